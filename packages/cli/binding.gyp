@@ -5,7 +5,34 @@
       "sources": [
         "native/main.cpp",
         "native/appcontainer_manager.cpp",
-        "native/amsi_scanner.cpp"
+        "native/amsi_scanner.cpp",
+        "native/worker_pool.cpp",
+        "native/work_scheduler.cpp",
+        "native/blake3.cpp",
+        "native/content_hasher.cpp",
+        "native/workspace_stage.cpp",
+        "native/policy_engine.cpp",
+        "native/sandbox_linux.cpp",
+        "native/sandbox_registry.cpp",
+        "native/egress_proxy.cpp",
+        "native/overlay_workspace.cpp",
+        "native/seccomp_compiler.cpp",
+        "native/resource_governor.cpp",
+        "native/pty_session.cpp",
+        "native/process_spawner.cpp",
+        "native/provider_init.cpp",
+        "native/access_grants.cpp",
+        "native/cancellation.cpp",
+        "native/mapped_file.cpp",
+        "native/decompress.cpp",
+        "native/rule_database.cpp",
+        "native/scan_provider.cpp",
+        "native/scan_pipeline.cpp",
+        "native/script_normalizer.cpp",
+        "native/archive_scanner.cpp",
+        "native/scanned_write.cpp",
+        "native/hash_allowlist.cpp",
+        "native/call_trace.cpp"
       ],
       "include_dirs": ["<!@(node -p \"require('node-addon-api').include\")"],
       "dependencies": ["<!(node -p \"require('node-addon-api').gyp\")"],
@@ -0,0 +1,883 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Access Grant Engine Implementation
+ */
+
+#include "access_grants.h"
+#include "work_scheduler.h"
+#include "worker_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include "appcontainer_manager.h"
+#elif defined(__linux__)
+#include <dirent.h>
+#include <endian.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/xattr.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+namespace TerminAI {
+
+bool ParseAccessRights(const std::string& text, uint32_t& rights) {
+    rights = 0;
+    for (char c : text) {
+        switch (c) {
+            case 'r':
+                rights |= AccessRead;
+                break;
+            case 'w':
+                rights |= AccessWrite;
+                break;
+            case 'x':
+                rights |= AccessExecute;
+                break;
+            default:
+                return false;
+        }
+    }
+    return rights != 0;
+}
+
+#if defined(_WIN32) || defined(__linux__)
+
+namespace {
+
+enum class EntryOutcome { Present, Missing, Granted, Failed };
+
+struct EntryInfo {
+    bool directory = false;
+    /** Regular files and directories; links and devices are left alone */
+    bool supported = false;
+    int64_t changeTime = 0;
+#ifdef __linux__
+    mode_t mode = 0;
+    uid_t uid = 0;
+#endif
+};
+
+#ifdef _WIN32
+
+// ============================================================================
+// Windows: DACLs
+// ============================================================================
+
+using NativePath = std::wstring;
+
+struct Principal {
+    std::vector<BYTE> sid;
+    /** ALL APPLICATION PACKAGES ACEs also cover this SID */
+    bool appContainer = false;
+
+    PSID Sid() const { return reinterpret_cast<PSID>(const_cast<BYTE*>(sid.data())); }
+};
+
+GENERIC_MAPPING kFileMapping = {
+    FILE_GENERIC_READ,
+    FILE_GENERIC_WRITE,
+    FILE_GENERIC_EXECUTE,
+    FILE_ALL_ACCESS,
+};
+
+bool SidFromString(const wchar_t* text, std::vector<BYTE>& out) {
+    PSID sid = nullptr;
+    if (!ConvertStringSidToSidW(text, &sid)) return false;
+    const BYTE* bytes = reinterpret_cast<const BYTE*>(sid);
+    out.assign(bytes, bytes + GetLengthSid(sid));
+    LocalFree(sid);
+    return true;
+}
+
+PSID AllAppPackagesSid() {
+    static std::vector<BYTE> sid = []() {
+        std::vector<BYTE> bytes;
+        SidFromString(ALL_APPLICATION_PACKAGES_SID, bytes);
+        return bytes;
+    }();
+    return sid.empty() ? nullptr : reinterpret_cast<PSID>(sid.data());
+}
+
+bool ParsePrincipal(const std::string& text, Principal& principal, std::string& error) {
+    if (!SidFromString(Utf8ToWide(text).c_str(), principal.sid)) {
+        error = "Invalid SID: " + text;
+        return false;
+    }
+    principal.appContainer = text.compare(0, 9, "S-1-15-2-") == 0;
+    return true;
+}
+
+NativePath ToNativePath(const std::string& path) {
+    return Utf8ToWide(path);
+}
+
+NativePath JoinNative(const NativePath& dir, const NativePath& name) {
+    if (!dir.empty() && (dir.back() == L'\\' || dir.back() == L'/')) return dir + name;
+    return dir + L'\\' + name;
+}
+
+bool StatEntry(const NativePath& path, EntryInfo& info) {
+    HANDLE handle = CreateFileW(path.c_str(), FILE_READ_ATTRIBUTES,
+                                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                                OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) return false;
+    FILE_BASIC_INFO basic = {};
+    BOOL ok = GetFileInformationByHandleEx(handle, FileBasicInfo, &basic, sizeof(basic));
+    CloseHandle(handle);
+    if (!ok) return false;
+    info.directory = (basic.FileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+    info.supported = true;
+    info.changeTime = basic.ChangeTime.QuadPart;
+    return true;
+}
+
+bool ListEntries(const NativePath& dir, std::vector<std::pair<NativePath, EntryInfo>>& entries) {
+    WIN32_FIND_DATAW data;
+    HANDLE find = FindFirstFileExW(JoinNative(dir, L"*").c_str(), FindExInfoBasic, &data,
+                                   FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH);
+    if (find == INVALID_HANDLE_VALUE) return false;
+    do {
+        if (wcscmp(data.cFileName, L".") == 0 || wcscmp(data.cFileName, L"..") == 0) continue;
+        // Junctions and symlinks point outside the tree (or back into it).
+        if (data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) continue;
+        EntryInfo info;
+        info.directory = (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+        info.supported = true;
+        entries.emplace_back(JoinNative(dir, data.cFileName), info);
+    } while (FindNextFileW(find, &data));
+    FindClose(find);
+    return true;
+}
+
+ACCESS_MASK MaskFromRights(uint32_t rights) {
+    ACCESS_MASK mask = 0;
+    if (rights & AccessRead) mask |= FILE_GENERIC_READ;
+    if (rights & AccessWrite) mask |= FILE_GENERIC_WRITE;
+    if (rights & AccessExecute) mask |= FILE_GENERIC_EXECUTE;
+    return mask;
+}
+
+struct Dacl {
+    std::vector<BYTE> descriptor;
+    PACL acl = nullptr;
+    bool present = false;
+    SECURITY_DESCRIPTOR_CONTROL control = 0;
+};
+
+bool ReadDacl(const NativePath& path, Dacl& dacl, std::string& error) {
+    DWORD needed = 0;
+    GetFileSecurityW(path.c_str(), DACL_SECURITY_INFORMATION, nullptr, 0, &needed);
+    if (needed == 0) {
+        error = "GetFileSecurity failed: " + GetWindowsErrorMessage(GetLastError());
+        return false;
+    }
+    dacl.descriptor.resize(needed);
+    if (!GetFileSecurityW(path.c_str(), DACL_SECURITY_INFORMATION, dacl.descriptor.data(), needed,
+                          &needed)) {
+        error = "GetFileSecurity failed: " + GetWindowsErrorMessage(GetLastError());
+        return false;
+    }
+    PSECURITY_DESCRIPTOR descriptor = dacl.descriptor.data();
+    BOOL present = FALSE;
+    BOOL defaulted = FALSE;
+    GetSecurityDescriptorDacl(descriptor, &present, &dacl.acl, &defaulted);
+    dacl.present = present != FALSE;
+    DWORD revision = 0;
+    GetSecurityDescriptorControl(descriptor, &dacl.control, &revision);
+    return true;
+}
+
+bool HasGrant(const Dacl& dacl, const Principal& principal, ACCESS_MASK required,
+              bool inheritable) {
+    // No DACL at all grants everyone everything.
+    if (!dacl.present || dacl.acl == nullptr) return true;
+
+    PSID allAppPackages = principal.appContainer ? AllAppPackagesSid() : nullptr;
+    const BYTE inheritBoth = OBJECT_INHERIT_ACE | CONTAINER_INHERIT_ACE;
+    bool effective = false;
+    bool inherits = !inheritable;
+
+    for (DWORD i = 0; i < dacl.acl->AceCount; i++) {
+        void* ace = nullptr;
+        if (!GetAce(dacl.acl, i, &ace)) continue;
+        auto* header = static_cast<ACE_HEADER*>(ace);
+        if (header->AceType != ACCESS_ALLOWED_ACE_TYPE) continue;
+
+        auto* allowed = static_cast<ACCESS_ALLOWED_ACE*>(ace);
+        PSID sid = reinterpret_cast<PSID>(&allowed->SidStart);
+        if (!EqualSid(sid, principal.Sid()) &&
+            !(allAppPackages != nullptr && EqualSid(sid, allAppPackages))) {
+            continue;
+        }
+
+        ACCESS_MASK mask = allowed->Mask;
+        MapGenericMask(&mask, &kFileMapping);
+        if ((mask & required) != required) continue;
+
+        if (!(header->AceFlags & INHERIT_ONLY_ACE)) effective = true;
+        if ((header->AceFlags & inheritBoth) == inheritBoth &&
+            !(header->AceFlags & NO_PROPAGATE_INHERIT_ACE)) {
+            inherits = true;
+        }
+    }
+    return effective && inherits;
+}
+
+/**
+ * Rewrite the DACL with one more allow ACE. Explicit ACEs go before the
+ * inherited ones, inherited ACEs last, which keeps the DACL canonical.
+ */
+bool AddGrantAce(const NativePath& path, const Dacl& dacl, const Principal& principal,
+                 ACCESS_MASK mask, BYTE aceFlags, std::string& error) {
+    DWORD used = sizeof(ACL);
+    BYTE revision = ACL_REVISION;
+    if (dacl.present && dacl.acl != nullptr) {
+        ACL_SIZE_INFORMATION size = {};
+        GetAclInformation(dacl.acl, &size, sizeof(size), AclSizeInformation);
+        used = size.AclBytesInUse;
+        revision = std::max<BYTE>(revision, dacl.acl->AclRevision);
+    }
+    DWORD total = used + sizeof(ACCESS_ALLOWED_ACE) - sizeof(DWORD) + GetLengthSid(principal.Sid());
+    std::vector<BYTE> buffer(total);
+    PACL acl = reinterpret_cast<PACL>(buffer.data());
+    if (!InitializeAcl(acl, total, revision)) {
+        error = "InitializeAcl failed: " + GetWindowsErrorMessage(GetLastError());
+        return false;
+    }
+
+    bool added = false;
+    auto addOurs = [&]() {
+        added = AddAccessAllowedAceEx(acl, revision, aceFlags, mask, principal.Sid()) != FALSE;
+        return added;
+    };
+
+    DWORD count = dacl.present && dacl.acl != nullptr ? dacl.acl->AceCount : 0;
+    bool inherited = (aceFlags & INHERITED_ACE) != 0;
+    bool inserted = false;
+    for (DWORD i = 0; i < count; i++) {
+        void* ace = nullptr;
+        if (!GetAce(dacl.acl, i, &ace)) continue;
+        auto* header = static_cast<ACE_HEADER*>(ace);
+        if (!inherited && !inserted && (header->AceFlags & INHERITED_ACE)) {
+            inserted = true;
+            if (!addOurs()) break;
+        }
+        if (!AddAce(acl, revision, MAXDWORD, ace, header->AceSize)) {
+            error = "AddAce failed: " + GetWindowsErrorMessage(GetLastError());
+            return false;
+        }
+    }
+    if (!inserted) addOurs();
+    if (!added) {
+        error = "AddAccessAllowedAceEx failed: " + GetWindowsErrorMessage(GetLastError());
+        return false;
+    }
+
+    SECURITY_DESCRIPTOR descriptor;
+    InitializeSecurityDescriptor(&descriptor, SECURITY_DESCRIPTOR_REVISION);
+    SetSecurityDescriptorDacl(&descriptor, TRUE, acl, FALSE);
+    const SECURITY_DESCRIPTOR_CONTROL keep = SE_DACL_PROTECTED | SE_DACL_AUTO_INHERITED;
+    SetSecurityDescriptorControl(&descriptor, keep, dacl.control & keep);
+
+    // SetFileSecurity writes this one object; it does not walk the subtree
+    // the way SetNamedSecurityInfo does.
+    if (!SetFileSecurityW(path.c_str(), DACL_SECURITY_INFORMATION, &descriptor)) {
+        error = "SetFileSecurity failed: " + GetWindowsErrorMessage(GetLastError());
+        return false;
+    }
+    return true;
+}
+
+EntryOutcome EnsureEntry(const NativePath& path, const EntryInfo& info, const Principal& principal,
+                         uint32_t rights, bool inheritable, bool root, bool checkOnly,
+                         std::string& error) {
+    Dacl dacl;
+    if (!ReadDacl(path, dacl, error)) return EntryOutcome::Failed;
+
+    ACCESS_MASK required = MaskFromRights(rights);
+    bool needInheritable = inheritable && info.directory;
+    if (HasGrant(dacl, principal, required, needInheritable)) return EntryOutcome::Present;
+    if (checkOnly) return EntryOutcome::Missing;
+
+    BYTE flags = needInheritable ? OBJECT_INHERIT_ACE | CONTAINER_INHERIT_ACE : 0;
+    // Below the root, the ACE stands in for what propagation would have
+    // written, unless the entry blocks inheritance.
+    if (!root && !(dacl.control & SE_DACL_PROTECTED)) flags |= INHERITED_ACE;
+    if (!AddGrantAce(path, dacl, principal, required, flags, error)) return EntryOutcome::Failed;
+    return EntryOutcome::Granted;
+}
+
+#else // __linux__
+
+// ============================================================================
+// Linux: POSIX ACLs (system.posix_acl_* extended attributes)
+// ============================================================================
+
+using NativePath = std::string;
+
+struct Principal {
+    bool group = false;
+    uint32_t id = 0;
+};
+
+// include/uapi/linux/posix_acl_xattr.h; little-endian on disk.
+constexpr uint32_t kAclXattrVersion = 2;
+constexpr uint16_t kTagUserObj = 0x01;
+constexpr uint16_t kTagUser = 0x02;
+constexpr uint16_t kTagGroupObj = 0x04;
+constexpr uint16_t kTagGroup = 0x08;
+constexpr uint16_t kTagMask = 0x10;
+constexpr uint16_t kTagOther = 0x20;
+constexpr uint32_t kUndefinedId = 0xFFFFFFFF;
+
+const char* const kAccessAcl = "system.posix_acl_access";
+const char* const kDefaultAcl = "system.posix_acl_default";
+
+struct AclEntry {
+    uint16_t tag;
+    uint16_t perm;
+    uint32_t id;
+};
+
+bool ParsePrincipal(const std::string& text, Principal& principal, std::string& error) {
+    if (text.size() > 2 && (text[0] == 'u' || text[0] == 'g') && text[1] == ':') {
+        char* end = nullptr;
+        unsigned long id = strtoul(text.c_str() + 2, &end, 10);
+        if (*end == '\0' && id < kUndefinedId) {
+            principal.group = text[0] == 'g';
+            principal.id = static_cast<uint32_t>(id);
+            return true;
+        }
+    }
+    error = "Invalid principal (expected u:<uid> or g:<gid>): " + text;
+    return false;
+}
+
+NativePath ToNativePath(const std::string& path) {
+    return path;
+}
+
+void FillInfo(const struct stat& st, EntryInfo& info) {
+    info.directory = S_ISDIR(st.st_mode);
+    info.supported = S_ISDIR(st.st_mode) || S_ISREG(st.st_mode);
+    info.changeTime = static_cast<int64_t>(st.st_ctim.tv_sec) * 1000000000 + st.st_ctim.tv_nsec;
+    info.mode = st.st_mode;
+    info.uid = st.st_uid;
+}
+
+bool StatEntry(const NativePath& path, EntryInfo& info) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return false;
+    FillInfo(st, info);
+    return true;
+}
+
+bool ListEntries(const NativePath& dir, std::vector<std::pair<NativePath, EntryInfo>>& entries) {
+    DIR* handle = opendir(dir.c_str());
+    if (handle == nullptr) return false;
+    int fd = dirfd(handle);
+    while (dirent* entry = readdir(handle)) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+        struct stat st;
+        if (fstatat(fd, entry->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0) continue;
+        EntryInfo info;
+        FillInfo(st, info);
+        if (!info.supported) continue;
+        entries.emplace_back(dir + "/" + entry->d_name, info);
+    }
+    closedir(handle);
+    return true;
+}
+
+/**
+ * @param present Set to false (and true returned) when the ACL is absent
+ */
+bool ReadAcl(const NativePath& path, const char* name, std::vector<AclEntry>& entries,
+             bool& present, std::string& error) {
+    entries.clear();
+    present = false;
+    char buffer[4 + 8 * 64];
+    ssize_t size = getxattr(path.c_str(), name, buffer, sizeof(buffer));
+    std::vector<char> large;
+    if (size < 0 && errno == ERANGE) {
+        size = getxattr(path.c_str(), name, nullptr, 0);
+        if (size > 0) {
+            large.resize(size);
+            size = getxattr(path.c_str(), name, large.data(), large.size());
+        }
+    }
+    if (size < 0) {
+        if (errno == ENODATA) return true;
+        error = std::string("Cannot read ") + name + " of " + path + ": " + strerror(errno);
+        return false;
+    }
+
+    const char* data = large.empty() ? buffer : large.data();
+    uint32_t version = 0;
+    if (size >= 4) memcpy(&version, data, sizeof(version));
+    if (size < 4 || (size - 4) % 8 != 0 || le32toh(version) != kAclXattrVersion) {
+        error = std::string("Unexpected ") + name + " format on " + path;
+        return false;
+    }
+    for (ssize_t offset = 4; offset < size; offset += 8) {
+        AclEntry entry;
+        memcpy(&entry, data + offset, sizeof(entry));
+        entries.push_back({le16toh(entry.tag), le16toh(entry.perm), le32toh(entry.id)});
+    }
+    present = true;
+    return true;
+}
+
+bool WriteAcl(const NativePath& path, const char* name, std::vector<AclEntry> entries,
+              std::string& error) {
+    // The kernel requires entries ordered by tag, then id.
+    std::sort(entries.begin(), entries.end(), [](const AclEntry& a, const AclEntry& b) {
+        return a.tag != b.tag ? a.tag < b.tag : a.id < b.id;
+    });
+    std::vector<char> data(4 + 8 * entries.size());
+    uint32_t version = htole32(kAclXattrVersion);
+    memcpy(data.data(), &version, sizeof(version));
+    for (size_t i = 0; i < entries.size(); i++) {
+        AclEntry raw = {htole16(entries[i].tag), htole16(entries[i].perm), htole32(entries[i].id)};
+        memcpy(data.data() + 4 + 8 * i, &raw, sizeof(raw));
+    }
+    if (setxattr(path.c_str(), name, data.data(), data.size(), 0) != 0) {
+        error = std::string("Cannot write ") + name + " of " + path + ": " + strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+/** The ACL equivalent of plain permission bits. */
+std::vector<AclEntry> AclFromMode(mode_t mode) {
+    return {
+        {kTagUserObj, static_cast<uint16_t>((mode >> 6) & 7), kUndefinedId},
+        {kTagGroupObj, static_cast<uint16_t>((mode >> 3) & 7), kUndefinedId},
+        {kTagOther, static_cast<uint16_t>(mode & 7), kUndefinedId},
+    };
+}
+
+bool AclGrants(const std::vector<AclEntry>& entries, const Principal& principal, uint16_t perm) {
+    uint16_t tag = principal.group ? kTagGroup : kTagUser;
+    bool named = false;
+    uint16_t mask = 7;
+    for (const auto& entry : entries) {
+        if (entry.tag == tag && entry.id == principal.id) named = (entry.perm & perm) == perm;
+        if (entry.tag == kTagMask) mask = entry.perm;
+    }
+    return named && (mask & perm) == perm;
+}
+
+/** Add or widen the named entry and recompute the mask, as setfacl does. */
+void AddToAcl(std::vector<AclEntry>& entries, const Principal& principal, uint16_t perm) {
+    uint16_t tag = principal.group ? kTagGroup : kTagUser;
+    auto named = std::find_if(entries.begin(), entries.end(), [&](const AclEntry& entry) {
+        return entry.tag == tag && entry.id == principal.id;
+    });
+    if (named != entries.end()) {
+        named->perm |= perm;
+    } else {
+        entries.push_back({tag, perm, principal.id});
+    }
+
+    uint16_t mask = 0;
+    for (const auto& entry : entries) {
+        if (entry.tag == kTagUser || entry.tag == kTagGroupObj || entry.tag == kTagGroup) {
+            mask |= entry.perm;
+        }
+    }
+    auto existing = std::find_if(entries.begin(), entries.end(),
+                                 [](const AclEntry& entry) { return entry.tag == kTagMask; });
+    if (existing != entries.end()) {
+        existing->perm = mask;
+    } else {
+        entries.push_back({kTagMask, mask, kUndefinedId});
+    }
+}
+
+EntryOutcome EnsureEntry(const NativePath& path, const EntryInfo& info, const Principal& principal,
+                         uint32_t rights, bool inheritable, bool root, bool checkOnly,
+                         std::string& error) {
+    uint16_t perm = 0;
+    if (rights & AccessRead) perm |= 4;
+    if (rights & AccessWrite) perm |= 2;
+    if ((rights & AccessExecute) && (info.directory || (info.mode & 0111))) perm |= 1;
+    if (perm == 0) return EntryOutcome::Present;
+
+    // The owner is governed by the mode bits, never by a named entry.
+    if (!principal.group && principal.id == info.uid) {
+        mode_t owner = (info.mode >> 6) & 7;
+        if ((owner & perm) == perm) return EntryOutcome::Present;
+        if (checkOnly) return EntryOutcome::Missing;
+        if (chmod(path.c_str(), (info.mode & 07777) | (static_cast<mode_t>(perm) << 6)) != 0) {
+            error = "Cannot chmod " + path + ": " + strerror(errno);
+            return EntryOutcome::Failed;
+        }
+        return EntryOutcome::Granted;
+    }
+
+    std::vector<AclEntry> access;
+    bool hasAccess = false;
+    if (!ReadAcl(path, kAccessAcl, access, hasAccess, error)) return EntryOutcome::Failed;
+    if (!hasAccess) access = AclFromMode(info.mode);
+    bool needAccess = !AclGrants(access, principal, perm);
+
+    std::vector<AclEntry> defaults;
+    bool hasDefault = false;
+    bool needDefault = false;
+    if (inheritable && info.directory) {
+        if (!ReadAcl(path, kDefaultAcl, defaults, hasDefault, error)) return EntryOutcome::Failed;
+        if (!hasDefault) defaults = AclFromMode(info.mode);
+        needDefault = !hasDefault || !AclGrants(defaults, principal, perm);
+    }
+
+    if (!needAccess && !needDefault) return EntryOutcome::Present;
+    if (checkOnly) return EntryOutcome::Missing;
+
+    if (needAccess) {
+        AddToAcl(access, principal, perm);
+        if (!WriteAcl(path, kAccessAcl, access, error)) return EntryOutcome::Failed;
+    }
+    if (needDefault) {
+        AddToAcl(defaults, principal, perm);
+        if (!WriteAcl(path, kDefaultAcl, defaults, error)) return EntryOutcome::Failed;
+    }
+    return EntryOutcome::Granted;
+}
+
+#endif // _WIN32 / __linux__
+
+// ============================================================================
+// Verification Cache
+// ============================================================================
+
+std::mutex g_verifiedMutex;
+/** Grant key -> the root's change time when the grant was verified */
+std::unordered_map<std::string, int64_t> g_verified;
+
+std::string GrantKey(const AccessGrant& grant) {
+    std::string key = grant.path;
+    key += '\n';
+    key += grant.principal;
+    key += '\n';
+    key += std::to_string(grant.rights);
+    key += grant.recursive ? "R" : "";
+    return key;
+}
+
+bool IsVerified(const std::string& key, int64_t changeTime) {
+    std::lock_guard<std::mutex> lock(g_verifiedMutex);
+    auto it = g_verified.find(key);
+    return it != g_verified.end() && it->second == changeTime;
+}
+
+void MarkVerified(const std::string& key, int64_t changeTime) {
+    std::lock_guard<std::mutex> lock(g_verifiedMutex);
+    g_verified[key] = changeTime;
+}
+
+// ============================================================================
+// Recursive Walk
+// ============================================================================
+
+struct GrantWalk {
+    GrantWalk(const Principal& principal, uint32_t rights, CancelToken* cancel)
+        : group(WorkerPool::Shared()), principal(principal), rights(rights), cancel(cancel) {}
+
+    WaitGroup group;
+    const Principal& principal;
+    uint32_t rights;
+    CancelToken* cancel;
+
+    std::atomic<uint64_t> checked{0};
+    std::atomic<uint64_t> granted{0};
+    std::atomic<uint64_t> failed{0};
+};
+
+void WalkDirectory(GrantWalk& walk, const NativePath& dir) {
+    if (IsStopped(walk.cancel)) return;
+
+    std::vector<std::pair<NativePath, EntryInfo>> entries;
+    if (!ListEntries(dir, entries)) {
+        walk.failed.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    uint64_t checked = 0;
+    uint64_t granted = 0;
+    uint64_t failed = 0;
+    for (auto& [path, info] : entries) {
+        if (IsStopped(walk.cancel)) break;
+
+        std::string error;
+        checked++;
+        switch (EnsureEntry(path, info, walk.principal, walk.rights, true, false, false, error)) {
+            case EntryOutcome::Granted:
+                granted++;
+                break;
+            case EntryOutcome::Failed:
+                failed++;
+                continue;
+            default:
+                break;
+        }
+        if (info.directory) {
+            walk.group.Run([&walk, path = std::move(path)]() { WalkDirectory(walk, path); });
+        }
+    }
+    walk.checked.fetch_add(checked, std::memory_order_relaxed);
+    walk.granted.fetch_add(granted, std::memory_order_relaxed);
+    walk.failed.fetch_add(failed, std::memory_order_relaxed);
+}
+
+int64_t ElapsedUs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+} // namespace
+
+// ============================================================================
+// Core Functions
+// ============================================================================
+
+bool ApplyAccessGrant(const AccessGrant& grant, AccessGrantResult& result, std::string& error,
+                      CancelToken* cancel) {
+    auto start = std::chrono::steady_clock::now();
+    result = AccessGrantResult{};
+
+    Principal principal;
+    if (!ParsePrincipal(grant.principal, principal, error)) return false;
+    if (grant.rights == 0) {
+        error = "No rights to grant";
+        return false;
+    }
+
+    NativePath root = ToNativePath(grant.path);
+    EntryInfo info;
+    if (!StatEntry(root, info) || !info.supported) {
+        error = "Cannot grant access to " + grant.path + ": not a file or directory";
+        return false;
+    }
+
+    std::string key = GrantKey(grant);
+    if (IsVerified(key, info.changeTime)) {
+        result.cached = true;
+        result.latencyUs = ElapsedUs(start);
+        return true;
+    }
+
+    result.checked = 1;
+    switch (EnsureEntry(root, info, principal, grant.rights, grant.recursive, true, false, error)) {
+        case EntryOutcome::Failed:
+            return false;
+        case EntryOutcome::Granted:
+            result.granted = 1;
+            break;
+        default:
+            break;
+    }
+
+    if (grant.recursive && info.directory) {
+        GrantWalk walk(principal, grant.rights, cancel);
+        WalkDirectory(walk, root);
+        walk.group.Wait();
+        result.checked += walk.checked.load();
+        result.granted += walk.granted.load();
+        result.failed = walk.failed.load();
+        if (IsStopped(cancel)) {
+            error = CancelReasonMessage(cancel->Outcome());
+            return false;
+        }
+    }
+
+    // Stamp with the change time after our own writes.
+    if (result.failed == 0 && StatEntry(root, info)) MarkVerified(key, info.changeTime);
+    result.latencyUs = ElapsedUs(start);
+    return true;
+}
+
+bool CheckAccessGrant(const AccessGrant& grant, std::string& error) {
+    Principal principal;
+    if (!ParsePrincipal(grant.principal, principal, error)) return false;
+
+    NativePath root = ToNativePath(grant.path);
+    EntryInfo info;
+    if (!StatEntry(root, info) || !info.supported) {
+        error = "Cannot check " + grant.path + ": not a file or directory";
+        return false;
+    }
+    if (IsVerified(GrantKey(grant), info.changeTime)) return true;
+    return EnsureEntry(root, info, principal, grant.rights, grant.recursive, true, true, error) ==
+           EntryOutcome::Present;
+}
+
+namespace {
+
+// ============================================================================
+// Async Worker
+// ============================================================================
+
+class GrantWorker : public Napi::AsyncWorker {
+public:
+    GrantWorker(Napi::Env env, AccessGrant grant, CancelBinding cancel, WorkContext work)
+        : Napi::AsyncWorker(env),
+          deferred_(Napi::Promise::Deferred::New(env)),
+          grant_(std::move(grant)),
+          cancel_(std::move(cancel)),
+          work_(work) {}
+
+    Napi::Promise Promise() const { return deferred_.Promise(); }
+
+    void Execute() override {
+        WorkScope scope(work_);
+        std::string error;
+        if (!ApplyAccessGrant(grant_, result_, error, cancel_.Token())) SetError(error);
+    }
+
+    void OnOK() override {
+        cancel_.Finish();
+        Napi::Env env = Env();
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("cached", Napi::Boolean::New(env, result_.cached));
+        result.Set("checked", Napi::Number::New(env, static_cast<double>(result_.checked)));
+        result.Set("granted", Napi::Number::New(env, static_cast<double>(result_.granted)));
+        result.Set("failed", Napi::Number::New(env, static_cast<double>(result_.failed)));
+        result.Set("latencyUs", Napi::Number::New(env, static_cast<double>(result_.latencyUs)));
+        deferred_.Resolve(result);
+    }
+
+    void OnError(const Napi::Error& error) override {
+        cancel_.Finish();
+        deferred_.Reject(cancel_.Stopped() ? cancel_.StoppedError(Env()) : error.Value());
+    }
+
+private:
+    Napi::Promise::Deferred deferred_;
+    AccessGrant grant_;
+    CancelBinding cancel_;
+    WorkContext work_;
+    AccessGrantResult result_;
+};
+
+} // namespace
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+Napi::Value GrantPathAccess(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    AccessGrant grant;
+    bool valid = info.Length() >= 1 && info[0].IsObject();
+    if (valid) {
+        Napi::Object options = info[0].As<Napi::Object>();
+        Napi::Value path = options.Get("path");
+        Napi::Value principal = options.Get("principal");
+        Napi::Value rights = options.Get("rights");
+        Napi::Value recursive = options.Get("recursive");
+        valid = path.IsString() && principal.IsString() && rights.IsString() &&
+                ParseAccessRights(rights.As<Napi::String>().Utf8Value(), grant.rights);
+        if (valid) {
+            grant.path = path.As<Napi::String>().Utf8Value();
+            grant.principal = principal.As<Napi::String>().Utf8Value();
+            grant.recursive = recursive.IsBoolean() && recursive.As<Napi::Boolean>().Value();
+        }
+    }
+    if (!valid) {
+        auto deferred = Napi::Promise::Deferred::New(env);
+        deferred.Reject(Napi::TypeError::New(
+            env, "grantPathAccess expects { path, principal, rights: 'r'|'w'|'x'... }").Value());
+        return deferred.Promise();
+    }
+
+    WorkContext work;
+    CancelBinding cancel(CancellableOperation::GrantPathAccess);
+    std::string error;
+    if (!ReadWorkContext(info[0], WorkPriority::Normal, work, error) ||
+        !cancel.Attach(info[0], error)) {
+        auto deferred = Napi::Promise::Deferred::New(env);
+        deferred.Reject(Napi::TypeError::New(env, error).Value());
+        return deferred.Promise();
+    }
+
+    auto* worker = new GrantWorker(env, std::move(grant), std::move(cancel), work);
+    Napi::Promise promise = worker->Promise();
+    worker->Queue();
+    return promise;
+}
+
+Napi::Value CheckPathAccess(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    AccessGrant grant;
+    if (info.Length() < 3 || !info[0].IsString() || !info[1].IsString() || !info[2].IsString() ||
+        !ParseAccessRights(info[2].As<Napi::String>().Utf8Value(), grant.rights)) {
+        return Napi::Boolean::New(env, false);
+    }
+    grant.path = info[0].As<Napi::String>().Utf8Value();
+    grant.principal = info[1].As<Napi::String>().Utf8Value();
+    grant.recursive = info.Length() > 3 && info[3].IsBoolean() && info[3].As<Napi::Boolean>().Value();
+
+    std::string error;
+    return Napi::Boolean::New(env, CheckAccessGrant(grant, error));
+}
+
+Napi::Value ClearAccessGrantCache(const Napi::CallbackInfo& info) {
+    std::lock_guard<std::mutex> lock(g_verifiedMutex);
+    g_verified.clear();
+    return info.Env().Undefined();
+}
+
+#else // !_WIN32 && !__linux__
+
+// ============================================================================
+// Stubs for other platforms
+// ============================================================================
+
+bool ApplyAccessGrant(const AccessGrant& grant, AccessGrantResult& result, std::string& error,
+                      CancelToken* cancel) {
+    error = "Access grants are only available on Linux and Windows";
+    return false;
+}
+
+bool CheckAccessGrant(const AccessGrant& grant, std::string& error) {
+    error = "Access grants are only available on Linux and Windows";
+    return false;
+}
+
+Napi::Value GrantPathAccess(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    auto deferred = Napi::Promise::Deferred::New(env);
+    deferred.Reject(
+        Napi::Error::New(env, "Access grants are only available on Linux and Windows").Value());
+    return deferred.Promise();
+}
+
+Napi::Value CheckPathAccess(const Napi::CallbackInfo& info) {
+    return Napi::Boolean::New(info.Env(), false);
+}
+
+Napi::Value ClearAccessGrantCache(const Napi::CallbackInfo& info) {
+    return info.Env().Undefined();
+}
+
+#endif
+
+} // namespace TerminAI
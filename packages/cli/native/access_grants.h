@@ -0,0 +1,147 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Access Grant Engine Header
+ *
+ * Grants a principal access to a file or a directory tree, writing only the
+ * entries that lack it:
+ *
+ *   Windows  an allow ACE for a SID (the AppContainer SID, or S-1-15-2-1 for
+ *            ALL APPLICATION PACKAGES). Written with SetFileSecurity, which
+ *            does not re-propagate through the tree the way
+ *            SetNamedSecurityInfo and icacls do; the walk below adds the
+ *            inherited ACE only to entries that are missing it.
+ *   Linux    a POSIX ACL entry for a uid or gid, plus a default ACL on
+ *            directories so that new files inherit it.
+ *
+ * Every entry is checked before it is written. An ACE or ACL entry that
+ * already covers the rights (an ALL APPLICATION PACKAGES ACE covers every
+ * AppContainer SID) leaves the entry alone. Recursive grants fan out over
+ * the shared worker pool, one task per directory.
+ *
+ * Verified grants are cached as (path, principal, rights) together with the
+ * root's change time (ctime / ChangeTime, which any ACL or mode write bumps).
+ * A warm launch stats the root, finds the cache current and does no ACL
+ * work. New files in a granted tree inherit the grant; entries moved in from
+ * elsewhere keep their own ACL until the cache is cleared.
+ */
+
+#pragma once
+
+#include <napi.h>
+#include "cancellation.h"
+
+#include <cstdint>
+#include <string>
+
+namespace TerminAI {
+
+// ============================================================================
+// Types
+// ============================================================================
+
+enum AccessRight : uint32_t {
+    AccessRead = 1,
+    AccessWrite = 2,
+    /** Directories, and files some class can already execute (like chmod X) */
+    AccessExecute = 4,
+};
+
+struct AccessGrant {
+    /** UTF-8 path of a file or directory */
+    std::string path;
+    /** Windows: SID string ("S-1-15-2-1"); Linux: "u:<uid>" or "g:<gid>" */
+    std::string principal;
+    /** AccessRight bits */
+    uint32_t rights = 0;
+    /** Grant on every entry below a directory, and make new entries inherit */
+    bool recursive = false;
+};
+
+struct AccessGrantResult {
+    /** Answered from the verification cache; nothing was read */
+    bool cached = false;
+    /** Entries whose ACL was read */
+    uint64_t checked = 0;
+    /** Entries whose ACL was written */
+    uint64_t granted = 0;
+    /** Entries that could not be read or written */
+    uint64_t failed = 0;
+    int64_t latencyUs = 0;
+};
+
+// ============================================================================
+// Core Functions
+// ============================================================================
+
+/**
+ * Parse "r", "w" and "x" characters into AccessRight bits.
+ *
+ * @return false for any other character or an empty string
+ */
+bool ParseAccessRights(const std::string& text, uint32_t& rights);
+
+/**
+ * Make sure the principal has the rights; see the file comment.
+ *
+ * @param error Receives a description when the root itself fails
+ * @param cancel Checked per entry. A stopped grant keeps what it wrote and
+ *        is not cached; granting again finishes it.
+ * @return false if the root could not be checked or granted, or the walk was
+ *         stopped; failures below the root are only counted
+ */
+bool ApplyAccessGrant(const AccessGrant& grant, AccessGrantResult& result, std::string& error,
+                      CancelToken* cancel = nullptr);
+
+/**
+ * Whether the root entry already grants the rights (no writes, no walk).
+ * A recursive check on a directory also requires the grant to be
+ * inheritable.
+ */
+bool CheckAccessGrant(const AccessGrant& grant, std::string& error);
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+/**
+ * Grant access to a path.
+ *
+ * Arguments:
+ *   0: Object
+ *      - path: String
+ *      - principal: String - SID (Windows) or "u:<uid>" / "g:<gid>" (Linux)
+ *      - rights: String - any of "r", "w", "x"
+ *      - recursive?: Boolean (default: false)
+ *      - timeoutMs?: Number, signal?: AbortSignal (see cancellation.h)
+ *      - priority?: String (default 'normal'), sessionId?: String
+ *        (see work_scheduler.h)
+ *
+ * Returns: Promise<{ cached, checked, granted, failed, latencyUs }>
+ *          (rejects when the root cannot be checked or granted, and with an
+ *          AbortError or TimeoutError when stopped)
+ */
+Napi::Value GrantPathAccess(const Napi::CallbackInfo& info);
+
+/**
+ * Check a grant on one path without changing anything.
+ *
+ * Arguments:
+ *   0: String - Path
+ *   1: String - Principal
+ *   2: String - Rights
+ *   3: Boolean - Require an inheritable grant on directories (default: false)
+ *
+ * Returns: Boolean (false also when the path or principal is invalid)
+ */
+Napi::Value CheckPathAccess(const Napi::CallbackInfo& info);
+
+/**
+ * Forget every verified grant.
+ */
+Napi::Value ClearAccessGrantCache(const Napi::CallbackInfo& info);
+
+} // namespace TerminAI
@@ -17,8 +17,11 @@
 
 #include "amsi_scanner.h"
 #include "appcontainer_manager.h"
+#include "provider_init.h"
+#include <atomic>
 #include <iostream>
 #include <fstream>
+#include <mutex>
 #include <sstream>
 
 namespace TerminAI {
@@ -27,7 +30,9 @@ namespace TerminAI {
 // Global State
 // ============================================================================
 
-static HAMSICONTEXT g_amsiContext = nullptr;
+// Set by the background initializer or the first scan, whichever runs first
+static std::atomic<HAMSICONTEXT> g_amsiContext{nullptr};
+static std::mutex g_amsiMutex;
 static const wchar_t* const AMSI_APP_NAME = L"TerminAI";
 
 // ============================================================================
@@ -35,11 +40,13 @@ static const wchar_t* const AMSI_APP_NAME = L"TerminAI";
 // ============================================================================
 
 bool InitializeAmsi() {
+    std::lock_guard<std::mutex> lock(g_amsiMutex);
     if (g_amsiContext != nullptr) {
         return true; // Already initialized
     }
 
-    HRESULT hr = AmsiInitialize(AMSI_APP_NAME, &g_amsiContext);
+    HAMSICONTEXT context = nullptr;
+    HRESULT hr = AmsiInitialize(AMSI_APP_NAME, &context);
 
     if (FAILED(hr)) {
         std::cerr << "[AmsiScanner] AmsiInitialize failed: 0x"
@@ -47,11 +54,13 @@ bool InitializeAmsi() {
         return false;
     }
 
+    g_amsiContext = context;
     std::cout << "[AmsiScanner] AMSI initialized successfully" << std::endl;
     return true;
 }
 
 void UninitializeAmsi() {
+    std::lock_guard<std::mutex> lock(g_amsiMutex);
     if (g_amsiContext != nullptr) {
         AmsiUninitialize(g_amsiContext);
         g_amsiContext = nullptr;
@@ -63,6 +72,48 @@ bool IsAmsiInitialized() {
     return g_amsiContext != nullptr;
 }
 
+// ============================================================================
+// Native Scanning
+// ============================================================================
+
+HAMSISESSION OpenAmsiSession() {
+    HAMSISESSION session = nullptr;
+    if (g_amsiContext == nullptr || FAILED(AmsiOpenSession(g_amsiContext, &session))) {
+        return nullptr;
+    }
+    return session;
+}
+
+void CloseAmsiSession(HAMSISESSION session) {
+    if (session != nullptr && g_amsiContext != nullptr) {
+        AmsiCloseSession(g_amsiContext, session);
+    }
+}
+
+bool AmsiScanContent(const void* data, size_t length, const std::string& contentName,
+                     HAMSISESSION session, AMSI_RESULT& result, std::string& error) {
+    if (g_amsiContext == nullptr) {
+        error = "AMSI not available";
+        return false;
+    }
+    if (length > MAXULONG) {
+        error = "content too large for AMSI";
+        return false;
+    }
+
+    std::wstring nameWide = Utf8ToWide(contentName);
+    result = AMSI_RESULT_DETECTED; // Default to detected for safety
+    HRESULT hr = ::AmsiScanBuffer(g_amsiContext, const_cast<void*>(data),
+                                  static_cast<ULONG>(length), nameWide.c_str(), session, &result);
+    if (FAILED(hr)) {
+        std::cerr << "[AmsiScanner] AmsiScanBuffer failed for " << contentName << ": 0x"
+                  << std::hex << hr << std::dec << std::endl;
+        error = "AMSI scan failed";
+        return false;
+    }
+    return true;
+}
+
 // ============================================================================
 // Helper Functions
 // ============================================================================
@@ -114,8 +165,9 @@ Napi::Value AmsiScanBuffer(const Napi::CallbackInfo& info) {
         return result;
     }
 
-    // Check AMSI initialization
-    if (!IsAmsiInitialized()) {
+    // Check AMSI initialization: the first scan waits for the background
+    // initializer; a failed attempt is retried here
+    if (!IsAmsiInitialized() && !AwaitNativeProvider("amsi")) {
         if (!InitializeAmsi()) {
             result.Set("clean", Napi::Boolean::New(env, false));
             result.Set("result", Napi::Number::New(env, -2));
@@ -210,8 +262,7 @@ Napi::Value AmsiScanFile(const Napi::CallbackInfo& info) {
     args.Set((uint32_t)1, Napi::String::New(env, filename));
 
     // Reconstruct CallbackInfo is not possible, so we duplicate the logic
-    // Check AMSI initialization
-    if (!IsAmsiInitialized()) {
+    if (!IsAmsiInitialized() && !AwaitNativeProvider("amsi")) {
         if (!InitializeAmsi()) {
             Napi::Object result = Napi::Object::New(env);
             result.Set("clean", Napi::Boolean::New(env, false));
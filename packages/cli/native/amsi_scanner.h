@@ -62,8 +62,8 @@ enum class AmsiResult : int32_t {
 // ============================================================================
 
 /**
- * Initialize AMSI context.
- * Call once at module load.
+ * Initialize AMSI context. Thread-safe; runs on the background provider
+ * initializer (see provider_init.h) rather than at module load.
  *
  * @return true if initialization succeeded
  */
@@ -82,6 +82,30 @@ void UninitializeAmsi();
  */
 bool IsAmsiInitialized();
 
+// ============================================================================
+// Native Scanning
+// ============================================================================
+
+/**
+ * Open an AMSI session so the antimalware product can correlate buffers
+ * that belong together (the members of one archive). Returns nullptr if
+ * AMSI is not initialized or the session cannot be opened; scans then run
+ * without a session.
+ */
+HAMSISESSION OpenAmsiSession();
+
+/** Close a session from OpenAmsiSession(). nullptr is ignored. */
+void CloseAmsiSession(HAMSISESSION session);
+
+/**
+ * Scan a buffer for native callers. Thread-safe; AMSI must be initialized.
+ *
+ * @param contentName Origin shown to the provider, e.g. "a.zip!/run.ps1"
+ * @return false with a message if the scan itself failed
+ */
+bool AmsiScanContent(const void* data, size_t length, const std::string& contentName,
+                     HAMSISESSION session, AMSI_RESULT& result, std::string& error);
+
 // ============================================================================
 // NAPI Exports
 // ============================================================================
@@ -20,7 +20,11 @@
 #ifdef _WIN32
 
 #include "appcontainer_manager.h"
+#include "access_grants.h"
+#include "resource_governor.h"
+#include <algorithm>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 
 namespace TerminAI {
@@ -38,7 +42,8 @@ const wchar_t* const CONTAINER_DISPLAY_NAME = L"TerminAI Agent Runtime";
 const wchar_t* const CONTAINER_DESCRIPTION = L"Sandboxed environment for TerminAI agent";
 
 // Cached AppContainer SID (created once per session)
-static PSID g_appContainerSid = nullptr;
+static AppContainerSidPtr g_appContainerSid;
+static std::mutex g_profileMutex;
 
 // ============================================================================
 // Helper Functions
@@ -78,6 +83,50 @@ std::string WideToUtf8(const std::wstring& wstr) {
     return result;
 }
 
+std::wstring QuoteArgument(const std::wstring& arg) {
+    if (!arg.empty() && arg.find_first_of(L" \t\n\v\"") == std::wstring::npos) return arg;
+
+    std::wstring quoted = L"\"";
+    for (auto it = arg.begin();; ++it) {
+        size_t backslashes = 0;
+        while (it != arg.end() && *it == L'\\') {
+            ++it;
+            ++backslashes;
+        }
+        if (it == arg.end()) {
+            quoted.append(backslashes * 2, L'\\');
+            break;
+        }
+        quoted.append(*it == L'"' ? backslashes * 2 + 1 : backslashes, L'\\');
+        quoted.push_back(*it);
+    }
+    quoted.push_back(L'"');
+    return quoted;
+}
+
+std::wstring BuildEnvironmentBlock(const Napi::Object& env) {
+    std::vector<std::wstring> entries;
+    Napi::Array names = env.GetPropertyNames();
+    for (uint32_t i = 0; i < names.Length(); i++) {
+        Napi::Value name = names.Get(i);
+        Napi::Value value = env.Get(name);
+        if (!value.IsString()) continue;
+        entries.push_back(Utf8ToWide(name.As<Napi::String>().Utf8Value() + "=" +
+                                     value.As<Napi::String>().Utf8Value()));
+    }
+    std::sort(entries.begin(), entries.end(), [](const std::wstring& a, const std::wstring& b) {
+        return _wcsicmp(a.c_str(), b.c_str()) < 0;
+    });
+
+    std::wstring block;
+    for (const auto& entry : entries) {
+        block += entry;
+        block.push_back(L'\0');
+    }
+    block.push_back(L'\0');
+    return block;
+}
+
 std::string GetWindowsErrorMessage(DWORD error) {
     LPWSTR buffer = nullptr;
     DWORD size = FormatMessageW(
@@ -115,201 +164,205 @@ bool GrantWorkspaceAccess(const std::wstring& workspacePath, PSID appContainerSi
         return false;
     }
 
-    // Convert SID to string for logging
     LPWSTR sidString = nullptr;
-    if (ConvertSidToStringSidW(appContainerSid, &sidString)) {
-        std::wcout << L"[AppContainerManager] Granting access to " << sidString
-                   << L" on " << workspacePath << std::endl;
-    }
-
-    // Set up EXPLICIT_ACCESS structure
-    EXPLICIT_ACCESS_W ea = {};
-    ea.grfAccessPermissions = GENERIC_READ | GENERIC_WRITE | GENERIC_EXECUTE;
-    ea.grfAccessMode = GRANT_ACCESS;
-    ea.grfInheritance = SUB_CONTAINERS_AND_OBJECTS_INHERIT;
-    ea.Trustee.TrusteeForm = TRUSTEE_IS_SID;
-    ea.Trustee.TrusteeType = TRUSTEE_IS_WELL_KNOWN_GROUP;
-    ea.Trustee.ptstrName = (LPWSTR)appContainerSid;
-
-    // Get existing DACL
-    PACL pOldDacl = nullptr;
-    PSECURITY_DESCRIPTOR pSD = nullptr;
-    DWORD result = GetNamedSecurityInfoW(
-        workspacePath.c_str(),
-        SE_FILE_OBJECT,
-        DACL_SECURITY_INFORMATION,
-        nullptr, nullptr,
-        &pOldDacl,
-        nullptr,
-        &pSD
-    );
-
-    if (result != ERROR_SUCCESS) {
-        std::cerr << "[AppContainerManager] GetNamedSecurityInfo failed: "
-                  << GetWindowsErrorMessage(result) << std::endl;
-        if (sidString) LocalFree(sidString);
+    if (!ConvertSidToStringSidW(appContainerSid, &sidString)) {
+        std::cerr << "[AppContainerManager] ConvertSidToStringSid failed: "
+                  << GetWindowsErrorMessage(GetLastError()) << std::endl;
         return false;
     }
 
-    // Create new DACL with AppContainer access
-    PACL pNewDacl = nullptr;
-    result = SetEntriesInAclW(1, &ea, pOldDacl, &pNewDacl);
+    // Read, write and execute on the whole workspace, inherited by new files.
+    // The engine only writes entries that lack the ACE, and a warm launch
+    // whose workspace root is unchanged skips ACL work entirely.
+    AccessGrant grant;
+    grant.path = WideToUtf8(workspacePath);
+    grant.principal = WideToUtf8(sidString);
+    grant.rights = AccessRead | AccessWrite | AccessExecute;
+    grant.recursive = true;
+    LocalFree(sidString);
 
-    if (result != ERROR_SUCCESS) {
-        std::cerr << "[AppContainerManager] SetEntriesInAcl failed: "
-                  << GetWindowsErrorMessage(result) << std::endl;
-        if (pSD) LocalFree(pSD);
-        if (sidString) LocalFree(sidString);
+    AccessGrantResult result;
+    std::string error;
+    if (!ApplyAccessGrant(grant, result, error)) {
+        std::cerr << "[AppContainerManager] " << error << std::endl;
         return false;
     }
 
-    // Apply new DACL
-    result = SetNamedSecurityInfoW(
-        (LPWSTR)workspacePath.c_str(),
-        SE_FILE_OBJECT,
-        DACL_SECURITY_INFORMATION,
-        nullptr, nullptr,
-        pNewDacl,
-        nullptr
-    );
-
-    // Cleanup
-    if (pNewDacl) LocalFree(pNewDacl);
-    if (pSD) LocalFree(pSD);
-    if (sidString) LocalFree(sidString);
-
-    if (result != ERROR_SUCCESS) {
-        std::cerr << "[AppContainerManager] SetNamedSecurityInfo failed: "
-                  << GetWindowsErrorMessage(result) << std::endl;
-        return false;
+    if (!result.cached) {
+        std::cout << "[AppContainerManager] Workspace access verified: " << result.checked
+                  << " checked, " << result.granted << " granted, " << result.failed
+                  << " failed" << std::endl;
     }
-
-    std::cout << "[AppContainerManager] Workspace access granted successfully" << std::endl;
     return true;
 }
 
 // ============================================================================
-// Main NAPI Export: CreateAppContainerSandbox
+// Profile
 // ============================================================================
 
-Napi::Value CreateAppContainerSandbox(const Napi::CallbackInfo& info) {
-    Napi::Env env = info.Env();
+AppContainerSidPtr OpenAppContainerProfile(const std::wstring& name,
+                                           const std::wstring& displayName, std::string& error) {
+    PSID sid = nullptr;
+    HRESULT hr = CreateAppContainerProfile(
+        name.c_str(),
+        displayName.c_str(),
+        CONTAINER_DESCRIPTION,
+        nullptr, 0,  // Capabilities added separately
+        &sid
+    );
 
-    // Validate arguments
-    if (info.Length() < 2 || !info[0].IsString() || !info[1].IsString()) {
-        return Napi::Number::New(env, static_cast<int32_t>(AppContainerError::InvalidArguments));
+    if (hr == HRESULT_FROM_WIN32(ERROR_ALREADY_EXISTS)) {
+        // Profile already exists, derive the SID
+        hr = DeriveAppContainerSidFromAppContainerName(name.c_str(), &sid);
     }
 
-    std::string commandLineUtf8 = info[0].As<Napi::String>().Utf8Value();
-    std::string workspacePathUtf8 = info[1].As<Napi::String>().Utf8Value();
-    bool enableInternet = info.Length() > 2 && info[2].IsBoolean()
-        ? info[2].As<Napi::Boolean>().Value()
-        : true; // Default: enable internet for LLM access
-
-    std::wstring commandLine = Utf8ToWide(commandLineUtf8);
-    std::wstring workspacePath = Utf8ToWide(workspacePathUtf8);
-
-    // ========================================================================
-    // Step 1: Create or Get AppContainer Profile
-    // ========================================================================
+    if (FAILED(hr)) {
+        std::ostringstream message;
+        message << "Failed to create/get profile " << WideToUtf8(name) << ": 0x" << std::hex << hr;
+        error = message.str();
+        return nullptr;
+    }
+    return AppContainerSidPtr(sid, [](void* owned) { FreeSid(owned); });
+}
 
-    if (g_appContainerSid == nullptr) {
-        HRESULT hr = CreateAppContainerProfile(
-            CONTAINER_PROFILE_NAME,
-            CONTAINER_DISPLAY_NAME,
-            CONTAINER_DESCRIPTION,
-            nullptr, 0,  // Capabilities added separately
-            &g_appContainerSid
-        );
-
-        if (FAILED(hr)) {
-            if (hr == HRESULT_FROM_WIN32(ERROR_ALREADY_EXISTS)) {
-                // Profile already exists, derive the SID
-                hr = DeriveAppContainerSidFromAppContainerName(
-                    CONTAINER_PROFILE_NAME,
-                    &g_appContainerSid
-                );
-            }
+AppContainerSidPtr EnsureAppContainerProfile() {
+    std::lock_guard<std::mutex> lock(g_profileMutex);
+    if (g_appContainerSid != nullptr) {
+        return g_appContainerSid;
+    }
 
-            if (FAILED(hr)) {
-                std::cerr << "[AppContainerManager] Failed to create/get profile: 0x"
-                          << std::hex << hr << std::endl;
-                return Napi::Number::New(env, static_cast<int32_t>(AppContainerError::ProfileCreationFailed));
-            }
-        }
+    std::string error;
+    g_appContainerSid = OpenAppContainerProfile(CONTAINER_PROFILE_NAME, CONTAINER_DISPLAY_NAME, error);
+    if (!g_appContainerSid) {
+        std::cerr << "[AppContainerManager] " << error << std::endl;
     }
+    return g_appContainerSid;
+}
 
-    // ========================================================================
-    // Step 2: Grant Workspace Directory Access (CRITICAL!)
-    // ========================================================================
+bool RemoveAppContainerProfile(const std::wstring& name) {
+    HRESULT hr = ::DeleteAppContainerProfile(name.c_str());
+    return SUCCEEDED(hr) || hr == HRESULT_FROM_WIN32(ERROR_NOT_FOUND);
+}
 
-    if (!GrantWorkspaceAccess(workspacePath, g_appContainerSid)) {
-        return Napi::Number::New(env, static_cast<int32_t>(AppContainerError::AclFailure));
-    }
+// ============================================================================
+// Launcher
+// ============================================================================
 
-    // ========================================================================
-    // Step 3: Define Capabilities
-    // ========================================================================
+AppContainerError LaunchAppContainerProcess(const AppContainerLaunch& launch,
+                                            PROCESS_INFORMATION& process) {
+    // Every sandbox runs in a kill-on-close Job Object (plus any resource
+    // limits): the process is created suspended and assigned to the job
+    // before it runs any code, so nothing it spawns can escape teardown.
+    // Session launches share the session's job instead.
+    GovernedGroupPtr group = launch.group;
+    if (!group) {
+        std::vector<std::string> unsupported;
+        std::string groupError;
+        group = CreateGovernedGroup(launch.limits, unsupported, groupError);
+        if (!group) {
+            std::cerr << "[AppContainerManager] " << groupError << std::endl;
+            return AppContainerError::ResourceError;
+        }
+        for (const auto& name : unsupported) {
+            std::cerr << "[AppContainerManager] Limit not supported by Job Objects: " << name
+                      << std::endl;
+        }
+    }
 
+    SECURITY_CAPABILITIES secCaps = {};
+    // Held until the process is created, whoever deletes the profile meanwhile.
+    AppContainerSidPtr appContainerSid;
     std::vector<SID_AND_ATTRIBUTES> capabilities;
     PSID internetClientSid = nullptr;
     PSID privateNetworkSid = nullptr;
+    auto freeCapabilitySids = [&]() {
+        if (internetClientSid) LocalFree(internetClientSid);
+        if (privateNetworkSid) LocalFree(privateNetworkSid);
+    };
 
-    if (enableInternet) {
-        // S-1-15-3-1 = internetClient capability (REQUIRED for LLM API calls)
-        if (ConvertStringSidToSidW(CAPABILITY_INTERNET_CLIENT, &internetClientSid)) {
-            capabilities.push_back({ internetClientSid, SE_GROUP_ENABLED });
-        } else {
-            std::cerr << "[AppContainerManager] Failed to convert internetClient SID" << std::endl;
-            return Napi::Number::New(env, static_cast<int32_t>(AppContainerError::CapabilityError));
+    if (launch.isolate) {
+        // ====================================================================
+        // Step 1: Create or Get AppContainer Profile
+        // ====================================================================
+
+        appContainerSid = launch.appContainerSid ? launch.appContainerSid
+                                                 : EnsureAppContainerProfile();
+        if (appContainerSid == nullptr) {
+            return AppContainerError::ProfileCreationFailed;
         }
 
-        // S-1-15-3-3 = privateNetworkClientServer (for local MCP servers)
-        if (ConvertStringSidToSidW(CAPABILITY_PRIVATE_NETWORK, &privateNetworkSid)) {
-            capabilities.push_back({ privateNetworkSid, SE_GROUP_ENABLED });
+        // ====================================================================
+        // Step 2: Grant Workspace Directory Access (CRITICAL!)
+        // ====================================================================
+
+        if (!GrantWorkspaceAccess(launch.workspacePath, appContainerSid.get())) {
+            return AppContainerError::AclFailure;
         }
-    }
 
-    // ========================================================================
-    // Step 4: Prepare SECURITY_CAPABILITIES Structure
-    // ========================================================================
+        // ====================================================================
+        // Step 3: Define Capabilities
+        // ====================================================================
+
+        if (launch.enableInternet) {
+            // S-1-15-3-1 = internetClient capability (REQUIRED for LLM API calls)
+            if (ConvertStringSidToSidW(CAPABILITY_INTERNET_CLIENT, &internetClientSid)) {
+                capabilities.push_back({ internetClientSid, SE_GROUP_ENABLED });
+            } else {
+                std::cerr << "[AppContainerManager] Failed to convert internetClient SID" << std::endl;
+                return AppContainerError::CapabilityError;
+            }
 
-    SECURITY_CAPABILITIES secCaps = {};
-    secCaps.AppContainerSid = g_appContainerSid;
-    secCaps.Capabilities = capabilities.empty() ? nullptr : capabilities.data();
-    secCaps.CapabilityCount = static_cast<DWORD>(capabilities.size());
+            // S-1-15-3-3 = privateNetworkClientServer (for local MCP servers)
+            if (ConvertStringSidToSidW(CAPABILITY_PRIVATE_NETWORK, &privateNetworkSid)) {
+                capabilities.push_back({ privateNetworkSid, SE_GROUP_ENABLED });
+            }
+        }
+
+        // ====================================================================
+        // Step 4: Prepare SECURITY_CAPABILITIES Structure
+        // ====================================================================
+
+        secCaps.AppContainerSid = appContainerSid.get();
+        secCaps.Capabilities = capabilities.empty() ? nullptr : capabilities.data();
+        secCaps.CapabilityCount = static_cast<DWORD>(capabilities.size());
+    }
 
     // ========================================================================
     // Step 5: Prepare Extended Startup Info with Attribute List
     // ========================================================================
 
+    DWORD attributeCount = (launch.isolate ? 1 : 0) + (launch.pseudoConsole ? 1 : 0);
     SIZE_T attrListSize = 0;
-    InitializeProcThreadAttributeList(nullptr, 1, 0, &attrListSize);
+    InitializeProcThreadAttributeList(nullptr, attributeCount, 0, &attrListSize);
 
     std::vector<BYTE> attrListBuffer(attrListSize);
     LPPROC_THREAD_ATTRIBUTE_LIST attrList =
         reinterpret_cast<LPPROC_THREAD_ATTRIBUTE_LIST>(attrListBuffer.data());
 
-    if (!InitializeProcThreadAttributeList(attrList, 1, 0, &attrListSize)) {
+    if (!InitializeProcThreadAttributeList(attrList, attributeCount, 0, &attrListSize)) {
         std::cerr << "[AppContainerManager] InitializeProcThreadAttributeList failed: "
                   << GetWindowsErrorMessage(GetLastError()) << std::endl;
-        if (internetClientSid) LocalFree(internetClientSid);
-        if (privateNetworkSid) LocalFree(privateNetworkSid);
-        return Napi::Number::New(env, static_cast<int32_t>(AppContainerError::ProcessCreationFailed));
+        freeCapabilitySids();
+        return AppContainerError::ProcessCreationFailed;
     }
 
-    if (!UpdateProcThreadAttribute(
-        attrList, 0,
-        PROC_THREAD_ATTRIBUTE_SECURITY_CAPABILITIES,
-        &secCaps, sizeof(secCaps),
-        nullptr, nullptr
-    )) {
+    if ((launch.isolate &&
+         !UpdateProcThreadAttribute(
+             attrList, 0,
+             PROC_THREAD_ATTRIBUTE_SECURITY_CAPABILITIES,
+             &secCaps, sizeof(secCaps),
+             nullptr, nullptr)) ||
+        (launch.pseudoConsole &&
+         !UpdateProcThreadAttribute(
+             attrList, 0,
+             PROC_THREAD_ATTRIBUTE_PSEUDOCONSOLE,
+             launch.pseudoConsole, sizeof(launch.pseudoConsole),
+             nullptr, nullptr))) {
         std::cerr << "[AppContainerManager] UpdateProcThreadAttribute failed: "
                   << GetWindowsErrorMessage(GetLastError()) << std::endl;
         DeleteProcThreadAttributeList(attrList);
-        if (internetClientSid) LocalFree(internetClientSid);
-        if (privateNetworkSid) LocalFree(privateNetworkSid);
-        return Napi::Number::New(env, static_cast<int32_t>(AppContainerError::ProcessCreationFailed));
+        freeCapabilitySids();
+        return AppContainerError::ProcessCreationFailed;
     }
 
     // ========================================================================
@@ -319,21 +372,29 @@ Napi::Value CreateAppContainerSandbox(const Napi::CallbackInfo& info) {
     STARTUPINFOEXW si = {};
     si.StartupInfo.cb = sizeof(si);
     si.lpAttributeList = attrList;
+    if (launch.pseudoConsole) {
+        // Without this the child inherits our std handles instead of the
+        // pseudoconsole's.
+        si.StartupInfo.dwFlags = STARTF_USESTDHANDLES;
+    }
 
     PROCESS_INFORMATION pi = {};
 
     // Make command line mutable for CreateProcessW
-    std::vector<wchar_t> cmdLine(commandLine.begin(), commandLine.end());
+    std::vector<wchar_t> cmdLine(launch.commandLine.begin(), launch.commandLine.end());
     cmdLine.push_back(L'\0');
 
+    const std::wstring& cwd = launch.cwd.empty() ? launch.workspacePath : launch.cwd;
+
     BOOL success = CreateProcessW(
         nullptr,
         cmdLine.data(),
         nullptr, nullptr,
         FALSE,
-        EXTENDED_STARTUPINFO_PRESENT | CREATE_UNICODE_ENVIRONMENT | CREATE_NEW_CONSOLE,
-        nullptr,
-        workspacePath.c_str(),
+        EXTENDED_STARTUPINFO_PRESENT | CREATE_UNICODE_ENVIRONMENT | CREATE_SUSPENDED |
+            (launch.pseudoConsole ? 0 : CREATE_NEW_CONSOLE),
+        launch.environment.empty() ? nullptr : const_cast<wchar_t*>(launch.environment.c_str()),
+        cwd.empty() ? nullptr : cwd.c_str(),
         reinterpret_cast<LPSTARTUPINFOW>(&si),
         &pi
     );
@@ -343,13 +404,60 @@ Napi::Value CreateAppContainerSandbox(const Napi::CallbackInfo& info) {
     // ========================================================================
 
     DeleteProcThreadAttributeList(attrList);
-    if (internetClientSid) LocalFree(internetClientSid);
-    if (privateNetworkSid) LocalFree(privateNetworkSid);
+    freeCapabilitySids();
 
     if (!success) {
         std::cerr << "[AppContainerManager] CreateProcessW failed: "
                   << GetWindowsErrorMessage(GetLastError()) << std::endl;
-        return Napi::Number::New(env, static_cast<int32_t>(AppContainerError::ProcessCreationFailed));
+        return AppContainerError::ProcessCreationFailed;
+    }
+
+    if (!AssignProcessToJobObject(GovernedGroupJob(*group), pi.hProcess)) {
+        std::cerr << "[AppContainerManager] AssignProcessToJobObject failed: "
+                  << GetWindowsErrorMessage(GetLastError()) << std::endl;
+        TerminateProcess(pi.hProcess, 1);
+        CloseHandle(pi.hThread);
+        CloseHandle(pi.hProcess);
+        return AppContainerError::ResourceError;
+    }
+    RegisterGovernedProcess(pi.dwProcessId, std::move(group));
+    ResumeThread(pi.hThread);
+
+    process = pi;
+    return AppContainerError::Success;
+}
+
+// ============================================================================
+// Main NAPI Export: CreateAppContainerSandbox
+// ============================================================================
+
+Napi::Value CreateAppContainerSandbox(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    // Validate arguments
+    if (info.Length() < 2 || !info[0].IsString() || !info[1].IsString()) {
+        return Napi::Number::New(env, static_cast<int32_t>(AppContainerError::InvalidArguments));
+    }
+
+    AppContainerLaunch launch;
+    launch.commandLine = Utf8ToWide(info[0].As<Napi::String>().Utf8Value());
+    launch.workspacePath = Utf8ToWide(info[1].As<Napi::String>().Utf8Value());
+    launch.enableInternet = info.Length() > 2 && info[2].IsBoolean()
+        ? info[2].As<Napi::Boolean>().Value()
+        : true; // Default: enable internet for LLM access
+
+    if (info.Length() > 3 && info[3].IsObject()) {
+        std::string error;
+        if (!ParseResourceLimits(info[3].As<Napi::Object>(), launch.limits, error)) {
+            std::cerr << "[AppContainerManager] Invalid resources: " << error << std::endl;
+            return Napi::Number::New(env, static_cast<int32_t>(AppContainerError::InvalidArguments));
+        }
+    }
+
+    PROCESS_INFORMATION pi = {};
+    AppContainerError result = LaunchAppContainerProcess(launch, pi);
+    if (result != AppContainerError::Success) {
+        return Napi::Number::New(env, static_cast<int32_t>(result));
     }
 
     // Close handles we don't need (the process continues running)
@@ -397,16 +505,15 @@ Napi::Value GetAppContainerSid(const Napi::CallbackInfo& info) {
 Napi::Value DeleteAppContainerProfile(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
 
-    HRESULT hr = DeleteAppContainerProfile(CONTAINER_PROFILE_NAME);
+    bool removed = RemoveAppContainerProfile(CONTAINER_PROFILE_NAME);
 
-    // Clear cached SID
-    if (g_appContainerSid != nullptr) {
-        FreeSid(g_appContainerSid);
-        g_appContainerSid = nullptr;
-    }
+    // Clear the cached SID. Launches in flight hold their own reference, and
+    // session profiles (sandbox_registry.h) are not affected.
+    std::lock_guard<std::mutex> lock(g_profileMutex);
+    g_appContainerSid.reset();
 
     // Success or profile didn't exist
-    return Napi::Boolean::New(env, SUCCEEDED(hr) || hr == HRESULT_FROM_WIN32(ERROR_NOT_FOUND));
+    return Napi::Boolean::New(env, removed);
 }
 
 } // namespace TerminAI
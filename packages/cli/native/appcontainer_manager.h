@@ -31,6 +31,8 @@
 #include <vector>
 #include <memory>
 
+#include "resource_governor.h"
+
 // Linker pragmas (safety net if binding.gyp fails to link)
 #pragma comment(lib, "Userenv.lib")
 #pragma comment(lib, "Advapi32.lib")
@@ -92,8 +94,74 @@ enum class AppContainerError : int32_t {
   ProcessCreationFailed = -3,
   InvalidArguments = -4,
   CapabilityError = -5,
+  ResourceError = -6,
+};
+
+// ============================================================================
+// Profiles
+// ============================================================================
+
+/** An AppContainer SID, freed with FreeSid when the last holder drops it. */
+using AppContainerSidPtr = std::shared_ptr<void>;
+
+/**
+ * Create the TerminAI profile, or derive its SID if it already exists. The
+ * SID is cached for the session; launches and background provider
+ * initialization share it, and a launch keeps its reference even if
+ * deleteAppContainerProfile() runs meanwhile.
+ *
+ * @return The cached SID, or null on failure
+ */
+AppContainerSidPtr EnsureAppContainerProfile();
+
+/**
+ * Create (or open, if it exists) a profile with its own name and SID, as
+ * sandbox sessions (sandbox_registry.h) do. Not cached.
+ *
+ * @return null with a message on failure
+ */
+AppContainerSidPtr OpenAppContainerProfile(const std::wstring& name,
+                                           const std::wstring& displayName, std::string& error);
+
+/**
+ * Delete a profile by name.
+ *
+ * @return true if deleted or it did not exist
+ */
+bool RemoveAppContainerProfile(const std::wstring& name);
+
+// ============================================================================
+// Launcher
+// ============================================================================
+
+struct AppContainerLaunch {
+    std::wstring commandLine;
+    std::wstring workspacePath;
+    /** Working directory (default: workspacePath) */
+    std::wstring cwd;
+    /** CREATE_UNICODE_ENVIRONMENT block (empty = inherit) */
+    std::wstring environment;
+    bool enableInternet = true;
+    ResourceLimits limits;
+    /** Attach to this pseudoconsole instead of a new console window */
+    HPCON pseudoConsole = nullptr;
+    /** false = host process: no AppContainer, but still in a Job Object */
+    bool isolate = true;
+    /** Profile to run in (null = the TerminAI profile) */
+    AppContainerSidPtr appContainerSid;
+    /** Job Object to join, shared with other processes (null = a new one with `limits`) */
+    GovernedGroupPtr group;
 };
 
+/**
+ * Create the process (suspended), put it in its kill-on-close Job Object,
+ * register the job with the resource governor, and resume it.
+ *
+ * @param process Receives the process and thread handles (caller closes)
+ */
+AppContainerError LaunchAppContainerProcess(const AppContainerLaunch& launch,
+                                            PROCESS_INFORMATION& process);
+
 // ============================================================================
 // NAPI Exports
 // ============================================================================
@@ -105,6 +173,9 @@ enum class AppContainerError : int32_t {
  *   0: String - Command line (e.g., "node.exe agent.js")
  *   1: String - Workspace path (e.g., "C:\\Users\\Me\\.terminai\\workspace")
  *   2: Boolean (optional) - Enable internet access (default: true)
+ *   3: Object (optional) - Resource limits { cpuWeight?, cpuQuotaPercent?,
+ *      memoryMax?, pidsMax? }; the process runs in a Job Object that
+ *      enforces them (see resource_governor.h)
  *
  * Returns: Number
  *   - Positive: Process ID of spawned process
@@ -114,6 +185,7 @@ enum class AppContainerError : int32_t {
  *     -3: Process creation failed
  *     -4: Invalid arguments
  *     -5: Capability error
+ *     -6: Resource error (Job Object could not be created or assigned)
  *
  * @see architecture-sovereign-runtime.md Appendix M.6.1
  */
@@ -146,6 +218,8 @@ Napi::Value DeleteAppContainerProfile(const Napi::CallbackInfo& info);
 /**
  * Grant file system ACLs to AppContainer SID on a directory.
  * Without this, sandboxed process cannot read/write to workspace.
+ * Goes through the access grant engine (access_grants.h), so entries that
+ * already carry the ACE are not rewritten.
  *
  * @param workspacePath Path to directory to grant access
  * @param appContainerSid SID of the AppContainer profile
@@ -164,6 +238,17 @@ bool GrantWorkspaceAccess(const std::wstring& workspacePath, PSID appContainerSi
  */
 bool IsPathAccessible(const std::wstring& path, PSID sid);
 
+/**
+ * Quote one argument so that CommandLineToArgvW returns it unchanged.
+ */
+std::wstring QuoteArgument(const std::wstring& arg);
+
+/**
+ * CREATE_UNICODE_ENVIRONMENT block from an `env` option object, sorted by
+ * name as CreateProcess expects.
+ */
+std::wstring BuildEnvironmentBlock(const Napi::Object& env);
+
 /**
  * Convert UTF-8 string to UTF-16 (wstring).
  * Node.js passes UTF-8, Windows APIs want wchar_t.
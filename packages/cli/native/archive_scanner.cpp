@@ -0,0 +1,1153 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Archive Scanner Implementation
+ */
+
+#include "archive_scanner.h"
+#include "decompress.h"
+#include "mapped_file.h"
+#include "work_scheduler.h"
+#include "worker_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace TerminAI {
+
+namespace {
+
+/** Output a stream may produce before its ratio is checked. */
+constexpr uint64_t RATIO_GRACE_BYTES = 1024 * 1024;
+
+/** Tar member bytes held by scans still queued or running. */
+constexpr uint64_t MAX_INFLIGHT_BYTES = 256ull * 1024 * 1024;
+
+/** Largest GNU long name or pax header accepted. */
+constexpr uint64_t MAX_TAR_METADATA = 1024 * 1024;
+
+constexpr size_t TAR_BLOCK = 512;
+
+const char* const NESTED_SEPARATOR = "!/";
+
+enum class ArchiveFormat { None, Zip, Tar, Gzip, Zstd };
+
+uint32_t ReadLE16(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8);
+}
+
+uint32_t ReadLE32(const uint8_t* p) {
+    return ReadLE16(p) | (ReadLE16(p + 2) << 16);
+}
+
+uint64_t ReadLE64(const uint8_t* p) {
+    return static_cast<uint64_t>(ReadLE32(p)) | (static_cast<uint64_t>(ReadLE32(p + 4)) << 32);
+}
+
+// ============================================================================
+// Format Detection
+// ============================================================================
+
+bool ParseOctal(const uint8_t* field, size_t length, uint64_t& value) {
+    value = 0;
+    size_t i = 0;
+    while (i < length && (field[i] == ' ' || field[i] == 0)) i++;
+    bool digits = false;
+    for (; i < length && field[i] >= '0' && field[i] <= '7'; i++) {
+        if (value >> 60) return false;
+        value = (value << 3) | static_cast<uint64_t>(field[i] - '0');
+        digits = true;
+    }
+    return digits || i == length;
+}
+
+bool TarChecksumValid(const uint8_t* header) {
+    uint64_t expected = 0;
+    if (!ParseOctal(header + 148, 8, expected)) return false;
+    uint64_t unsignedSum = 0;
+    int64_t signedSum = 0;
+    for (size_t i = 0; i < TAR_BLOCK; i++) {
+        uint8_t byte = (i >= 148 && i < 156) ? ' ' : header[i];
+        unsignedSum += byte;
+        signedSum += static_cast<int8_t>(byte);
+    }
+    // Some old writers summed signed chars.
+    return expected == unsignedSum || static_cast<int64_t>(expected) == signedSum;
+}
+
+bool IsTarHeader(const uint8_t* data, size_t length) {
+    return length >= TAR_BLOCK && std::memcmp(data + 257, "ustar", 5) == 0 &&
+           TarChecksumValid(data);
+}
+
+ArchiveFormat DetectFormat(const uint8_t* data, size_t length) {
+    if (length >= 4 && data[0] == 'P' && data[1] == 'K' &&
+        ((data[2] == 3 && data[3] == 4) || (data[2] == 5 && data[3] == 6))) {
+        return ArchiveFormat::Zip;
+    }
+    if (length >= 3 && data[0] == 0x1F && data[1] == 0x8B && data[2] == 8) {
+        return ArchiveFormat::Gzip;
+    }
+    if (length >= 4 && ReadLE32(data) == 0xFD2FB528) return ArchiveFormat::Zstd;
+    if (IsTarHeader(data, length)) return ArchiveFormat::Tar;
+    return ArchiveFormat::None;
+}
+
+// ============================================================================
+// Scan State
+// ============================================================================
+
+/** Shared by every member of one scan, on whichever thread scans it. */
+class ScanState {
+public:
+    ScanState(ScanProvider& provider, const ArchiveScanOptions& options, uint64_t archiveBytes)
+        : limits(options.limits),
+          provider_(provider),
+          rootName_(options.name),
+          cancel_(options.cancel),
+          archiveBytes_(archiveBytes) {}
+
+    const ArchiveLimits& limits;
+
+    bool Stopped() const { return stop_.load(std::memory_order_relaxed); }
+
+    /** Stopped(), after polling the cancel token. */
+    bool CheckStop() {
+        if (Stopped()) return true;
+        if (IsStopped(cancel_)) {
+            cancelled_ = true;
+            stop_ = true;
+        }
+        return Stopped();
+    }
+
+    bool Cancelled() const { return cancelled_.load(); }
+
+    /** A member's path as shown to the provider and in the result. */
+    std::string DisplayPath(const std::string& path) const {
+        return path.empty() ? rootName_ : path;
+    }
+
+    void HitLimit(const char* kind, const std::string& path, const std::string& detail) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (result_.limitKind.empty()) {
+            result_.limitKind = kind;
+            result_.limitPath = DisplayPath(path);
+            result_.limitDetail = detail;
+        }
+        stop_ = true;
+    }
+
+    void Skip(const std::string& path, const std::string& reason) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        result_.unscanned.push_back({DisplayPath(path), reason});
+    }
+
+    void Fail(const std::string& error) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (error_.empty()) error_ = error;
+        stop_ = true;
+    }
+
+    /** Count a member; false (and stop) past maxEntries. */
+    bool CountEntry(const std::string& path) {
+        uint64_t count = entries_.fetch_add(1) + 1;
+        if (count > limits.maxEntries) {
+            HitLimit("entries", path, "more than " + std::to_string(limits.maxEntries) + " members");
+            return false;
+        }
+        return true;
+    }
+
+    void AddCompressed(uint64_t bytes) { compressedBytes_ += bytes; }
+
+    /** Account decoded output against the archive-wide limits. */
+    bool AddOutput(uint64_t bytes, const std::string& path) {
+        uint64_t total = totalOutput_.fetch_add(bytes) + bytes;
+        if (total > limits.maxTotalBytes) {
+            HitLimit("totalSize", path,
+                     "more than " + std::to_string(limits.maxTotalBytes) + " bytes decompressed");
+            return false;
+        }
+        if (total > RATIO_GRACE_BYTES &&
+            static_cast<double>(total) > limits.maxRatio * static_cast<double>(std::max<uint64_t>(archiveBytes_, 1))) {
+            HitLimit("ratio", path,
+                     "archive expands past " + FormatRatio(limits.maxRatio) + "x its size");
+            return false;
+        }
+        return true;
+    }
+
+    void Scan(const std::string& path, const uint8_t* data, size_t length) {
+        if (CheckStop()) return;
+        std::string name = path.empty() ? rootName_ : rootName_ + NESTED_SEPARATOR + path;
+        ScanVerdict verdict;
+        std::string error;
+        if (!provider_.Scan(data, length, name, verdict, error)) {
+            Fail(error);
+            return;
+        }
+        scannedEntries_++;
+        scannedBytes_ += length;
+        if (!verdict.clean) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            result_.threats.push_back({DisplayPath(path), verdict.result, verdict.description});
+        }
+    }
+
+    static std::string FormatRatio(double ratio) {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%g", ratio);
+        return buffer;
+    }
+
+    /** Move the findings into `out`; false with the error that stopped the scan. */
+    bool Collect(ArchiveScanResult& out, std::string& error) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        out.entries = std::min(entries_.load(), limits.maxEntries);
+        out.scannedEntries = scannedEntries_.load();
+        out.scannedBytes = scannedBytes_.load();
+        out.compressedBytes = compressedBytes_.load();
+        out.threats = std::move(result_.threats);
+        out.unscanned = std::move(result_.unscanned);
+        out.limitKind = std::move(result_.limitKind);
+        out.limitPath = std::move(result_.limitPath);
+        out.limitDetail = std::move(result_.limitDetail);
+
+        // Members finish in any order; report them in path order.
+        std::sort(out.threats.begin(), out.threats.end(),
+                  [](const ArchiveThreat& a, const ArchiveThreat& b) { return a.path < b.path; });
+        std::sort(out.unscanned.begin(), out.unscanned.end(),
+                  [](const ArchiveSkipped& a, const ArchiveSkipped& b) { return a.path < b.path; });
+
+        if (!error_.empty()) {
+            error = error_;
+            return false;
+        }
+        if (cancelled_) {
+            error = CancelReasonMessage(cancel_->Outcome());
+            return false;
+        }
+        return true;
+    }
+
+private:
+    ScanProvider& provider_;
+    std::string rootName_;
+    CancelToken* cancel_;
+    uint64_t archiveBytes_;
+
+    std::atomic<bool> stop_{false};
+    std::atomic<bool> cancelled_{false};
+    std::atomic<uint64_t> entries_{0};
+    std::atomic<uint64_t> scannedEntries_{0};
+    std::atomic<uint64_t> scannedBytes_{0};
+    std::atomic<uint64_t> compressedBytes_{0};
+    std::atomic<uint64_t> totalOutput_{0};
+
+    std::mutex mutex_;
+    ArchiveScanResult result_;
+    std::string error_;
+};
+
+/**
+ * Enforces one stream's limits (its size and expansion ratio) and the
+ * archive-wide ones before passing output on.
+ */
+class LimitedSink {
+public:
+    LimitedSink(ScanState& state, std::string path, uint64_t compressed, uint64_t maxOutput,
+                ByteSink next)
+        : state_(state),
+          path_(std::move(path)),
+          compressed_(std::max<uint64_t>(compressed, 1)),
+          maxOutput_(maxOutput),
+          next_(std::move(next)) {}
+
+    bool operator()(const uint8_t* data, size_t length) {
+        if (state_.CheckStop()) return false;
+        produced_ += length;
+        if (produced_ > maxOutput_) {
+            state_.HitLimit("entrySize", path_,
+                            "decompresses past " + std::to_string(maxOutput_) + " bytes");
+            return false;
+        }
+        if (produced_ > RATIO_GRACE_BYTES &&
+            static_cast<double>(produced_) > state_.limits.maxRatio * static_cast<double>(compressed_)) {
+            state_.HitLimit("ratio", path_,
+                            "expands past " + ScanState::FormatRatio(state_.limits.maxRatio) +
+                                "x its compressed size");
+            return false;
+        }
+        if (!state_.AddOutput(length, path_)) return false;
+        return next_(data, length);
+    }
+
+private:
+    ScanState& state_;
+    std::string path_;
+    uint64_t compressed_;
+    uint64_t maxOutput_;
+    ByteSink next_;
+    uint64_t produced_ = 0;
+};
+
+std::string NestedPrefix(const std::string& containerPath) {
+    return containerPath.empty() ? std::string() : containerPath + NESTED_SEPARATOR;
+}
+
+void ScanMember(ScanState& state, const std::string& path, const uint8_t* data, size_t length,
+                uint32_t depth);
+
+std::string ScanContainer(ScanState& state, ArchiveFormat format, const uint8_t* data,
+                          size_t length, const std::string& containerPath, uint32_t depth);
+
+// ============================================================================
+// Tar
+// ============================================================================
+
+/**
+ * Streaming tar reader: fed the archive in arbitrary chunks, it hands each
+ * complete regular file to the pool for scanning.
+ */
+class TarReader {
+public:
+    TarReader(ScanState& state, std::string prefix, uint32_t depth, WaitGroup& group)
+        : state_(state), prefix_(std::move(prefix)), depth_(depth), group_(group) {}
+
+    bool Feed(const uint8_t* data, size_t length) {
+        while (length > 0 && !state_.Stopped()) {
+            size_t n = 0;
+            switch (stage_) {
+                case Stage::Header:
+                    n = std::min(TAR_BLOCK - fill_, length);
+                    std::memcpy(header_ + fill_, data, n);
+                    fill_ += n;
+                    if (fill_ == TAR_BLOCK) {
+                        fill_ = 0;
+                        ParseHeader();
+                    }
+                    break;
+                case Stage::Body:
+                    n = static_cast<size_t>(std::min<uint64_t>(remaining_, length));
+                    if (kind_ != Kind::Skip) body_.insert(body_.end(), data, data + n);
+                    remaining_ -= n;
+                    if (remaining_ == 0) {
+                        FinishMember();
+                        stage_ = padding_ > 0 ? Stage::Padding : Stage::Header;
+                    }
+                    break;
+                case Stage::Padding:
+                    n = static_cast<size_t>(std::min<uint64_t>(padding_, length));
+                    padding_ -= n;
+                    if (padding_ == 0) stage_ = Stage::Header;
+                    break;
+                case Stage::Done:
+                    // Whatever follows the end-of-archive blocks is ignored.
+                    return true;
+            }
+            data += n;
+            length -= n;
+        }
+        return !state_.Stopped();
+    }
+
+    /** Report a stream that ended inside a header or member. */
+    void Finish() {
+        if (state_.Stopped()) return;
+        if (stage_ == Stage::Body && kind_ == Kind::File) {
+            state_.Skip(prefix_ + path_, "truncated tar member");
+        } else if (stage_ == Stage::Header && fill_ > 0) {
+            state_.Skip(prefix_ + path_, "truncated tar header");
+        }
+    }
+
+private:
+    enum class Stage { Header, Body, Padding, Done };
+    enum class Kind { Skip, File, LongName, Pax };
+
+    void ParseHeader() {
+        bool zero = std::all_of(header_, header_ + TAR_BLOCK, [](uint8_t b) { return b == 0; });
+        if (zero) {
+            if (++zeroBlocks_ == 2) stage_ = Stage::Done;
+            return;
+        }
+        zeroBlocks_ = 0;
+
+        uint64_t size = 0;
+        if (!TarChecksumValid(header_) || !ParseSize(size)) {
+            state_.Skip(prefix_ + path_, "corrupt tar header");
+            stage_ = Stage::Done;
+            return;
+        }
+
+        char type = static_cast<char>(header_[156]);
+        kind_ = Kind::Skip;
+        if (type == 'L' || type == 'x') {
+            if (size > MAX_TAR_METADATA) {
+                state_.Skip(prefix_ + path_, "oversized tar metadata");
+                stage_ = Stage::Done;
+                return;
+            }
+            kind_ = type == 'L' ? Kind::LongName : Kind::Pax;
+        } else if (type == '0' || type == '\0' || type == '7') {
+            path_ = !paxPath_.empty() ? paxPath_ : !longName_.empty() ? longName_ : HeaderName();
+            longName_.clear();
+            paxPath_.clear();
+            std::string path = prefix_ + path_;
+            if (!state_.CountEntry(path)) return;
+            if (size > state_.limits.maxEntryBytes) {
+                state_.HitLimit("entrySize", path, "declares " + std::to_string(size) + " bytes");
+                return;
+            }
+            kind_ = Kind::File;
+            body_.reserve(static_cast<size_t>(size));
+        } else if (type != 'g') {
+            // Directories, links and devices: a preceding long name or pax
+            // path was theirs.
+            longName_.clear();
+            paxPath_.clear();
+        }
+
+        remaining_ = size;
+        padding_ = (TAR_BLOCK - size % TAR_BLOCK) % TAR_BLOCK;
+        if (size > 0) {
+            stage_ = Stage::Body;
+        } else {
+            FinishMember();
+        }
+    }
+
+    bool ParseSize(uint64_t& size) const {
+        const uint8_t* field = header_ + 124;
+        if (field[0] & 0x80) {
+            // GNU base-256 for sizes past 8 GiB.
+            size = field[0] & 0x7F;
+            for (size_t i = 1; i < 12; i++) {
+                if (size >> 55) return false;
+                size = (size << 8) | field[i];
+            }
+            return true;
+        }
+        return ParseOctal(field, 12, size);
+    }
+
+    std::string HeaderName() const {
+        auto field = [this](size_t offset, size_t length) {
+            const char* start = reinterpret_cast<const char*>(header_ + offset);
+            return std::string(start, strnlen(start, length));
+        };
+        std::string name = field(0, 100);
+        if (std::memcmp(header_ + 257, "ustar", 5) == 0) {
+            std::string prefix = field(345, 155);
+            if (!prefix.empty()) name = prefix + "/" + name;
+        }
+        return name;
+    }
+
+    void FinishMember() {
+        switch (kind_) {
+            case Kind::LongName:
+                longName_.assign(body_.begin(), std::find(body_.begin(), body_.end(), 0));
+                break;
+            case Kind::Pax:
+                ParsePax();
+                break;
+            case Kind::File:
+                Dispatch();
+                break;
+            case Kind::Skip:
+                break;
+        }
+        body_.clear();
+        kind_ = Kind::Skip;
+    }
+
+    /** Records are "<length> <key>=<value>\n"; only path matters here. */
+    void ParsePax() {
+        size_t pos = 0;
+        while (pos < body_.size()) {
+            size_t space = pos;
+            size_t length = 0;
+            while (space < body_.size() && body_[space] >= '0' && body_[space] <= '9') {
+                length = length * 10 + (body_[space] - '0');
+                space++;
+                if (length > body_.size()) return;
+            }
+            if (space >= body_.size() || body_[space] != ' ' || length == 0 ||
+                pos + length > body_.size()) {
+                return;
+            }
+            std::string record(body_.begin() + space + 1, body_.begin() + pos + length - 1);
+            if (record.compare(0, 5, "path=") == 0) paxPath_ = record.substr(5);
+            pos += length;
+        }
+    }
+
+    void Dispatch() {
+        uint64_t size = body_.size();
+        inflight_ += size;
+        group_.Run([this, path = prefix_ + path_, body = std::move(body_), size]() {
+            ScanMember(state_, path, body.data(), body.size(), depth_);
+            inflight_ -= size;
+        });
+        body_ = std::vector<uint8_t>();
+
+        // Hold the stream back while too many members are waiting.
+        WorkerPool& pool = WorkerPool::Shared();
+        while (inflight_.load() > MAX_INFLIGHT_BYTES && !state_.Stopped()) {
+            if (!pool.RunPendingTask()) std::this_thread::yield();
+        }
+    }
+
+    ScanState& state_;
+    std::string prefix_;
+    uint32_t depth_;
+    WaitGroup& group_;
+
+    Stage stage_ = Stage::Header;
+    Kind kind_ = Kind::Skip;
+    uint8_t header_[TAR_BLOCK];
+    size_t fill_ = 0;
+    uint64_t remaining_ = 0;
+    uint64_t padding_ = 0;
+    int zeroBlocks_ = 0;
+    std::vector<uint8_t> body_;
+    std::string path_;
+    std::string longName_;
+    std::string paxPath_;
+    std::atomic<uint64_t> inflight_{0};
+};
+
+void ScanTar(ScanState& state, const uint8_t* data, size_t length,
+             const std::string& containerPath, uint32_t depth) {
+    WaitGroup group(WorkerPool::Shared());
+    TarReader reader(state, NestedPrefix(containerPath), depth, group);
+    if (reader.Feed(data, length)) reader.Finish();
+    group.Wait();
+}
+
+// ============================================================================
+// gzip / zstd Streams
+// ============================================================================
+
+/**
+ * Receives a decompressed stream: a tarball (read as it arrives) or a
+ * single member (buffered, then scanned).
+ */
+class StreamConsumer {
+public:
+    StreamConsumer(ScanState& state, std::string containerPath, uint32_t depth, WaitGroup& group)
+        : state_(state), containerPath_(std::move(containerPath)), depth_(depth), group_(group) {}
+
+    bool Feed(const uint8_t* data, size_t length) {
+        if (!decided_) {
+            content_.insert(content_.end(), data, data + length);
+            if (content_.size() < TAR_BLOCK) return true;
+            Decide();
+            if (tar_) {
+                std::vector<uint8_t> head = std::move(content_);
+                content_.clear();
+                return tar_->Feed(head.data(), head.size());
+            }
+            return CheckSize();
+        }
+        if (tar_) return tar_->Feed(data, length);
+        content_.insert(content_.end(), data, data + length);
+        return CheckSize();
+    }
+
+    /** The stream is done (or broke off): scan what it produced. */
+    void Finish(const std::string& memberName) {
+        if (state_.Stopped()) return;
+        if (!decided_) Decide();
+        if (tar_) {
+            tar_->Finish();
+            return;
+        }
+        std::string path = NestedPrefix(containerPath_) + memberName;
+        if (state_.CountEntry(path)) ScanMember(state_, path, content_.data(), content_.size(), depth_);
+    }
+
+    bool IsTar() const { return tar_ != nullptr; }
+
+private:
+    void Decide() {
+        decided_ = true;
+        if (IsTarHeader(content_.data(), content_.size())) {
+            tar_ = std::make_unique<TarReader>(state_, NestedPrefix(containerPath_), depth_, group_);
+        }
+    }
+
+    bool CheckSize() {
+        if (content_.size() <= state_.limits.maxEntryBytes) return true;
+        state_.HitLimit("entrySize", containerPath_,
+                        "decompresses past " + std::to_string(state_.limits.maxEntryBytes) + " bytes");
+        return false;
+    }
+
+    ScanState& state_;
+    std::string containerPath_;
+    uint32_t depth_;
+    WaitGroup& group_;
+    bool decided_ = false;
+    std::vector<uint8_t> content_;
+    std::unique_ptr<TarReader> tar_;
+};
+
+/** "notes.txt.gz" -> "notes.txt", "src.tgz" -> "src.tar" */
+std::string StreamMemberName(const std::string& containerName) {
+    std::string base = containerName.substr(containerName.find_last_of("/\\") + 1);
+    static const std::pair<const char*, const char*> SUFFIXES[] = {
+        {".tgz", ".tar"}, {".tzst", ".tar"}, {".gz", ""}, {".zst", ""}, {".zstd", ""},
+    };
+    for (const auto& suffix : SUFFIXES) {
+        size_t n = std::strlen(suffix.first);
+        if (base.size() > n && base.compare(base.size() - n, n, suffix.first) == 0) {
+            return base.substr(0, base.size() - n) + suffix.second;
+        }
+    }
+    return base.empty() ? "data" : base;
+}
+
+bool ScanStream(ScanState& state, ArchiveFormat format, const uint8_t* data, size_t length,
+                const std::string& containerPath, uint32_t depth) {
+    state.AddCompressed(length);
+    WaitGroup group(WorkerPool::Shared());
+    StreamConsumer consumer(state, containerPath, depth, group);
+    LimitedSink limited(state, state.DisplayPath(containerPath), length,
+                        std::numeric_limits<uint64_t>::max(),
+                        [&consumer](const uint8_t* chunk, size_t n) { return consumer.Feed(chunk, n); });
+    ByteSink sink = std::ref(limited);
+
+    std::string storedName;
+    DecodeResult decoded = format == ArchiveFormat::Gzip
+        ? Gunzip(data, length, sink, &storedName)
+        : ZstdDecompress(data, length, sink);
+
+    if (decoded.status != DecodeStatus::Stopped) {
+        if (decoded.status != DecodeStatus::Ok) {
+            state.Skip(containerPath, DecodeErrorMessage(decoded));
+        }
+        // A broken stream's output so far is still worth scanning.
+        std::string name = storedName.empty() ? StreamMemberName(state.DisplayPath(containerPath))
+                                              : StreamMemberName(storedName);
+        consumer.Finish(name);
+    }
+    group.Wait();
+    return consumer.IsTar();
+}
+
+// ============================================================================
+// Zip
+// ============================================================================
+
+struct ZipEntry {
+    std::string path;
+    uint16_t flags = 0;
+    uint16_t method = 0;
+    uint64_t compressedSize = 0;
+    uint64_t size = 0;
+    uint64_t localOffset = 0;
+    uint64_t dataStart = 0;
+    /** Why the member cannot be read, if it cannot */
+    std::string problem;
+};
+
+/** Fill in 0xFFFFFFFF sizes/offset from a zip64 extra field. */
+void ApplyZip64Extra(const uint8_t* extra, size_t length, ZipEntry& entry, bool sizeMax,
+                     bool compressedMax, bool offsetMax) {
+    size_t pos = 0;
+    while (pos + 4 <= length) {
+        uint32_t id = ReadLE16(extra + pos);
+        size_t fieldLength = ReadLE16(extra + pos + 2);
+        const uint8_t* field = extra + pos + 4;
+        if (pos + 4 + fieldLength > length) return;
+        if (id == 0x0001) {
+            size_t offset = 0;
+            auto next = [&](uint64_t& value) {
+                if (offset + 8 <= fieldLength) {
+                    value = ReadLE64(field + offset);
+                    offset += 8;
+                }
+            };
+            if (sizeMax) next(entry.size);
+            if (compressedMax) next(entry.compressedSize);
+            if (offsetMax) next(entry.localOffset);
+            return;
+        }
+        pos += 4 + fieldLength;
+    }
+}
+
+bool ReadZipDirectory(const uint8_t* data, size_t length, uint64_t maxEntries,
+                      std::vector<ZipEntry>& entries, std::string& error) {
+    if (length < 22) {
+        error = "missing end of central directory";
+        return false;
+    }
+
+    // The end record sits before a comment of up to 64 KiB.
+    size_t eocd = std::numeric_limits<size_t>::max();
+    size_t lowest = length > 22 + 0xFFFF ? length - 22 - 0xFFFF : 0;
+    for (size_t i = length - 22 + 1; i-- > lowest;) {
+        if (ReadLE32(data + i) == 0x06054B50) {
+            eocd = i;
+            break;
+        }
+    }
+    if (eocd == std::numeric_limits<size_t>::max()) {
+        error = "missing end of central directory";
+        return false;
+    }
+
+    uint64_t count = ReadLE16(data + eocd + 10);
+    uint64_t directorySize = ReadLE32(data + eocd + 12);
+    uint64_t directoryOffset = ReadLE32(data + eocd + 16);
+    if ((count == 0xFFFF || directorySize == 0xFFFFFFFF || directoryOffset == 0xFFFFFFFF) &&
+        eocd >= 20 && ReadLE32(data + eocd - 20) == 0x07064B50) {
+        uint64_t record = ReadLE64(data + eocd - 20 + 8);
+        if (record <= length - 56 && ReadLE32(data + record) == 0x06064B50) {
+            count = ReadLE64(data + record + 32);
+            directorySize = ReadLE64(data + record + 40);
+            directoryOffset = ReadLE64(data + record + 48);
+        }
+    }
+    if (directoryOffset > length || directorySize > length - directoryOffset) {
+        error = "central directory out of range";
+        return false;
+    }
+
+    const uint8_t* p = data + directoryOffset;
+    const uint8_t* end = p + directorySize;
+    // Never trust the count for allocation: each record is at least 46 bytes.
+    entries.reserve(static_cast<size_t>(std::min<uint64_t>(count, directorySize / 46)));
+    for (uint64_t i = 0; i < count; i++) {
+        if (end - p < 46 || ReadLE32(p) != 0x02014B50) {
+            error = "corrupt central directory";
+            return false;
+        }
+        size_t nameLength = ReadLE16(p + 28);
+        size_t extraLength = ReadLE16(p + 30);
+        size_t commentLength = ReadLE16(p + 32);
+        if (static_cast<size_t>(end - p) < 46 + nameLength + extraLength + commentLength) {
+            error = "corrupt central directory";
+            return false;
+        }
+
+        ZipEntry entry;
+        entry.flags = static_cast<uint16_t>(ReadLE16(p + 8));
+        entry.method = static_cast<uint16_t>(ReadLE16(p + 10));
+        entry.compressedSize = ReadLE32(p + 20);
+        entry.size = ReadLE32(p + 24);
+        entry.localOffset = ReadLE32(p + 42);
+        entry.path.assign(reinterpret_cast<const char*>(p + 46), nameLength);
+        ApplyZip64Extra(p + 46 + nameLength, extraLength, entry, entry.size == 0xFFFFFFFF,
+                        entry.compressedSize == 0xFFFFFFFF, entry.localOffset == 0xFFFFFFFF);
+        p += 46 + nameLength + extraLength + commentLength;
+
+        if (!entry.path.empty() && entry.path.back() == '/') continue;
+
+        if (length < 30 || entry.localOffset > length - 30 ||
+            ReadLE32(data + entry.localOffset) != 0x04034B50) {
+            entry.problem = "missing local header";
+        } else {
+            const uint8_t* local = data + entry.localOffset;
+            entry.dataStart = entry.localOffset + 30 + ReadLE16(local + 26) + ReadLE16(local + 28);
+            if (entry.dataStart > length || entry.compressedSize > length - entry.dataStart) {
+                entry.problem = "member data out of range";
+            }
+        }
+        entries.push_back(std::move(entry));
+        if (entries.size() > maxEntries) break;
+    }
+    return true;
+}
+
+void ScanZipEntry(ScanState& state, const uint8_t* data, const ZipEntry& entry,
+                  const std::string& path, uint32_t depth) {
+    if (state.CheckStop()) return;
+    if (!entry.problem.empty()) {
+        state.Skip(path, entry.problem);
+        return;
+    }
+    if (entry.flags & 1) {
+        state.Skip(path, "encrypted");
+        return;
+    }
+
+    const uint64_t maxEntry = state.limits.maxEntryBytes;
+    if (entry.size > maxEntry) {
+        state.HitLimit("entrySize", path, "declares " + std::to_string(entry.size) + " bytes");
+        return;
+    }
+
+    const uint8_t* compressed = data + entry.dataStart;
+    size_t compressedSize = static_cast<size_t>(entry.compressedSize);
+    state.AddCompressed(compressedSize);
+
+    if (entry.method == 0) {
+        if (compressedSize > maxEntry) {
+            state.HitLimit("entrySize", path, "stores " + std::to_string(compressedSize) + " bytes");
+            return;
+        }
+        // Stored members are scanned straight from the mapping.
+        ScanMember(state, path, compressed, compressedSize, depth);
+        return;
+    }
+    if (entry.method != 8 && entry.method != 93) {
+        state.Skip(path, "unsupported compression method " + std::to_string(entry.method));
+        return;
+    }
+
+    std::vector<uint8_t> content;
+    content.reserve(static_cast<size_t>(entry.size));
+    LimitedSink limited(state, path, compressedSize, maxEntry,
+                        [&content](const uint8_t* chunk, size_t n) {
+                            content.insert(content.end(), chunk, chunk + n);
+                            return true;
+                        });
+    ByteSink sink = std::ref(limited);
+    DecodeResult decoded = entry.method == 8 ? InflateRaw(compressed, compressedSize, sink)
+                                             : ZstdDecompress(compressed, compressedSize, sink);
+    if (decoded.status == DecodeStatus::Stopped) return;
+    if (decoded.status != DecodeStatus::Ok) {
+        state.Skip(path, DecodeErrorMessage(decoded));
+        return;
+    }
+    ScanMember(state, path, content.data(), content.size(), depth);
+}
+
+void ScanZip(ScanState& state, const uint8_t* data, size_t length,
+             const std::string& containerPath, uint32_t depth) {
+    std::vector<ZipEntry> entries;
+    std::string error;
+    if (!ReadZipDirectory(data, length, state.limits.maxEntries, entries, error)) {
+        state.Skip(containerPath, "corrupt zip: " + error);
+        return;
+    }
+
+    // Members sharing bytes are how non-recursive zip bombs get their
+    // ratio: one compressed kernel referenced by every entry.
+    std::vector<const ZipEntry*> byOffset;
+    for (const ZipEntry& entry : entries) {
+        if (entry.problem.empty()) byOffset.push_back(&entry);
+    }
+    std::sort(byOffset.begin(), byOffset.end(), [](const ZipEntry* a, const ZipEntry* b) {
+        return a->localOffset < b->localOffset;
+    });
+    for (size_t i = 1; i < byOffset.size(); i++) {
+        const ZipEntry* previous = byOffset[i - 1];
+        if (previous->dataStart + previous->compressedSize > byOffset[i]->localOffset) {
+            state.HitLimit("overlap", NestedPrefix(containerPath) + byOffset[i]->path,
+                           "overlaps " + previous->path);
+            return;
+        }
+    }
+
+    const std::string prefix = NestedPrefix(containerPath);
+    WaitGroup group(WorkerPool::Shared());
+    for (const ZipEntry& entry : entries) {
+        std::string path = prefix + entry.path;
+        if (state.CheckStop() || !state.CountEntry(path)) break;
+        group.Run([&state, data, &entry, path, depth]() {
+            ScanZipEntry(state, data, entry, path, depth);
+        });
+    }
+    group.Wait();
+}
+
+// ============================================================================
+// Dispatch
+// ============================================================================
+
+std::string ScanContainer(ScanState& state, ArchiveFormat format, const uint8_t* data,
+                          size_t length, const std::string& containerPath, uint32_t depth) {
+    switch (format) {
+        case ArchiveFormat::Zip:
+            ScanZip(state, data, length, containerPath, depth);
+            return "zip";
+        case ArchiveFormat::Tar:
+            ScanTar(state, data, length, containerPath, depth);
+            return "tar";
+        case ArchiveFormat::Gzip:
+            return ScanStream(state, format, data, length, containerPath, depth) ? "tar+gzip" : "gzip";
+        case ArchiveFormat::Zstd:
+            return ScanStream(state, format, data, length, containerPath, depth) ? "tar+zstd" : "zstd";
+        default:
+            return "none";
+    }
+}
+
+void ScanMember(ScanState& state, const std::string& path, const uint8_t* data, size_t length,
+                uint32_t depth) {
+    if (state.CheckStop()) return;
+    ArchiveFormat nested = DetectFormat(data, length);
+    if (nested != ArchiveFormat::None) {
+        if (depth < state.limits.maxDepth) {
+            ScanContainer(state, nested, data, length, path, depth + 1);
+            return;
+        }
+        // Too deep to open: the raw bytes are still scanned.
+        state.Skip(path, "nested archive deeper than maxDepth");
+    }
+    state.Scan(path, data, length);
+}
+
+// ============================================================================
+// Async Worker
+// ============================================================================
+
+class ScanArchiveWorker : public Napi::AsyncWorker {
+public:
+    ScanArchiveWorker(Napi::Env env, std::string path, Napi::Value buffer, ScanEngine engine,
+                      std::vector<ScanSignature> signatures, ArchiveScanOptions options,
+                      CancelBinding cancel, WorkContext work)
+        : Napi::AsyncWorker(env),
+          deferred_(Napi::Promise::Deferred::New(env)),
+          path_(std::move(path)),
+          engine_(engine),
+          signatures_(std::move(signatures)),
+          options_(std::move(options)),
+          cancel_(std::move(cancel)),
+          work_(work) {
+        if (buffer.IsBuffer()) {
+            // Held so the bytes stay put while the scan reads them.
+            auto bytes = buffer.As<Napi::Buffer<uint8_t>>();
+            data_ = bytes.Data();
+            length_ = bytes.Length();
+            buffer_ = Napi::Persistent(buffer.As<Napi::Object>());
+        }
+        options_.cancel = cancel_.Token();
+    }
+
+    Napi::Promise Promise() const { return deferred_.Promise(); }
+
+    void Execute() override {
+        WorkScope scope(work_);
+        std::string error;
+        std::unique_ptr<ScanProvider> provider = CreateScanProvider(engine_, signatures_, error);
+        if (!provider) {
+            SetError(error);
+            return;
+        }
+        engineName_ = provider->Name();
+
+        bool ok = path_.empty()
+            ? ScanArchiveBuffer(data_, length_, *provider, options_, result_, error)
+            : ScanArchiveFile(path_, *provider, options_, result_, error);
+        if (!ok) SetError(error);
+    }
+
+    void OnOK() override {
+        cancel_.Finish();
+        Napi::Env env = Env();
+        Napi::Object out = Napi::Object::New(env);
+        out.Set("clean", Napi::Boolean::New(env, result_.Clean()));
+        out.Set("format", Napi::String::New(env, result_.format));
+        out.Set("engine", Napi::String::New(env, engineName_));
+        out.Set("entries", Napi::Number::New(env, static_cast<double>(result_.entries)));
+        out.Set("scannedEntries", Napi::Number::New(env, static_cast<double>(result_.scannedEntries)));
+        out.Set("scannedBytes", Napi::Number::New(env, static_cast<double>(result_.scannedBytes)));
+        out.Set("compressedBytes",
+                Napi::Number::New(env, static_cast<double>(result_.compressedBytes)));
+        out.Set("durationMs", Napi::Number::New(env, result_.durationMs));
+
+        Napi::Array threats = Napi::Array::New(env, result_.threats.size());
+        for (size_t i = 0; i < result_.threats.size(); i++) {
+            const ArchiveThreat& t = result_.threats[i];
+            Napi::Object threat = Napi::Object::New(env);
+            threat.Set("path", Napi::String::New(env, t.path));
+            threat.Set("result", Napi::Number::New(env, t.result));
+            threat.Set("description", Napi::String::New(env, t.description));
+            threats.Set(static_cast<uint32_t>(i), threat);
+        }
+        out.Set("threats", threats);
+
+        Napi::Array unscanned = Napi::Array::New(env, result_.unscanned.size());
+        for (size_t i = 0; i < result_.unscanned.size(); i++) {
+            Napi::Object skipped = Napi::Object::New(env);
+            skipped.Set("path", Napi::String::New(env, result_.unscanned[i].path));
+            skipped.Set("reason", Napi::String::New(env, result_.unscanned[i].reason));
+            unscanned.Set(static_cast<uint32_t>(i), skipped);
+        }
+        out.Set("unscanned", unscanned);
+
+        if (result_.limitKind.empty()) {
+            out.Set("limit", env.Null());
+        } else {
+            Napi::Object limit = Napi::Object::New(env);
+            limit.Set("kind", Napi::String::New(env, result_.limitKind));
+            limit.Set("path", Napi::String::New(env, result_.limitPath));
+            limit.Set("detail", Napi::String::New(env, result_.limitDetail));
+            out.Set("limit", limit);
+        }
+
+        deferred_.Resolve(out);
+    }
+
+    void OnError(const Napi::Error& error) override {
+        cancel_.Finish();
+        deferred_.Reject(cancel_.Stopped() ? cancel_.StoppedError(Env()) : error.Value());
+    }
+
+private:
+    Napi::Promise::Deferred deferred_;
+    std::string path_;
+    Napi::ObjectReference buffer_;
+    const uint8_t* data_ = nullptr;
+    size_t length_ = 0;
+    ScanEngine engine_;
+    std::vector<ScanSignature> signatures_;
+    ArchiveScanOptions options_;
+    CancelBinding cancel_;
+    WorkContext work_;
+    std::string engineName_;
+    ArchiveScanResult result_;
+};
+
+Napi::Value RejectedPromise(Napi::Env env, const std::string& message) {
+    auto deferred = Napi::Promise::Deferred::New(env);
+    deferred.Reject(Napi::TypeError::New(env, message).Value());
+    return deferred.Promise();
+}
+
+bool ReadLimit(const Napi::Object& options, const char* name, double max, uint64_t& out,
+               std::string& error) {
+    Napi::Value value = options.Get(name);
+    if (value.IsUndefined()) return true;
+    double number = value.IsNumber() ? value.As<Napi::Number>().DoubleValue() : -1;
+    if (!(number >= 0) || number != std::floor(number) || number > max) {
+        error = std::string(name) + " must be a non-negative integer";
+        return false;
+    }
+    out = static_cast<uint64_t>(number);
+    return true;
+}
+
+} // namespace
+
+// ============================================================================
+// Scanning
+// ============================================================================
+
+bool ScanArchiveBuffer(const uint8_t* data, size_t length, ScanProvider& provider,
+                       const ArchiveScanOptions& options, ArchiveScanResult& result,
+                       std::string& error) {
+    auto start = std::chrono::steady_clock::now();
+    result = ArchiveScanResult();
+    ScanState state(provider, options, length);
+
+    ArchiveFormat format = DetectFormat(data, length);
+    if (format == ArchiveFormat::None) {
+        result.format = "none";
+        if (state.CountEntry("")) state.Scan("", data, length);
+    } else {
+        result.format = ScanContainer(state, format, data, length, "", 0);
+    }
+
+    bool ok = state.Collect(result, error);
+    result.durationMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    return ok;
+}
+
+bool ScanArchiveFile(const std::string& path, ScanProvider& provider,
+                     const ArchiveScanOptions& options, ArchiveScanResult& result,
+                     std::string& error) {
+    MappedFile file;
+    if (!file.Open(path, error)) return false;
+    ArchiveScanOptions named = options;
+    if (named.name.empty()) named.name = path.substr(path.find_last_of("/\\") + 1);
+    return ScanArchiveBuffer(file.Data(), file.Size(), provider, named, result, error);
+}
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+Napi::Value ScanArchive(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !(info[0].IsString() || info[0].IsBuffer())) {
+        return RejectedPromise(env, "scanArchive expects a path or a Buffer");
+    }
+
+    Napi::Value opts = info.Length() > 1 ? info[1] : env.Undefined();
+    if (!opts.IsUndefined() && !opts.IsObject()) {
+        return RejectedPromise(env, "options must be an object");
+    }
+
+    ArchiveScanOptions options;
+    ScanEngine engine = ScanEngine::Auto;
+    std::vector<ScanSignature> signatures;
+    std::string error;
+    if (opts.IsObject()) {
+        Napi::Object o = opts.As<Napi::Object>();
+        ArchiveLimits& limits = options.limits;
+        uint64_t depth = limits.maxDepth;
+        const double maxBytes = 9007199254740991.0;
+        if (!ReadLimit(o, "maxEntryBytes", maxBytes, limits.maxEntryBytes, error) ||
+            !ReadLimit(o, "maxTotalBytes", maxBytes, limits.maxTotalBytes, error) ||
+            !ReadLimit(o, "maxEntries", maxBytes, limits.maxEntries, error) ||
+            !ReadLimit(o, "maxDepth", 16, depth, error)) {
+            return RejectedPromise(env, error);
+        }
+        limits.maxDepth = static_cast<uint32_t>(depth);
+
+        Napi::Value ratio = o.Get("maxRatio");
+        if (!ratio.IsUndefined()) {
+            double value = ratio.IsNumber() ? ratio.As<Napi::Number>().DoubleValue() : 0;
+            if (!(value >= 1) || !std::isfinite(value)) {
+                return RejectedPromise(env, "maxRatio must be a finite number >= 1");
+            }
+            limits.maxRatio = value;
+        }
+
+        if (!ReadScanEngineOptions(o, engine, signatures, error)) {
+            return RejectedPromise(env, error);
+        }
+
+        Napi::Value name = o.Get("name");
+        if (name.IsString()) {
+            options.name = name.As<Napi::String>().Utf8Value();
+        } else if (!name.IsUndefined()) {
+            return RejectedPromise(env, "name must be a string");
+        }
+    }
+    if (info[0].IsBuffer() && options.name.empty()) options.name = "archive";
+
+    // Whole-archive work: bulk unless the caller is waiting on it.
+    WorkContext work;
+    if (!ReadWorkContext(opts, WorkPriority::Bulk, work, error)) {
+        return RejectedPromise(env, error);
+    }
+
+    CancelBinding cancel(CancellableOperation::ScanArchive);
+    if (!cancel.Attach(opts, error)) {
+        return RejectedPromise(env, error);
+    }
+
+    std::string path = info[0].IsString() ? info[0].As<Napi::String>().Utf8Value() : "";
+    if (info[0].IsString() && path.empty()) {
+        return RejectedPromise(env, "scanArchive expects a path or a Buffer");
+    }
+    auto* worker = new ScanArchiveWorker(env, path, info[0], engine, std::move(signatures),
+                                         std::move(options), std::move(cancel), work);
+    Napi::Promise promise = worker->Promise();
+    worker->Queue();
+    return promise;
+}
+
+} // namespace TerminAI
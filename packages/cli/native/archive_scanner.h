@@ -0,0 +1,145 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Archive Scanner Header
+ *
+ * Scans the members of zip, tar, gzip and zstd archives without extracting
+ * them to disk. Each member is decompressed in memory (see decompress.h)
+ * and handed to a ScanProvider with its inner path as the content name,
+ * e.g. "bundle.zip!/scripts/setup.ps1". Archives nested inside members are
+ * opened in turn, up to a depth limit.
+ *
+ * Zip members are independent, so they are decompressed and scanned in
+ * parallel on the shared WorkerPool. Tar (plain or compressed) is read
+ * front to back; each completed member is scanned on the pool while the
+ * stream moves on, with the bytes held by in-flight members bounded.
+ *
+ * Decompression bombs are stopped by limits checked as output is produced:
+ * the size of one member, the total across the archive, the expansion
+ * ratio of each stream and of the whole archive, the member count, and
+ * zip members whose data overlaps. Hitting a limit stops the scan and
+ * reports which limit and where; the archive is then not clean.
+ */
+
+#pragma once
+
+#include <napi.h>
+#include "cancellation.h"
+#include "scan_provider.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace TerminAI {
+
+// ============================================================================
+// Types
+// ============================================================================
+
+struct ArchiveLimits {
+    /** Largest decompressed member */
+    uint64_t maxEntryBytes = 64ull * 1024 * 1024;
+    /** Decompressed bytes across the archive, nested archives included */
+    uint64_t maxTotalBytes = 1024ull * 1024 * 1024;
+    /** Largest output/input ratio, per stream and overall (past 1 MiB out) */
+    double maxRatio = 100;
+    /** Members across the archive, nested archives included */
+    uint64_t maxEntries = 100000;
+    /** How many archives deep to open (0 = the outer archive only) */
+    uint32_t maxDepth = 2;
+};
+
+struct ArchiveScanOptions {
+    ArchiveLimits limits;
+    /** Content name of the archive itself (usually its file name) */
+    std::string name;
+    /** Checked per decoded chunk and member (null = never stops) */
+    CancelToken* cancel = nullptr;
+};
+
+struct ArchiveThreat {
+    std::string path;
+    int32_t result = 0;
+    std::string description;
+};
+
+struct ArchiveSkipped {
+    std::string path;
+    std::string reason;
+};
+
+struct ArchiveScanResult {
+    /** "zip", "tar", "gzip", "zstd", "tar+gzip", "tar+zstd" or "none" */
+    std::string format;
+    uint64_t entries = 0;
+    uint64_t scannedEntries = 0;
+    uint64_t scannedBytes = 0;
+    uint64_t compressedBytes = 0;
+    std::vector<ArchiveThreat> threats;
+    /** Members that could not be scanned (encrypted, unsupported, corrupt) */
+    std::vector<ArchiveSkipped> unscanned;
+    /** Set when a limit stopped the scan: "entrySize", "totalSize", "ratio", "entries", "overlap" */
+    std::string limitKind;
+    std::string limitPath;
+    std::string limitDetail;
+    double durationMs = 0;
+
+    /** No threats, every member scanned and no limit hit. */
+    bool Clean() const { return threats.empty() && unscanned.empty() && limitKind.empty(); }
+};
+
+// ============================================================================
+// Scanning
+// ============================================================================
+
+/**
+ * Scan an archive held in memory. Content that is not a recognized archive
+ * is scanned as a single member (format "none").
+ *
+ * @return false with a message if the provider failed or the scan stopped
+ *         on options.cancel; limits and corrupt members are reported in
+ *         `result` instead
+ */
+bool ScanArchiveBuffer(const uint8_t* data, size_t length, ScanProvider& provider,
+                       const ArchiveScanOptions& options, ArchiveScanResult& result,
+                       std::string& error);
+
+/** Map a file read-only and scan it with ScanArchiveBuffer(). */
+bool ScanArchiveFile(const std::string& path, ScanProvider& provider,
+                     const ArchiveScanOptions& options, ArchiveScanResult& result,
+                     std::string& error);
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+/**
+ * Scan the members of an archive without extracting it.
+ *
+ * Arguments:
+ *   0: String | Buffer - Archive path, or its content
+ *   1: Object (optional)
+ *      - maxEntryBytes, maxTotalBytes, maxRatio, maxEntries, maxDepth:
+ *        limits (see ArchiveLimits)
+ *      - engine: 'auto' | 'amsi' | 'portable' (default 'auto')
+ *      - signatures: Array<{ name, pattern: string | Buffer }> extra
+ *        patterns for the portable engine
+ *      - name: String - content name for a Buffer (default "archive")
+ *      - priority, sessionId: scheduling (default priority 'bulk')
+ *      - timeoutMs, signal: see cancellation.h
+ *
+ * Returns: Promise<Object>
+ *   - clean, format, engine, entries, scannedEntries, scannedBytes,
+ *     compressedBytes, durationMs
+ *   - threats: Array<{ path, result, description }>
+ *   - unscanned: Array<{ path, reason }>
+ *   - limit: null | { kind, path, detail }
+ */
+Napi::Value ScanArchive(const Napi::CallbackInfo& info);
+
+} // namespace TerminAI
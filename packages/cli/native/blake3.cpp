@@ -0,0 +1,560 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - BLAKE3 Hash Implementation
+ *
+ * The tree layout follows the specification: the left subtree of every
+ * parent holds the largest power-of-two number of chunks that still leaves
+ * at least one byte for the right subtree. Because BLAKE3_SEGMENT_LEN is a
+ * power-of-two number of chunks, every full segment is a complete subtree,
+ * which is what lets the parallel paths hash segments independently and
+ * merge their chaining values afterwards.
+ */
+
+#include "blake3.h"
+#include "worker_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TERMINAI_BLAKE3_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace TerminAI {
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+namespace {
+
+constexpr uint32_t IV[8] = {
+    0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
+    0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19,
+};
+
+constexpr uint8_t MSG_PERMUTATION[16] = {
+    2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8,
+};
+
+enum : uint8_t {
+    CHUNK_START = 1 << 0,
+    CHUNK_END = 1 << 1,
+    PARENT = 1 << 2,
+    ROOT = 1 << 3,
+};
+
+constexpr size_t CHUNKS_PER_SEGMENT = BLAKE3_SEGMENT_LEN / BLAKE3_CHUNK_LEN;
+static_assert((CHUNKS_PER_SEGMENT & (CHUNKS_PER_SEGMENT - 1)) == 0,
+              "BLAKE3_SEGMENT_LEN must be a power-of-two number of chunks");
+
+// ============================================================================
+// Portable Compression Function
+// ============================================================================
+
+inline uint32_t Load32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) |
+           (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) |
+           (static_cast<uint32_t>(p[3]) << 24);
+}
+
+inline void Store32(uint8_t* p, uint32_t w) {
+    p[0] = static_cast<uint8_t>(w);
+    p[1] = static_cast<uint8_t>(w >> 8);
+    p[2] = static_cast<uint8_t>(w >> 16);
+    p[3] = static_cast<uint8_t>(w >> 24);
+}
+
+inline uint32_t Rotr32(uint32_t w, uint32_t c) {
+    return (w >> c) | (w << (32 - c));
+}
+
+inline void G(uint32_t* s, int a, int b, int c, int d, uint32_t x, uint32_t y) {
+    s[a] = s[a] + s[b] + x;
+    s[d] = Rotr32(s[d] ^ s[a], 16);
+    s[c] = s[c] + s[d];
+    s[b] = Rotr32(s[b] ^ s[c], 12);
+    s[a] = s[a] + s[b] + y;
+    s[d] = Rotr32(s[d] ^ s[a], 8);
+    s[c] = s[c] + s[d];
+    s[b] = Rotr32(s[b] ^ s[c], 7);
+}
+
+inline void Round(uint32_t* s, const uint32_t* m) {
+    G(s, 0, 4, 8, 12, m[0], m[1]);
+    G(s, 1, 5, 9, 13, m[2], m[3]);
+    G(s, 2, 6, 10, 14, m[4], m[5]);
+    G(s, 3, 7, 11, 15, m[6], m[7]);
+    G(s, 0, 5, 10, 15, m[8], m[9]);
+    G(s, 1, 6, 11, 12, m[10], m[11]);
+    G(s, 2, 7, 8, 13, m[12], m[13]);
+    G(s, 3, 4, 9, 14, m[14], m[15]);
+}
+
+/**
+ * Compress one block, writing the new 8-word chaining value to `cv`.
+ */
+void Compress(uint32_t cv[8], const uint8_t block[BLAKE3_BLOCK_LEN],
+              uint8_t blockLen, uint64_t counter, uint8_t flags) {
+    uint32_t m[16];
+    for (int i = 0; i < 16; i++) m[i] = Load32(block + 4 * i);
+
+    uint32_t s[16] = {
+        cv[0], cv[1], cv[2], cv[3], cv[4], cv[5], cv[6], cv[7],
+        IV[0], IV[1], IV[2], IV[3],
+        static_cast<uint32_t>(counter),
+        static_cast<uint32_t>(counter >> 32),
+        blockLen,
+        flags,
+    };
+
+    for (int r = 0; r < 7; r++) {
+        Round(s, m);
+        if (r == 6) break;
+        uint32_t permuted[16];
+        for (int i = 0; i < 16; i++) permuted[i] = m[MSG_PERMUTATION[i]];
+        std::memcpy(m, permuted, sizeof(m));
+    }
+
+    for (int i = 0; i < 8; i++) cv[i] = s[i] ^ s[i + 8];
+}
+
+void ParentCv(const uint32_t left[8], const uint32_t right[8], uint8_t flags,
+              uint32_t out[8]) {
+    uint8_t block[BLAKE3_BLOCK_LEN];
+    for (int i = 0; i < 8; i++) {
+        Store32(block + 4 * i, left[i]);
+        Store32(block + 32 + 4 * i, right[i]);
+    }
+    std::memcpy(out, IV, sizeof(IV));
+    Compress(out, block, BLAKE3_BLOCK_LEN, 0, PARENT | flags);
+}
+
+/**
+ * Chaining value (or root output when `rootFlag` is ROOT) of a single chunk
+ * of 0..BLAKE3_CHUNK_LEN bytes.
+ */
+void ChunkCv(const uint8_t* input, size_t length, uint64_t counter,
+             uint8_t rootFlag, uint32_t out[8]) {
+    std::memcpy(out, IV, sizeof(IV));
+
+    size_t blocks = length == 0 ? 1 : (length + BLAKE3_BLOCK_LEN - 1) / BLAKE3_BLOCK_LEN;
+    for (size_t b = 0; b < blocks; b++) {
+        uint8_t block[BLAKE3_BLOCK_LEN] = {};
+        size_t take = std::min(BLAKE3_BLOCK_LEN, length - b * BLAKE3_BLOCK_LEN);
+        if (length > 0) std::memcpy(block, input + b * BLAKE3_BLOCK_LEN, take);
+
+        uint8_t flags = 0;
+        if (b == 0) flags |= CHUNK_START;
+        if (b == blocks - 1) flags |= CHUNK_END | rootFlag;
+        Compress(out, block, static_cast<uint8_t>(take), counter, flags);
+    }
+}
+
+// ============================================================================
+// SSE2 Four-Way Chunk Hashing
+// ============================================================================
+
+#ifdef TERMINAI_BLAKE3_SSE2
+
+inline __m128i Rotr128(__m128i x, int c) {
+    return _mm_or_si128(_mm_srli_epi32(x, c), _mm_slli_epi32(x, 32 - c));
+}
+
+inline void G4(__m128i* s, int a, int b, int c, int d, __m128i x, __m128i y) {
+    s[a] = _mm_add_epi32(_mm_add_epi32(s[a], s[b]), x);
+    s[d] = Rotr128(_mm_xor_si128(s[d], s[a]), 16);
+    s[c] = _mm_add_epi32(s[c], s[d]);
+    s[b] = Rotr128(_mm_xor_si128(s[b], s[c]), 12);
+    s[a] = _mm_add_epi32(_mm_add_epi32(s[a], s[b]), y);
+    s[d] = Rotr128(_mm_xor_si128(s[d], s[a]), 8);
+    s[c] = _mm_add_epi32(s[c], s[d]);
+    s[b] = Rotr128(_mm_xor_si128(s[b], s[c]), 7);
+}
+
+inline void Transpose4(__m128i& a, __m128i& b, __m128i& c, __m128i& d) {
+    __m128i t0 = _mm_unpacklo_epi32(a, b);
+    __m128i t1 = _mm_unpacklo_epi32(c, d);
+    __m128i t2 = _mm_unpackhi_epi32(a, b);
+    __m128i t3 = _mm_unpackhi_epi32(c, d);
+    a = _mm_unpacklo_epi64(t0, t1);
+    b = _mm_unpackhi_epi64(t0, t1);
+    c = _mm_unpacklo_epi64(t2, t3);
+    d = _mm_unpackhi_epi64(t2, t3);
+}
+
+/**
+ * Hash four consecutive full chunks starting at `input` (counters
+ * `counter`..`counter + 3`), writing their chaining values to `out`.
+ */
+void HashFourChunks(const uint8_t* input, uint64_t counter, uint32_t out[4][8]) {
+    __m128i h[8];
+    for (int i = 0; i < 8; i++) h[i] = _mm_set1_epi32(static_cast<int>(IV[i]));
+
+    const __m128i counterLo = _mm_set_epi32(
+        static_cast<int>(static_cast<uint32_t>(counter + 3)),
+        static_cast<int>(static_cast<uint32_t>(counter + 2)),
+        static_cast<int>(static_cast<uint32_t>(counter + 1)),
+        static_cast<int>(static_cast<uint32_t>(counter)));
+    const __m128i counterHi = _mm_set_epi32(
+        static_cast<int>(static_cast<uint32_t>((counter + 3) >> 32)),
+        static_cast<int>(static_cast<uint32_t>((counter + 2) >> 32)),
+        static_cast<int>(static_cast<uint32_t>((counter + 1) >> 32)),
+        static_cast<int>(static_cast<uint32_t>(counter >> 32)));
+
+    for (size_t b = 0; b < BLAKE3_CHUNK_LEN / BLAKE3_BLOCK_LEN; b++) {
+        // Load block `b` of each lane and transpose so that m[i] holds
+        // message word i of all four chunks.
+        __m128i m[16];
+        for (int g = 0; g < 4; g++) {
+            __m128i lanes[4];
+            for (int lane = 0; lane < 4; lane++) {
+                lanes[lane] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(
+                    input + lane * BLAKE3_CHUNK_LEN + b * BLAKE3_BLOCK_LEN + 16 * g));
+            }
+            Transpose4(lanes[0], lanes[1], lanes[2], lanes[3]);
+            for (int k = 0; k < 4; k++) m[4 * g + k] = lanes[k];
+        }
+
+        uint8_t flags = 0;
+        if (b == 0) flags |= CHUNK_START;
+        if (b == BLAKE3_CHUNK_LEN / BLAKE3_BLOCK_LEN - 1) flags |= CHUNK_END;
+
+        __m128i s[16] = {
+            h[0], h[1], h[2], h[3], h[4], h[5], h[6], h[7],
+            _mm_set1_epi32(static_cast<int>(IV[0])),
+            _mm_set1_epi32(static_cast<int>(IV[1])),
+            _mm_set1_epi32(static_cast<int>(IV[2])),
+            _mm_set1_epi32(static_cast<int>(IV[3])),
+            counterLo,
+            counterHi,
+            _mm_set1_epi32(static_cast<int>(BLAKE3_BLOCK_LEN)),
+            _mm_set1_epi32(flags),
+        };
+
+        for (int r = 0; r < 7; r++) {
+            G4(s, 0, 4, 8, 12, m[0], m[1]);
+            G4(s, 1, 5, 9, 13, m[2], m[3]);
+            G4(s, 2, 6, 10, 14, m[4], m[5]);
+            G4(s, 3, 7, 11, 15, m[6], m[7]);
+            G4(s, 0, 5, 10, 15, m[8], m[9]);
+            G4(s, 1, 6, 11, 12, m[10], m[11]);
+            G4(s, 2, 7, 8, 13, m[12], m[13]);
+            G4(s, 3, 4, 9, 14, m[14], m[15]);
+            if (r == 6) break;
+            __m128i permuted[16];
+            for (int i = 0; i < 16; i++) permuted[i] = m[MSG_PERMUTATION[i]];
+            for (int i = 0; i < 16; i++) m[i] = permuted[i];
+        }
+
+        for (int i = 0; i < 8; i++) h[i] = _mm_xor_si128(s[i], s[i + 8]);
+    }
+
+    Transpose4(h[0], h[1], h[2], h[3]);
+    Transpose4(h[4], h[5], h[6], h[7]);
+    for (int lane = 0; lane < 4; lane++) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[lane][0]), h[lane]);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[lane][4]), h[lane + 4]);
+    }
+}
+
+#endif // TERMINAI_BLAKE3_SSE2
+
+/**
+ * Chaining values of `count` consecutive full chunks.
+ */
+void HashFullChunks(const uint8_t* input, size_t count, uint64_t counter,
+                    uint32_t (*out)[8]) {
+    size_t i = 0;
+#ifdef TERMINAI_BLAKE3_SSE2
+    for (; i + 4 <= count; i += 4) {
+        HashFourChunks(input + i * BLAKE3_CHUNK_LEN, counter + i, out + i);
+    }
+#endif
+    for (; i < count; i++) {
+        ChunkCv(input + i * BLAKE3_CHUNK_LEN, BLAKE3_CHUNK_LEN, counter + i, 0, out[i]);
+    }
+}
+
+// ============================================================================
+// Tree Helpers
+// ============================================================================
+
+/** Largest power of two strictly less than n (n >= 2). */
+inline size_t LeftSubtreeCount(size_t n) {
+    size_t p = 1;
+    while ((p << 1) < n) p <<= 1;
+    return p;
+}
+
+/**
+ * Merge `n` adjacent subtree chaining values (each covering the same
+ * power-of-two number of chunks, except possibly the last) into their
+ * parent. `rootFlag` is applied to the topmost parent only.
+ */
+void MergeCvs(const uint32_t (*cvs)[8], size_t n, uint8_t rootFlag, uint32_t out[8]) {
+    if (n == 1) {
+        std::memcpy(out, cvs[0], 8 * sizeof(uint32_t));
+        return;
+    }
+    size_t left = LeftSubtreeCount(n);
+    uint32_t l[8], r[8];
+    MergeCvs(cvs, left, 0, l);
+    MergeCvs(cvs + left, n - left, 0, r);
+    ParentCv(l, r, rootFlag, out);
+}
+
+/**
+ * Chaining value of a non-root subtree covering `length` bytes (at least
+ * one full chunk plus one byte, or exactly one chunk) starting at chunk
+ * `counter`.
+ */
+void SubtreeCv(const uint8_t* input, size_t length, uint64_t counter, uint32_t out[8]) {
+    size_t chunks = (length + BLAKE3_CHUNK_LEN - 1) / BLAKE3_CHUNK_LEN;
+    size_t fullChunks = length / BLAKE3_CHUNK_LEN;
+
+    std::vector<uint32_t> storage(chunks * 8);
+    auto* cvs = reinterpret_cast<uint32_t (*)[8]>(storage.data());
+
+    HashFullChunks(input, fullChunks, counter, cvs);
+    if (fullChunks < chunks) {
+        ChunkCv(input + fullChunks * BLAKE3_CHUNK_LEN, length - fullChunks * BLAKE3_CHUNK_LEN,
+                counter + fullChunks, 0, cvs[fullChunks]);
+    }
+    MergeCvs(cvs, chunks, 0, out);
+}
+
+Blake3Digest DigestFromCv(const uint32_t cv[8]) {
+    Blake3Digest digest;
+    for (int i = 0; i < 8; i++) Store32(digest.bytes + 4 * i, cv[i]);
+    return digest;
+}
+
+} // namespace
+
+// ============================================================================
+// Blake3Digest
+// ============================================================================
+
+bool Blake3Digest::operator==(const Blake3Digest& other) const {
+    return std::memcmp(bytes, other.bytes, BLAKE3_OUT_LEN) == 0;
+}
+
+std::string Blake3Digest::ToHex() const {
+    static const char* const HEX = "0123456789abcdef";
+    std::string hex(BLAKE3_OUT_LEN * 2, '0');
+    for (size_t i = 0; i < BLAKE3_OUT_LEN; i++) {
+        hex[2 * i] = HEX[bytes[i] >> 4];
+        hex[2 * i + 1] = HEX[bytes[i] & 0xF];
+    }
+    return hex;
+}
+
+bool Blake3Digest::FromHex(const std::string& hex, Blake3Digest& out) {
+    if (hex.size() != BLAKE3_OUT_LEN * 2) return false;
+
+    auto nibble = [](char c) -> int {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    };
+
+    for (size_t i = 0; i < BLAKE3_OUT_LEN; i++) {
+        int hi = nibble(hex[2 * i]);
+        int lo = nibble(hex[2 * i + 1]);
+        if (hi < 0 || lo < 0) return false;
+        out.bytes[i] = static_cast<uint8_t>((hi << 4) | lo);
+    }
+    return true;
+}
+
+// ============================================================================
+// Blake3Hasher
+// ============================================================================
+
+Blake3Hasher::Blake3Hasher() {
+    ResetChunk(0);
+}
+
+void Blake3Hasher::ResetChunk(uint64_t chunkCounter) {
+    std::memcpy(chunk_.cv, IV, sizeof(IV));
+    chunk_.chunkCounter = chunkCounter;
+    chunk_.blockLen = 0;
+    chunk_.blocksCompressed = 0;
+}
+
+size_t Blake3Hasher::ChunkLen() const {
+    return static_cast<size_t>(chunk_.blocksCompressed) * BLAKE3_BLOCK_LEN + chunk_.blockLen;
+}
+
+void Blake3Hasher::PushChunkCv(const uint32_t cv[8], uint64_t totalChunks) {
+    // Merge completed subtrees: every trailing zero bit of the chunk count
+    // marks a left sibling on the stack that is now complete.
+    uint32_t merged[8];
+    std::memcpy(merged, cv, sizeof(merged));
+    while ((totalChunks & 1) == 0) {
+        cvStackLen_--;
+        ParentCv(cvStack_[cvStackLen_], merged, 0, merged);
+        totalChunks >>= 1;
+    }
+    std::memcpy(cvStack_[cvStackLen_], merged, sizeof(merged));
+    cvStackLen_++;
+}
+
+void Blake3Hasher::Update(const void* data, size_t length) {
+    const uint8_t* input = static_cast<const uint8_t*>(data);
+
+    while (length > 0) {
+        // A full chunk is only finalized once more input arrives, because
+        // the last chunk of the whole input must carry the ROOT flag.
+        if (ChunkLen() == BLAKE3_CHUNK_LEN) {
+            uint8_t flags = CHUNK_END | (chunk_.blocksCompressed == 0 ? CHUNK_START : 0);
+            Compress(chunk_.cv, chunk_.block, chunk_.blockLen, chunk_.chunkCounter, flags);
+            uint64_t total = chunk_.chunkCounter + 1;
+            PushChunkCv(chunk_.cv, total);
+            ResetChunk(total);
+        }
+
+        // Fast path: whole chunks straight from the input, several at once,
+        // always leaving at least one byte for the final chunk.
+        if (ChunkLen() == 0 && length > BLAKE3_CHUNK_LEN) {
+            size_t batch = std::min<size_t>((length - 1) / BLAKE3_CHUNK_LEN, 16);
+            uint32_t cvs[16][8];
+            HashFullChunks(input, batch, chunk_.chunkCounter, cvs);
+            for (size_t i = 0; i < batch; i++) {
+                PushChunkCv(cvs[i], chunk_.chunkCounter + i + 1);
+            }
+            ResetChunk(chunk_.chunkCounter + batch);
+            input += batch * BLAKE3_CHUNK_LEN;
+            length -= batch * BLAKE3_CHUNK_LEN;
+            continue;
+        }
+
+        if (chunk_.blockLen == BLAKE3_BLOCK_LEN) {
+            uint8_t flags = chunk_.blocksCompressed == 0 ? CHUNK_START : 0;
+            Compress(chunk_.cv, chunk_.block, BLAKE3_BLOCK_LEN, chunk_.chunkCounter, flags);
+            chunk_.blocksCompressed++;
+            chunk_.blockLen = 0;
+        }
+
+        size_t take = std::min<size_t>(BLAKE3_BLOCK_LEN - chunk_.blockLen, length);
+        take = std::min(take, BLAKE3_CHUNK_LEN - ChunkLen());
+        std::memcpy(chunk_.block + chunk_.blockLen, input, take);
+        chunk_.blockLen = static_cast<uint8_t>(chunk_.blockLen + take);
+        input += take;
+        length -= take;
+    }
+}
+
+Blake3Digest Blake3Hasher::Finalize() const {
+    uint8_t block[BLAKE3_BLOCK_LEN] = {};
+    std::memcpy(block, chunk_.block, chunk_.blockLen);
+
+    uint32_t cv[8];
+    std::memcpy(cv, chunk_.cv, sizeof(cv));
+    uint8_t flags = CHUNK_END | (chunk_.blocksCompressed == 0 ? CHUNK_START : 0);
+
+    if (cvStackLen_ == 0) {
+        Compress(cv, block, chunk_.blockLen, chunk_.chunkCounter, flags | ROOT);
+        return DigestFromCv(cv);
+    }
+
+    Compress(cv, block, chunk_.blockLen, chunk_.chunkCounter, flags);
+    for (int i = cvStackLen_ - 1; i >= 0; i--) {
+        ParentCv(cvStack_[i], cv, i == 0 ? ROOT : 0, cv);
+    }
+    return DigestFromCv(cv);
+}
+
+// ============================================================================
+// One-shot Hashing
+// ============================================================================
+
+Blake3Digest Blake3Hash(const void* data, size_t length) {
+    Blake3Hasher hasher;
+    hasher.Update(data, length);
+    return hasher.Finalize();
+}
+
+Blake3Digest Blake3HashParallel(const void* data, size_t length, WorkerPool& pool) {
+    const uint8_t* input = static_cast<const uint8_t*>(data);
+    Blake3Digest digest;
+    Blake3HashSegmented(
+        length,
+        [input](uint64_t offset, uint8_t* buffer, size_t len) {
+            std::memcpy(buffer, input + offset, len);
+            return true;
+        },
+        pool, 0, digest);
+    return digest;
+}
+
+bool Blake3HashSegmented(uint64_t totalLength,
+                         const Blake3SegmentReader& reader,
+                         WorkerPool& pool,
+                         size_t maxParallel,
+                         Blake3Digest& out) {
+    // Inputs that fit in one segment are the root chunk/subtree themselves.
+    if (totalLength <= BLAKE3_SEGMENT_LEN) {
+        std::vector<uint8_t> buffer(static_cast<size_t>(totalLength));
+        if (totalLength > 0 && !reader(0, buffer.data(), buffer.size())) return false;
+        out = Blake3Hash(buffer.data(), buffer.size());
+        return true;
+    }
+
+    const size_t segments =
+        static_cast<size_t>((totalLength + BLAKE3_SEGMENT_LEN - 1) / BLAKE3_SEGMENT_LEN);
+    std::vector<uint32_t> storage(segments * 8);
+    auto* cvs = reinterpret_cast<uint32_t (*)[8]>(storage.data());
+
+    std::atomic<size_t> nextSegment{0};
+    std::atomic<bool> failed{false};
+
+    // Each runner owns one segment buffer and pulls segments until none
+    // remain, so memory stays bounded by the degree of parallelism.
+    auto runner = [&]() {
+        std::unique_ptr<uint8_t[]> buffer(new uint8_t[BLAKE3_SEGMENT_LEN]);
+        for (;;) {
+            size_t index = nextSegment.fetch_add(1, std::memory_order_relaxed);
+            if (index >= segments || failed.load(std::memory_order_relaxed)) return;
+
+            uint64_t offset = static_cast<uint64_t>(index) * BLAKE3_SEGMENT_LEN;
+            size_t len = static_cast<size_t>(
+                std::min<uint64_t>(BLAKE3_SEGMENT_LEN, totalLength - offset));
+            if (!reader(offset, buffer.get(), len)) {
+                failed.store(true, std::memory_order_relaxed);
+                return;
+            }
+            SubtreeCv(buffer.get(), len, index * CHUNKS_PER_SEGMENT, cvs[index]);
+            // A large bulk hash keeps its runners busy for a long time;
+            // let more urgent work through between segments.
+            pool.RunUrgentTask();
+        }
+    };
+
+    size_t parallel = maxParallel == 0 ? pool.ThreadCount() + 1 : maxParallel;
+    parallel = std::min(parallel, segments);
+
+    WaitGroup group(pool);
+    for (size_t i = 1; i < parallel; i++) group.Run(runner);
+    runner();
+    group.Wait();
+
+    if (failed.load()) return false;
+
+    uint32_t root[8];
+    MergeCvs(cvs, segments, ROOT, root);
+    out = DigestFromCv(root);
+    return true;
+}
+
+} // namespace TerminAI
@@ -0,0 +1,132 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - BLAKE3 Hash Header
+ *
+ * Self-contained BLAKE3 implementation used for content addressing
+ * (workspace snapshots, scan verdict cache keys). Only the default hash
+ * mode with 32-byte output is implemented.
+ *
+ * Two entry points are provided:
+ * - Blake3Hasher: incremental hashing for streamed input
+ * - Blake3HashParallel: one-shot tree hashing that splits large inputs into
+ *   independent subtrees and hashes them on a WorkerPool
+ *
+ * On x86-64 both paths hash four chunks at a time with SSE2.
+ *
+ * @see https://github.com/BLAKE3-team/BLAKE3-specs
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace TerminAI {
+
+class WorkerPool;
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+constexpr size_t BLAKE3_OUT_LEN = 32;
+constexpr size_t BLAKE3_BLOCK_LEN = 64;
+constexpr size_t BLAKE3_CHUNK_LEN = 1024;
+
+/**
+ * Size of the independent subtrees handed to worker threads by the parallel
+ * hashing paths. Must be a power-of-two multiple of BLAKE3_CHUNK_LEN so that
+ * every segment is a complete node of the BLAKE3 tree.
+ */
+constexpr size_t BLAKE3_SEGMENT_LEN = 1024 * BLAKE3_CHUNK_LEN;
+
+/** A 32-byte BLAKE3 digest. */
+struct Blake3Digest {
+    uint8_t bytes[BLAKE3_OUT_LEN] = {};
+
+    bool operator==(const Blake3Digest& other) const;
+    bool operator!=(const Blake3Digest& other) const { return !(*this == other); }
+
+    /** Lowercase hex encoding (64 characters). */
+    std::string ToHex() const;
+
+    /** Parse a 64-character hex string. Returns false on malformed input. */
+    static bool FromHex(const std::string& hex, Blake3Digest& out);
+};
+
+// ============================================================================
+// Incremental Hasher
+// ============================================================================
+
+class Blake3Hasher {
+public:
+    Blake3Hasher();
+
+    /** Absorb more input. */
+    void Update(const void* data, size_t length);
+
+    /** Produce the digest of everything absorbed so far. Does not reset. */
+    Blake3Digest Finalize() const;
+
+private:
+    struct ChunkState {
+        uint32_t cv[8];
+        uint64_t chunkCounter;
+        uint8_t block[BLAKE3_BLOCK_LEN];
+        uint8_t blockLen;
+        uint8_t blocksCompressed;
+    };
+
+    void ResetChunk(uint64_t chunkCounter);
+    size_t ChunkLen() const;
+    void PushChunkCv(const uint32_t cv[8], uint64_t totalChunks);
+
+    ChunkState chunk_;
+    // Enough for 2^54 chunks, far more than any single input we hash.
+    uint32_t cvStack_[54][8];
+    uint8_t cvStackLen_ = 0;
+};
+
+// ============================================================================
+// One-shot Hashing
+// ============================================================================
+
+/** Hash a buffer on the calling thread. */
+Blake3Digest Blake3Hash(const void* data, size_t length);
+
+/**
+ * Hash a buffer, splitting inputs larger than one segment across the pool.
+ * Produces exactly the same digest as Blake3Hash().
+ */
+Blake3Digest Blake3HashParallel(const void* data, size_t length, WorkerPool& pool);
+
+/**
+ * Reader callback for Blake3HashSegmented: fill `buffer` with `length` bytes
+ * starting at `offset`. Returns false on I/O failure.
+ */
+using Blake3SegmentReader =
+    std::function<bool(uint64_t offset, uint8_t* buffer, size_t length)>;
+
+/**
+ * Hash `totalLength` bytes produced by `reader`, one BLAKE3_SEGMENT_LEN
+ * segment per task. Each task reads and hashes its own segment, so both I/O
+ * and hashing proceed in parallel without buffering the whole input.
+ *
+ * @param maxParallel Upper bound on concurrently running segment tasks
+ *                    (0 = pool size)
+ * @return false if any read failed
+ */
+bool Blake3HashSegmented(uint64_t totalLength,
+                         const Blake3SegmentReader& reader,
+                         WorkerPool& pool,
+                         size_t maxParallel,
+                         Blake3Digest& out);
+
+} // namespace TerminAI
@@ -0,0 +1,916 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Call Trace Implementation
+ */
+
+#include "call_trace.h"
+#include "blake3.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#include "appcontainer_manager.h"
+
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace TerminAI {
+
+namespace {
+
+constexpr char TRACE_MAGIC[8] = {'T', 'A', 'I', 'T', 'R', 'A', 'C', 'E'};
+constexpr uint32_t TRACE_VERSION = 1;
+constexpr size_t HEADER_BYTES = 24;
+constexpr uint32_t FLAG_REDACTED = 1;
+
+constexpr size_t FLUSH_BYTES = 256 * 1024;
+constexpr int MAX_ARG_DEPTH = 4;
+constexpr int MAX_RESULT_DEPTH = 2;
+constexpr uint32_t MAX_ENTRIES = 64;
+constexpr size_t DIGEST_BYTES = 8;
+
+enum RecordType : uint8_t {
+    RecordName = 'N',
+    RecordCall = 'C',
+    RecordSettle = 'P',
+    RecordEnd = 'E',
+};
+
+enum CallStatus : uint8_t {
+    StatusReturned = 0,
+    StatusThrew = 1,
+    StatusResolved = 2,
+    StatusRejected = 3,
+    /** Returned a promise that has not settled (yet) */
+    StatusPending = 4,
+};
+
+enum ValueTag : uint8_t {
+    TagUndefined = 0,
+    TagNull = 1,
+    TagFalse = 2,
+    TagTrue = 3,
+    TagNumber = 4,
+    TagString = 5,
+    TagDigestedString = 6,
+    TagBuffer = 7,
+    TagArray = 8,
+    TagObject = 9,
+    TagFunction = 10,
+    TagTruncated = 11,
+};
+
+struct TraceLimits {
+    size_t maxStringBytes = 256;
+    size_t maxDigestBytes = 65536;
+    bool redactStrings = true;
+    uint64_t maxBytes = 256ull * 1024 * 1024;
+};
+
+// ============================================================================
+// Encoding
+// ============================================================================
+
+void PutVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void PutBytes(std::vector<uint8_t>& out, const void* data, size_t length) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    out.insert(out.end(), bytes, bytes + length);
+}
+
+void PutString(std::vector<uint8_t>& out, const std::string& value) {
+    PutVarint(out, value.size());
+    PutBytes(out, value.data(), value.size());
+}
+
+void PutDigest(std::vector<uint8_t>& out, const void* data, size_t length) {
+    Blake3Digest digest = Blake3Hash(data, length);
+    PutBytes(out, digest.bytes, DIGEST_BYTES);
+}
+
+void EncodeValue(const Napi::Value& value, int depth, const TraceLimits& limits,
+                 std::vector<uint8_t>& out) {
+    if (value.IsUndefined()) {
+        out.push_back(TagUndefined);
+    } else if (value.IsNull()) {
+        out.push_back(TagNull);
+    } else if (value.IsBoolean()) {
+        out.push_back(value.As<Napi::Boolean>().Value() ? TagTrue : TagFalse);
+    } else if (value.IsNumber()) {
+        double number = value.As<Napi::Number>().DoubleValue();
+        out.push_back(TagNumber);
+        PutBytes(out, &number, sizeof(number));
+    } else if (value.IsString()) {
+        std::string text = value.As<Napi::String>().Utf8Value();
+        if (!limits.redactStrings && text.size() <= limits.maxStringBytes) {
+            out.push_back(TagString);
+            PutString(out, text);
+        } else {
+            out.push_back(TagDigestedString);
+            PutVarint(out, text.size());
+            PutDigest(out, text.data(), text.size());
+        }
+    } else if (value.IsTypedArray() || value.IsArrayBuffer()) {
+        const uint8_t* data = nullptr;
+        size_t length = 0;
+        if (value.IsTypedArray()) {
+            Napi::TypedArray array = value.As<Napi::TypedArray>();
+            length = array.ByteLength();
+            data = static_cast<const uint8_t*>(array.ArrayBuffer().Data()) + array.ByteOffset();
+        } else {
+            Napi::ArrayBuffer buffer = value.As<Napi::ArrayBuffer>();
+            length = buffer.ByteLength();
+            data = static_cast<const uint8_t*>(buffer.Data());
+        }
+        out.push_back(TagBuffer);
+        PutVarint(out, length);
+        PutDigest(out, data, std::min(length, limits.maxDigestBytes));
+    } else if (value.IsFunction()) {
+        out.push_back(TagFunction);
+    } else if (depth <= 0 || value.IsPromise()) {
+        out.push_back(TagTruncated);
+    } else if (value.IsArray()) {
+        Napi::Array array = value.As<Napi::Array>();
+        uint32_t length = array.Length();
+        uint32_t encoded = std::min(length, MAX_ENTRIES);
+        out.push_back(TagArray);
+        PutVarint(out, length);
+        PutVarint(out, encoded);
+        for (uint32_t i = 0; i < encoded; i++) {
+            EncodeValue(array.Get(i), depth - 1, limits, out);
+        }
+    } else if (value.IsObject()) {
+        Napi::Object object = value.As<Napi::Object>();
+        Napi::Array names = object.GetPropertyNames();
+        uint32_t encoded = std::min(names.Length(), MAX_ENTRIES);
+        out.push_back(TagObject);
+        PutVarint(out, encoded);
+        for (uint32_t i = 0; i < encoded; i++) {
+            Napi::Value name = names.Get(i);
+            std::string key = name.ToString().Utf8Value();
+            PutString(out, key);
+            // Variables carry tokens and keys: always digested.
+            if (key == "env" && !limits.redactStrings) {
+                TraceLimits redacted = limits;
+                redacted.redactStrings = true;
+                EncodeValue(object.Get(name), depth - 1, redacted, out);
+            } else {
+                EncodeValue(object.Get(name), depth - 1, limits, out);
+            }
+        }
+    } else {
+        // Symbols, BigInts and external values
+        out.push_back(TagTruncated);
+    }
+}
+
+// ============================================================================
+// Trace File
+// ============================================================================
+
+/**
+ * Create the trace for our user alone: a new file, never an existing one or
+ * a symlink, with mode 0600 (an owner-only DACL on Windows).
+ */
+std::FILE* CreateTraceFile(const std::string& path, std::string& error) {
+#ifdef _WIN32
+    PSECURITY_DESCRIPTOR descriptor = nullptr;
+    if (!ConvertStringSecurityDescriptorToSecurityDescriptorW(L"D:P(A;;FA;;;OW)", SDDL_REVISION_1,
+                                                              &descriptor, nullptr)) {
+        error = "cannot create " + path + ": " + GetWindowsErrorMessage(GetLastError());
+        return nullptr;
+    }
+    SECURITY_ATTRIBUTES attributes = {sizeof(attributes), descriptor, FALSE};
+    HANDLE handle = CreateFileW(Utf8ToWide(path).c_str(), GENERIC_WRITE, 0, &attributes,
+                                CREATE_NEW, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OPEN_REPARSE_POINT,
+                                nullptr);
+    DWORD createError = GetLastError();
+    LocalFree(descriptor);
+    if (handle == INVALID_HANDLE_VALUE) {
+        error = "cannot create " + path + ": " + GetWindowsErrorMessage(createError);
+        return nullptr;
+    }
+    int fd = _open_osfhandle(reinterpret_cast<intptr_t>(handle), _O_WRONLY | _O_BINARY);
+    if (fd < 0) {
+        CloseHandle(handle);
+        error = "cannot create " + path;
+        return nullptr;
+    }
+    std::FILE* file = _fdopen(fd, "wb");
+    if (file == nullptr) _close(fd);
+#else
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        error = "cannot create " + path + ": " + std::strerror(errno);
+        return nullptr;
+    }
+    std::FILE* file = fdopen(fd, "wb");
+    if (file == nullptr) close(fd);
+#endif
+    if (file == nullptr) error = "cannot create " + path;
+    return file;
+}
+
+// ============================================================================
+// Trace Session
+// ============================================================================
+
+struct TracedExport;
+
+/** Only touched on the JavaScript thread, plus the exit flush. */
+class TraceSession {
+public:
+    std::string path;
+    TraceLimits limits;
+    Napi::ObjectReference target;
+    std::vector<TracedExport*> exports;
+
+    bool Open(std::string& error) {
+        file_ = CreateTraceFile(path, error);
+        if (file_ == nullptr) return false;
+        start_ = std::chrono::steady_clock::now();
+        uint64_t startedAtUs = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        uint32_t flags = limits.redactStrings ? FLAG_REDACTED : 0;
+        PutBytes(buffer_, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+        PutBytes(buffer_, &TRACE_VERSION, sizeof(TRACE_VERSION));
+        PutBytes(buffer_, &flags, sizeof(flags));
+        PutBytes(buffer_, &startedAtUs, sizeof(startedAtUs));
+        return true;
+    }
+
+    uint64_t Now() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_).count();
+    }
+
+    /** Start a record, or return false once the trace is full. */
+    bool Begin() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (written_ + buffer_.size() >= limits.maxBytes) {
+            dropped_++;
+            return false;
+        }
+        return true;
+    }
+
+    void Append(const std::vector<uint8_t>& record, bool call) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        buffer_.insert(buffer_.end(), record.begin(), record.end());
+        if (call) calls_++;
+        if (buffer_.size() >= FLUSH_BYTES) FlushLocked();
+    }
+
+    /** Write the end record and close. Returns the file size. */
+    uint64_t Close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (file_ == nullptr) return written_;
+        durationNs_ = Now();
+        buffer_.push_back(RecordEnd);
+        PutVarint(buffer_, durationNs_);
+        PutVarint(buffer_, dropped_);
+        FlushLocked();
+        std::fclose(file_);
+        file_ = nullptr;
+        return written_;
+    }
+
+    uint64_t Calls() const { return calls_; }
+    uint64_t Dropped() const { return dropped_; }
+    double DurationMs() const { return static_cast<double>(durationNs_) / 1e6; }
+
+private:
+    void FlushLocked() {
+        if (file_ != nullptr && !buffer_.empty()) {
+            std::fwrite(buffer_.data(), 1, buffer_.size(), file_);
+            std::fflush(file_);
+        }
+        written_ += buffer_.size();
+        buffer_.clear();
+    }
+
+    std::mutex mutex_;
+    std::FILE* file_ = nullptr;
+    std::vector<uint8_t> buffer_;
+    std::chrono::steady_clock::time_point start_;
+    uint64_t written_ = 0;
+    uint64_t calls_ = 0;
+    uint64_t dropped_ = 0;
+    uint64_t durationNs_ = 0;
+};
+
+struct TracedExport {
+    std::string name;
+    Napi::FunctionReference original;
+    /** Name id in the current trace (0 = not written yet) */
+    uint64_t nameId = 0;
+};
+
+std::mutex g_traceMutex;
+TraceSession* g_trace = nullptr;
+uint64_t g_nextSeq = 0;
+uint64_t g_nextNameId = 0;
+
+// Wrappers outlive the trace they were made for (a caller may hold one),
+// so these are never freed; a wrapper called after the trace stopped just
+// forwards.
+std::unordered_map<std::string, TracedExport*>& TracedExports() {
+    static auto* exports = new std::unordered_map<std::string, TracedExport*>();
+    return *exports;
+}
+
+void FlushTraceAtExit() {
+    std::lock_guard<std::mutex> lock(g_traceMutex);
+    if (g_trace != nullptr) g_trace->Close();
+}
+
+void WriteSettle(uint64_t seq, CallStatus status, const Napi::Value& value) {
+    TraceSession* trace = g_trace;
+    if (trace == nullptr) return;
+    std::vector<uint8_t> record;
+    record.push_back(RecordSettle);
+    PutVarint(record, seq);
+    PutVarint(record, trace->Now());
+    record.push_back(status);
+    EncodeValue(value, MAX_RESULT_DEPTH, trace->limits, record);
+    trace->Append(record, false);
+}
+
+Napi::Value TracedCall(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    auto* entry = static_cast<TracedExport*>(info.Data());
+
+    std::vector<napi_value> args;
+    args.reserve(info.Length());
+    for (size_t i = 0; i < info.Length(); i++) args.push_back(info[i]);
+
+    TraceSession* trace = g_trace;
+    if (trace == nullptr || !trace->Begin()) {
+        return entry->original.Call(info.This(), args);
+    }
+
+    std::vector<uint8_t> record;
+    if (entry->nameId == 0) {
+        entry->nameId = ++g_nextNameId;
+        record.push_back(RecordName);
+        PutVarint(record, entry->nameId);
+        PutString(record, entry->name);
+    }
+    std::vector<uint8_t> encodedArgs;
+    PutVarint(encodedArgs, args.size());
+    for (size_t i = 0; i < info.Length(); i++) {
+        EncodeValue(info[i], MAX_ARG_DEPTH, trace->limits, encodedArgs);
+    }
+    // A throwing getter on an argument surfaces as if the call threw.
+    if (env.IsExceptionPending()) return env.Undefined();
+
+    uint64_t seq = ++g_nextSeq;
+    uint64_t start = trace->Now();
+    Napi::Value result = entry->original.Call(info.This(), args);
+    uint64_t end = trace->Now();
+
+    record.push_back(RecordCall);
+    PutVarint(record, seq);
+    PutVarint(record, entry->nameId);
+    PutVarint(record, start);
+    PutVarint(record, end - start);
+    if (env.IsExceptionPending()) {
+        record.push_back(StatusThrew);
+        record.push_back(TagUndefined);
+        record.insert(record.end(), encodedArgs.begin(), encodedArgs.end());
+        trace->Append(record, true);
+        return result;
+    }
+    bool promised = result.IsPromise();
+    record.push_back(promised ? StatusPending : StatusReturned);
+    EncodeValue(result, MAX_RESULT_DEPTH, trace->limits, record);
+    record.insert(record.end(), encodedArgs.begin(), encodedArgs.end());
+    trace->Append(record, true);
+
+    if (promised) {
+        // Settle handlers time the async part. The derived promise always
+        // fulfils, so it never reports an unhandled rejection of its own.
+        Napi::Object promise = result.As<Napi::Object>();
+        Napi::Function onResolved = Napi::Function::New(env, [seq](const Napi::CallbackInfo& settled) {
+            WriteSettle(seq, StatusResolved, settled[0]);
+            return settled.Env().Undefined();
+        });
+        Napi::Function onRejected = Napi::Function::New(env, [seq](const Napi::CallbackInfo& settled) {
+            WriteSettle(seq, StatusRejected, settled[0]);
+            return settled.Env().Undefined();
+        });
+        promise.Get("then").As<Napi::Function>().Call(promise, {onResolved, onRejected});
+    }
+    return result;
+}
+
+bool ReadSize(const Napi::Object& options, const char* name, double max, uint64_t& out,
+              std::string& error) {
+    Napi::Value value = options.Get(name);
+    if (value.IsUndefined()) return true;
+    double number = value.IsNumber() ? value.As<Napi::Number>().DoubleValue() : -1;
+    if (!(number >= 0 && number <= max)) {
+        error = std::string(name) + " must be a number between 0 and " + std::to_string(max);
+        return false;
+    }
+    out = static_cast<uint64_t>(number);
+    return true;
+}
+
+/** Restore the exports and close the trace; caller holds g_traceMutex. */
+uint64_t StopTraceLocked() {
+    TraceSession* trace = g_trace;
+    g_trace = nullptr;
+    if (!trace->target.IsEmpty()) {
+        Napi::Object target = trace->target.Value();
+        for (TracedExport* entry : trace->exports) {
+            target.Set(entry->name, entry->original.Value());
+        }
+    }
+    trace->target.Reset();
+    return trace->Close();
+}
+
+// ============================================================================
+// Decoding
+// ============================================================================
+
+struct DecodedValue {
+    uint8_t tag = TagUndefined;
+    double number = 0;
+    std::string text;
+    uint64_t length = 0;
+    std::string digest;
+    std::vector<std::pair<std::string, DecodedValue>> fields;
+    std::vector<DecodedValue> items;
+};
+
+struct DecodedCall {
+    uint64_t seq = 0;
+    std::string name;
+    uint64_t startNs = 0;
+    uint64_t syncNs = 0;
+    uint64_t endNs = 0;
+    uint8_t status = StatusReturned;
+    DecodedValue result;
+    std::vector<DecodedValue> args;
+    uint64_t payloadBytes = 0;
+};
+
+struct DecodedTrace {
+    uint32_t version = 0;
+    uint64_t startedAtUs = 0;
+    uint64_t durationNs = 0;
+    uint64_t dropped = 0;
+    bool complete = false;
+    std::vector<DecodedCall> calls;
+};
+
+class TraceReader {
+public:
+    TraceReader(const uint8_t* data, size_t length) : p_(data), end_(data + length) {}
+
+    bool AtEnd() const { return p_ >= end_; }
+
+    bool Byte(uint8_t& out) {
+        if (p_ >= end_) return false;
+        out = *p_++;
+        return true;
+    }
+
+    bool Varint(uint64_t& out) {
+        out = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t byte;
+            if (!Byte(byte)) return false;
+            out |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) return true;
+        }
+        return false;
+    }
+
+    bool Bytes(size_t length, std::string& out) {
+        if (static_cast<size_t>(end_ - p_) < length) return false;
+        out.assign(reinterpret_cast<const char*>(p_), length);
+        p_ += length;
+        return true;
+    }
+
+    bool String(std::string& out) {
+        uint64_t length;
+        return Varint(length) && Bytes(length, out);
+    }
+
+    bool Digest(std::string& hex) {
+        std::string raw;
+        if (!Bytes(DIGEST_BYTES, raw)) return false;
+        static const char digits[] = "0123456789abcdef";
+        hex.clear();
+        for (unsigned char c : raw) {
+            hex.push_back(digits[c >> 4]);
+            hex.push_back(digits[c & 15]);
+        }
+        return true;
+    }
+
+    /** Decode one value, adding string and buffer lengths to `payload`. */
+    bool Value(DecodedValue& out, uint64_t& payload, int depth = 0) {
+        if (depth > MAX_ARG_DEPTH + 1 || !Byte(out.tag)) return false;
+        switch (out.tag) {
+        case TagUndefined:
+        case TagNull:
+        case TagFalse:
+        case TagTrue:
+        case TagFunction:
+        case TagTruncated:
+            return true;
+        case TagNumber: {
+            std::string raw;
+            if (!Bytes(sizeof(double), raw)) return false;
+            std::memcpy(&out.number, raw.data(), sizeof(double));
+            return true;
+        }
+        case TagString:
+            if (!String(out.text)) return false;
+            payload += out.text.size();
+            return true;
+        case TagDigestedString:
+        case TagBuffer:
+            if (!Varint(out.length) || !Digest(out.digest)) return false;
+            payload += out.length;
+            return true;
+        case TagArray: {
+            uint64_t encoded;
+            if (!Varint(out.length) || !Varint(encoded) || encoded > MAX_ENTRIES) return false;
+            out.items.resize(encoded);
+            for (auto& item : out.items) {
+                if (!Value(item, payload, depth + 1)) return false;
+            }
+            return true;
+        }
+        case TagObject: {
+            uint64_t count;
+            if (!Varint(count) || count > MAX_ENTRIES) return false;
+            out.fields.resize(count);
+            for (auto& field : out.fields) {
+                if (!String(field.first) || !Value(field.second, payload, depth + 1)) return false;
+            }
+            return true;
+        }
+        default:
+            return false;
+        }
+    }
+
+private:
+    const uint8_t* p_;
+    const uint8_t* end_;
+};
+
+/**
+ * Decode a whole trace. A trace cut short (the process died while
+ * recording) decodes up to its last complete record, with complete false.
+ */
+bool DecodeTrace(const std::vector<uint8_t>& bytes, DecodedTrace& trace, std::string& error) {
+    if (bytes.size() < HEADER_BYTES || std::memcmp(bytes.data(), TRACE_MAGIC, 8) != 0) {
+        error = "not a native trace";
+        return false;
+    }
+    std::memcpy(&trace.version, bytes.data() + 8, sizeof(uint32_t));
+    std::memcpy(&trace.startedAtUs, bytes.data() + 16, sizeof(uint64_t));
+    if (trace.version != TRACE_VERSION) {
+        error = "unsupported trace version " + std::to_string(trace.version);
+        return false;
+    }
+
+    std::unordered_map<uint64_t, std::string> names;
+    std::unordered_map<uint64_t, size_t> bySeq;
+    TraceReader reader(bytes.data() + HEADER_BYTES, bytes.size() - HEADER_BYTES);
+    while (!reader.AtEnd()) {
+        uint8_t type;
+        reader.Byte(type);
+        if (type == RecordName) {
+            uint64_t id;
+            std::string name;
+            if (!reader.Varint(id) || !reader.String(name)) break;
+            names[id] = std::move(name);
+        } else if (type == RecordCall) {
+            DecodedCall call;
+            uint64_t nameId, argc, ignored = 0;
+            if (!reader.Varint(call.seq) || !reader.Varint(nameId) || !reader.Varint(call.startNs) ||
+                !reader.Varint(call.syncNs) || !reader.Byte(call.status) ||
+                !reader.Value(call.result, ignored) || !reader.Varint(argc) || argc > MAX_ENTRIES) {
+                break;
+            }
+            call.args.resize(argc);
+            bool ok = true;
+            for (auto& arg : call.args) ok = ok && reader.Value(arg, call.payloadBytes);
+            if (!ok) break;
+            auto name = names.find(nameId);
+            call.name = name == names.end() ? "?" : name->second;
+            call.endNs = call.startNs + call.syncNs;
+            bySeq[call.seq] = trace.calls.size();
+            trace.calls.push_back(std::move(call));
+        } else if (type == RecordSettle) {
+            uint64_t seq, endNs, ignored = 0;
+            uint8_t status;
+            DecodedValue value;
+            if (!reader.Varint(seq) || !reader.Varint(endNs) || !reader.Byte(status) ||
+                !reader.Value(value, ignored)) {
+                break;
+            }
+            auto it = bySeq.find(seq);
+            if (it != bySeq.end()) {
+                DecodedCall& call = trace.calls[it->second];
+                call.endNs = endNs;
+                call.status = status;
+                call.result = std::move(value);
+            }
+        } else if (type == RecordEnd) {
+            if (reader.Varint(trace.durationNs) && reader.Varint(trace.dropped)) {
+                trace.complete = true;
+            }
+            break;
+        } else {
+            break;
+        }
+    }
+    return true;
+}
+
+Napi::Value DecodedToValue(Napi::Env env, const DecodedValue& value) {
+    auto marker = [&env](const char* key, Napi::Value content) {
+        Napi::Object object = Napi::Object::New(env);
+        object.Set(key, content);
+        return object;
+    };
+    switch (value.tag) {
+    case TagNull:
+        return env.Null();
+    case TagFalse:
+    case TagTrue:
+        return Napi::Boolean::New(env, value.tag == TagTrue);
+    case TagNumber:
+        return Napi::Number::New(env, value.number);
+    case TagString:
+        return Napi::String::New(env, value.text);
+    case TagDigestedString:
+    case TagBuffer: {
+        Napi::Object object = marker(value.tag == TagBuffer ? "$buffer" : "$string",
+                                     Napi::Number::New(env, static_cast<double>(value.length)));
+        object.Set("digest", Napi::String::New(env, value.digest));
+        return object;
+    }
+    case TagFunction:
+        return marker("$function", Napi::Boolean::New(env, true));
+    case TagTruncated:
+        return marker("$truncated", Napi::Boolean::New(env, true));
+    case TagArray: {
+        Napi::Array items = Napi::Array::New(env, value.items.size());
+        for (size_t i = 0; i < value.items.size(); i++) {
+            items.Set(static_cast<uint32_t>(i), DecodedToValue(env, value.items[i]));
+        }
+        if (value.items.size() == value.length) return items;
+        Napi::Object object = marker("$array", Napi::Number::New(env, static_cast<double>(value.length)));
+        object.Set("items", items);
+        return object;
+    }
+    case TagObject: {
+        Napi::Object object = Napi::Object::New(env);
+        for (const auto& field : value.fields) {
+            object.Set(field.first, DecodedToValue(env, field.second));
+        }
+        return object;
+    }
+    default:
+        return env.Undefined();
+    }
+}
+
+const char* StatusName(uint8_t status) {
+    switch (status) {
+    case StatusThrew:
+        return "threw";
+    case StatusResolved:
+        return "resolved";
+    case StatusRejected:
+        return "rejected";
+    case StatusPending:
+        return "pending";
+    default:
+        return "returned";
+    }
+}
+
+class ReadTraceWorker : public Napi::AsyncWorker {
+public:
+    ReadTraceWorker(Napi::Env env, std::string path)
+        : Napi::AsyncWorker(env), deferred_(Napi::Promise::Deferred::New(env)), path_(std::move(path)) {}
+
+    Napi::Promise Promise() const { return deferred_.Promise(); }
+
+    void Execute() override {
+        std::ifstream in(path_, std::ios::binary);
+        if (!in) {
+            SetError("cannot open " + path_);
+            return;
+        }
+        std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::string error;
+        if (!DecodeTrace(bytes, trace_, error)) SetError(path_ + ": " + error);
+    }
+
+    void OnOK() override {
+        Napi::Env env = Env();
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("version", Napi::Number::New(env, trace_.version));
+        result.Set("startedAt", Napi::Number::New(env, static_cast<double>(trace_.startedAtUs) / 1000));
+        result.Set("durationMs", Napi::Number::New(env, static_cast<double>(trace_.durationNs) / 1e6));
+        result.Set("dropped", Napi::Number::New(env, static_cast<double>(trace_.dropped)));
+        result.Set("complete", Napi::Boolean::New(env, trace_.complete));
+
+        Napi::Array calls = Napi::Array::New(env, trace_.calls.size());
+        for (size_t i = 0; i < trace_.calls.size(); i++) {
+            const DecodedCall& call = trace_.calls[i];
+            Napi::Object entry = Napi::Object::New(env);
+            entry.Set("seq", Napi::Number::New(env, static_cast<double>(call.seq)));
+            entry.Set("name", Napi::String::New(env, call.name));
+            entry.Set("startUs", Napi::Number::New(env, static_cast<double>(call.startNs) / 1000));
+            entry.Set("syncUs", Napi::Number::New(env, static_cast<double>(call.syncNs) / 1000));
+            double durationUs = static_cast<double>(call.endNs - call.startNs) / 1000;
+            entry.Set("durationUs", call.status == StatusPending ? env.Null()
+                                                                : Napi::Number::New(env, durationUs));
+            entry.Set("status", Napi::String::New(env, StatusName(call.status)));
+            Napi::Array args = Napi::Array::New(env, call.args.size());
+            for (size_t a = 0; a < call.args.size(); a++) {
+                args.Set(static_cast<uint32_t>(a), DecodedToValue(env, call.args[a]));
+            }
+            entry.Set("args", args);
+            entry.Set("result", DecodedToValue(env, call.result));
+            entry.Set("payloadBytes", Napi::Number::New(env, static_cast<double>(call.payloadBytes)));
+            calls.Set(static_cast<uint32_t>(i), entry);
+        }
+        result.Set("calls", calls);
+        deferred_.Resolve(result);
+    }
+
+    void OnError(const Napi::Error& error) override {
+        deferred_.Reject(error.Value());
+    }
+
+private:
+    Napi::Promise::Deferred deferred_;
+    std::string path_;
+    DecodedTrace trace_;
+};
+
+} // namespace
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+Napi::Value StartNativeTrace(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString() || !info.This().IsObject()) {
+        Napi::TypeError::New(env, "startNativeTrace expects a path and the module as this")
+            .ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    auto trace = std::make_unique<TraceSession>();
+    trace->path = info[0].As<Napi::String>().Utf8Value();
+    std::string error;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Object options = info[1].As<Napi::Object>();
+        uint64_t maxString = trace->limits.maxStringBytes;
+        uint64_t maxDigest = trace->limits.maxDigestBytes;
+        if (!ReadSize(options, "maxStringBytes", 1 << 20, maxString, error) ||
+            !ReadSize(options, "maxDigestBytes", 1ull << 40, maxDigest, error) ||
+            !ReadSize(options, "maxBytes", 1ull << 50, trace->limits.maxBytes, error)) {
+            Napi::TypeError::New(env, error).ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        trace->limits.maxStringBytes = maxString;
+        trace->limits.maxDigestBytes = maxDigest;
+        Napi::Value redact = options.Get("redactStrings");
+        if (redact.IsBoolean()) trace->limits.redactStrings = redact.As<Napi::Boolean>().Value();
+    }
+
+    std::lock_guard<std::mutex> lock(g_traceMutex);
+    if (g_trace != nullptr) {
+        TraceSession* previous = g_trace;
+        StopTraceLocked();
+        delete previous;
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    if (!trace->Open(error)) {
+        result.Set("ok", Napi::Boolean::New(env, false));
+        result.Set("exports", Napi::Number::New(env, 0));
+        result.Set("error", Napi::String::New(env, error));
+        return result;
+    }
+
+    // Data properties holding functions only: reading an accessor (such as
+    // isAmsiAvailable) could have side effects.
+    Napi::Object target = info.This().As<Napi::Object>();
+    Napi::Function describe = env.Global().Get("Object").As<Napi::Object>()
+                                  .Get("getOwnPropertyDescriptor").As<Napi::Function>();
+    Napi::Array names = target.GetPropertyNames();
+    for (uint32_t i = 0; i < names.Length(); i++) {
+        std::string name = names.Get(i).ToString().Utf8Value();
+        if (name == "startNativeTrace" || name == "stopNativeTrace" || name == "readNativeTrace") {
+            continue;
+        }
+        Napi::Value descriptor = describe.Call({target, names.Get(i)});
+        if (!descriptor.IsObject()) continue;
+        Napi::Value value = descriptor.As<Napi::Object>().Get("value");
+        if (!value.IsFunction()) continue;
+
+        TracedExport*& entry = TracedExports()[name];
+        if (entry == nullptr) entry = new TracedExport{name, {}, 0};
+        entry->original = Napi::Persistent(value.As<Napi::Function>());
+        entry->nameId = 0;
+        target.Set(name, Napi::Function::New(env, TracedCall, entry->name.c_str(), entry));
+        trace->exports.push_back(entry);
+    }
+    trace->target = Napi::Persistent(target);
+
+    static bool exitHookInstalled = false;
+    if (!exitHookInstalled) {
+        std::atexit(FlushTraceAtExit);
+        exitHookInstalled = true;
+    }
+
+    size_t traced = trace->exports.size();
+    g_trace = trace.release();
+    g_nextSeq = 0;
+    g_nextNameId = 0;
+
+    result.Set("ok", Napi::Boolean::New(env, true));
+    result.Set("exports", Napi::Number::New(env, static_cast<double>(traced)));
+    return result;
+}
+
+Napi::Value StopNativeTrace(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    std::lock_guard<std::mutex> lock(g_traceMutex);
+    if (g_trace == nullptr) return env.Null();
+    TraceSession* trace = g_trace;
+    uint64_t bytes = StopTraceLocked();
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("path", Napi::String::New(env, trace->path));
+    result.Set("calls", Napi::Number::New(env, static_cast<double>(trace->Calls())));
+    result.Set("dropped", Napi::Number::New(env, static_cast<double>(trace->Dropped())));
+    result.Set("bytes", Napi::Number::New(env, static_cast<double>(bytes)));
+    result.Set("durationMs", Napi::Number::New(env, trace->DurationMs()));
+    delete trace;
+    return result;
+}
+
+Napi::Value ReadNativeTrace(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        auto deferred = Napi::Promise::Deferred::New(env);
+        deferred.Reject(Napi::TypeError::New(env, "readNativeTrace expects a path").Value());
+        return deferred.Promise();
+    }
+
+    auto* worker = new ReadTraceWorker(env, info[0].As<Napi::String>().Utf8Value());
+    Napi::Promise promise = worker->Promise();
+    worker->Queue();
+    return promise;
+}
+
+} // namespace TerminAI
@@ -0,0 +1,99 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Call Trace Header
+ *
+ * Records every call into the module's exports to a compact binary trace,
+ * so that broker sessions from the field can be replayed later as
+ * regression benchmarks (scripts/replay-native-trace.ts).
+ *
+ * Tracing costs nothing while it is off: startNativeTrace() replaces each
+ * exported function on the module object with a recording wrapper, and
+ * stopNativeTrace() puts the originals back. Callers that go through the
+ * module object (as native.ts does) are traced; functions copied out of it
+ * beforehand are not.
+ *
+ * Per call the trace holds the export, start time, time spent in the
+ * synchronous part, the arguments and the result. Calls returning a
+ * promise also get a settle record with the completion time and value, so
+ * async work is timed end to end. Argument encoding:
+ *
+ *   primitives          as is
+ *   strings             length and BLAKE3 digest; with redactStrings off,
+ *                       verbatim up to maxStringBytes, except anywhere
+ *                       under an `env` key
+ *   Buffers, typed      length and BLAKE3 digest of the first
+ *   arrays              maxDigestBytes; contents are never recorded
+ *   objects, arrays     recursively, 4 levels and 64 entries deep
+ *   functions           a marker
+ *
+ * File layout (little-endian): a 24-byte header (magic "TAITRACE",
+ * version, flags, wall-clock start in microseconds), then records
+ * introduced by one type byte and encoded with LEB128 varints:
+ *
+ *   'N' name    id, export name (first use of each export)
+ *   'C' call    seq, name id, start ns, sync ns, status, result, arguments
+ *   'P' settle  seq, end ns, status, value
+ *   'E' end     duration ns, calls dropped past maxBytes
+ *
+ * The file is created 0600 (owner-only on Windows) and must not exist.
+ * Recording runs on the JavaScript thread; the trace is buffered and
+ * written in 256 KiB blocks, and flushed at exit if it was not stopped.
+ */
+
+#pragma once
+
+#include <napi.h>
+
+namespace TerminAI {
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+/**
+ * Start recording calls to the module's exports. Call it as a method of
+ * the module object; a running trace is stopped first.
+ *
+ * Arguments:
+ *   0: String - Trace file path (created; an existing file or symlink
+ *      is refused)
+ *   1: Object (optional)
+ *      - maxStringBytes?: Number - longer strings are digested (default 256)
+ *      - maxDigestBytes?: Number - payload prefix digested (default 65536)
+ *      - redactStrings?: Boolean - digest every string (default true)
+ *      - maxBytes?: Number - stop recording calls past this trace size
+ *        (default 256 MiB)
+ *
+ * Returns: Object - { ok, exports: Number traced, error? }
+ */
+Napi::Value StartNativeTrace(const Napi::CallbackInfo& info);
+
+/**
+ * Stop recording, restore the exports and close the trace.
+ *
+ * Returns: Object | null - { path, calls, dropped, bytes, durationMs }, or
+ *          null if no trace is running
+ */
+Napi::Value StopNativeTrace(const Napi::CallbackInfo& info);
+
+/**
+ * Decode a trace file off the main thread.
+ *
+ * Arguments:
+ *   0: String - Trace file path
+ *
+ * Returns: Promise<Object> - { version, startedAt, durationMs, dropped,
+ *          complete, calls: [{ seq, name, startUs, syncUs, durationUs,
+ *          status, args, result, payloadBytes }] }
+ *   status is 'returned', 'threw', 'resolved', 'rejected' or 'pending';
+ *   digested values decode to { $string | $buffer: length, digest },
+ *   functions to { $function: true }, cut-off values to { $truncated: true }
+ *   and shortened arrays to { $array: length, items }.
+ */
+Napi::Value ReadNativeTrace(const Napi::CallbackInfo& info);
+
+} // namespace TerminAI
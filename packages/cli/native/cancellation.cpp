@@ -0,0 +1,302 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Deadlines and Cancellation Implementation
+ */
+
+#include "cancellation.h"
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef __linux__
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+namespace TerminAI {
+
+namespace {
+
+// ============================================================================
+// Counters
+// ============================================================================
+
+struct OperationCounters {
+    std::atomic<uint64_t> started{0};
+    std::atomic<uint64_t> completed{0};
+    std::atomic<uint64_t> cancelled{0};
+    std::atomic<uint64_t> expired{0};
+};
+
+constexpr size_t OPERATION_COUNT = static_cast<size_t>(CancellableOperation::Count);
+
+OperationCounters g_counters[OPERATION_COUNT];
+
+const char* const OPERATION_NAMES[OPERATION_COUNT] = {
+    "hashFile",
+    "snapshotDirectory",
+    "diffOverlay",
+    "commitOverlay",
+    "grantPathAccess",
+    "launchSandbox",
+    "waitSandbox",
+    "scanArchive",
+    "writeFileScanned",
+    "stageWorkspace",
+    "spawnProcess",
+};
+
+OperationCounters& CountersFor(CancellableOperation operation) {
+    return g_counters[static_cast<size_t>(operation)];
+}
+
+// ============================================================================
+// Option Parsing
+// ============================================================================
+
+/**
+ * Validate the options object and apply its deadline; returns the signal
+ * (or undefined) through `signal`.
+ */
+bool ParseOptions(const Napi::Value& value, CancelToken& token, Napi::Value& signal,
+                  std::string& error) {
+    signal = value.Env().Undefined();
+    if (value.IsUndefined() || value.IsNull()) return true;
+    if (!value.IsObject()) {
+        error = "options must be an object";
+        return false;
+    }
+    Napi::Object options = value.As<Napi::Object>();
+
+    Napi::Value timeout = options.Get("timeoutMs");
+    if (timeout.IsNumber()) {
+        double ms = timeout.As<Napi::Number>().DoubleValue();
+        if (std::isnan(ms) || ms < 0) {
+            error = "timeoutMs must be a non-negative number";
+            return false;
+        }
+        if (std::isfinite(ms)) token.SetTimeout(static_cast<int64_t>(std::ceil(ms)));
+    } else if (!timeout.IsUndefined()) {
+        error = "timeoutMs must be a number";
+        return false;
+    }
+
+    signal = options.Get("signal");
+    if (signal.IsUndefined() || signal.IsNull()) return true;
+    if (!signal.IsObject() || !signal.As<Napi::Object>().Get("addEventListener").IsFunction()) {
+        error = "signal must be an AbortSignal";
+        return false;
+    }
+    if (signal.As<Napi::Object>().Get("aborted").ToBoolean().Value()) token.Cancel();
+    return true;
+}
+
+} // namespace
+
+// ============================================================================
+// CancelToken
+// ============================================================================
+
+CancelToken::~CancelToken() {
+#ifdef __linux__
+    if (wakeFd_ >= 0) close(wakeFd_);
+#endif
+}
+
+void CancelToken::SetTimeout(int64_t timeoutMs) {
+    hasDeadline_ = true;
+    deadline_ = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+}
+
+void CancelToken::Cancel() {
+    if (cancelled_.exchange(true, std::memory_order_acq_rel)) return;
+#ifdef __linux__
+    std::lock_guard<std::mutex> lock(wakeMutex_);
+    if (wakeFd_ >= 0) {
+        uint64_t one = 1;
+        ssize_t ignored = write(wakeFd_, &one, sizeof(one));
+        (void)ignored;
+    }
+#endif
+}
+
+CancelReason CancelToken::Check() {
+    int outcome = outcome_.load(std::memory_order_relaxed);
+    if (outcome != 0) return static_cast<CancelReason>(outcome);
+
+    CancelReason reason = CancelReason::None;
+    if (cancelled_.load(std::memory_order_relaxed)) {
+        reason = CancelReason::Cancelled;
+    } else if (hasDeadline_ && std::chrono::steady_clock::now() >= deadline_) {
+        reason = CancelReason::Expired;
+    } else {
+        return CancelReason::None;
+    }
+
+    // Concurrent checkers agree on whichever reason was latched first.
+    int expected = 0;
+    outcome_.compare_exchange_strong(expected, static_cast<int>(reason),
+                                     std::memory_order_acq_rel);
+    return static_cast<CancelReason>(outcome_.load(std::memory_order_acquire));
+}
+
+int CancelToken::RemainingMs() const {
+    if (!hasDeadline_) return -1;
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline_ - std::chrono::steady_clock::now()).count();
+    // Round up so that a wait never wakes just short of the deadline.
+    return static_cast<int>(std::clamp<int64_t>(remaining + 1, 0, INT32_MAX));
+}
+
+#ifdef __linux__
+int CancelToken::WakeFd() {
+    std::lock_guard<std::mutex> lock(wakeMutex_);
+    if (wakeFd_ < 0) {
+        wakeFd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        // Cancel() before the fd existed had nothing to write to.
+        if (wakeFd_ >= 0 && cancelled_.load(std::memory_order_acquire)) {
+            uint64_t one = 1;
+            ssize_t ignored = write(wakeFd_, &one, sizeof(one));
+            (void)ignored;
+        }
+    }
+    return wakeFd_;
+}
+
+int CancelToken::PollTimeoutMs() {
+    constexpr int SLICE_MS = 10;
+    int remaining = RemainingMs();
+    if (WakeFd() >= 0) return remaining;
+    return remaining < 0 ? SLICE_MS : std::min(remaining, SLICE_MS);
+}
+#endif
+
+const char* CancelReasonMessage(CancelReason reason) {
+    switch (reason) {
+        case CancelReason::Cancelled: return "operation cancelled";
+        case CancelReason::Expired: return "deadline exceeded";
+        default: return "";
+    }
+}
+
+// ============================================================================
+// Counters
+// ============================================================================
+
+void RecordOperationStarted(CancellableOperation operation) {
+    CountersFor(operation).started.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RecordOperationFinished(CancellableOperation operation, CancelReason outcome) {
+    OperationCounters& counters = CountersFor(operation);
+    switch (outcome) {
+        case CancelReason::Cancelled:
+            counters.cancelled.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case CancelReason::Expired:
+            counters.expired.fetch_add(1, std::memory_order_relaxed);
+            break;
+        default:
+            counters.completed.fetch_add(1, std::memory_order_relaxed);
+            break;
+    }
+}
+
+// ============================================================================
+// CancelBinding
+// ============================================================================
+
+CancelBinding::CancelBinding(CancellableOperation operation)
+    : operation_(operation), token_(std::make_shared<CancelToken>()) {}
+
+bool CancelBinding::Attach(const Napi::Value& options, std::string& error) {
+    Napi::Value signal;
+    if (!ParseOptions(options, *token_, signal, error)) return false;
+
+    if (signal.IsObject()) {
+        Napi::Env env = signal.Env();
+        // The listener holds the token, not the binding: it may fire after
+        // the worker is gone if removal races with a pending abort event.
+        CancelTokenPtr token = token_;
+        Napi::Function listener = Napi::Function::New(
+            env,
+            [token](const Napi::CallbackInfo& info) -> Napi::Value {
+                token->Cancel();
+                return info.Env().Undefined();
+            },
+            "cancelNativeOperation");
+        Napi::Object target = signal.As<Napi::Object>();
+        target.Get("addEventListener")
+            .As<Napi::Function>()
+            .Call(target, {Napi::String::New(env, "abort"), listener});
+        signal_ = Napi::Persistent(target);
+        listener_ = Napi::Persistent(listener);
+        hasSignal_ = true;
+    }
+
+    attached_ = true;
+    RecordOperationStarted(operation_);
+    return true;
+}
+
+void CancelBinding::Finish() {
+    if (!attached_) return;
+    attached_ = false;
+
+    if (!signal_.IsEmpty()) {
+        Napi::Object target = signal_.Value();
+        Napi::Value remove = target.Get("removeEventListener");
+        if (remove.IsFunction()) {
+            Napi::Env env = target.Env();
+            remove.As<Napi::Function>().Call(
+                target, {Napi::String::New(env, "abort"), listener_.Value()});
+        }
+        signal_.Reset();
+        listener_.Reset();
+    }
+
+    RecordOperationFinished(operation_, token_->Outcome());
+}
+
+Napi::Value CancelBinding::StoppedError(Napi::Env env) const {
+    CancelReason reason = token_->Outcome();
+    bool expired = reason == CancelReason::Expired;
+    std::string message = std::string(OPERATION_NAMES[static_cast<size_t>(operation_)]) + ": " +
+                          CancelReasonMessage(reason);
+    Napi::Object error = Napi::Error::New(env, message).Value();
+    error.Set("name", Napi::String::New(env, expired ? "TimeoutError" : "AbortError"));
+    error.Set("code", Napi::String::New(env, expired ? "ETIMEDOUT" : "ABORT_ERR"));
+    return error;
+}
+
+bool ReadCancelOptions(const Napi::Value& options, CancelToken& token, std::string& error) {
+    Napi::Value signal;
+    return ParseOptions(options, token, signal, error);
+}
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+Napi::Value GetCancellationStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Object stats = Napi::Object::New(env);
+    for (size_t i = 0; i < OPERATION_COUNT; i++) {
+        const OperationCounters& counters = g_counters[i];
+        Napi::Object entry = Napi::Object::New(env);
+        entry.Set("started", Napi::Number::New(env, static_cast<double>(counters.started.load())));
+        entry.Set("completed",
+                  Napi::Number::New(env, static_cast<double>(counters.completed.load())));
+        entry.Set("cancelled",
+                  Napi::Number::New(env, static_cast<double>(counters.cancelled.load())));
+        entry.Set("expired", Napi::Number::New(env, static_cast<double>(counters.expired.load())));
+        stats.Set(OPERATION_NAMES[i], entry);
+    }
+    return stats;
+}
+
+} // namespace TerminAI
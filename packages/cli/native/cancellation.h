@@ -0,0 +1,217 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Deadlines and Cancellation Header
+ *
+ * Long-running exports take `{ timeoutMs?, signal? }` in their options:
+ *
+ *   timeoutMs  deadline relative to the call; the operation stops at its
+ *              next check once it has passed
+ *   signal     an AbortSignal (anything with `aborted` and
+ *              addEventListener/removeEventListener); aborting it stops the
+ *              operation at its next check
+ *
+ * Cancellation is cooperative. Work loops call CancelToken::Check() between
+ * units of work (a file segment, a directory entry), so an operation stops
+ * within one unit of the request and never mid-write. Blocking waits (a
+ * child's exit, a launch handshake) poll the token's wake fd instead.
+ *
+ * A stopped async operation rejects with an Error named "AbortError"
+ * (code ABORT_ERR) or "TimeoutError" (code ETIMEDOUT), the way Node's own
+ * APIs report an aborted signal or AbortSignal.timeout(). Every operation
+ * counts how often it was started, ran to the end, was cancelled or expired.
+ */
+
+#pragma once
+
+#include <napi.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace TerminAI {
+
+// ============================================================================
+// Types
+// ============================================================================
+
+enum class CancelReason : int {
+    None = 0,
+    /** The signal was aborted */
+    Cancelled = 1,
+    /** The deadline passed */
+    Expired = 2,
+};
+
+/** Operations that accept a deadline and a signal (counter slots). */
+enum class CancellableOperation : int {
+    HashFile,
+    SnapshotDirectory,
+    DiffOverlay,
+    CommitOverlay,
+    GrantPathAccess,
+    LaunchSandbox,
+    WaitSandbox,
+    ScanArchive,
+    WriteFileScanned,
+    StageWorkspace,
+    SpawnProcess,
+    Count,
+};
+
+/**
+ * Shared between the JS thread, which cancels it, and the threads doing the
+ * work, which check it. Check() is one relaxed load when no deadline is set,
+ * plus a clock read when one is.
+ */
+class CancelToken {
+public:
+    CancelToken() = default;
+    ~CancelToken();
+
+    CancelToken(const CancelToken&) = delete;
+    CancelToken& operator=(const CancelToken&) = delete;
+
+    /** Set the deadline to `timeoutMs` from now. */
+    void SetTimeout(int64_t timeoutMs);
+
+    /** Request cancellation. Safe from any thread; later calls are no-ops. */
+    void Cancel();
+
+    /**
+     * Whether the operation should stop. The first non-None answer is
+     * latched, so Outcome() reports what the work actually observed rather
+     * than a cancel that arrived after it had finished.
+     */
+    CancelReason Check();
+
+    bool Stopped() { return Check() != CancelReason::None; }
+
+    /** What Check() reported, or None if the work never saw a stop. */
+    CancelReason Outcome() const {
+        return static_cast<CancelReason>(outcome_.load(std::memory_order_acquire));
+    }
+
+    bool HasDeadline() const { return hasDeadline_; }
+
+    /** Milliseconds until the deadline: -1 = none, 0 = passed. */
+    int RemainingMs() const;
+
+#ifdef __linux__
+    /**
+     * An eventfd that becomes readable on Cancel(), for waits that poll().
+     * Created on first use; -1 if it cannot be.
+     */
+    int WakeFd();
+
+    /**
+     * poll() timeout for a wait that includes WakeFd(): the time left, or
+     * short slices if there is no wake fd for Cancel() to signal.
+     */
+    int PollTimeoutMs();
+#endif
+
+private:
+    std::atomic<bool> cancelled_{false};
+    std::atomic<int> outcome_{0};
+    bool hasDeadline_ = false;
+    std::chrono::steady_clock::time_point deadline_;
+#ifdef __linux__
+    std::mutex wakeMutex_;
+    int wakeFd_ = -1;
+#endif
+};
+
+using CancelTokenPtr = std::shared_ptr<CancelToken>;
+
+/** True if `token` is set and says stop (null = never stops). */
+inline bool IsStopped(CancelToken* token) {
+    return token != nullptr && token->Stopped();
+}
+
+/** "operation cancelled" / "deadline exceeded" */
+const char* CancelReasonMessage(CancelReason reason);
+
+// ============================================================================
+// Counters
+// ============================================================================
+
+void RecordOperationStarted(CancellableOperation operation);
+void RecordOperationFinished(CancellableOperation operation, CancelReason outcome);
+
+// ============================================================================
+// JS Binding
+// ============================================================================
+
+/**
+ * Binds `{ timeoutMs?, signal? }` to a CancelToken for one async operation.
+ * Owned by its AsyncWorker; Attach() and Finish() run on the JS thread.
+ */
+class CancelBinding {
+public:
+    explicit CancelBinding(CancellableOperation operation);
+
+    /**
+     * Read the options (an object, or undefined for neither), subscribe to
+     * the signal and count the operation as started. An already aborted
+     * signal cancels the token straight away.
+     *
+     * @return false with a message if timeoutMs or signal is malformed
+     */
+    bool Attach(const Napi::Value& options, std::string& error);
+
+    CancelToken* Token() const { return token_.get(); }
+
+    /** Whether the work stopped because of the token. */
+    bool Stopped() const { return token_->Outcome() != CancelReason::None; }
+
+    /** Whether a deadline or a signal was given (otherwise nothing can stop it). */
+    bool Armed() const { return token_->HasDeadline() || hasSignal_; }
+
+    /** Unsubscribe from the signal and record the outcome. Idempotent. */
+    void Finish();
+
+    /** The AbortError / TimeoutError a stopped operation rejects with. */
+    Napi::Value StoppedError(Napi::Env env) const;
+
+private:
+    CancellableOperation operation_;
+    CancelTokenPtr token_;
+    Napi::ObjectReference signal_;
+    Napi::FunctionReference listener_;
+    bool hasSignal_ = false;
+    bool attached_ = false;
+};
+
+/**
+ * For synchronous exports: apply `{ timeoutMs?, signal? }` to `token`
+ * without subscribing (the JS thread is busy until the call returns, so
+ * only a signal that is already aborted can take effect).
+ */
+bool ReadCancelOptions(const Napi::Value& options, CancelToken& token, std::string& error);
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+/**
+ * Per-operation counters since the module was loaded.
+ *
+ * Returns: Object - keyed by operation (hashFile, snapshotDirectory,
+ *          diffOverlay, commitOverlay, grantPathAccess, launchSandbox,
+ *          waitSandbox, scanArchive, writeFileScanned, stageWorkspace,
+ *          spawnProcess), each
+ *          { started, completed, cancelled, expired }.
+ *          `completed` counts operations that ran to the end, whether they
+ *          succeeded or failed.
+ */
+Napi::Value GetCancellationStats(const Napi::CallbackInfo& info);
+
+} // namespace TerminAI
@@ -0,0 +1,905 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Content Hasher Implementation
+ *
+ * Snapshot walk:
+ * 1. Each directory is listed by its own pool task, which stats every entry,
+ *    queues sub-directories as new tasks and hashes small files inline.
+ *    Large files get their own task and are tree-hashed in segments.
+ * 2. Once every task has finished, directory hashes are computed bottom-up
+ *    on the calling thread (cheap: 32 bytes per child).
+ *
+ * Change detection follows git's "racily clean" rule: a cached hash is only
+ * trusted if the file's mtime is older than the snapshot that produced it,
+ * so a write landing in the same timestamp tick is never missed.
+ */
+
+#include "content_hasher.h"
+#include "work_scheduler.h"
+#include "worker_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+#ifdef _WIN32
+#include "appcontainer_manager.h"
+#include <filesystem>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace TerminAI {
+
+namespace {
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+/** Files at or below this size are hashed inline by the directory task. */
+constexpr uint64_t INLINE_HASH_LIMIT = 256 * 1024;
+
+constexpr const char* MANIFEST_MAGIC = "terminai-snapshot v1";
+
+// ============================================================================
+// Platform Layer
+// ============================================================================
+
+struct StatInfo {
+    SnapshotEntryType type = SnapshotEntryType::File;
+    bool supported = false;
+    bool executable = false;
+    uint64_t size = 0;
+    int64_t mtimeNs = 0;
+    int64_t ctimeNs = 0;
+    uint64_t inode = 0;
+    uint64_t device = 0;
+};
+
+#ifndef _WIN32
+
+class FileReader {
+public:
+    ~FileReader() {
+        if (fd_ >= 0) close(fd_);
+    }
+
+    bool Open(const std::string& path, std::string& error) {
+        fd_ = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd_ < 0) {
+            error = "open " + path + ": " + std::strerror(errno);
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd_, &st) != 0) {
+            error = "fstat " + path + ": " + std::strerror(errno);
+            return false;
+        }
+        size_ = static_cast<uint64_t>(st.st_size);
+        return true;
+    }
+
+    uint64_t Size() const { return size_; }
+
+    bool ReadAt(uint64_t offset, uint8_t* buffer, size_t length) const {
+        while (length > 0) {
+            ssize_t n = pread(fd_, buffer, length, static_cast<off_t>(offset));
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            if (n == 0) return false; // Truncated underneath us
+            buffer += n;
+            offset += static_cast<uint64_t>(n);
+            length -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+private:
+    int fd_ = -1;
+    uint64_t size_ = 0;
+};
+
+inline int64_t TimespecNs(const struct timespec& ts) {
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+bool StatPath(const std::string& path, StatInfo& info) {
+    struct stat st;
+    if (lstat(path.c_str(), &st) != 0) return false;
+
+    info.supported = true;
+    if (S_ISREG(st.st_mode)) {
+        info.type = SnapshotEntryType::File;
+    } else if (S_ISDIR(st.st_mode)) {
+        info.type = SnapshotEntryType::Directory;
+    } else if (S_ISLNK(st.st_mode)) {
+        info.type = SnapshotEntryType::Symlink;
+    } else {
+        info.supported = false; // Sockets, FIFOs, devices
+    }
+
+    info.executable = (st.st_mode & S_IXUSR) != 0 && S_ISREG(st.st_mode);
+    info.size = static_cast<uint64_t>(st.st_size);
+    info.mtimeNs = TimespecNs(st.st_mtim);
+    info.ctimeNs = TimespecNs(st.st_ctim);
+    info.inode = static_cast<uint64_t>(st.st_ino);
+    info.device = static_cast<uint64_t>(st.st_dev);
+    return true;
+}
+
+bool ListDirectory(const std::string& path, std::vector<std::string>& names) {
+    DIR* dir = opendir(path.c_str());
+    if (dir == nullptr) return false;
+
+    while (struct dirent* entry = readdir(dir)) {
+        const char* name = entry->d_name;
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+            continue;
+        }
+        names.emplace_back(name);
+    }
+    closedir(dir);
+    return true;
+}
+
+bool ReadLinkTarget(const std::string& path, std::string& target) {
+    char buffer[PATH_MAX];
+    ssize_t n = readlink(path.c_str(), buffer, sizeof(buffer));
+    if (n < 0) return false;
+    target.assign(buffer, static_cast<size_t>(n));
+    return true;
+}
+
+bool CanonicalPath(const std::string& path, std::string& out) {
+    char resolved[PATH_MAX];
+    if (realpath(path.c_str(), resolved) == nullptr) return false;
+    out = resolved;
+    return true;
+}
+
+int64_t NowFileTimeNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return TimespecNs(ts);
+}
+
+#else // _WIN32
+
+namespace fs = std::filesystem;
+
+class FileReader {
+public:
+    ~FileReader() {
+        if (handle_ != INVALID_HANDLE_VALUE) CloseHandle(handle_);
+    }
+
+    bool Open(const std::string& path, std::string& error) {
+        handle_ = CreateFileW(Utf8ToWide(path).c_str(), GENERIC_READ,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (handle_ == INVALID_HANDLE_VALUE) {
+            error = "open " + path + ": " + GetWindowsErrorMessage(GetLastError());
+            return false;
+        }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(handle_, &size)) {
+            error = "size " + path + ": " + GetWindowsErrorMessage(GetLastError());
+            return false;
+        }
+        size_ = static_cast<uint64_t>(size.QuadPart);
+        return true;
+    }
+
+    uint64_t Size() const { return size_; }
+
+    bool ReadAt(uint64_t offset, uint8_t* buffer, size_t length) const {
+        while (length > 0) {
+            OVERLAPPED ov = {};
+            ov.Offset = static_cast<DWORD>(offset);
+            ov.OffsetHigh = static_cast<DWORD>(offset >> 32);
+            DWORD want = static_cast<DWORD>(std::min<size_t>(length, 1u << 30));
+            DWORD got = 0;
+            if (!ReadFile(handle_, buffer, want, &got, &ov) || got == 0) return false;
+            buffer += got;
+            offset += got;
+            length -= got;
+        }
+        return true;
+    }
+
+private:
+    HANDLE handle_ = INVALID_HANDLE_VALUE;
+    uint64_t size_ = 0;
+};
+
+bool StatPath(const std::string& path, StatInfo& info) {
+    std::error_code ec;
+    fs::path p(Utf8ToWide(path));
+    fs::file_status status = fs::symlink_status(p, ec);
+    if (ec) return false;
+
+    info.supported = true;
+    if (fs::is_symlink(status)) {
+        info.type = SnapshotEntryType::Symlink;
+    } else if (fs::is_directory(status)) {
+        info.type = SnapshotEntryType::Directory;
+    } else if (fs::is_regular_file(status)) {
+        info.type = SnapshotEntryType::File;
+        info.size = fs::file_size(p, ec);
+    } else {
+        info.supported = false;
+    }
+
+    auto mtime = fs::last_write_time(p, ec);
+    info.mtimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        mtime.time_since_epoch()).count();
+    return true;
+}
+
+bool ListDirectory(const std::string& path, std::vector<std::string>& names) {
+    std::error_code ec;
+    fs::directory_iterator it(fs::path(Utf8ToWide(path)), ec);
+    if (ec) return false;
+    for (const auto& entry : it) {
+        names.push_back(WideToUtf8(entry.path().filename().wstring()));
+    }
+    return true;
+}
+
+bool ReadLinkTarget(const std::string& path, std::string& target) {
+    std::error_code ec;
+    fs::path resolved = fs::read_symlink(fs::path(Utf8ToWide(path)), ec);
+    if (ec) return false;
+    target = WideToUtf8(resolved.wstring());
+    return true;
+}
+
+bool CanonicalPath(const std::string& path, std::string& out) {
+    std::error_code ec;
+    fs::path resolved = fs::canonical(fs::path(Utf8ToWide(path)), ec);
+    if (ec) return false;
+    out = WideToUtf8(resolved.wstring());
+    return true;
+}
+
+int64_t NowFileTimeNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        fs::file_time_type::clock::now().time_since_epoch()).count();
+}
+
+#endif // _WIN32
+
+inline std::string JoinPath(const std::string& dir, const std::string& name) {
+    if (dir.empty()) return name;
+#ifdef _WIN32
+    if (dir.back() == '\\' || dir.back() == '/') return dir + name;
+    return dir + "\\" + name;
+#else
+    if (dir.back() == '/') return dir + name;
+    return dir + "/" + name;
+#endif
+}
+
+inline std::string JoinRelative(const std::string& dir, const std::string& name) {
+    return dir.empty() ? name : dir + "/" + name;
+}
+
+// ============================================================================
+// Manifest Cache
+// ============================================================================
+
+struct Manifest {
+    int64_t takenAtNs = 0;
+    std::unordered_map<std::string, SnapshotEntry> entries;
+};
+
+std::mutex g_cacheMutex;
+std::unordered_map<std::string, std::shared_ptr<const Manifest>> g_manifestCache;
+
+std::shared_ptr<const Manifest> LookupManifest(const std::string& root) {
+    std::lock_guard<std::mutex> lock(g_cacheMutex);
+    auto it = g_manifestCache.find(root);
+    return it == g_manifestCache.end() ? nullptr : it->second;
+}
+
+void StoreManifest(const std::string& root, std::shared_ptr<const Manifest> manifest) {
+    std::lock_guard<std::mutex> lock(g_cacheMutex);
+    g_manifestCache[root] = std::move(manifest);
+}
+
+std::shared_ptr<const Manifest> LoadManifestFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return nullptr;
+
+    std::string line;
+    if (!std::getline(file, line) || line != MANIFEST_MAGIC) return nullptr;
+
+    auto manifest = std::make_shared<Manifest>();
+    if (!std::getline(file, line)) return nullptr;
+    manifest->takenAtNs = std::strtoll(line.c_str(), nullptr, 10);
+
+    while (std::getline(file, line)) {
+        // <type> <exec> <hash> <size> <mtime> <ctime> <inode> <device> <path>
+        std::istringstream fields(line);
+        SnapshotEntry entry;
+        char type = 0;
+        int executable = 0;
+        std::string hex;
+        fields >> type >> executable >> hex >> entry.size >> entry.mtimeNs >>
+            entry.ctimeNs >> entry.inode >> entry.device;
+        if (!fields || !Blake3Digest::FromHex(hex, entry.hash)) return nullptr;
+
+        fields.get(); // Separator before the path, which may contain spaces
+        std::getline(fields, entry.path);
+        entry.type = static_cast<SnapshotEntryType>(type);
+        entry.executable = executable != 0;
+        manifest->entries.emplace(entry.path, std::move(entry));
+    }
+    return manifest;
+}
+
+void SaveManifestFile(const std::string& path, const Manifest& manifest) {
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return;
+
+        file << MANIFEST_MAGIC << '\n' << manifest.takenAtNs << '\n';
+        for (const auto& [relPath, entry] : manifest.entries) {
+            if (relPath.find('\n') != std::string::npos) continue;
+            file << static_cast<char>(entry.type) << ' ' << (entry.executable ? 1 : 0) << ' '
+                 << entry.hash.ToHex() << ' ' << entry.size << ' ' << entry.mtimeNs << ' '
+                 << entry.ctimeNs << ' ' << entry.inode << ' ' << entry.device << ' '
+                 << relPath << '\n';
+        }
+        if (!file.good()) return;
+    }
+    std::rename(tempPath.c_str(), path.c_str());
+}
+
+// ============================================================================
+// Snapshot Walk
+// ============================================================================
+
+struct WalkNode {
+    std::string name;
+    SnapshotEntry entry;
+    bool reused = false;
+    bool unreadable = false;
+    std::vector<std::unique_ptr<WalkNode>> children;
+};
+
+struct WalkContext {
+    WalkContext(WorkerPool& pool, const SnapshotOptions& options)
+        : pool(pool), group(pool), options(options) {}
+
+    WorkerPool& pool;
+    WaitGroup group;
+    const SnapshotOptions& options;
+    std::shared_ptr<const Manifest> previous;
+
+    std::atomic<uint64_t> hashedBytes{0};
+    std::atomic<uint64_t> skipped{0};
+
+    bool Serial() const { return options.threads == 1; }
+
+    bool Stopped() const { return IsStopped(options.cancel); }
+
+    void Spawn(std::function<void()> task) {
+        if (Serial()) {
+            task();
+        } else {
+            group.Run(std::move(task));
+        }
+    }
+
+    bool IsExcluded(const std::string& name) const {
+        return std::find(options.exclude.begin(), options.exclude.end(), name) !=
+               options.exclude.end();
+    }
+
+    const SnapshotEntry* Previous(const std::string& relPath) const {
+        if (!previous) return nullptr;
+        auto it = previous->entries.find(relPath);
+        return it == previous->entries.end() ? nullptr : &it->second;
+    }
+};
+
+bool IsUnchanged(const SnapshotEntry* cached, const SnapshotEntry& current, int64_t takenAtNs) {
+    return cached != nullptr &&
+           cached->type == current.type &&
+           cached->inode == current.inode &&
+           cached->device == current.device &&
+           cached->size == current.size &&
+           cached->mtimeNs == current.mtimeNs &&
+           cached->ctimeNs == current.ctimeNs &&
+           cached->executable == current.executable &&
+           current.mtimeNs < takenAtNs;
+}
+
+void HashLeaf(WalkContext& ctx, WalkNode& node, const std::string& absPath) {
+    if (node.entry.type == SnapshotEntryType::Symlink) {
+        std::string target;
+        if (!ReadLinkTarget(absPath, target)) {
+            ctx.skipped.fetch_add(1, std::memory_order_relaxed);
+            node.unreadable = true;
+            return;
+        }
+        node.entry.hash = Blake3Hash(target.data(), target.size());
+        return;
+    }
+
+    std::string error;
+    if (!HashFileContent(absPath, ctx.Serial() ? 1 : 0, node.entry.hash, error,
+                         ctx.options.cancel)) {
+        ctx.skipped.fetch_add(1, std::memory_order_relaxed);
+        node.unreadable = true;
+        return;
+    }
+    ctx.hashedBytes.fetch_add(node.entry.size, std::memory_order_relaxed);
+}
+
+void WalkDirectory(WalkContext& ctx, WalkNode& dir, const std::string& absPath) {
+    if (ctx.Stopped()) return;
+
+    std::vector<std::string> names;
+    if (!ListDirectory(absPath, names)) {
+        ctx.skipped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Sorted here so the Merkle record order is deterministic.
+    std::sort(names.begin(), names.end());
+    dir.children.reserve(names.size());
+
+    for (auto& name : names) {
+        if (ctx.Stopped()) return;
+        if (ctx.IsExcluded(name)) continue;
+
+        std::string childAbs = JoinPath(absPath, name);
+        StatInfo st;
+        if (!StatPath(childAbs, st) || !st.supported) continue;
+
+        auto child = std::make_unique<WalkNode>();
+        child->name = std::move(name);
+        child->entry.path = JoinRelative(dir.entry.path, child->name);
+        child->entry.type = st.type;
+        child->entry.executable = st.executable;
+        child->entry.size = st.type == SnapshotEntryType::Directory ? 0 : st.size;
+        child->entry.mtimeNs = st.mtimeNs;
+        child->entry.ctimeNs = st.ctimeNs;
+        child->entry.inode = st.inode;
+        child->entry.device = st.device;
+
+        WalkNode* node = child.get();
+        dir.children.push_back(std::move(child));
+
+        if (st.type == SnapshotEntryType::Directory) {
+            ctx.Spawn([&ctx, node, childAbs]() { WalkDirectory(ctx, *node, childAbs); });
+            continue;
+        }
+
+        const SnapshotEntry* cached = ctx.Previous(node->entry.path);
+        if (IsUnchanged(cached, node->entry, ctx.previous ? ctx.previous->takenAtNs : 0)) {
+            node->entry.hash = cached->hash;
+            node->reused = true;
+            continue;
+        }
+
+        if (st.type == SnapshotEntryType::File && st.size > INLINE_HASH_LIMIT) {
+            ctx.Spawn([&ctx, node, childAbs]() { HashLeaf(ctx, *node, childAbs); });
+        } else {
+            HashLeaf(ctx, *node, childAbs);
+        }
+    }
+}
+
+/**
+ * Compute directory hashes bottom-up and collect results. Returns true if
+ * the whole subtree was reused from the previous manifest.
+ */
+bool FinalizeDirectory(WalkContext& ctx, WalkNode& dir, SnapshotResult& result,
+                       Manifest& manifest) {
+    bool allReused = true;
+    Blake3Hasher hasher;
+
+    for (auto& child : dir.children) {
+        if (child->unreadable) continue; // Vanished or unreadable mid-walk
+
+        if (child->entry.type == SnapshotEntryType::Directory) {
+            allReused &= FinalizeDirectory(ctx, *child, result, manifest);
+        } else {
+            allReused &= child->reused;
+            if (child->entry.type == SnapshotEntryType::File) {
+                result.files++;
+                result.totalBytes += child->entry.size;
+                if (child->reused) result.reusedFiles++;
+            } else {
+                result.symlinks++;
+            }
+            if (ctx.options.includeEntries) result.entries.push_back(child->entry);
+            manifest.entries.emplace(child->entry.path, child->entry);
+        }
+
+        const char record[2] = {
+            static_cast<char>(child->entry.type),
+            child->entry.executable ? 'x' : '-',
+        };
+        hasher.Update(record, sizeof(record));
+        hasher.Update(child->name.data(), child->name.size() + 1); // Includes NUL
+        hasher.Update(child->entry.hash.bytes, BLAKE3_OUT_LEN);
+    }
+
+    const SnapshotEntry* cached = ctx.Previous(dir.entry.path);
+    if (allReused && IsUnchanged(cached, dir.entry, ctx.previous ? ctx.previous->takenAtNs : 0)) {
+        dir.entry.hash = cached->hash;
+        dir.reused = true;
+        result.reusedDirectories++;
+    } else {
+        dir.entry.hash = hasher.Finalize();
+    }
+
+    result.directories++;
+    if (ctx.options.includeEntries) result.entries.push_back(dir.entry);
+    manifest.entries.emplace(dir.entry.path, dir.entry);
+    return dir.reused;
+}
+
+} // namespace
+
+// ============================================================================
+// Core API
+// ============================================================================
+
+bool HashFileContent(const std::string& path, size_t threads,
+                     Blake3Digest& out, std::string& error,
+                     CancelToken* cancel) {
+    FileReader reader;
+    if (!reader.Open(path, error)) return false;
+
+    bool ok = Blake3HashSegmented(
+        reader.Size(),
+        [&reader, cancel](uint64_t offset, uint8_t* buffer, size_t length) {
+            return !IsStopped(cancel) && reader.ReadAt(offset, buffer, length);
+        },
+        WorkerPool::Shared(), threads, out);
+
+    if (!ok) {
+        error = IsStopped(cancel) ? CancelReasonMessage(cancel->Outcome())
+                                  : "read failed: " + path;
+    }
+    return ok;
+}
+
+bool SnapshotDirectory(const std::string& root, const SnapshotOptions& options,
+                       SnapshotResult& result, std::string& error) {
+    auto start = std::chrono::steady_clock::now();
+
+    std::string canonicalRoot;
+    if (!CanonicalPath(root, canonicalRoot)) {
+        error = "Cannot resolve snapshot root: " + root;
+        return false;
+    }
+
+    StatInfo rootStat;
+    if (!StatPath(canonicalRoot, rootStat) || rootStat.type != SnapshotEntryType::Directory) {
+        error = "Snapshot root is not a directory: " + root;
+        return false;
+    }
+
+    WalkContext ctx(WorkerPool::Shared(), options);
+    ctx.previous = LookupManifest(canonicalRoot);
+    if (!ctx.previous && !options.manifestPath.empty()) {
+        ctx.previous = LoadManifestFile(options.manifestPath);
+    }
+
+    // Taken before the walk so that files modified during it are racy.
+    auto manifest = std::make_shared<Manifest>();
+    manifest->takenAtNs = NowFileTimeNs();
+
+    WalkNode rootNode;
+    rootNode.name = ".";
+    rootNode.entry.type = SnapshotEntryType::Directory;
+    rootNode.entry.mtimeNs = rootStat.mtimeNs;
+    rootNode.entry.ctimeNs = rootStat.ctimeNs;
+    rootNode.entry.inode = rootStat.inode;
+    rootNode.entry.device = rootStat.device;
+
+    ctx.Spawn([&ctx, &rootNode, &canonicalRoot]() {
+        WalkDirectory(ctx, rootNode, canonicalRoot);
+    });
+    ctx.group.Wait();
+
+    // A partial walk must not become the baseline for the next snapshot.
+    if (ctx.Stopped()) {
+        error = CancelReasonMessage(options.cancel->Outcome());
+        return false;
+    }
+
+    FinalizeDirectory(ctx, rootNode, result, *manifest);
+    result.root = rootNode.entry.hash;
+    result.hashedBytes = ctx.hashedBytes.load();
+    result.skipped = ctx.skipped.load();
+
+    if (!options.manifestPath.empty()) SaveManifestFile(options.manifestPath, *manifest);
+    StoreManifest(canonicalRoot, std::move(manifest));
+
+    result.durationMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+void ClearSnapshotCache(const std::string& root) {
+    std::lock_guard<std::mutex> lock(g_cacheMutex);
+    if (root.empty()) {
+        g_manifestCache.clear();
+        return;
+    }
+    std::string canonicalRoot;
+    g_manifestCache.erase(CanonicalPath(root, canonicalRoot) ? canonicalRoot : root);
+}
+
+// ============================================================================
+// Async Workers
+// ============================================================================
+
+namespace {
+
+class HashFileWorker : public Napi::AsyncWorker {
+public:
+    HashFileWorker(Napi::Env env, std::string path, size_t threads, CancelBinding cancel,
+                   WorkContext work)
+        : Napi::AsyncWorker(env),
+          deferred_(Napi::Promise::Deferred::New(env)),
+          path_(std::move(path)),
+          threads_(threads),
+          cancel_(std::move(cancel)),
+          work_(work) {}
+
+    Napi::Promise Promise() const { return deferred_.Promise(); }
+
+    void Execute() override {
+        WorkScope scope(work_);
+        std::string error;
+        if (!HashFileContent(path_, threads_, digest_, error, cancel_.Token())) SetError(error);
+    }
+
+    void OnOK() override {
+        cancel_.Finish();
+        deferred_.Resolve(Napi::String::New(Env(), digest_.ToHex()));
+    }
+
+    void OnError(const Napi::Error& error) override {
+        cancel_.Finish();
+        deferred_.Reject(cancel_.Stopped() ? cancel_.StoppedError(Env()) : error.Value());
+    }
+
+private:
+    Napi::Promise::Deferred deferred_;
+    std::string path_;
+    size_t threads_;
+    CancelBinding cancel_;
+    WorkContext work_;
+    Blake3Digest digest_;
+};
+
+class SnapshotWorker : public Napi::AsyncWorker {
+public:
+    SnapshotWorker(Napi::Env env, std::string root, SnapshotOptions options,
+                   CancelBinding cancel, WorkContext work)
+        : Napi::AsyncWorker(env),
+          deferred_(Napi::Promise::Deferred::New(env)),
+          root_(std::move(root)),
+          options_(std::move(options)),
+          cancel_(std::move(cancel)),
+          work_(work) {
+        options_.cancel = cancel_.Token();
+    }
+
+    Napi::Promise Promise() const { return deferred_.Promise(); }
+
+    void Execute() override {
+        WorkScope scope(work_);
+        std::string error;
+        if (!SnapshotDirectory(root_, options_, result_, error)) SetError(error);
+    }
+
+    void OnOK() override {
+        cancel_.Finish();
+        Napi::Env env = Env();
+        Napi::Object out = Napi::Object::New(env);
+        out.Set("root", Napi::String::New(env, result_.root.ToHex()));
+        out.Set("files", Napi::Number::New(env, static_cast<double>(result_.files)));
+        out.Set("directories", Napi::Number::New(env, static_cast<double>(result_.directories)));
+        out.Set("symlinks", Napi::Number::New(env, static_cast<double>(result_.symlinks)));
+        out.Set("totalBytes", Napi::Number::New(env, static_cast<double>(result_.totalBytes)));
+        out.Set("hashedBytes", Napi::Number::New(env, static_cast<double>(result_.hashedBytes)));
+        out.Set("reusedFiles", Napi::Number::New(env, static_cast<double>(result_.reusedFiles)));
+        out.Set("reusedDirectories",
+                Napi::Number::New(env, static_cast<double>(result_.reusedDirectories)));
+        out.Set("skipped", Napi::Number::New(env, static_cast<double>(result_.skipped)));
+        out.Set("durationMs", Napi::Number::New(env, result_.durationMs));
+
+        if (options_.includeEntries) {
+            Napi::Array entries = Napi::Array::New(env, result_.entries.size());
+            for (size_t i = 0; i < result_.entries.size(); i++) {
+                const SnapshotEntry& e = result_.entries[i];
+                Napi::Object entry = Napi::Object::New(env);
+                entry.Set("path", Napi::String::New(env, e.path));
+                entry.Set("type", Napi::String::New(env,
+                    e.type == SnapshotEntryType::File ? "file"
+                    : e.type == SnapshotEntryType::Symlink ? "symlink" : "directory"));
+                entry.Set("size", Napi::Number::New(env, static_cast<double>(e.size)));
+                entry.Set("hash", Napi::String::New(env, e.hash.ToHex()));
+                entries.Set(static_cast<uint32_t>(i), entry);
+            }
+            out.Set("entries", entries);
+        }
+
+        deferred_.Resolve(out);
+    }
+
+    void OnError(const Napi::Error& error) override {
+        cancel_.Finish();
+        deferred_.Reject(cancel_.Stopped() ? cancel_.StoppedError(Env()) : error.Value());
+    }
+
+private:
+    Napi::Promise::Deferred deferred_;
+    std::string root_;
+    SnapshotOptions options_;
+    CancelBinding cancel_;
+    WorkContext work_;
+    SnapshotResult result_;
+};
+
+Napi::Value RejectedPromise(Napi::Env env, const std::string& message) {
+    auto deferred = Napi::Promise::Deferred::New(env);
+    deferred.Reject(Napi::TypeError::New(env, message).Value());
+    return deferred.Promise();
+}
+
+size_t ThreadsOption(const Napi::Object& options) {
+    Napi::Value threads = options.Get("threads");
+    return threads.IsNumber() ? threads.As<Napi::Number>().Uint32Value() : 0;
+}
+
+} // namespace
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+Napi::Value HashBuffer(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1) {
+        Napi::TypeError::New(env, "hashBuffer expects a Buffer or string").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    if (info[0].IsBuffer()) {
+        auto buffer = info[0].As<Napi::Buffer<uint8_t>>();
+        Blake3Digest digest = buffer.Length() > BLAKE3_SEGMENT_LEN
+            ? Blake3HashParallel(buffer.Data(), buffer.Length(), WorkerPool::Shared())
+            : Blake3Hash(buffer.Data(), buffer.Length());
+        return Napi::String::New(env, digest.ToHex());
+    }
+
+    if (info[0].IsString()) {
+        std::string content = info[0].As<Napi::String>().Utf8Value();
+        return Napi::String::New(env, Blake3Hash(content.data(), content.size()).ToHex());
+    }
+
+    Napi::TypeError::New(env, "hashBuffer expects a Buffer or string").ThrowAsJavaScriptException();
+    return env.Null();
+}
+
+Napi::Value HashFile(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        return RejectedPromise(env, "Invalid arguments");
+    }
+
+    size_t threads = 0;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        threads = ThreadsOption(info[1].As<Napi::Object>());
+    }
+
+    Napi::Value options = info.Length() > 1 ? info[1] : env.Undefined();
+    WorkContext work;
+    std::string error;
+    if (!ReadWorkContext(options, WorkPriority::Normal, work, error)) {
+        return RejectedPromise(env, error);
+    }
+
+    CancelBinding cancel(CancellableOperation::HashFile);
+    if (!cancel.Attach(options, error)) {
+        return RejectedPromise(env, error);
+    }
+
+    auto* worker = new HashFileWorker(env, info[0].As<Napi::String>().Utf8Value(), threads,
+                                      std::move(cancel), work);
+    Napi::Promise promise = worker->Promise();
+    worker->Queue();
+    return promise;
+}
+
+Napi::Value SnapshotDirectoryExport(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        return RejectedPromise(env, "Invalid arguments");
+    }
+
+    SnapshotOptions options;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Object opts = info[1].As<Napi::Object>();
+        options.threads = ThreadsOption(opts);
+
+        Napi::Value exclude = opts.Get("exclude");
+        if (exclude.IsArray()) {
+            Napi::Array names = exclude.As<Napi::Array>();
+            for (uint32_t i = 0; i < names.Length(); i++) {
+                Napi::Value name = names.Get(i);
+                if (name.IsString()) options.exclude.push_back(name.As<Napi::String>().Utf8Value());
+            }
+        }
+
+        Napi::Value includeEntries = opts.Get("includeEntries");
+        options.includeEntries = includeEntries.IsBoolean() && includeEntries.As<Napi::Boolean>().Value();
+
+        Napi::Value manifestPath = opts.Get("manifestPath");
+        if (manifestPath.IsString()) options.manifestPath = manifestPath.As<Napi::String>().Utf8Value();
+    }
+
+    // Tree-wide by nature, so bulk unless the caller is waiting on it.
+    Napi::Value opts = info.Length() > 1 ? info[1] : env.Undefined();
+    WorkContext work;
+    std::string error;
+    if (!ReadWorkContext(opts, WorkPriority::Bulk, work, error)) {
+        return RejectedPromise(env, error);
+    }
+
+    CancelBinding cancel(CancellableOperation::SnapshotDirectory);
+    if (!cancel.Attach(opts, error)) {
+        return RejectedPromise(env, error);
+    }
+
+    auto* worker = new SnapshotWorker(env, info[0].As<Napi::String>().Utf8Value(),
+                                      std::move(options), std::move(cancel), work);
+    Napi::Promise promise = worker->Promise();
+    worker->Queue();
+    return promise;
+}
+
+Napi::Value ClearSnapshotCacheExport(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    std::string root = info.Length() > 0 && info[0].IsString()
+        ? info[0].As<Napi::String>().Utf8Value()
+        : "";
+    ClearSnapshotCache(root);
+    return env.Undefined();
+}
+
+} // namespace TerminAI
@@ -0,0 +1,176 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Content Hasher Header
+ *
+ * Content-addressed hashing for workspace files. Used for deduplication,
+ * change detection and as the key for cached scan verdicts.
+ *
+ * A snapshot is a Merkle tree over a directory:
+ * - file:      BLAKE3(content)
+ * - symlink:   BLAKE3(link target)
+ * - directory: BLAKE3 over the sorted child records
+ *              (type, executable bit, name, NUL, child hash)
+ *
+ * Directories are walked in parallel on the shared WorkerPool and large
+ * files are tree-hashed across several threads. Snapshots of the same root
+ * are cached; a file whose (inode, size, mtime, ctime) is unchanged since
+ * the previous snapshot reuses its previous hash without being read.
+ */
+
+#pragma once
+
+#include <napi.h>
+#include "blake3.h"
+#include "cancellation.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace TerminAI {
+
+// ============================================================================
+// Snapshot Types
+// ============================================================================
+
+enum class SnapshotEntryType : char {
+    File = 'f',
+    Directory = 'd',
+    Symlink = 'l',
+};
+
+struct SnapshotEntry {
+    /** Path relative to the snapshot root, '/'-separated */
+    std::string path;
+    SnapshotEntryType type = SnapshotEntryType::File;
+    bool executable = false;
+    uint64_t size = 0;
+    int64_t mtimeNs = 0;
+    int64_t ctimeNs = 0;
+    uint64_t inode = 0;
+    uint64_t device = 0;
+    Blake3Digest hash;
+};
+
+struct SnapshotOptions {
+    /** Entry names (not paths) to skip at any depth, e.g. ".git" */
+    std::vector<std::string> exclude;
+    /** 1 = hash on the calling thread only; 0 = use the whole pool */
+    size_t threads = 0;
+    /** Return every entry, not just the summary */
+    bool includeEntries = false;
+    /** Optional file used to persist the manifest across processes */
+    std::string manifestPath;
+    /** Checked per directory entry and file segment (null = never stops) */
+    CancelToken* cancel = nullptr;
+};
+
+struct SnapshotResult {
+    Blake3Digest root;
+    uint64_t files = 0;
+    uint64_t directories = 0;
+    uint64_t symlinks = 0;
+    uint64_t totalBytes = 0;
+    uint64_t hashedBytes = 0;
+    uint64_t reusedFiles = 0;
+    uint64_t reusedDirectories = 0;
+    /** Entries that vanished or could not be read during the walk */
+    uint64_t skipped = 0;
+    double durationMs = 0;
+    std::vector<SnapshotEntry> entries;
+};
+
+// ============================================================================
+// Core API
+// ============================================================================
+
+/**
+ * Hash a file's content.
+ *
+ * @param threads 1 = calling thread only; 0 = whole pool
+ * @param cancel Checked before each segment is read (null = never stops)
+ * @return false on I/O failure or when stopped (error describes it)
+ */
+bool HashFileContent(const std::string& path, size_t threads,
+                     Blake3Digest& out, std::string& error,
+                     CancelToken* cancel = nullptr);
+
+/**
+ * Build a Merkle snapshot of `root`. A stopped snapshot leaves the manifest
+ * cache as it was.
+ *
+ * @return false if the root cannot be read or the walk was stopped
+ *         (error describes it)
+ */
+bool SnapshotDirectory(const std::string& root, const SnapshotOptions& options,
+                       SnapshotResult& result, std::string& error);
+
+/** Drop cached manifests for `root`, or for every root if empty. */
+void ClearSnapshotCache(const std::string& root);
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+/**
+ * Hash an in-memory payload.
+ *
+ * Arguments:
+ *   0: Buffer | String - Content to hash
+ *
+ * Returns: String - 64-character hex BLAKE3 digest
+ */
+Napi::Value HashBuffer(const Napi::CallbackInfo& info);
+
+/**
+ * Hash a file off the main thread.
+ *
+ * Arguments:
+ *   0: String - Path to file
+ *   1: Object (optional) - { threads?: number, timeoutMs?: number,
+ *                            signal?: AbortSignal, priority?: string,
+ *                            sessionId?: string }
+ *      priority defaults to 'normal' (see work_scheduler.h)
+ *
+ * Returns: Promise<String> - hex digest (rejects with an AbortError or
+ *          TimeoutError when stopped; see cancellation.h)
+ */
+Napi::Value HashFile(const Napi::CallbackInfo& info);
+
+/**
+ * Snapshot a directory off the main thread.
+ *
+ * Arguments:
+ *   0: String - Root directory
+ *   1: Object (optional) - { exclude?: string[], threads?: number,
+ *                            includeEntries?: boolean, manifestPath?: string,
+ *                            timeoutMs?: number, signal?: AbortSignal,
+ *                            priority?: string, sessionId?: string }
+ *      priority defaults to 'bulk' (see work_scheduler.h)
+ *
+ * Returns: Promise<Object>
+ *   - root: String - Merkle root digest
+ *   - files, directories, symlinks: Number - entry counts
+ *   - totalBytes: Number - size of all files
+ *   - hashedBytes: Number - bytes actually read (cache misses)
+ *   - reusedFiles, reusedDirectories: Number - cache hits
+ *   - skipped: Number - entries that could not be read
+ *   - durationMs: Number
+ *   - entries?: Array<{ path, type, size, hash }>
+ *   (rejects with an AbortError or TimeoutError when stopped)
+ */
+Napi::Value SnapshotDirectoryExport(const Napi::CallbackInfo& info);
+
+/**
+ * Drop cached snapshot manifests.
+ *
+ * Arguments:
+ *   0: String (optional) - Root to forget (default: all)
+ */
+Napi::Value ClearSnapshotCacheExport(const Napi::CallbackInfo& info);
+
+} // namespace TerminAI
@@ -0,0 +1,1247 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Decompression Implementation
+ */
+
+#include "decompress.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace TerminAI {
+
+namespace {
+
+// ============================================================================
+// Output Window
+// ============================================================================
+
+/**
+ * Decoded output plus the history that back-references may reach. Output
+ * is handed to the sink whenever the buffer fills; the last `window` bytes
+ * are then slid to the front and decoding continues.
+ */
+class OutputWindow {
+public:
+    OutputWindow(size_t window, size_t chunk, const ByteSink& sink)
+        : buffer_(window + chunk), window_(window), sink_(sink) {}
+
+    /** Make room for `length` more bytes. False if the sink stopped. */
+    bool Reserve(size_t length) {
+        if (pos_ + length <= buffer_.size()) return true;
+        if (!Flush()) return false;
+        size_t keep = std::min(window_, pos_);
+        std::memmove(buffer_.data(), buffer_.data() + pos_ - keep, keep);
+        pos_ = flushed_ = keep;
+        return pos_ + length <= buffer_.size();
+    }
+
+    bool Flush() {
+        if (pos_ > flushed_ && !sink_(buffer_.data() + flushed_, pos_ - flushed_)) return false;
+        flushed_ = pos_;
+        return true;
+    }
+
+    uint8_t* Cursor() { return buffer_.data() + pos_; }
+    void Advance(size_t length) { pos_ += length; }
+    void Put(uint8_t byte) { buffer_[pos_++] = byte; }
+
+    /** Bytes a back-reference can currently reach. */
+    size_t History() const { return pos_; }
+
+    /** Copy `length` bytes from `distance` back (ranges may overlap). */
+    void CopyMatch(size_t distance, size_t length) {
+        uint8_t* dst = buffer_.data() + pos_;
+        const uint8_t* src = dst - distance;
+        pos_ += length;
+        if (distance == 1) {
+            std::memset(dst, *src, length);
+            return;
+        }
+        // Chunks of at most `distance` never overlap and repeat the pattern.
+        while (length > 0) {
+            size_t n = std::min(distance, length);
+            std::memcpy(dst, src, n);
+            dst += n;
+            src += n;
+            length -= n;
+        }
+    }
+
+private:
+    std::vector<uint8_t> buffer_;
+    size_t window_;
+    size_t pos_ = 0;
+    size_t flushed_ = 0;
+    const ByteSink& sink_;
+};
+
+DecodeResult Fail(DecodeStatus status, const char* error) {
+    DecodeResult result;
+    result.status = status;
+    result.error = error;
+    return result;
+}
+
+DecodeResult Corrupt(const char* error) {
+    return Fail(DecodeStatus::Corrupt, error);
+}
+
+DecodeResult Stopped() {
+    return Fail(DecodeStatus::Stopped, "stopped");
+}
+
+uint32_t ReadLE16(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8);
+}
+
+uint32_t ReadLE24(const uint8_t* p) {
+    return ReadLE16(p) | (static_cast<uint32_t>(p[2]) << 16);
+}
+
+uint32_t ReadLE32(const uint8_t* p) {
+    return ReadLE16(p) | (ReadLE16(p + 2) << 16);
+}
+
+int HighBit(uint32_t value) {
+    int bit = -1;
+    while (value != 0) {
+        value >>= 1;
+        bit++;
+    }
+    return bit;
+}
+
+// ============================================================================
+// DEFLATE
+// ============================================================================
+
+constexpr size_t DEFLATE_WINDOW = 32 * 1024;
+constexpr size_t DEFLATE_CHUNK = 256 * 1024;
+constexpr size_t DEFLATE_MAX_MATCH = 258;
+
+const uint16_t LENGTH_BASE[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                  31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+const uint8_t LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                  2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+const uint16_t DIST_BASE[30] = {1,    2,    3,    4,    5,    7,     9,     13,    17,  25,
+                                33,   49,   65,   97,   129,  193,   257,   385,   513, 769,
+                                1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+const uint8_t DIST_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                                6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+const uint8_t CODE_LENGTH_ORDER[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5,
+                                       11, 4,  12, 3, 13, 2, 14, 1, 15};
+
+/** LSB-first bit reader; reads past the end yield zeros and are tracked. */
+class LsbBitReader {
+public:
+    LsbBitReader(const uint8_t* data, size_t length)
+        : start_(data), p_(data), end_(data + length) {}
+
+    void Refill() {
+        while (count_ <= 56) {
+            uint64_t byte = 0;
+            if (p_ < end_) {
+                byte = *p_++;
+            } else {
+                padding_++;
+            }
+            buffer_ |= byte << count_;
+            count_ += 8;
+        }
+    }
+
+    uint32_t Peek(unsigned n) const { return static_cast<uint32_t>(buffer_ & ((1ull << n) - 1)); }
+
+    void Drop(unsigned n) {
+        buffer_ >>= n;
+        count_ -= n;
+    }
+
+    uint32_t Bits(unsigned n) {
+        if (n == 0) return 0;
+        if (count_ < n) Refill();
+        uint32_t value = Peek(n);
+        Drop(n);
+        return value;
+    }
+
+    /** Whether more bits were consumed than the input holds. */
+    bool Overrun() const { return padding_ * 8 > count_; }
+
+    /** Discard bits up to the next byte boundary and return to byte reads. */
+    void AlignToByte() {
+        Drop(count_ & 7);
+        size_t buffered = count_ / 8;
+        size_t real = buffered > padding_ ? buffered - padding_ : 0;
+        p_ -= real;
+        buffer_ = 0;
+        count_ = 0;
+        padding_ = 0;
+    }
+
+    /** Byte position after the last consumed bit (rounded up). */
+    size_t Consumed() const {
+        size_t fed = static_cast<size_t>(p_ - start_) + padding_;
+        return fed - count_ / 8;
+    }
+
+    const uint8_t* Position() const { return p_; }
+    size_t Remaining() const { return static_cast<size_t>(end_ - p_); }
+    void Skip(size_t n) { p_ += n; }
+
+private:
+    const uint8_t* start_;
+    const uint8_t* p_;
+    const uint8_t* end_;
+    uint64_t buffer_ = 0;
+    unsigned count_ = 0;
+    size_t padding_ = 0;
+};
+
+/**
+ * Canonical Huffman decoder: a lookup table for codes of up to FAST_BITS
+ * bits, and a bit-at-a-time walk for the rare longer ones.
+ */
+class DeflateHuffman {
+public:
+    static constexpr unsigned FAST_BITS = 10;
+
+    /** False if the lengths over-subscribe the code space. */
+    bool Build(const uint8_t* lengths, size_t count) {
+        std::memset(count_, 0, sizeof(count_));
+        for (size_t i = 0; i < count; i++) count_[lengths[i]]++;
+        count_[0] = 0;
+
+        int left = 1;
+        for (int len = 1; len <= 15; len++) {
+            left <<= 1;
+            left -= count_[len];
+            if (left < 0) return false;
+        }
+
+        uint16_t offsets[16];
+        offsets[1] = 0;
+        for (int len = 1; len < 15; len++) offsets[len + 1] = offsets[len] + count_[len];
+        for (size_t symbol = 0; symbol < count; symbol++) {
+            if (lengths[symbol] != 0) symbols_[offsets[lengths[symbol]]++] = static_cast<uint16_t>(symbol);
+        }
+
+        std::memset(fast_, 0, sizeof(fast_));
+        uint32_t code = 0;
+        size_t index = 0;
+        for (unsigned len = 1; len <= 15; len++) {
+            for (unsigned k = 0; k < count_[len]; k++, code++) {
+                uint16_t symbol = symbols_[index++];
+                if (len > FAST_BITS) continue;
+                // Codes are stored MSB-first but read LSB-first.
+                uint32_t reversed = 0;
+                for (unsigned b = 0; b < len; b++) reversed |= ((code >> b) & 1) << (len - 1 - b);
+                for (uint32_t r = reversed; r < (1u << FAST_BITS); r += 1u << len) {
+                    fast_[r] = static_cast<uint16_t>((symbol << 4) | len);
+                }
+            }
+            code <<= 1;
+        }
+        return true;
+    }
+
+    /** Next symbol, or -1 for a code that is not in the table. */
+    int Decode(LsbBitReader& bits) const {
+        bits.Refill();
+        uint16_t entry = fast_[bits.Peek(FAST_BITS)];
+        if (entry != 0) {
+            bits.Drop(entry & 15);
+            return entry >> 4;
+        }
+        int code = 0;
+        int first = 0;
+        int index = 0;
+        for (int len = 1; len <= 15; len++) {
+            code |= static_cast<int>(bits.Bits(1));
+            int count = count_[len];
+            if (code - count < first) return symbols_[index + (code - first)];
+            index += count;
+            first += count;
+            first <<= 1;
+            code <<= 1;
+        }
+        return -1;
+    }
+
+private:
+    uint16_t fast_[1u << FAST_BITS];
+    uint16_t count_[16];
+    uint16_t symbols_[288];
+};
+
+const DeflateHuffman& FixedLiteralCode() {
+    static const DeflateHuffman code = []() {
+        uint8_t lengths[288];
+        std::fill(lengths, lengths + 144, 8);
+        std::fill(lengths + 144, lengths + 256, 9);
+        std::fill(lengths + 256, lengths + 280, 7);
+        std::fill(lengths + 280, lengths + 288, 8);
+        DeflateHuffman h;
+        h.Build(lengths, 288);
+        return h;
+    }();
+    return code;
+}
+
+const DeflateHuffman& FixedDistanceCode() {
+    static const DeflateHuffman code = []() {
+        uint8_t lengths[30];
+        std::fill(lengths, lengths + 30, 5);
+        DeflateHuffman h;
+        h.Build(lengths, 30);
+        return h;
+    }();
+    return code;
+}
+
+bool ReadDynamicCodes(LsbBitReader& bits, DeflateHuffman& literal, DeflateHuffman& distance,
+                      const char*& error) {
+    unsigned nlen = bits.Bits(5) + 257;
+    unsigned ndist = bits.Bits(5) + 1;
+    unsigned ncode = bits.Bits(4) + 4;
+    if (nlen > 286 || ndist > 30) {
+        error = "bad code counts";
+        return false;
+    }
+
+    uint8_t lengths[320] = {};
+    for (unsigned i = 0; i < ncode; i++) lengths[CODE_LENGTH_ORDER[i]] = static_cast<uint8_t>(bits.Bits(3));
+    DeflateHuffman lencode;
+    if (!lencode.Build(lengths, 19)) {
+        error = "bad code length code";
+        return false;
+    }
+
+    std::memset(lengths, 0, sizeof(lengths));
+    unsigned index = 0;
+    while (index < nlen + ndist) {
+        int symbol = lencode.Decode(bits);
+        if (symbol < 0 || bits.Overrun()) {
+            error = "bad code lengths";
+            return false;
+        }
+        if (symbol < 16) {
+            lengths[index++] = static_cast<uint8_t>(symbol);
+            continue;
+        }
+        uint8_t value = 0;
+        unsigned repeat;
+        if (symbol == 16) {
+            if (index == 0) {
+                error = "repeat with no previous length";
+                return false;
+            }
+            value = lengths[index - 1];
+            repeat = 3 + bits.Bits(2);
+        } else if (symbol == 17) {
+            repeat = 3 + bits.Bits(3);
+        } else {
+            repeat = 11 + bits.Bits(7);
+        }
+        if (index + repeat > nlen + ndist) {
+            error = "too many code lengths";
+            return false;
+        }
+        while (repeat-- > 0) lengths[index++] = value;
+    }
+
+    if (lengths[256] == 0) {
+        error = "no end-of-block code";
+        return false;
+    }
+    if (!literal.Build(lengths, nlen) || !distance.Build(lengths + nlen, ndist)) {
+        error = "over-subscribed code";
+        return false;
+    }
+    return true;
+}
+
+bool InflateCodes(LsbBitReader& bits, OutputWindow& out, const DeflateHuffman& literal,
+                  const DeflateHuffman& distance, DecodeResult& result) {
+    for (;;) {
+        if (bits.Overrun()) {
+            result = Corrupt("truncated stream");
+            return false;
+        }
+        if (!out.Reserve(DEFLATE_MAX_MATCH)) {
+            result = Stopped();
+            return false;
+        }
+
+        int symbol = literal.Decode(bits);
+        if (symbol < 256) {
+            if (symbol < 0) {
+                result = Corrupt("invalid literal/length code");
+                return false;
+            }
+            out.Put(static_cast<uint8_t>(symbol));
+            continue;
+        }
+        if (symbol == 256) return true;
+
+        symbol -= 257;
+        if (symbol >= 29) {
+            result = Corrupt("invalid length symbol");
+            return false;
+        }
+        size_t length = LENGTH_BASE[symbol] + bits.Bits(LENGTH_EXTRA[symbol]);
+
+        int dsym = distance.Decode(bits);
+        if (dsym < 0 || dsym >= 30) {
+            result = Corrupt("invalid distance code");
+            return false;
+        }
+        size_t dist = DIST_BASE[dsym] + bits.Bits(DIST_EXTRA[dsym]);
+        if (dist > out.History()) {
+            result = Corrupt("distance too far back");
+            return false;
+        }
+        out.CopyMatch(dist, length);
+    }
+}
+
+// ============================================================================
+// Zstandard
+// ============================================================================
+
+constexpr uint32_t ZSTD_MAGIC = 0xFD2FB528;
+constexpr uint32_t ZSTD_SKIPPABLE_MASK = 0xFFFFFFF0;
+constexpr uint32_t ZSTD_SKIPPABLE_MAGIC = 0x184D2A50;
+constexpr size_t ZSTD_BLOCK_MAX = 128 * 1024;
+
+constexpr int LL_MAX_SYMBOL = 35;
+constexpr int ML_MAX_SYMBOL = 52;
+constexpr int OF_MAX_SYMBOL = 31;
+
+const int16_t LL_DEFAULT_NORM[36] = {4, 3, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1, 2, 2,
+                                     2, 2, 2, 2, 2, 2, 2, 3, 2, 1, 1, 1, 1, 1, -1, -1, -1, -1};
+const int16_t ML_DEFAULT_NORM[53] = {1, 4, 3, 2, 2, 2, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+                                     1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+                                     1, 1, 1, 1, 1, 1, 1, 1, 1, 1, -1, -1, -1, -1, -1, -1, -1};
+const int16_t OF_DEFAULT_NORM[29] = {1, 1, 1, 1, 1, 1, 2, 2, 2, 1, 1, 1, 1, 1, 1,
+                                     1, 1, 1, 1, 1, 1, 1, 1, 1, -1, -1, -1, -1, -1};
+
+const uint32_t LL_BASE[36] = {0,  1,  2,   3,   4,   5,   6,    7,    8,    9,     10,    11,
+                              12, 13, 14,  15,  16,  18,  20,   22,   24,   28,    32,    40,
+                              48, 64, 128, 256, 512, 1024, 2048, 4096, 8192, 16384, 32768, 65536};
+const uint8_t LL_BITS[36] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  0,  0,  0,  0,  0,  1,  1,
+                             1, 1, 2, 2, 3, 3, 4, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+const uint32_t ML_BASE[53] = {3,  4,  5,  6,  7,  8,  9,  10,  11,  12,  13,   14,   15,   16,
+                              17, 18, 19, 20, 21, 22, 23, 24,  25,  26,  27,   28,   29,   30,
+                              31, 32, 33, 34, 35, 37, 39, 41,  43,  47,  51,   59,   67,   83,
+                              99, 131, 259, 515, 1027, 2051, 4099, 8195, 16387, 32771, 65539};
+const uint8_t ML_BITS[53] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                             0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1,
+                             2, 2, 3, 3, 4, 4, 5, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+
+/** Forward (LSB-first) bit reader over a bounded range, for table headers. */
+class ForwardBits {
+public:
+    ForwardBits(const uint8_t* data, size_t length) : data_(data), length_(length) {}
+
+    uint32_t Peek(unsigned n) const {
+        uint64_t value = 0;
+        size_t byte = pos_ >> 3;
+        for (unsigned i = 0; i < 5 && byte + i < length_; i++) {
+            value |= static_cast<uint64_t>(data_[byte + i]) << (8 * i);
+        }
+        return static_cast<uint32_t>((value >> (pos_ & 7)) & ((1ull << n) - 1));
+    }
+
+    void Skip(unsigned n) { pos_ += n; }
+
+    uint32_t Read(unsigned n) {
+        uint32_t value = Peek(n);
+        Skip(n);
+        return value;
+    }
+
+    size_t BytesConsumed() const { return (pos_ + 7) >> 3; }
+
+private:
+    const uint8_t* data_;
+    size_t length_;
+    size_t pos_ = 0;
+};
+
+/**
+ * Reads a zstd backward bitstream: it starts at the last byte's highest set
+ * bit and runs towards the first byte. Reading past the start yields zeros
+ * and leaves Position() negative.
+ */
+class BackwardBits {
+public:
+    bool Init(const uint8_t* data, size_t length) {
+        data_ = data;
+        length_ = length;
+        if (length == 0 || data[length - 1] == 0) return false;
+        pos_ = static_cast<int64_t>((length - 1) * 8) + HighBit(data[length - 1]);
+        return true;
+    }
+
+    uint32_t Peek(unsigned n) const {
+        if (n == 0) return 0;
+        int64_t start = pos_ - n;
+        if (start >= 0) return Extract(static_cast<size_t>(start), n);
+        if (pos_ <= 0) return 0;
+        // Fewer than n bits left: the missing low bits read as zero.
+        return Extract(0, static_cast<unsigned>(pos_)) << (n - pos_);
+    }
+
+    void Skip(unsigned n) { pos_ -= n; }
+
+    uint32_t Read(unsigned n) {
+        uint32_t value = Peek(n);
+        pos_ -= n;
+        return value;
+    }
+
+    int64_t Position() const { return pos_; }
+
+private:
+    uint32_t Extract(size_t start, unsigned n) const {
+        size_t byte = start >> 3;
+        uint64_t word = 0;
+        if (byte + 8 <= length_) {
+            std::memcpy(&word, data_ + byte, 8);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            word = __builtin_bswap64(word);
+#endif
+        } else {
+            for (size_t i = 0; byte + i < length_; i++) {
+                word |= static_cast<uint64_t>(data_[byte + i]) << (8 * i);
+            }
+        }
+        return static_cast<uint32_t>((word >> (start & 7)) & ((1ull << n) - 1));
+    }
+
+    const uint8_t* data_ = nullptr;
+    size_t length_ = 0;
+    int64_t pos_ = 0;
+};
+
+struct FseEntry {
+    uint16_t baseState;
+    uint8_t symbol;
+    uint8_t bits;
+};
+
+struct FseTable {
+    std::vector<FseEntry> entries;
+    unsigned accuracyLog = 0;
+    bool valid = false;
+
+    bool Build(const int16_t* norm, int maxSymbol, unsigned log) {
+        const uint32_t size = 1u << log;
+        entries.assign(size, FseEntry{0, 0, 0});
+        accuracyLog = log;
+
+        std::vector<uint32_t> next(static_cast<size_t>(maxSymbol) + 1);
+        uint32_t high = size - 1;
+        for (int s = 0; s <= maxSymbol; s++) {
+            if (norm[s] == -1) {
+                entries[high--].symbol = static_cast<uint8_t>(s);
+                next[s] = 1;
+            } else {
+                next[s] = static_cast<uint32_t>(norm[s]);
+            }
+        }
+
+        const uint32_t step = (size >> 1) + (size >> 3) + 3;
+        const uint32_t mask = size - 1;
+        uint32_t pos = 0;
+        for (int s = 0; s <= maxSymbol; s++) {
+            for (int i = 0; i < norm[s]; i++) {
+                entries[pos].symbol = static_cast<uint8_t>(s);
+                do {
+                    pos = (pos + step) & mask;
+                } while (pos > high);
+            }
+        }
+        if (pos != 0) return false;
+
+        for (uint32_t u = 0; u < size; u++) {
+            FseEntry& entry = entries[u];
+            uint32_t state = next[entry.symbol]++;
+            unsigned bits = log - static_cast<unsigned>(HighBit(state));
+            entry.bits = static_cast<uint8_t>(bits);
+            entry.baseState = static_cast<uint16_t>((state << bits) - size);
+        }
+        valid = true;
+        return true;
+    }
+
+    void BuildRle(uint8_t symbol) {
+        entries.assign(1, FseEntry{0, symbol, 0});
+        accuracyLog = 0;
+        valid = true;
+    }
+};
+
+/** Read an FSE table description (normalized counts). */
+bool ReadFseTable(const uint8_t* src, size_t length, int maxSymbol, unsigned maxLog,
+                  FseTable& table, size_t& consumed) {
+    if (length == 0) return false;
+    ForwardBits bits(src, length);
+    unsigned log = bits.Read(4) + 5;
+    if (log > maxLog) return false;
+
+    int16_t norm[256] = {};
+    int remaining = (1 << log) + 1;
+    int threshold = 1 << log;
+    unsigned nbBits = log + 1;
+    int symbol = 0;
+    bool previous0 = false;
+
+    while (remaining > 1 && symbol <= maxSymbol) {
+        if (previous0) {
+            int n0 = symbol;
+            for (;;) {
+                uint32_t repeat = bits.Read(2);
+                n0 += static_cast<int>(repeat);
+                if (repeat != 3) break;
+                if (bits.BytesConsumed() > length) return false;
+            }
+            if (n0 > maxSymbol) return false;
+            while (symbol < n0) norm[symbol++] = 0;
+        }
+
+        int max = (2 * threshold - 1) - remaining;
+        int count;
+        uint32_t value = bits.Peek(nbBits);
+        if (static_cast<int>(value & (threshold - 1)) < max) {
+            count = static_cast<int>(value & (threshold - 1));
+            bits.Skip(nbBits - 1);
+        } else {
+            count = static_cast<int>(value & (2 * threshold - 1));
+            if (count >= threshold) count -= max;
+            bits.Skip(nbBits);
+        }
+        count--;
+        remaining -= count < 0 ? -count : count;
+        if (remaining < 1) return false;
+        norm[symbol++] = static_cast<int16_t>(count);
+        previous0 = count == 0;
+        while (remaining < threshold) {
+            nbBits--;
+            threshold >>= 1;
+        }
+        if (bits.BytesConsumed() > length) return false;
+    }
+    if (remaining != 1) return false;
+
+    consumed = bits.BytesConsumed();
+    return table.Build(norm, symbol - 1, log);
+}
+
+struct HuffmanTable {
+    /** Indexed by the next maxBits bits: (symbol << 8) | code length */
+    std::vector<uint16_t> entries;
+    unsigned maxBits = 0;
+    bool valid = false;
+};
+
+/** Read a literals Huffman tree description. */
+bool ReadHuffmanTable(const uint8_t* src, size_t length, HuffmanTable& table, size_t& consumed) {
+    if (length == 0) return false;
+    uint8_t weights[256] = {};
+    size_t count = 0;
+
+    uint8_t header = src[0];
+    if (header >= 128) {
+        count = header - 127;
+        size_t bytes = (count + 1) / 2;
+        if (1 + bytes > length) return false;
+        for (size_t i = 0; i < count; i++) {
+            uint8_t byte = src[1 + i / 2];
+            weights[i] = (i % 2 == 0) ? byte >> 4 : byte & 15;
+        }
+        consumed = 1 + bytes;
+    } else {
+        size_t compressed = header;
+        if (compressed == 0 || 1 + compressed > length) return false;
+        FseTable fse;
+        size_t used = 0;
+        if (!ReadFseTable(src + 1, compressed, 255, 6, fse, used) || used >= compressed) {
+            return false;
+        }
+        BackwardBits bits;
+        if (!bits.Init(src + 1 + used, compressed - used)) return false;
+
+        uint32_t state1 = bits.Read(fse.accuracyLog);
+        uint32_t state2 = bits.Read(fse.accuracyLog);
+        // Two interleaved states until the stream runs out.
+        for (;;) {
+            if (count > 253) return false;
+            const FseEntry& e1 = fse.entries[state1];
+            weights[count++] = e1.symbol;
+            state1 = e1.baseState + bits.Read(e1.bits);
+            if (bits.Position() < 0) {
+                weights[count++] = fse.entries[state2].symbol;
+                break;
+            }
+            const FseEntry& e2 = fse.entries[state2];
+            weights[count++] = e2.symbol;
+            state2 = e2.baseState + bits.Read(e2.bits);
+            if (bits.Position() < 0) {
+                weights[count++] = fse.entries[state1].symbol;
+                break;
+            }
+        }
+        consumed = 1 + compressed;
+    }
+
+    // The last symbol's weight is implied: it completes a power of two.
+    uint32_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (weights[i] > 11) return false;
+        if (weights[i] > 0) total += 1u << (weights[i] - 1);
+    }
+    if (total == 0) return false;
+    unsigned maxBits = static_cast<unsigned>(HighBit(total)) + 1;
+    if (maxBits > 11) return false;
+    uint32_t rest = (1u << maxBits) - total;
+    if ((rest & (rest - 1)) != 0) return false;
+    weights[count++] = static_cast<uint8_t>(HighBit(rest) + 1);
+
+    uint32_t rankStart[13] = {};
+    uint32_t rankCount[13] = {};
+    for (size_t i = 0; i < count; i++) rankCount[weights[i]]++;
+    uint32_t next = 0;
+    for (unsigned w = 1; w <= maxBits; w++) {
+        rankStart[w] = next;
+        next += rankCount[w] << (w - 1);
+    }
+
+    table.entries.assign(1u << maxBits, 0);
+    table.maxBits = maxBits;
+    for (size_t symbol = 0; symbol < count; symbol++) {
+        unsigned w = weights[symbol];
+        if (w == 0) continue;
+        uint32_t span = 1u << (w - 1);
+        uint16_t entry = static_cast<uint16_t>((symbol << 8) | (maxBits + 1 - w));
+        std::fill_n(table.entries.begin() + rankStart[w], span, entry);
+        rankStart[w] += span;
+    }
+    table.valid = true;
+    return true;
+}
+
+bool DecodeHuffmanStream(const HuffmanTable& table, const uint8_t* src, size_t length,
+                         uint8_t* out, size_t count) {
+    BackwardBits bits;
+    if (!bits.Init(src, length)) return false;
+    const uint16_t* entries = table.entries.data();
+    const unsigned maxBits = table.maxBits;
+    for (size_t i = 0; i < count; i++) {
+        uint16_t entry = entries[bits.Peek(maxBits)];
+        out[i] = static_cast<uint8_t>(entry >> 8);
+        bits.Skip(entry & 0xFF);
+    }
+    return bits.Position() == 0;
+}
+
+/** State that carries from block to block within a frame. */
+struct ZstdFrameState {
+    HuffmanTable huffman;
+    FseTable literalLengths;
+    FseTable offsets;
+    FseTable matchLengths;
+    uint32_t repeat[3] = {1, 4, 8};
+    std::vector<uint8_t> literals;
+};
+
+/** Decode a literals section; sets `literals`/`count` and returns bytes used. */
+bool DecodeLiterals(const uint8_t* src, size_t length, ZstdFrameState& state,
+                    const uint8_t*& literals, size_t& count, size_t& consumed) {
+    if (length == 0) return false;
+    unsigned type = src[0] & 3;
+    unsigned format = (src[0] >> 2) & 3;
+
+    if (type == 0 || type == 1) {
+        size_t headerSize;
+        if ((format & 1) == 0) {
+            headerSize = 1;
+            count = src[0] >> 3;
+        } else if (format == 1) {
+            headerSize = 2;
+            if (length < 2) return false;
+            count = ReadLE16(src) >> 4;
+        } else {
+            headerSize = 3;
+            if (length < 3) return false;
+            count = ReadLE24(src) >> 4;
+        }
+        if (count > ZSTD_BLOCK_MAX) return false;
+        if (type == 0) {
+            if (headerSize + count > length) return false;
+            literals = src + headerSize;
+            consumed = headerSize + count;
+        } else {
+            if (headerSize + 1 > length) return false;
+            state.literals.assign(count, src[headerSize]);
+            literals = state.literals.data();
+            consumed = headerSize + 1;
+        }
+        return true;
+    }
+
+    // Huffman-compressed (type 2) or reusing the previous table (type 3).
+    static const unsigned HEADER_SIZE[4] = {3, 3, 4, 5};
+    static const unsigned SIZE_BITS[4] = {10, 10, 14, 18};
+    size_t headerSize = HEADER_SIZE[format];
+    if (length < headerSize) return false;
+    uint64_t header = 0;
+    for (size_t i = 0; i < headerSize; i++) header |= static_cast<uint64_t>(src[i]) << (8 * i);
+    const uint64_t mask = (1ull << SIZE_BITS[format]) - 1;
+    count = static_cast<size_t>((header >> 4) & mask);
+    size_t compressed = static_cast<size_t>((header >> (4 + SIZE_BITS[format])) & mask);
+    bool fourStreams = format != 0;
+    if (count > ZSTD_BLOCK_MAX || headerSize + compressed > length) return false;
+
+    const uint8_t* p = src + headerSize;
+    size_t remaining = compressed;
+    if (type == 2) {
+        size_t used = 0;
+        if (!ReadHuffmanTable(p, remaining, state.huffman, used)) return false;
+        p += used;
+        remaining -= used;
+    } else if (!state.huffman.valid) {
+        return false;
+    }
+
+    state.literals.resize(count);
+    uint8_t* out = state.literals.data();
+    if (!fourStreams) {
+        if (!DecodeHuffmanStream(state.huffman, p, remaining, out, count)) return false;
+    } else {
+        if (remaining < 6) return false;
+        size_t sizes[4];
+        sizes[0] = ReadLE16(p);
+        sizes[1] = ReadLE16(p + 2);
+        sizes[2] = ReadLE16(p + 4);
+        size_t first3 = sizes[0] + sizes[1] + sizes[2];
+        if (6 + first3 > remaining) return false;
+        sizes[3] = remaining - 6 - first3;
+        size_t segment = (count + 3) / 4;
+        if (3 * segment > count) return false;
+        const uint8_t* stream = p + 6;
+        for (int i = 0; i < 4; i++) {
+            size_t n = i < 3 ? segment : count - 3 * segment;
+            if (!DecodeHuffmanStream(state.huffman, stream, sizes[i], out + i * segment, n)) {
+                return false;
+            }
+            stream += sizes[i];
+        }
+    }
+    literals = out;
+    consumed = headerSize + compressed;
+    return true;
+}
+
+const FseTable& DefaultTable(int which) {
+    static const FseTable tables[3] = {
+        []() { FseTable t; t.Build(LL_DEFAULT_NORM, LL_MAX_SYMBOL, 6); return t; }(),
+        []() { FseTable t; t.Build(OF_DEFAULT_NORM, 28, 5); return t; }(),
+        []() { FseTable t; t.Build(ML_DEFAULT_NORM, ML_MAX_SYMBOL, 6); return t; }(),
+    };
+    return tables[which];
+}
+
+/** Resolve one sequence table from its compression mode. */
+bool ReadSequenceTable(unsigned mode, int which, int maxSymbol, unsigned maxLog,
+                       const uint8_t*& p, const uint8_t* end, FseTable& table) {
+    switch (mode) {
+        case 0:
+            table = DefaultTable(which);
+            return true;
+        case 1:
+            if (p >= end || *p > maxSymbol) return false;
+            table.BuildRle(*p++);
+            return true;
+        case 2: {
+            size_t used = 0;
+            if (!ReadFseTable(p, static_cast<size_t>(end - p), maxSymbol, maxLog, table, used)) {
+                return false;
+            }
+            p += used;
+            return true;
+        }
+        default:
+            return table.valid;
+    }
+}
+
+/** Decode one compressed block straight into `out`. */
+bool DecodeCompressedBlock(const uint8_t* src, size_t length, ZstdFrameState& state,
+                           OutputWindow& out, const char*& error) {
+    const uint8_t* literals = nullptr;
+    size_t literalCount = 0;
+    size_t used = 0;
+    if (!DecodeLiterals(src, length, state, literals, literalCount, used)) {
+        error = "bad literals section";
+        return false;
+    }
+
+    const uint8_t* p = src + used;
+    const uint8_t* end = src + length;
+    if (p >= end) {
+        error = "missing sequences section";
+        return false;
+    }
+
+    size_t sequences = *p++;
+    if (sequences >= 128) {
+        if (sequences == 255) {
+            if (end - p < 2) return error = "bad sequence count", false;
+            sequences = ReadLE16(p) + 0x7F00;
+            p += 2;
+        } else {
+            if (p >= end) return error = "bad sequence count", false;
+            sequences = ((sequences - 128) << 8) + *p++;
+        }
+    }
+
+    size_t produced = 0;
+    const uint8_t* literal = literals;
+    const uint8_t* literalEnd = literals + literalCount;
+
+    if (sequences > 0) {
+        if (p >= end) return error = "missing compression modes", false;
+        uint8_t modes = *p++;
+        if ((modes & 3) != 0) return error = "reserved compression mode bits", false;
+        if (!ReadSequenceTable(modes >> 6, 0, LL_MAX_SYMBOL, 9, p, end, state.literalLengths) ||
+            !ReadSequenceTable((modes >> 4) & 3, 1, OF_MAX_SYMBOL, 8, p, end, state.offsets) ||
+            !ReadSequenceTable((modes >> 2) & 3, 2, ML_MAX_SYMBOL, 9, p, end,
+                               state.matchLengths)) {
+            error = "bad sequence tables";
+            return false;
+        }
+
+        BackwardBits bits;
+        if (!bits.Init(p, static_cast<size_t>(end - p))) {
+            error = "bad sequence bitstream";
+            return false;
+        }
+        const FseTable& llTable = state.literalLengths;
+        const FseTable& ofTable = state.offsets;
+        const FseTable& mlTable = state.matchLengths;
+        uint32_t llState = bits.Read(llTable.accuracyLog);
+        uint32_t ofState = bits.Read(ofTable.accuracyLog);
+        uint32_t mlState = bits.Read(mlTable.accuracyLog);
+        uint32_t* rep = state.repeat;
+
+        for (size_t i = 0; i < sequences; i++) {
+            const FseEntry& ll = llTable.entries[llState];
+            const FseEntry& of = ofTable.entries[ofState];
+            const FseEntry& ml = mlTable.entries[mlState];
+            if (ll.symbol > LL_MAX_SYMBOL || ml.symbol > ML_MAX_SYMBOL || of.symbol > OF_MAX_SYMBOL) {
+                error = "bad sequence code";
+                return false;
+            }
+
+            uint32_t offsetValue = (1u << of.symbol) + bits.Read(of.symbol);
+            size_t matchLength = ML_BASE[ml.symbol] + bits.Read(ML_BITS[ml.symbol]);
+            size_t literalLength = LL_BASE[ll.symbol] + bits.Read(LL_BITS[ll.symbol]);
+
+            if (i + 1 < sequences) {
+                llState = ll.baseState + bits.Read(ll.bits);
+                mlState = ml.baseState + bits.Read(ml.bits);
+                ofState = of.baseState + bits.Read(of.bits);
+            }
+
+            uint32_t offset;
+            if (offsetValue > 3) {
+                offset = offsetValue - 3;
+                rep[2] = rep[1];
+                rep[1] = rep[0];
+                rep[0] = offset;
+            } else {
+                unsigned index = offsetValue - 1 + (literalLength == 0 ? 1 : 0);
+                if (index == 0) {
+                    offset = rep[0];
+                } else {
+                    offset = index == 3 ? rep[0] - 1 : rep[index];
+                    if (offset == 0) return error = "zero offset", false;
+                    if (index != 1) rep[2] = rep[1];
+                    rep[1] = rep[0];
+                    rep[0] = offset;
+                }
+            }
+
+            if (static_cast<size_t>(literalEnd - literal) < literalLength ||
+                produced + literalLength + matchLength > ZSTD_BLOCK_MAX) {
+                error = "sequence overflows block";
+                return false;
+            }
+            std::memcpy(out.Cursor(), literal, literalLength);
+            out.Advance(literalLength);
+            literal += literalLength;
+            if (offset > out.History()) return error = "offset too far back", false;
+            out.CopyMatch(offset, matchLength);
+            produced += literalLength + matchLength;
+        }
+        if (bits.Position() != 0) return error = "sequence bitstream not consumed", false;
+    } else if (p != end) {
+        error = "trailing bytes after empty sequences section";
+        return false;
+    }
+
+    size_t rest = static_cast<size_t>(literalEnd - literal);
+    if (produced + rest > ZSTD_BLOCK_MAX) return error = "block too large", false;
+    std::memcpy(out.Cursor(), literal, rest);
+    out.Advance(rest);
+    return true;
+}
+
+/** Decode one frame starting after its magic number. */
+DecodeResult DecodeZstdFrame(const uint8_t* input, size_t length, const ByteSink& sink) {
+    if (length < 1) return Corrupt("truncated frame header");
+    uint8_t descriptor = input[0];
+    unsigned fcsFlag = descriptor >> 6;
+    bool singleSegment = (descriptor >> 5) & 1;
+    bool checksum = (descriptor >> 2) & 1;
+    unsigned dictFlag = descriptor & 3;
+    if (descriptor & 0x08) return Corrupt("reserved frame header bit");
+
+    static const size_t DICT_SIZE[4] = {0, 1, 2, 4};
+    static const size_t FCS_SIZE[4] = {0, 2, 4, 8};
+    size_t fcsSize = fcsFlag == 0 && singleSegment ? 1 : FCS_SIZE[fcsFlag];
+    size_t headerSize = 1 + (singleSegment ? 0 : 1) + DICT_SIZE[dictFlag] + fcsSize;
+    if (length < headerSize) return Corrupt("truncated frame header");
+
+    const uint8_t* p = input + 1;
+    uint64_t windowSize = 0;
+    if (!singleSegment) {
+        uint8_t wd = *p++;
+        unsigned exponent = wd >> 3;
+        uint64_t base = 1ull << (10 + exponent);
+        windowSize = base + (base / 8) * (wd & 7);
+    }
+    uint32_t dictId = 0;
+    for (size_t i = 0; i < DICT_SIZE[dictFlag]; i++) dictId |= static_cast<uint32_t>(p[i]) << (8 * i);
+    p += DICT_SIZE[dictFlag];
+    if (dictId != 0) return Fail(DecodeStatus::Unsupported, "zstd dictionaries are not supported");
+
+    bool hasContentSize = fcsSize != 0;
+    uint64_t contentSize = 0;
+    for (size_t i = 0; i < fcsSize; i++) contentSize |= static_cast<uint64_t>(p[i]) << (8 * i);
+    if (fcsSize == 2) contentSize += 256;
+    p += fcsSize;
+
+    if (singleSegment) windowSize = contentSize;
+    if (windowSize > ZSTD_MAX_WINDOW) {
+        return Fail(DecodeStatus::Unsupported, "zstd window too large");
+    }
+    // History beyond the frame's content is never referenced.
+    uint64_t history = hasContentSize ? std::min(windowSize, contentSize) : windowSize;
+    size_t blockMax = static_cast<size_t>(std::min<uint64_t>(std::max<uint64_t>(windowSize, 1),
+                                                            ZSTD_BLOCK_MAX));
+
+    OutputWindow out(static_cast<size_t>(history), 2 * ZSTD_BLOCK_MAX, sink);
+    ZstdFrameState state;
+    const uint8_t* end = input + length;
+    uint64_t produced = 0;
+
+    for (;;) {
+        if (end - p < 3) return Corrupt("truncated block header");
+        uint32_t blockHeader = ReadLE24(p);
+        p += 3;
+        bool last = blockHeader & 1;
+        unsigned type = (blockHeader >> 1) & 3;
+        size_t size = blockHeader >> 3;
+
+        if (!out.Reserve(ZSTD_BLOCK_MAX)) return Stopped();
+        size_t before = out.History();
+        switch (type) {
+            case 0:
+                if (size > blockMax || static_cast<size_t>(end - p) < size) {
+                    return Corrupt("bad raw block");
+                }
+                std::memcpy(out.Cursor(), p, size);
+                out.Advance(size);
+                p += size;
+                break;
+            case 1:
+                if (size > blockMax || p >= end) return Corrupt("bad RLE block");
+                std::memset(out.Cursor(), *p, size);
+                out.Advance(size);
+                p += 1;
+                break;
+            case 2: {
+                if (size > blockMax || static_cast<size_t>(end - p) < size) {
+                    return Corrupt("bad compressed block");
+                }
+                const char* error = nullptr;
+                if (!DecodeCompressedBlock(p, size, state, out, error)) return Corrupt(error);
+                p += size;
+                break;
+            }
+            default:
+                return Corrupt("reserved block type");
+        }
+        produced += out.History() - before;
+        if (!out.Flush()) return Stopped();
+        if (last) break;
+    }
+
+    if (hasContentSize && produced != contentSize) return Corrupt("frame content size mismatch");
+    if (checksum) {
+        if (end - p < 4) return Corrupt("truncated checksum");
+        p += 4;
+    }
+
+    DecodeResult result;
+    result.consumed = static_cast<size_t>(p - input);
+    return result;
+}
+
+} // namespace
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+DecodeResult InflateRaw(const uint8_t* input, size_t length, const ByteSink& sink) {
+    OutputWindow out(DEFLATE_WINDOW, DEFLATE_CHUNK, sink);
+    LsbBitReader bits(input, length);
+    DeflateHuffman literal;
+    DeflateHuffman distance;
+    DecodeResult result;
+
+    for (;;) {
+        bool final = bits.Bits(1) != 0;
+        unsigned type = bits.Bits(2);
+
+        if (type == 0) {
+            bits.AlignToByte();
+            if (bits.Remaining() < 4) return Corrupt("truncated stored block");
+            const uint8_t* header = bits.Position();
+            uint32_t len = ReadLE16(header);
+            if ((len ^ ReadLE16(header + 2)) != 0xFFFF) return Corrupt("stored length mismatch");
+            bits.Skip(4);
+            if (bits.Remaining() < len) return Corrupt("truncated stored block");
+            const uint8_t* data = bits.Position();
+            size_t copied = 0;
+            while (copied < len) {
+                size_t n = std::min<size_t>(len - copied, DEFLATE_CHUNK / 2);
+                if (!out.Reserve(n)) return Stopped();
+                std::memcpy(out.Cursor(), data + copied, n);
+                out.Advance(n);
+                copied += n;
+            }
+            bits.Skip(len);
+        } else if (type == 1) {
+            if (!InflateCodes(bits, out, FixedLiteralCode(), FixedDistanceCode(), result)) {
+                return result;
+            }
+        } else if (type == 2) {
+            const char* error = nullptr;
+            if (!ReadDynamicCodes(bits, literal, distance, error)) return Corrupt(error);
+            if (!InflateCodes(bits, out, literal, distance, result)) return result;
+        } else {
+            return Corrupt("invalid block type");
+        }
+
+        if (bits.Overrun()) return Corrupt("truncated stream");
+        if (final) break;
+    }
+
+    if (!out.Flush()) return Stopped();
+    result.consumed = bits.Consumed();
+    return result;
+}
+
+DecodeResult Gunzip(const uint8_t* input, size_t length, const ByteSink& sink, std::string* name) {
+    size_t pos = 0;
+    bool first = true;
+    while (pos < length) {
+        const uint8_t* p = input + pos;
+        size_t left = length - pos;
+        bool member = left >= 18 && p[0] == 0x1F && p[1] == 0x8B && p[2] == 8;
+        if (!member) {
+            // Trailing padding after the last member is common; ignore it.
+            if (!first) break;
+            return Corrupt("not a gzip stream");
+        }
+
+        uint8_t flags = p[3];
+        if (flags & 0xE0) return Corrupt("reserved gzip flags");
+        size_t offset = 10;
+        if (flags & 0x04) {
+            if (left < offset + 2) return Corrupt("truncated gzip header");
+            offset += 2 + ReadLE16(p + offset);
+        }
+        if (flags & 0x08) {
+            size_t start = offset;
+            while (offset < left && p[offset] != 0) offset++;
+            if (first && name != nullptr) name->assign(reinterpret_cast<const char*>(p + start), offset - start);
+            offset++;
+        }
+        if (flags & 0x10) {
+            while (offset < left && p[offset] != 0) offset++;
+            offset++;
+        }
+        if (flags & 0x02) offset += 2;
+        if (offset > left) return Corrupt("truncated gzip header");
+
+        DecodeResult member_result = InflateRaw(p + offset, left - offset, sink);
+        if (member_result.status != DecodeStatus::Ok) return member_result;
+        offset += member_result.consumed;
+        if (offset + 8 > left) return Corrupt("truncated gzip trailer");
+        pos += offset + 8;
+        first = false;
+    }
+
+    DecodeResult result;
+    result.consumed = pos;
+    return result;
+}
+
+DecodeResult ZstdDecompress(const uint8_t* input, size_t length, const ByteSink& sink) {
+    size_t pos = 0;
+    while (pos < length) {
+        if (length - pos < 4) return Corrupt("truncated frame");
+        uint32_t magic = ReadLE32(input + pos);
+        pos += 4;
+        if ((magic & ZSTD_SKIPPABLE_MASK) == ZSTD_SKIPPABLE_MAGIC) {
+            if (length - pos < 4) return Corrupt("truncated skippable frame");
+            uint64_t size = ReadLE32(input + pos);
+            pos += 4;
+            if (length - pos < size) return Corrupt("truncated skippable frame");
+            pos += static_cast<size_t>(size);
+            continue;
+        }
+        if (magic != ZSTD_MAGIC) return Corrupt("not a zstd frame");
+
+        DecodeResult frame = DecodeZstdFrame(input + pos, length - pos, sink);
+        if (frame.status != DecodeStatus::Ok) return frame;
+        pos += frame.consumed;
+    }
+
+    DecodeResult result;
+    result.consumed = pos;
+    return result;
+}
+
+std::string DecodeErrorMessage(const DecodeResult& result) {
+    switch (result.status) {
+        case DecodeStatus::Corrupt: return "corrupt data: " + result.error;
+        case DecodeStatus::Unsupported: return "unsupported: " + result.error;
+        case DecodeStatus::Stopped: return "stopped";
+        default: return "";
+    }
+}
+
+} // namespace TerminAI
@@ -0,0 +1,78 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Decompression Header
+ *
+ * Self-contained DEFLATE (RFC 1951), gzip (RFC 1952) and Zstandard
+ * (RFC 8878) decoders for scanning archive content in memory.
+ *
+ * The decoders take the whole compressed input (a mapped file or a member
+ * of one) and stream their output through a ByteSink in chunks, keeping only
+ * the format's back-reference window in memory. The sink can stop decoding
+ * at any chunk, which is how callers enforce size and ratio limits without
+ * ever materializing the full output.
+ *
+ * Zstandard dictionaries are not supported, and checksums (gzip CRC-32,
+ * zstd XXH64) are not verified: the output is scanned, not trusted.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace TerminAI {
+
+/**
+ * Receives decoded output in order. Returns false to stop decoding (the
+ * decoder then returns DecodeStatus::Stopped).
+ */
+using ByteSink = std::function<bool(const uint8_t* data, size_t length)>;
+
+enum class DecodeStatus {
+    Ok,
+    /** Malformed or truncated input */
+    Corrupt,
+    /** Valid input using a feature this decoder does not implement */
+    Unsupported,
+    /** The sink asked to stop */
+    Stopped,
+};
+
+struct DecodeResult {
+    DecodeStatus status = DecodeStatus::Ok;
+    /** Input bytes consumed (meaningful for Ok) */
+    size_t consumed = 0;
+    std::string error;
+};
+
+/** Largest zstd window accepted; bounds decoder memory per stream. */
+constexpr size_t ZSTD_MAX_WINDOW = 64 * 1024 * 1024;
+
+/**
+ * Decode a raw DEFLATE stream (zip method 8).
+ */
+DecodeResult InflateRaw(const uint8_t* input, size_t length, const ByteSink& sink);
+
+/**
+ * Decode a gzip file: every concatenated member, in order.
+ *
+ * @param name Set to the first member's FNAME field, if present
+ */
+DecodeResult Gunzip(const uint8_t* input, size_t length, const ByteSink& sink,
+                    std::string* name = nullptr);
+
+/**
+ * Decode Zstandard frames (skippable frames are skipped).
+ */
+DecodeResult ZstdDecompress(const uint8_t* input, size_t length, const ByteSink& sink);
+
+/** "corrupt data: <detail>" style message for a failed result. */
+std::string DecodeErrorMessage(const DecodeResult& result);
+
+} // namespace TerminAI
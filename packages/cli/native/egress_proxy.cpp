@@ -0,0 +1,1629 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Egress Proxy Implementation
+ *
+ * The service thread owns every listener and connection. A connection reads
+ * its request header, is checked against its proxy's allowlist, resolves
+ * (on the worker pool, unless the host is an address), connects without
+ * blocking and then relays with one pipe per direction. Work from other
+ * threads (new listeners, closed proxies, resolved names) is posted to the
+ * thread as commands. Counters are atomics, read by the JS thread at any
+ * time.
+ */
+
+#include "egress_proxy.h"
+
+#ifdef __linux__
+
+#include "worker_pool.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace TerminAI {
+
+namespace {
+
+constexpr size_t kMaxHeaderBytes = 8 * 1024;
+/** Bytes moved per splice() call, and the most a direction holds in its pipe */
+constexpr size_t kPipeBytes = 64 * 1024;
+/** A ClientHello record (5-byte header + at most 16 KiB) */
+constexpr size_t kMaxHelloBytes = 5 + 16 * 1024;
+/** Request header, resolution, connect and ClientHello, in all */
+constexpr int64_t kHandshakeMs = 10000;
+/** Rate-limited reads wait for at least this many tokens (or the burst) */
+constexpr uint64_t kMinGrant = 16 * 1024;
+constexpr size_t kMaxHosts = 256;
+constexpr size_t kPooledPipes = 64;
+constexpr int kMaxEvents = 64;
+constexpr int kAcceptsPerWakeup = 64;
+/** Pump rounds per connection per wakeup */
+constexpr int kPumpRounds = 16;
+
+/** Completion keys: id << 3 | kind. Ids start at 1; 0 wakes the thread. */
+constexpr uint64_t kWakeKey = 0;
+enum KeyKind : uint64_t { kListener = 1, kClient = 2, kUpstream = 3, kOwnerExit = 4 };
+
+const char* const kStatusBadRequest =
+    "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+const char* const kStatusHeaderTooLarge =
+    "HTTP/1.1 431 Request Header Fields Too Large\r\nContent-Length: 0\r\n"
+    "Connection: close\r\n\r\n";
+const char* const kStatusBadGateway =
+    "HTTP/1.1 502 Bad Gateway\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+const char* const kStatusUnavailable =
+    "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+const char* const kStatusTimeout =
+    "HTTP/1.1 504 Gateway Timeout\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+const char* const kStatusEstablished = "HTTP/1.1 200 Connection established\r\n\r\n";
+
+int64_t NowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+int64_t NowMs() { return NowUs() / 1000; }
+
+std::string Lowercase(std::string text) {
+    for (char& c : text) c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+    return text;
+}
+
+bool StartsWithIgnoringCase(const std::string& text, size_t offset, const char* prefix) {
+    size_t length = strlen(prefix);
+    if (text.size() - std::min(text.size(), offset) < length) return false;
+    return strncasecmp(text.c_str() + offset, prefix, length) == 0;
+}
+
+// ============================================================================
+// Hosts
+// ============================================================================
+
+/** Canonical text of an IP address literal, or "" if `host` is not one. */
+std::string CanonicalAddress(const std::string& host) {
+    char text[INET6_ADDRSTRLEN];
+    in_addr v4;
+    in6_addr v6;
+    if (inet_pton(AF_INET, host.c_str(), &v4) == 1) {
+        return inet_ntop(AF_INET, &v4, text, sizeof(text)) ? text : "";
+    }
+    if (inet_pton(AF_INET6, host.c_str(), &v6) == 1) {
+        return inet_ntop(AF_INET6, &v6, text, sizeof(text)) ? text : "";
+    }
+    return "";
+}
+
+/**
+ * Lowercase a host name (dropping a trailing dot) or canonicalize an
+ * address. @return false if it is neither.
+ */
+bool NormalizeHost(std::string host, std::string& out, bool& literal) {
+    std::string address = CanonicalAddress(host);
+    if (!address.empty()) {
+        out = address;
+        literal = true;
+        return true;
+    }
+    host = Lowercase(std::move(host));
+    if (!host.empty() && host.back() == '.') host.pop_back();
+    if (host.empty() || host.size() > 253 || host.front() == '.' || host.front() == '-') {
+        return false;
+    }
+    for (char c : host) {
+        if (!isalnum(static_cast<unsigned char>(c)) && c != '.' && c != '-' && c != '_') {
+            return false;
+        }
+    }
+    out = host;
+    literal = false;
+    return true;
+}
+
+bool ParsePort(const std::string& text, uint16_t& port) {
+    if (text.empty() || text.size() > 5) return false;
+    uint32_t value = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') return false;
+        value = value * 10 + static_cast<uint32_t>(c - '0');
+    }
+    if (value == 0 || value > 65535) return false;
+    port = static_cast<uint16_t>(value);
+    return true;
+}
+
+/**
+ * Split "host", "host:port", "[v6]", "[v6]:port" or a bare IPv6 address.
+ * `port` is left alone when there is none.
+ */
+bool SplitAuthority(const std::string& authority, std::string& host, uint16_t& port) {
+    if (!authority.empty() && authority.front() == '[') {
+        size_t close = authority.find(']');
+        if (close == std::string::npos) return false;
+        host = authority.substr(1, close - 1);
+        if (close + 1 == authority.size()) return true;
+        return authority[close + 1] == ':' && ParsePort(authority.substr(close + 2), port);
+    }
+    size_t colon = authority.find(':');
+    if (colon == std::string::npos || authority.find(':', colon + 1) != std::string::npos) {
+        host = authority; // No port, or an IPv6 address without brackets
+        return true;
+    }
+    host = authority.substr(0, colon);
+    return ParsePort(authority.substr(colon + 1), port);
+}
+
+bool ParseAllowEntry(const std::string& text, EgressAllowEntry& entry) {
+    std::string host;
+    uint16_t port = 0;
+    if (!SplitAuthority(text, host, port)) return false;
+    entry = EgressAllowEntry();
+    entry.port = port;
+    if (host == "*") {
+        entry.wildcard = true;
+        return true;
+    }
+    if (host.rfind("*.", 0) == 0) {
+        entry.wildcard = true;
+        host = host.substr(2);
+    }
+    bool literal = false;
+    if (!NormalizeHost(host, entry.host, literal)) return false;
+    if (literal && entry.wildcard) return false;
+    entry.literal = literal;
+    return true;
+}
+
+bool IsPrivateV4(uint32_t address) {
+    uint8_t a = static_cast<uint8_t>(address >> 24);
+    uint8_t b = static_cast<uint8_t>(address >> 16);
+    return a == 0 || a == 10 || a == 127 || (a == 100 && (b & 0xc0) == 64) ||
+           (a == 169 && b == 254) || (a == 172 && (b & 0xf0) == 16) || (a == 192 && b == 168) ||
+           a >= 224;
+}
+
+/** Loopback, private, link-local, unspecified or multicast. */
+bool IsPrivate(const sockaddr_storage& address) {
+    if (address.ss_family == AF_INET) {
+        const auto& v4 = reinterpret_cast<const sockaddr_in&>(address);
+        return IsPrivateV4(ntohl(v4.sin_addr.s_addr));
+    }
+    const in6_addr& v6 = reinterpret_cast<const sockaddr_in6&>(address).sin6_addr;
+    if (IN6_IS_ADDR_V4MAPPED(&v6)) {
+        uint32_t v4;
+        memcpy(&v4, v6.s6_addr + 12, sizeof(v4));
+        return IsPrivateV4(ntohl(v4));
+    }
+    return IN6_IS_ADDR_UNSPECIFIED(&v6) || IN6_IS_ADDR_LOOPBACK(&v6) ||
+           IN6_IS_ADDR_LINKLOCAL(&v6) || IN6_IS_ADDR_MULTICAST(&v6) ||
+           (v6.s6_addr[0] & 0xfe) == 0xfc;
+}
+
+// ============================================================================
+// TLS ClientHello
+// ============================================================================
+
+enum class HelloName { Absent, Found, Malformed };
+
+/**
+ * The server_name of a ClientHello handshake message (the body of its
+ * record), lowercased.
+ */
+HelloName ParseServerName(const uint8_t* data, size_t length, std::string& name) {
+    size_t at = 0;
+    auto skip = [&](size_t count) {
+        if (length - at < count) return false;
+        at += count;
+        return true;
+    };
+    auto u8 = [&](size_t& value) {
+        if (length - at < 1) return false;
+        value = data[at++];
+        return true;
+    };
+    auto u16 = [&](size_t& value) {
+        if (length - at < 2) return false;
+        value = static_cast<size_t>(data[at]) << 8 | data[at + 1];
+        at += 2;
+        return true;
+    };
+
+    size_t size = 0;
+    // Handshake type 1 (ClientHello), 24-bit length, version, random.
+    if (length < 4 || data[0] != 1) return HelloName::Malformed;
+    at = 4;
+    if (!skip(2 + 32) || !u8(size) || !skip(size) || !u16(size) || !skip(size) || !u8(size) ||
+        !skip(size)) {
+        return HelloName::Malformed;
+    }
+    if (at == length) return HelloName::Absent; // No extensions
+    size_t extensions = 0;
+    if (!u16(extensions) || length - at < extensions) return HelloName::Malformed;
+    size_t end = at + extensions;
+    while (at < end) {
+        size_t type = 0;
+        if (!u16(type) || !u16(size) || end - at < size) return HelloName::Malformed;
+        if (type != 0) {
+            at += size;
+            continue;
+        }
+        // server_name: list length, then (name_type, length, name) entries.
+        size_t listEnd = at + size;
+        size_t list = 0;
+        if (!u16(list) || listEnd - at < list) return HelloName::Malformed;
+        while (at < listEnd) {
+            size_t nameType = 0;
+            if (!u8(nameType) || !u16(size) || listEnd - at < size) return HelloName::Malformed;
+            if (nameType == 0) {
+                name.assign(reinterpret_cast<const char*>(data + at), size);
+                return HelloName::Found;
+            }
+            at += size;
+        }
+        return HelloName::Absent;
+    }
+    return HelloName::Absent;
+}
+
+// ============================================================================
+// Token Bucket
+// ============================================================================
+
+/** Service thread only. */
+class TokenBucket {
+public:
+    void Configure(uint64_t rate, uint64_t burst) {
+        rate_ = rate;
+        burst_ = static_cast<double>(burst != 0 ? burst : rate);
+        tokens_ = burst_;
+        lastUs_ = NowUs();
+    }
+
+    bool Limited() const { return rate_ != 0; }
+
+    /** Up to `want` tokens; none until at least the minimum grant is there. */
+    size_t Take(size_t want) {
+        Refill();
+        double minimum = std::min({static_cast<double>(kMinGrant), burst_,
+                                   static_cast<double>(want)});
+        if (tokens_ < minimum) return 0;
+        size_t grant = std::min(want, static_cast<size_t>(tokens_));
+        tokens_ -= static_cast<double>(grant);
+        return grant;
+    }
+
+    void Refund(size_t count) {
+        tokens_ = std::min(burst_, tokens_ + static_cast<double>(count));
+    }
+
+    /** When Take() can grant again. */
+    int64_t ReadyAtMs() const {
+        double minimum = std::min(static_cast<double>(kMinGrant), burst_);
+        double missing = std::max(0.0, minimum - tokens_);
+        return (lastUs_ + static_cast<int64_t>(std::ceil(missing * 1e6 / rate_))) / 1000 + 1;
+    }
+
+private:
+    void Refill() {
+        int64_t now = NowUs();
+        tokens_ = std::min(burst_, tokens_ + static_cast<double>(now - lastUs_) * rate_ / 1e6);
+        lastUs_ = now;
+    }
+
+    uint64_t rate_ = 0;
+    double burst_ = 0;
+    double tokens_ = 0;
+    int64_t lastUs_ = 0;
+};
+
+struct HostCounters {
+    std::atomic<uint64_t> connections{0};
+    std::atomic<uint64_t> denied{0};
+    std::atomic<uint64_t> bytesUp{0};
+    std::atomic<uint64_t> bytesDown{0};
+};
+
+} // namespace
+
+// ============================================================================
+// Egress Proxy
+// ============================================================================
+
+class EgressProxy {
+public:
+    EgressProxy(std::string id, EgressPolicy policy)
+        : id_(std::move(id)), policy_(std::move(policy)) {
+        up.Configure(policy_.bytesPerSec, policy_.burstBytes);
+        down.Configure(policy_.bytesPerSec, policy_.burstBytes);
+    }
+
+    const std::string& Id() const { return id_; }
+    const EgressPolicy& Policy() const { return policy_; }
+
+    /**
+     * Whether `host` (normalized) may be reached on `port`. `exact` is set
+     * if an address entry names it, which exempts it from the private
+     * address check.
+     */
+    bool Allowed(const std::string& host, bool literal, uint16_t port, bool& exact) const {
+        exact = false;
+        for (const auto& entry : policy_.allow) {
+            if (entry.port != 0 && entry.port != port) continue;
+            bool match = false;
+            if (entry.wildcard) {
+                match = entry.host.empty() ||
+                        (!literal && host.size() > entry.host.size() &&
+                         host.compare(host.size() - entry.host.size(), std::string::npos,
+                                      entry.host) == 0 &&
+                         host[host.size() - entry.host.size() - 1] == '.');
+            } else {
+                match = host == entry.host;
+            }
+            if (!match) continue;
+            exact = entry.literal;
+            return true;
+        }
+        return false;
+    }
+
+    /** Counters of one host; past kMaxHosts, hosts share "(other)". */
+    HostCounters& Host(const std::string& host) {
+        std::lock_guard<std::mutex> lock(hostsMutex_);
+        auto it = hosts_.find(host);
+        if (it != hosts_.end()) return *it->second;
+        const std::string& key = hosts_.size() < kMaxHosts ? host : std::string("(other)");
+        auto& counters = hosts_[key];
+        if (!counters) counters = std::make_unique<HostCounters>();
+        return *counters;
+    }
+
+    template <typename Visit>
+    void ForEachHost(Visit&& visit) const {
+        std::lock_guard<std::mutex> lock(hostsMutex_);
+        for (const auto& [host, counters] : hosts_) visit(host, *counters);
+    }
+
+    std::atomic<uint64_t> listeners{0};
+    std::atomic<uint64_t> connections{0};
+    std::atomic<uint64_t> active{0};
+    std::atomic<uint64_t> denied{0};
+    std::atomic<uint64_t> failed{0};
+    std::atomic<uint64_t> bytesUp{0};
+    std::atomic<uint64_t> bytesDown{0};
+    std::atomic<uint64_t> throttled{0};
+    std::atomic<uint64_t> spliceCalls{0};
+
+    /** Unix socket to unlink when the proxy is closed */
+    std::string socketPath;
+    /** Closed: listeners that arrive late are dropped */
+    std::atomic<bool> closed{false};
+
+    // Service thread
+    TokenBucket up;
+    TokenBucket down;
+
+private:
+    std::string id_;
+    EgressPolicy policy_;
+    mutable std::mutex hostsMutex_;
+    std::map<std::string, std::unique_ptr<HostCounters>> hosts_;
+};
+
+namespace {
+
+// ============================================================================
+// Connections
+// ============================================================================
+
+enum class Phase { Request, Resolving, Connecting, Open };
+
+struct Address {
+    sockaddr_storage storage;
+    socklen_t length;
+};
+
+/** One direction of a relay: source -> pipe -> destination. */
+struct Pump {
+    int pipe[2] = {-1, -1};
+    /** Bytes in the pipe */
+    size_t buffered = 0;
+    /** The pipe refused more (its pages are partly used); wait for a drain */
+    bool full = false;
+    /** The source reached end of file */
+    bool eof = false;
+    /** The destination was shut down for writing */
+    bool shut = false;
+    /** Out of tokens until the connection's resume timer */
+    bool throttled = false;
+
+    bool CanFill() const { return !eof && !full && !throttled && buffered < kPipeBytes; }
+};
+
+struct Connection {
+    uint64_t id = 0;
+    EgressProxyPtr proxy;
+    HostCounters* host = nullptr;
+    Phase phase = Phase::Request;
+    int client = -1;
+    int upstream = -1;
+    /** epoll interest registered for each socket; 0 = not in the set */
+    uint32_t clientEvents = 0;
+    uint32_t upstreamEvents = 0;
+
+    std::string header;
+    std::string target;
+    uint16_t port = 0;
+    bool literal = false;
+    /** Allowed by an address entry: private addresses are fine */
+    bool exact = false;
+    bool tunnel = false;
+    /** Tunnel whose ClientHello has not been checked yet */
+    bool inspecting = false;
+    bool lowered = false;
+    /** Forwarded request header still to write upstream */
+    std::string pending;
+    size_t pendingSent = 0;
+
+    std::vector<Address> addresses;
+    size_t nextAddress = 0;
+
+    Pump up;
+    Pump down;
+
+    /** Handshake deadline; 0 once relaying */
+    int64_t deadlineMs = 0;
+    /** Throttled directions resume; 0 = none */
+    int64_t resumeMs = 0;
+    bool dead = false;
+};
+
+} // namespace
+
+// ============================================================================
+// Service
+// ============================================================================
+
+class EgressService {
+public:
+    static EgressService& Instance() {
+        // Leaked on purpose: the service thread must not be joined from a
+        // static destructor during process exit.
+        static EgressService* service = new EgressService();
+        return *service;
+    }
+
+    /** Start the service thread (first proxy). */
+    bool Ensure(std::string& error);
+
+    uint64_t NextId() { return ++lastId_; }
+
+    /** Run `command` on the service thread. */
+    void Post(std::function<void()> command) {
+        {
+            std::lock_guard<std::mutex> lock(commandsMutex_);
+            commands_.push_back(std::move(command));
+        }
+        uint64_t one = 1;
+        ssize_t ignored = write(wakeFd_, &one, sizeof(one));
+        (void)ignored;
+    }
+
+    // Service thread
+    void AddListener(const EgressProxyPtr& proxy, int fd, int ownerFd);
+    void CloseProxy(const EgressProxyPtr& proxy);
+
+private:
+    struct Listener {
+        EgressProxyPtr proxy;
+        int fd = -1;
+        /** pidfd of the process whose namespace the listener is in */
+        int ownerFd = -1;
+    };
+
+    EgressService() = default;
+
+    void Run();
+    void RunCommands();
+    int WaitTimeoutMs() const;
+    void RunTimers();
+    void Arm(Connection& conn, int64_t atMs) { timers_.emplace(atMs, conn.id); }
+
+    void Accept(Listener& listener);
+    void DropListener(uint64_t id);
+    void Handle(Connection& conn, uint64_t kind, uint32_t events);
+    void ReadRequest(Connection& conn);
+    void ParseRequest(Connection& conn);
+    void Deny(Connection& conn);
+    void Resolve(Connection& conn);
+    void Connect(Connection& conn, std::vector<Address> addresses);
+    void ConnectNext(Connection& conn);
+    void FinishConnect(Connection& conn);
+    void Opened(Connection& conn);
+    void Inspect(Connection& conn);
+    void Relay(Connection& conn);
+    bool Move(Connection& conn, Pump& pump, int source, int destination, TokenBucket& bucket,
+              bool upward);
+    void Fail(Connection& conn, const char* status);
+    void Reply(Connection& conn, const char* status);
+    void UpdateInterest(Connection& conn);
+    void SetInterest(int fd, uint64_t key, uint32_t& current, uint32_t wanted);
+    void Destroy(uint64_t id);
+    /** Handle the end of a step: update interest or destroy. */
+    void Settle(Connection& conn);
+
+    bool AcquirePipe(Pump& pump);
+    void ReleasePipe(Pump& pump);
+
+    Connection* Find(uint64_t id) {
+        auto it = connections_.find(id);
+        return it == connections_.end() ? nullptr : it->second.get();
+    }
+
+    std::once_flag started_;
+    bool ready_ = false;
+    std::string startError_;
+    std::atomic<uint64_t> lastId_{0};
+
+    int epoll_ = -1;
+    int wakeFd_ = -1;
+
+    std::mutex commandsMutex_;
+    std::vector<std::function<void()>> commands_;
+
+    // Service thread
+    std::unordered_map<uint64_t, Listener> listeners_;
+    std::unordered_map<uint64_t, std::unique_ptr<Connection>> connections_;
+    /** Deadline -> connection; stale entries are skipped when they fire */
+    std::multimap<int64_t, uint64_t> timers_;
+    std::vector<std::array<int, 2>> pipes_;
+};
+
+bool EgressService::Ensure(std::string& error) {
+    std::call_once(started_, [this]() {
+        epoll_ = epoll_create1(EPOLL_CLOEXEC);
+        wakeFd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.u64 = kWakeKey;
+        if (epoll_ < 0 || wakeFd_ < 0 || epoll_ctl(epoll_, EPOLL_CTL_ADD, wakeFd_, &event) != 0) {
+            startError_ = std::string("cannot start the egress service: ") + strerror(errno);
+            return;
+        }
+        std::thread([this]() { Run(); }).detach();
+        ready_ = true;
+    });
+    error = startError_;
+    return ready_;
+}
+
+void EgressService::Run() {
+    epoll_event events[kMaxEvents];
+    for (;;) {
+        int ready = epoll_wait(epoll_, events, kMaxEvents, WaitTimeoutMs());
+        if (ready < 0) {
+            if (errno != EINTR) {
+                std::cerr << "[EgressProxy] epoll_wait failed: " << strerror(errno) << std::endl;
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            ready = 0;
+        }
+
+        for (int i = 0; i < ready; i++) {
+            uint64_t key = events[i].data.u64;
+            if (key == kWakeKey) {
+                uint64_t count;
+                ssize_t ignored = read(wakeFd_, &count, sizeof(count));
+                (void)ignored;
+                RunCommands();
+                continue;
+            }
+            uint64_t id = key >> 3;
+            uint64_t kind = key & 7;
+            if (kind == kListener || kind == kOwnerExit) {
+                auto it = listeners_.find(id);
+                if (it == listeners_.end()) continue;
+                if (kind == kListener) {
+                    Accept(it->second);
+                } else {
+                    DropListener(id);
+                }
+                continue;
+            }
+            Connection* conn = Find(id);
+            if (conn == nullptr) continue;
+            Handle(*conn, kind, events[i].events);
+            Settle(*conn);
+        }
+        RunTimers();
+    }
+}
+
+void EgressService::RunCommands() {
+    std::vector<std::function<void()>> commands;
+    {
+        std::lock_guard<std::mutex> lock(commandsMutex_);
+        commands.swap(commands_);
+    }
+    for (auto& command : commands) command();
+}
+
+int EgressService::WaitTimeoutMs() const {
+    if (timers_.empty()) return -1;
+    int64_t ms = std::max<int64_t>(0, timers_.begin()->first - NowMs());
+    return static_cast<int>(std::min<int64_t>(ms, INT32_MAX));
+}
+
+void EgressService::RunTimers() {
+    int64_t now = NowMs();
+    while (!timers_.empty() && timers_.begin()->first <= now) {
+        uint64_t id = timers_.begin()->second;
+        timers_.erase(timers_.begin());
+        Connection* conn = Find(id);
+        if (conn == nullptr) continue;
+        if (conn->deadlineMs != 0 && conn->deadlineMs <= now) {
+            // A tunnel still waiting for its ClientHello is already open.
+            bool replied = conn->phase == Phase::Request || conn->phase == Phase::Open;
+            conn->proxy->failed++;
+            Fail(*conn, replied ? nullptr : kStatusTimeout);
+        } else if (conn->resumeMs != 0 && conn->resumeMs <= now) {
+            conn->resumeMs = 0;
+            conn->up.throttled = false;
+            conn->down.throttled = false;
+            Relay(*conn);
+        } else {
+            continue;
+        }
+        Settle(*conn);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Listeners
+// ----------------------------------------------------------------------------
+
+void EgressService::AddListener(const EgressProxyPtr& proxy, int fd, int ownerFd) {
+    uint64_t id = NextId();
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.u64 = id << 3 | kListener;
+    if (proxy->closed || epoll_ctl(epoll_, EPOLL_CTL_ADD, fd, &event) != 0) {
+        if (!proxy->closed) {
+            std::cerr << "[EgressProxy] cannot watch a listener of " << proxy->Id() << ": "
+                      << strerror(errno) << std::endl;
+        }
+        close(fd);
+        if (ownerFd >= 0) close(ownerFd);
+        proxy->listeners--;
+        return;
+    }
+    if (ownerFd >= 0) {
+        event.data.u64 = id << 3 | kOwnerExit;
+        if (epoll_ctl(epoll_, EPOLL_CTL_ADD, ownerFd, &event) != 0) {
+            close(ownerFd);
+            ownerFd = -1;
+        }
+    }
+    listeners_[id] = Listener{proxy, fd, ownerFd};
+}
+
+void EgressService::DropListener(uint64_t id) {
+    auto it = listeners_.find(id);
+    if (it == listeners_.end()) return;
+    for (int fd : {it->second.fd, it->second.ownerFd}) {
+        if (fd < 0) continue;
+        epoll_ctl(epoll_, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+    }
+    it->second.proxy->listeners--;
+    listeners_.erase(it);
+}
+
+void EgressService::CloseProxy(const EgressProxyPtr& proxy) {
+    std::vector<uint64_t> ids;
+    for (const auto& [id, listener] : listeners_) {
+        if (listener.proxy == proxy) ids.push_back(id);
+    }
+    for (uint64_t id : ids) DropListener(id);
+    ids.clear();
+    for (const auto& [id, conn] : connections_) {
+        if (conn->proxy == proxy) ids.push_back(id);
+    }
+    for (uint64_t id : ids) Destroy(id);
+}
+
+void EgressService::Accept(Listener& listener) {
+    EgressProxy& proxy = *listener.proxy;
+    for (int i = 0; i < kAcceptsPerWakeup; i++) {
+        int fd = accept4(listener.fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            if (errno != EAGAIN) {
+                std::cerr << "[EgressProxy] accept failed on " << proxy.Id() << ": "
+                          << strerror(errno) << std::endl;
+            }
+            return;
+        }
+        proxy.connections++;
+        if (proxy.active.load() >= proxy.Policy().maxConnections) {
+            proxy.failed++;
+            ssize_t ignored = send(fd, kStatusUnavailable, strlen(kStatusUnavailable),
+                                   MSG_NOSIGNAL | MSG_DONTWAIT);
+            (void)ignored;
+            close(fd);
+            continue;
+        }
+        auto conn = std::make_unique<Connection>();
+        conn->id = NextId();
+        conn->proxy = listener.proxy;
+        conn->client = fd;
+        conn->deadlineMs = NowMs() + kHandshakeMs;
+        proxy.active++;
+        Arm(*conn, conn->deadlineMs);
+        Connection& added = *conn;
+        connections_[conn->id] = std::move(conn);
+        UpdateInterest(added);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Handshake
+// ----------------------------------------------------------------------------
+
+void EgressService::Handle(Connection& conn, uint64_t kind, uint32_t events) {
+    switch (conn.phase) {
+        case Phase::Request:
+            if (kind == kClient) ReadRequest(conn);
+            break;
+        case Phase::Connecting:
+            if (kind == kUpstream) FinishConnect(conn);
+            break;
+        case Phase::Open:
+            if (conn.inspecting && kind == kClient && (events & EPOLLIN)) Inspect(conn);
+            if (!conn.dead) Relay(conn);
+            break;
+        case Phase::Resolving:
+            break; // Nothing is watched
+    }
+}
+
+void EgressService::ReadRequest(Connection& conn) {
+    char buffer[kMaxHeaderBytes];
+    size_t room = kMaxHeaderBytes - conn.header.size();
+    ssize_t n = recv(conn.client, buffer, room, MSG_PEEK);
+    if (n < 0 && (errno == EAGAIN || errno == EINTR)) return;
+    if (n <= 0) {
+        conn.dead = true;
+        return;
+    }
+
+    // Take the header and nothing after it; the rest is the body (or, for
+    // a tunnel, the ClientHello) and stays in the socket.
+    size_t previous = conn.header.size();
+    conn.header.append(buffer, static_cast<size_t>(n));
+    size_t end = conn.header.find("\r\n\r\n", previous >= 3 ? previous - 3 : 0);
+    size_t take = end == std::string::npos ? static_cast<size_t>(n) : end + 4 - previous;
+    conn.header.resize(previous + take);
+    while (recv(conn.client, buffer, take, 0) < 0 && errno == EINTR) {
+    }
+
+    if (end != std::string::npos) {
+        ParseRequest(conn);
+    } else if (conn.header.size() >= kMaxHeaderBytes) {
+        Fail(conn, kStatusHeaderTooLarge);
+    }
+}
+
+void EgressService::ParseRequest(Connection& conn) {
+    EgressProxy& proxy = *conn.proxy;
+    size_t lineEnd = conn.header.find("\r\n");
+    std::string line = conn.header.substr(0, lineEnd);
+    size_t space1 = line.find(' ');
+    size_t space2 = line.rfind(' ');
+    if (space1 == std::string::npos || space2 == space1) {
+        Fail(conn, kStatusBadRequest);
+        return;
+    }
+    std::string method = line.substr(0, space1);
+    std::string target = line.substr(space1 + 1, space2 - space1 - 1);
+    std::string version = line.substr(space2 + 1);
+
+    std::string authority;
+    std::string path;
+    if (method == "CONNECT") {
+        conn.tunnel = true;
+        authority = target;
+        conn.port = 0; // Required
+    } else if (StartsWithIgnoringCase(target, 0, "http://")) {
+        size_t slash = target.find_first_of("/?", 7);
+        authority = target.substr(7, slash == std::string::npos ? std::string::npos : slash - 7);
+        path = slash == std::string::npos ? "/" : target.substr(slash);
+        if (path.front() == '?') path.insert(0, "/");
+        size_t at = authority.rfind('@');
+        if (at != std::string::npos) authority.erase(0, at + 1);
+        conn.port = 80;
+    } else {
+        // Origin-form (not sent to proxies) or https:// (sent as CONNECT).
+        Fail(conn, kStatusBadRequest);
+        return;
+    }
+
+    std::string host;
+    if (!SplitAuthority(authority, host, conn.port) || conn.port == 0 ||
+        !NormalizeHost(host, conn.target, conn.literal)) {
+        Fail(conn, kStatusBadRequest);
+        return;
+    }
+    if (!proxy.Allowed(conn.target, conn.literal, conn.port, conn.exact)) {
+        Deny(conn);
+        return;
+    }
+
+    if (!conn.tunnel) {
+        // One request per connection: its header is rewritten to
+        // origin-form without the Proxy-* and hop-by-hop fields.
+        conn.pending = method + " " + path + " " + version + "\r\n";
+        size_t at = lineEnd + 2;
+        while (at < conn.header.size()) {
+            size_t next = conn.header.find("\r\n", at);
+            if (next == at) break;
+            bool drop = StartsWithIgnoringCase(conn.header, at, "proxy-") ||
+                        StartsWithIgnoringCase(conn.header, at, "connection:") ||
+                        StartsWithIgnoringCase(conn.header, at, "keep-alive:");
+            if (!drop) conn.pending.append(conn.header, at, next + 2 - at);
+            at = next + 2;
+        }
+        conn.pending += "Connection: close\r\n\r\n";
+    }
+    conn.header.clear();
+    conn.header.shrink_to_fit();
+
+    conn.host = &proxy.Host(conn.target);
+    conn.host->connections++;
+    Resolve(conn);
+}
+
+void EgressService::Deny(Connection& conn) {
+    EgressProxy& proxy = *conn.proxy;
+    proxy.denied++;
+    proxy.Host(conn.target).denied++;
+    std::string reply = "HTTP/1.1 403 Forbidden\r\nContent-Type: text/plain\r\n"
+                        "Connection: close\r\nContent-Length: ";
+    std::string body = "egress to " + conn.target + ":" + std::to_string(conn.port) +
+                       " is not allowed\n";
+    reply += std::to_string(body.size()) + "\r\n\r\n" + body;
+    // The tunnel was already established for an SNI denial: just drop it.
+    Fail(conn, conn.phase == Phase::Open ? nullptr : reply.c_str());
+}
+
+void EgressService::Resolve(Connection& conn) {
+    if (conn.literal) {
+        Address address = {};
+        if (inet_pton(AF_INET, conn.target.c_str(),
+                      &reinterpret_cast<sockaddr_in&>(address.storage).sin_addr) == 1) {
+            auto& v4 = reinterpret_cast<sockaddr_in&>(address.storage);
+            v4.sin_family = AF_INET;
+            v4.sin_port = htons(conn.port);
+            address.length = sizeof(sockaddr_in);
+        } else {
+            auto& v6 = reinterpret_cast<sockaddr_in6&>(address.storage);
+            inet_pton(AF_INET6, conn.target.c_str(), &v6.sin6_addr);
+            v6.sin6_family = AF_INET6;
+            v6.sin6_port = htons(conn.port);
+            address.length = sizeof(sockaddr_in6);
+        }
+        Connect(conn, {address});
+        return;
+    }
+
+    conn.phase = Phase::Resolving;
+    uint64_t id = conn.id;
+    std::string host = conn.target;
+    std::string port = std::to_string(conn.port);
+    WorkerPool::Shared().Submit([this, id, host, port]() {
+        addrinfo hints = {};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_NUMERICSERV;
+        addrinfo* list = nullptr;
+        std::vector<Address> addresses;
+        if (getaddrinfo(host.c_str(), port.c_str(), &hints, &list) == 0) {
+            for (addrinfo* info = list; info != nullptr; info = info->ai_next) {
+                if (info->ai_addrlen > sizeof(sockaddr_storage)) continue;
+                Address address = {};
+                memcpy(&address.storage, info->ai_addr, info->ai_addrlen);
+                address.length = info->ai_addrlen;
+                addresses.push_back(address);
+            }
+            freeaddrinfo(list);
+        }
+        Post([this, id, addresses = std::move(addresses)]() mutable {
+            Connection* conn = Find(id);
+            if (conn == nullptr) return;
+            Connect(*conn, std::move(addresses));
+            Settle(*conn);
+        });
+    });
+}
+
+void EgressService::Connect(Connection& conn, std::vector<Address> addresses) {
+    if (addresses.empty()) {
+        conn.proxy->failed++;
+        Fail(conn, kStatusBadGateway);
+        return;
+    }
+    if (!conn.exact && !conn.proxy->Policy().allowPrivate) {
+        addresses.erase(std::remove_if(addresses.begin(), addresses.end(),
+                                       [](const Address& a) { return IsPrivate(a.storage); }),
+                        addresses.end());
+        if (addresses.empty()) {
+            Deny(conn);
+            return;
+        }
+    }
+    conn.addresses = std::move(addresses);
+    conn.nextAddress = 0;
+    ConnectNext(conn);
+}
+
+void EgressService::ConnectNext(Connection& conn) {
+    if (conn.upstream >= 0) {
+        SetInterest(conn.upstream, 0, conn.upstreamEvents, 0);
+        close(conn.upstream);
+        conn.upstream = -1;
+    }
+    while (conn.nextAddress < conn.addresses.size()) {
+        const Address& address = conn.addresses[conn.nextAddress++];
+        int fd = socket(address.storage.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) continue;
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        if (connect(fd, reinterpret_cast<const sockaddr*>(&address.storage), address.length) ==
+            0) {
+            conn.upstream = fd;
+            Opened(conn);
+            return;
+        }
+        if (errno == EINPROGRESS) {
+            conn.upstream = fd;
+            conn.phase = Phase::Connecting;
+            return;
+        }
+        close(fd);
+    }
+    conn.proxy->failed++;
+    Fail(conn, kStatusBadGateway);
+}
+
+void EgressService::FinishConnect(Connection& conn) {
+    int error = 0;
+    socklen_t length = sizeof(error);
+    if (getsockopt(conn.upstream, SOL_SOCKET, SO_ERROR, &error, &length) != 0) error = errno;
+    if (error == EINPROGRESS || error == EALREADY) return;
+    if (error != 0) {
+        ConnectNext(conn);
+        return;
+    }
+    Opened(conn);
+}
+
+void EgressService::Opened(Connection& conn) {
+    conn.phase = Phase::Open;
+    conn.addresses.clear();
+    if (!AcquirePipe(conn.up) || !AcquirePipe(conn.down)) {
+        conn.proxy->failed++;
+        Fail(conn, kStatusBadGateway);
+        return;
+    }
+    if (conn.tunnel) {
+        Reply(conn, kStatusEstablished);
+        conn.inspecting = true;
+    } else {
+        conn.deadlineMs = 0;
+    }
+    Relay(conn);
+}
+
+void EgressService::Inspect(Connection& conn) {
+    uint8_t buffer[kMaxHelloBytes];
+    ssize_t n = recv(conn.client, buffer, sizeof(buffer), MSG_PEEK);
+    if (n < 0 && (errno == EAGAIN || errno == EINTR)) return;
+
+    size_t need = 5;
+    HelloName result = HelloName::Absent;
+    std::string name;
+    if (n > 0 && buffer[0] == 0x16) {
+        if (n >= 5) need += std::min(static_cast<size_t>(buffer[3]) << 8 | buffer[4],
+                                     kMaxHelloBytes - 5);
+        if (static_cast<size_t>(n) < need) {
+            // Wake up once the whole record is there.
+            int lowat = static_cast<int>(need);
+            setsockopt(conn.client, SOL_SOCKET, SO_RCVLOWAT, &lowat, sizeof(lowat));
+            conn.lowered = true;
+            return;
+        }
+        result = ParseServerName(buffer + 5, need - 5, name);
+    }
+    // Not TLS, or end of file: the relay takes it from here.
+
+    if (conn.lowered) {
+        int one = 1;
+        setsockopt(conn.client, SOL_SOCKET, SO_RCVLOWAT, &one, sizeof(one));
+        conn.lowered = false;
+    }
+    conn.inspecting = false;
+    conn.deadlineMs = 0;
+    if (result == HelloName::Absent) return;
+
+    bool literal = false;
+    std::string host;
+    bool exact = false;
+    if (result == HelloName::Malformed || !NormalizeHost(name, host, literal) ||
+        !conn.proxy->Allowed(host, literal, conn.port, exact)) {
+        if (result == HelloName::Found && !host.empty()) conn.target = host;
+        Deny(conn);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Relay
+// ----------------------------------------------------------------------------
+
+void EgressService::Relay(Connection& conn) {
+    EgressProxy& proxy = *conn.proxy;
+    for (int round = 0; round < kPumpRounds && !conn.dead; round++) {
+        if (conn.pendingSent < conn.pending.size()) {
+            ssize_t n = send(conn.upstream, conn.pending.data() + conn.pendingSent,
+                             conn.pending.size() - conn.pendingSent, MSG_NOSIGNAL);
+            if (n < 0 && errno != EAGAIN && errno != EINTR) {
+                conn.dead = true;
+                return;
+            }
+            if (n > 0) {
+                conn.pendingSent += static_cast<size_t>(n);
+                proxy.bytesUp += static_cast<uint64_t>(n);
+                conn.host->bytesUp += static_cast<uint64_t>(n);
+            }
+            if (conn.pendingSent < conn.pending.size()) break;
+            conn.pending.clear();
+            conn.pendingSent = 0;
+        }
+        bool progress = false;
+        if (!conn.inspecting) {
+            progress |= Move(conn, conn.up, conn.client, conn.upstream, proxy.up, true);
+        }
+        if (!conn.dead) {
+            progress |= Move(conn, conn.down, conn.upstream, conn.client, proxy.down, false);
+        }
+        if (!progress) break;
+    }
+    if (conn.up.shut && conn.down.shut) conn.dead = true;
+}
+
+bool EgressService::Move(Connection& conn, Pump& pump, int source, int destination,
+                         TokenBucket& bucket, bool upward) {
+    EgressProxy& proxy = *conn.proxy;
+    bool progress = false;
+
+    if (pump.buffered > 0) {
+        ssize_t n = splice(pump.pipe[0], nullptr, destination, nullptr, pump.buffered,
+                           SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        proxy.spliceCalls++;
+        if (n > 0) {
+            pump.buffered -= static_cast<size_t>(n);
+            pump.full = false;
+            (upward ? proxy.bytesUp : proxy.bytesDown) += static_cast<uint64_t>(n);
+            if (conn.host != nullptr) {
+                (upward ? conn.host->bytesUp : conn.host->bytesDown) += static_cast<uint64_t>(n);
+            }
+            progress = true;
+        } else if (n < 0 && errno != EAGAIN && errno != EINTR) {
+            conn.dead = true;
+            return false;
+        }
+    }
+
+    if (pump.CanFill()) {
+        size_t want = kPipeBytes - pump.buffered;
+        if (bucket.Limited()) {
+            want = bucket.Take(want);
+            if (want == 0) {
+                pump.throttled = true;
+                proxy.throttled++;
+                int64_t resume = bucket.ReadyAtMs();
+                if (conn.resumeMs == 0 || resume < conn.resumeMs) {
+                    conn.resumeMs = resume;
+                    Arm(conn, resume);
+                }
+            }
+        }
+        if (want > 0) {
+            ssize_t n = splice(source, nullptr, pump.pipe[1], nullptr, want,
+                               SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+            proxy.spliceCalls++;
+            if (n > 0) {
+                pump.buffered += static_cast<size_t>(n);
+                progress = true;
+            } else if (n == 0) {
+                pump.eof = true;
+                progress = true;
+            } else if (errno == EAGAIN) {
+                // With bytes in the pipe this is the pipe, not the socket.
+                if (pump.buffered > 0) pump.full = true;
+            } else if (errno != EINTR) {
+                conn.dead = true;
+            }
+            if (bucket.Limited()) {
+                bucket.Refund(want - static_cast<size_t>(std::max<ssize_t>(n, 0)));
+            }
+        }
+    }
+
+    if (pump.eof && pump.buffered == 0 && !pump.shut) {
+        shutdown(destination, SHUT_WR);
+        pump.shut = true;
+        progress = true;
+    }
+    return progress;
+}
+
+void EgressService::Reply(Connection& conn, const char* status) {
+    // Replies are a few dozen bytes on a socket that has sent nothing yet.
+    ssize_t ignored = send(conn.client, status, strlen(status), MSG_NOSIGNAL | MSG_DONTWAIT);
+    (void)ignored;
+}
+
+void EgressService::Fail(Connection& conn, const char* status) {
+    if (status != nullptr) Reply(conn, status);
+    conn.dead = true;
+}
+
+// ----------------------------------------------------------------------------
+// Bookkeeping
+// ----------------------------------------------------------------------------
+
+void EgressService::SetInterest(int fd, uint64_t key, uint32_t& current, uint32_t wanted) {
+    if (wanted == current) return;
+    epoll_event event = {};
+    event.events = wanted;
+    event.data.u64 = key;
+    // Out of the set while nothing is wanted, or hangups would spin.
+    int op = wanted == 0 ? EPOLL_CTL_DEL : current == 0 ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+    epoll_ctl(epoll_, op, fd, &event);
+    current = wanted;
+}
+
+void EgressService::UpdateInterest(Connection& conn) {
+    uint32_t client = 0;
+    uint32_t upstream = 0;
+    switch (conn.phase) {
+        case Phase::Request:
+            client = EPOLLIN;
+            break;
+        case Phase::Resolving:
+            break;
+        case Phase::Connecting:
+            upstream = EPOLLOUT;
+            break;
+        case Phase::Open: {
+            // The body waits for the forwarded header to be written.
+            bool forwarding = conn.pendingSent < conn.pending.size();
+            if (conn.inspecting || (!forwarding && conn.up.CanFill())) client |= EPOLLIN;
+            if (conn.down.buffered > 0) client |= EPOLLOUT;
+            if (conn.down.CanFill()) upstream |= EPOLLIN;
+            if (conn.up.buffered > 0 || forwarding) upstream |= EPOLLOUT;
+            break;
+        }
+    }
+    SetInterest(conn.client, conn.id << 3 | kClient, conn.clientEvents, client);
+    if (conn.upstream >= 0) {
+        SetInterest(conn.upstream, conn.id << 3 | kUpstream, conn.upstreamEvents, upstream);
+    }
+}
+
+void EgressService::Settle(Connection& conn) {
+    if (conn.dead) {
+        Destroy(conn.id);
+    } else {
+        UpdateInterest(conn);
+    }
+}
+
+void EgressService::Destroy(uint64_t id) {
+    auto it = connections_.find(id);
+    if (it == connections_.end()) return;
+    Connection& conn = *it->second;
+    for (int fd : {conn.client, conn.upstream}) {
+        if (fd < 0) continue;
+        epoll_ctl(epoll_, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+    }
+    ReleasePipe(conn.up);
+    ReleasePipe(conn.down);
+    conn.proxy->active--;
+    connections_.erase(it);
+}
+
+bool EgressService::AcquirePipe(Pump& pump) {
+    if (!pipes_.empty()) {
+        pump.pipe[0] = pipes_.back()[0];
+        pump.pipe[1] = pipes_.back()[1];
+        pipes_.pop_back();
+        return true;
+    }
+    if (pipe2(pump.pipe, O_NONBLOCK | O_CLOEXEC) != 0) return false;
+    fcntl(pump.pipe[1], F_SETPIPE_SZ, static_cast<int>(kPipeBytes));
+    return true;
+}
+
+void EgressService::ReleasePipe(Pump& pump) {
+    if (pump.pipe[0] < 0) return;
+    // Only empty pipes go back: what is left in one would leak into the next.
+    if (pump.buffered == 0 && pipes_.size() < kPooledPipes) {
+        pipes_.push_back({pump.pipe[0], pump.pipe[1]});
+    } else {
+        close(pump.pipe[0]);
+        close(pump.pipe[1]);
+    }
+    pump.pipe[0] = pump.pipe[1] = -1;
+}
+
+// ============================================================================
+// Registry
+// ============================================================================
+
+namespace {
+
+std::mutex g_proxiesMutex;
+std::unordered_map<std::string, EgressProxyPtr> g_proxies;
+std::atomic<uint64_t> g_standaloneIds{0};
+
+EgressProxyPtr FindProxy(const std::string& id) {
+    std::lock_guard<std::mutex> lock(g_proxiesMutex);
+    auto it = g_proxies.find(id);
+    return it == g_proxies.end() ? nullptr : it->second;
+}
+
+/** A positive number option, or `fallback` if absent. */
+bool ReadPositive(const Napi::Object& options, const char* name, double fallback, double max,
+                  double& out, std::string& error) {
+    Napi::Value value = options.Get(name);
+    if (value.IsUndefined()) {
+        out = fallback;
+        return true;
+    }
+    double number = value.IsNumber() ? value.As<Napi::Number>().DoubleValue() : -1;
+    if (!(number >= 1) || number > max || number != std::floor(number)) {
+        error = std::string(name) + " must be an integer from 1 to " +
+                std::to_string(static_cast<uint64_t>(max));
+        return false;
+    }
+    out = number;
+    return true;
+}
+
+int OpenLoopbackListener(const Napi::Object& options, std::string& socketPath, uint16_t& port,
+                         std::string& error) {
+    Napi::Value path = options.Get("socketPath");
+    int fd = -1;
+    if (!path.IsUndefined()) {
+        if (!path.IsString() || path.As<Napi::String>().Utf8Value().empty()) {
+            error = "listen.socketPath must be a non-empty string";
+            return -1;
+        }
+        socketPath = path.As<Napi::String>().Utf8Value();
+        sockaddr_un address = {};
+        if (socketPath.size() >= sizeof(address.sun_path)) {
+            error = "listen.socketPath is too long";
+            return -1;
+        }
+        address.sun_family = AF_UNIX;
+        memcpy(address.sun_path, socketPath.c_str(), socketPath.size());
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd >= 0 && bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            error = "cannot listen on " + socketPath + ": " + strerror(errno);
+            close(fd);
+            return -1;
+        }
+    } else {
+        double number = 0;
+        Napi::Value value = options.Get("port");
+        if (!value.IsUndefined()) {
+            number = value.IsNumber() ? value.As<Napi::Number>().DoubleValue() : -1;
+            if (!(number >= 0 && number <= 65535) || number != std::floor(number)) {
+                error = "listen.port must be an integer from 0 to 65535";
+                return -1;
+            }
+        }
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(static_cast<uint16_t>(number));
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        int one = 1;
+        if (fd >= 0) setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        socklen_t length = sizeof(address);
+        if (fd >= 0 && (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+                        getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length) != 0)) {
+            error = std::string("cannot listen on 127.0.0.1: ") + strerror(errno);
+            close(fd);
+            return -1;
+        }
+        port = ntohs(address.sin_port);
+    }
+    if (fd < 0 || listen(fd, SOMAXCONN) != 0) {
+        error = std::string("cannot listen: ") + strerror(errno);
+        if (fd >= 0) close(fd);
+        if (!socketPath.empty()) unlink(socketPath.c_str());
+        return -1;
+    }
+    return fd;
+}
+
+} // namespace
+
+bool ReadEgressPolicy(const Napi::Object& options, EgressPolicy& policy, std::string& error) {
+    Napi::Value allow = options.Get("allow");
+    if (!allow.IsArray()) {
+        error = "allow must be an array of hosts";
+        return false;
+    }
+    Napi::Array entries = allow.As<Napi::Array>();
+    policy.allow.clear();
+    for (uint32_t i = 0; i < entries.Length(); i++) {
+        Napi::Value value = entries.Get(i);
+        EgressAllowEntry entry;
+        if (!value.IsString() || !ParseAllowEntry(value.As<Napi::String>().Utf8Value(), entry)) {
+            error = "invalid allow entry '" + value.ToString().Utf8Value() + "'";
+            return false;
+        }
+        policy.allow.push_back(std::move(entry));
+    }
+
+    Napi::Value rate = options.Get("rate");
+    if (!rate.IsUndefined()) {
+        if (!rate.IsObject()) {
+            error = "rate must be an object";
+            return false;
+        }
+        double bytesPerSec = 0;
+        double burstBytes = 0;
+        Napi::Object object = rate.As<Napi::Object>();
+        if (object.Get("bytesPerSec").IsUndefined()) {
+            error = "rate.bytesPerSec is required";
+            return false;
+        }
+        if (!ReadPositive(object, "bytesPerSec", 0, 1e12, bytesPerSec, error) ||
+            !ReadPositive(object, "burstBytes", bytesPerSec, 1e12, burstBytes, error)) {
+            error = "rate." + error;
+            return false;
+        }
+        policy.bytesPerSec = static_cast<uint64_t>(bytesPerSec);
+        policy.burstBytes = static_cast<uint64_t>(burstBytes);
+    }
+
+    double maxConnections = 0;
+    if (!ReadPositive(options, "maxConnections", 256, 65536, maxConnections, error)) return false;
+    policy.maxConnections = static_cast<uint32_t>(maxConnections);
+
+    Napi::Value allowPrivate = options.Get("allowPrivate");
+    if (!allowPrivate.IsUndefined() && !allowPrivate.IsBoolean()) {
+        error = "allowPrivate must be a boolean";
+        return false;
+    }
+    policy.allowPrivate = allowPrivate.IsBoolean() && allowPrivate.As<Napi::Boolean>().Value();
+    return true;
+}
+
+EgressProxyPtr CreateEgressProxy(const std::string& id, const EgressPolicy& policy,
+                                 std::string& error) {
+    if (!EgressService::Instance().Ensure(error)) return nullptr;
+    auto proxy = std::make_shared<EgressProxy>(id, policy);
+    std::lock_guard<std::mutex> lock(g_proxiesMutex);
+    if (!g_proxies.emplace(id, proxy).second) {
+        error = "egress proxy '" + id + "' already exists";
+        return nullptr;
+    }
+    return proxy;
+}
+
+bool AttachEgressListener(const EgressProxyPtr& proxy, int fd, int owner, std::string& error) {
+    if (fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) != 0) {
+        error = std::string("cannot use the egress listener: ") + strerror(errno);
+        close(fd);
+        return false;
+    }
+    int ownerFd = -1;
+#ifdef SYS_pidfd_open
+    // Without pidfds (before 5.3) the listener stays until the proxy closes.
+    if (owner > 0) ownerFd = static_cast<int>(syscall(SYS_pidfd_open, owner, 0));
+#endif
+    if (ownerFd >= 0) fcntl(ownerFd, F_SETFD, FD_CLOEXEC);
+    proxy->listeners++;
+    EgressService::Instance().Post([proxy, fd, ownerFd]() {
+        EgressService::Instance().AddListener(proxy, fd, ownerFd);
+    });
+    return true;
+}
+
+void CloseEgressProxy(const EgressProxyPtr& proxy) {
+    {
+        std::lock_guard<std::mutex> lock(g_proxiesMutex);
+        auto it = g_proxies.find(proxy->Id());
+        if (it == g_proxies.end() || it->second != proxy) return;
+        g_proxies.erase(it);
+    }
+    proxy->closed = true;
+    if (!proxy->socketPath.empty()) unlink(proxy->socketPath.c_str());
+    EgressService::Instance().Post([proxy]() { EgressService::Instance().CloseProxy(proxy); });
+}
+
+Napi::Object EgressStatsObject(Napi::Env env, const EgressProxy& proxy) {
+    auto number = [&env](uint64_t value) {
+        return Napi::Number::New(env, static_cast<double>(value));
+    };
+    Napi::Object stats = Napi::Object::New(env);
+    stats.Set("id", Napi::String::New(env, proxy.Id()));
+    stats.Set("listeners", number(proxy.listeners.load()));
+    stats.Set("connections", number(proxy.connections.load()));
+    stats.Set("active", number(proxy.active.load()));
+    stats.Set("denied", number(proxy.denied.load()));
+    stats.Set("failed", number(proxy.failed.load()));
+    stats.Set("bytesUp", number(proxy.bytesUp.load()));
+    stats.Set("bytesDown", number(proxy.bytesDown.load()));
+    stats.Set("throttled", number(proxy.throttled.load()));
+    stats.Set("spliceCalls", number(proxy.spliceCalls.load()));
+
+    Napi::Array hosts = Napi::Array::New(env);
+    uint32_t index = 0;
+    proxy.ForEachHost([&](const std::string& host, const HostCounters& counters) {
+        Napi::Object entry = Napi::Object::New(env);
+        entry.Set("host", Napi::String::New(env, host));
+        entry.Set("connections", number(counters.connections.load()));
+        entry.Set("denied", number(counters.denied.load()));
+        entry.Set("bytesUp", number(counters.bytesUp.load()));
+        entry.Set("bytesDown", number(counters.bytesDown.load()));
+        hosts.Set(index++, entry);
+    });
+    stats.Set("hosts", hosts);
+    return stats;
+}
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+Napi::Value CreateEgressProxyExport(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "options must be an object").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    Napi::Object options = info[0].As<Napi::Object>();
+    EgressPolicy policy;
+    std::string error;
+    if (!ReadEgressPolicy(options, policy, error)) {
+        Napi::TypeError::New(env, error).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    Napi::Value listen = options.Get("listen");
+    if (!listen.IsUndefined() && !listen.IsObject()) {
+        Napi::TypeError::New(env, "listen must be an object").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    std::string socketPath;
+    uint16_t port = 0;
+    int fd = OpenLoopbackListener(listen.IsObject() ? listen.As<Napi::Object>()
+                                                    : Napi::Object::New(env),
+                                  socketPath, port, error);
+    if (fd < 0) {
+        Napi::Error::New(env, error).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    std::string id = "egress-" + std::to_string(++g_standaloneIds);
+    EgressProxyPtr proxy = CreateEgressProxy(id, policy, error);
+    if (proxy) {
+        proxy->socketPath = socketPath;
+        if (!AttachEgressListener(proxy, fd, 0, error)) {
+            CloseEgressProxy(proxy);
+            proxy = nullptr;
+        }
+    } else {
+        close(fd);
+        if (!socketPath.empty()) unlink(socketPath.c_str());
+    }
+    if (!proxy) {
+        Napi::Error::New(env, error).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("id", Napi::String::New(env, id));
+    result.Set("port", socketPath.empty() ? Napi::Number::New(env, port) : env.Null());
+    result.Set("socketPath",
+               socketPath.empty() ? env.Null() : Napi::String::New(env, socketPath));
+    return result;
+}
+
+Napi::Value GetEgressProxyStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "id must be a string").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    EgressProxyPtr proxy = FindProxy(info[0].As<Napi::String>().Utf8Value());
+    return proxy ? EgressStatsObject(env, *proxy) : env.Null();
+}
+
+Napi::Value CloseEgressProxyExport(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "id must be a string").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    std::string id = info[0].As<Napi::String>().Utf8Value();
+    // Session proxies go with their session.
+    EgressProxyPtr proxy = id.rfind("session:", 0) == 0 ? nullptr : FindProxy(id);
+    if (proxy) CloseEgressProxy(proxy);
+    return Napi::Boolean::New(env, proxy != nullptr);
+}
+
+} // namespace TerminAI
+
+#else // !__linux__
+
+namespace TerminAI {
+
+// ============================================================================
+// Stubs for Windows and macOS
+// ============================================================================
+
+Napi::Value CreateEgressProxyExport(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Error::New(env, "Egress proxies are only available on Linux")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+}
+
+Napi::Value GetEgressProxyStats(const Napi::CallbackInfo& info) {
+    return info.Env().Null();
+}
+
+Napi::Value CloseEgressProxyExport(const Napi::CallbackInfo& info) {
+    return Napi::Boolean::New(info.Env(), false);
+}
+
+} // namespace TerminAI
+
+#endif
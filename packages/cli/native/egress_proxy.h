@@ -0,0 +1,147 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Egress Proxy Header
+ *
+ * Per-sandbox network egress on Linux. A sandbox session created with an
+ * `egress` policy launches every process in its own network namespace,
+ * which has nothing but loopback. Before execve the child binds a
+ * listener on 127.0.0.1:<port> inside that namespace and hands it to the
+ * parent (SCM_RIGHTS); the parent's proxy accepts on it, so the proxy is
+ * the sandbox's only way out. HTTP_PROXY / HTTPS_PROXY point at it.
+ *
+ *   Policy      Tunnels (CONNECT host:port) and plain HTTP requests
+ *               (absolute-form) are checked against a host allowlist:
+ *               "example.com", "*.example.com" (subdomains), "10.0.0.5",
+ *               each optionally ":port", or "*". A tunnel's TLS
+ *               ClientHello is peeked, not read, and its SNI must be
+ *               allowed as well, so an allowed CONNECT cannot front for
+ *               another name. Names that resolve to loopback, private or
+ *               link-local addresses are refused unless allowPrivate is
+ *               set or the entry is that address itself.
+ *   Forwarding  Bytes move socket -> pipe -> socket with splice(), never
+ *               through user space; pipes are pooled across connections.
+ *   Rate        One token bucket per direction per proxy, shared by its
+ *               connections. A direction out of tokens stops reading
+ *               until the bucket refills, which backs the sender off
+ *               through TCP flow control.
+ *   Accounting  Connections, denials and bytes per proxy and per host.
+ *
+ * One service thread runs every proxy on one epoll set. Names are resolved
+ * on the worker pool. A standalone proxy (createEgressProxy) listens on a
+ * host loopback port or Unix socket instead, which is also how it is
+ * tested against local stand-in upstreams.
+ */
+
+#pragma once
+
+#include <napi.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace TerminAI {
+
+struct EgressAllowEntry {
+    /** Lowercase; "" with `wildcard` = any host */
+    std::string host;
+    /** "*.host": subdomains of host, not host itself */
+    bool wildcard = false;
+    /** 0 = any port */
+    uint16_t port = 0;
+    /** host is an IP address literal */
+    bool literal = false;
+};
+
+struct EgressPolicy {
+    std::vector<EgressAllowEntry> allow;
+    /** Bytes per second in each direction (0 = unlimited) */
+    uint64_t bytesPerSec = 0;
+    /** Bucket size (default: one second of bytesPerSec) */
+    uint64_t burstBytes = 0;
+    /** Concurrent connections; more are answered 503 */
+    uint32_t maxConnections = 256;
+    /** Resolved addresses may be loopback, private or link-local */
+    bool allowPrivate = false;
+};
+
+class EgressProxy;
+using EgressProxyPtr = std::shared_ptr<EgressProxy>;
+
+#ifdef __linux__
+
+/**
+ * Parse { allow: String[], rate?: { bytesPerSec, burstBytes? },
+ * maxConnections?, allowPrivate? }.
+ */
+bool ReadEgressPolicy(const Napi::Object& options, EgressPolicy& policy, std::string& error);
+
+/** Register a proxy under `id` with no listeners yet. */
+EgressProxyPtr CreateEgressProxy(const std::string& id, const EgressPolicy& policy,
+                                 std::string& error);
+
+/**
+ * Hand a listening socket to the proxy, which takes ownership of it. With
+ * an `owner` pid the listener is closed when that process exits (the one
+ * launched into the namespace it was bound in); 0 keeps it until the proxy
+ * is closed.
+ */
+bool AttachEgressListener(const EgressProxyPtr& proxy, int fd, int owner, std::string& error);
+
+/** Stop listening, drop every connection and unregister the proxy. */
+void CloseEgressProxy(const EgressProxyPtr& proxy);
+
+/** { id, listeners, connections, active, denied, failed, bytesUp, ... } */
+Napi::Object EgressStatsObject(Napi::Env env, const EgressProxy& proxy);
+
+#endif // __linux__
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+/**
+ * Start a standalone egress proxy on the host (Linux).
+ *
+ * Arguments:
+ *   0: Object
+ *      - allow: String[] - Allowed hosts (see above)
+ *      - rate?: { bytesPerSec: Number, burstBytes?: Number }
+ *      - maxConnections?: Number (default 256)
+ *      - allowPrivate?: Boolean (default false)
+ *      - listen?: { port?: Number } | { socketPath: String } - Loopback
+ *        port (default 0, any free one) or Unix socket to listen on
+ *
+ * Returns: Object - { id, port: Number | null, socketPath: String | null }
+ *   Throws on an invalid policy or if the listener cannot be opened.
+ */
+Napi::Value CreateEgressProxyExport(const Napi::CallbackInfo& info);
+
+/**
+ * Counters of one proxy; sandbox session proxies are "session:<id>".
+ *
+ * Arguments:
+ *   0: String - Proxy id
+ *
+ * Returns: Object | null - { id, listeners, connections, active, denied,
+ *          failed, bytesUp, bytesDown, throttled, spliceCalls, hosts:
+ *          Array<{ host, connections, denied, bytesUp, bytesDown }> }
+ */
+Napi::Value GetEgressProxyStats(const Napi::CallbackInfo& info);
+
+/**
+ * Close a standalone proxy and its connections.
+ *
+ * Arguments:
+ *   0: String - Proxy id
+ *
+ * Returns: Boolean - false for an unknown id or a session's proxy
+ */
+Napi::Value CloseEgressProxyExport(const Napi::CallbackInfo& info);
+
+} // namespace TerminAI
@@ -0,0 +1,546 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Known-Good Hash Allowlist Implementation
+ *
+ * Construction (hash-and-displace, as in CHD/PTHash): keys are grouped by
+ * bucket and buckets are placed largest first. For each bucket, pilots
+ * 0, 1, 2, ... are tried until every key in it lands on a free slot; the
+ * winning pilot is stored. Large buckets are placed while the table is
+ * mostly empty, and the many single-key buckets left at the end only need
+ * one free slot each, so a table with exactly one slot per key (minimal)
+ * still builds in one to two microseconds per key.
+ */
+
+#include "hash_allowlist.h"
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace TerminAI {
+
+namespace {
+
+constexpr char ALLOWLIST_MAGIC[8] = {'T', 'A', 'I', 'A', 'L', 'L', 'O', 'W'};
+constexpr uint32_t ALLOWLIST_VERSION = 1;
+constexpr size_t SECTION_ALIGN = 64;
+
+/** Average keys per bucket: one 4-byte pilot per this many keys. */
+constexpr uint64_t KEYS_PER_BUCKET = 4;
+
+/** Pilots tried per bucket before giving up (only identical keys get here). */
+constexpr uint64_t MAX_PILOT = 0xffffffffull;
+
+struct AllowlistHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerBytes;
+    uint64_t entries;
+    uint64_t buckets;
+    uint64_t pilotsOffset;
+    uint64_t keysOffset;
+    uint64_t fileBytes;
+    /** First 8 bytes of BLAKE3 over everything after the header */
+    uint8_t checksum[8];
+};
+
+static_assert(sizeof(AllowlistHeader) == 64, "header is one cache line");
+
+uint64_t LoadLE64(const uint8_t* p) {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+/** x * n / 2^64: maps a uniform 64-bit value onto [0, n) without a division. */
+inline uint64_t FastRange(uint64_t x, uint64_t n) {
+#ifdef _MSC_VER
+    return __umulh(x, n);
+#else
+    return static_cast<uint64_t>((static_cast<unsigned __int128>(x) * n) >> 64);
+#endif
+}
+
+/** splitmix64 finalizer */
+inline uint64_t Mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x;
+}
+
+inline uint64_t BucketOf(const uint8_t* key, uint64_t buckets) {
+    return FastRange(LoadLE64(key), buckets);
+}
+
+inline uint64_t SlotOf(const uint8_t* key, uint32_t pilot, uint64_t entries) {
+    return FastRange(Mix(LoadLE64(key + 8) ^ Mix(pilot + 0x9e3779b97f4a7c15ull)), entries);
+}
+
+uint64_t AlignUp(uint64_t value) {
+    return (value + SECTION_ALIGN - 1) & ~static_cast<uint64_t>(SECTION_ALIGN - 1);
+}
+
+void Checksum(const uint8_t* data, size_t length, uint8_t out[8]) {
+    Blake3Hasher hasher;
+    hasher.Update(data, length);
+    Blake3Digest digest = hasher.Finalize();
+    std::memcpy(out, digest.bytes, 8);
+}
+
+/** A 32-byte Buffer or a 64-character hex string. */
+bool ParseDigest(const Napi::Value& value, Blake3Digest& out) {
+    if (value.IsBuffer()) {
+        auto bytes = value.As<Napi::Buffer<uint8_t>>();
+        if (bytes.Length() != BLAKE3_OUT_LEN) return false;
+        std::memcpy(out.bytes, bytes.Data(), BLAKE3_OUT_LEN);
+        return true;
+    }
+    return value.IsString() && Blake3Digest::FromHex(value.As<Napi::String>().Utf8Value(), out);
+}
+
+} // namespace
+
+// ============================================================================
+// Table
+// ============================================================================
+
+class HashAllowlist {
+public:
+    MappedFile file;
+    const AllowlistHeader* header = nullptr;
+    const uint32_t* pilots = nullptr;
+    const uint8_t* keys = nullptr;
+    uint64_t entries = 0;
+    uint64_t buckets = 0;
+};
+
+bool AllowlistContains(const HashAllowlist& table, const Blake3Digest& digest) {
+    if (table.entries == 0) return false;
+    uint32_t pilot = table.pilots[BucketOf(digest.bytes, table.buckets)];
+    const uint8_t* key = table.keys + SlotOf(digest.bytes, pilot, table.entries) * BLAKE3_OUT_LEN;
+    return std::memcmp(key, digest.bytes, BLAKE3_OUT_LEN) == 0;
+}
+
+uint64_t AllowlistEntryCount(const HashAllowlist& table) {
+    return table.entries;
+}
+
+std::shared_ptr<const HashAllowlist> OpenHashAllowlist(const std::string& path, bool verify,
+                                                       std::string& error) {
+    auto table = std::make_shared<HashAllowlist>();
+    if (!table->file.Open(path, error)) return nullptr;
+
+    const uint8_t* data = table->file.Data();
+    const uint64_t size = table->file.Size();
+    auto invalid = [&](const char* why) {
+        error = path + ": " + why;
+        return nullptr;
+    };
+    if (size < sizeof(AllowlistHeader) ||
+        std::memcmp(data, ALLOWLIST_MAGIC, sizeof(ALLOWLIST_MAGIC)) != 0) {
+        return invalid("not an allowlist table");
+    }
+
+    const auto* header = reinterpret_cast<const AllowlistHeader*>(data);
+    if (header->version != ALLOWLIST_VERSION) {
+        return invalid("unsupported allowlist table version");
+    }
+    // Each bound is checked before it is used in the next, so nothing overflows.
+    const uint64_t entries = header->entries;
+    const uint64_t buckets = header->buckets;
+    const uint64_t pilots = header->pilotsOffset;
+    const uint64_t keys = header->keysOffset;
+    if (header->headerBytes != sizeof(AllowlistHeader) || header->fileBytes != size ||
+        (entries > 0) != (buckets > 0) || pilots % SECTION_ALIGN != 0 ||
+        keys % SECTION_ALIGN != 0 || pilots < sizeof(AllowlistHeader) || pilots > keys ||
+        keys > size || buckets > (keys - pilots) / sizeof(uint32_t) ||
+        entries != (size - keys) / BLAKE3_OUT_LEN || (size - keys) % BLAKE3_OUT_LEN != 0) {
+        return invalid("corrupt allowlist table header");
+    }
+
+    if (verify) {
+        uint8_t checksum[8];
+        Checksum(data + sizeof(AllowlistHeader), size - sizeof(AllowlistHeader), checksum);
+        if (std::memcmp(checksum, header->checksum, sizeof(checksum)) != 0) {
+            return invalid("allowlist table checksum mismatch");
+        }
+    }
+
+    table->header = header;
+    table->pilots = reinterpret_cast<const uint32_t*>(data + pilots);
+    table->keys = data + keys;
+    table->entries = entries;
+    table->buckets = buckets;
+    return table;
+}
+
+bool BuildHashAllowlist(std::vector<Blake3Digest> keys, const std::string& path,
+                        AllowlistBuildStats& stats, std::string& error) {
+    auto start = std::chrono::steady_clock::now();
+    stats = AllowlistBuildStats();
+
+    auto byBytes = [](const Blake3Digest& a, const Blake3Digest& b) {
+        return std::memcmp(a.bytes, b.bytes, BLAKE3_OUT_LEN) < 0;
+    };
+    std::sort(keys.begin(), keys.end(), byBytes);
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    const uint64_t entries = keys.size();
+    if (entries > UINT32_MAX) {
+        error = "allowlist tables hold at most 2^32 - 1 entries";
+        return false;
+    }
+    const uint64_t buckets = entries == 0 ? 0 : (entries + KEYS_PER_BUCKET - 1) / KEYS_PER_BUCKET;
+
+    // Group keys by bucket (counting sort), then order buckets largest first.
+    std::vector<uint32_t> bucketStart(buckets + 1, 0);
+    for (const Blake3Digest& key : keys) bucketStart[BucketOf(key.bytes, buckets) + 1]++;
+    for (uint64_t b = 0; b < buckets; b++) bucketStart[b + 1] += bucketStart[b];
+    std::vector<uint32_t> members(entries);
+    {
+        std::vector<uint32_t> next(bucketStart);
+        for (uint64_t i = 0; i < entries; i++) {
+            members[next[BucketOf(keys[i].bytes, buckets)]++] = static_cast<uint32_t>(i);
+        }
+    }
+    std::vector<uint32_t> order(buckets);
+    for (uint64_t b = 0; b < buckets; b++) order[b] = static_cast<uint32_t>(b);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return bucketStart[a + 1] - bucketStart[a] > bucketStart[b + 1] - bucketStart[b];
+    });
+
+    std::vector<uint32_t> pilots(buckets, 0);
+    std::vector<uint64_t> taken((entries + 63) / 64, 0);
+    std::vector<uint32_t> slotKey(entries);
+    std::vector<uint64_t> slots;
+    for (uint32_t bucket : order) {
+        const uint32_t first = bucketStart[bucket];
+        const uint32_t count = bucketStart[bucket + 1] - first;
+        if (count == 0) break;
+
+        bool placed = false;
+        for (uint64_t pilot = 0; pilot <= MAX_PILOT && !placed; pilot++) {
+            slots.clear();
+            placed = true;
+            for (uint32_t i = 0; i < count; i++) {
+                uint64_t slot = SlotOf(keys[members[first + i]].bytes,
+                                       static_cast<uint32_t>(pilot), entries);
+                if ((taken[slot / 64] >> (slot % 64)) & 1 ||
+                    std::find(slots.begin(), slots.end(), slot) != slots.end()) {
+                    placed = false;
+                    break;
+                }
+                slots.push_back(slot);
+            }
+            if (placed) pilots[bucket] = static_cast<uint32_t>(pilot);
+        }
+        if (!placed) {
+            error = "cannot place allowlist bucket " + std::to_string(bucket);
+            return false;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            taken[slots[i] / 64] |= 1ull << (slots[i] % 64);
+            slotKey[slots[i]] = members[first + i];
+        }
+    }
+
+    // Lay out the file in memory and checksum it before writing.
+    AllowlistHeader header = {};
+    std::memcpy(header.magic, ALLOWLIST_MAGIC, sizeof(header.magic));
+    header.version = ALLOWLIST_VERSION;
+    header.headerBytes = sizeof(AllowlistHeader);
+    header.entries = entries;
+    header.buckets = buckets;
+    header.pilotsOffset = AlignUp(sizeof(AllowlistHeader));
+    header.keysOffset = AlignUp(header.pilotsOffset + buckets * sizeof(uint32_t));
+    header.fileBytes = header.keysOffset + entries * BLAKE3_OUT_LEN;
+
+    std::vector<uint8_t> image(header.fileBytes, 0);
+    uint8_t* pilotsOut = image.data() + header.pilotsOffset;
+    uint8_t* keysOut = image.data() + header.keysOffset;
+    if (buckets > 0) std::memcpy(pilotsOut, pilots.data(), buckets * sizeof(uint32_t));
+    for (uint64_t slot = 0; slot < entries; slot++) {
+        std::memcpy(keysOut + slot * BLAKE3_OUT_LEN, keys[slotKey[slot]].bytes, BLAKE3_OUT_LEN);
+    }
+    Checksum(image.data() + sizeof(header), image.size() - sizeof(header), header.checksum);
+    std::memcpy(image.data(), &header, sizeof(header));
+
+    // Replaces an existing table; a process that has it mapped keeps the old one.
+    if (!ReplaceFileContents(path, image, error)) return false;
+
+    stats.entries = entries;
+    stats.bytes = header.fileBytes;
+    stats.durationMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+// ============================================================================
+// Active Table
+// ============================================================================
+
+namespace {
+
+class AllowlistStore {
+public:
+    static AllowlistStore& Instance() {
+        static AllowlistStore* store = new AllowlistStore();
+        return *store;
+    }
+
+    std::shared_ptr<const HashAllowlist> Current() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return table_;
+    }
+
+    bool Load(const std::string& path, bool verify, std::string& error) {
+        auto table = OpenHashAllowlist(path, verify, error);
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!table) {
+            lastError_ = error;
+            return false;
+        }
+        table_ = std::move(table);
+        path_ = path;
+        version_++;
+        lastError_.clear();
+        return true;
+    }
+
+    void Unload() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        table_.reset();
+        path_.clear();
+        lastError_.clear();
+    }
+
+    void Record(bool hit) {
+        lookups_.fetch_add(1, std::memory_order_relaxed);
+        if (hit) hits_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    struct Info {
+        bool loaded;
+        std::string path;
+        uint64_t entries;
+        uint64_t bytes;
+        uint64_t version;
+        uint64_t lookups;
+        uint64_t hits;
+        std::string lastError;
+    };
+
+    Info Describe() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return {
+            table_ != nullptr,
+            path_,
+            table_ ? table_->entries : 0,
+            table_ ? table_->file.Size() : 0,
+            version_,
+            lookups_.load(),
+            hits_.load(),
+            lastError_,
+        };
+    }
+
+    uint64_t Version() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return version_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::shared_ptr<const HashAllowlist> table_;
+    std::string path_;
+    std::string lastError_;
+    uint64_t version_ = 0;
+
+    std::atomic<uint64_t> lookups_{0};
+    std::atomic<uint64_t> hits_{0};
+};
+
+} // namespace
+
+std::shared_ptr<const HashAllowlist> CurrentHashAllowlist() {
+    return AllowlistStore::Instance().Current();
+}
+
+bool IsHashAllowlisted(const Blake3Digest& digest) {
+    AllowlistStore& store = AllowlistStore::Instance();
+    auto table = store.Current();
+    if (!table) return false;
+    bool hit = AllowlistContains(*table, digest);
+    store.Record(hit);
+    return hit;
+}
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+namespace {
+
+class BuildAllowlistWorker : public Napi::AsyncWorker {
+public:
+    BuildAllowlistWorker(Napi::Env env, std::vector<Blake3Digest> keys, std::string path)
+        : Napi::AsyncWorker(env),
+          deferred_(Napi::Promise::Deferred::New(env)),
+          keys_(std::move(keys)),
+          path_(std::move(path)) {}
+
+    Napi::Promise Promise() const { return deferred_.Promise(); }
+
+    void Execute() override {
+        std::string error;
+        if (!BuildHashAllowlist(std::move(keys_), path_, stats_, error)) SetError(error);
+    }
+
+    void OnOK() override {
+        Napi::Env env = Env();
+        Napi::Object out = Napi::Object::New(env);
+        out.Set("entries", Napi::Number::New(env, static_cast<double>(stats_.entries)));
+        out.Set("bytes", Napi::Number::New(env, static_cast<double>(stats_.bytes)));
+        out.Set("durationMs", Napi::Number::New(env, stats_.durationMs));
+        deferred_.Resolve(out);
+    }
+
+    void OnError(const Napi::Error& error) override { deferred_.Reject(error.Value()); }
+
+private:
+    Napi::Promise::Deferred deferred_;
+    std::vector<Blake3Digest> keys_;
+    std::string path_;
+    AllowlistBuildStats stats_;
+};
+
+Napi::Value RejectedPromise(Napi::Env env, const std::string& message) {
+    auto deferred = Napi::Promise::Deferred::New(env);
+    deferred.Reject(Napi::TypeError::New(env, message).Value());
+    return deferred.Promise();
+}
+
+Napi::Object LoadResult(Napi::Env env, bool ok, const std::string& error, double loadMs) {
+    auto table = CurrentHashAllowlist();
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("ok", Napi::Boolean::New(env, ok));
+    result.Set("entries", Napi::Number::New(env, table ? static_cast<double>(table->entries) : 0));
+    result.Set("version",
+               Napi::Number::New(env, static_cast<double>(AllowlistStore::Instance().Version())));
+    result.Set("loadMs", Napi::Number::New(env, loadMs));
+    if (!ok) result.Set("error", Napi::String::New(env, error));
+    return result;
+}
+
+} // namespace
+
+Napi::Value BuildHashAllowlistExport(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    const char* usage =
+        "buildHashAllowlist expects an array of digests or a Buffer of 32-byte digests, "
+        "and an output path";
+
+    if (info.Length() < 2 || !info[1].IsString() || info[1].As<Napi::String>().Utf8Value().empty()) {
+        return RejectedPromise(env, usage);
+    }
+
+    std::vector<Blake3Digest> keys;
+    if (info[0].IsBuffer()) {
+        auto bytes = info[0].As<Napi::Buffer<uint8_t>>();
+        if (bytes.Length() % BLAKE3_OUT_LEN != 0) return RejectedPromise(env, usage);
+        keys.resize(bytes.Length() / BLAKE3_OUT_LEN);
+        if (!keys.empty()) std::memcpy(keys.data(), bytes.Data(), bytes.Length());
+    } else if (info[0].IsArray()) {
+        Napi::Array list = info[0].As<Napi::Array>();
+        keys.resize(list.Length());
+        for (uint32_t i = 0; i < list.Length(); i++) {
+            if (!ParseDigest(list.Get(i), keys[i])) {
+                return RejectedPromise(env, "digest " + std::to_string(i) +
+                                                " is not 64 hex characters or 32 bytes");
+            }
+        }
+    } else {
+        return RejectedPromise(env, usage);
+    }
+
+    auto* worker = new BuildAllowlistWorker(env, std::move(keys),
+                                            info[1].As<Napi::String>().Utf8Value());
+    Napi::Promise promise = worker->Promise();
+    worker->Queue();
+    return promise;
+}
+
+Napi::Value LoadHashAllowlist(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        return LoadResult(env, false, "Invalid arguments", 0);
+    }
+
+    bool verify = false;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Value value = info[1].As<Napi::Object>().Get("verify");
+        verify = value.IsBoolean() && value.As<Napi::Boolean>().Value();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::string error;
+    bool ok = AllowlistStore::Instance().Load(info[0].As<Napi::String>().Utf8Value(), verify, error);
+    double loadMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    return LoadResult(env, ok, error, loadMs);
+}
+
+Napi::Value IsHashAllowlistedExport(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    Blake3Digest digest;
+    if (info.Length() < 1 || !ParseDigest(info[0], digest)) {
+        Napi::TypeError::New(env, "isHashAllowlisted expects a 64-character hex digest or 32 bytes")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    return Napi::Boolean::New(env, IsHashAllowlisted(digest));
+}
+
+Napi::Value GetHashAllowlistInfo(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    AllowlistStore::Info state = AllowlistStore::Instance().Describe();
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("loaded", Napi::Boolean::New(env, state.loaded));
+    result.Set("path", state.path.empty() ? env.Null() : Napi::String::New(env, state.path));
+    result.Set("entries", Napi::Number::New(env, static_cast<double>(state.entries)));
+    result.Set("bytes", Napi::Number::New(env, static_cast<double>(state.bytes)));
+    result.Set("version", Napi::Number::New(env, static_cast<double>(state.version)));
+    result.Set("lookups", Napi::Number::New(env, static_cast<double>(state.lookups)));
+    result.Set("hits", Napi::Number::New(env, static_cast<double>(state.hits)));
+    result.Set("hitRate", Napi::Number::New(env, state.lookups == 0
+                                                     ? 0
+                                                     : static_cast<double>(state.hits) /
+                                                           static_cast<double>(state.lookups)));
+    result.Set("lastError",
+               state.lastError.empty() ? env.Null() : Napi::String::New(env, state.lastError));
+    return result;
+}
+
+Napi::Value UnloadHashAllowlist(const Napi::CallbackInfo& info) {
+    AllowlistStore::Instance().Unload();
+    return info.Env().Undefined();
+}
+
+} // namespace TerminAI
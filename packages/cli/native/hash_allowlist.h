@@ -0,0 +1,147 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Known-Good Hash Allowlist Header
+ *
+ * A table of trusted BLAKE3 content hashes (package-manager shims, our own
+ * tooling) checked before content is handed to a scan engine. Tables are
+ * built offline into a file that is mapped read-only and used in place:
+ * loading one costs a header check, whatever its size.
+ *
+ * Lookups go through a minimal perfect hash (hash-and-displace): a key's
+ * first 8 bytes pick a bucket, the bucket's 32-bit pilot picks the key's
+ * slot, and the slot holds the one key that can live there. A lookup reads
+ * one pilot and one 32-byte key, i.e. two cache misses, and a hash that is
+ * not in the table still compares unequal at its slot. BLAKE3 output is
+ * already uniform, so key bytes are used directly as hash values.
+ *
+ * File layout (little-endian, sections 64-byte aligned):
+ *
+ *   header   64 bytes: magic "TAIALLOW", version, entry and bucket counts,
+ *            section offsets, file size, BLAKE3 checksum of the sections
+ *   pilots   uint32 per bucket (about one bucket per four keys)
+ *   keys     32-byte digests in slot order, one per entry
+ *
+ * One table is active per process. Loading another swaps it in atomically:
+ * a lookup sees the old table or the new one, and the old mapping is
+ * released when its last lookup finishes.
+ */
+
+#pragma once
+
+#include <napi.h>
+#include "blake3.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace TerminAI {
+
+// ============================================================================
+// Tables
+// ============================================================================
+
+class HashAllowlist;
+
+struct AllowlistBuildStats {
+    /** Distinct hashes written */
+    uint64_t entries = 0;
+    uint64_t bytes = 0;
+    double durationMs = 0;
+};
+
+/**
+ * Build a table from `keys` (duplicates are dropped) and write it to `path`
+ * through a temporary file and a rename, so a loaded table is never
+ * modified underneath its mapping.
+ *
+ * @return false with a message on I/O failure
+ */
+bool BuildHashAllowlist(std::vector<Blake3Digest> keys, const std::string& path,
+                        AllowlistBuildStats& stats, std::string& error);
+
+/**
+ * Map a table. The header and section bounds are always checked; `verify`
+ * also checks the checksum, which reads the whole file.
+ *
+ * @return nullptr with a message if the file is not a valid table
+ */
+std::shared_ptr<const HashAllowlist> OpenHashAllowlist(const std::string& path, bool verify,
+                                                       std::string& error);
+
+/** Membership in one table. Safe to call from any thread. */
+bool AllowlistContains(const HashAllowlist& table, const Blake3Digest& digest);
+
+/** Entries in one table. */
+uint64_t AllowlistEntryCount(const HashAllowlist& table);
+
+// ============================================================================
+// Active Table
+// ============================================================================
+
+/** The active table, or nullptr. Hold it to run many lookups on one table. */
+std::shared_ptr<const HashAllowlist> CurrentHashAllowlist();
+
+/**
+ * Look `digest` up in the active table and count the lookup toward the hit
+ * rate. False when no table is loaded.
+ */
+bool IsHashAllowlisted(const Blake3Digest& digest);
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+/**
+ * Build a table file off the main thread.
+ *
+ * Arguments:
+ *   0: Array<String | Buffer> | Buffer - hex digests or 32-byte digests, or
+ *      one Buffer of digests back to back
+ *   1: String - Output path
+ *
+ * Returns: Promise<Object> - { entries, bytes, durationMs }
+ */
+Napi::Value BuildHashAllowlistExport(const Napi::CallbackInfo& info);
+
+/**
+ * Load a table file and make it the active table. The previous table stays
+ * active if the file is not a valid table.
+ *
+ * Arguments:
+ *   0: String - Table path
+ *   1: Object (optional) - { verify?: boolean } checksum the whole file
+ *      (default false)
+ *
+ * Returns: Object - { ok, entries, version, loadMs, error? }
+ */
+Napi::Value LoadHashAllowlist(const Napi::CallbackInfo& info);
+
+/**
+ * Check a content hash against the active table.
+ *
+ * Arguments:
+ *   0: String | Buffer - 64-character hex digest or 32-byte digest
+ *
+ * Returns: Boolean (false when no table is loaded)
+ */
+Napi::Value IsHashAllowlistedExport(const Napi::CallbackInfo& info);
+
+/**
+ * Describe the active table and lookup counters.
+ *
+ * Returns: Object - { loaded, path, entries, bytes, version, lookups, hits,
+ *          hitRate, lastError }
+ */
+Napi::Value GetHashAllowlistInfo(const Napi::CallbackInfo& info);
+
+/** Deactivate the active table. */
+Napi::Value UnloadHashAllowlist(const Napi::CallbackInfo& info);
+
+} // namespace TerminAI
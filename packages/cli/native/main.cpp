@@ -10,21 +10,507 @@
  * The module provides Windows-specific functionality:
  * - AppContainer sandbox creation (Tasks 42, 42b)
  * - AMSI malware scanning (Task 43)
+ *
+ * and cross-platform functionality:
+ * - Content hashing and workspace snapshots (BLAKE3)
+ * - Bulk workspace staging and incremental sync (io_uring on Linux)
+ * - Compiled command policy for broker execute requests
+ * - Sandbox resource limits, usage sampling and process-tree teardown
+ *   (cgroup v2 / Job Objects)
+ * - Pseudo-terminal sessions for sandboxed or host processes (Linux / ConPTY)
+ * - Host process spawning for broker execute requests (posix_spawn / Job
+ *   Objects)
+ * - Background provider initialization (module load stays near-free)
+ * - Cached, check-first access grants (DACL ACEs / POSIX ACLs)
+ * - Deadlines and AbortSignal cancellation for long-running operations
+ * - Priority-aware scheduling of pooled work (interactive / normal / bulk)
+ * - Tiered content scanning (allowlist, verdict cache, pre-classifier)
+ * - Single-pass de-obfuscation of PowerShell and shell scripts
+ *
+ * and Linux-specific functionality (stubs elsewhere):
+ * - User/mount namespace sandbox with copy-on-write overlay workspaces
+ * - Cached seccomp-BPF filters for sandbox capability profiles
+ * - Per-sandbox egress proxy (allowlists, rate limits, splice forwarding)
  */
 
 #include <napi.h>
 
-#ifdef _WIN32
+#include "access_grants.h"
 #include "appcontainer_manager.h"
 #include "amsi_scanner.h"
-#endif
+#include "archive_scanner.h"
+#include "call_trace.h"
+#include "cancellation.h"
+#include "content_hasher.h"
+#include "egress_proxy.h"
+#include "hash_allowlist.h"
+#include "overlay_workspace.h"
+#include "policy_engine.h"
+#include "process_spawner.h"
+#include "provider_init.h"
+#include "pty_session.h"
+#include "resource_governor.h"
+#include "rule_database.h"
+#include "sandbox_linux.h"
+#include "sandbox_registry.h"
+#include "scan_pipeline.h"
+#include "scanned_write.h"
+#include "script_normalizer.h"
+#include "seccomp_compiler.h"
+#include "work_scheduler.h"
+#include "workspace_stage.h"
 
 // Module initialization
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
-#ifdef _WIN32
-    // Initialize AMSI on module load
-    TerminAI::InitializeAmsi();
+    // ========================================================================
+    // Content Hashing (all platforms)
+    // ========================================================================
+
+    exports.Set(
+        Napi::String::New(env, "hashBuffer"),
+        Napi::Function::New(env, TerminAI::HashBuffer)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "hashFile"),
+        Napi::Function::New(env, TerminAI::HashFile)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "snapshotDirectory"),
+        Napi::Function::New(env, TerminAI::SnapshotDirectoryExport)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "clearSnapshotCache"),
+        Napi::Function::New(env, TerminAI::ClearSnapshotCacheExport)
+    );
+
+    // ========================================================================
+    // Workspace Staging (all platforms)
+    // ========================================================================
+
+    exports.Set(
+        Napi::String::New(env, "stageWorkspace"),
+        Napi::Function::New(env, TerminAI::StageWorkspaceExport)
+    );
+
+    // ========================================================================
+    // Command Policy (all platforms)
+    // ========================================================================
+
+    exports.Set(
+        Napi::String::New(env, "loadCommandPolicy"),
+        Napi::Function::New(env, TerminAI::LoadCommandPolicy)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "compileCommandPolicy"),
+        Napi::Function::New(env, TerminAI::CompileCommandPolicy)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "evaluateCommandPolicy"),
+        Napi::Function::New(env, TerminAI::EvaluateCommandPolicy)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "getCommandPolicyInfo"),
+        Napi::Function::New(env, TerminAI::GetCommandPolicyInfo)
+    );
 
+    exports.Set(
+        Napi::String::New(env, "unloadCommandPolicy"),
+        Napi::Function::New(env, TerminAI::UnloadCommandPolicy)
+    );
+
+    // ========================================================================
+    // Resource Governance (Linux cgroup v2, Windows Job Objects)
+    // ========================================================================
+
+    exports.Set(
+        Napi::String::New(env, "sampleSandboxResources"),
+        Napi::Function::New(env, TerminAI::SampleSandboxResources)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "startResourceSampler"),
+        Napi::Function::New(env, TerminAI::StartResourceSampler)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "stopResourceSampler"),
+        Napi::Function::New(env, TerminAI::StopResourceSampler)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "releaseSandboxResources"),
+        Napi::Function::New(env, TerminAI::ReleaseSandboxResources)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "attachProcessTree"),
+        Napi::Function::New(env, TerminAI::AttachProcessTree)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "killProcessTree"),
+        Napi::Function::New(env, TerminAI::KillProcessTree)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "setResourceGovernorRoot"),
+        Napi::Function::New(env, TerminAI::SetResourceGovernorRoot)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "getResourceGovernorSupport"),
+        Napi::Function::New(env, TerminAI::GetResourceGovernorSupport)
+    );
+
+    // ========================================================================
+    // Pseudo-Terminal Sessions (Linux, Windows ConPTY)
+    // ========================================================================
+
+    exports.Set(
+        Napi::String::New(env, "createPty"),
+        Napi::Function::New(env, TerminAI::CreatePty)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "writePty"),
+        Napi::Function::New(env, TerminAI::WritePty)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "resizePty"),
+        Napi::Function::New(env, TerminAI::ResizePty)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "closePty"),
+        Napi::Function::New(env, TerminAI::ClosePty)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "getPtyStats"),
+        Napi::Function::New(env, TerminAI::GetPtyStats)
+    );
+
+    // ========================================================================
+    // Host Process Spawning (Linux, Windows)
+    // ========================================================================
+
+    exports.Set(
+        Napi::String::New(env, "spawnProcess"),
+        Napi::Function::New(env, TerminAI::SpawnProcess)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "setSpawnEnvironment"),
+        Napi::Function::New(env, TerminAI::SetSpawnEnvironment)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "getSpawnStats"),
+        Napi::Function::New(env, TerminAI::GetSpawnStats)
+    );
+
+    // ========================================================================
+    // Linux Sandbox and Overlay Workspaces (stubs on other platforms)
+    // ========================================================================
+
+    exports.Set(
+        Napi::String::New(env, "createLinuxSandbox"),
+        Napi::Function::New(env, TerminAI::CreateLinuxSandbox)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "waitLinuxSandbox"),
+        Napi::Function::New(env, TerminAI::WaitLinuxSandbox)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "getLinuxSandboxSupport"),
+        Napi::Function::New(env, TerminAI::GetLinuxSandboxSupport)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "createOverlayWorkspace"),
+        Napi::Function::New(env, TerminAI::CreateOverlayWorkspace)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "diffOverlayWorkspace"),
+        Napi::Function::New(env, TerminAI::DiffOverlayWorkspace)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "commitOverlayWorkspace"),
+        Napi::Function::New(env, TerminAI::CommitOverlayWorkspace)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "discardOverlayWorkspace"),
+        Napi::Function::New(env, TerminAI::DiscardOverlayWorkspace)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "compileSeccompFilter"),
+        Napi::Function::New(env, TerminAI::CompileSeccompFilter)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "setSeccompCacheDirectory"),
+        Napi::Function::New(env, TerminAI::SetSeccompCacheDirectory)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "clearSeccompCache"),
+        Napi::Function::New(env, TerminAI::ClearSeccompCache)
+    );
+
+    // ========================================================================
+    // Sandbox Sessions (Linux namespaces, Windows AppContainer profiles)
+    // ========================================================================
+
+    exports.Set(
+        Napi::String::New(env, "createSandboxSession"),
+        Napi::Function::New(env, TerminAI::CreateSandboxSession)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "launchInSandboxSession"),
+        Napi::Function::New(env, TerminAI::LaunchInSandboxSession)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "getSandboxSession"),
+        Napi::Function::New(env, TerminAI::GetSandboxSession)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "listSandboxSessions"),
+        Napi::Function::New(env, TerminAI::ListSandboxSessions)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "destroySandboxSession"),
+        Napi::Function::New(env, TerminAI::DestroySandboxSession)
+    );
+
+    // ========================================================================
+    // Egress Proxy (Linux; stubs on other platforms)
+    // ========================================================================
+
+    exports.Set(
+        Napi::String::New(env, "createEgressProxy"),
+        Napi::Function::New(env, TerminAI::CreateEgressProxyExport)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "getEgressProxyStats"),
+        Napi::Function::New(env, TerminAI::GetEgressProxyStats)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "closeEgressProxy"),
+        Napi::Function::New(env, TerminAI::CloseEgressProxyExport)
+    );
+
+    // ========================================================================
+    // Access Grants (Windows DACLs, Linux POSIX ACLs)
+    // ========================================================================
+
+    exports.Set(
+        Napi::String::New(env, "grantPathAccess"),
+        Napi::Function::New(env, TerminAI::GrantPathAccess)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "checkPathAccess"),
+        Napi::Function::New(env, TerminAI::CheckPathAccess)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "clearAccessGrantCache"),
+        Napi::Function::New(env, TerminAI::ClearAccessGrantCache)
+    );
+
+    // ========================================================================
+    // Deadlines and Cancellation (all platforms)
+    // ========================================================================
+
+    exports.Set(
+        Napi::String::New(env, "getCancellationStats"),
+        Napi::Function::New(env, TerminAI::GetCancellationStats)
+    );
+
+    // ========================================================================
+    // Work Scheduling (all platforms)
+    // ========================================================================
+
+    exports.Set(
+        Napi::String::New(env, "configureScheduler"),
+        Napi::Function::New(env, TerminAI::ConfigureScheduler)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "getSchedulerStats"),
+        Napi::Function::New(env, TerminAI::GetSchedulerStats)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "resetSchedulerStats"),
+        Napi::Function::New(env, TerminAI::ResetSchedulerStats)
+    );
+
+    // ========================================================================
+    // Archive Scanning and Scanned Writes (all platforms; AMSI or the
+    // portable engine)
+    // ========================================================================
+
+    exports.Set(
+        Napi::String::New(env, "scanArchive"),
+        Napi::Function::New(env, TerminAI::ScanArchive)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "writeFileScanned"),
+        Napi::Function::New(env, TerminAI::WriteFileScanned)
+    );
+
+    // ========================================================================
+    // Known-Good Hash Allowlist (all platforms)
+    // ========================================================================
+
+    exports.Set(
+        Napi::String::New(env, "buildHashAllowlist"),
+        Napi::Function::New(env, TerminAI::BuildHashAllowlistExport)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "loadHashAllowlist"),
+        Napi::Function::New(env, TerminAI::LoadHashAllowlist)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "isHashAllowlisted"),
+        Napi::Function::New(env, TerminAI::IsHashAllowlistedExport)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "getHashAllowlistInfo"),
+        Napi::Function::New(env, TerminAI::GetHashAllowlistInfo)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "unloadHashAllowlist"),
+        Napi::Function::New(env, TerminAI::UnloadHashAllowlist)
+    );
+
+    // ========================================================================
+    // Precompiled Rule Database (all platforms)
+    // ========================================================================
+
+    exports.Set(
+        Napi::String::New(env, "compileRuleDatabase"),
+        Napi::Function::New(env, TerminAI::CompileRuleDatabaseExport)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "loadRuleDatabase"),
+        Napi::Function::New(env, TerminAI::LoadRuleDatabase)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "getRuleDatabaseInfo"),
+        Napi::Function::New(env, TerminAI::GetRuleDatabaseInfo)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "unloadRuleDatabase"),
+        Napi::Function::New(env, TerminAI::UnloadRuleDatabase)
+    );
+
+    // ========================================================================
+    // Tiered Scan Pipeline (all platforms)
+    // ========================================================================
+
+    exports.Set(
+        Napi::String::New(env, "scanContent"),
+        Napi::Function::New(env, TerminAI::ScanContent)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "configureScanPipeline"),
+        Napi::Function::New(env, TerminAI::ConfigureScanPipelineExport)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "getScanPipelineStats"),
+        Napi::Function::New(env, TerminAI::GetScanPipelineStats)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "resetScanPipelineStats"),
+        Napi::Function::New(env, TerminAI::ResetScanPipelineStats)
+    );
+
+    // ========================================================================
+    // Script Normalization (all platforms)
+    // ========================================================================
+
+    exports.Set(
+        Napi::String::New(env, "normalizeScript"),
+        Napi::Function::New(env, TerminAI::NormalizeScriptExport)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "getScriptNormalizerStats"),
+        Napi::Function::New(env, TerminAI::GetScriptNormalizerStats)
+    );
+
+    // ========================================================================
+    // Background Provider Initialization (all platforms)
+    // ========================================================================
+
+    exports.Set(
+        Napi::String::New(env, "warmUpNative"),
+        Napi::Function::New(env, TerminAI::WarmUpNative)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "getNativeReadiness"),
+        Napi::Function::New(env, TerminAI::GetNativeReadiness)
+    );
+
+    // ========================================================================
+    // Call Tracing (all platforms)
+    // ========================================================================
+
+    exports.Set(
+        Napi::String::New(env, "startNativeTrace"),
+        Napi::Function::New(env, TerminAI::StartNativeTrace)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "stopNativeTrace"),
+        Napi::Function::New(env, TerminAI::StopNativeTrace)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "readNativeTrace"),
+        Napi::Function::New(env, TerminAI::ReadNativeTrace)
+    );
+
+    // A getter, so loading the module does not initialize AMSI
+    exports.DefineProperty(
+        Napi::PropertyDescriptor::Accessor<TerminAI::IsAmsiAvailableGetter>(
+            "isAmsiAvailable", napi_enumerable)
+    );
+
+#ifdef _WIN32
     // ========================================================================
     // Task 42: AppContainer Sandbox
     // ========================================================================
@@ -67,20 +553,35 @@ Napi::Object Init(Napi::Env env, Napi::Object exports) {
         Napi::Boolean::New(env, true)
     );
 
+#else
+    // Non-Windows: Export stubs and platform info
     exports.Set(
-        Napi::String::New(env, "isAmsiAvailable"),
-        Napi::Boolean::New(env, TerminAI::IsAmsiInitialized())
+        Napi::String::New(env, "createAppContainerSandbox"),
+        Napi::Function::New(env, TerminAI::CreateAppContainerSandbox)
     );
 
-#else
-    // Non-Windows: Export stubs and platform info
     exports.Set(
-        Napi::String::New(env, "isWindows"),
-        Napi::Boolean::New(env, false)
+        Napi::String::New(env, "getAppContainerSid"),
+        Napi::Function::New(env, TerminAI::GetAppContainerSid)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "deleteAppContainerProfile"),
+        Napi::Function::New(env, TerminAI::DeleteAppContainerProfile)
     );
 
     exports.Set(
-        Napi::String::New(env, "isAmsiAvailable"),
+        Napi::String::New(env, "amsiScanBuffer"),
+        Napi::Function::New(env, TerminAI::AmsiScanBuffer)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "amsiScanFile"),
+        Napi::Function::New(env, TerminAI::AmsiScanFile)
+    );
+
+    exports.Set(
+        Napi::String::New(env, "isWindows"),
         Napi::Boolean::New(env, false)
     );
 #endif
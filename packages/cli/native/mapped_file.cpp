@@ -0,0 +1,126 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Mapped File Implementation
+ */
+
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#include "appcontainer_manager.h"
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#endif
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+namespace TerminAI {
+
+#ifdef _WIN32
+
+MappedFile::~MappedFile() {
+    if (data_ != nullptr) UnmapViewOfFile(data_);
+    if (mapping_ != nullptr) CloseHandle(mapping_);
+    if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+}
+
+bool MappedFile::Open(const std::string& path, std::string& error) {
+    file_ = CreateFileW(Utf8ToWide(path).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                        nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE) {
+        error = "open " + path + ": error " + std::to_string(GetLastError());
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file_, &size)) {
+        error = "stat " + path + ": error " + std::to_string(GetLastError());
+        return false;
+    }
+    size_ = static_cast<size_t>(size.QuadPart);
+    if (size_ == 0) return true;
+    mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_ != nullptr) data_ = MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+    if (data_ == nullptr) {
+        error = "map " + path + ": error " + std::to_string(GetLastError());
+        return false;
+    }
+    return true;
+}
+
+#else
+
+MappedFile::~MappedFile() {
+    if (data_ != nullptr) munmap(data_, size_);
+}
+
+bool MappedFile::Open(const std::string& path, std::string& error) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        error = "open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        error = "open " + path + ": not a regular file";
+        close(fd);
+        return false;
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ > 0) {
+        void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            error = "mmap " + path + ": " + std::strerror(errno);
+            close(fd);
+            return false;
+        }
+        data_ = data;
+    }
+    close(fd);
+    return true;
+}
+
+#endif
+
+bool ReplaceFileContents(const std::string& path, const std::vector<uint8_t>& contents,
+                         std::string& error) {
+    char suffix[32];
+    std::snprintf(suffix, sizeof(suffix), ".%llx.tmp",
+                  static_cast<unsigned long long>(
+                      std::chrono::steady_clock::now().time_since_epoch().count()));
+    const std::filesystem::path target = std::filesystem::u8path(path);
+    const std::filesystem::path temp = std::filesystem::u8path(path + suffix);
+    std::error_code ec;
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(contents.data()),
+                  static_cast<std::streamsize>(contents.size()));
+        out.close();
+        if (!out) {
+            std::filesystem::remove(temp, ec);
+            error = "cannot write " + path + suffix;
+            return false;
+        }
+    }
+    std::filesystem::rename(temp, target, ec);
+    if (ec) {
+        std::filesystem::remove(temp, ec);
+        error = "cannot replace " + path + ": " + ec.message();
+        return false;
+    }
+    return true;
+}
+
+} // namespace TerminAI
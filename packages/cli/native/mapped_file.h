@@ -0,0 +1,69 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Mapped File Header
+ *
+ * Read-only mapping of a whole file (mmap on POSIX, MapViewOfFile on
+ * Windows). Pages come straight from the page cache, so several processes
+ * mapping the same file share its memory.
+ *
+ * A mapping stays valid when the file is replaced by a rename, which is how
+ * every writer in this module updates mapped files. Truncating a mapped
+ * file in place is not supported (reads past the new end fault).
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+namespace TerminAI {
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * Map `path`. An empty file maps to Data() == nullptr, Size() == 0.
+     *
+     * @return false with a message if the file cannot be opened or mapped,
+     *         or (on POSIX) is not a regular file
+     */
+    bool Open(const std::string& path, std::string& error);
+
+    const uint8_t* Data() const { return static_cast<const uint8_t*>(data_); }
+    size_t Size() const { return size_; }
+
+private:
+    void* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+#endif
+};
+
+/**
+ * Create or replace `path` with `contents` through a temporary file in the
+ * same directory and a rename, so a process that has the old file mapped
+ * keeps reading the old contents.
+ *
+ * @return false with a message on I/O failure (the temporary file is removed)
+ */
+bool ReplaceFileContents(const std::string& path, const std::vector<uint8_t>& contents,
+                         std::string& error);
+
+} // namespace TerminAI
@@ -0,0 +1,662 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Overlay Workspace Implementation
+ */
+
+#include "overlay_workspace.h"
+#include "sandbox_linux.h"
+#include "worker_pool.h"
+
+#ifdef __linux__
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <sys/xattr.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <unordered_map>
+
+namespace TerminAI {
+
+namespace {
+
+// ============================================================================
+// Overlay Registry
+// ============================================================================
+
+struct OverlayRecord {
+    OverlayInfo info;
+    std::vector<pid_t> processes;
+};
+
+std::mutex g_overlayMutex;
+std::unordered_map<std::string, OverlayRecord> g_overlays;
+
+std::string NewOverlayId() {
+    static std::mutex mutex;
+    static std::mt19937_64 rng{std::random_device{}()};
+    std::lock_guard<std::mutex> lock(mutex);
+
+    static const char* hex = "0123456789abcdef";
+    uint64_t value = rng();
+    std::string id(16, '0');
+    for (int i = 15; i >= 0; i--, value >>= 4) id[i] = hex[value & 0xf];
+    return id;
+}
+
+bool HasRunningProcess(OverlayRecord& record) {
+    auto& pids = record.processes;
+    pids.erase(std::remove_if(pids.begin(), pids.end(),
+                              [](pid_t pid) { return !IsLinuxSandboxRunning(pid); }),
+               pids.end());
+    return !pids.empty();
+}
+
+// ============================================================================
+// Filesystem Helpers
+// ============================================================================
+
+std::string JoinPath(const std::string& dir, const std::string& name) {
+    return dir.empty() ? name : dir + "/" + name;
+}
+
+bool ListDirectory(const std::string& path, std::vector<std::string>& names) {
+    DIR* dir = opendir(path.c_str());
+    if (!dir) return false;
+    while (struct dirent* entry = readdir(dir)) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+        names.emplace_back(entry->d_name);
+    }
+    closedir(dir);
+    std::sort(names.begin(), names.end());
+    return true;
+}
+
+bool HasXattrValue(const std::string& path, const char* name, const char* value) {
+    char buffer[8];
+    ssize_t n = lgetxattr(path.c_str(), name, buffer, sizeof(buffer));
+    return n == static_cast<ssize_t>(strlen(value)) && memcmp(buffer, value, n) == 0;
+}
+
+bool IsWhiteout(const std::string& path, const struct stat& st) {
+    if (S_ISCHR(st.st_mode) && st.st_rdev == makedev(0, 0)) return true;
+    // Kernel >= 6.7 may use xattr whiteouts in user namespaces.
+    return S_ISREG(st.st_mode) && st.st_size == 0 &&
+           lgetxattr(path.c_str(), "user.overlay.whiteout", nullptr, 0) >= 0;
+}
+
+bool IsOpaque(const std::string& path) {
+    return HasXattrValue(path, "user.overlay.opaque", "y");
+}
+
+/**
+ * rm -rf that also copes with overlayfs's mode-000 work/work directory.
+ */
+bool RemoveTree(const std::string& path) {
+    struct stat st;
+    if (lstat(path.c_str(), &st) != 0) return errno == ENOENT;
+    if (!S_ISDIR(st.st_mode)) return unlink(path.c_str()) == 0;
+
+    chmod(path.c_str(), 0700);
+    std::vector<std::string> names;
+    ListDirectory(path, names);
+    bool ok = true;
+    for (const auto& name : names) ok &= RemoveTree(path + "/" + name);
+    return rmdir(path.c_str()) == 0 && ok;
+}
+
+/** Copy a regular file via a temporary name, then rename into place. */
+bool CopyFileAtomic(const std::string& from, const std::string& to, mode_t mode,
+                    std::string& error) {
+    std::string temp = to + ".terminai-commit";
+    int in = open(from.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in < 0) {
+        error = "cannot open " + from + ": " + strerror(errno);
+        return false;
+    }
+    int out = open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, mode & 07777);
+    if (out < 0) {
+        error = "cannot create " + temp + ": " + strerror(errno);
+        close(in);
+        return false;
+    }
+
+    bool ok = true;
+    for (;;) {
+        ssize_t n = copy_file_range(in, nullptr, out, nullptr, 1 << 30, 0);
+        if (n == 0) break;
+        if (n > 0) continue;
+        if (errno != EXDEV && errno != ENOSYS && errno != EINVAL) {
+            ok = false;
+            break;
+        }
+        // Fallback: plain read/write loop.
+        char buffer[1 << 16];
+        ssize_t r;
+        while ((r = read(in, buffer, sizeof(buffer))) > 0) {
+            if (write(out, buffer, r) != r) {
+                ok = false;
+                break;
+            }
+        }
+        if (r < 0) ok = false;
+        break;
+    }
+
+    close(in);
+    ok = close(out) == 0 && ok;
+    if (!ok || rename(temp.c_str(), to.c_str()) != 0) {
+        error = "cannot write " + to + ": " + strerror(errno);
+        unlink(temp.c_str());
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// Diff / Apply Walks
+// ============================================================================
+
+void DiffDirectory(const std::string& upperDir, const std::string& lowerDir, const std::string& rel,
+                   bool lowerExists, std::vector<OverlayChange>& changes, CancelToken* cancel) {
+    std::vector<std::string> names;
+    if (!ListDirectory(upperDir, names)) return;
+
+    for (const auto& name : names) {
+        if (IsStopped(cancel)) return;
+
+        std::string upperPath = upperDir + "/" + name;
+        std::string lowerPath = lowerDir + "/" + name;
+        std::string relPath = JoinPath(rel, name);
+
+        struct stat upperSt, lowerSt;
+        if (lstat(upperPath.c_str(), &upperSt) != 0) continue;
+        bool inLower = lowerExists && lstat(lowerPath.c_str(), &lowerSt) == 0;
+
+        OverlayChange change;
+        change.path = relPath;
+
+        if (IsWhiteout(upperPath, upperSt)) {
+            if (!inLower) continue;
+            change.kind = OverlayChangeKind::Deleted;
+            change.directory = S_ISDIR(lowerSt.st_mode);
+            changes.push_back(std::move(change));
+        } else if (S_ISDIR(upperSt.st_mode)) {
+            bool merged = inLower && S_ISDIR(lowerSt.st_mode) && !IsOpaque(upperPath);
+            if (!merged) {
+                change.kind = inLower ? OverlayChangeKind::Replaced : OverlayChangeKind::Added;
+                change.directory = true;
+                changes.push_back(std::move(change));
+            }
+            DiffDirectory(upperPath, lowerPath, relPath, merged, changes, cancel);
+        } else {
+            change.kind = inLower ? OverlayChangeKind::Modified : OverlayChangeKind::Added;
+            change.size = S_ISREG(upperSt.st_mode) ? static_cast<uint64_t>(upperSt.st_size) : 0;
+            changes.push_back(std::move(change));
+        }
+    }
+}
+
+bool ApplyDirectory(const std::string& upperDir, const std::string& lowerDir,
+                    OverlayCommitResult& result, std::string& error, CancelToken* cancel) {
+    // Names are collected up front because entries are renamed out of upperDir.
+    std::vector<std::string> names;
+    if (!ListDirectory(upperDir, names)) {
+        error = "cannot read " + upperDir + ": " + strerror(errno);
+        return false;
+    }
+
+    for (const auto& name : names) {
+        if (IsStopped(cancel)) {
+            error = CancelReasonMessage(cancel->Outcome());
+            return false;
+        }
+
+        std::string upperPath = upperDir + "/" + name;
+        std::string lowerPath = lowerDir + "/" + name;
+
+        struct stat upperSt, lowerSt;
+        if (lstat(upperPath.c_str(), &upperSt) != 0) continue;
+        bool inLower = lstat(lowerPath.c_str(), &lowerSt) == 0;
+
+        if (IsWhiteout(upperPath, upperSt)) {
+            if (inLower) {
+                if (!RemoveTree(lowerPath)) {
+                    error = "cannot remove " + lowerPath + ": " + strerror(errno);
+                    return false;
+                }
+                result.removed++;
+            }
+            continue;
+        }
+
+        if (S_ISDIR(upperSt.st_mode)) {
+            if (inLower && (!S_ISDIR(lowerSt.st_mode) || IsOpaque(upperPath))) {
+                RemoveTree(lowerPath);
+                result.removed++;
+                inLower = false;
+            }
+            if (!inLower && mkdir(lowerPath.c_str(), 0700) != 0) {
+                error = "cannot create " + lowerPath + ": " + strerror(errno);
+                return false;
+            }
+            if (!ApplyDirectory(upperPath, lowerPath, result, error, cancel)) return false;
+            chmod(lowerPath.c_str(), upperSt.st_mode & 07777);
+            continue;
+        }
+
+        // A file replacing a directory arrives without a whiteout.
+        if (inLower && S_ISDIR(lowerSt.st_mode)) RemoveTree(lowerPath);
+
+        // Same filesystem: rename is the whole copy. Otherwise copy+rename.
+        if (rename(upperPath.c_str(), lowerPath.c_str()) != 0) {
+            if (errno != EXDEV) {
+                error = "cannot move " + upperPath + ": " + strerror(errno);
+                return false;
+            }
+            if (S_ISLNK(upperSt.st_mode)) {
+                char target[PATH_MAX];
+                ssize_t n = readlink(upperPath.c_str(), target, sizeof(target) - 1);
+                std::string temp = lowerPath + ".terminai-commit";
+                if (n < 0 || (target[n] = '\0', symlink(target, temp.c_str())) != 0 ||
+                    rename(temp.c_str(), lowerPath.c_str()) != 0) {
+                    error = "cannot link " + lowerPath + ": " + strerror(errno);
+                    unlink(temp.c_str());
+                    return false;
+                }
+            } else if (!CopyFileAtomic(upperPath, lowerPath, upperSt.st_mode, error)) {
+                return false;
+            }
+        }
+        result.written++;
+        if (S_ISREG(upperSt.st_mode)) result.bytes += static_cast<uint64_t>(upperSt.st_size);
+    }
+    return true;
+}
+
+/** Move a directory out of the way and delete it on the worker pool. */
+bool RetireDirectory(const std::string& path) {
+    std::string trash = path + ".discard-" + NewOverlayId();
+    if (rename(path.c_str(), trash.c_str()) != 0) return errno == ENOENT;
+    WorkerPool::Shared().Submit([trash]() { RemoveTree(trash); },
+                                WorkContext{WorkPriority::Bulk, 0});
+    return true;
+}
+
+bool CanonicalPath(const std::string& path, std::string& out) {
+    char resolved[PATH_MAX];
+    if (!realpath(path.c_str(), resolved)) return false;
+    out = resolved;
+    return true;
+}
+
+} // namespace
+
+// ============================================================================
+// Core Functions
+// ============================================================================
+
+bool CreateOverlay(const std::string& lower, const std::string& stateRoot,
+                   OverlayInfo& info, std::string& error) {
+    std::string lowerPath, rootPath;
+    struct stat st;
+    if (!CanonicalPath(lower, lowerPath) || stat(lowerPath.c_str(), &st) != 0 ||
+        !S_ISDIR(st.st_mode)) {
+        error = "workspace is not a directory: " + lower;
+        return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(stateRoot, ec);
+    if (ec) {
+        error = "cannot create " + stateRoot + ": " + ec.message();
+        return false;
+    }
+    if (!CanonicalPath(stateRoot, rootPath)) {
+        error = "cannot resolve " + stateRoot + ": " + strerror(errno);
+        return false;
+    }
+
+    // overlayfs rejects overlapping layers.
+    if (rootPath == lowerPath || rootPath.compare(0, lowerPath.size() + 1, lowerPath + "/") == 0) {
+        error = "overlay state root must be outside the workspace";
+        return false;
+    }
+
+    info.id = NewOverlayId();
+    info.lower = lowerPath;
+    info.stateDir = rootPath + "/" + info.id;
+    info.upper = info.stateDir + "/upper";
+    info.work = info.stateDir + "/work";
+
+    if (mkdir(info.stateDir.c_str(), 0700) != 0 || mkdir(info.upper.c_str(), 0755) != 0 ||
+        mkdir(info.work.c_str(), 0700) != 0) {
+        error = "cannot create overlay directories: " + std::string(strerror(errno));
+        RemoveTree(info.stateDir);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(g_overlayMutex);
+    g_overlays[info.id] = {info, {}};
+    return true;
+}
+
+bool FindOverlay(const std::string& id, OverlayInfo& info) {
+    std::lock_guard<std::mutex> lock(g_overlayMutex);
+    auto it = g_overlays.find(id);
+    if (it == g_overlays.end()) return false;
+    info = it->second.info;
+    return true;
+}
+
+void AttachOverlayProcess(const std::string& id, pid_t pid) {
+    std::lock_guard<std::mutex> lock(g_overlayMutex);
+    auto it = g_overlays.find(id);
+    if (it != g_overlays.end()) it->second.processes.push_back(pid);
+}
+
+bool DiffOverlay(const std::string& id, std::vector<OverlayChange>& changes, std::string& error,
+                 CancelToken* cancel) {
+    OverlayInfo info;
+    if (!FindOverlay(id, info)) {
+        error = "unknown overlay: " + id;
+        return false;
+    }
+    DiffDirectory(info.upper, info.lower, "", true, changes, cancel);
+    if (IsStopped(cancel)) {
+        error = CancelReasonMessage(cancel->Outcome());
+        return false;
+    }
+    return true;
+}
+
+bool CommitOverlay(const std::string& id, OverlayCommitResult& result, std::string& error,
+                   CancelToken* cancel) {
+    OverlayInfo info;
+    {
+        std::lock_guard<std::mutex> lock(g_overlayMutex);
+        auto it = g_overlays.find(id);
+        if (it == g_overlays.end()) {
+            error = "unknown overlay: " + id;
+            return false;
+        }
+        // The lower layer must not change under a mounted overlay.
+        if (HasRunningProcess(it->second)) {
+            error = "overlay is in use by a running sandbox";
+            return false;
+        }
+        info = it->second.info;
+    }
+
+    if (!ApplyDirectory(info.upper, info.lower, result, error, cancel)) return false;
+
+    // Start the next run from a clean upper layer.
+    if (!RetireDirectory(info.upper) || !RetireDirectory(info.work) ||
+        mkdir(info.upper.c_str(), 0755) != 0 || mkdir(info.work.c_str(), 0700) != 0) {
+        error = "cannot reset overlay: " + std::string(strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+bool DiscardOverlay(const std::string& id, std::string& error) {
+    OverlayInfo info;
+    {
+        std::lock_guard<std::mutex> lock(g_overlayMutex);
+        auto it = g_overlays.find(id);
+        if (it == g_overlays.end()) {
+            error = "unknown overlay: " + id;
+            return false;
+        }
+        info = it->second.info;
+        g_overlays.erase(it);
+    }
+
+    // A still-running sandbox keeps its mount (and open upper files) alive;
+    // unlinking underneath it is safe.
+    if (!RetireDirectory(info.stateDir)) {
+        error = "cannot discard overlay: " + std::string(strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// Async Workers
+// ============================================================================
+
+namespace {
+
+const char* ChangeKindName(OverlayChangeKind kind) {
+    switch (kind) {
+        case OverlayChangeKind::Added: return "added";
+        case OverlayChangeKind::Modified: return "modified";
+        case OverlayChangeKind::Deleted: return "deleted";
+        case OverlayChangeKind::Replaced: return "replaced";
+    }
+    return "modified";
+}
+
+class DiffWorker : public Napi::AsyncWorker {
+public:
+    DiffWorker(Napi::Env env, std::string id, CancelBinding cancel)
+        : Napi::AsyncWorker(env),
+          deferred_(Napi::Promise::Deferred::New(env)),
+          id_(std::move(id)),
+          cancel_(std::move(cancel)) {}
+
+    Napi::Promise Promise() const { return deferred_.Promise(); }
+
+    void Execute() override {
+        std::string error;
+        if (!DiffOverlay(id_, changes_, error, cancel_.Token())) SetError(error);
+    }
+
+    void OnOK() override {
+        cancel_.Finish();
+        Napi::Env env = Env();
+        Napi::Array out = Napi::Array::New(env, changes_.size());
+        for (size_t i = 0; i < changes_.size(); i++) {
+            const OverlayChange& c = changes_[i];
+            Napi::Object entry = Napi::Object::New(env);
+            entry.Set("path", Napi::String::New(env, c.path));
+            entry.Set("kind", Napi::String::New(env, ChangeKindName(c.kind)));
+            entry.Set("directory", Napi::Boolean::New(env, c.directory));
+            entry.Set("size", Napi::Number::New(env, static_cast<double>(c.size)));
+            out.Set(static_cast<uint32_t>(i), entry);
+        }
+        deferred_.Resolve(out);
+    }
+
+    void OnError(const Napi::Error& error) override {
+        cancel_.Finish();
+        deferred_.Reject(cancel_.Stopped() ? cancel_.StoppedError(Env()) : error.Value());
+    }
+
+private:
+    Napi::Promise::Deferred deferred_;
+    std::string id_;
+    CancelBinding cancel_;
+    std::vector<OverlayChange> changes_;
+};
+
+class CommitWorker : public Napi::AsyncWorker {
+public:
+    CommitWorker(Napi::Env env, std::string id, CancelBinding cancel)
+        : Napi::AsyncWorker(env),
+          deferred_(Napi::Promise::Deferred::New(env)),
+          id_(std::move(id)),
+          cancel_(std::move(cancel)) {}
+
+    Napi::Promise Promise() const { return deferred_.Promise(); }
+
+    void Execute() override {
+        std::string error;
+        if (!CommitOverlay(id_, result_, error, cancel_.Token())) SetError(error);
+    }
+
+    void OnOK() override {
+        cancel_.Finish();
+        Napi::Env env = Env();
+        Napi::Object out = Napi::Object::New(env);
+        out.Set("written", Napi::Number::New(env, static_cast<double>(result_.written)));
+        out.Set("removed", Napi::Number::New(env, static_cast<double>(result_.removed)));
+        out.Set("bytes", Napi::Number::New(env, static_cast<double>(result_.bytes)));
+        deferred_.Resolve(out);
+    }
+
+    void OnError(const Napi::Error& error) override {
+        cancel_.Finish();
+        deferred_.Reject(cancel_.Stopped() ? cancel_.StoppedError(Env()) : error.Value());
+    }
+
+private:
+    Napi::Promise::Deferred deferred_;
+    std::string id_;
+    CancelBinding cancel_;
+    OverlayCommitResult result_;
+};
+
+Napi::Value RejectWith(Napi::Env env, const std::string& message) {
+    auto deferred = Napi::Promise::Deferred::New(env);
+    deferred.Reject(Napi::TypeError::New(env, message).Value());
+    return deferred.Promise();
+}
+
+} // namespace
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+Napi::Value CreateOverlayWorkspace(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsString() || !info[1].IsString()) {
+        Napi::TypeError::New(env, "createOverlayWorkspace expects (workspacePath, stateRoot)")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    OverlayInfo overlay;
+    std::string error;
+    if (!CreateOverlay(info[0].As<Napi::String>().Utf8Value(),
+                       info[1].As<Napi::String>().Utf8Value(), overlay, error)) {
+        Napi::Error::New(env, error).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("id", Napi::String::New(env, overlay.id));
+    result.Set("lower", Napi::String::New(env, overlay.lower));
+    result.Set("upper", Napi::String::New(env, overlay.upper));
+    result.Set("work", Napi::String::New(env, overlay.work));
+    return result;
+}
+
+Napi::Value DiffOverlayWorkspace(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsString()) {
+        return RejectWith(env, "diffOverlayWorkspace expects an overlay id");
+    }
+
+    CancelBinding cancel(CancellableOperation::DiffOverlay);
+    std::string error;
+    if (!cancel.Attach(info.Length() > 1 ? info[1] : env.Undefined(), error)) {
+        return RejectWith(env, error);
+    }
+
+    auto* worker = new DiffWorker(env, info[0].As<Napi::String>().Utf8Value(), std::move(cancel));
+    Napi::Promise promise = worker->Promise();
+    worker->Queue();
+    return promise;
+}
+
+Napi::Value CommitOverlayWorkspace(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsString()) {
+        return RejectWith(env, "commitOverlayWorkspace expects an overlay id");
+    }
+
+    CancelBinding cancel(CancellableOperation::CommitOverlay);
+    std::string error;
+    if (!cancel.Attach(info.Length() > 1 ? info[1] : env.Undefined(), error)) {
+        return RejectWith(env, error);
+    }
+
+    auto* worker = new CommitWorker(env, info[0].As<Napi::String>().Utf8Value(),
+                                    std::move(cancel));
+    Napi::Promise promise = worker->Promise();
+    worker->Queue();
+    return promise;
+}
+
+Napi::Value DiscardOverlayWorkspace(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsString()) {
+        return Napi::Boolean::New(env, false);
+    }
+
+    std::string error;
+    bool ok = DiscardOverlay(info[0].As<Napi::String>().Utf8Value(), error);
+    if (!ok) std::cerr << "[OverlayWorkspace] " << error << std::endl;
+    return Napi::Boolean::New(env, ok);
+}
+
+} // namespace TerminAI
+
+#else // !__linux__
+
+namespace TerminAI {
+
+// ============================================================================
+// Stubs for Windows and macOS
+// ============================================================================
+
+namespace {
+
+Napi::Value Unsupported(Napi::Env env) {
+    auto deferred = Napi::Promise::Deferred::New(env);
+    deferred.Reject(Napi::Error::New(env, "Overlay workspaces are only available on Linux").Value());
+    return deferred.Promise();
+}
+
+} // namespace
+
+Napi::Value CreateOverlayWorkspace(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Error::New(env, "Overlay workspaces are only available on Linux")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+}
+
+Napi::Value DiffOverlayWorkspace(const Napi::CallbackInfo& info) {
+    return Unsupported(info.Env());
+}
+
+Napi::Value CommitOverlayWorkspace(const Napi::CallbackInfo& info) {
+    return Unsupported(info.Env());
+}
+
+Napi::Value DiscardOverlayWorkspace(const Napi::CallbackInfo& info) {
+    return Napi::Boolean::New(info.Env(), false);
+}
+
+} // namespace TerminAI
+
+#endif // __linux__
@@ -0,0 +1,166 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Overlay Workspace Header
+ *
+ * Copy-on-write workspaces for disposable sandbox runs (Linux). Instead of
+ * copying the workspace, an overlay gets two empty directories:
+ *
+ *   <stateRoot>/<id>/upper   receives every file the sandbox writes
+ *   <stateRoot>/<id>/work    overlayfs scratch space
+ *
+ * and the sandbox launcher mounts overlayfs(lower = workspace, upper, work)
+ * over the workspace path inside the sandbox's mount namespace. Setup cost
+ * is two mkdir calls regardless of workspace size.
+ *
+ * After the sandbox exits, the upper directory *is* the diff:
+ * - regular files / symlinks     added or modified
+ * - 0:0 character devices        whiteouts (deleted)
+ * - user.overlay.whiteout xattr  whiteouts (kernel >= 6.7)
+ * - user.overlay.opaque = "y"    directory replaced wholesale
+ *
+ * Commit applies that diff to the workspace; discard renames the state
+ * directory away and deletes it in the background.
+ */
+
+#pragma once
+
+#include <napi.h>
+#include "cancellation.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/types.h>
+#endif
+
+namespace TerminAI {
+
+// ============================================================================
+// Types
+// ============================================================================
+
+enum class OverlayChangeKind : uint8_t {
+    Added,
+    Modified,
+    Deleted,
+    /** Directory existed in the workspace and was replaced (opaque) */
+    Replaced,
+};
+
+struct OverlayChange {
+    /** Path relative to the workspace, '/'-separated */
+    std::string path;
+    OverlayChangeKind kind;
+    bool directory = false;
+    uint64_t size = 0;
+};
+
+struct OverlayInfo {
+    std::string id;
+    std::string lower;
+    std::string stateDir;
+    std::string upper;
+    std::string work;
+};
+
+struct OverlayCommitResult {
+    uint64_t written = 0;
+    uint64_t removed = 0;
+    uint64_t bytes = 0;
+};
+
+#ifdef __linux__
+
+// ============================================================================
+// Core Functions
+// ============================================================================
+
+bool CreateOverlay(const std::string& lower, const std::string& stateRoot,
+                   OverlayInfo& info, std::string& error);
+
+/** Look up a live overlay by id. */
+bool FindOverlay(const std::string& id, OverlayInfo& info);
+
+/** Record that `pid` runs on the overlay (commit refuses while it lives). */
+void AttachOverlayProcess(const std::string& id, pid_t pid);
+
+/** @param cancel Checked per upper-layer entry (null = never stops) */
+bool DiffOverlay(const std::string& id, std::vector<OverlayChange>& changes, std::string& error,
+                 CancelToken* cancel = nullptr);
+
+/**
+ * Apply the upper directory to the workspace, then reset the overlay to
+ * empty so it can be reused. Each file is moved (or copied, across
+ * filesystems) into place via rename, so readers never see partial files.
+ *
+ * @param cancel Checked between entries. A stopped commit has applied a
+ *        prefix of the changes; the rest stay in the upper layer and the
+ *        next commit applies them.
+ */
+bool CommitOverlay(const std::string& id, OverlayCommitResult& result, std::string& error,
+                   CancelToken* cancel = nullptr);
+
+/** Forget the overlay and delete its state directory in the background. */
+bool DiscardOverlay(const std::string& id, std::string& error);
+
+#endif // __linux__
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+/**
+ * Create an overlay workspace.
+ *
+ * Arguments:
+ *   0: String - Workspace path (the lower layer)
+ *   1: String - State root where upper/work directories are created
+ *
+ * Returns: Object - { id, lower, upper, work } or throws on failure
+ */
+Napi::Value CreateOverlayWorkspace(const Napi::CallbackInfo& info);
+
+/**
+ * List the changes recorded in an overlay.
+ *
+ * Arguments:
+ *   0: String - Overlay id
+ *   1: Object (optional) - { timeoutMs?: number, signal?: AbortSignal }
+ *
+ * Returns: Promise<Array<{ path, kind, directory, size }>>
+ *   kind: 'added' | 'modified' | 'deleted' | 'replaced'
+ *   (rejects with an AbortError or TimeoutError when stopped)
+ */
+Napi::Value DiffOverlayWorkspace(const Napi::CallbackInfo& info);
+
+/**
+ * Apply an overlay's changes to the workspace and reset the overlay.
+ * Rejects while a sandbox started on the overlay is still running.
+ *
+ * Arguments:
+ *   0: String - Overlay id
+ *   1: Object (optional) - { timeoutMs?: number, signal?: AbortSignal }
+ *
+ * Returns: Promise<{ written, removed, bytes }> (rejects with an AbortError
+ *          or TimeoutError when stopped between entries; see CommitOverlay)
+ */
+Napi::Value CommitOverlayWorkspace(const Napi::CallbackInfo& info);
+
+/**
+ * Throw an overlay away. O(1): the state directory is renamed and removed
+ * on a background thread.
+ *
+ * Arguments:
+ *   0: String - Overlay id
+ *
+ * Returns: Boolean - false if the id is unknown
+ */
+Napi::Value DiscardOverlayWorkspace(const Napi::CallbackInfo& info);
+
+} // namespace TerminAI
@@ -0,0 +1,989 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Command Policy Engine Implementation
+ *
+ * Hot reload: the active policy is an immutable CompiledPolicy held by
+ * shared_ptr. Reloads compile the new file completely on the watcher thread
+ * and then swap the pointer under a mutex, so an evaluation always sees
+ * either the old or the new rule set, never a mix.
+ */
+
+#include "policy_engine.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+namespace TerminAI {
+
+// ============================================================================
+// GlobMatcher
+// ============================================================================
+
+namespace {
+
+/** DFA construction is abandoned (NFA simulation used) beyond this size. */
+constexpr size_t MAX_DFA_STATES = 4096;
+
+} // namespace
+
+bool GlobMatcher::Compile(const std::string& pattern) {
+    if (pattern.empty()) return false;
+
+    pattern_ = pattern;
+    tokens_.clear();
+    literalPrefix_.clear();
+    isLiteral_ = true;
+
+    for (char c : pattern) {
+        if (c == '*') {
+            isLiteral_ = false;
+            if (tokens_.empty() || tokens_.back().kind != TokenKind::AnyRun) {
+                tokens_.push_back({TokenKind::AnyRun, 0});
+            }
+        } else if (c == '?') {
+            isLiteral_ = false;
+            tokens_.push_back({TokenKind::AnyByte, 0});
+        } else {
+            if (isLiteral_) literalPrefix_.push_back(c);
+            tokens_.push_back({TokenKind::Literal, static_cast<uint8_t>(c)});
+        }
+    }
+
+    // Byte equivalence classes: one per distinct literal byte, class 0 for
+    // every other byte. Keeps the transition table tiny.
+    std::fill(std::begin(byteClass_), std::end(byteClass_), 0);
+    classCount_ = 1;
+    for (const Token& token : tokens_) {
+        if (token.kind == TokenKind::Literal && byteClass_[token.byte] == 0) {
+            byteClass_[token.byte] = static_cast<uint8_t>(classCount_++);
+        }
+    }
+
+    const uint32_t accept = static_cast<uint32_t>(tokens_.size());
+
+    auto closure = [this, accept](std::vector<uint32_t>& set) {
+        for (size_t i = 0; i < set.size(); i++) {
+            uint32_t pos = set[i];
+            if (pos < accept && tokens_[pos].kind == TokenKind::AnyRun &&
+                std::find(set.begin(), set.end(), pos + 1) == set.end()) {
+                set.push_back(pos + 1);
+            }
+        }
+        std::sort(set.begin(), set.end());
+    };
+
+    std::map<std::vector<uint32_t>, uint32_t> stateIds;
+    std::vector<std::vector<uint32_t>> states;
+
+    // State 0: dead.
+    states.emplace_back();
+    stateIds[{}] = 0;
+
+    std::vector<uint32_t> start = {0};
+    closure(start);
+    stateIds[start] = 1;
+    states.push_back(start);
+
+    transitions_.assign(2 * classCount_, 0);
+    dfaBuilt_ = true;
+
+    for (size_t s = 1; s < states.size(); s++) {
+        for (uint32_t cls = 0; cls < classCount_; cls++) {
+            std::vector<uint32_t> next;
+            for (uint32_t pos : states[s]) {
+                if (pos >= accept) continue;
+                const Token& token = tokens_[pos];
+                bool advance = token.kind == TokenKind::AnyByte ||
+                               (token.kind == TokenKind::Literal && byteClass_[token.byte] == cls);
+                if (token.kind == TokenKind::AnyRun) {
+                    if (std::find(next.begin(), next.end(), pos) == next.end()) next.push_back(pos);
+                } else if (advance) {
+                    if (std::find(next.begin(), next.end(), pos + 1) == next.end()) next.push_back(pos + 1);
+                }
+            }
+            closure(next);
+
+            auto it = stateIds.find(next);
+            uint32_t target;
+            if (it != stateIds.end()) {
+                target = it->second;
+            } else {
+                if (states.size() >= MAX_DFA_STATES) {
+                    dfaBuilt_ = false;
+                    transitions_.clear();
+                    accepting_.clear();
+                    return true;
+                }
+                target = static_cast<uint32_t>(states.size());
+                stateIds.emplace(next, target);
+                states.push_back(std::move(next));
+                transitions_.resize(states.size() * classCount_, 0);
+            }
+            transitions_[s * classCount_ + cls] = target;
+        }
+    }
+
+    accepting_.assign(states.size(), false);
+    for (size_t s = 1; s < states.size(); s++) {
+        accepting_[s] = std::binary_search(states[s].begin(), states[s].end(), accept);
+    }
+    return true;
+}
+
+bool GlobMatcher::Match(std::string_view input) const {
+    if (!dfaBuilt_) return SimulateNfa(input);
+
+    uint32_t state = 1;
+    for (char c : input) {
+        state = transitions_[state * classCount_ + byteClass_[static_cast<uint8_t>(c)]];
+        if (state == 0) return false;
+    }
+    return accepting_[state];
+}
+
+bool GlobMatcher::SimulateNfa(std::string_view input) const {
+    // Classic linear-space glob match with single-star backtracking.
+    size_t p = 0, i = 0;
+    size_t starToken = SIZE_MAX, starInput = 0;
+
+    while (i < input.size()) {
+        if (p < tokens_.size()) {
+            const Token& token = tokens_[p];
+            if (token.kind == TokenKind::AnyRun) {
+                starToken = p++;
+                starInput = i;
+                continue;
+            }
+            if (token.kind == TokenKind::AnyByte ||
+                token.byte == static_cast<uint8_t>(input[i])) {
+                p++;
+                i++;
+                continue;
+            }
+        }
+        if (starToken == SIZE_MAX) return false;
+        p = starToken + 1;
+        i = ++starInput;
+    }
+
+    while (p < tokens_.size() && tokens_[p].kind == TokenKind::AnyRun) p++;
+    return p == tokens_.size();
+}
+
+// ============================================================================
+// Tries
+// ============================================================================
+
+namespace {
+
+/**
+ * Byte trie mapping literal prefixes to the rules that start with them.
+ */
+class PrefixTrie {
+public:
+    PrefixTrie() : nodes_(1) {}
+
+    void Insert(const std::string& key, uint32_t rule) {
+        uint32_t node = 0;
+        for (char c : key) node = Child(node, static_cast<uint8_t>(c), true);
+        nodes_[node].rules.push_back(rule);
+    }
+
+    /** Append the rules of every node on the path spelled by `input`. */
+    void CollectPrefixes(std::string_view input, std::vector<uint32_t>& out) const {
+        uint32_t node = 0;
+        out.insert(out.end(), nodes_[0].rules.begin(), nodes_[0].rules.end());
+        for (char c : input) {
+            node = Find(node, static_cast<uint8_t>(c));
+            if (node == 0) return;
+            out.insert(out.end(), nodes_[node].rules.begin(), nodes_[node].rules.end());
+        }
+    }
+
+private:
+    struct Node {
+        std::vector<std::pair<uint8_t, uint32_t>> children; // Sorted by byte
+        std::vector<uint32_t> rules;
+    };
+
+    uint32_t Find(uint32_t node, uint8_t byte) const {
+        const auto& children = nodes_[node].children;
+        auto it = std::lower_bound(children.begin(), children.end(),
+                                   std::make_pair(byte, uint32_t(0)));
+        return it != children.end() && it->first == byte ? it->second : 0;
+    }
+
+    uint32_t Child(uint32_t node, uint8_t byte, bool create) {
+        uint32_t found = Find(node, byte);
+        if (found != 0 || !create) return found;
+
+        uint32_t created = static_cast<uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+        auto& children = nodes_[node].children;
+        auto it = std::lower_bound(children.begin(), children.end(),
+                                   std::make_pair(byte, uint32_t(0)));
+        children.insert(it, {byte, created});
+        return created;
+    }
+
+    std::vector<Node> nodes_;
+};
+
+/**
+ * Split a path into normalized components: separators '/' and '\\',
+ * "." dropped and ".." resolved lexically so "/ws/../etc" cannot pass as
+ * being under "/ws".
+ */
+std::vector<std::string> PathComponents(const std::string& path) {
+    std::vector<std::string> components;
+    std::string current;
+
+    auto flush = [&]() {
+        if (current.empty() || current == ".") {
+            // Skip
+        } else if (current == "..") {
+            if (!components.empty()) components.pop_back();
+        } else {
+#ifdef _WIN32
+            std::transform(current.begin(), current.end(), current.begin(),
+                           [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+#endif
+            components.push_back(current);
+        }
+        current.clear();
+    };
+
+    for (char c : path) {
+        if (c == '/' || c == '\\') {
+            flush();
+        } else {
+            current.push_back(c);
+        }
+    }
+    flush();
+    return components;
+}
+
+/**
+ * Trie of path components mapping directory prefixes to rules.
+ */
+class PathTrie {
+public:
+    PathTrie() : nodes_(1) {}
+
+    void Insert(const std::vector<std::string>& components, uint32_t rule) {
+        uint32_t node = 0;
+        for (const auto& component : components) {
+            auto it = nodes_[node].children.find(component);
+            if (it == nodes_[node].children.end()) {
+                uint32_t created = static_cast<uint32_t>(nodes_.size());
+                nodes_[node].children.emplace(component, created);
+                nodes_.emplace_back();
+                node = created;
+            } else {
+                node = it->second;
+            }
+        }
+        nodes_[node].rules.push_back(rule);
+    }
+
+    void CollectPrefixes(const std::vector<std::string>& components,
+                         std::vector<uint32_t>& out) const {
+        uint32_t node = 0;
+        out.insert(out.end(), nodes_[0].rules.begin(), nodes_[0].rules.end());
+        for (const auto& component : components) {
+            auto it = nodes_[node].children.find(component);
+            if (it == nodes_[node].children.end()) return;
+            node = it->second;
+            out.insert(out.end(), nodes_[node].rules.begin(), nodes_[node].rules.end());
+        }
+    }
+
+private:
+    struct Node {
+        std::unordered_map<std::string, uint32_t> children;
+        std::vector<uint32_t> rules;
+    };
+
+    std::vector<Node> nodes_;
+};
+
+struct EnvConstraint {
+    enum class Kind { Present, Absent, Matches };
+    Kind kind = Kind::Present;
+    std::string name;
+    GlobMatcher value;
+};
+
+struct PolicyRule {
+    std::string id;
+    bool deny = false;
+    int line = 0;
+    bool hasCommand = false;
+    bool commandIsPath = false;
+    GlobMatcher command;
+    bool hasArgs = false;
+    GlobMatcher args;
+    bool hasCwd = false;
+    std::vector<EnvConstraint> env;
+};
+
+inline std::string_view Basename(std::string_view command) {
+    size_t slash = command.find_last_of("/\\");
+    return slash == std::string_view::npos ? command : command.substr(slash + 1);
+}
+
+/**
+ * Split a rule line into whitespace-separated tokens. Double quotes group
+ * text containing spaces; backslash escapes a quote or backslash inside
+ * quotes only, so Windows paths need no escaping.
+ */
+bool TokenizeLine(const std::string& line, std::vector<std::string>& tokens, std::string& error) {
+    std::string current;
+    bool inQuotes = false;
+    bool hasToken = false;
+
+    for (size_t i = 0; i < line.size(); i++) {
+        char c = line[i];
+        if (inQuotes) {
+            if (c == '\\' && i + 1 < line.size() && (line[i + 1] == '"' || line[i + 1] == '\\')) {
+                current.push_back(line[++i]);
+            } else if (c == '"') {
+                inQuotes = false;
+            } else {
+                current.push_back(c);
+            }
+        } else if (c == '"') {
+            inQuotes = true;
+            hasToken = true;
+        } else if (c == '#') {
+            break;
+        } else if (c == ' ' || c == '\t' || c == '\r') {
+            if (hasToken) tokens.push_back(std::move(current));
+            current.clear();
+            hasToken = false;
+        } else {
+            current.push_back(c);
+            hasToken = true;
+        }
+    }
+
+    if (inQuotes) {
+        error = "unterminated quote";
+        return false;
+    }
+    if (hasToken) tokens.push_back(std::move(current));
+    return true;
+}
+
+} // namespace
+
+// ============================================================================
+// CompiledPolicy
+// ============================================================================
+
+class CompiledPolicy {
+public:
+    std::vector<PolicyRule> rules;
+    bool defaultAllow = false;
+
+    std::unordered_map<std::string, std::vector<uint32_t>> exactBase;
+    std::unordered_map<std::string, std::vector<uint32_t>> exactPath;
+    PrefixTrie globBase;
+    PrefixTrie globPath;
+    std::vector<uint32_t> anyCommand;
+    PathTrie cwdTrie;
+
+    void Index() {
+        for (uint32_t i = 0; i < rules.size(); i++) {
+            const PolicyRule& rule = rules[i];
+            if (!rule.hasCommand) {
+                anyCommand.push_back(i);
+            } else if (rule.command.IsLiteral()) {
+                (rule.commandIsPath ? exactPath : exactBase)[rule.command.Pattern()].push_back(i);
+            } else {
+                (rule.commandIsPath ? globPath : globBase).Insert(rule.command.LiteralPrefix(), i);
+            }
+        }
+    }
+};
+
+std::shared_ptr<const CompiledPolicy> CompilePolicy(const std::string& text, std::string& error) {
+    auto policy = std::make_shared<CompiledPolicy>();
+    std::unordered_map<std::string, int> seenIds;
+
+    std::istringstream stream(text);
+    std::string line;
+    int lineNumber = 0;
+
+    auto fail = [&](const std::string& message) {
+        error = "line " + std::to_string(lineNumber) + ": " + message;
+        return nullptr;
+    };
+
+    while (std::getline(stream, line)) {
+        lineNumber++;
+
+        std::vector<std::string> tokens;
+        std::string tokenError;
+        if (!TokenizeLine(line, tokens, tokenError)) return fail(tokenError);
+        if (tokens.empty()) continue;
+
+        if (tokens[0] == "default") {
+            if (tokens.size() != 2 || (tokens[1] != "allow" && tokens[1] != "deny")) {
+                return fail("expected 'default allow' or 'default deny'");
+            }
+            policy->defaultAllow = tokens[1] == "allow";
+            continue;
+        }
+
+        if (tokens[0] != "allow" && tokens[0] != "deny") {
+            return fail("unknown action '" + tokens[0] + "'");
+        }
+        if (tokens.size() < 2 || tokens[1].find('=') != std::string::npos) {
+            return fail("missing rule id");
+        }
+        if (!seenIds.emplace(tokens[1], lineNumber).second) {
+            return fail("duplicate rule id '" + tokens[1] + "'");
+        }
+
+        PolicyRule rule;
+        rule.id = tokens[1];
+        rule.deny = tokens[0] == "deny";
+        rule.line = lineNumber;
+        std::vector<std::string> cwdComponents;
+
+        for (size_t t = 2; t < tokens.size(); t++) {
+            size_t eq = tokens[t].find('=');
+            if (eq == std::string::npos) return fail("expected key=value, got '" + tokens[t] + "'");
+            std::string key = tokens[t].substr(0, eq);
+            std::string value = tokens[t].substr(eq + 1);
+
+            if (key == "cmd") {
+                if (!rule.command.Compile(value)) return fail("empty cmd pattern");
+                rule.hasCommand = true;
+                rule.commandIsPath = value.find_first_of("/\\") != std::string::npos;
+            } else if (key == "args") {
+                // An empty args pattern means "no arguments".
+                rule.hasArgs = true;
+                if (!value.empty()) rule.args.Compile(value);
+            } else if (key == "cwd") {
+                if (value.empty()) return fail("empty cwd prefix");
+                cwdComponents = PathComponents(value);
+                rule.hasCwd = true;
+            } else if (key == "env") {
+                EnvConstraint constraint;
+                if (!value.empty() && value[0] == '!') {
+                    constraint.kind = EnvConstraint::Kind::Absent;
+                    constraint.name = value.substr(1);
+                } else if (size_t veq = value.find('='); veq != std::string::npos) {
+                    constraint.kind = EnvConstraint::Kind::Matches;
+                    constraint.name = value.substr(0, veq);
+                    if (!constraint.value.Compile(value.substr(veq + 1))) {
+                        return fail("empty env value pattern");
+                    }
+                } else {
+                    constraint.name = value;
+                }
+                if (constraint.name.empty()) return fail("empty env name");
+                rule.env.push_back(std::move(constraint));
+            } else {
+                return fail("unknown key '" + key + "'");
+            }
+        }
+
+        if (rule.hasCwd) {
+            policy->cwdTrie.Insert(cwdComponents, static_cast<uint32_t>(policy->rules.size()));
+        }
+        policy->rules.push_back(std::move(rule));
+    }
+
+    policy->Index();
+    return policy;
+}
+
+size_t PolicyRuleCount(const CompiledPolicy& policy) {
+    return policy.rules.size();
+}
+
+namespace {
+
+/** Whether two variable names are the same variable (Windows ignores case). */
+bool SameEnvName(const std::string& a, const std::string& b) {
+#ifdef _WIN32
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(), [](unsigned char x, unsigned char y) {
+               return std::tolower(x) == std::tolower(y);
+           });
+#else
+    return a == b;
+#endif
+}
+
+} // namespace
+
+PolicyDecision EvaluatePolicy(const CompiledPolicy& policy, const PolicyRequest& request) {
+    std::string_view base = Basename(request.command);
+
+    // Step 1: Candidate rules by command
+    std::vector<uint32_t> candidates;
+    candidates.reserve(16);
+
+    if (auto it = policy.exactBase.find(std::string(base)); it != policy.exactBase.end()) {
+        candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+    }
+    if (auto it = policy.exactPath.find(request.command); it != policy.exactPath.end()) {
+        candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+    }
+    size_t exactCount = candidates.size();
+    policy.globBase.CollectPrefixes(base, candidates);
+    policy.globPath.CollectPrefixes(request.command, candidates);
+    size_t globEnd = candidates.size();
+    candidates.insert(candidates.end(), policy.anyCommand.begin(), policy.anyCommand.end());
+
+    // Glob candidates only share the literal prefix; confirm with the DFA.
+    auto confirmed = std::remove_if(
+        candidates.begin() + exactCount, candidates.begin() + globEnd,
+        [&](uint32_t index) {
+            const PolicyRule& rule = policy.rules[index];
+            return !rule.command.Match(rule.commandIsPath ? std::string_view(request.command) : base);
+        });
+    candidates.erase(confirmed, candidates.begin() + globEnd);
+
+    // A bare-name allow must not admit a path ending in that name (a binary
+    // planted as ./git); deny rules still match the basename.
+    if (base.size() != request.command.size()) {
+        candidates.erase(
+            std::remove_if(candidates.begin(), candidates.end(), [&](uint32_t index) {
+                const PolicyRule& rule = policy.rules[index];
+                return rule.hasCommand && !rule.commandIsPath && !rule.deny;
+            }),
+            candidates.end());
+    }
+
+    if (candidates.empty()) {
+        PolicyDecision decision;
+        decision.allowed = policy.defaultAllow;
+        return decision;
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    // Step 2: Per-request inputs, computed only if a candidate needs them
+    std::vector<uint32_t> cwdMatches;
+    bool cwdResolved = false;
+    std::string joinedArgs;
+    bool argsJoined = false;
+
+    auto matches = [&](const PolicyRule& rule, uint32_t index) {
+        if (rule.hasCwd) {
+            if (!cwdResolved) {
+                policy.cwdTrie.CollectPrefixes(PathComponents(request.cwd), cwdMatches);
+                std::sort(cwdMatches.begin(), cwdMatches.end());
+                cwdResolved = true;
+            }
+            if (!std::binary_search(cwdMatches.begin(), cwdMatches.end(), index)) return false;
+        }
+
+        if (rule.hasArgs) {
+            if (!argsJoined) {
+                for (size_t i = 0; i < request.args.size(); i++) {
+                    if (i > 0) joinedArgs.push_back(' ');
+                    joinedArgs += request.args[i];
+                }
+                argsJoined = true;
+            }
+            bool ok = rule.args.Pattern().empty() ? request.args.empty() : rule.args.Match(joinedArgs);
+            if (!ok) return false;
+        }
+
+        for (const EnvConstraint& constraint : rule.env) {
+            const std::string* value = nullptr;
+            for (const auto& [name, v] : request.env) {
+                if (SameEnvName(name, constraint.name)) {
+                    value = &v;
+                    break;
+                }
+            }
+            switch (constraint.kind) {
+                case EnvConstraint::Kind::Present:
+                    if (value == nullptr) return false;
+                    break;
+                case EnvConstraint::Kind::Absent:
+                    if (value != nullptr) return false;
+                    break;
+                case EnvConstraint::Kind::Matches:
+                    if (value == nullptr || !constraint.value.Match(*value)) return false;
+                    break;
+            }
+        }
+        return true;
+    };
+
+    // Step 3: Deny overrides; otherwise first allow in file order
+    const PolicyRule* firstAllow = nullptr;
+    uint32_t previous = UINT32_MAX;
+    for (uint32_t index : candidates) {
+        if (index == previous) continue;
+        previous = index;
+
+        const PolicyRule& rule = policy.rules[index];
+        if (!rule.deny && firstAllow != nullptr) continue;
+        if (!matches(rule, index)) continue;
+
+        if (rule.deny) {
+            PolicyDecision decision;
+            decision.allowed = false;
+            decision.action = PolicyAction::Deny;
+            decision.ruleId = rule.id;
+            decision.line = rule.line;
+            return decision;
+        }
+        firstAllow = &rule;
+    }
+
+    PolicyDecision decision;
+    if (firstAllow != nullptr) {
+        decision.allowed = true;
+        decision.action = PolicyAction::Allow;
+        decision.ruleId = firstAllow->id;
+        decision.line = firstAllow->line;
+    } else {
+        decision.allowed = policy.defaultAllow;
+    }
+    return decision;
+}
+
+// ============================================================================
+// Active Policy Store
+// ============================================================================
+
+namespace {
+
+struct FileStamp {
+    int64_t mtime = 0;
+    uintmax_t size = 0;
+    bool operator==(const FileStamp& o) const { return mtime == o.mtime && size == o.size; }
+};
+
+bool StampFile(const std::string& path, FileStamp& stamp) {
+    std::error_code ec;
+    std::filesystem::path p = std::filesystem::u8path(path);
+    auto mtime = std::filesystem::last_write_time(p, ec);
+    if (ec) return false;
+    stamp.size = std::filesystem::file_size(p, ec);
+    if (ec) return false;
+    stamp.mtime = mtime.time_since_epoch().count();
+    return true;
+}
+
+bool ReadTextFile(const std::string& path, std::string& text) {
+    std::ifstream file(std::filesystem::u8path(path), std::ios::binary);
+    if (!file.is_open()) return false;
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    text = buffer.str();
+    return true;
+}
+
+class PolicyStore {
+public:
+    static PolicyStore& Instance() {
+        // Leaked on purpose: the watcher thread must not be joined from a
+        // static destructor during process exit.
+        static PolicyStore* store = new PolicyStore();
+        return *store;
+    }
+
+    std::shared_ptr<const CompiledPolicy> Current() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return policy_;
+    }
+
+    bool LoadText(const std::string& text, const std::string& path, std::string& error) {
+        auto compiled = CompilePolicy(text, error);
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!compiled) {
+            lastError_ = error;
+            return false;
+        }
+        policy_ = std::move(compiled);
+        path_ = path;
+        version_++;
+        lastError_.clear();
+        return true;
+    }
+
+    bool LoadFile(const std::string& path, uint32_t watchIntervalMs, std::string& error) {
+        StopWatcher();
+
+        FileStamp stamp;
+        std::string text;
+        if (!StampFile(path, stamp) || !ReadTextFile(path, text)) {
+            error = "cannot read policy file: " + path;
+            std::lock_guard<std::mutex> lock(mutex_);
+            lastError_ = error;
+            return false;
+        }
+        if (!LoadText(text, path, error)) return false;
+
+        if (watchIntervalMs > 0) StartWatcher(path, stamp, watchIntervalMs);
+        return true;
+    }
+
+    void Unload() {
+        StopWatcher();
+        std::lock_guard<std::mutex> lock(mutex_);
+        policy_.reset();
+        path_.clear();
+        lastError_.clear();
+    }
+
+    void RecordEvaluation(uint64_t ns) {
+        evaluations_.fetch_add(1, std::memory_order_relaxed);
+        evalNs_.fetch_add(ns, std::memory_order_relaxed);
+    }
+
+    struct Info {
+        bool loaded;
+        std::string path;
+        size_t rules;
+        uint64_t version;
+        uint64_t evaluations;
+        uint64_t evalNs;
+        std::string lastError;
+    };
+
+    Info Describe() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return {
+            policy_ != nullptr,
+            path_,
+            policy_ ? policy_->rules.size() : 0,
+            version_,
+            evaluations_.load(),
+            evalNs_.load(),
+            lastError_,
+        };
+    }
+
+    uint64_t Version() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return version_;
+    }
+
+private:
+    void StartWatcher(const std::string& path, FileStamp stamp, uint32_t intervalMs) {
+        std::lock_guard<std::mutex> lock(watchMutex_);
+        stopWatcher_ = false;
+        watcher_ = std::thread([this, path, stamp, intervalMs]() mutable {
+            std::string reported;
+            std::unique_lock<std::mutex> lock(watchMutex_);
+            while (!watchCv_.wait_for(lock, std::chrono::milliseconds(intervalMs),
+                                      [this]() { return stopWatcher_; })) {
+                FileStamp current;
+                if (!StampFile(path, current) || current == stamp) continue;
+
+                // Compile outside the watch lock so StopWatcher never waits
+                // on a large compile.
+                lock.unlock();
+                std::string text, error;
+                bool loaded = false;
+                if (ReadTextFile(path, text)) {
+                    loaded = LoadText(text, path, error);
+                } else {
+                    error = "cannot read policy file: " + path;
+                    std::lock_guard<std::mutex> guard(mutex_);
+                    lastError_ = error;
+                }
+                lock.lock();
+
+                // On failure the previous policy stays and the stamp does
+                // not move: a file caught mid-write can finish with the same
+                // size and mtime, so it is read again every tick.
+                if (loaded) {
+                    stamp = current;
+                    reported.clear();
+                } else if (error != reported) {
+                    std::cerr << "[PolicyEngine] Keeping the previous policy, " << path
+                              << " did not load: " << error << std::endl;
+                    reported = error;
+                }
+            }
+        });
+    }
+
+    void StopWatcher() {
+        {
+            std::lock_guard<std::mutex> lock(watchMutex_);
+            stopWatcher_ = true;
+        }
+        watchCv_.notify_all();
+        if (watcher_.joinable()) watcher_.join();
+    }
+
+    std::mutex mutex_;
+    std::shared_ptr<const CompiledPolicy> policy_;
+    std::string path_;
+    std::string lastError_;
+    uint64_t version_ = 0;
+
+    std::atomic<uint64_t> evaluations_{0};
+    std::atomic<uint64_t> evalNs_{0};
+
+    std::mutex watchMutex_;
+    std::condition_variable watchCv_;
+    std::thread watcher_;
+    bool stopWatcher_ = false;
+};
+
+Napi::Object LoadResult(Napi::Env env, bool ok, const std::string& error) {
+    PolicyStore& store = PolicyStore::Instance();
+    auto policy = store.Current();
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("ok", Napi::Boolean::New(env, ok));
+    result.Set("rules", Napi::Number::New(env, policy ? static_cast<double>(policy->rules.size()) : 0));
+    result.Set("version", Napi::Number::New(env, static_cast<double>(store.Version())));
+    if (!ok) result.Set("error", Napi::String::New(env, error));
+    return result;
+}
+
+} // namespace
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+Napi::Value LoadCommandPolicy(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        return LoadResult(env, false, "Invalid arguments");
+    }
+
+    uint32_t watchIntervalMs = 0;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Value interval = info[1].As<Napi::Object>().Get("watchIntervalMs");
+        if (interval.IsNumber()) watchIntervalMs = interval.As<Napi::Number>().Uint32Value();
+    }
+
+    std::string error;
+    bool ok = PolicyStore::Instance().LoadFile(
+        info[0].As<Napi::String>().Utf8Value(), watchIntervalMs, error);
+    return LoadResult(env, ok, error);
+}
+
+Napi::Value CompileCommandPolicy(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        return LoadResult(env, false, "Invalid arguments");
+    }
+
+    std::string error;
+    bool ok = PolicyStore::Instance().LoadText(info[0].As<Napi::String>().Utf8Value(), "", error);
+    return LoadResult(env, ok, error);
+}
+
+Napi::Value EvaluateCommandPolicy(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    auto policy = PolicyStore::Instance().Current();
+    if (!policy) return env.Null();
+
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "evaluateCommandPolicy expects a request object")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    Napi::Object object = info[0].As<Napi::Object>();
+    PolicyRequest request;
+
+    Napi::Value command = object.Get("command");
+    if (command.IsString()) request.command = command.As<Napi::String>().Utf8Value();
+
+    Napi::Value args = object.Get("args");
+    if (args.IsArray()) {
+        Napi::Array array = args.As<Napi::Array>();
+        request.args.reserve(array.Length());
+        for (uint32_t i = 0; i < array.Length(); i++) {
+            Napi::Value arg = array.Get(i);
+            if (arg.IsString()) request.args.push_back(arg.As<Napi::String>().Utf8Value());
+        }
+    }
+
+    Napi::Value cwd = object.Get("cwd");
+    if (cwd.IsString()) request.cwd = cwd.As<Napi::String>().Utf8Value();
+
+    Napi::Value envValue = object.Get("env");
+    if (envValue.IsObject()) {
+        Napi::Object envObject = envValue.As<Napi::Object>();
+        Napi::Array names = envObject.GetPropertyNames();
+        for (uint32_t i = 0; i < names.Length(); i++) {
+            Napi::Value name = names.Get(i);
+            Napi::Value value = envObject.Get(name);
+            request.env.emplace_back(name.As<Napi::String>().Utf8Value(),
+                                     value.IsString() ? value.As<Napi::String>().Utf8Value() : "");
+        }
+    }
+
+    PolicyDecision decision = EvaluatePolicy(*policy, request);
+
+    PolicyStore::Instance().RecordEvaluation(static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count()));
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("allowed", Napi::Boolean::New(env, decision.allowed));
+    result.Set("action", Napi::String::New(env,
+        decision.action == PolicyAction::Allow ? "allow"
+        : decision.action == PolicyAction::Deny ? "deny" : "default"));
+    result.Set("ruleId", decision.ruleId.empty()
+        ? env.Null()
+        : Napi::String::New(env, decision.ruleId));
+    result.Set("line", Napi::Number::New(env, decision.line));
+    return result;
+}
+
+Napi::Value GetCommandPolicyInfo(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    PolicyStore::Info state = PolicyStore::Instance().Describe();
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("loaded", Napi::Boolean::New(env, state.loaded));
+    result.Set("path", Napi::String::New(env, state.path));
+    result.Set("rules", Napi::Number::New(env, static_cast<double>(state.rules)));
+    result.Set("version", Napi::Number::New(env, static_cast<double>(state.version)));
+    result.Set("evaluations", Napi::Number::New(env, static_cast<double>(state.evaluations)));
+    result.Set("averageEvalNs", Napi::Number::New(env, state.evaluations == 0 ? 0
+        : static_cast<double>(state.evalNs) / static_cast<double>(state.evaluations)));
+    result.Set("lastError", state.lastError.empty()
+        ? env.Null()
+        : Napi::String::New(env, state.lastError));
+    return result;
+}
+
+Napi::Value UnloadCommandPolicy(const Napi::CallbackInfo& info) {
+    PolicyStore::Instance().Unload();
+    return info.Env().Undefined();
+}
+
+} // namespace TerminAI
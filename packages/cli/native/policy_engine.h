@@ -0,0 +1,196 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Command Policy Engine Header
+ *
+ * Evaluates broker `execute` requests against allow/deny rule files.
+ * Rules are compiled once into lookup structures so that evaluation cost is
+ * independent of how many rules do not apply to the request:
+ * - exact command names:     hash map
+ * - command globs:           byte trie on the literal prefix, then a DFA
+ * - working directory:       path-component trie of cwd prefixes
+ * - argument/env patterns:   one DFA per pattern, run only on candidates
+ *
+ * Rule file format (one rule per line, '#' starts a comment):
+ *
+ *   default deny
+ *   allow git-read   cmd=git args="status*"  cwd=/home/me/workspace
+ *   allow npm-ci     cmd=npm args="ci" env=CI=true
+ *   deny  no-preload cmd=* env=LD_PRELOAD
+ *   allow node       cmd=node env=!NODE_OPTIONS
+ *
+ *   cmd=GLOB   Command glob. A glob with a path separator matches the full
+ *              command; one without matches bare names only, so an allow
+ *              rule for "git" does not admit "./git" or "sub/git". Deny
+ *              rules without a separator also match the basename of a
+ *              path. Omitted = any command.
+ *   args=GLOB  Glob over the arguments joined with single spaces.
+ *   cwd=PATH   Working directory must be PATH or below it.
+ *   env=NAME   Request must set NAME; env=!NAME must not set it;
+ *              env=NAME=GLOB must set it to a matching value. Names
+ *              ignore case on Windows, as the variables themselves do.
+ *
+ * Globs support '*' (any run of bytes) and '?' (one byte).
+ *
+ * Decision: a matching deny rule always wins; otherwise the first matching
+ * allow rule in file order; otherwise the default action (deny).
+ */
+
+#pragma once
+
+#include <napi.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace TerminAI {
+
+// ============================================================================
+// Glob DFA
+// ============================================================================
+
+/**
+ * A glob pattern compiled to a DFA over byte equivalence classes.
+ */
+class GlobMatcher {
+public:
+    /** @return false if the pattern is empty */
+    bool Compile(const std::string& pattern);
+
+    bool Match(std::string_view input) const;
+
+    /** Bytes before the first wildcard. */
+    const std::string& LiteralPrefix() const { return literalPrefix_; }
+
+    /** True if the pattern has no wildcards at all. */
+    bool IsLiteral() const { return isLiteral_; }
+
+    const std::string& Pattern() const { return pattern_; }
+
+private:
+    enum class TokenKind : uint8_t { Literal, AnyByte, AnyRun };
+    struct Token {
+        TokenKind kind;
+        uint8_t byte;
+    };
+
+    bool SimulateNfa(std::string_view input) const;
+
+    std::string pattern_;
+    std::string literalPrefix_;
+    bool isLiteral_ = false;
+    std::vector<Token> tokens_;
+
+    // DFA: state 0 is the dead state, state 1 the start state.
+    uint8_t byteClass_[256] = {};
+    uint32_t classCount_ = 0;
+    std::vector<uint32_t> transitions_;
+    std::vector<bool> accepting_;
+    bool dfaBuilt_ = false;
+};
+
+// ============================================================================
+// Policy Types
+// ============================================================================
+
+struct PolicyRequest {
+    std::string command;
+    std::vector<std::string> args;
+    std::string cwd;
+    std::vector<std::pair<std::string, std::string>> env;
+};
+
+enum class PolicyAction : int32_t {
+    Allow = 0,
+    Deny = 1,
+    Default = 2,
+};
+
+struct PolicyDecision {
+    bool allowed = false;
+    PolicyAction action = PolicyAction::Default;
+    /** Rule ID that decided the request (empty for the default action) */
+    std::string ruleId;
+    /** Source line of the rule (0 for the default action) */
+    int line = 0;
+};
+
+class CompiledPolicy;
+
+/**
+ * Compile policy text. Returns nullptr and sets `error` (with the line
+ * number) if any rule is malformed; a policy is never partially applied.
+ */
+std::shared_ptr<const CompiledPolicy> CompilePolicy(const std::string& text, std::string& error);
+
+/** Evaluate a request against a compiled policy. */
+PolicyDecision EvaluatePolicy(const CompiledPolicy& policy, const PolicyRequest& request);
+
+/** Number of rules in a compiled policy. */
+size_t PolicyRuleCount(const CompiledPolicy& policy);
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+/**
+ * Load and activate a policy file, optionally watching it for changes.
+ * The previous policy stays active if the new file fails to compile; a
+ * watched file that fails to load is logged and read again every interval
+ * until it loads.
+ *
+ * Arguments:
+ *   0: String - Path to rule file
+ *   1: Object (optional) - { watchIntervalMs?: number } (0 = no watching)
+ *
+ * Returns: Object - { ok: Boolean, rules: Number, version: Number, error?: String }
+ */
+Napi::Value LoadCommandPolicy(const Napi::CallbackInfo& info);
+
+/**
+ * Compile and activate policy text directly (no file, no watching).
+ *
+ * Arguments:
+ *   0: String - Policy text
+ *
+ * Returns: Same as LoadCommandPolicy
+ */
+Napi::Value CompileCommandPolicy(const Napi::CallbackInfo& info);
+
+/**
+ * Evaluate an execute request against the active policy.
+ *
+ * Arguments:
+ *   0: Object - { command: String, args?: String[], cwd?: String,
+ *                 env?: Record<String, String> }
+ *
+ * Returns: Object
+ *   - allowed: Boolean
+ *   - action: 'allow' | 'deny' | 'default'
+ *   - ruleId: String | null
+ *   - line: Number
+ *   or null if no policy is loaded
+ */
+Napi::Value EvaluateCommandPolicy(const Napi::CallbackInfo& info);
+
+/**
+ * Describe the active policy.
+ *
+ * Returns: Object - { loaded, path, rules, version, evaluations,
+ *                     averageEvalNs, lastError }
+ */
+Napi::Value GetCommandPolicyInfo(const Napi::CallbackInfo& info);
+
+/**
+ * Deactivate the policy and stop watching its file.
+ */
+Napi::Value UnloadCommandPolicy(const Napi::CallbackInfo& info);
+
+} // namespace TerminAI
@@ -0,0 +1,1539 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Process Spawner Implementation
+ *
+ * Launches run on the JS thread (a posix_spawn or CreateProcessW call, as
+ * child_process does) and hand the process to the service thread, which
+ * owns it until it is delivered. Completion keys carry the process id and
+ * what became ready (stdout, stderr, exit, cancel), so one wait covers
+ * every process. Records hold JS references (the promise, the signal
+ * listener) and are only released on the JS thread.
+ */
+
+#include "process_spawner.h"
+
+#if defined(__linux__) || defined(_WIN32)
+
+#include "cancellation.h"
+#include "resource_governor.h"
+
+#ifdef __linux__
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+#else
+#include "appcontainer_manager.h"
+
+#include <cwctype>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace TerminAI {
+
+namespace {
+
+constexpr size_t kDefaultMaxOutput = 64 * 1024 * 1024;
+constexpr size_t kReadChunk = 64 * 1024;
+/** Reads per pipe per wakeup, so one chatty process cannot starve the rest */
+constexpr int kReadsPerWakeup = 16;
+/** Reads per pipe once its process has exited (what is left in the pipe) */
+constexpr int kReadsAfterExit = 64;
+constexpr int kMaxEvents = 64;
+
+/** Timer wheel: 512 slots of 10 ms, one revolution every 5.12 s */
+constexpr int64_t kTickMs = 10;
+constexpr uint64_t kWheelSlots = 512;
+
+/** Completion keys: process id << 2 | kind. Ids start at 1; 0 wakes the thread. */
+constexpr uint64_t kWakeKey = 0;
+enum KeyKind : uint64_t { kStdout = 0, kStderr = 1, kExit = 2, kCancel = 3 };
+
+Napi::Value RejectedPromise(Napi::Env env, const std::string& message) {
+    auto deferred = Napi::Promise::Deferred::New(env);
+    deferred.Reject(Napi::TypeError::New(env, message).Value());
+    return deferred.Promise();
+}
+
+// ============================================================================
+// Base Environment
+// ============================================================================
+
+#ifdef __linux__
+using EnvString = std::string;
+#else
+using EnvString = std::wstring;
+#endif
+
+struct BaseEnvironment {
+    /** "NAME=value" */
+    std::vector<EnvString> entries;
+    /** Name (upper-cased on Windows, where names ignore case) -> entry */
+    std::unordered_map<EnvString, size_t> index;
+#ifdef __linux__
+    /** Every entry, then null: the envp of a launch without variables of its own */
+    std::vector<char*> pointers;
+#else
+    /** Sorted CREATE_UNICODE_ENVIRONMENT block of a launch without variables of its own */
+    std::wstring block;
+#endif
+};
+using BaseEnvironmentPtr = std::shared_ptr<const BaseEnvironment>;
+
+EnvString KeyOf(const EnvString& entry) {
+    // From 1: Windows keeps per-drive directories in names like "=C:".
+    EnvString key = entry.substr(0, entry.find(static_cast<EnvString::value_type>('='), 1));
+#ifdef _WIN32
+    for (auto& c : key) c = static_cast<wchar_t>(std::towupper(c));
+#endif
+    return key;
+}
+
+#ifdef _WIN32
+bool EntryLess(const std::wstring* a, const std::wstring* b) {
+    return _wcsicmp(a->c_str(), b->c_str()) < 0;
+}
+
+std::wstring JoinBlock(const std::vector<const std::wstring*>& entries) {
+    size_t length = 2;
+    for (const auto* entry : entries) length += entry->size() + 1;
+    std::wstring block;
+    block.reserve(length);
+    for (const auto* entry : entries) {
+        block += *entry;
+        block.push_back(L'\0');
+    }
+    // An empty block still needs its two terminators.
+    if (entries.empty()) block.push_back(L'\0');
+    block.push_back(L'\0');
+    return block;
+}
+#endif
+
+BaseEnvironmentPtr BuildBase(std::vector<EnvString> entries) {
+    auto base = std::make_shared<BaseEnvironment>();
+    base->entries = std::move(entries);
+#ifdef _WIN32
+    std::sort(base->entries.begin(), base->entries.end(),
+              [](const std::wstring& a, const std::wstring& b) { return EntryLess(&a, &b); });
+#endif
+    for (size_t i = 0; i < base->entries.size(); i++) {
+        base->index.emplace(KeyOf(base->entries[i]), i);
+    }
+#ifdef __linux__
+    base->pointers.reserve(base->entries.size() + 1);
+    for (auto& entry : base->entries) base->pointers.push_back(const_cast<char*>(entry.c_str()));
+    base->pointers.push_back(nullptr);
+#else
+    std::vector<const std::wstring*> sorted;
+    sorted.reserve(base->entries.size());
+    for (const auto& entry : base->entries) sorted.push_back(&entry);
+    base->block = JoinBlock(sorted);
+#endif
+    return base;
+}
+
+std::vector<EnvString> HostEnvironment() {
+    std::vector<EnvString> entries;
+#ifdef __linux__
+    for (char** var = environ; *var != nullptr; var++) entries.emplace_back(*var);
+#else
+    LPWCH strings = GetEnvironmentStringsW();
+    if (strings != nullptr) {
+        for (LPWCH var = strings; *var != L'\0'; var += wcslen(var) + 1) entries.emplace_back(var);
+        FreeEnvironmentStringsW(strings);
+    }
+#endif
+    return entries;
+}
+
+EnvString ToEnvString(const std::string& utf8) {
+#ifdef __linux__
+    return utf8;
+#else
+    return Utf8ToWide(utf8);
+#endif
+}
+
+std::mutex g_baseMutex;
+BaseEnvironmentPtr g_base;
+
+/** The base of the next launch, captured from the host on first use. */
+BaseEnvironmentPtr CurrentBase() {
+    std::lock_guard<std::mutex> lock(g_baseMutex);
+    if (!g_base) g_base = BuildBase(HostEnvironment());
+    return g_base;
+}
+
+using EnvOverrides = std::vector<std::pair<std::string, std::string>>;
+
+#ifdef __linux__
+/**
+ * The envp of one launch: the base's pointers with `overrides` swapped in
+ * or appended. New strings live in `storage`.
+ */
+std::vector<char*> ApplyOverrides(const BaseEnvironment& base, const EnvOverrides& overrides,
+                                  std::vector<std::string>& storage) {
+    std::vector<char*> envp(base.pointers);
+    storage.reserve(overrides.size()); // No reallocation: envp points into it
+    for (const auto& [name, value] : overrides) {
+        storage.push_back(name + "=" + value);
+        char* entry = storage.back().data();
+        auto it = base.index.find(name);
+        if (it != base.index.end()) {
+            envp[it->second] = entry;
+        } else {
+            envp.insert(envp.end() - 1, entry);
+        }
+    }
+    return envp;
+}
+
+/**
+ * Resolve a bare command against the base environment's PATH. A PATH the
+ * call sets only reaches the child: otherwise it would choose the binary
+ * the policy approved by name. Empty and relative entries are skipped,
+ * since they would be checked here against our directory but resolved
+ * by the child against its own.
+ */
+std::string ResolveExecutable(const std::string& command, const BaseEnvironment& base) {
+    if (command.find('/') != std::string::npos) return command;
+
+    std::string path = "/usr/local/bin:/usr/bin:/bin";
+    auto it = base.index.find("PATH");
+    if (it != base.index.end()) path = base.entries[it->second].substr(5);
+
+    std::istringstream dirs(path);
+    std::string dir;
+    while (std::getline(dirs, dir, ':')) {
+        if (dir.empty() || dir[0] != '/') continue;
+        std::string candidate = dir + "/" + command;
+        if (access(candidate.c_str(), X_OK) == 0) return candidate;
+    }
+    return command;
+}
+#else
+/** The sorted block of one launch: the base with `overrides` swapped in or added. */
+std::wstring ApplyOverrides(const BaseEnvironment& base, const EnvOverrides& overrides) {
+    std::vector<std::wstring> added;
+    added.reserve(overrides.size()); // No reallocation: entries points into it
+    std::vector<const std::wstring*> entries;
+    entries.reserve(base.entries.size() + overrides.size());
+    for (const auto& entry : base.entries) entries.push_back(&entry);
+
+    bool appended = false;
+    for (const auto& [name, value] : overrides) {
+        added.push_back(Utf8ToWide(name + "=" + value));
+        auto it = base.index.find(KeyOf(added.back()));
+        if (it != base.index.end()) {
+            entries[it->second] = &added.back();
+        } else {
+            entries.push_back(&added.back());
+            appended = true;
+        }
+    }
+    if (appended) std::sort(entries.begin(), entries.end(), EntryLess);
+    return JoinBlock(entries);
+}
+
+/**
+ * The image a bare command runs: searched on the base environment's PATH,
+ * absolute entries only, with .exe added to a name without an extension
+ * as CreateProcessW does. Anything else is returned as given.
+ */
+std::wstring ResolveExecutable(const std::wstring& command, const BaseEnvironment& base) {
+    auto it = base.index.find(L"PATH");
+    if (command.find_first_of(L"\\/:") != std::wstring::npos || it == base.index.end()) {
+        return command;
+    }
+    std::wstring file = command;
+    if (file.find(L'.') == std::wstring::npos) file += L".exe";
+
+    std::wstring path = base.entries[it->second].substr(5);
+    for (size_t start = 0; start <= path.size();) {
+        size_t end = std::min(path.find(L';', start), path.size());
+        std::wstring dir = path.substr(start, end - start);
+        start = end + 1;
+        if (dir.size() >= 2 && dir.front() == L'"' && dir.back() == L'"') {
+            dir = dir.substr(1, dir.size() - 2);
+        }
+        bool drive = dir.size() >= 3 && dir[1] == L':' && (dir[2] == L'\\' || dir[2] == L'/');
+        if (!drive && dir.rfind(L"\\\\", 0) != 0) continue;
+        if (dir.back() != L'\\' && dir.back() != L'/') dir.push_back(L'\\');
+        std::wstring candidate = dir + file;
+        DWORD attributes = GetFileAttributesW(candidate.c_str());
+        if (attributes != INVALID_FILE_ATTRIBUTES && !(attributes & FILE_ATTRIBUTE_DIRECTORY)) {
+            return candidate;
+        }
+    }
+    return command;
+}
+
+/** Whether `image` ends in .bat or .cmd once Windows drops trailing dots and spaces. */
+bool IsBatchFile(std::wstring image) {
+    while (!image.empty() && (image.back() == L'.' || image.back() == L' ')) image.pop_back();
+    if (image.size() < 4) return false;
+    const wchar_t* extension = image.c_str() + image.size() - 4;
+    return _wcsicmp(extension, L".bat") == 0 || _wcsicmp(extension, L".cmd") == 0;
+}
+#endif
+
+// ============================================================================
+// Timer Wheel
+// ============================================================================
+
+/**
+ * Hashed timing wheel. A timer sits in slot `deadline % kWheelSlots`;
+ * deadlines more than one revolution out stay in their slot until a pass
+ * reaches them. Slots hold a handful of timers, so disarming scans one.
+ */
+class TimerWheel {
+public:
+    void Start(uint64_t tick) { current_ = tick; }
+
+    /** @return the tick the timer was armed for (never the current one) */
+    uint64_t Arm(uint64_t id, uint64_t deadline) {
+        deadline = std::max(deadline, current_ + 1);
+        slots_[deadline % kWheelSlots].push_back({id, deadline});
+        armed_++;
+        return deadline;
+    }
+
+    void Disarm(uint64_t id, uint64_t deadline) {
+        auto& slot = slots_[deadline % kWheelSlots];
+        for (size_t i = 0; i < slot.size(); i++) {
+            if (slot[i].id != id) continue;
+            slot[i] = slot.back();
+            slot.pop_back();
+            armed_--;
+            return;
+        }
+    }
+
+    /** Fire every timer due by `tick`. Each slot is visited at most once. */
+    template <typename Fire>
+    void Advance(uint64_t tick, Fire&& fire) {
+        if (tick <= current_) return;
+        uint64_t steps = std::min<uint64_t>(tick - current_, kWheelSlots);
+        for (uint64_t step = 1; step <= steps; step++) {
+            auto& slot = slots_[(current_ + step) % kWheelSlots];
+            for (size_t i = 0; i < slot.size();) {
+                if (slot[i].deadline > tick) {
+                    i++;
+                    continue;
+                }
+                uint64_t id = slot[i].id;
+                slot[i] = slot.back();
+                slot.pop_back();
+                armed_--;
+                fire(id);
+            }
+        }
+        current_ = tick;
+    }
+
+    /**
+     * The first tick whose slot holds a timer: a lower bound for the next
+     * deadline (the timer may be due a revolution later). 0 = none armed.
+     */
+    uint64_t NextDue() const {
+        if (armed_ == 0) return 0;
+        for (uint64_t step = 1; step <= kWheelSlots; step++) {
+            if (!slots_[(current_ + step) % kWheelSlots].empty()) return current_ + step;
+        }
+        return 0;
+    }
+
+    size_t Armed() const { return armed_; }
+
+private:
+    struct Timer {
+        uint64_t id;
+        uint64_t deadline;
+    };
+
+    std::vector<Timer> slots_[kWheelSlots];
+    uint64_t current_ = 0;
+    size_t armed_ = 0;
+};
+
+// ============================================================================
+// Processes
+// ============================================================================
+
+struct SpawnRequest {
+    std::string command;
+    std::vector<std::string> args;
+    std::string cwd;
+    EnvOverrides env;
+};
+
+struct SpawnedProcess {
+    explicit SpawnedProcess(Napi::Env env)
+        : deferred(Napi::Promise::Deferred::New(env)),
+          cancel(CancellableOperation::SpawnProcess) {}
+
+    ~SpawnedProcess() { ClosePlatformHandles(); }
+
+    SpawnedProcess(const SpawnedProcess&) = delete;
+    SpawnedProcess& operator=(const SpawnedProcess&) = delete;
+
+    void ClosePlatformHandles();
+
+    uint64_t id = 0;
+    int64_t pid = 0;
+
+    // JS thread only
+    Napi::Promise::Deferred deferred;
+    CancelBinding cancel;
+
+    /** A signal was given: the service thread checks the token */
+    bool cancellable = false;
+    std::chrono::steady_clock::time_point started;
+    /** Timer wheel tick of the timeout; 0 = none, or it already fired */
+    uint64_t deadline = 0;
+    size_t maxOutput = kDefaultMaxOutput;
+
+    // Service thread until delivered
+    std::string output[2];
+    bool truncated = false;
+    bool timedOut = false;
+    /** The group was killed (timeout or signal) */
+    bool killed = false;
+    bool exited = false;
+    int exitCode = -1;
+    int signal = -1;
+    double durationMs = 0;
+
+#ifdef __linux__
+    int pipes[2] = {-1, -1};
+    int pidFd = -1;
+    /** The token's wake fd while it is in the epoll set */
+    int cancelFd = -1;
+#else
+    struct PipeRead {
+        HANDLE handle = nullptr;
+        OVERLAPPED overlapped = {};
+        std::unique_ptr<char[]> buffer;
+    };
+    PipeRead pipes[2];
+    HANDLE process = nullptr;
+    HANDLE wait = nullptr;
+    GovernedGroupPtr group;
+#endif
+};
+
+using SpawnedProcessPtr = std::shared_ptr<SpawnedProcess>;
+using Delivery = std::vector<SpawnedProcessPtr>;
+
+#ifdef __linux__
+void SpawnedProcess::ClosePlatformHandles() {
+    for (int& fd : pipes) {
+        if (fd >= 0) close(fd);
+        fd = -1;
+    }
+    if (pidFd >= 0) close(pidFd);
+    pidFd = -1;
+}
+#else
+void SpawnedProcess::ClosePlatformHandles() {
+    for (auto& pipe : pipes) {
+        if (pipe.handle != nullptr) CloseHandle(pipe.handle);
+        pipe.handle = nullptr;
+    }
+    if (process != nullptr) CloseHandle(process);
+    process = nullptr;
+}
+#endif
+
+void AppendOutput(SpawnedProcess& process, int stream, const char* data, size_t length) {
+    std::string& output = process.output[stream];
+    size_t room = process.maxOutput - std::min(process.maxOutput, output.size());
+    if (length > room) process.truncated = true;
+    output.append(data, std::min(length, room));
+}
+
+Napi::Object ResultToObject(Napi::Env env, const SpawnedProcess& process) {
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("pid", Napi::Number::New(env, static_cast<double>(process.pid)));
+    result.Set("exitCode",
+               process.exitCode >= 0 ? Napi::Number::New(env, process.exitCode) : env.Null());
+    result.Set("signal", process.signal >= 0 ? Napi::Number::New(env, process.signal) : env.Null());
+    result.Set("stdout", Napi::String::New(env, process.output[kStdout]));
+    result.Set("stderr", Napi::String::New(env, process.output[kStderr]));
+    result.Set("timedOut", Napi::Boolean::New(env, process.timedOut));
+    result.Set("truncated", Napi::Boolean::New(env, process.truncated));
+    result.Set("durationMs", Napi::Number::New(env, process.durationMs));
+    return result;
+}
+
+// ============================================================================
+// Launch
+// ============================================================================
+
+#ifdef __linux__
+
+bool StartProcess(SpawnedProcess& process, const SpawnRequest& request, std::string& error) {
+    BaseEnvironmentPtr base = CurrentBase();
+    std::vector<std::string> storage;
+    std::vector<char*> envp = ApplyOverrides(*base, request.env, storage);
+    std::string executable = ResolveExecutable(request.command, *base);
+
+    std::vector<char*> argv;
+    argv.reserve(request.args.size() + 2);
+    argv.push_back(const_cast<char*>(request.command.c_str()));
+    for (const auto& arg : request.args) argv.push_back(const_cast<char*>(arg.c_str()));
+    argv.push_back(nullptr);
+
+    // CLOEXEC from the start, so launches on other threads cannot inherit
+    // them; dup2 onto 1 and 2 clears the flag in the child.
+    int out[2] = {-1, -1};
+    int err[2] = {-1, -1};
+    if (pipe2(out, O_CLOEXEC) != 0 || pipe2(err, O_CLOEXEC) != 0) {
+        error = std::string("pipe2 failed: ") + strerror(errno);
+        for (int fd : {out[0], out[1]}) {
+            if (fd >= 0) close(fd);
+        }
+        return false;
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, 0, "/dev/null", O_RDONLY, 0);
+    posix_spawn_file_actions_adddup2(&actions, out[1], 1);
+    posix_spawn_file_actions_adddup2(&actions, err[1], 2);
+    if (!request.cwd.empty()) posix_spawn_file_actions_addchdir_np(&actions, request.cwd.c_str());
+
+    // Node ignores SIGPIPE and may block signals on this thread; the child
+    // starts with default dispositions and an empty mask, in a new group.
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    sigset_t none;
+    sigset_t all;
+    sigemptyset(&none);
+    sigfillset(&all);
+    posix_spawnattr_setsigmask(&attr, &none);
+    posix_spawnattr_setsigdefault(&attr, &all);
+    posix_spawnattr_setpgroup(&attr, 0);
+    posix_spawnattr_setflags(
+        &attr, POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+    pid_t pid = 0;
+    int result = posix_spawn(&pid, executable.c_str(), &actions, &attr, argv.data(), envp.data());
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
+    close(out[1]);
+    close(err[1]);
+
+    if (result != 0) {
+        close(out[0]);
+        close(err[0]);
+        error = "cannot start '" + request.command + "': " + strerror(result);
+        if (result == ENOENT && !request.cwd.empty() && access(request.cwd.c_str(), F_OK) != 0) {
+            error = "cannot start '" + request.command + "': no directory '" + request.cwd + "'";
+        }
+        return false;
+    }
+
+    for (int fd : {out[0], err[0]}) fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    process.pid = pid;
+    process.pipes[kStdout] = out[0];
+    process.pipes[kStderr] = err[0];
+    // Pre-5.3 kernels have no pidfd: the service thread polls those.
+    process.pidFd = static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+    return true;
+}
+
+#else // _WIN32
+
+/** Our overlapped end of an output pipe, and the child's inheritable end. */
+bool CreateOutputPipe(uint64_t id, int stream, HANDLE& server, HANDLE& client,
+                      std::string& error) {
+    // Anonymous pipes cannot do overlapped I/O, so each stream gets a
+    // uniquely named single-instance pipe.
+    std::wstring name = L"\\\\.\\pipe\\terminai-spawn-" + std::to_wstring(GetCurrentProcessId()) +
+                        L"-" + std::to_wstring(id) + L"-" + std::to_wstring(stream);
+    server = CreateNamedPipeW(name.c_str(),
+                              PIPE_ACCESS_INBOUND | FILE_FLAG_OVERLAPPED |
+                                  FILE_FLAG_FIRST_PIPE_INSTANCE,
+                              PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT |
+                                  PIPE_REJECT_REMOTE_CLIENTS,
+                              1, 0, static_cast<DWORD>(kReadChunk), 0, nullptr);
+    if (server == INVALID_HANDLE_VALUE) {
+        server = nullptr;
+        error = "CreateNamedPipe failed: " + GetWindowsErrorMessage(GetLastError());
+        return false;
+    }
+    SECURITY_ATTRIBUTES inherit = {sizeof(inherit), nullptr, TRUE};
+    client = CreateFileW(name.c_str(), GENERIC_WRITE, 0, &inherit, OPEN_EXISTING,
+                         FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (client == INVALID_HANDLE_VALUE) {
+        client = nullptr;
+        error = "cannot open pipe: " + GetWindowsErrorMessage(GetLastError());
+        return false;
+    }
+    return true;
+}
+
+bool StartProcess(SpawnedProcess& process, const SpawnRequest& request, std::string& error) {
+    BaseEnvironmentPtr base = CurrentBase();
+    std::wstring command = Utf8ToWide(request.command);
+    std::wstring image = ResolveExecutable(command, *base);
+    // CreateProcessW hands these to cmd.exe, which parses the command line
+    // again with metacharacters (& | % ^) that QuoteArgument does not
+    // escape. As Node does, refuse them: callers run cmd.exe themselves.
+    if (IsBatchFile(image)) {
+        error = "cannot start '" + request.command + "': batch files must be run through cmd.exe";
+        return false;
+    }
+
+    std::wstring commandLine = QuoteArgument(command);
+    for (const auto& arg : request.args) {
+        commandLine.push_back(L' ');
+        commandLine += QuoteArgument(Utf8ToWide(arg));
+    }
+    std::vector<wchar_t> mutableCommandLine(commandLine.begin(), commandLine.end());
+    mutableCommandLine.push_back(L'\0');
+
+    std::wstring overridden;
+    if (!request.env.empty()) overridden = ApplyOverrides(*base, request.env);
+    const std::wstring& environment = request.env.empty() ? base->block : overridden;
+    std::wstring cwd = Utf8ToWide(request.cwd);
+
+    HANDLE clients[2] = {nullptr, nullptr};
+    HANDLE input = nullptr;
+    auto closeInherited = [&]() {
+        for (HANDLE handle : {clients[0], clients[1], input}) {
+            if (handle != nullptr) CloseHandle(handle);
+        }
+    };
+    for (int stream : {kStdout, kStderr}) {
+        if (!CreateOutputPipe(process.id, stream, process.pipes[stream].handle, clients[stream],
+                              error)) {
+            closeInherited();
+            return false;
+        }
+        process.pipes[stream].buffer.reset(new char[kReadChunk]);
+    }
+    SECURITY_ATTRIBUTES inherit = {sizeof(inherit), nullptr, TRUE};
+    input = CreateFileW(L"NUL", GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, &inherit,
+                        OPEN_EXISTING, 0, nullptr);
+    if (input == INVALID_HANDLE_VALUE) {
+        input = nullptr;
+        error = "cannot open NUL: " + GetWindowsErrorMessage(GetLastError());
+        closeInherited();
+        return false;
+    }
+
+    // Only these three are inherited, whatever else is inheritable while
+    // another thread is launching.
+    HANDLE inherited[3] = {input, clients[0], clients[1]};
+    SIZE_T attrListSize = 0;
+    InitializeProcThreadAttributeList(nullptr, 1, 0, &attrListSize);
+    std::vector<BYTE> attrListBuffer(attrListSize);
+    auto attrList = reinterpret_cast<LPPROC_THREAD_ATTRIBUTE_LIST>(attrListBuffer.data());
+    if (!InitializeProcThreadAttributeList(attrList, 1, 0, &attrListSize) ||
+        !UpdateProcThreadAttribute(attrList, 0, PROC_THREAD_ATTRIBUTE_HANDLE_LIST, inherited,
+                                   sizeof(inherited), nullptr, nullptr)) {
+        error = "cannot set up inherited handles: " + GetWindowsErrorMessage(GetLastError());
+        closeInherited();
+        return false;
+    }
+
+    std::vector<std::string> unsupported;
+    process.group = CreateGovernedGroup(ResourceLimits{}, unsupported, error);
+    if (!process.group) {
+        DeleteProcThreadAttributeList(attrList);
+        closeInherited();
+        return false;
+    }
+
+    STARTUPINFOEXW si = {};
+    si.StartupInfo.cb = sizeof(si);
+    si.StartupInfo.dwFlags = STARTF_USESTDHANDLES;
+    si.StartupInfo.hStdInput = input;
+    si.StartupInfo.hStdOutput = clients[kStdout];
+    si.StartupInfo.hStdError = clients[kStderr];
+    si.lpAttributeList = attrList;
+
+    PROCESS_INFORMATION pi = {};
+    BOOL created = CreateProcessW(
+        image == command ? nullptr : image.c_str(), mutableCommandLine.data(), nullptr, nullptr,
+        TRUE,
+        EXTENDED_STARTUPINFO_PRESENT | CREATE_UNICODE_ENVIRONMENT | CREATE_SUSPENDED |
+            CREATE_NO_WINDOW,
+        const_cast<wchar_t*>(environment.c_str()), cwd.empty() ? nullptr : cwd.c_str(),
+        reinterpret_cast<LPSTARTUPINFOW>(&si), &pi);
+    DWORD createError = GetLastError();
+    DeleteProcThreadAttributeList(attrList);
+    closeInherited();
+
+    if (!created) {
+        error = "cannot start '" + request.command + "': " + GetWindowsErrorMessage(createError);
+        return false;
+    }
+    if (!AssignProcessToJobObject(GovernedGroupJob(*process.group), pi.hProcess)) {
+        error = "AssignProcessToJobObject failed: " + GetWindowsErrorMessage(GetLastError());
+        TerminateProcess(pi.hProcess, 1);
+        CloseHandle(pi.hThread);
+        CloseHandle(pi.hProcess);
+        return false;
+    }
+    RegisterGovernedProcess(pi.dwProcessId, process.group);
+    ResumeThread(pi.hThread);
+    CloseHandle(pi.hThread);
+
+    process.pid = pi.dwProcessId;
+    process.process = pi.hProcess;
+    return true;
+}
+
+#endif // _WIN32
+
+// ============================================================================
+// Spawner
+// ============================================================================
+
+struct SpawnCounters {
+    std::atomic<uint64_t> spawned{0};
+    std::atomic<uint64_t> failed{0};
+    std::atomic<int64_t> running{0};
+    std::atomic<uint64_t> exited{0};
+    std::atomic<uint64_t> timedOut{0};
+    std::atomic<uint64_t> aborted{0};
+    std::atomic<uint64_t> wakeups{0};
+    std::atomic<uint64_t> deliveries{0};
+    std::atomic<uint64_t> largestDelivery{0};
+    std::atomic<uint64_t> timers{0};
+};
+
+class ProcessSpawner {
+public:
+    static ProcessSpawner& Instance() {
+        // Leaked on purpose: the service thread must not be joined from a
+        // static destructor during process exit.
+        static ProcessSpawner* spawner = new ProcessSpawner();
+        return *spawner;
+    }
+
+    /** Start the service thread and the delivery function (JS thread, first launch). */
+    bool Ensure(Napi::Env env, std::string& error);
+
+    uint64_t NextId() { return ++lastId_; }
+
+    /** The wheel tick `timeoutMs` from now, rounded up. */
+    uint64_t DeadlineTick(int64_t timeoutMs) const {
+        return static_cast<uint64_t>((ElapsedMs() + timeoutMs + kTickMs - 1) / kTickMs);
+    }
+
+    /** Hand a launched process to the service thread (JS thread). */
+    void Adopt(Napi::Env env, SpawnedProcessPtr process) {
+        // Pending processes keep the event loop alive, as child_process does.
+        if (active_++ == 0) tsfn_.Ref(env);
+        {
+            std::lock_guard<std::mutex> lock(incomingMutex_);
+            incoming_.push_back(std::move(process));
+        }
+        Wake();
+    }
+
+    SpawnCounters& Counters() { return counters_; }
+
+private:
+    ProcessSpawner() = default;
+
+    int64_t ElapsedMs() const {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now() - epoch_)
+            .count();
+    }
+
+    uint64_t NowTick() const { return static_cast<uint64_t>(ElapsedMs() / kTickMs); }
+
+    SpawnedProcess* Find(uint64_t id) {
+        auto it = records_.find(id);
+        return it == records_.end() ? nullptr : it->second.get();
+    }
+
+    /**
+     * How long the service thread may sleep: until the next occupied wheel
+     * slot, and one tick at a time while something has to be polled.
+     */
+    int WaitTimeoutMs() const {
+        bool poll = !unwatched_.empty() || polledCancels_ > 0;
+        uint64_t due = wheel_.NextDue();
+        if (due == 0) return poll ? static_cast<int>(kTickMs) : -1;
+        int64_t ms = std::max<int64_t>(0, static_cast<int64_t>(due) * kTickMs - ElapsedMs());
+        if (poll) ms = std::min<int64_t>(ms, kTickMs);
+        return static_cast<int>(std::min<int64_t>(ms, INT32_MAX));
+    }
+
+    void Run();
+    void Wake();
+    void AdoptIncoming();
+    void Kill(SpawnedProcess& process);
+    /** Timeouts, signals and polled exits after a wakeup's events. */
+    void CheckDeadlines(std::vector<uint64_t>& candidates);
+    /** Reap, collect the rest of the output, and take the record out. */
+    SpawnedProcessPtr Finish(uint64_t id);
+    void Forget(SpawnedProcess& process);
+    void Deliver(Delivery finished);
+    /** Resolves everything in pending_ (the call's data is unused). */
+    static void OnDelivery(Napi::Env env, Napi::Function, Delivery*);
+
+    std::chrono::steady_clock::time_point epoch_ = std::chrono::steady_clock::now();
+    std::once_flag started_;
+    bool ready_ = false;
+    std::string startError_;
+
+    // JS thread
+    Napi::ThreadSafeFunction tsfn_;
+    uint64_t lastId_ = 0;
+    size_t active_ = 0;
+
+    std::mutex incomingMutex_;
+    std::vector<SpawnedProcessPtr> incoming_;
+
+    /** Finished processes waiting for the queued delivery call */
+    std::mutex pendingMutex_;
+    Delivery pending_;
+
+    // Service thread
+    std::unordered_map<uint64_t, SpawnedProcessPtr> records_;
+    TimerWheel wheel_;
+    /** Processes with a signal, and those whose token cannot wake us */
+    std::vector<uint64_t> cancellable_;
+    size_t polledCancels_ = 0;
+    /** Processes without an exit notification (checked every tick) */
+    std::vector<uint64_t> unwatched_;
+
+    SpawnCounters counters_;
+
+#ifdef __linux__
+    bool Watch(int fd, uint64_t id, uint64_t kind, uint32_t flags = 0);
+    void Unwatch(int fd);
+    /** @return false at end of file (the pipe is closed) */
+    bool ReadOutput(SpawnedProcess& process, int stream, int maxReads);
+
+    int epoll_ = -1;
+    int wakeFd_ = -1;
+    char scratch_[kReadChunk];
+#else
+    bool IssueRead(SpawnedProcess& process, int stream);
+    void OnRead(SpawnedProcess& process, int stream, const OVERLAPPED_ENTRY& entry);
+    static VOID CALLBACK OnProcessExit(PVOID context, BOOLEAN timedOut);
+
+    HANDLE port_ = nullptr;
+#endif
+};
+
+bool ProcessSpawner::Ensure(Napi::Env env, std::string& error) {
+    std::call_once(started_, [this, env]() {
+#ifdef __linux__
+        epoll_ = epoll_create1(EPOLL_CLOEXEC);
+        wakeFd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (epoll_ < 0 || wakeFd_ < 0 || !Watch(wakeFd_, 0, kWakeKey)) {
+            startError_ = std::string("cannot start the spawn service: ") + strerror(errno);
+            return;
+        }
+#else
+        port_ = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+        if (port_ == nullptr) {
+            startError_ = "cannot start the spawn service: " +
+                          GetWindowsErrorMessage(GetLastError());
+            return;
+        }
+#endif
+        // The callback is never called: deliveries run their own.
+        Napi::Function noop =
+            Napi::Function::New(env, [](const Napi::CallbackInfo& info) -> Napi::Value {
+                return info.Env().Undefined();
+            });
+        tsfn_ = Napi::ThreadSafeFunction::New(env, noop, "ProcessSpawner", 0, 1);
+        tsfn_.Unref(env);
+        wheel_.Start(NowTick());
+        std::thread([this]() { Run(); }).detach();
+        ready_ = true;
+    });
+    error = startError_;
+    return ready_;
+}
+
+void ProcessSpawner::Kill(SpawnedProcess& process) {
+    if (process.killed || process.exited) return;
+    process.killed = true;
+#ifdef __linux__
+    // The leader is not reaped before Finish(), so its group id is still ours.
+    kill(-static_cast<pid_t>(process.pid), SIGKILL);
+#else
+    TerminateJobObject(GovernedGroupJob(*process.group), 1);
+#endif
+}
+
+void ProcessSpawner::CheckDeadlines(std::vector<uint64_t>& candidates) {
+    wheel_.Advance(NowTick(), [this](uint64_t id) {
+        SpawnedProcess* process = Find(id);
+        if (process == nullptr) return;
+        process->deadline = 0;
+        if (process->exited) return;
+        process->timedOut = true;
+        Kill(*process);
+    });
+
+    for (uint64_t id : cancellable_) {
+        SpawnedProcess* process = Find(id);
+        // Stopped() latches: only ask while the answer can still change the result.
+        if (process == nullptr || process->killed || process->exited) continue;
+        if (process->cancel.Token()->Stopped()) {
+            Kill(*process);
+        }
+    }
+
+    for (uint64_t id : unwatched_) {
+        SpawnedProcess* process = Find(id);
+        if (process == nullptr || process->exited) continue;
+#ifdef __linux__
+        siginfo_t info = {};
+        bool done = waitid(P_PID, static_cast<id_t>(process->pid), &info,
+                           WEXITED | WNOHANG | WNOWAIT) == 0 &&
+                    info.si_pid != 0;
+#else
+        bool done = WaitForSingleObject(process->process, 0) == WAIT_OBJECT_0;
+        if (done) TerminateJobObject(GovernedGroupJob(*process->group), 1);
+#endif
+        if (done) {
+            process->exited = true;
+            candidates.push_back(id);
+        }
+    }
+    counters_.timers.store(wheel_.Armed(), std::memory_order_relaxed);
+}
+
+void ProcessSpawner::Forget(SpawnedProcess& process) {
+    uint64_t id = process.id;
+    if (process.deadline != 0) wheel_.Disarm(id, process.deadline);
+    process.deadline = 0;
+    auto drop = [id](std::vector<uint64_t>& ids) {
+        auto it = std::find(ids.begin(), ids.end(), id);
+        if (it == ids.end()) return false;
+        *it = ids.back();
+        ids.pop_back();
+        return true;
+    };
+    if (drop(cancellable_)) {
+#ifdef __linux__
+        if (process.cancelFd < 0) polledCancels_--;
+#else
+        polledCancels_--;
+#endif
+    }
+    drop(unwatched_);
+    counters_.timers.store(wheel_.Armed(), std::memory_order_relaxed);
+}
+
+void ProcessSpawner::Deliver(Delivery finished) {
+    {
+        // While a call is queued and the JS thread has not run it, later
+        // exits join its batch instead of queueing calls of their own.
+        std::lock_guard<std::mutex> lock(pendingMutex_);
+        bool queued = !pending_.empty();
+        pending_.insert(pending_.end(), std::make_move_iterator(finished.begin()),
+                        std::make_move_iterator(finished.end()));
+        if (queued) return;
+    }
+    if (tsfn_.BlockingCall(static_cast<Delivery*>(nullptr), &ProcessSpawner::OnDelivery) !=
+        napi_ok) {
+        // The environment is shutting down. The records hold JS references
+        // that can only be released on its thread, so they are left behind.
+        std::cerr << "[ProcessSpawner] cannot deliver finished processes" << std::endl;
+    }
+}
+
+void ProcessSpawner::OnDelivery(Napi::Env env, Napi::Function, Delivery*) {
+    ProcessSpawner& spawner = Instance();
+    Delivery batch;
+    {
+        std::lock_guard<std::mutex> lock(spawner.pendingMutex_);
+        batch.swap(spawner.pending_);
+    }
+
+    SpawnCounters& counters = spawner.counters_;
+    counters.deliveries++;
+    if (batch.size() > counters.largestDelivery.load()) counters.largestDelivery = batch.size();
+
+    for (const auto& process : batch) {
+        process->cancel.Finish();
+        if (process->cancel.Stopped()) {
+            process->deferred.Reject(process->cancel.StoppedError(env));
+        } else {
+            process->deferred.Resolve(ResultToObject(env, *process));
+        }
+    }
+    spawner.active_ -= batch.size();
+    if (spawner.active_ == 0) spawner.tsfn_.Unref(env);
+}
+
+#ifdef __linux__
+
+// ============================================================================
+// Linux: epoll + pidfd
+// ============================================================================
+
+bool ProcessSpawner::Watch(int fd, uint64_t id, uint64_t kind, uint32_t flags) {
+    epoll_event event = {};
+    event.events = EPOLLIN | flags;
+    event.data.u64 = id == 0 ? kWakeKey : (id << 2 | kind);
+    return epoll_ctl(epoll_, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+void ProcessSpawner::Unwatch(int fd) {
+    // Closing is not enough: a child being spawned on the JS thread holds a
+    // copy of every descriptor until it execs, and the set reports the
+    // description (not the number) until the last copy is gone.
+    epoll_ctl(epoll_, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+void ProcessSpawner::Wake() {
+    uint64_t one = 1;
+    ssize_t ignored = write(wakeFd_, &one, sizeof(one));
+    (void)ignored;
+}
+
+void ProcessSpawner::AdoptIncoming() {
+    std::vector<SpawnedProcessPtr> incoming;
+    {
+        std::lock_guard<std::mutex> lock(incomingMutex_);
+        incoming.swap(incoming_);
+    }
+    for (auto& process : incoming) {
+        uint64_t id = process->id;
+        Watch(process->pipes[kStdout], id, kStdout);
+        Watch(process->pipes[kStderr], id, kStderr);
+        if (process->pidFd < 0 || !Watch(process->pidFd, id, kExit)) unwatched_.push_back(id);
+        if (process->deadline != 0) process->deadline = wheel_.Arm(id, process->deadline);
+        if (process->cancellable) {
+            // One-shot: the token's eventfd stays readable once cancelled.
+            int fd = process->cancel.Token()->WakeFd();
+            if (fd >= 0 && Watch(fd, id, kCancel, EPOLLONESHOT)) {
+                process->cancelFd = fd;
+            } else {
+                polledCancels_++;
+            }
+            cancellable_.push_back(id);
+        }
+        records_[id] = std::move(process);
+    }
+}
+
+bool ProcessSpawner::ReadOutput(SpawnedProcess& process, int stream, int maxReads) {
+    int& fd = process.pipes[stream];
+    if (fd < 0) return false;
+    for (int reads = 0; reads < maxReads;) {
+        ssize_t n = read(fd, scratch_, sizeof(scratch_));
+        if (n > 0) {
+            AppendOutput(process, stream, scratch_, static_cast<size_t>(n));
+            reads++;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && errno == EAGAIN) return true;
+        Unwatch(fd);
+        close(fd);
+        fd = -1;
+        return false;
+    }
+    return true;
+}
+
+SpawnedProcessPtr ProcessSpawner::Finish(uint64_t id) {
+    auto it = records_.find(id);
+    SpawnedProcessPtr process = std::move(it->second);
+    records_.erase(it);
+    Forget(*process);
+
+    // What the command left running goes with it. Its group id cannot have
+    // been reused: the leader is a zombie until the waitpid below.
+    pid_t pid = static_cast<pid_t>(process->pid);
+    kill(-pid, SIGKILL);
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+    if (WIFEXITED(status)) process->exitCode = WEXITSTATUS(status);
+    if (WIFSIGNALED(status)) process->signal = WTERMSIG(status);
+
+    // Everything the command wrote is in the pipes by now. Descendants that
+    // left the group may hold them open, so stop at what is there.
+    for (int stream : {kStdout, kStderr}) {
+        if (ReadOutput(*process, stream, kReadsAfterExit)) Unwatch(process->pipes[stream]);
+    }
+    for (int fd : {process->pidFd, process->cancelFd}) {
+        if (fd >= 0) Unwatch(fd);
+    }
+    process->cancelFd = -1;
+    process->ClosePlatformHandles();
+
+    process->durationMs = std::chrono::duration<double, std::milli>(
+                              std::chrono::steady_clock::now() - process->started)
+                              .count();
+    counters_.running--;
+    counters_.exited++;
+    if (process->timedOut) counters_.timedOut++;
+    if (process->killed && !process->timedOut) counters_.aborted++;
+    return process;
+}
+
+void ProcessSpawner::Run() {
+    epoll_event events[kMaxEvents];
+    std::vector<uint64_t> candidates;
+    for (;;) {
+        int ready = epoll_wait(epoll_, events, kMaxEvents, WaitTimeoutMs());
+        if (ready < 0) {
+            if (errno != EINTR) {
+                std::cerr << "[ProcessSpawner] epoll_wait failed: " << strerror(errno)
+                          << std::endl;
+                std::this_thread::sleep_for(std::chrono::milliseconds(kTickMs));
+            }
+            ready = 0;
+        }
+        counters_.wakeups++;
+
+        candidates.clear();
+        for (int i = 0; i < ready; i++) {
+            uint64_t key = events[i].data.u64;
+            if (key == kWakeKey) {
+                uint64_t count;
+                ssize_t ignored = read(wakeFd_, &count, sizeof(count));
+                (void)ignored;
+                AdoptIncoming();
+                continue;
+            }
+            SpawnedProcess* process = Find(key >> 2);
+            if (process == nullptr) continue;
+            switch (key & 3) {
+                case kStdout:
+                case kStderr:
+                    ReadOutput(*process, static_cast<int>(key & 3), kReadsPerWakeup);
+                    break;
+                case kExit:
+                    process->exited = true;
+                    candidates.push_back(process->id);
+                    break;
+                default:
+                    break; // kCancel: the token is checked below
+            }
+        }
+        CheckDeadlines(candidates);
+
+        if (candidates.empty()) continue;
+        Delivery finished;
+        finished.reserve(candidates.size());
+        for (uint64_t id : candidates) finished.push_back(Finish(id));
+        Deliver(std::move(finished));
+    }
+}
+
+#else // _WIN32
+
+// ============================================================================
+// Windows: I/O completion port
+// ============================================================================
+
+void ProcessSpawner::Wake() {
+    PostQueuedCompletionStatus(port_, 0, kWakeKey, nullptr);
+}
+
+VOID CALLBACK ProcessSpawner::OnProcessExit(PVOID context, BOOLEAN) {
+    PostQueuedCompletionStatus(Instance().port_, 0, reinterpret_cast<ULONG_PTR>(context), nullptr);
+}
+
+bool ProcessSpawner::IssueRead(SpawnedProcess& process, int stream) {
+    auto& pipe = process.pipes[stream];
+    pipe.overlapped = {};
+    // Completes through the port either way (synchronous successes too).
+    if (ReadFile(pipe.handle, pipe.buffer.get(), static_cast<DWORD>(kReadChunk), nullptr,
+                 &pipe.overlapped) ||
+        GetLastError() == ERROR_IO_PENDING) {
+        return true;
+    }
+    CloseHandle(pipe.handle); // ERROR_BROKEN_PIPE: every writer is gone
+    pipe.handle = nullptr;
+    return false;
+}
+
+void ProcessSpawner::OnRead(SpawnedProcess& process, int stream, const OVERLAPPED_ENTRY& entry) {
+    auto& pipe = process.pipes[stream];
+    DWORD bytes = entry.dwNumberOfBytesTransferred;
+    if (bytes > 0) AppendOutput(process, stream, pipe.buffer.get(), bytes);
+    if (entry.lpOverlapped->Internal != 0) {
+        CloseHandle(pipe.handle);
+        pipe.handle = nullptr;
+        return;
+    }
+    IssueRead(process, stream);
+}
+
+void ProcessSpawner::AdoptIncoming() {
+    std::vector<SpawnedProcessPtr> incoming;
+    {
+        std::lock_guard<std::mutex> lock(incomingMutex_);
+        incoming.swap(incoming_);
+    }
+    for (auto& process : incoming) {
+        uint64_t id = process->id;
+        for (int stream : {kStdout, kStderr}) {
+            auto& pipe = process->pipes[stream];
+            if (CreateIoCompletionPort(pipe.handle, port_, id << 2 | stream, 0) == nullptr) {
+                CloseHandle(pipe.handle);
+                pipe.handle = nullptr;
+                continue;
+            }
+            IssueRead(*process, stream);
+        }
+        auto exitKey = reinterpret_cast<PVOID>(static_cast<ULONG_PTR>(id << 2 | kExit));
+        if (!RegisterWaitForSingleObject(&process->wait, process->process, OnProcessExit, exitKey,
+                                         INFINITE, WT_EXECUTEONLYONCE | WT_EXECUTEINWAITTHREAD)) {
+            process->wait = nullptr;
+            unwatched_.push_back(id);
+        }
+        if (process->deadline != 0) process->deadline = wheel_.Arm(id, process->deadline);
+        // No wake handle for the token: signals are checked every tick.
+        if (process->cancellable) {
+            cancellable_.push_back(id);
+            polledCancels_++;
+        }
+        records_[id] = std::move(process);
+    }
+}
+
+SpawnedProcessPtr ProcessSpawner::Finish(uint64_t id) {
+    auto it = records_.find(id);
+    SpawnedProcessPtr process = std::move(it->second);
+    records_.erase(it);
+    Forget(*process);
+
+    if (process->wait != nullptr) UnregisterWaitEx(process->wait, INVALID_HANDLE_VALUE);
+    process->wait = nullptr;
+    DWORD code = 0;
+    if (GetExitCodeProcess(process->process, &code)) process->exitCode = static_cast<int>(code);
+    process->ClosePlatformHandles();
+    // Drops the last reference to the Job Object (kill-on-close).
+    ReleaseGovernedProcess(process->pid);
+    process->group.reset();
+
+    process->durationMs = std::chrono::duration<double, std::milli>(
+                              std::chrono::steady_clock::now() - process->started)
+                              .count();
+    counters_.running--;
+    counters_.exited++;
+    if (process->timedOut) counters_.timedOut++;
+    if (process->killed && !process->timedOut) counters_.aborted++;
+    return process;
+}
+
+void ProcessSpawner::Run() {
+    OVERLAPPED_ENTRY entries[kMaxEvents];
+    std::vector<uint64_t> candidates;
+    for (;;) {
+        ULONG ready = 0;
+        int timeout = WaitTimeoutMs();
+        if (!GetQueuedCompletionStatusEx(port_, entries, kMaxEvents, &ready,
+                                         timeout < 0 ? INFINITE : static_cast<DWORD>(timeout),
+                                         FALSE)) {
+            ready = 0; // WAIT_TIMEOUT
+        }
+        counters_.wakeups++;
+
+        candidates.clear();
+        for (ULONG i = 0; i < ready; i++) {
+            uint64_t key = entries[i].lpCompletionKey;
+            if (key == kWakeKey) {
+                AdoptIncoming();
+                continue;
+            }
+            SpawnedProcess* process = Find(key >> 2);
+            if (process == nullptr) continue;
+            switch (key & 3) {
+                case kStdout:
+                case kStderr:
+                    OnRead(*process, static_cast<int>(key & 3), entries[i]);
+                    break;
+                case kExit:
+                    process->exited = true;
+                    // Leftover members go with the command, which also
+                    // breaks the pipes they held.
+                    TerminateJobObject(GovernedGroupJob(*process->group), 1);
+                    break;
+                default:
+                    break;
+            }
+            candidates.push_back(process->id);
+        }
+        CheckDeadlines(candidates);
+
+        // Done once exited and both pipes have reached end of file.
+        Delivery finished;
+        for (uint64_t id : candidates) {
+            SpawnedProcess* process = Find(id);
+            if (process == nullptr || !process->exited) continue;
+            if (process->pipes[kStdout].handle || process->pipes[kStderr].handle) continue;
+            finished.push_back(Finish(id));
+        }
+        if (!finished.empty()) Deliver(std::move(finished));
+    }
+}
+
+#endif // _WIN32
+
+// ============================================================================
+// Option Parsing
+// ============================================================================
+
+bool ReadSpawnRequest(const Napi::CallbackInfo& info, SpawnRequest& request, Napi::Object& options,
+                      std::string& error) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsString()) {
+        error = "spawnProcess expects a command";
+        return false;
+    }
+    request.command = info[0].As<Napi::String>().Utf8Value();
+    if (request.command.empty()) {
+        error = "spawnProcess expects a command";
+        return false;
+    }
+
+    if (info.Length() > 1 && !info[1].IsUndefined()) {
+        if (!info[1].IsArray()) {
+            error = "args must be an array of strings";
+            return false;
+        }
+        Napi::Array args = info[1].As<Napi::Array>();
+        request.args.reserve(args.Length());
+        for (uint32_t i = 0; i < args.Length(); i++) {
+            Napi::Value arg = args.Get(i);
+            if (!arg.IsString()) {
+                error = "args must be an array of strings";
+                return false;
+            }
+            request.args.push_back(arg.As<Napi::String>().Utf8Value());
+        }
+    }
+
+    options = Napi::Object::New(env);
+    if (info.Length() > 2 && !info[2].IsUndefined()) {
+        if (!info[2].IsObject()) {
+            error = "options must be an object";
+            return false;
+        }
+        options = info[2].As<Napi::Object>();
+    }
+
+    Napi::Value cwd = options.Get("cwd");
+    if (cwd.IsString()) {
+        request.cwd = cwd.As<Napi::String>().Utf8Value();
+    } else if (!cwd.IsUndefined()) {
+        error = "cwd must be a string";
+        return false;
+    }
+
+    Napi::Value vars = options.Get("env");
+    if (vars.IsObject()) {
+        Napi::Object object = vars.As<Napi::Object>();
+        Napi::Array names = object.GetPropertyNames();
+        request.env.reserve(names.Length());
+        for (uint32_t i = 0; i < names.Length(); i++) {
+            Napi::Value name = names.Get(i);
+            Napi::Value value = object.Get(name);
+            if (!value.IsString()) continue;
+            request.env.emplace_back(name.As<Napi::String>().Utf8Value(),
+                                     value.As<Napi::String>().Utf8Value());
+        }
+    } else if (!vars.IsUndefined()) {
+        error = "env must be an object";
+        return false;
+    }
+    return true;
+}
+
+/** A non-negative number option, or `fallback` if absent. */
+bool ReadCount(const Napi::Object& options, const char* name, double fallback, double& out,
+               std::string& error) {
+    Napi::Value value = options.Get(name);
+    if (value.IsUndefined()) {
+        out = fallback;
+        return true;
+    }
+    double number = value.IsNumber() ? value.As<Napi::Number>().DoubleValue() : -1;
+    if (!(number >= 0) || !std::isfinite(number)) {
+        error = std::string(name) + " must be a non-negative number";
+        return false;
+    }
+    out = number;
+    return true;
+}
+
+} // namespace
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+Napi::Value SpawnProcess(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    SpawnRequest request;
+    Napi::Object options;
+    std::string error;
+    double timeoutMs = 0;
+    double maxOutput = 0;
+    if (!ReadSpawnRequest(info, request, options, error) ||
+        !ReadCount(options, "timeoutMs", 0, timeoutMs, error) ||
+        !ReadCount(options, "maxOutputBytes", static_cast<double>(kDefaultMaxOutput), maxOutput,
+                   error)) {
+        return RejectedPromise(env, error);
+    }
+
+    // timeoutMs kills the process and resolves (timedOut: true) rather than
+    // rejecting, so only the signal goes to the binding.
+    auto process = std::make_shared<SpawnedProcess>(env);
+    Napi::Object cancelOptions = Napi::Object::New(env);
+    Napi::Value signal = options.Get("signal");
+    if (!signal.IsUndefined()) cancelOptions.Set("signal", signal);
+    if (!process->cancel.Attach(cancelOptions, error)) return RejectedPromise(env, error);
+
+    Napi::Promise promise = process->deferred.Promise();
+    if (process->cancel.Token()->Stopped()) {
+        process->cancel.Finish();
+        process->deferred.Reject(process->cancel.StoppedError(env));
+        return promise;
+    }
+
+    ProcessSpawner& spawner = ProcessSpawner::Instance();
+    if (!spawner.Ensure(env, error)) {
+        process->cancel.Finish();
+        process->deferred.Reject(Napi::Error::New(env, error).Value());
+        return promise;
+    }
+
+    process->id = spawner.NextId();
+    process->cancellable = process->cancel.Armed();
+    process->maxOutput = static_cast<size_t>(maxOutput);
+    process->started = std::chrono::steady_clock::now();
+    if (timeoutMs > 0) process->deadline = spawner.DeadlineTick(static_cast<int64_t>(timeoutMs));
+
+    SpawnCounters& counters = spawner.Counters();
+    if (!StartProcess(*process, request, error)) {
+        counters.failed++;
+        process->cancel.Finish();
+        process->deferred.Reject(Napi::Error::New(env, error).Value());
+        return promise;
+    }
+    counters.spawned++;
+    counters.running++;
+    spawner.Adopt(env, std::move(process));
+    return promise;
+}
+
+Napi::Value SetSpawnEnvironment(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    std::vector<EnvString> entries;
+    if (info.Length() > 0 && info[0].IsObject()) {
+        Napi::Object object = info[0].As<Napi::Object>();
+        Napi::Array names = object.GetPropertyNames();
+        for (uint32_t i = 0; i < names.Length(); i++) {
+            Napi::Value name = names.Get(i);
+            Napi::Value value = object.Get(name);
+            if (!value.IsString()) continue;
+            entries.push_back(ToEnvString(name.As<Napi::String>().Utf8Value() + "=" +
+                                          value.As<Napi::String>().Utf8Value()));
+        }
+    } else if (info.Length() > 0 && !info[0].IsUndefined()) {
+        Napi::TypeError::New(env, "env must be an object").ThrowAsJavaScriptException();
+        return env.Null();
+    } else {
+        entries = HostEnvironment();
+    }
+
+    BaseEnvironmentPtr base = BuildBase(std::move(entries));
+    size_t count = base->entries.size();
+    {
+        std::lock_guard<std::mutex> lock(g_baseMutex);
+        g_base = std::move(base);
+    }
+    return Napi::Number::New(env, static_cast<double>(count));
+}
+
+Napi::Value GetSpawnStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    SpawnCounters& counters = ProcessSpawner::Instance().Counters();
+    auto number = [&env](double value) { return Napi::Number::New(env, value); };
+
+    Napi::Object stats = Napi::Object::New(env);
+    stats.Set("spawned", number(static_cast<double>(counters.spawned.load())));
+    stats.Set("failed", number(static_cast<double>(counters.failed.load())));
+    stats.Set("running", number(static_cast<double>(counters.running.load())));
+    stats.Set("exited", number(static_cast<double>(counters.exited.load())));
+    stats.Set("timedOut", number(static_cast<double>(counters.timedOut.load())));
+    stats.Set("aborted", number(static_cast<double>(counters.aborted.load())));
+    stats.Set("wakeups", number(static_cast<double>(counters.wakeups.load())));
+    stats.Set("deliveries", number(static_cast<double>(counters.deliveries.load())));
+    stats.Set("largestDelivery", number(static_cast<double>(counters.largestDelivery.load())));
+    stats.Set("timers", number(static_cast<double>(counters.timers.load())));
+    stats.Set("baseVariables", number(static_cast<double>(CurrentBase()->entries.size())));
+    return stats;
+}
+
+} // namespace TerminAI
+
+#else // !__linux__ && !_WIN32
+
+namespace TerminAI {
+
+// ============================================================================
+// Stubs for macOS
+// ============================================================================
+
+Napi::Value SpawnProcess(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    auto deferred = Napi::Promise::Deferred::New(env);
+    deferred.Reject(
+        Napi::Error::New(env, "The native spawner is only available on Linux and Windows")
+            .Value());
+    return deferred.Promise();
+}
+
+Napi::Value SetSpawnEnvironment(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), 0);
+}
+
+Napi::Value GetSpawnStats(const Napi::CallbackInfo& info) {
+    return info.Env().Null();
+}
+
+} // namespace TerminAI
+
+#endif
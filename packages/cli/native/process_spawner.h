@@ -0,0 +1,98 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Process Spawner Header
+ *
+ * Host-side process launches for broker execute requests: start a command
+ * without a shell, collect its output, enforce a timeout, and resolve with
+ * the exit status. Built for many short commands:
+ *
+ *   Launch       Linux: posix_spawn (glibc clones with CLONE_VM|CLONE_VFORK,
+ *                so nothing is copied and the parent resumes at exec);
+ *                the child leads its own process group.
+ *                Windows: CreateProcessW, suspended, into a kill-on-close
+ *                Job Object, then resumed; only its three std handles are
+ *                inherited (PROC_THREAD_ATTRIBUTE_HANDLE_LIST).
+ *   Environment  A base block is built once: the host environment, or the
+ *                one given to setSpawnEnvironment(). A launch copies the
+ *                base's pointer array (Linux) or block (Windows) and
+ *                applies its own variables on top, instead of merging two
+ *                objects per call.
+ *   Service      One thread owns every running process: stdout and stderr
+ *                pipes, exit notifications (pidfd on Linux, a thread-pool
+ *                wait on Windows), and timeouts, all on one epoll set / I/O
+ *                completion port. Timeouts sit on a hashed timer wheel
+ *                (10 ms ticks), so arming and disarming are O(1) and the
+ *                thread only wakes when a slot is due.
+ *   Delivery     Finished processes are resolved by one call onto the JS
+ *                thread; those that finish while that call waits for a busy
+ *                event loop join it instead of queueing calls of their own.
+ *
+ * When a command exits, whatever is left in its process group / Job Object
+ * is killed, and the output already in its pipes is collected. A timeout
+ * or an aborted signal kills the whole group. Processes stay visible to
+ * killProcessTree() while they run.
+ */
+
+#pragma once
+
+#include <napi.h>
+
+namespace TerminAI {
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+/**
+ * Start a command and collect its output.
+ *
+ * Arguments:
+ *   0: String - Command; a bare name is resolved against the base
+ *      environment's PATH (absolute entries only), never one from `env`.
+ *      Batch files (.bat, .cmd) are refused on Windows.
+ *   1: String[] (optional) - Arguments
+ *   2: Object (optional)
+ *      - cwd?: String - Working directory (default: inherited)
+ *      - env?: Record<String, String> - Variables set on top of the base
+ *        environment
+ *      - timeoutMs?: Number - Kill the process group after this long and
+ *        resolve with timedOut: true (default: none)
+ *      - maxOutputBytes?: Number - Per stream; the rest is discarded and
+ *        truncated is set (default: 64 MiB)
+ *      - signal?: AbortSignal - Kill the process group and reject with an
+ *        AbortError
+ *
+ * Returns: Promise<Object> - { pid, exitCode: Number|null,
+ *          signal: Number|null, stdout: String, stderr: String, timedOut,
+ *          truncated, durationMs }
+ *   Rejects if the process cannot be started.
+ */
+Napi::Value SpawnProcess(const Napi::CallbackInfo& info);
+
+/**
+ * Replace the base environment of later launches.
+ *
+ * Arguments:
+ *   0: Record<String, String> (optional) - The environment; omitted = the
+ *      host environment as it is now
+ *
+ * Returns: Number - Variables in the new base
+ */
+Napi::Value SetSpawnEnvironment(const Napi::CallbackInfo& info);
+
+/**
+ * Counters since the module was loaded.
+ *
+ * Returns: Object - { spawned, failed, running, exited, timedOut, aborted,
+ *          wakeups, deliveries, largestDelivery, timers, baseVariables }
+ *   `deliveries` counts calls onto the JS thread, each resolving every
+ *   process that finished before it ran; `timers` is the number of armed
+ *   timeouts.
+ */
+Napi::Value GetSpawnStats(const Napi::CallbackInfo& info);
+
+} // namespace TerminAI
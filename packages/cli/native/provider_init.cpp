@@ -0,0 +1,287 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Background Provider Initialization Implementation
+ */
+
+#include "provider_init.h"
+#include "amsi_scanner.h"
+#include "appcontainer_manager.h"
+#include "resource_governor.h"
+#include "seccomp_compiler.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace TerminAI {
+
+namespace {
+
+// ============================================================================
+// Providers
+// ============================================================================
+
+struct ProviderSpec {
+    const char* name;
+    /** Returns false (with error set) when the provider is unavailable */
+    bool (*init)(std::string& error);
+};
+
+#ifdef _WIN32
+
+bool InitAmsiProvider(std::string& error) {
+    if (InitializeAmsi()) return true;
+    error = "AmsiInitialize failed";
+    return false;
+}
+
+bool InitAppContainerProfile(std::string& error) {
+    if (EnsureAppContainerProfile() != nullptr) return true;
+    error = "cannot create or open the AppContainer profile";
+    return false;
+}
+
+const ProviderSpec kProviders[] = {
+    {"amsi", InitAmsiProvider},
+    {"appContainerProfile", InitAppContainerProfile},
+};
+
+#else
+
+bool InitPortableScanner(std::string& /* error */) {
+    return true;
+}
+
+#ifdef __linux__
+
+bool InitCgroupRoot(std::string& error) {
+    return PrepareResourceGovernor(error);
+}
+
+bool InitSeccompProfile(std::string& error) {
+    if (GetSeccompProgram(SeccompProfile{})) return true;
+    error = "no seccomp filter for this architecture";
+    return false;
+}
+
+const ProviderSpec kProviders[] = {
+    {"portable", InitPortableScanner},
+    {"cgroupRoot", InitCgroupRoot},
+    {"seccompProfile", InitSeccompProfile},
+};
+
+#else
+
+const ProviderSpec kProviders[] = {
+    {"portable", InitPortableScanner},
+};
+
+#endif // __linux__
+#endif // _WIN32
+
+constexpr size_t kProviderCount = sizeof(kProviders) / sizeof(kProviders[0]);
+
+// ============================================================================
+// State
+// ============================================================================
+
+enum class InitState { Idle, Initializing, Ready };
+
+struct ProviderStatus {
+    bool ready = false;
+    bool available = false;
+    int64_t durationUs = 0;
+    std::string error;
+};
+
+struct InitSnapshot {
+    InitState state = InitState::Idle;
+    int64_t totalUs = 0;
+    ProviderStatus providers[kProviderCount];
+};
+
+struct ProviderRegistry {
+    std::mutex mutex;
+    std::condition_variable progress;
+    InitSnapshot snapshot;
+};
+
+/** Leaked on purpose: the initializer may still be running at exit. */
+ProviderRegistry& Registry() {
+    static ProviderRegistry* registry = new ProviderRegistry();
+    return *registry;
+}
+
+int64_t ElapsedUs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+void RunProviders() {
+    ProviderRegistry& registry = Registry();
+    auto runStart = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < kProviderCount; i++) {
+        auto start = std::chrono::steady_clock::now();
+        std::string error;
+        bool available = kProviders[i].init(error);
+        int64_t durationUs = ElapsedUs(start);
+        if (!available) {
+            std::cerr << "[ProviderInit] " << kProviders[i].name << " unavailable: " << error
+                      << std::endl;
+        }
+
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        ProviderStatus& status = registry.snapshot.providers[i];
+        status.ready = true;
+        status.available = available;
+        status.durationUs = durationUs;
+        status.error = std::move(error);
+        registry.progress.notify_all();
+    }
+
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.snapshot.state = InitState::Ready;
+    registry.snapshot.totalUs = ElapsedUs(runStart);
+    registry.progress.notify_all();
+}
+
+InitSnapshot TakeSnapshot() {
+    ProviderRegistry& registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    return registry.snapshot;
+}
+
+const char* StateName(InitState state) {
+    switch (state) {
+        case InitState::Idle:
+            return "idle";
+        case InitState::Initializing:
+            return "initializing";
+        case InitState::Ready:
+            return "ready";
+    }
+    return "idle";
+}
+
+Napi::Object SnapshotToObject(Napi::Env env, const InitSnapshot& snapshot) {
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("state", Napi::String::New(env, StateName(snapshot.state)));
+    result.Set("totalUs", Napi::Number::New(env, static_cast<double>(snapshot.totalUs)));
+
+    Napi::Array providers = Napi::Array::New(env, kProviderCount);
+    for (size_t i = 0; i < kProviderCount; i++) {
+        const ProviderStatus& status = snapshot.providers[i];
+        Napi::Object provider = Napi::Object::New(env);
+        provider.Set("name", Napi::String::New(env, kProviders[i].name));
+        provider.Set("ready", Napi::Boolean::New(env, status.ready));
+        provider.Set("available", Napi::Boolean::New(env, status.available));
+        provider.Set("durationUs", Napi::Number::New(env, static_cast<double>(status.durationUs)));
+        if (!status.error.empty()) provider.Set("error", Napi::String::New(env, status.error));
+        providers.Set(static_cast<uint32_t>(i), provider);
+    }
+    result.Set("providers", providers);
+    return result;
+}
+
+// ============================================================================
+// Async Worker
+// ============================================================================
+
+class ReadinessWorker : public Napi::AsyncWorker {
+public:
+    explicit ReadinessWorker(Napi::Env env)
+        : Napi::AsyncWorker(env),
+          deferred_(Napi::Promise::Deferred::New(env)) {}
+
+    Napi::Promise Promise() const { return deferred_.Promise(); }
+
+    void Execute() override {
+        ProviderRegistry& registry = Registry();
+        std::unique_lock<std::mutex> lock(registry.mutex);
+        registry.progress.wait(lock, [&registry]() {
+            return registry.snapshot.state == InitState::Ready;
+        });
+        snapshot_ = registry.snapshot;
+    }
+
+    void OnOK() override {
+        deferred_.Resolve(SnapshotToObject(Env(), snapshot_));
+    }
+
+    void OnError(const Napi::Error& error) override {
+        deferred_.Reject(error.Value());
+    }
+
+private:
+    Napi::Promise::Deferred deferred_;
+    InitSnapshot snapshot_;
+};
+
+} // namespace
+
+// ============================================================================
+// Core Functions
+// ============================================================================
+
+void StartProviderInit() {
+    ProviderRegistry& registry = Registry();
+    {
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        if (registry.snapshot.state != InitState::Idle) return;
+        registry.snapshot.state = InitState::Initializing;
+    }
+    std::thread(RunProviders).detach();
+}
+
+bool AwaitNativeProvider(const char* name) {
+    size_t index = 0;
+    while (index < kProviderCount && std::strcmp(kProviders[index].name, name) != 0) index++;
+    if (index == kProviderCount) return false;
+
+    StartProviderInit();
+    ProviderRegistry& registry = Registry();
+    std::unique_lock<std::mutex> lock(registry.mutex);
+    registry.progress.wait(lock, [&registry, index]() {
+        return registry.snapshot.providers[index].ready;
+    });
+    return registry.snapshot.providers[index].available;
+}
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+Napi::Value WarmUpNative(const Napi::CallbackInfo& info) {
+    StartProviderInit();
+    auto* worker = new ReadinessWorker(info.Env());
+    Napi::Promise promise = worker->Promise();
+    worker->Queue();
+    return promise;
+}
+
+Napi::Value GetNativeReadiness(const Napi::CallbackInfo& info) {
+    return SnapshotToObject(info.Env(), TakeSnapshot());
+}
+
+Napi::Value IsAmsiAvailableGetter(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+#ifdef _WIN32
+    bool available = IsAmsiInitialized() || AwaitNativeProvider("amsi");
+    return Napi::Boolean::New(env, available);
+#else
+    return Napi::Boolean::New(env, false);
+#endif
+}
+
+} // namespace TerminAI
@@ -0,0 +1,81 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Background Provider Initialization Header
+ *
+ * Loading the addon only registers exports. Providers that cost real time
+ * to bring up are initialized on a background thread, started by the first
+ * call that needs one of them or by warmUpNative():
+ *
+ *   Windows  amsi                 AmsiInitialize()
+ *            appContainerProfile  create the profile / derive its SID
+ *   Linux    portable             content scanner without AMSI (nothing to
+ *                                 load; scans report clean)
+ *            cgroupRoot           locate the delegated cgroup v2 root and
+ *                                 enable its controllers
+ *            seccompProfile       default capability profile, through the
+ *                                 memory and disk caches
+ *   macOS    portable
+ *
+ * Providers run in that order, so a scan waits only for the scanner, not for
+ * the sandbox profile behind it. Each provider is attempted once per
+ * process; callers that can retry (AMSI scans) do so themselves.
+ */
+
+#pragma once
+
+#include <napi.h>
+
+namespace TerminAI {
+
+// ============================================================================
+// Core Functions
+// ============================================================================
+
+/**
+ * Start the background initializer. Idempotent and non-blocking.
+ */
+void StartProviderInit();
+
+/**
+ * Start the initializer if needed and wait until the named provider has
+ * been attempted.
+ *
+ * @return true if the provider is available; false if it failed or does not
+ *         exist on this platform
+ */
+bool AwaitNativeProvider(const char* name);
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+/**
+ * Start background initialization.
+ *
+ * Returns: Promise<Object> - resolves with the getNativeReadiness() result
+ *          once every provider has been attempted (never rejects; failures
+ *          are reported per provider)
+ */
+Napi::Value WarmUpNative(const Napi::CallbackInfo& info);
+
+/**
+ * Report initialization progress without starting or waiting for it.
+ *
+ * Returns: Object
+ *   - state: "idle" | "initializing" | "ready"
+ *   - totalUs: Number - wall time of the whole run (0 until ready)
+ *   - providers: Array<{ name, ready, available, durationUs, error? }>
+ */
+Napi::Value GetNativeReadiness(const Napi::CallbackInfo& info);
+
+/**
+ * Getter behind the `isAmsiAvailable` export. The first read waits for the
+ * amsi provider; later reads are a flag check. Always false off Windows.
+ */
+Napi::Value IsAmsiAvailableGetter(const Napi::CallbackInfo& info);
+
+} // namespace TerminAI
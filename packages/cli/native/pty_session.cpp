@@ -0,0 +1,839 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Pseudo-Terminal Sessions Implementation
+ */
+
+#include "pty_session.h"
+
+#if defined(__linux__) || defined(_WIN32)
+
+#include "resource_governor.h"
+
+#ifdef __linux__
+#include "sandbox_linux.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <unistd.h>
+#else
+#include "appcontainer_manager.h"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace TerminAI {
+
+namespace {
+
+// Same values in LinuxSandboxError and AppContainerError.
+constexpr int32_t kProcessCreationFailed = -3;
+constexpr int32_t kInvalidArguments = -4;
+
+/** Output slabs per session, and their size (one read() batch at most) */
+constexpr size_t kSlabCount = 4;
+constexpr size_t kSlabSize = 64 * 1024;
+
+struct PtyStats {
+    std::atomic<uint64_t> bytesRead{0};
+    std::atomic<uint64_t> chunks{0};
+    std::atomic<uint64_t> copiedChunks{0};
+    std::atomic<uint64_t> bytesWritten{0};
+    std::atomic<uint64_t> writeCalls{0};
+    std::atomic<uint64_t> writeSyscalls{0};
+};
+
+class PtySession;
+using PtySessionPtr = std::shared_ptr<PtySession>;
+
+/** One TSFN call: a filled slab, or the exit notification (no slab). */
+struct PtyEvent {
+    PtySessionPtr session;
+    uint8_t* slab;
+    size_t length;
+};
+
+// ============================================================================
+// Session Registry
+// ============================================================================
+
+std::mutex g_sessionsMutex;
+std::unordered_map<int64_t, PtySessionPtr> g_sessions;
+
+PtySessionPtr FindSession(int64_t pid) {
+    std::lock_guard<std::mutex> lock(g_sessionsMutex);
+    auto it = g_sessions.find(pid);
+    return it == g_sessions.end() ? nullptr : it->second;
+}
+
+// ============================================================================
+// Session
+// ============================================================================
+
+class PtySession : public std::enable_shared_from_this<PtySession> {
+public:
+    PtySession() {
+        for (size_t i = 0; i < kSlabCount; i++) slabs_.push_back(new uint8_t[kSlabSize]);
+        free_ = slabs_;
+    }
+
+    ~PtySession() {
+        ClosePlatformHandles();
+        for (uint8_t* slab : slabs_) delete[] slab;
+    }
+
+    PtySession(const PtySession&) = delete;
+    PtySession& operator=(const PtySession&) = delete;
+
+    /**
+     * Create the terminal and start the process on it.
+     *
+     * @return PID, or a negative launcher error code
+     */
+    int32_t Launch(const Napi::Object& options, bool sandbox, uint16_t cols, uint16_t rows);
+
+    /** Start delivering output; the session must already be registered. */
+    void Start(Napi::Env env, Napi::Function onData, Napi::Function onExit) {
+        tsfn_ = Napi::ThreadSafeFunction::New(env, onData, "PtySession", 0, 1);
+        onExit_ = Napi::Persistent(onExit);
+        std::thread([self = shared_from_this()]() { self->Run(); }).detach();
+    }
+
+    bool Write(const char* data, size_t length) {
+        stats_.writeCalls++;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (hangupRequested_ || inputClosed_) return false;
+            bool idle = pendingOffset_ == pending_.size();
+            pending_.append(data, length);
+            // Already due for a flush: this write rides along with it.
+            if (!idle) return true;
+        }
+        Wake();
+        return true;
+    }
+
+    bool Resize(uint16_t cols, uint16_t rows);
+
+    void Hangup() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            hangupRequested_ = true;
+        }
+        Wake();
+    }
+
+    const PtyStats& Stats() const { return stats_; }
+
+private:
+    enum class ReadResult { Full, Drained, Closed };
+
+    void Run();
+    void Flush();
+    void Wake();
+    void ClosePlatformHandles();
+
+    // ------------------------------------------------------------------------
+    // Slabs
+    // ------------------------------------------------------------------------
+
+    uint8_t* TakeSlab() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_.empty()) return nullptr;
+        uint8_t* slab = free_.back();
+        free_.pop_back();
+        return slab;
+    }
+
+    bool HasFreeSlab() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return !free_.empty();
+    }
+
+    void ReturnSlab(uint8_t* slab) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            free_.push_back(slab);
+        }
+        slabCv_.notify_one();
+        Wake();
+    }
+
+    /** A chunk could not be detached: it keeps its slab, the pool gets a new one. */
+    void ReplaceSlab(uint8_t* slab) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            slabs_.erase(std::remove(slabs_.begin(), slabs_.end(), slab), slabs_.end());
+            uint8_t* fresh = new uint8_t[kSlabSize];
+            slabs_.push_back(fresh);
+            free_.push_back(fresh);
+        }
+        slabCv_.notify_one();
+        Wake();
+    }
+
+    // ------------------------------------------------------------------------
+    // Delivery (I/O thread -> JS thread)
+    // ------------------------------------------------------------------------
+
+    void Deliver(uint8_t* slab, size_t length) {
+        stats_.bytesRead += length;
+        stats_.chunks++;
+        auto* event = new PtyEvent{shared_from_this(), slab, length};
+        if (tsfn_.BlockingCall(event, &PtySession::OnEvent) != napi_ok) {
+            delete event;
+            ReturnSlab(slab);
+        }
+    }
+
+    void PostExit() {
+        auto* event = new PtyEvent{shared_from_this(), nullptr, 0};
+        if (tsfn_.BlockingCall(event, &PtySession::OnEvent) != napi_ok) delete event;
+        tsfn_.Release();
+    }
+
+    static void OnEvent(Napi::Env env, Napi::Function onData, PtyEvent* event) {
+        std::unique_ptr<PtyEvent> owned(event);
+        PtySession& session = *event->session;
+        if (event->slab == nullptr) {
+            session.DeliverExit(env);
+            return;
+        }
+
+        uint8_t* slab = event->slab;
+        auto chunk = Napi::Buffer<uint8_t>::NewOrCopy(env, slab, event->length,
+                                                      [](Napi::Env, uint8_t*) {});
+        bool lent = chunk.Data() == slab;
+        if (!lent) {
+            session.stats_.copiedChunks++;
+            session.ReturnSlab(slab);
+        }
+        onData.Call({chunk});
+        if (lent) session.Reclaim(env, chunk, slab);
+    }
+
+    /** Take a lent slab back from JS once onData has returned. */
+    void Reclaim(Napi::Env env, Napi::Buffer<uint8_t> chunk, uint8_t* slab) {
+        // A throwing onData leaves an exception pending, which would fail the
+        // detach; set it aside and rethrow it afterwards.
+        bool threw = env.IsExceptionPending();
+        Napi::Error thrown;
+        if (threw) thrown = env.GetAndClearPendingException();
+
+        chunk.ArrayBuffer().Detach();
+        if (env.IsExceptionPending()) {
+            // Not detachable: the Buffer owns the slab until it is collected.
+            env.GetAndClearPendingException();
+            chunk.AddFinalizer([](Napi::Env, uint8_t* memory) { delete[] memory; }, slab);
+            ReplaceSlab(slab);
+        } else {
+            ReturnSlab(slab);
+        }
+
+        if (threw) thrown.ThrowAsJavaScriptException();
+    }
+
+    void DeliverExit(Napi::Env env) {
+        {
+            std::lock_guard<std::mutex> lock(g_sessionsMutex);
+            auto it = g_sessions.find(pid_);
+            if (it != g_sessions.end() && it->second.get() == this) g_sessions.erase(it);
+        }
+
+        Napi::Object exit = Napi::Object::New(env);
+        exit.Set("exitCode", exitCode_ >= 0 ? Napi::Number::New(env, exitCode_) : env.Null());
+        exit.Set("signal", signal_ >= 0 ? Napi::Number::New(env, signal_) : env.Null());
+        onExit_.Call({exit});
+        onExit_.Reset();
+    }
+
+    // ------------------------------------------------------------------------
+    // State
+    // ------------------------------------------------------------------------
+
+    std::mutex mutex_;
+    std::condition_variable slabCv_;
+    /** Every slab the pool owns, and the ones not lent out */
+    std::vector<uint8_t*> slabs_;
+    std::vector<uint8_t*> free_;
+    /** Input not yet accepted by the terminal, from pendingOffset_ on */
+    std::string pending_;
+    size_t pendingOffset_ = 0;
+    bool hangupRequested_ = false;
+    bool inputClosed_ = false;
+
+    Napi::ThreadSafeFunction tsfn_;
+    Napi::FunctionReference onExit_;
+    PtyStats stats_;
+    int64_t pid_ = 0;
+    int exitCode_ = -1;
+    int signal_ = -1;
+
+#ifdef __linux__
+    ReadResult ReadAvailable();
+    void CloseMaster();
+
+    int masterFd_ = -1;
+    int wakeFd_ = -1;
+    int pidFd_ = -1;
+#else
+    uint8_t* WaitForSlab();
+    void Control();
+    void CloseConsole();
+
+    HPCON console_ = nullptr;
+    HANDLE inputWrite_ = nullptr;
+    HANDLE outputRead_ = nullptr;
+    HANDLE process_ = nullptr;
+    HANDLE wakeEvent_ = nullptr;
+#endif
+};
+
+#ifdef __linux__
+
+// ============================================================================
+// Linux: posix_openpt + sandbox launcher
+// ============================================================================
+
+int32_t PtySession::Launch(const Napi::Object& options, bool sandbox, uint16_t cols,
+                           uint16_t rows) {
+    // posix_openpt rather than openpty(): the descriptors are CLOEXEC from
+    // the start, so a concurrent child_process.spawn cannot inherit them.
+    masterFd_ = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+    char name[64];
+    if (masterFd_ < 0 || grantpt(masterFd_) != 0 || unlockpt(masterFd_) != 0 ||
+        ptsname_r(masterFd_, name, sizeof(name)) != 0) {
+        std::cerr << "[PtySession] Cannot allocate a terminal: " << strerror(errno) << std::endl;
+        return kProcessCreationFailed;
+    }
+    int slave = open(name, O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (slave < 0) {
+        std::cerr << "[PtySession] Cannot open " << name << ": " << strerror(errno) << std::endl;
+        return kProcessCreationFailed;
+    }
+
+    struct winsize size = {rows, cols, 0, 0};
+    ioctl(slave, TIOCSWINSZ, &size);
+    struct termios modes;
+    if (tcgetattr(slave, &modes) == 0) {
+        modes.c_iflag |= IUTF8; // Line editing erases whole UTF-8 characters
+        tcsetattr(slave, TCSANOW, &modes);
+    }
+
+    fcntl(masterFd_, F_SETFL, fcntl(masterFd_, F_GETFL) | O_NONBLOCK);
+    wakeFd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wakeFd_ < 0) {
+        close(slave);
+        std::cerr << "[PtySession] eventfd failed: " << strerror(errno) << std::endl;
+        return kProcessCreationFailed;
+    }
+
+    pid_t pid = 0;
+    LinuxSandboxError result = SpawnLinuxSandbox(options, slave, sandbox, pid);
+    close(slave);
+    if (result != LinuxSandboxError::Success) return static_cast<int32_t>(result);
+
+    pid_ = pid;
+    pidFd_ = static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+    return pid;
+}
+
+bool PtySession::Resize(uint16_t cols, uint16_t rows) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    struct winsize size = {rows, cols, 0, 0};
+    return masterFd_ >= 0 && ioctl(masterFd_, TIOCSWINSZ, &size) == 0;
+}
+
+void PtySession::Wake() {
+    uint64_t one = 1;
+    ssize_t ignored = write(wakeFd_, &one, sizeof(one));
+    (void)ignored;
+}
+
+void PtySession::CloseMaster() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (masterFd_ >= 0) close(masterFd_);
+    masterFd_ = -1;
+    pending_.clear();
+    pendingOffset_ = 0;
+}
+
+void PtySession::ClosePlatformHandles() {
+    if (masterFd_ >= 0) close(masterFd_);
+    if (wakeFd_ >= 0) close(wakeFd_);
+    if (pidFd_ >= 0) close(pidFd_);
+}
+
+void PtySession::Flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (masterFd_ >= 0 && pendingOffset_ < pending_.size()) {
+        ssize_t n = write(masterFd_, pending_.data() + pendingOffset_,
+                          pending_.size() - pendingOffset_);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && errno == EAGAIN) return; // Resumed on POLLOUT
+        if (n <= 0) {
+            // EIO: no one has the terminal open anymore.
+            inputClosed_ = true;
+            break;
+        }
+        stats_.writeSyscalls++;
+        stats_.bytesWritten += static_cast<uint64_t>(n);
+        pendingOffset_ += static_cast<size_t>(n);
+    }
+    pending_.clear();
+    pendingOffset_ = 0;
+}
+
+PtySession::ReadResult PtySession::ReadAvailable() {
+    uint8_t* slab = TakeSlab();
+    if (slab == nullptr) return ReadResult::Drained;
+
+    size_t length = 0;
+    ReadResult result = ReadResult::Full;
+    while (length < kSlabSize) {
+        ssize_t n = read(masterFd_, slab + length, kSlabSize - length);
+        if (n > 0) {
+            length += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        // EIO (or 0): every slave descriptor is closed.
+        result = n < 0 && errno == EAGAIN ? ReadResult::Drained : ReadResult::Closed;
+        break;
+    }
+
+    if (length > 0) {
+        Deliver(slab, length);
+    } else {
+        ReturnSlab(slab);
+    }
+    return result;
+}
+
+void PtySession::Run() {
+    bool exited = false;
+    bool eof = false;
+
+    while (!(exited && eof)) {
+        bool hangup;
+        bool wantWrite;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            hangup = hangupRequested_ && masterFd_ >= 0;
+            wantWrite = pendingOffset_ < pending_.size();
+        }
+        if (hangup) {
+            CloseMaster(); // The kernel sends SIGHUP to the session
+            eof = true;
+            continue;
+        }
+        bool haveSlab = HasFreeSlab();
+
+        // Once the child is gone, take what it left in the terminal and stop
+        // there: background processes may hold the slave open indefinitely.
+        if (exited) {
+            if (haveSlab) {
+                if (ReadAvailable() != ReadResult::Full) eof = true;
+                continue;
+            }
+        }
+
+        short events = 0;
+        if (!eof && !exited && haveSlab) events |= POLLIN;
+        if (wantWrite) events |= POLLOUT;
+        struct pollfd fds[3] = {
+            {wakeFd_, POLLIN, 0},
+            {events != 0 ? masterFd_ : -1, events, 0},
+            {exited ? -1 : pidFd_, POLLIN, 0},
+        };
+        // Pre-5.3 kernels have no pidfd: check the child on a short timer.
+        int timeout = !exited && pidFd_ < 0 ? 50 : -1;
+        if (poll(fds, 3, timeout) < 0 && errno != EINTR) {
+            std::cerr << "[PtySession] poll failed: " << strerror(errno) << std::endl;
+            break;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            uint64_t count;
+            ssize_t ignored = read(wakeFd_, &count, sizeof(count));
+            (void)ignored;
+        }
+
+        // Input goes out as soon as the thread is up, in one write() for
+        // everything queued since the last flush.
+        Flush();
+
+        if ((fds[1].revents & (POLLIN | POLLHUP | POLLERR)) && (events & POLLIN)) {
+            if (ReadAvailable() == ReadResult::Closed) eof = true;
+        }
+
+        if (!exited && ((fds[2].revents & POLLIN) ||
+                        (pidFd_ < 0 && !IsLinuxSandboxRunning(static_cast<pid_t>(pid_))))) {
+            int status = 0;
+            if (ReapLinuxSandbox(static_cast<pid_t>(pid_), status)) {
+                if (WIFEXITED(status)) exitCode_ = WEXITSTATUS(status);
+                if (WIFSIGNALED(status)) signal_ = WTERMSIG(status);
+            }
+            exited = true;
+        }
+    }
+
+    PostExit();
+}
+
+#else // _WIN32
+
+// ============================================================================
+// Windows: ConPTY + AppContainer launcher
+// ============================================================================
+
+int32_t PtySession::Launch(const Napi::Object& options, bool sandbox, uint16_t cols,
+                           uint16_t rows) {
+    AppContainerLaunch launch;
+    launch.isolate = sandbox;
+
+    Napi::Array argv = options.Get("command").As<Napi::Array>();
+    for (uint32_t i = 0; i < argv.Length(); i++) {
+        if (i > 0) launch.commandLine.push_back(L' ');
+        launch.commandLine += QuoteArgument(Utf8ToWide(argv.Get(i).As<Napi::String>().Utf8Value()));
+    }
+
+    Napi::Value workspace = options.Get("workspacePath");
+    if (workspace.IsString()) launch.workspacePath = Utf8ToWide(workspace.As<Napi::String>().Utf8Value());
+    Napi::Value cwd = options.Get("cwd");
+    if (cwd.IsString()) launch.cwd = Utf8ToWide(cwd.As<Napi::String>().Utf8Value());
+    Napi::Value env = options.Get("env");
+    if (env.IsObject()) launch.environment = BuildEnvironmentBlock(env.As<Napi::Object>());
+    Napi::Value internet = options.Get("enableInternet");
+    if (internet.IsBoolean()) launch.enableInternet = internet.As<Napi::Boolean>().Value();
+
+    Napi::Value resources = options.Get("resources");
+    if (resources.IsObject()) {
+        std::string error;
+        if (!ParseResourceLimits(resources.As<Napi::Object>(), launch.limits, error)) {
+            std::cerr << "[PtySession] Invalid resources: " << error << std::endl;
+            return kInvalidArguments;
+        }
+    }
+    if (sandbox && launch.workspacePath.empty()) return kInvalidArguments;
+
+    // The ConPTY ends of both pipes are duplicated into conhost, so ours can
+    // be closed right after CreatePseudoConsole.
+    HANDLE inputRead = nullptr;
+    HANDLE outputWrite = nullptr;
+    if (!CreatePipe(&inputRead, &inputWrite_, nullptr, 0) ||
+        !CreatePipe(&outputRead_, &outputWrite, nullptr, 0)) {
+        std::cerr << "[PtySession] CreatePipe failed: "
+                  << GetWindowsErrorMessage(GetLastError()) << std::endl;
+        if (inputRead) CloseHandle(inputRead);
+        return kProcessCreationFailed;
+    }
+    HRESULT hr = CreatePseudoConsole({static_cast<SHORT>(cols), static_cast<SHORT>(rows)},
+                                     inputRead, outputWrite, 0, &console_);
+    CloseHandle(inputRead);
+    CloseHandle(outputWrite);
+    if (FAILED(hr)) {
+        std::cerr << "[PtySession] CreatePseudoConsole failed: 0x" << std::hex << hr
+                  << std::dec << std::endl;
+        console_ = nullptr;
+        return kProcessCreationFailed;
+    }
+
+    wakeEvent_ = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    if (wakeEvent_ == nullptr) return kProcessCreationFailed;
+
+    launch.pseudoConsole = console_;
+    PROCESS_INFORMATION pi = {};
+    AppContainerError result = LaunchAppContainerProcess(launch, pi);
+    if (result != AppContainerError::Success) return static_cast<int32_t>(result);
+
+    CloseHandle(pi.hThread);
+    process_ = pi.hProcess;
+    pid_ = pi.dwProcessId;
+    return static_cast<int32_t>(pi.dwProcessId);
+}
+
+bool PtySession::Resize(uint16_t cols, uint16_t rows) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return console_ != nullptr &&
+           SUCCEEDED(ResizePseudoConsole(console_, {static_cast<SHORT>(cols),
+                                                    static_cast<SHORT>(rows)}));
+}
+
+void PtySession::Wake() {
+    SetEvent(wakeEvent_);
+}
+
+void PtySession::CloseConsole() {
+    // Outside the lock: ClosePseudoConsole can block until the output pipe is
+    // drained, which needs the reader (and so the slab lock) to make progress.
+    HPCON console;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        console = console_;
+        console_ = nullptr;
+        inputClosed_ = true;
+    }
+    if (console) ClosePseudoConsole(console);
+}
+
+void PtySession::ClosePlatformHandles() {
+    if (console_) ClosePseudoConsole(console_);
+    if (inputWrite_) CloseHandle(inputWrite_);
+    if (outputRead_) CloseHandle(outputRead_);
+    if (process_) CloseHandle(process_);
+    if (wakeEvent_) CloseHandle(wakeEvent_);
+}
+
+void PtySession::Flush() {
+    // The pipe is blocking: write outside the lock so Write() never waits on
+    // ConPTY; anything queued meanwhile signals the next flush.
+    std::string batch;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (inputClosed_) return;
+        batch.swap(pending_);
+    }
+    size_t offset = 0;
+    while (offset < batch.size()) {
+        DWORD written = 0;
+        if (!WriteFile(inputWrite_, batch.data() + offset, static_cast<DWORD>(batch.size() - offset),
+                       &written, nullptr)) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            inputClosed_ = true;
+            return;
+        }
+        stats_.writeSyscalls++;
+        stats_.bytesWritten += written;
+        offset += written;
+    }
+}
+
+uint8_t* PtySession::WaitForSlab() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    slabCv_.wait(lock, [this]() { return !free_.empty(); });
+    uint8_t* slab = free_.back();
+    free_.pop_back();
+    return slab;
+}
+
+/** Flushes input, handles hangup, and closes the console when the process exits. */
+void PtySession::Control() {
+    HANDLE handles[2] = {wakeEvent_, process_};
+    for (;;) {
+        DWORD which = WaitForMultipleObjects(2, handles, FALSE, INFINITE);
+        if (which != WAIT_OBJECT_0) break; // Process exited (or the wait failed)
+
+        bool hangup;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            hangup = hangupRequested_;
+        }
+        if (hangup) {
+            CloseConsole(); // CTRL_CLOSE_EVENT to the attached processes
+        } else {
+            Flush();
+        }
+    }
+
+    DWORD code = 0;
+    if (GetExitCodeProcess(process_, &code)) exitCode_ = static_cast<int>(code);
+    // Ends the output pipe once ConPTY has flushed what the process wrote.
+    CloseConsole();
+}
+
+void PtySession::Run() {
+    std::thread control([this]() { Control(); });
+
+    for (;;) {
+        uint8_t* slab = WaitForSlab();
+        DWORD n = 0;
+        if (!ReadFile(outputRead_, slab, static_cast<DWORD>(kSlabSize), &n, nullptr) || n == 0) {
+            ReturnSlab(slab);
+            break; // ERROR_BROKEN_PIPE: the console is closed
+        }
+
+        // Batch whatever else is already buffered into the same slab.
+        size_t length = n;
+        DWORD available = 0;
+        while (length < kSlabSize &&
+               PeekNamedPipe(outputRead_, nullptr, 0, nullptr, &available, nullptr) &&
+               available > 0) {
+            DWORD want = static_cast<DWORD>(std::min<size_t>(available, kSlabSize - length));
+            if (!ReadFile(outputRead_, slab + length, want, &n, nullptr) || n == 0) break;
+            length += n;
+        }
+        Deliver(slab, length);
+    }
+
+    control.join();
+    PostExit();
+}
+
+#endif // _WIN32
+
+uint16_t ReadDimension(const Napi::Object& options, const char* name, uint16_t fallback) {
+    Napi::Value value = options.Get(name);
+    if (!value.IsNumber()) return fallback;
+    int64_t number = value.As<Napi::Number>().Int64Value();
+    return static_cast<uint16_t>(std::clamp<int64_t>(number, 1, 0x7fff));
+}
+
+} // namespace
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+Napi::Value CreatePty(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    auto invalid = [&env]() { return Napi::Number::New(env, kInvalidArguments); };
+
+    if (info.Length() < 1 || !info[0].IsObject()) return invalid();
+    Napi::Object options = info[0].As<Napi::Object>();
+
+    Napi::Value onData = options.Get("onData");
+    Napi::Value onExit = options.Get("onExit");
+    if (!onData.IsFunction() || !onExit.IsFunction()) return invalid();
+
+    Napi::Value command = options.Get("command");
+    if (!command.IsArray() || command.As<Napi::Array>().Length() == 0) return invalid();
+    Napi::Array argv = command.As<Napi::Array>();
+    for (uint32_t i = 0; i < argv.Length(); i++) {
+        if (!argv.Get(i).IsString()) return invalid();
+    }
+
+    Napi::Value sandboxValue = options.Get("sandbox");
+    bool sandbox = sandboxValue.IsBoolean() && sandboxValue.As<Napi::Boolean>().Value();
+    uint16_t cols = ReadDimension(options, "cols", 80);
+    uint16_t rows = ReadDimension(options, "rows", 24);
+
+    auto session = std::make_shared<PtySession>();
+    int32_t pid = session->Launch(options, sandbox, cols, rows);
+    if (pid <= 0) return Napi::Number::New(env, pid);
+
+    {
+        std::lock_guard<std::mutex> lock(g_sessionsMutex);
+        g_sessions[pid] = session;
+    }
+    session->Start(env, onData.As<Napi::Function>(), onExit.As<Napi::Function>());
+    return Napi::Number::New(env, pid);
+}
+
+Napi::Value WritePty(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 2 || !info[0].IsNumber()) return Napi::Boolean::New(env, false);
+
+    PtySessionPtr session = FindSession(info[0].As<Napi::Number>().Int64Value());
+    if (!session) return Napi::Boolean::New(env, false);
+
+    if (info[1].IsBuffer()) {
+        auto data = info[1].As<Napi::Buffer<char>>();
+        return Napi::Boolean::New(env, session->Write(data.Data(), data.Length()));
+    }
+    if (info[1].IsString()) {
+        std::string data = info[1].As<Napi::String>().Utf8Value();
+        return Napi::Boolean::New(env, session->Write(data.data(), data.size()));
+    }
+    return Napi::Boolean::New(env, false);
+}
+
+Napi::Value ResizePty(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 3 || !info[0].IsNumber() || !info[1].IsNumber() || !info[2].IsNumber()) {
+        return Napi::Boolean::New(env, false);
+    }
+
+    PtySessionPtr session = FindSession(info[0].As<Napi::Number>().Int64Value());
+    if (!session) return Napi::Boolean::New(env, false);
+
+    auto clamp = [](const Napi::Value& value) {
+        return static_cast<uint16_t>(
+            std::clamp<int64_t>(value.As<Napi::Number>().Int64Value(), 1, 0x7fff));
+    };
+    return Napi::Boolean::New(env, session->Resize(clamp(info[1]), clamp(info[2])));
+}
+
+Napi::Value ClosePty(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() >= 1 && info[0].IsNumber()) {
+        PtySessionPtr session = FindSession(info[0].As<Napi::Number>().Int64Value());
+        if (session) session->Hangup();
+    }
+    return env.Undefined();
+}
+
+Napi::Value GetPtyStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsNumber()) return env.Null();
+
+    PtySessionPtr session = FindSession(info[0].As<Napi::Number>().Int64Value());
+    if (!session) return env.Null();
+
+    const PtyStats& stats = session->Stats();
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("bytesRead", Napi::Number::New(env, static_cast<double>(stats.bytesRead)));
+    result.Set("chunks", Napi::Number::New(env, static_cast<double>(stats.chunks)));
+    result.Set("copiedChunks", Napi::Number::New(env, static_cast<double>(stats.copiedChunks)));
+    result.Set("bytesWritten", Napi::Number::New(env, static_cast<double>(stats.bytesWritten)));
+    result.Set("writeCalls", Napi::Number::New(env, static_cast<double>(stats.writeCalls)));
+    result.Set("writeSyscalls", Napi::Number::New(env, static_cast<double>(stats.writeSyscalls)));
+    return result;
+}
+
+} // namespace TerminAI
+
+#else // !__linux__ && !_WIN32
+
+namespace TerminAI {
+
+// ============================================================================
+// Stubs for macOS
+// ============================================================================
+
+Napi::Value CreatePty(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Error::New(env, "Pseudo-terminal sessions are only available on Linux and Windows")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+}
+
+Napi::Value WritePty(const Napi::CallbackInfo& info) {
+    return Napi::Boolean::New(info.Env(), false);
+}
+
+Napi::Value ResizePty(const Napi::CallbackInfo& info) {
+    return Napi::Boolean::New(info.Env(), false);
+}
+
+Napi::Value ClosePty(const Napi::CallbackInfo& info) {
+    return info.Env().Undefined();
+}
+
+Napi::Value GetPtyStats(const Napi::CallbackInfo& info) {
+    return info.Env().Null();
+}
+
+} // namespace TerminAI
+
+#endif
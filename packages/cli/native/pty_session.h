@@ -0,0 +1,115 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Pseudo-Terminal Sessions Header
+ *
+ * Interactive sessions for sandboxed or host processes, without a JS-side
+ * terminal layer:
+ *
+ *   Linux    posix_openpt(); the sandbox launcher makes the slave the child's
+ *            controlling terminal and stdio (host sessions skip the
+ *            namespace steps)
+ *   Windows  ConPTY, attached with PROC_THREAD_ATTRIBUTE_PSEUDOCONSOLE next to
+ *            the AppContainer capabilities (host sessions skip those)
+ *
+ * Either way the process gets its own group (cgroup / Job Object), so
+ * killProcessTree() and the resource sampler work on the session's PID.
+ *
+ * Output: the session owns a few preallocated slabs. Its I/O thread reads
+ * into a free slab until the slab is full or the terminal has nothing more,
+ * then hands the slab to JS as an external Buffer (no copy). The Buffer is
+ * detached when the callback returns and the slab is reused, so a chunk must
+ * be consumed (decoded, parsed, or copied) inside the callback. While every
+ * slab is in flight the thread stops reading, the terminal's kernel buffer
+ * fills, and the child blocks: slow consumers get backpressure, not memory
+ * growth. Runtimes that forbid external buffers get a copy instead.
+ *
+ * Input: writes append to a pending buffer that the I/O thread flushes in
+ * one write() whenever the terminal accepts data, so bursts of keystrokes
+ * and pastes cost one system call per wakeup instead of one per call.
+ */
+
+#pragma once
+
+#include <napi.h>
+
+#include <cstdint>
+
+namespace TerminAI {
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+/**
+ * Start a process on a new pseudo-terminal.
+ *
+ * Arguments:
+ *   0: Object
+ *      - command: String[] - argv
+ *      - cwd?: String
+ *      - env?: Record<String, String> - complete environment
+ *      - cols?: Number, rows?: Number - initial size (default: 80x24)
+ *      - sandbox?: Boolean - run in the platform sandbox; the
+ *        createLinuxSandbox options (workspacePath, overlayId, capabilities,
+ *        resources) or, on Windows, { workspacePath, enableInternet,
+ *        resources } apply
+ *      - onData: (chunk: Buffer) => void - valid only during the call
+ *      - onExit: (exit: { exitCode: Number|null, signal: Number|null }) => void
+ *        called once, after the last onData
+ *
+ * Returns: Number
+ *   - Positive: Process ID (the session handle)
+ *   - Negative: Error code of the launcher (LinuxSandboxError /
+ *     AppContainerError); -3 also covers terminal creation failures
+ */
+Napi::Value CreatePty(const Napi::CallbackInfo& info);
+
+/**
+ * Queue input for the session.
+ *
+ * Arguments:
+ *   0: Number - Session PID
+ *   1: String | Buffer - Data
+ *
+ * Returns: Boolean - false if the session is gone or hung up
+ */
+Napi::Value WritePty(const Napi::CallbackInfo& info);
+
+/**
+ * Change the terminal size (the foreground process gets SIGWINCH, or the
+ * ConPTY equivalent).
+ *
+ * Arguments:
+ *   0: Number - Session PID
+ *   1: Number - Columns
+ *   2: Number - Rows
+ *
+ * Returns: Boolean
+ */
+Napi::Value ResizePty(const Napi::CallbackInfo& info);
+
+/**
+ * Hang up the terminal (SIGHUP / CTRL_CLOSE_EVENT). onExit still fires when
+ * the process exits; killProcessTree() is the hard stop.
+ *
+ * Arguments:
+ *   0: Number - Session PID
+ */
+Napi::Value ClosePty(const Napi::CallbackInfo& info);
+
+/**
+ * Transfer counters of a session.
+ *
+ * Arguments:
+ *   0: Number - Session PID
+ *
+ * Returns: Object | null - { bytesRead, chunks, copiedChunks, bytesWritten,
+ *          writeCalls, writeSyscalls }
+ */
+Napi::Value GetPtyStats(const Napi::CallbackInfo& info);
+
+} // namespace TerminAI
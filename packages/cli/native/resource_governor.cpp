@@ -0,0 +1,1221 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Resource Governor Implementation
+ */
+
+#include "resource_governor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#ifdef __linux__
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <sstream>
+#endif
+
+#ifdef _WIN32
+#include <psapi.h>
+#include "appcontainer_manager.h"
+#endif
+
+namespace TerminAI {
+
+// ============================================================================
+// Limits (all platforms)
+// ============================================================================
+
+bool ParseResourceLimits(const Napi::Object& object, ResourceLimits& limits, std::string& error) {
+    auto read = [&](const char* name, uint64_t min, uint64_t max, uint64_t& out) {
+        Napi::Value value = object.Get(name);
+        if (value.IsUndefined() || value.IsNull()) return true;
+        double number = value.IsNumber() ? value.As<Napi::Number>().DoubleValue() : -1;
+        if (!(number >= static_cast<double>(min) && number <= static_cast<double>(max))) {
+            error = std::string(name) + " must be a number in [" + std::to_string(min) + ", " +
+                    std::to_string(max) + "]";
+            return false;
+        }
+        out = static_cast<uint64_t>(number);
+        return true;
+    };
+
+    uint64_t cpuWeight = 0, cpuQuota = 0, pidsMax = 0, ioWeight = 0;
+    if (!read("cpuWeight", 1, 10000, cpuWeight) ||
+        !read("cpuQuotaPercent", 1, 100000, cpuQuota) ||
+        !read("memoryMax", 4096, UINT64_C(1) << 52, limits.memoryMax) ||
+        !read("memoryHigh", 4096, UINT64_C(1) << 52, limits.memoryHigh) ||
+        !read("pidsMax", 1, 4194304, pidsMax) ||
+        !read("ioWeight", 1, 10000, ioWeight)) {
+        return false;
+    }
+    limits.cpuWeight = static_cast<uint32_t>(cpuWeight);
+    limits.cpuQuotaPercent = static_cast<uint32_t>(cpuQuota);
+    limits.pidsMax = static_cast<uint32_t>(pidsMax);
+    limits.ioWeight = static_cast<uint32_t>(ioWeight);
+    return true;
+}
+
+#ifdef __linux__
+
+// ============================================================================
+// Linux: cgroup v2
+// ============================================================================
+
+class GovernedGroup {
+public:
+    ~GovernedGroup();
+
+    std::string path;
+    int procsFd = -1;
+    /** cgroup.kill (Linux 5.14+), -1 if missing */
+    int killFd = -1;
+    int eventsFd = -1;
+
+    // Opened once, read with pread on every sample (-1 = not available)
+    int cpuStatFd = -1;
+    int memoryCurrentFd = -1;
+    int memoryPeakFd = -1;
+    int memoryEventsFd = -1;
+    int ioStatFd = -1;
+    int pidsCurrentFd = -1;
+    int procsReadFd = -1;
+
+    /** Highest fallback RSS seen by any sample (no memory.peak to read) */
+    mutable std::atomic<uint64_t> observedPeak{0};
+};
+
+namespace {
+
+struct GovernorRoot {
+    bool resolved = false;
+    /** From setResourceGovernorRoot(); empty = default */
+    std::string configured;
+    std::string path;
+    /** Controllers enabled for children of the root */
+    std::vector<std::string> controllers;
+    std::string error;
+};
+
+std::mutex g_rootMutex;
+GovernorRoot g_root;
+
+/** Groups that were still populated when released; retried later. */
+std::mutex g_drainingMutex;
+std::vector<std::string> g_draining;
+
+bool ReadSmallFile(const std::string& path, std::string& text) {
+    std::ifstream file(path);
+    if (!file.is_open()) return false;
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    text = buffer.str();
+    return true;
+}
+
+bool WriteSmallFile(const std::string& path, const std::string& text) {
+    int fd = open(path.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    bool ok = write(fd, text.data(), text.size()) == static_cast<ssize_t>(text.size());
+    close(fd);
+    return ok;
+}
+
+/** mountinfo escapes space, tab, newline and backslash as \ooo. */
+std::string UnescapeMountPath(const std::string& path) {
+    std::string result;
+    for (size_t i = 0; i < path.size(); i++) {
+        if (path[i] == '\\' && i + 3 < path.size()) {
+            int value = (path[i + 1] - '0') * 64 + (path[i + 2] - '0') * 8 + (path[i + 3] - '0');
+            result.push_back(static_cast<char>(value));
+            i += 3;
+        } else {
+            result.push_back(path[i]);
+        }
+    }
+    return result;
+}
+
+std::string FindCgroup2Mount() {
+    std::ifstream mountinfo("/proc/self/mountinfo");
+    std::string line;
+    while (std::getline(mountinfo, line)) {
+        size_t separator = line.find(" - ");
+        if (separator == std::string::npos) continue;
+        std::istringstream tail(line.substr(separator + 3));
+        std::string fsType;
+        tail >> fsType;
+        if (fsType != "cgroup2") continue;
+
+        std::istringstream head(line.substr(0, separator));
+        std::string id, parent, device, root, mountPoint;
+        head >> id >> parent >> device >> root >> mountPoint;
+        return UnescapeMountPath(mountPoint);
+    }
+    return "";
+}
+
+/** The "0::/path" entry of /proc/self/cgroup. */
+std::string OwnCgroupPath() {
+    std::ifstream file("/proc/self/cgroup");
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.compare(0, 3, "0::") == 0) return line.substr(3);
+    }
+    return "";
+}
+
+const char* const kControllers[] = {"cpu", "memory", "pids", "io"};
+
+void ResolveRootLocked() {
+    if (g_root.resolved) return;
+    g_root.resolved = true;
+    g_root.path.clear();
+    g_root.controllers.clear();
+    g_root.error.clear();
+
+    std::string path = g_root.configured;
+    if (path.empty()) {
+        const char* fromEnv = getenv("TERMINAI_CGROUP_ROOT");
+        if (fromEnv != nullptr) path = fromEnv;
+    }
+    if (path.empty()) {
+        std::string mount = FindCgroup2Mount();
+        std::string own = OwnCgroupPath();
+        if (mount.empty() || own.empty()) {
+            g_root.error = "no cgroup v2 hierarchy is mounted";
+            return;
+        }
+        path = own == "/" ? mount : mount + own;
+    }
+    while (path.size() > 1 && path.back() == '/') path.pop_back();
+
+    if (access((path + "/cgroup.procs").c_str(), F_OK) != 0) {
+        g_root.error = path + " is not a cgroup v2 directory";
+        return;
+    }
+    if (access(path.c_str(), W_OK) != 0) {
+        g_root.error = "cannot create cgroups under " + path + " (not delegated)";
+        return;
+    }
+
+    // Hand the controllers we use down to sandbox groups. Fails with EBUSY
+    // when the root itself has processes; sandboxes then get accounting
+    // only.
+    std::string available;
+    ReadSmallFile(path + "/cgroup.controllers", available);
+    std::istringstream availableNames(available);
+    std::string name;
+    while (availableNames >> name) {
+        for (const char* wanted : kControllers) {
+            if (name == wanted) WriteSmallFile(path + "/cgroup.subtree_control", "+" + name);
+        }
+    }
+
+    std::string enabled;
+    ReadSmallFile(path + "/cgroup.subtree_control", enabled);
+    std::istringstream enabledNames(enabled);
+    while (enabledNames >> name) g_root.controllers.push_back(name);
+    g_root.path = path;
+}
+
+void RetryDraining() {
+    std::lock_guard<std::mutex> lock(g_drainingMutex);
+    g_draining.erase(std::remove_if(g_draining.begin(), g_draining.end(),
+                                    [](const std::string& path) {
+                                        return rmdir(path.c_str()) == 0 || errno == ENOENT;
+                                    }),
+                     g_draining.end());
+}
+
+int OpenStat(const std::string& dir, const char* name, int flags = O_RDONLY) {
+    return open((dir + "/" + name).c_str(), flags | O_CLOEXEC);
+}
+
+bool ReadFd(int fd, char* buffer, size_t size) {
+    if (fd < 0) return false;
+    ssize_t n = pread(fd, buffer, size - 1, 0);
+    if (n < 0) return false;
+    buffer[n] = '\0';
+    return true;
+}
+
+/** Value of a "key value" line in a flat-keyed cgroup file. */
+uint64_t KeyedValue(const char* text, const char* key) {
+    size_t keyLength = strlen(key);
+    const char* line = text;
+    while (*line != '\0') {
+        if (strncmp(line, key, keyLength) == 0 && line[keyLength] == ' ') {
+            return strtoull(line + keyLength + 1, nullptr, 10);
+        }
+        const char* next = strchr(line, '\n');
+        if (next == nullptr) break;
+        line = next + 1;
+    }
+    return 0;
+}
+
+/** Sum of one "name=value" field over every device line of io.stat. */
+uint64_t SumIoField(const char* text, const char* field) {
+    uint64_t total = 0;
+    size_t fieldLength = strlen(field);
+    for (const char* at = strstr(text, field); at != nullptr; at = strstr(at + fieldLength, field)) {
+        if (at == text || at[-1] == ' ') total += strtoull(at + fieldLength, nullptr, 10);
+    }
+    return total;
+}
+
+/**
+ * Kill the members one by one (kernels without cgroup.kill). The group is
+ * frozen first, where supported, so nothing can fork between listing and
+ * killing; repeated until the list comes back empty.
+ */
+void KillListedProcesses(const GovernedGroup& group) {
+    bool frozen = WriteSmallFile(group.path + "/cgroup.freeze", "1");
+    char buffer[16384];
+    for (int round = 0; round < 64; round++) {
+        if (!ReadFd(group.procsReadFd, buffer, sizeof(buffer))) break;
+        bool any = false;
+        for (char* cursor = buffer; *cursor != '\0';) {
+            char* end;
+            long pid = strtol(cursor, &end, 10);
+            if (end == cursor) break;
+            cursor = end;
+            while (*cursor == '\n') cursor++;
+            kill(static_cast<pid_t>(pid), SIGKILL);
+            any = true;
+        }
+        if (!any) break;
+    }
+    if (frozen) WriteSmallFile(group.path + "/cgroup.freeze", "0");
+}
+
+/** Block on cgroup.events until "populated 0" (no polling loop). */
+bool WaitUnpopulated(const GovernedGroup& group, int64_t timeoutMs) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    char buffer[256];
+    while (ReadFd(group.eventsFd, buffer, sizeof(buffer))) {
+        if (strstr(buffer, "populated 0") != nullptr) return true;
+
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0) return false;
+        // kernfs signals modifications of cgroup.events with POLLPRI.
+        struct pollfd pfd = {group.eventsFd, POLLPRI, 0};
+        if (poll(&pfd, 1, static_cast<int>(std::min<int64_t>(remaining, INT32_MAX))) < 0 &&
+            errno != EINTR) {
+            return false;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+GovernedGroup::~GovernedGroup() {
+    if (!path.empty() && rmdir(path.c_str()) != 0 && errno == EBUSY) {
+        // Descendants outlived the sandbox leader: they go with it, like a
+        // Job Object with kill-on-close. The directory is removed once the
+        // kill has landed.
+        if (killFd >= 0) {
+            ssize_t ignored = write(killFd, "1", 1);
+            (void)ignored;
+        } else {
+            KillListedProcesses(*this);
+        }
+        std::lock_guard<std::mutex> lock(g_drainingMutex);
+        g_draining.push_back(path);
+    }
+    for (int fd : {procsFd, killFd, eventsFd, cpuStatFd, memoryCurrentFd, memoryPeakFd,
+                   memoryEventsFd, ioStatFd, pidsCurrentFd, procsReadFd}) {
+        if (fd >= 0) close(fd);
+    }
+}
+
+GovernedGroupPtr CreateGovernedGroup(const ResourceLimits& limits,
+                                     std::vector<std::string>& unsupported,
+                                     std::string& error) {
+    std::string root;
+    std::vector<std::string> controllers;
+    {
+        std::lock_guard<std::mutex> lock(g_rootMutex);
+        ResolveRootLocked();
+        if (g_root.path.empty()) {
+            error = g_root.error;
+            return nullptr;
+        }
+        root = g_root.path;
+        controllers = g_root.controllers;
+    }
+    RetryDraining();
+
+    static std::atomic<uint64_t> sequence{0};
+    auto group = std::make_shared<GovernedGroup>();
+    for (int attempt = 0;; attempt++) {
+        std::string path = root + "/terminai-" + std::to_string(getpid()) + "-" +
+                           std::to_string(sequence.fetch_add(1));
+        if (mkdir(path.c_str(), 0755) == 0) {
+            group->path = path;
+            break;
+        }
+        if (errno != EEXIST || attempt >= 16) {
+            error = "cannot create cgroup " + path + ": " + strerror(errno);
+            return nullptr;
+        }
+    }
+
+    group->procsFd = OpenStat(group->path, "cgroup.procs", O_WRONLY);
+    if (group->procsFd < 0) {
+        error = "cannot open " + group->path + "/cgroup.procs: " + strerror(errno);
+        return nullptr;
+    }
+
+    auto apply = [&](const char* limit, const char* controller, const char* file,
+                     const std::string& value) {
+        bool delegated = std::find(controllers.begin(), controllers.end(), controller) !=
+                         controllers.end();
+        if (!delegated || !WriteSmallFile(group->path + "/" + file, value)) {
+            unsupported.push_back(limit);
+        }
+    };
+    if (limits.cpuWeight) apply("cpuWeight", "cpu", "cpu.weight", std::to_string(limits.cpuWeight));
+    if (limits.cpuQuotaPercent) {
+        // Quota per 100ms period: 100% of one CPU = 100000us.
+        apply("cpuQuotaPercent", "cpu", "cpu.max",
+              std::to_string(static_cast<uint64_t>(limits.cpuQuotaPercent) * 1000) + " 100000");
+    }
+    if (limits.memoryMax) apply("memoryMax", "memory", "memory.max", std::to_string(limits.memoryMax));
+    if (limits.memoryHigh) apply("memoryHigh", "memory", "memory.high", std::to_string(limits.memoryHigh));
+    if (limits.pidsMax) apply("pidsMax", "pids", "pids.max", std::to_string(limits.pidsMax));
+    if (limits.ioWeight) {
+        apply("ioWeight", "io", "io.weight", "default " + std::to_string(limits.ioWeight));
+    }
+
+    group->killFd = OpenStat(group->path, "cgroup.kill", O_WRONLY);
+    group->eventsFd = OpenStat(group->path, "cgroup.events");
+    group->cpuStatFd = OpenStat(group->path, "cpu.stat");
+    group->memoryCurrentFd = OpenStat(group->path, "memory.current");
+    group->memoryPeakFd = OpenStat(group->path, "memory.peak");
+    group->memoryEventsFd = OpenStat(group->path, "memory.events");
+    group->ioStatFd = OpenStat(group->path, "io.stat");
+    group->pidsCurrentFd = OpenStat(group->path, "pids.current");
+    group->procsReadFd = OpenStat(group->path, "cgroup.procs");
+    return group;
+}
+
+int GovernedGroupProcsFd(const GovernedGroup& group) {
+    return group.procsFd;
+}
+
+bool AttachGovernedProcess(const GovernedGroup& group, int64_t pid, std::string& error) {
+    std::string text = std::to_string(pid);
+    if (write(group.procsFd, text.data(), text.size()) != static_cast<ssize_t>(text.size())) {
+        error = "cannot move " + text + " into " + group.path + ": " + strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+bool KillGovernedGroup(const GovernedGroup& group, int64_t timeoutMs, TreeKillResult& result,
+                       std::string& error) {
+    auto start = std::chrono::steady_clock::now();
+    result.method = "cgroup";
+    if (group.killFd >= 0) {
+        if (write(group.killFd, "1", 1) != 1) {
+            error = std::string("cgroup.kill failed: ") + strerror(errno);
+            return false;
+        }
+    } else {
+        KillListedProcesses(group);
+    }
+    result.complete = WaitUnpopulated(group, timeoutMs);
+    result.latencyUs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    return true;
+}
+
+bool SampleGovernedGroup(const GovernedGroup& group, ResourceSample& sample) {
+    char buffer[16384];
+
+    if (!ReadFd(group.cpuStatFd, buffer, sizeof(buffer))) return false;
+    sample.cpuUsageUs = KeyedValue(buffer, "usage_usec");
+    sample.cpuUserUs = KeyedValue(buffer, "user_usec");
+    sample.cpuSystemUs = KeyedValue(buffer, "system_usec");
+    sample.cpuThrottledCount = KeyedValue(buffer, "nr_throttled");
+    sample.cpuThrottledUs = KeyedValue(buffer, "throttled_usec");
+
+    if (ReadFd(group.memoryCurrentFd, buffer, sizeof(buffer))) {
+        sample.memoryCurrent = strtoull(buffer, nullptr, 10);
+    }
+    if (ReadFd(group.memoryPeakFd, buffer, sizeof(buffer))) {
+        sample.memoryPeak = strtoull(buffer, nullptr, 10);
+    }
+    if (ReadFd(group.memoryEventsFd, buffer, sizeof(buffer))) {
+        sample.memoryHighEvents = KeyedValue(buffer, "high");
+        sample.memoryMaxEvents = KeyedValue(buffer, "max");
+        sample.oomKills = KeyedValue(buffer, "oom_kill");
+    }
+    if (ReadFd(group.ioStatFd, buffer, sizeof(buffer))) {
+        sample.ioReadBytes = SumIoField(buffer, "rbytes=");
+        sample.ioWriteBytes = SumIoField(buffer, "wbytes=");
+    }
+    if (ReadFd(group.pidsCurrentFd, buffer, sizeof(buffer))) {
+        sample.pids = strtoull(buffer, nullptr, 10);
+    }
+
+    // Without the memory/pids controllers, fall back to the member
+    // processes: RSS from /proc/<pid>/statm, process count from
+    // cgroup.procs.
+    if ((group.memoryCurrentFd < 0 || group.pidsCurrentFd < 0) &&
+        ReadFd(group.procsReadFd, buffer, sizeof(buffer))) {
+        static const uint64_t pageSize = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+        uint64_t processes = 0;
+        uint64_t resident = 0;
+        char* cursor = buffer;
+        while (*cursor != '\0') {
+            char* end;
+            unsigned long pid = strtoul(cursor, &end, 10);
+            if (end == cursor) break;
+            cursor = end;
+            while (*cursor == '\n') cursor++;
+            processes++;
+            if (group.memoryCurrentFd >= 0) continue;
+
+            char path[64];
+            snprintf(path, sizeof(path), "/proc/%lu/statm", pid);
+            int fd = open(path, O_RDONLY | O_CLOEXEC);
+            if (fd < 0) continue;
+            char statm[128];
+            if (ReadFd(fd, statm, sizeof(statm))) {
+                char* field = statm;
+                strtoull(field, &field, 10); // size
+                resident += strtoull(field, nullptr, 10) * pageSize;
+            }
+            close(fd);
+        }
+        if (group.memoryCurrentFd < 0) {
+            uint64_t peak = group.observedPeak.load();
+            while (resident > peak && !group.observedPeak.compare_exchange_weak(peak, resident)) {}
+            sample.memoryCurrent = resident;
+            sample.memoryPeak = std::max(peak, resident);
+        }
+        if (group.pidsCurrentFd < 0) sample.pids = processes;
+    }
+    return true;
+}
+
+#elif defined(_WIN32)
+
+// ============================================================================
+// Windows: Job Objects
+// ============================================================================
+
+class GovernedGroup {
+public:
+    ~GovernedGroup() {
+        if (job != nullptr) CloseHandle(job);
+    }
+
+    HANDLE job = nullptr;
+};
+
+namespace {
+
+/** cgroup weight 1..10000 (default 100) onto the job scale 1..9 (default 5) */
+DWORD JobCpuWeight(uint32_t weight) {
+    long scaled = 5 + std::lround(2.0 * std::log10(weight / 100.0));
+    return static_cast<DWORD>(std::clamp(scaled, 1L, 9L));
+}
+
+} // namespace
+
+GovernedGroupPtr CreateGovernedGroup(const ResourceLimits& limits,
+                                     std::vector<std::string>& unsupported,
+                                     std::string& error) {
+    HANDLE job = CreateJobObjectW(nullptr, nullptr);
+    if (job == nullptr) {
+        error = "CreateJobObject failed: " + GetWindowsErrorMessage(GetLastError());
+        return nullptr;
+    }
+    auto group = std::make_shared<GovernedGroup>();
+    group->job = job;
+
+    // Kill-on-close: when the last handle goes (release, or this process
+    // dying) the whole tree goes with it.
+    JOBOBJECT_EXTENDED_LIMIT_INFORMATION extended = {};
+    extended.BasicLimitInformation.LimitFlags = JOB_OBJECT_LIMIT_KILL_ON_JOB_CLOSE;
+    if (limits.memoryMax) {
+        extended.BasicLimitInformation.LimitFlags |= JOB_OBJECT_LIMIT_JOB_MEMORY;
+        extended.JobMemoryLimit = static_cast<SIZE_T>(limits.memoryMax);
+    }
+    if (limits.pidsMax) {
+        extended.BasicLimitInformation.LimitFlags |= JOB_OBJECT_LIMIT_ACTIVE_PROCESS;
+        extended.BasicLimitInformation.ActiveProcessLimit = limits.pidsMax;
+    }
+    if (!SetInformationJobObject(job, JobObjectExtendedLimitInformation, &extended, sizeof(extended))) {
+        if (limits.memoryMax) unsupported.push_back("memoryMax");
+        if (limits.pidsMax) unsupported.push_back("pidsMax");
+        extended = {};
+        extended.BasicLimitInformation.LimitFlags = JOB_OBJECT_LIMIT_KILL_ON_JOB_CLOSE;
+        if (!SetInformationJobObject(job, JobObjectExtendedLimitInformation, &extended, sizeof(extended))) {
+            error = "cannot configure Job Object: " + GetWindowsErrorMessage(GetLastError());
+            return nullptr;
+        }
+    }
+
+    // Weight-based and hard-cap rate control are mutually exclusive; the
+    // quota wins.
+    JOBOBJECT_CPU_RATE_CONTROL_INFORMATION cpu = {};
+    if (limits.cpuQuotaPercent) {
+        DWORD processors = std::max<DWORD>(1, GetActiveProcessorCount(ALL_PROCESSOR_GROUPS));
+        // CpuRate is in 1/100 percent of all processors.
+        uint64_t rate = static_cast<uint64_t>(limits.cpuQuotaPercent) * 100 / processors;
+        cpu.ControlFlags = JOB_OBJECT_CPU_RATE_CONTROL_ENABLE | JOB_OBJECT_CPU_RATE_CONTROL_HARD_CAP;
+        cpu.CpuRate = static_cast<DWORD>(std::clamp<uint64_t>(rate, 1, 10000));
+        if (limits.cpuWeight) unsupported.push_back("cpuWeight");
+    } else if (limits.cpuWeight) {
+        cpu.ControlFlags = JOB_OBJECT_CPU_RATE_CONTROL_ENABLE | JOB_OBJECT_CPU_RATE_CONTROL_WEIGHT_BASED;
+        cpu.Weight = JobCpuWeight(limits.cpuWeight);
+    }
+    if (cpu.ControlFlags != 0 &&
+        !SetInformationJobObject(job, JobObjectCpuRateControlInformation, &cpu, sizeof(cpu))) {
+        unsupported.push_back(limits.cpuQuotaPercent ? "cpuQuotaPercent" : "cpuWeight");
+    }
+
+    if (limits.memoryHigh) unsupported.push_back("memoryHigh");
+    if (limits.ioWeight) unsupported.push_back("ioWeight");
+    return group;
+}
+
+HANDLE GovernedGroupJob(const GovernedGroup& group) {
+    return group.job;
+}
+
+bool AttachGovernedProcess(const GovernedGroup& group, int64_t pid, std::string& error) {
+    HANDLE process = OpenProcess(PROCESS_SET_QUOTA | PROCESS_TERMINATE, FALSE, static_cast<DWORD>(pid));
+    if (process == nullptr) {
+        error = "OpenProcess failed: " + GetWindowsErrorMessage(GetLastError());
+        return false;
+    }
+    BOOL assigned = AssignProcessToJobObject(group.job, process);
+    if (!assigned) error = "AssignProcessToJobObject failed: " + GetWindowsErrorMessage(GetLastError());
+    CloseHandle(process);
+    return assigned != FALSE;
+}
+
+namespace {
+
+DWORD ActiveJobProcesses(HANDLE job) {
+    JOBOBJECT_BASIC_ACCOUNTING_INFORMATION accounting = {};
+    if (!QueryInformationJobObject(job, JobObjectBasicAccountingInformation, &accounting,
+                                   sizeof(accounting), nullptr)) {
+        return 0;
+    }
+    return accounting.ActiveProcesses;
+}
+
+} // namespace
+
+bool KillGovernedGroup(const GovernedGroup& group, int64_t timeoutMs, TreeKillResult& result,
+                       std::string& error) {
+    auto start = std::chrono::steady_clock::now();
+    result.method = "job";
+
+    // Associated before terminating so ACTIVE_PROCESS_ZERO cannot be missed.
+    // A job takes one port for its lifetime; a second kill falls back to
+    // short sleeps.
+    HANDLE port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+    bool notified = false;
+    if (port != nullptr) {
+        JOBOBJECT_ASSOCIATE_COMPLETION_PORT association = {};
+        association.CompletionKey = group.job;
+        association.CompletionPort = port;
+        notified = SetInformationJobObject(group.job, JobObjectAssociateCompletionPortInformation,
+                                           &association, sizeof(association)) != FALSE;
+    }
+
+    if (!TerminateJobObject(group.job, 1)) {
+        error = "TerminateJobObject failed: " + GetWindowsErrorMessage(GetLastError());
+        if (port != nullptr) CloseHandle(port);
+        return false;
+    }
+
+    auto deadline = start + std::chrono::milliseconds(timeoutMs);
+    while (ActiveJobProcesses(group.job) != 0) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0) break;
+        if (notified) {
+            DWORD message = 0;
+            ULONG_PTR key = 0;
+            LPOVERLAPPED overlapped = nullptr;
+            if (!GetQueuedCompletionStatus(port, &message, &key, &overlapped,
+                                           static_cast<DWORD>(remaining))) {
+                break;
+            }
+        } else {
+            Sleep(1);
+        }
+    }
+    if (port != nullptr) CloseHandle(port);
+
+    result.complete = ActiveJobProcesses(group.job) == 0;
+    result.latencyUs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    return true;
+}
+
+bool SampleGovernedGroup(const GovernedGroup& group, ResourceSample& sample) {
+    JOBOBJECT_BASIC_AND_IO_ACCOUNTING_INFORMATION accounting = {};
+    if (!QueryInformationJobObject(group.job, JobObjectBasicAndIoAccountingInformation,
+                                   &accounting, sizeof(accounting), nullptr)) {
+        return false;
+    }
+    // 100ns units
+    sample.cpuUserUs = static_cast<uint64_t>(accounting.BasicInfo.TotalUserTime.QuadPart) / 10;
+    sample.cpuSystemUs = static_cast<uint64_t>(accounting.BasicInfo.TotalKernelTime.QuadPart) / 10;
+    sample.cpuUsageUs = sample.cpuUserUs + sample.cpuSystemUs;
+    sample.ioReadBytes = accounting.IoInfo.ReadTransferCount;
+    sample.ioWriteBytes = accounting.IoInfo.WriteTransferCount;
+    sample.pids = accounting.BasicInfo.ActiveProcesses;
+
+    JOBOBJECT_EXTENDED_LIMIT_INFORMATION extended = {};
+    if (QueryInformationJobObject(group.job, JobObjectExtendedLimitInformation, &extended,
+                                  sizeof(extended), nullptr)) {
+        sample.memoryPeak = extended.PeakJobMemoryUsed;
+    }
+
+    // Jobs have no resident-set counter; sum the members' working sets.
+    constexpr DWORD kMaxIds = 256;
+    alignas(JOBOBJECT_BASIC_PROCESS_ID_LIST) uint8_t buffer[sizeof(JOBOBJECT_BASIC_PROCESS_ID_LIST) +
+                                                          kMaxIds * sizeof(ULONG_PTR)];
+    auto* list = reinterpret_cast<JOBOBJECT_BASIC_PROCESS_ID_LIST*>(buffer);
+    if (QueryInformationJobObject(group.job, JobObjectBasicProcessIdList, list, sizeof(buffer), nullptr) ||
+        GetLastError() == ERROR_MORE_DATA) {
+        for (DWORD i = 0; i < list->NumberOfProcessIdsInList; i++) {
+            HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE,
+                                         static_cast<DWORD>(list->ProcessIdList[i]));
+            if (process == nullptr) continue;
+            PROCESS_MEMORY_COUNTERS counters = {};
+            if (K32GetProcessMemoryInfo(process, &counters, sizeof(counters))) {
+                sample.memoryCurrent += counters.WorkingSetSize;
+            }
+            CloseHandle(process);
+        }
+    }
+    return true;
+}
+
+#endif // __linux__ / _WIN32
+
+#if defined(__linux__) || defined(_WIN32)
+
+// ============================================================================
+// Registry
+// ============================================================================
+
+namespace {
+
+std::mutex g_registryMutex;
+std::unordered_map<int64_t, GovernedGroupPtr> g_governed;
+
+GovernedGroupPtr FindGoverned(int64_t pid) {
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    auto it = g_governed.find(pid);
+    return it == g_governed.end() ? nullptr : it->second;
+}
+
+std::vector<std::pair<int64_t, GovernedGroupPtr>> SnapshotGoverned() {
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    return {g_governed.begin(), g_governed.end()};
+}
+
+double NowMs() {
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+struct TimedSample {
+    int64_t pid;
+    double timestamp;
+    ResourceSample sample;
+};
+
+Napi::Object SampleToObject(Napi::Env env, const TimedSample& timed) {
+    Napi::Object result = ResourceSampleToObject(env, timed.sample);
+    result.Set("pid", Napi::Number::New(env, static_cast<double>(timed.pid)));
+    result.Set("timestamp", Napi::Number::New(env, timed.timestamp));
+    return result;
+}
+
+// ============================================================================
+// Sampler
+// ============================================================================
+
+class ResourceSampler {
+public:
+    static ResourceSampler& Instance() {
+        // Leaked on purpose: the sampler thread must not be joined from a
+        // static destructor during process exit.
+        static ResourceSampler* sampler = new ResourceSampler();
+        return *sampler;
+    }
+
+    void Start(Napi::Env env, Napi::Function callback, uint32_t intervalMs) {
+        Stop();
+
+        // Queue of one: a batch the JS thread has not picked up yet means
+        // the next one is dropped instead of piling up.
+        tsfn_ = Napi::ThreadSafeFunction::New(env, callback, "ResourceSampler", 1, 1);
+        tsfn_.Unref(env);
+        passes_ = 0;
+        dropped_ = 0;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = false;
+        running_ = true;
+        thread_ = std::thread([this, intervalMs]() { Run(intervalMs); });
+    }
+
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_) return;
+            stop_ = true;
+        }
+        cv_.notify_all();
+        if (thread_.joinable()) thread_.join();
+        tsfn_.Release();
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+
+    uint64_t Passes() const { return passes_.load(); }
+    uint64_t Dropped() const { return dropped_.load(); }
+
+private:
+    using Batch = std::vector<TimedSample>;
+
+    void Run(uint32_t intervalMs) {
+        const auto interval = std::chrono::milliseconds(intervalMs);
+        auto next = std::chrono::steady_clock::now() + interval;
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!cv_.wait_until(lock, next, [this]() { return stop_; })) {
+            lock.unlock();
+            bool closing = !SamplePass();
+            lock.lock();
+            if (closing) break;
+
+            // Fixed cadence: skip ticks that were missed, never burst.
+            next += interval;
+            auto now = std::chrono::steady_clock::now();
+            if (next <= now) next = now + interval;
+        }
+    }
+
+    /** @return false once the JS side is gone */
+    bool SamplePass() {
+        auto governed = SnapshotGoverned();
+        if (governed.empty()) return true;
+
+        auto* batch = new Batch();
+        batch->reserve(governed.size());
+        double timestamp = NowMs();
+        for (const auto& [pid, group] : governed) {
+            TimedSample timed{pid, timestamp, {}};
+            if (SampleGovernedGroup(*group, timed.sample)) batch->push_back(timed);
+        }
+        passes_++;
+
+        napi_status status = tsfn_.NonBlockingCall(
+            batch, [](Napi::Env env, Napi::Function callback, Batch* samples) {
+                Napi::Array array = Napi::Array::New(env, samples->size());
+                for (size_t i = 0; i < samples->size(); i++) {
+                    array.Set(static_cast<uint32_t>(i), SampleToObject(env, (*samples)[i]));
+                }
+                delete samples;
+                callback.Call({array});
+            });
+        if (status != napi_ok) {
+            delete batch;
+            dropped_++;
+        }
+        return status != napi_closing;
+    }
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::thread thread_;
+    bool stop_ = false;
+    bool running_ = false;
+    Napi::ThreadSafeFunction tsfn_;
+    std::atomic<uint64_t> passes_{0};
+    std::atomic<uint64_t> dropped_{0};
+};
+
+// ============================================================================
+// Tree Teardown
+// ============================================================================
+
+/** Processes without a group: the best the platform offers. */
+bool KillUngoverned(int64_t pid, int64_t timeoutMs, TreeKillResult& result, std::string& error) {
+    auto start = std::chrono::steady_clock::now();
+#ifdef __linux__
+    pid_t target = static_cast<pid_t>(pid);
+    // Sandboxes lead their own session, so the process group covers every
+    // descendant that did not call setsid itself.
+    bool leader = getpgid(target) == target;
+    result.method = leader ? "processGroup" : "process";
+    if (kill(leader ? -target : target, SIGKILL) != 0) {
+        if (errno != ESRCH) {
+            error = std::string("kill failed: ") + strerror(errno);
+            return false;
+        }
+        result.complete = true;
+        return true;
+    }
+    int pidfd = static_cast<int>(syscall(SYS_pidfd_open, target, 0));
+    if (pidfd >= 0) {
+        struct pollfd pfd = {pidfd, POLLIN, 0};
+        int ready;
+        do {
+            ready = poll(&pfd, 1, static_cast<int>(std::min<int64_t>(timeoutMs, INT32_MAX)));
+        } while (ready < 0 && errno == EINTR);
+        close(pidfd);
+        result.complete = ready > 0;
+    }
+#else
+    result.method = "process";
+    HANDLE process = OpenProcess(PROCESS_TERMINATE | SYNCHRONIZE, FALSE, static_cast<DWORD>(pid));
+    if (process == nullptr) {
+        result.complete = true;
+        return true;
+    }
+    if (!TerminateProcess(process, 1)) {
+        error = "TerminateProcess failed: " + GetWindowsErrorMessage(GetLastError());
+        CloseHandle(process);
+        return false;
+    }
+    result.complete = WaitForSingleObject(process, static_cast<DWORD>(timeoutMs)) == WAIT_OBJECT_0;
+    CloseHandle(process);
+#endif
+    result.latencyUs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    return true;
+}
+
+class KillTreeWorker : public Napi::AsyncWorker {
+public:
+    KillTreeWorker(Napi::Env env, int64_t pid, int64_t timeoutMs)
+        : Napi::AsyncWorker(env),
+          deferred_(Napi::Promise::Deferred::New(env)),
+          pid_(pid),
+          timeoutMs_(timeoutMs) {}
+
+    Napi::Promise Promise() const { return deferred_.Promise(); }
+
+    void Execute() override {
+        std::string error;
+        if (!KillProcessTreeOf(pid_, timeoutMs_, result_, error)) SetError(error);
+    }
+
+    void OnOK() override {
+        Napi::Env env = Env();
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("method", Napi::String::New(env, result_.method));
+        result.Set("latencyUs", Napi::Number::New(env, static_cast<double>(result_.latencyUs)));
+        result.Set("complete", Napi::Boolean::New(env, result_.complete));
+        deferred_.Resolve(result);
+    }
+
+    void OnError(const Napi::Error& error) override {
+        deferred_.Reject(error.Value());
+    }
+
+private:
+    Napi::Promise::Deferred deferred_;
+    int64_t pid_;
+    int64_t timeoutMs_;
+    TreeKillResult result_;
+};
+
+} // namespace
+
+bool KillProcessTreeOf(int64_t pid, int64_t timeoutMs, TreeKillResult& result,
+                       std::string& error) {
+    GovernedGroupPtr group = FindGoverned(pid);
+    return group ? KillGovernedGroup(*group, timeoutMs, result, error)
+                 : KillUngoverned(pid, timeoutMs, result, error);
+}
+
+void RegisterGovernedProcess(int64_t pid, GovernedGroupPtr group) {
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    g_governed[pid] = std::move(group);
+}
+
+void ReleaseGovernedProcess(int64_t pid) {
+    GovernedGroupPtr released;
+    {
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        auto it = g_governed.find(pid);
+        if (it == g_governed.end()) return;
+        released = std::move(it->second);
+        g_governed.erase(it);
+    }
+    // The group is removed when the last reference (possibly a sampling
+    // pass in flight) goes away, outside the registry lock.
+}
+
+bool PrepareResourceGovernor(std::string& error) {
+#ifdef __linux__
+    std::lock_guard<std::mutex> lock(g_rootMutex);
+    ResolveRootLocked();
+    error = g_root.error;
+    return !g_root.path.empty();
+#else
+    // Job Objects need no setup.
+    return true;
+#endif
+}
+
+// ============================================================================
+// NAPI Helpers
+// ============================================================================
+
+Napi::Object ResourceSampleToObject(Napi::Env env, const ResourceSample& s) {
+    auto number = [&env](uint64_t value) { return Napi::Number::New(env, static_cast<double>(value)); };
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("cpuUsageUs", number(s.cpuUsageUs));
+    result.Set("cpuUserUs", number(s.cpuUserUs));
+    result.Set("cpuSystemUs", number(s.cpuSystemUs));
+    result.Set("cpuThrottledCount", number(s.cpuThrottledCount));
+    result.Set("cpuThrottledUs", number(s.cpuThrottledUs));
+    result.Set("memoryCurrent", number(s.memoryCurrent));
+    result.Set("memoryPeak", number(s.memoryPeak));
+    result.Set("memoryHighEvents", number(s.memoryHighEvents));
+    result.Set("memoryMaxEvents", number(s.memoryMaxEvents));
+    result.Set("oomKills", number(s.oomKills));
+    result.Set("ioReadBytes", number(s.ioReadBytes));
+    result.Set("ioWriteBytes", number(s.ioWriteBytes));
+    result.Set("pids", number(s.pids));
+    return result;
+}
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+Napi::Value SampleSandboxResources(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsNumber()) return env.Null();
+
+    int64_t pid = info[0].As<Napi::Number>().Int64Value();
+    GovernedGroupPtr group = FindGoverned(pid);
+    if (!group) return env.Null();
+
+    TimedSample timed{pid, NowMs(), {}};
+    if (!SampleGovernedGroup(*group, timed.sample)) return env.Null();
+    return SampleToObject(env, timed);
+}
+
+Napi::Value StartResourceSampler(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsFunction()) {
+        Napi::TypeError::New(env, "startResourceSampler expects (intervalMs, callback)")
+            .ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    int64_t intervalMs = info[0].As<Napi::Number>().Int64Value();
+    ResourceSampler::Instance().Start(
+        env, info[1].As<Napi::Function>(),
+        static_cast<uint32_t>(std::clamp<int64_t>(intervalMs, 10, 3600000)));
+    return env.Undefined();
+}
+
+Napi::Value StopResourceSampler(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    ResourceSampler& sampler = ResourceSampler::Instance();
+    sampler.Stop();
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("passes", Napi::Number::New(env, static_cast<double>(sampler.Passes())));
+    result.Set("dropped", Napi::Number::New(env, static_cast<double>(sampler.Dropped())));
+    return result;
+}
+
+Napi::Value ReleaseSandboxResources(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() >= 1 && info[0].IsNumber()) {
+        ReleaseGovernedProcess(info[0].As<Napi::Number>().Int64Value());
+    }
+    return env.Undefined();
+}
+
+Napi::Value AttachProcessTree(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsNumber()) return Napi::Boolean::New(env, false);
+    int64_t pid = info[0].As<Napi::Number>().Int64Value();
+
+    std::vector<std::string> unsupported;
+    std::string error;
+    GovernedGroupPtr group = CreateGovernedGroup(ResourceLimits{}, unsupported, error);
+    if (!group || !AttachGovernedProcess(*group, pid, error)) {
+        std::cerr << "[ResourceGovernor] Cannot attach " << pid << ": " << error << std::endl;
+        return Napi::Boolean::New(env, false);
+    }
+    RegisterGovernedProcess(pid, std::move(group));
+    return Napi::Boolean::New(env, true);
+}
+
+Napi::Value KillProcessTree(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        auto deferred = Napi::Promise::Deferred::New(env);
+        deferred.Reject(Napi::TypeError::New(env, "killProcessTree expects a pid").Value());
+        return deferred.Promise();
+    }
+
+    int64_t timeoutMs = 5000;
+    if (info.Length() > 1 && info[1].IsNumber()) {
+        timeoutMs = std::max<int64_t>(0, info[1].As<Napi::Number>().Int64Value());
+    }
+
+    auto* worker = new KillTreeWorker(env, info[0].As<Napi::Number>().Int64Value(), timeoutMs);
+    Napi::Promise promise = worker->Promise();
+    worker->Queue();
+    return promise;
+}
+
+Napi::Value SetResourceGovernorRoot(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+#ifdef __linux__
+    std::lock_guard<std::mutex> lock(g_rootMutex);
+    g_root = GovernorRoot{};
+    if (info.Length() >= 1 && info[0].IsString()) {
+        g_root.configured = info[0].As<Napi::String>().Utf8Value();
+    }
+#endif
+    return env.Undefined();
+}
+
+Napi::Value GetResourceGovernorSupport(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Object result = Napi::Object::New(env);
+    Napi::Array limits = Napi::Array::New(env);
+    auto add = [&limits, &env](const char* name) {
+        limits.Set(limits.Length(), Napi::String::New(env, name));
+    };
+
+#ifdef __linux__
+    std::lock_guard<std::mutex> lock(g_rootMutex);
+    ResolveRootLocked();
+    auto has = [](const char* controller) {
+        return std::find(g_root.controllers.begin(), g_root.controllers.end(), controller) !=
+               g_root.controllers.end();
+    };
+    if (has("cpu")) {
+        add("cpuWeight");
+        add("cpuQuotaPercent");
+    }
+    if (has("memory")) {
+        add("memoryMax");
+        add("memoryHigh");
+    }
+    if (has("pids")) add("pidsMax");
+    if (has("io")) add("ioWeight");
+
+    result.Set("available", Napi::Boolean::New(env, !g_root.path.empty()));
+    result.Set("root", Napi::String::New(env, g_root.path));
+    if (!g_root.error.empty()) result.Set("error", Napi::String::New(env, g_root.error));
+#else
+    add("cpuWeight");
+    add("cpuQuotaPercent");
+    add("memoryMax");
+    add("pidsMax");
+    result.Set("available", Napi::Boolean::New(env, true));
+    result.Set("root", Napi::String::New(env, ""));
+#endif
+    result.Set("limits", limits);
+    return result;
+}
+
+#else // !__linux__ && !_WIN32
+
+// ============================================================================
+// Stubs for other platforms
+// ============================================================================
+
+Napi::Value SampleSandboxResources(const Napi::CallbackInfo& info) {
+    return info.Env().Null();
+}
+
+Napi::Value StartResourceSampler(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Error::New(env, "Resource governor is only available on Linux and Windows")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+}
+
+Napi::Value StopResourceSampler(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("passes", Napi::Number::New(env, 0));
+    result.Set("dropped", Napi::Number::New(env, 0));
+    return result;
+}
+
+Napi::Value ReleaseSandboxResources(const Napi::CallbackInfo& info) {
+    return info.Env().Undefined();
+}
+
+Napi::Value AttachProcessTree(const Napi::CallbackInfo& info) {
+    return Napi::Boolean::New(info.Env(), false);
+}
+
+Napi::Value KillProcessTree(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    auto deferred = Napi::Promise::Deferred::New(env);
+    deferred.Reject(
+        Napi::Error::New(env, "Process tree teardown is only available on Linux and Windows").Value());
+    return deferred.Promise();
+}
+
+Napi::Value SetResourceGovernorRoot(const Napi::CallbackInfo& info) {
+    return info.Env().Undefined();
+}
+
+Napi::Value GetResourceGovernorSupport(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("available", Napi::Boolean::New(env, false));
+    result.Set("root", Napi::String::New(env, ""));
+    result.Set("limits", Napi::Array::New(env));
+    return result;
+}
+
+#endif
+
+} // namespace TerminAI
@@ -0,0 +1,302 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Resource Governor Header
+ *
+ * Per-sandbox resource limits, usage accounting and process-tree lifetime,
+ * shared by both launchers:
+ *
+ *   Linux    one cgroup v2 per sandbox under the governor root; the child
+ *            joins it before unshare/execve, so everything it spawns is
+ *            accounted and limited with it
+ *   Windows  one Job Object per sandbox; the process is created suspended,
+ *            assigned to the job, then resumed
+ *
+ *   limit            Linux (cgroup v2)      Windows (Job Object)
+ *   ---------------  ---------------------  ------------------------------
+ *   cpuWeight        cpu.weight             CPU rate control, weight 1..9
+ *   cpuQuotaPercent  cpu.max               CPU rate control, hard cap
+ *   memoryMax        memory.max             JobMemoryLimit
+ *   memoryHigh       memory.high            (unsupported)
+ *   pidsMax          pids.max (tasks)       ActiveProcessLimit (processes)
+ *   ioWeight         io.weight              (unsupported)
+ *
+ * Limits the host cannot enforce (controller not delegated, no API) are
+ * reported and skipped rather than failing the launch; callers that need
+ * a limit can check getResourceGovernorSupport() first.
+ *
+ * The governor root on Linux is, in order: setResourceGovernorRoot(),
+ * $TERMINAI_CGROUP_ROOT, or the caller's own cgroup. Controllers can only be
+ * handed to children of a cgroup that has no processes of its own, so
+ * limits need a delegated, empty root (for example a systemd unit with
+ * Delegate=yes, with the CLI itself moved into a sibling leaf). Without one
+ * sandboxes still get a cgroup for CPU accounting.
+ *
+ * A group is also the unit of teardown. killProcessTree() ends everything
+ * in it in one kernel operation (cgroup.kill / TerminateJobObject), so
+ * descendants cannot escape by forking, daemonizing or calling setsid, and
+ * it waits for the group to empty on a kernel notification (cgroup.events /
+ * job completion port) instead of polling. Releasing a group that still
+ * has members kills them (Job Objects are created with kill-on-close, and
+ * the cgroup is killed before removal), so a sandbox never outlives its
+ * owner.
+ *
+ * Samples are read from file descriptors opened once per sandbox (one
+ * pread per stat file), so a sampling pass costs a handful of system calls
+ * per sandbox and no allocation beyond the result.
+ */
+
+#pragma once
+
+#include <napi.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+namespace TerminAI {
+
+// ============================================================================
+// Types
+// ============================================================================
+
+/** Zero means "not set" for every field. */
+struct ResourceLimits {
+    /** Relative CPU share, 1..10000 (cgroup default 100) */
+    uint32_t cpuWeight = 0;
+    /** CPU time per wall time, in percent of one CPU (150 = 1.5 CPUs) */
+    uint32_t cpuQuotaPercent = 0;
+    /** Hard memory limit in bytes (OOM kill above it) */
+    uint64_t memoryMax = 0;
+    /** Memory throttling threshold in bytes (reclaim pressure above it) */
+    uint64_t memoryHigh = 0;
+    uint32_t pidsMax = 0;
+    /** Relative I/O share, 1..10000 (cgroup default 100) */
+    uint32_t ioWeight = 0;
+};
+
+/** Cumulative counters since the sandbox started, except where noted. */
+struct ResourceSample {
+    uint64_t cpuUsageUs = 0;
+    uint64_t cpuUserUs = 0;
+    uint64_t cpuSystemUs = 0;
+    /** Periods in which the CPU quota was exhausted, and time spent so */
+    uint64_t cpuThrottledCount = 0;
+    uint64_t cpuThrottledUs = 0;
+    /** Current resident memory (point in time) */
+    uint64_t memoryCurrent = 0;
+    uint64_t memoryPeak = 0;
+    /** Times memoryHigh throttled / memoryMax was hit / OOM kills */
+    uint64_t memoryHighEvents = 0;
+    uint64_t memoryMaxEvents = 0;
+    uint64_t oomKills = 0;
+    uint64_t ioReadBytes = 0;
+    uint64_t ioWriteBytes = 0;
+    /** Live tasks (Linux) or processes (Windows), point in time */
+    uint64_t pids = 0;
+};
+
+struct TreeKillResult {
+    /** "cgroup", "job", or without a group "processGroup" / "process" */
+    std::string method;
+    /** From the kill request until the last member exited */
+    uint64_t latencyUs = 0;
+    /** false if members were still alive when the timeout expired */
+    bool complete = false;
+};
+
+/** One sandbox's cgroup or Job Object. Removed when the last owner drops it. */
+class GovernedGroup;
+using GovernedGroupPtr = std::shared_ptr<GovernedGroup>;
+
+// ============================================================================
+// Core Functions
+// ============================================================================
+
+/**
+ * Read a `resources` option object.
+ *
+ * @return false (with error set) on out-of-range or non-numeric values
+ */
+bool ParseResourceLimits(const Napi::Object& object, ResourceLimits& limits, std::string& error);
+
+/**
+ * Create the group for one sandbox and apply the limits.
+ *
+ * @param unsupported Receives the names of limits that were not applied
+ * @param error Receives a description on failure
+ * @return null on failure
+ */
+GovernedGroupPtr CreateGovernedGroup(const ResourceLimits& limits,
+                                     std::vector<std::string>& unsupported,
+                                     std::string& error);
+
+#ifdef __linux__
+/**
+ * Write-only descriptor (O_CLOEXEC) of the group's cgroup.procs. The
+ * sandbox child writes "0" to it to move itself into the group.
+ */
+int GovernedGroupProcsFd(const GovernedGroup& group);
+#endif
+
+#ifdef _WIN32
+HANDLE GovernedGroupJob(const GovernedGroup& group);
+#endif
+
+/**
+ * Move an already running process into a group. Processes it forked before
+ * the move stay outside; callers attach right after spawning.
+ */
+bool AttachGovernedProcess(const GovernedGroup& group, int64_t pid, std::string& error);
+
+/**
+ * Kill every member of a group and wait until it is empty.
+ *
+ * @param timeoutMs How long to wait for the members to exit
+ * @return false (with error set) if the kill could not be issued
+ */
+bool KillGovernedGroup(const GovernedGroup& group, int64_t timeoutMs, TreeKillResult& result,
+                       std::string& error);
+
+/**
+ * Read the group's counters.
+ */
+bool SampleGovernedGroup(const GovernedGroup& group, ResourceSample& sample);
+
+/**
+ * Kill a process and its descendants: its whole group if it is governed,
+ * otherwise its process group (Linux) or the process alone (Windows), and
+ * wait up to `timeoutMs` for them to exit.
+ *
+ * @return false (with error set) if the kill could not be issued
+ */
+bool KillProcessTreeOf(int64_t pid, int64_t timeoutMs, TreeKillResult& result,
+                       std::string& error);
+
+/**
+ * Track a launched sandbox so samplers see it.
+ */
+void RegisterGovernedProcess(int64_t pid, GovernedGroupPtr group);
+
+/**
+ * Stop tracking a sandbox (after it has been reaped). Members still left in
+ * its group are killed. Safe to call for pids that were never registered.
+ */
+void ReleaseGovernedProcess(int64_t pid);
+
+/**
+ * Resolve the cgroup root and delegate controllers now instead of at the
+ * first sandbox launch (no-op for Job Objects).
+ *
+ * @return false (with error set) when sandboxes cannot be governed
+ */
+bool PrepareResourceGovernor(std::string& error);
+
+// ============================================================================
+// NAPI Helpers
+// ============================================================================
+
+/**
+ * A sample as { cpuUsageUs, cpuUserUs, cpuSystemUs, cpuThrottledCount,
+ * cpuThrottledUs, memoryCurrent, memoryPeak, memoryHighEvents,
+ * memoryMaxEvents, oomKills, ioReadBytes, ioWriteBytes, pids }.
+ */
+Napi::Object ResourceSampleToObject(Napi::Env env, const ResourceSample& sample);
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+/**
+ * Read one sandbox's usage now.
+ *
+ * Arguments:
+ *   0: Number - Sandbox PID
+ *
+ * Returns: Object | null - { pid, timestamp, cpuUsageUs, cpuUserUs,
+ *          cpuSystemUs, cpuThrottledCount, cpuThrottledUs, memoryCurrent,
+ *          memoryPeak, memoryHighEvents, memoryMaxEvents, oomKills,
+ *          ioReadBytes, ioWriteBytes, pids } (null if not governed)
+ */
+Napi::Value SampleSandboxResources(const Napi::CallbackInfo& info);
+
+/**
+ * Sample every governed sandbox on a fixed cadence from a native thread.
+ * Replaces a running sampler. Batches the JS thread has not picked up yet
+ * are dropped rather than queued, and empty passes deliver nothing.
+ *
+ * Arguments:
+ *   0: Number - Interval in ms (>= 10)
+ *   1: Function - (samples: Object[]) => void
+ */
+Napi::Value StartResourceSampler(const Napi::CallbackInfo& info);
+
+/**
+ * Stop the sampler.
+ *
+ * Returns: Object - { passes, dropped }
+ */
+Napi::Value StopResourceSampler(const Napi::CallbackInfo& info);
+
+/**
+ * Stop tracking a sandbox, kill whatever is left in its group and remove
+ * the group. Linux sandboxes are released automatically when
+ * waitLinuxSandbox reaps them.
+ *
+ * Arguments:
+ *   0: Number - Sandbox PID
+ */
+Napi::Value ReleaseSandboxResources(const Napi::CallbackInfo& info);
+
+/**
+ * Put a process that was spawned outside the sandbox launchers (e.g. by
+ * child_process) into its own group, so its whole tree can be killed and
+ * sampled. Attach right after spawning: children it forked earlier are not
+ * covered.
+ *
+ * Arguments:
+ *   0: Number - PID
+ *
+ * Returns: Boolean - false if no group could be created or joined
+ */
+Napi::Value AttachProcessTree(const Napi::CallbackInfo& info);
+
+/**
+ * Kill a sandbox (or attached process) and all its descendants.
+ *
+ * Arguments:
+ *   0: Number - PID
+ *   1: Number (optional) - Wait at most this long for the tree to exit
+ *      (default: 5000ms)
+ *
+ * Returns: Promise<Object> - { method, latencyUs, complete }
+ *   Without a group the process group (Linux) or the process alone
+ *   (Windows) is killed, and only the leader's exit is awaited.
+ */
+Napi::Value KillProcessTree(const Napi::CallbackInfo& info);
+
+/**
+ * Set the cgroup that sandbox groups are created under (Linux).
+ *
+ * Arguments:
+ *   0: String (optional) - Absolute cgroup directory; omitted = default
+ */
+Napi::Value SetResourceGovernorRoot(const Napi::CallbackInfo& info);
+
+/**
+ * Describe what the governor can enforce on this host.
+ *
+ * Returns: Object - { available: Boolean, root: String,
+ *                     limits: String[], error?: String }
+ */
+Napi::Value GetResourceGovernorSupport(const Napi::CallbackInfo& info);
+
+} // namespace TerminAI
@@ -0,0 +1,612 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Precompiled Rule Database Implementation
+ */
+
+#include "rule_database.h"
+#include "blake3.h"
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+
+namespace TerminAI {
+
+namespace {
+
+constexpr char RULES_MAGIC[8] = {'T', 'A', 'I', 'R', 'U', 'L', 'E', 'S'};
+constexpr uint32_t RULES_VERSION = 1;
+constexpr size_t SECTION_ALIGN = 64;
+
+/**
+ * Rules of at least NARROW_KEY bytes are indexed by a hash of their first
+ * NARROW_KEY bytes, or their first WIDE_KEY bytes once they are that long,
+ * so rules that share a short common prefix still spread over the buckets.
+ */
+constexpr size_t NARROW_KEY = 4;
+constexpr size_t WIDE_KEY = 8;
+
+constexpr uint32_t FILTER_BITS = 1u << 16;
+constexpr uint64_t FILTER_BYTES = FILTER_BITS / 8;
+constexpr uint64_t SHORT_INDEX_BYTES = 257 * sizeof(uint32_t);
+
+/** About one long rule per bucket, within these bounds. */
+constexpr uint32_t MIN_BUCKET_BITS = 4;
+constexpr uint32_t MAX_BUCKET_BITS = 24;
+
+struct RulesHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerBytes;
+    uint32_t rules;
+    /** Rules shorter than NARROW_KEY; they come first in the rules section */
+    uint32_t shortRules;
+    uint32_t bucketBits;
+    /** Rules of WIDE_KEY bytes or more */
+    uint32_t wideRules;
+    uint64_t filterOffset;
+    uint64_t shortOffset;
+    uint64_t bucketsOffset;
+    uint64_t rulesOffset;
+    uint64_t stringsOffset;
+    uint64_t stringsBytes;
+    uint64_t fileBytes;
+    /** First 8 bytes of BLAKE3 over everything after the header */
+    uint8_t checksum[8];
+    uint8_t padding[32];
+};
+
+static_assert(sizeof(RulesHeader) == 128, "header is two cache lines");
+
+struct RuleRecord {
+    /** The rule's index key: its first 4 or 8 bytes, little-endian */
+    uint64_t key;
+    uint32_t patternLength;
+    /** Offsets into the strings section */
+    uint32_t patternOffset;
+    uint32_t nameOffset;
+    uint32_t nameLength;
+};
+
+static_assert(sizeof(RuleRecord) == 24, "records are packed");
+
+inline uint64_t LoadKey(const uint8_t* p, bool wide) {
+    if (wide) {
+        uint64_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+/** Fibonacci hashing: the high bits of the product are well mixed. */
+inline uint32_t KeyHash(uint64_t key, bool wide) {
+    return wide ? static_cast<uint32_t>((key * 0x9e3779b97f4a7c15ull) >> 32)
+                : static_cast<uint32_t>(key) * 0x9e3779b1u;
+}
+
+uint64_t AlignUp(uint64_t value) {
+    return (value + SECTION_ALIGN - 1) & ~static_cast<uint64_t>(SECTION_ALIGN - 1);
+}
+
+void Checksum(const uint8_t* data, size_t length, uint8_t out[8]) {
+    Blake3Hasher hasher;
+    hasher.Update(data, length);
+    Blake3Digest digest = hasher.Finalize();
+    std::memcpy(out, digest.bytes, 8);
+}
+
+} // namespace
+
+// ============================================================================
+// Database
+// ============================================================================
+
+class RuleDatabase {
+public:
+    MappedFile file;
+    const uint8_t* filter = nullptr;
+    const uint32_t* shortIndex = nullptr;
+    const uint32_t* buckets = nullptr;
+    const RuleRecord* records = nullptr;
+    const uint8_t* strings = nullptr;
+    uint64_t stringsBytes = 0;
+    uint32_t rules = 0;
+    uint32_t shortRules = 0;
+    uint32_t bucketShift = 0;
+    bool hasNarrow = false;
+    bool hasWide = false;
+};
+
+namespace {
+
+/** The record's pattern, or nullptr if its offsets point outside the file. */
+const uint8_t* PatternOf(const RuleDatabase& db, const RuleRecord& record) {
+    if (record.patternOffset > db.stringsBytes ||
+        record.patternLength > db.stringsBytes - record.patternOffset) {
+        return nullptr;
+    }
+    return db.strings + record.patternOffset;
+}
+
+bool MatchesAt(const RuleDatabase& db, uint32_t index, const uint8_t* at, size_t remaining) {
+    const RuleRecord& record = db.records[index];
+    const uint8_t* pattern = PatternOf(db, record);
+    return pattern != nullptr && record.patternLength > 0 && record.patternLength <= remaining &&
+           std::memcmp(pattern, at, record.patternLength) == 0;
+}
+
+/**
+ * Look the 4- or 8-byte key at `at` up in the filter and its bucket.
+ *
+ * @return the index of a rule matching at `at`, or -1
+ */
+int64_t Probe(const RuleDatabase& db, bool wide, const uint8_t* at, size_t remaining) {
+    const uint64_t key = LoadKey(at, wide);
+    const uint32_t hash = KeyHash(key, wide);
+    if (((db.filter[hash >> 19] >> ((hash >> 16) & 7)) & 1) == 0) return -1;
+
+    const uint32_t bucket = hash >> db.bucketShift;
+    const uint32_t first = std::max(db.buckets[bucket], db.shortRules);
+    const uint32_t last = std::min(db.buckets[bucket + 1], db.rules);
+    for (uint32_t r = first; r < last; r++) {
+        const RuleRecord& record = db.records[r];
+        if (record.key == key && (record.patternLength >= WIDE_KEY) == wide &&
+            MatchesAt(db, r, at, remaining)) {
+            return r;
+        }
+    }
+    return -1;
+}
+
+void Report(const RuleDatabase& db, uint32_t index, uint64_t offset, RuleMatch& match) {
+    const RuleRecord& record = db.records[index];
+    if (record.nameOffset <= db.stringsBytes &&
+        record.nameLength <= db.stringsBytes - record.nameOffset) {
+        match.name.assign(reinterpret_cast<const char*>(db.strings + record.nameOffset),
+                          record.nameLength);
+    } else {
+        match.name = "rule " + std::to_string(index);
+    }
+    match.offset = offset;
+}
+
+} // namespace
+
+bool MatchRuleDatabase(const RuleDatabase& db, const uint8_t* data, size_t length,
+                       RuleMatch& match) {
+    const bool hasShort = db.shortRules > 0;
+
+    for (size_t i = 0; i < length; i++) {
+        const size_t remaining = length - i;
+
+        if (hasShort) {
+            uint32_t first = db.shortIndex[data[i]];
+            uint32_t last = std::min(db.shortIndex[data[i] + 1], db.shortRules);
+            for (uint32_t r = first; r < last; r++) {
+                if (MatchesAt(db, r, data + i, remaining)) {
+                    Report(db, r, i, match);
+                    return true;
+                }
+            }
+        }
+
+        int64_t rule = -1;
+        if (db.hasNarrow && remaining >= NARROW_KEY) rule = Probe(db, false, data + i, remaining);
+        if (rule < 0 && db.hasWide && remaining >= WIDE_KEY) {
+            rule = Probe(db, true, data + i, remaining);
+        }
+        if (rule >= 0) {
+            Report(db, static_cast<uint32_t>(rule), i, match);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::shared_ptr<const RuleDatabase> OpenRuleDatabase(const std::string& path, bool verify,
+                                                     std::string& error) {
+    auto db = std::make_shared<RuleDatabase>();
+    if (!db->file.Open(path, error)) return nullptr;
+
+    const uint8_t* data = db->file.Data();
+    const uint64_t size = db->file.Size();
+    auto invalid = [&](const char* why) {
+        error = path + ": " + why;
+        return nullptr;
+    };
+    if (size < sizeof(RulesHeader) || std::memcmp(data, RULES_MAGIC, sizeof(RULES_MAGIC)) != 0) {
+        return invalid("not a rule database");
+    }
+
+    const auto* header = reinterpret_cast<const RulesHeader*>(data);
+    if (header->version != RULES_VERSION) {
+        return invalid("unsupported rule database version");
+    }
+
+    // Sections follow one another in order. Each check only uses values the
+    // previous checks bounded by the file size, so nothing overflows.
+    uint64_t end = sizeof(RulesHeader);
+    auto section = [&](uint64_t offset, uint64_t bytes) {
+        bool ok = offset % SECTION_ALIGN == 0 && offset >= end && offset <= size &&
+                  bytes <= size - offset;
+        end = offset + bytes;
+        return ok;
+    };
+    const uint32_t bits = header->bucketBits;
+    if (header->headerBytes != sizeof(RulesHeader) || header->fileBytes != size ||
+        header->shortRules > header->rules ||
+        header->wideRules > header->rules - header->shortRules || bits < MIN_BUCKET_BITS || bits > MAX_BUCKET_BITS ||
+        !section(header->filterOffset, FILTER_BYTES) ||
+        !section(header->shortOffset, SHORT_INDEX_BYTES) ||
+        !section(header->bucketsOffset, ((1ull << bits) + 1) * sizeof(uint32_t)) ||
+        !section(header->rulesOffset, static_cast<uint64_t>(header->rules) * sizeof(RuleRecord)) ||
+        !section(header->stringsOffset, header->stringsBytes) || end != size) {
+        return invalid("corrupt rule database header");
+    }
+
+    if (verify) {
+        uint8_t checksum[8];
+        Checksum(data + sizeof(RulesHeader), size - sizeof(RulesHeader), checksum);
+        if (std::memcmp(checksum, header->checksum, sizeof(checksum)) != 0) {
+            return invalid("rule database checksum mismatch");
+        }
+    }
+
+    db->filter = data + header->filterOffset;
+    db->shortIndex = reinterpret_cast<const uint32_t*>(data + header->shortOffset);
+    db->buckets = reinterpret_cast<const uint32_t*>(data + header->bucketsOffset);
+    db->records = reinterpret_cast<const RuleRecord*>(data + header->rulesOffset);
+    db->strings = data + header->stringsOffset;
+    db->stringsBytes = header->stringsBytes;
+    db->rules = header->rules;
+    db->shortRules = header->shortRules;
+    db->bucketShift = 32 - bits;
+    db->hasNarrow = header->rules - header->shortRules > header->wideRules;
+    db->hasWide = header->wideRules > 0;
+    return db;
+}
+
+bool CompileRuleDatabase(const std::vector<ScanSignature>& rules, const std::string& path,
+                         RuleCompileStats& stats, std::string& error) {
+    auto start = std::chrono::steady_clock::now();
+    stats = RuleCompileStats();
+
+    if (rules.size() >= UINT32_MAX) {
+        error = "rule databases hold at most 2^32 - 2 rules";
+        return false;
+    }
+    uint64_t stringsBytes = 0;
+    uint32_t longRules = 0;
+    uint32_t wideRules = 0;
+    for (size_t i = 0; i < rules.size(); i++) {
+        if (rules[i].pattern.empty()) {
+            error = "rule " + std::to_string(i) + " has an empty pattern";
+            return false;
+        }
+        stringsBytes += rules[i].pattern.size() + rules[i].name.size();
+        if (rules[i].pattern.size() >= NARROW_KEY) longRules++;
+        if (rules[i].pattern.size() >= WIDE_KEY) wideRules++;
+    }
+    if (stringsBytes > UINT32_MAX) {
+        error = "rule patterns and names exceed 4 GiB";
+        return false;
+    }
+    const uint32_t count = static_cast<uint32_t>(rules.size());
+    const uint32_t shortRules = count - longRules;
+
+    uint32_t bits = MIN_BUCKET_BITS;
+    while (bits < MAX_BUCKET_BITS && (1u << bits) < longRules) bits++;
+    const uint32_t buckets = 1u << bits;
+
+    // Sort keys: short rules by first byte, then long rules by bucket, each
+    // counted into its index (a counting sort, so equal keys keep rule order).
+    auto keyOf = [&](const ScanSignature& rule) -> uint64_t {
+        const auto* bytes = reinterpret_cast<const uint8_t*>(rule.pattern.data());
+        if (rule.pattern.size() < NARROW_KEY) return bytes[0];
+        const bool wide = rule.pattern.size() >= WIDE_KEY;
+        return 256 + (KeyHash(LoadKey(bytes, wide), wide) >> (32 - bits));
+    };
+    std::vector<uint32_t> keyStart(256 + buckets + 1, 0);
+    for (const ScanSignature& rule : rules) keyStart[keyOf(rule) + 1]++;
+    for (size_t k = 0; k + 1 < keyStart.size(); k++) keyStart[k + 1] += keyStart[k];
+    std::vector<uint32_t> order(count);
+    {
+        std::vector<uint32_t> next(keyStart);
+        for (uint32_t i = 0; i < count; i++) order[next[keyOf(rules[i])]++] = i;
+    }
+
+    RulesHeader header = {};
+    std::memcpy(header.magic, RULES_MAGIC, sizeof(header.magic));
+    header.version = RULES_VERSION;
+    header.headerBytes = sizeof(RulesHeader);
+    header.rules = count;
+    header.shortRules = shortRules;
+    header.bucketBits = bits;
+    header.wideRules = wideRules;
+    header.filterOffset = AlignUp(sizeof(RulesHeader));
+    header.shortOffset = AlignUp(header.filterOffset + FILTER_BYTES);
+    header.bucketsOffset = AlignUp(header.shortOffset + SHORT_INDEX_BYTES);
+    header.rulesOffset = AlignUp(header.bucketsOffset + (buckets + 1ull) * sizeof(uint32_t));
+    header.stringsOffset =
+        AlignUp(header.rulesOffset + static_cast<uint64_t>(count) * sizeof(RuleRecord));
+    header.stringsBytes = stringsBytes;
+    header.fileBytes = header.stringsOffset + stringsBytes;
+
+    std::vector<uint8_t> image(header.fileBytes, 0);
+    uint8_t* filter = image.data() + header.filterOffset;
+    auto* shortIndex = reinterpret_cast<uint32_t*>(image.data() + header.shortOffset);
+    auto* bucketIndex = reinterpret_cast<uint32_t*>(image.data() + header.bucketsOffset);
+    auto* records = reinterpret_cast<RuleRecord*>(image.data() + header.rulesOffset);
+    uint8_t* strings = image.data() + header.stringsOffset;
+
+    std::memcpy(shortIndex, keyStart.data(), SHORT_INDEX_BYTES);
+    std::memcpy(bucketIndex, keyStart.data() + 256, (buckets + 1ull) * sizeof(uint32_t));
+
+    uint32_t cursor = 0;
+    for (uint32_t slot = 0; slot < count; slot++) {
+        const ScanSignature& rule = rules[order[slot]];
+        const auto* bytes = reinterpret_cast<const uint8_t*>(rule.pattern.data());
+        RuleRecord& record = records[slot];
+        if (rule.pattern.size() >= NARROW_KEY) {
+            const bool wide = rule.pattern.size() >= WIDE_KEY;
+            record.key = LoadKey(bytes, wide);
+            uint32_t hash = KeyHash(record.key, wide);
+            filter[hash >> 19] |= static_cast<uint8_t>(1u << ((hash >> 16) & 7));
+        }
+        record.patternLength = static_cast<uint32_t>(rule.pattern.size());
+        record.patternOffset = cursor;
+        std::memcpy(strings + cursor, bytes, rule.pattern.size());
+        cursor += record.patternLength;
+        record.nameLength = static_cast<uint32_t>(rule.name.size());
+        record.nameOffset = cursor;
+        if (!rule.name.empty()) std::memcpy(strings + cursor, rule.name.data(), rule.name.size());
+        cursor += record.nameLength;
+    }
+
+    Checksum(image.data() + sizeof(header), image.size() - sizeof(header), header.checksum);
+    std::memcpy(image.data(), &header, sizeof(header));
+    // Replaces an existing database; a process that has it mapped keeps the old one.
+    if (!ReplaceFileContents(path, image, error)) return false;
+
+    stats.rules = count;
+    stats.bytes = header.fileBytes;
+    stats.durationMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+// ============================================================================
+// Active Database
+// ============================================================================
+
+namespace {
+
+class RuleDatabaseStore {
+public:
+    static RuleDatabaseStore& Instance() {
+        static RuleDatabaseStore* store = new RuleDatabaseStore();
+        return *store;
+    }
+
+    std::shared_ptr<const RuleDatabase> Current() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return database_;
+    }
+
+    bool Load(const std::string& path, bool verify, std::string& error) {
+        auto database = OpenRuleDatabase(path, verify, error);
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!database) {
+            lastError_ = error;
+            return false;
+        }
+        database_ = std::move(database);
+        path_ = path;
+        version_++;
+        generation_.fetch_add(1, std::memory_order_release);
+        lastError_.clear();
+        return true;
+    }
+
+    void Unload() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (database_) generation_.fetch_add(1, std::memory_order_release);
+        database_.reset();
+        path_.clear();
+        lastError_.clear();
+    }
+
+    uint64_t Generation() const { return generation_.load(std::memory_order_acquire); }
+
+    void Record(bool matched) {
+        scans_.fetch_add(1, std::memory_order_relaxed);
+        if (matched) matches_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    struct Info {
+        bool loaded;
+        std::string path;
+        uint64_t rules;
+        uint64_t bytes;
+        uint64_t version;
+        uint64_t scans;
+        uint64_t matches;
+        std::string lastError;
+    };
+
+    Info Describe() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return {
+            database_ != nullptr,
+            path_,
+            database_ ? database_->rules : 0,
+            database_ ? database_->file.Size() : 0,
+            version_,
+            scans_.load(),
+            matches_.load(),
+            lastError_,
+        };
+    }
+
+    uint64_t Version() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return version_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::shared_ptr<const RuleDatabase> database_;
+    std::string path_;
+    std::string lastError_;
+    uint64_t version_ = 0;
+    std::atomic<uint64_t> generation_{0};
+
+    std::atomic<uint64_t> scans_{0};
+    std::atomic<uint64_t> matches_{0};
+};
+
+} // namespace
+
+std::shared_ptr<const RuleDatabase> CurrentRuleDatabase() {
+    return RuleDatabaseStore::Instance().Current();
+}
+
+uint64_t RuleDatabaseGeneration() {
+    return RuleDatabaseStore::Instance().Generation();
+}
+
+void RecordRuleDatabaseScan(bool matched) {
+    RuleDatabaseStore::Instance().Record(matched);
+}
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+namespace {
+
+class CompileRulesWorker : public Napi::AsyncWorker {
+public:
+    CompileRulesWorker(Napi::Env env, std::vector<ScanSignature> rules, std::string path)
+        : Napi::AsyncWorker(env),
+          deferred_(Napi::Promise::Deferred::New(env)),
+          rules_(std::move(rules)),
+          path_(std::move(path)) {}
+
+    Napi::Promise Promise() const { return deferred_.Promise(); }
+
+    void Execute() override {
+        std::string error;
+        if (!CompileRuleDatabase(rules_, path_, stats_, error)) SetError(error);
+    }
+
+    void OnOK() override {
+        Napi::Env env = Env();
+        Napi::Object out = Napi::Object::New(env);
+        out.Set("rules", Napi::Number::New(env, static_cast<double>(stats_.rules)));
+        out.Set("bytes", Napi::Number::New(env, static_cast<double>(stats_.bytes)));
+        out.Set("durationMs", Napi::Number::New(env, stats_.durationMs));
+        deferred_.Resolve(out);
+    }
+
+    void OnError(const Napi::Error& error) override { deferred_.Reject(error.Value()); }
+
+private:
+    Napi::Promise::Deferred deferred_;
+    std::vector<ScanSignature> rules_;
+    std::string path_;
+    RuleCompileStats stats_;
+};
+
+Napi::Value RejectedPromise(Napi::Env env, const std::string& message) {
+    auto deferred = Napi::Promise::Deferred::New(env);
+    deferred.Reject(Napi::TypeError::New(env, message).Value());
+    return deferred.Promise();
+}
+
+Napi::Object LoadResult(Napi::Env env, bool ok, const std::string& error, double loadMs) {
+    auto database = CurrentRuleDatabase();
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("ok", Napi::Boolean::New(env, ok));
+    result.Set("rules", Napi::Number::New(env, database ? database->rules : 0));
+    result.Set("version",
+               Napi::Number::New(env, static_cast<double>(RuleDatabaseStore::Instance().Version())));
+    result.Set("loadMs", Napi::Number::New(env, loadMs));
+    if (!ok) result.Set("error", Napi::String::New(env, error));
+    return result;
+}
+
+} // namespace
+
+Napi::Value CompileRuleDatabaseExport(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[1].IsString() || info[1].As<Napi::String>().Utf8Value().empty()) {
+        return RejectedPromise(env, "compileRuleDatabase expects an array of rules and an output path");
+    }
+    std::vector<ScanSignature> rules;
+    std::string error;
+    if (!ReadScanSignatures(info[0], rules, error)) return RejectedPromise(env, error);
+
+    auto* worker = new CompileRulesWorker(env, std::move(rules),
+                                          info[1].As<Napi::String>().Utf8Value());
+    Napi::Promise promise = worker->Promise();
+    worker->Queue();
+    return promise;
+}
+
+Napi::Value LoadRuleDatabase(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        return LoadResult(env, false, "Invalid arguments", 0);
+    }
+
+    bool verify = false;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Value value = info[1].As<Napi::Object>().Get("verify");
+        verify = value.IsBoolean() && value.As<Napi::Boolean>().Value();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::string error;
+    bool ok =
+        RuleDatabaseStore::Instance().Load(info[0].As<Napi::String>().Utf8Value(), verify, error);
+    double loadMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    return LoadResult(env, ok, error, loadMs);
+}
+
+Napi::Value GetRuleDatabaseInfo(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    RuleDatabaseStore::Info state = RuleDatabaseStore::Instance().Describe();
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("loaded", Napi::Boolean::New(env, state.loaded));
+    result.Set("path", state.path.empty() ? env.Null() : Napi::String::New(env, state.path));
+    result.Set("rules", Napi::Number::New(env, static_cast<double>(state.rules)));
+    result.Set("bytes", Napi::Number::New(env, static_cast<double>(state.bytes)));
+    result.Set("version", Napi::Number::New(env, static_cast<double>(state.version)));
+    result.Set("scans", Napi::Number::New(env, static_cast<double>(state.scans)));
+    result.Set("matches", Napi::Number::New(env, static_cast<double>(state.matches)));
+    result.Set("lastError",
+               state.lastError.empty() ? env.Null() : Napi::String::New(env, state.lastError));
+    return result;
+}
+
+Napi::Value UnloadRuleDatabase(const Napi::CallbackInfo& info) {
+    RuleDatabaseStore::Instance().Unload();
+    return info.Env().Undefined();
+}
+
+} // namespace TerminAI
@@ -0,0 +1,154 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Precompiled Rule Database Header
+ *
+ * Byte-signature rules for the portable scan engine, compiled offline into
+ * a file that the engine maps read-only and matches against in place.
+ * Every reference inside the file is an offset from a section start, so
+ * there is no parse or fix-up step: loading a database of any size costs
+ * a header check, and processes that load the same file share its pages
+ * through the page cache instead of each building private tables.
+ *
+ * Matching (one pass over the input, whatever the rule count):
+ *
+ *   - rules of 4 to 7 bytes are indexed by their first 4 bytes, longer
+ *     rules by their first 8. At each input position the next 4 and 8
+ *     bytes are hashed; an 8 KiB bit filter (kept in L1) rejects almost
+ *     every probe, and the rest look at one hash bucket of rule records
+ *     and compare the candidates
+ *   - rules of 1 to 3 bytes are indexed by their first byte
+ *
+ * File layout (little-endian, sections 64-byte aligned):
+ *
+ *   header   128 bytes: magic "TAIRULES", version, rule counts, bucket
+ *            bits, section offsets, file size, BLAKE3 checksum of the
+ *            sections
+ *   filter   65536-bit filter over hashed rule keys
+ *   short    257 uint32: rule index ranges by first byte (short rules)
+ *   buckets  2^bits + 1 uint32: rule index ranges by key hash
+ *   rules    24-byte records: key, pattern and name offsets/lengths,
+ *            short rules first, then long rules in bucket order
+ *   strings  rule patterns and names
+ *
+ * Record indexes and string offsets are bounds-checked as they are read,
+ * so a damaged file can miss rules but never reads outside its mapping;
+ * `verify` on load detects the damage up front.
+ *
+ * One database is active per process, swapped in atomically like the hash
+ * allowlist. Portable scan providers take the active database when they
+ * are created and match it after their own signatures.
+ */
+
+#pragma once
+
+#include <napi.h>
+#include "scan_provider.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace TerminAI {
+
+// ============================================================================
+// Databases
+// ============================================================================
+
+class RuleDatabase;
+
+struct RuleCompileStats {
+    uint64_t rules = 0;
+    uint64_t bytes = 0;
+    double durationMs = 0;
+};
+
+struct RuleMatch {
+    std::string name;
+    /** Input offset of the first matched byte */
+    uint64_t offset = 0;
+};
+
+/**
+ * Compile `rules` into a database file at `path`, written through a
+ * temporary file and a rename. Empty patterns are rejected.
+ *
+ * @return false with a message on invalid rules or I/O failure
+ */
+bool CompileRuleDatabase(const std::vector<ScanSignature>& rules, const std::string& path,
+                         RuleCompileStats& stats, std::string& error);
+
+/**
+ * Map a database. The header and section bounds are always checked;
+ * `verify` also checks the checksum, which reads the whole file.
+ *
+ * @return nullptr with a message if the file is not a valid database
+ */
+std::shared_ptr<const RuleDatabase> OpenRuleDatabase(const std::string& path, bool verify,
+                                                     std::string& error);
+
+/**
+ * Find the rule matching earliest in `data`. Safe to call from any thread.
+ *
+ * @return false if no rule matches
+ */
+bool MatchRuleDatabase(const RuleDatabase& database, const uint8_t* data, size_t length,
+                       RuleMatch& match);
+
+/** The active database, or nullptr. */
+std::shared_ptr<const RuleDatabase> CurrentRuleDatabase();
+
+/**
+ * Changes whenever a database is loaded or unloaded, so verdicts cached
+ * under one database are not reused under another.
+ */
+uint64_t RuleDatabaseGeneration();
+
+/** Count one scan against the active database toward its statistics. */
+void RecordRuleDatabaseScan(bool matched);
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+/**
+ * Compile a rule database file off the main thread.
+ *
+ * Arguments:
+ *   0: Array<{ name: String, pattern: String | Buffer }> - Rules
+ *   1: String - Output path
+ *
+ * Returns: Promise<Object> - { rules, bytes, durationMs }
+ */
+Napi::Value CompileRuleDatabaseExport(const Napi::CallbackInfo& info);
+
+/**
+ * Load a database file and make it the active database. The previous
+ * database stays active if the file is not valid.
+ *
+ * Arguments:
+ *   0: String - Database path
+ *   1: Object (optional) - { verify?: boolean } checksum the whole file
+ *      (default false)
+ *
+ * Returns: Object - { ok, rules, version, loadMs, error? }
+ */
+Napi::Value LoadRuleDatabase(const Napi::CallbackInfo& info);
+
+/**
+ * Describe the active database.
+ *
+ * Returns: Object - { loaded, path, rules, bytes, version, scans, matches,
+ *          lastError }
+ */
+Napi::Value GetRuleDatabaseInfo(const Napi::CallbackInfo& info);
+
+/** Deactivate the active database. */
+Napi::Value UnloadRuleDatabase(const Napi::CallbackInfo& info);
+
+} // namespace TerminAI
@@ -0,0 +1,916 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Linux Sandbox Launcher Implementation
+ */
+
+#include "sandbox_linux.h"
+#include "overlay_workspace.h"
+#include "resource_governor.h"
+#include "seccomp_compiler.h"
+
+#ifdef __linux__
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sched.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/mount.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
+
+extern char** environ;
+
+namespace TerminAI {
+
+namespace {
+
+// ============================================================================
+// Launched Process Registry
+// ============================================================================
+
+std::mutex g_launchedMutex;
+std::unordered_set<pid_t> g_launched;
+
+void TrackLaunched(pid_t pid) {
+    std::lock_guard<std::mutex> lock(g_launchedMutex);
+    g_launched.insert(pid);
+}
+
+bool ForgetLaunched(pid_t pid) {
+    std::lock_guard<std::mutex> lock(g_launchedMutex);
+    return g_launched.erase(pid) > 0;
+}
+
+bool IsLaunched(pid_t pid) {
+    std::lock_guard<std::mutex> lock(g_launchedMutex);
+    return g_launched.count(pid) > 0;
+}
+
+// ============================================================================
+// Child Setup
+// ============================================================================
+
+/** Stage reported through the error pipe when the child fails. */
+enum ChildStage : int32_t {
+    StageNamespace = 1,
+    StageMount = 2,
+    StageExec = 3,
+    StageSeccomp = 4,
+    StageCgroup = 5,
+    StageTerminal = 6,
+    StageNetwork = 7,
+};
+
+struct ChildFailure {
+    int32_t stage;
+    int32_t err;
+};
+
+/**
+ * Everything the child touches after fork(), fully materialized beforehand.
+ */
+struct ChildPlan {
+    std::string executable;
+    std::vector<std::string> argvStorage;
+    std::vector<std::string> envStorage;
+    std::vector<char*> argv;
+    std::vector<char*> envp;
+    std::string cwd;
+    std::string workspace;
+    std::string overlayOptions; // Empty = no overlay
+    std::string seccompCacheDir; // Covered with an empty tmpfs (empty = none)
+    std::string uidMap;
+    std::string gidMap;
+    std::shared_ptr<const SeccompProgram> seccomp;
+    int cgroupProcsFd = -1;
+    int terminalFd = -1;
+    bool isolate = true;
+    /** Our end of the channel the egress listener is sent over (-1 = none) */
+    int egressFd = -1;
+    uint16_t egressPort = 0;
+};
+
+bool WriteProcFile(const char* path, const char* data, size_t length) {
+    int fd = open(path, O_WRONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    bool ok = write(fd, data, length) == static_cast<ssize_t>(length);
+    close(fd);
+    return ok;
+}
+
+/**
+ * Bring up loopback in the child's new network namespace, listen on
+ * 127.0.0.1:port and send the listener over `channel` (SCM_RIGHTS).
+ */
+bool HandOverEgressListener(int channel, uint16_t port) {
+    int control = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (control < 0) return false;
+    struct ifreq request;
+    memset(&request, 0, sizeof(request));
+    memcpy(request.ifr_name, "lo", 3);
+    bool up = ioctl(control, SIOCGIFFLAGS, &request) == 0;
+    request.ifr_flags = static_cast<short>(request.ifr_flags | IFF_UP);
+    up = up && ioctl(control, SIOCSIFFLAGS, &request) == 0;
+    int saved = errno;
+    close(control);
+    errno = saved;
+    if (!up) return false;
+
+    int listener = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listener < 0) return false;
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    int one = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    char byte = 0;
+    struct iovec iov = {&byte, 1};
+    alignas(struct cmsghdr) char buffer[CMSG_SPACE(sizeof(int))];
+    memset(buffer, 0, sizeof(buffer));
+    struct msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = buffer;
+    message.msg_controllen = sizeof(buffer);
+    struct cmsghdr* header = CMSG_FIRSTHDR(&message);
+    header->cmsg_level = SOL_SOCKET;
+    header->cmsg_type = SCM_RIGHTS;
+    header->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(header), &listener, sizeof(int));
+
+    bool sent = bind(listener, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) ==
+                    0 &&
+                listen(listener, SOMAXCONN) == 0 && sendmsg(channel, &message, MSG_NOSIGNAL) == 1;
+    // The sandbox itself keeps no copy: nothing but the proxy accepts on it.
+    saved = errno;
+    close(listener);
+    errno = saved;
+    return sent;
+}
+
+[[noreturn]] void ChildFail(int pipeFd, int32_t stage) {
+    ChildFailure failure{stage, errno};
+    ssize_t ignored = write(pipeFd, &failure, sizeof(failure));
+    (void)ignored;
+    _exit(127);
+}
+
+/**
+ * Runs in the forked child. Async-signal-safe calls only.
+ */
+[[noreturn]] void RunChild(const ChildPlan& plan, int pipeFd) {
+    // Node installs handlers and may block signals; start from defaults.
+    struct sigaction dfl;
+    memset(&dfl, 0, sizeof(dfl));
+    dfl.sa_handler = SIG_DFL;
+    for (int sig = 1; sig < NSIG; sig++) {
+        if (sig != SIGKILL && sig != SIGSTOP) sigaction(sig, &dfl, nullptr);
+    }
+    sigset_t none;
+    sigemptyset(&none);
+    sigprocmask(SIG_SETMASK, &none, nullptr);
+
+    // Own session: the sandbox and its descendants form one process group.
+    setsid();
+
+    // A terminal session: the slave becomes the controlling tty and stdio.
+    if (plan.terminalFd >= 0) {
+        if (ioctl(plan.terminalFd, TIOCSCTTY, 0) != 0) ChildFail(pipeFd, StageTerminal);
+        for (int fd = 0; fd <= 2; fd++) {
+            if (dup2(plan.terminalFd, fd) < 0) ChildFail(pipeFd, StageTerminal);
+        }
+    }
+
+    // Step 0: Join the sandbox's cgroup ("0" = the writer) while still in
+    // the parent's user namespace, where the delegation check passes.
+    if (plan.cgroupProcsFd >= 0 && write(plan.cgroupProcsFd, "0", 1) != 1) {
+        ChildFail(pipeFd, StageCgroup);
+    }
+
+    if (plan.isolate) {
+        // Step 1: User + mount (+ network) namespace with a 1:1 uid/gid mapping
+        int flags = CLONE_NEWUSER | CLONE_NEWNS | (plan.egressFd >= 0 ? CLONE_NEWNET : 0);
+        if (unshare(flags) != 0) ChildFail(pipeFd, StageNamespace);
+        if (!WriteProcFile("/proc/self/setgroups", "deny", 4) && errno != ENOENT) {
+            ChildFail(pipeFd, StageNamespace);
+        }
+        if (!WriteProcFile("/proc/self/uid_map", plan.uidMap.data(), plan.uidMap.size()) ||
+            !WriteProcFile("/proc/self/gid_map", plan.gidMap.data(), plan.gidMap.size())) {
+            ChildFail(pipeFd, StageNamespace);
+        }
+        if (plan.egressFd >= 0 && !HandOverEgressListener(plan.egressFd, plan.egressPort)) {
+            ChildFail(pipeFd, StageNetwork);
+        }
+
+        // Step 2: Keep our mounts out of the parent namespace; mount the overlay
+        if (mount(nullptr, "/", nullptr, MS_REC | MS_PRIVATE, nullptr) != 0) {
+            ChildFail(pipeFd, StageMount);
+        }
+        if (!plan.overlayOptions.empty() &&
+            mount("overlay", plan.workspace.c_str(), "overlay", 0,
+                  plan.overlayOptions.c_str()) != 0) {
+            ChildFail(pipeFd, StageMount);
+        }
+        // Nothing run here may read the seccomp cache key or plant entries.
+        if (!plan.seccompCacheDir.empty() &&
+            mount("tmpfs", plan.seccompCacheDir.c_str(), "tmpfs",
+                  MS_RDONLY | MS_NOSUID | MS_NODEV | MS_NOEXEC, "size=4k,mode=0500") != 0) {
+            ChildFail(pipeFd, StageMount);
+        }
+    }
+
+    // Step 3: Enter the (possibly overlaid) working directory and exec
+    if (chdir(plan.cwd.c_str()) != 0) ChildFail(pipeFd, StageExec);
+
+    // Inherit nothing but stdio (and the CLOEXEC error pipe).
+    syscall(SYS_close_range, 3U, ~0U, 4U /* CLOSE_RANGE_CLOEXEC */);
+
+    // Step 4: Capability filter, last so that setup itself is unrestricted
+    if (plan.seccomp) {
+        int err = InstallSeccompProgram(*plan.seccomp);
+        if (err != 0) {
+            errno = err;
+            ChildFail(pipeFd, StageSeccomp);
+        }
+    }
+
+    execve(plan.executable.c_str(), plan.argv.data(), plan.envp.data());
+    ChildFail(pipeFd, StageExec);
+}
+
+/** Resolve argv[0] against PATH from the child's environment. */
+std::string ResolveExecutable(const std::string& command, const std::vector<std::string>& env) {
+    if (command.find('/') != std::string::npos) return command;
+
+    std::string path = "/usr/local/bin:/usr/bin:/bin";
+    for (const auto& entry : env) {
+        if (entry.compare(0, 5, "PATH=") == 0) {
+            path = entry.substr(5);
+            break;
+        }
+    }
+
+    std::istringstream dirs(path);
+    std::string dir;
+    while (std::getline(dirs, dir, ':')) {
+        std::string candidate = (dir.empty() ? "." : dir) + "/" + command;
+        if (access(candidate.c_str(), X_OK) == 0) return candidate;
+    }
+    return command;
+}
+
+/**
+ * overlayfs splits its options on ',' and lowerdir on ':'; a backslash
+ * makes the next character literal in any of its paths.
+ */
+std::string EscapeOverlayPath(const std::string& path) {
+    std::string escaped;
+    escaped.reserve(path.size());
+    for (char c : path) {
+        if (c == ',' || c == ':' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+/**
+ * Wait until the error pipe has data or EOF.
+ *
+ * @return false if the token stopped the wait first
+ */
+/** The listener HandOverEgressListener() sent, or -1. */
+int ReceiveEgressListener(int channel) {
+    char byte = 0;
+    struct iovec iov = {&byte, 1};
+    alignas(struct cmsghdr) char buffer[CMSG_SPACE(sizeof(int))];
+    struct msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = buffer;
+    message.msg_controllen = sizeof(buffer);
+    // Sent before execve, so it is there once the handshake has passed.
+    if (recvmsg(channel, &message, MSG_DONTWAIT | MSG_CMSG_CLOEXEC) != 1) return -1;
+    struct cmsghdr* header = CMSG_FIRSTHDR(&message);
+    if (header == nullptr || header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS ||
+        header->cmsg_len != CMSG_LEN(sizeof(int))) {
+        return -1;
+    }
+    int fd = -1;
+    memcpy(&fd, CMSG_DATA(header), sizeof(int));
+    return fd;
+}
+
+bool AwaitExecHandshake(int pipeFd, CancelToken* cancel) {
+    if (cancel == nullptr) return true;
+
+    struct pollfd fds[2] = {{pipeFd, POLLIN, 0}, {cancel->WakeFd(), POLLIN, 0}};
+    for (;;) {
+        int ready = poll(fds, fds[1].fd >= 0 ? 2 : 1, cancel->PollTimeoutMs());
+        if (ready < 0 && errno != EINTR) return true; // Fall back to a blocking read
+        if (fds[0].revents != 0) return true;
+        if (cancel->Stopped()) return false;
+    }
+}
+
+} // namespace
+
+// ============================================================================
+// Launcher
+// ============================================================================
+
+LinuxSandboxError LaunchLinuxSandbox(const LinuxSandboxSpec& spec, pid_t& pid, std::string& error) {
+    if (spec.argv.empty() || spec.argv[0].empty() ||
+        (spec.isolate && spec.workspacePath.empty())) {
+        error = "command and workspacePath are required";
+        return LinuxSandboxError::InvalidArguments;
+    }
+
+    bool overlay = !spec.overlayUpper.empty() && !spec.overlayWork.empty();
+    if (overlay && !spec.isolate) {
+        error = "an overlay needs the sandbox's mount namespace";
+        return LinuxSandboxError::InvalidArguments;
+    }
+    if (spec.egress && !spec.isolate) {
+        error = "egress needs the sandbox's network namespace";
+        return LinuxSandboxError::InvalidArguments;
+    }
+
+    ChildPlan plan;
+    plan.argvStorage = spec.argv;
+    plan.envStorage = spec.env;
+    plan.executable = ResolveExecutable(spec.argv[0], spec.env);
+    for (auto& arg : plan.argvStorage) plan.argv.push_back(arg.data());
+    plan.argv.push_back(nullptr);
+    for (auto& var : plan.envStorage) plan.envp.push_back(var.data());
+    plan.envp.push_back(nullptr);
+    plan.workspace = spec.workspacePath;
+    plan.cwd = !spec.cwd.empty()           ? spec.cwd
+             : !spec.workspacePath.empty() ? spec.workspacePath
+                                           : ".";
+    if (overlay) {
+        plan.overlayOptions = "lowerdir=" + EscapeOverlayPath(spec.workspacePath) +
+                              ",upperdir=" + EscapeOverlayPath(spec.overlayUpper) +
+                              ",workdir=" + EscapeOverlayPath(spec.overlayWork) + ",userxattr";
+    }
+    plan.uidMap = std::to_string(getuid()) + " " + std::to_string(getuid()) + " 1\n";
+    plan.gidMap = std::to_string(getgid()) + " " + std::to_string(getgid()) + " 1\n";
+    plan.seccomp = spec.seccomp;
+    plan.cgroupProcsFd = spec.cgroupProcsFd;
+    plan.terminalFd = spec.terminalFd;
+    plan.isolate = spec.isolate;
+    if (spec.isolate) plan.seccompCacheDir = PrepareSeccompCacheDirectory();
+
+    if (IsStopped(spec.cancel)) {
+        error = std::string("launch: ") + CancelReasonMessage(spec.cancel->Outcome());
+        return LinuxSandboxError::Cancelled;
+    }
+
+    int pipeFds[2];
+    if (pipe2(pipeFds, O_CLOEXEC) != 0) {
+        error = std::string("pipe2 failed: ") + strerror(errno);
+        return LinuxSandboxError::ProcessCreationFailed;
+    }
+    int egressFds[2] = {-1, -1};
+    if (spec.egress && socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, egressFds) != 0) {
+        error = std::string("socketpair failed: ") + strerror(errno);
+        close(pipeFds[0]);
+        close(pipeFds[1]);
+        return LinuxSandboxError::ProcessCreationFailed;
+    }
+    plan.egressFd = egressFds[1];
+    plan.egressPort = spec.egressPort;
+    auto closeEgress = [&egressFds]() {
+        for (int& fd : egressFds) {
+            if (fd >= 0) close(fd);
+            fd = -1;
+        }
+    };
+
+    pid_t child = fork();
+    if (child < 0) {
+        error = std::string("fork failed: ") + strerror(errno);
+        close(pipeFds[0]);
+        close(pipeFds[1]);
+        closeEgress();
+        return LinuxSandboxError::ProcessCreationFailed;
+    }
+    if (child == 0) {
+        close(pipeFds[0]);
+        RunChild(plan, pipeFds[1]);
+    }
+
+    close(pipeFds[1]);
+    if (egressFds[1] >= 0) close(egressFds[1]);
+    egressFds[1] = -1;
+
+    // A child stuck in setup (a hung mount, a frozen cgroup) is killed
+    // rather than left holding the caller.
+    if (!AwaitExecHandshake(pipeFds[0], spec.cancel)) {
+        kill(child, SIGKILL);
+        while (waitpid(child, nullptr, 0) < 0 && errno == EINTR) {}
+        close(pipeFds[0]);
+        closeEgress();
+        error = std::string("launch: ") + CancelReasonMessage(spec.cancel->Outcome());
+        return LinuxSandboxError::Cancelled;
+    }
+
+    // EOF means execve succeeded (the CLOEXEC pipe closed).
+    ChildFailure failure{};
+    ssize_t n;
+    do {
+        n = read(pipeFds[0], &failure, sizeof(failure));
+    } while (n < 0 && errno == EINTR);
+    close(pipeFds[0]);
+
+    if (n == static_cast<ssize_t>(sizeof(failure))) {
+        int status;
+        while (waitpid(child, &status, 0) < 0 && errno == EINTR) {}
+        closeEgress();
+
+        const char* what = failure.stage == StageNamespace ? "namespace setup"
+                         : failure.stage == StageNetwork   ? "network setup"
+                         : failure.stage == StageMount     ? "mount"
+                         : failure.stage == StageSeccomp   ? "seccomp"
+                         : failure.stage == StageCgroup    ? "cgroup join"
+                         : failure.stage == StageTerminal  ? "terminal setup"
+                                                           : "exec";
+        error = std::string(what) + " failed: " + strerror(failure.err);
+        std::cerr << "[LinuxSandbox] " << error << std::endl;
+
+        switch (failure.stage) {
+            case StageNamespace:
+            case StageNetwork: return LinuxSandboxError::NamespaceFailed;
+            case StageMount: return LinuxSandboxError::MountFailed;
+            case StageSeccomp: return LinuxSandboxError::CapabilityError;
+            case StageCgroup: return LinuxSandboxError::ResourceError;
+            default: return LinuxSandboxError::ProcessCreationFailed;
+        }
+    }
+
+    if (spec.egress) {
+        int listener = ReceiveEgressListener(egressFds[0]);
+        closeEgress();
+        if (listener < 0) error = "network setup failed: no egress listener from the sandbox";
+        if (listener < 0 || !AttachEgressListener(spec.egress, listener, child, error)) {
+            // Running without its proxy it would have no network at all.
+            kill(-child, SIGKILL);
+            while (waitpid(child, nullptr, 0) < 0 && errno == EINTR) {}
+            std::cerr << "[LinuxSandbox] " << error << std::endl;
+            return LinuxSandboxError::NamespaceFailed;
+        }
+    }
+
+    TrackLaunched(child);
+    pid = child;
+    return LinuxSandboxError::Success;
+}
+
+bool IsLinuxSandboxRunning(pid_t pid) {
+    if (!IsLaunched(pid)) return false;
+
+    // WNOWAIT: peek without reaping, so WaitLinuxSandbox still sees the status.
+    siginfo_t info;
+    memset(&info, 0, sizeof(info));
+    if (waitid(P_PID, static_cast<id_t>(pid), &info, WEXITED | WNOHANG | WNOWAIT) != 0) {
+        return false;
+    }
+    return info.si_pid == 0;
+}
+
+bool ReapLinuxSandbox(pid_t pid, int& status) {
+    if (!IsLaunched(pid)) return false;
+
+    pid_t reaped;
+    do {
+        reaped = waitpid(pid, &status, 0);
+    } while (reaped < 0 && errno == EINTR);
+    if (reaped < 0) return false;
+
+    ForgetLaunched(pid);
+    ReleaseGovernedProcess(pid);
+    return true;
+}
+
+// ============================================================================
+// Reaping
+// ============================================================================
+
+namespace {
+
+class WaitWorker : public Napi::AsyncWorker {
+public:
+    WaitWorker(Napi::Env env, pid_t pid, CancelBinding cancel)
+        : Napi::AsyncWorker(env),
+          deferred_(Napi::Promise::Deferred::New(env)),
+          pid_(pid),
+          cancel_(std::move(cancel)) {}
+
+    Napi::Promise Promise() const { return deferred_.Promise(); }
+
+    void Execute() override {
+        if (!IsLaunched(pid_)) {
+            SetError("Unknown sandbox pid " + std::to_string(pid_));
+            return;
+        }
+
+        // With no deadline and no signal the blocking reap below is the wait.
+        if (cancel_.Armed() && !WaitForExit()) {
+            if (cancel_.Token()->Outcome() == CancelReason::Cancelled) {
+                SetError(CancelReasonMessage(CancelReason::Cancelled));
+            } else {
+                timedOut_ = true;
+            }
+            return;
+        }
+
+        int status = 0;
+        if (!ReapLinuxSandbox(pid_, status)) {
+            SetError(std::string("waitpid failed: ") + strerror(errno));
+            return;
+        }
+
+        if (WIFEXITED(status)) exitCode_ = WEXITSTATUS(status);
+        if (WIFSIGNALED(status)) signal_ = WTERMSIG(status);
+    }
+
+    void OnOK() override {
+        cancel_.Finish();
+        Napi::Env env = Env();
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("exitCode", exitCode_ >= 0 ? Napi::Number::New(env, exitCode_) : env.Null());
+        result.Set("signal", signal_ >= 0 ? Napi::Number::New(env, signal_) : env.Null());
+        result.Set("timedOut", Napi::Boolean::New(env, timedOut_));
+        deferred_.Resolve(result);
+    }
+
+    void OnError(const Napi::Error& error) override {
+        cancel_.Finish();
+        deferred_.Reject(cancel_.Stopped() ? cancel_.StoppedError(Env()) : error.Value());
+    }
+
+private:
+    /** @return true once the child has exited (not yet reaped) */
+    bool WaitForExit() {
+        CancelToken* cancel = cancel_.Token();
+        int pidfd = static_cast<int>(syscall(SYS_pidfd_open, pid_, 0));
+        if (pidfd >= 0) {
+            struct pollfd fds[2] = {{pidfd, POLLIN, 0}, {cancel->WakeFd(), POLLIN, 0}};
+            // The exit is checked before the token, so a zero timeout still
+            // reports a child that has already exited.
+            bool exited = false;
+            for (;;) {
+                int ready = poll(fds, fds[1].fd >= 0 ? 2 : 1, cancel->PollTimeoutMs());
+                if (ready < 0 && errno != EINTR) break;
+                if (fds[0].revents != 0) {
+                    exited = true;
+                    break;
+                }
+                if (cancel->Stopped()) break;
+            }
+            close(pidfd);
+            return exited;
+        }
+
+        // Pre-5.3 kernels: poll the child's state.
+        while (IsLinuxSandboxRunning(pid_)) {
+            if (cancel->Stopped()) return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return true;
+    }
+
+    Napi::Promise::Deferred deferred_;
+    pid_t pid_;
+    CancelBinding cancel_;
+    bool timedOut_ = false;
+    int exitCode_ = -1;
+    int signal_ = -1;
+};
+
+bool ReadProcNumber(const char* path, long& value) {
+    std::ifstream file(path);
+    return static_cast<bool>(file >> value);
+}
+
+} // namespace
+
+// ============================================================================
+// Launch from Options
+// ============================================================================
+
+std::shared_ptr<const SeccompProgram> ReadSandboxCapabilities(const Napi::Object& caps) {
+    SeccompProfile profile;
+    auto flag = [&caps](const char* name, bool fallback) {
+        Napi::Value value = caps.Get(name);
+        return value.IsBoolean() ? value.As<Napi::Boolean>().Value() : fallback;
+    };
+    profile.network = flag("network", profile.network);
+    profile.privateNetwork = flag("privateNetwork", profile.privateNetwork);
+    profile.filesystemWrite = flag("filesystemWrite", profile.filesystemWrite);
+    profile.processSpawn = flag("processSpawn", profile.processSpawn);
+    Napi::Value dispatch = caps.Get("dispatch");
+    profile.linearDispatch =
+        dispatch.IsString() && dispatch.As<Napi::String>().Utf8Value() == "linear";
+    return GetSeccompProgram(profile);
+}
+
+LinuxSandboxError SpawnLinuxSandbox(const Napi::Object& options, int terminalFd, bool isolate,
+                                    pid_t& pid, const LinuxSandboxSession* session) {
+    const auto invalid = LinuxSandboxError::InvalidArguments;
+
+    LinuxSandboxSpec spec;
+    spec.terminalFd = terminalFd;
+    spec.isolate = isolate;
+
+    Napi::Value command = options.Get("command");
+    if (!command.IsArray()) return invalid;
+    Napi::Array argv = command.As<Napi::Array>();
+    for (uint32_t i = 0; i < argv.Length(); i++) {
+        Napi::Value arg = argv.Get(i);
+        if (!arg.IsString()) return invalid;
+        spec.argv.push_back(arg.As<Napi::String>().Utf8Value());
+    }
+
+    Napi::Value workspace = options.Get("workspacePath");
+    if (workspace.IsString()) spec.workspacePath = workspace.As<Napi::String>().Utf8Value();
+    if (session != nullptr) {
+        if (!options.Get("capabilities").IsUndefined() || !options.Get("resources").IsUndefined()) {
+            std::cerr << "[LinuxSandbox] capabilities and resources are fixed by the session"
+                      << std::endl;
+            return invalid;
+        }
+        if (!spec.workspacePath.empty() && spec.workspacePath != session->workspacePath) {
+            std::cerr << "[LinuxSandbox] " << spec.workspacePath
+                      << " is not the session workspace" << std::endl;
+            return invalid;
+        }
+        spec.workspacePath = session->workspacePath;
+    }
+
+    Napi::Value cwd = options.Get("cwd");
+    if (cwd.IsString()) spec.cwd = cwd.As<Napi::String>().Utf8Value();
+
+    Napi::Value envValue = options.Get("env");
+    if (envValue.IsObject()) {
+        Napi::Object envObject = envValue.As<Napi::Object>();
+        Napi::Array names = envObject.GetPropertyNames();
+        for (uint32_t i = 0; i < names.Length(); i++) {
+            Napi::Value name = names.Get(i);
+            Napi::Value value = envObject.Get(name);
+            if (!value.IsString()) continue;
+            spec.env.push_back(name.As<Napi::String>().Utf8Value() + "=" +
+                               value.As<Napi::String>().Utf8Value());
+        }
+    } else {
+        for (char** var = environ; *var != nullptr; var++) spec.env.emplace_back(*var);
+    }
+
+    if (session != nullptr && session->egress) {
+        // Point clients at the proxy unless the caller already did.
+        spec.egress = session->egress;
+        spec.egressPort = session->egressPort;
+        std::string proxy = "http://127.0.0.1:" + std::to_string(spec.egressPort);
+        std::string local = "localhost,127.0.0.1,::1";
+        const std::pair<const char*, const std::string*> variables[] = {
+            {"HTTP_PROXY", &proxy}, {"HTTPS_PROXY", &proxy}, {"ALL_PROXY", &proxy},
+            {"http_proxy", &proxy}, {"https_proxy", &proxy}, {"all_proxy", &proxy},
+            {"NO_PROXY", &local},   {"no_proxy", &local},
+        };
+        for (const auto& [name, value] : variables) {
+            std::string prefix = std::string(name) + "=";
+            auto named = [&prefix](const std::string& var) {
+                return var.compare(0, prefix.size(), prefix) == 0;
+            };
+            if (std::none_of(spec.env.begin(), spec.env.end(), named)) {
+                spec.env.push_back(prefix + *value);
+            }
+        }
+    }
+
+    std::string overlayId;
+    Napi::Value overlayValue = options.Get("overlayId");
+    if (overlayValue.IsString()) {
+        overlayId = overlayValue.As<Napi::String>().Utf8Value();
+        OverlayInfo overlay;
+        if (!FindOverlay(overlayId, overlay)) {
+            std::cerr << "[LinuxSandbox] Unknown overlay: " << overlayId << std::endl;
+            return invalid;
+        }
+        if (spec.workspacePath.empty()) spec.workspacePath = overlay.lower;
+        if (spec.workspacePath != overlay.lower) {
+            std::cerr << "[LinuxSandbox] Overlay " << overlayId
+                      << " does not belong to " << spec.workspacePath << std::endl;
+            return invalid;
+        }
+        spec.overlayUpper = overlay.upper;
+        spec.overlayWork = overlay.work;
+    }
+
+    Napi::Value capabilities = options.Get("capabilities");
+    if (session != nullptr) {
+        spec.seccomp = session->seccomp;
+    } else if (capabilities.IsObject()) {
+        spec.seccomp = ReadSandboxCapabilities(capabilities.As<Napi::Object>());
+        if (!spec.seccomp) {
+            std::cerr << "[LinuxSandbox] Cannot build seccomp filter on this architecture"
+                      << std::endl;
+            return LinuxSandboxError::CapabilityError;
+        }
+    }
+
+    GovernedGroupPtr group;
+    Napi::Value resources = options.Get("resources");
+    if (session != nullptr) {
+        group = session->group;
+    } else if (resources.IsObject()) {
+        ResourceLimits limits;
+        std::string error;
+        if (!ParseResourceLimits(resources.As<Napi::Object>(), limits, error)) {
+            std::cerr << "[LinuxSandbox] Invalid resources: " << error << std::endl;
+            return invalid;
+        }
+        std::vector<std::string> unsupported;
+        group = CreateGovernedGroup(limits, unsupported, error);
+        if (!group) {
+            std::cerr << "[LinuxSandbox] " << error << std::endl;
+            return LinuxSandboxError::ResourceError;
+        }
+        for (const auto& name : unsupported) {
+            std::cerr << "[LinuxSandbox] Limit not enforceable on this host: " << name << std::endl;
+        }
+    } else {
+        // No limits: still give the sandbox its own cgroup so its whole tree
+        // can be accounted and killed. Without cgroup v2 the process group
+        // is the fallback.
+        std::vector<std::string> unsupported;
+        std::string error;
+        group = CreateGovernedGroup(ResourceLimits{}, unsupported, error);
+    }
+    if (group) spec.cgroupProcsFd = GovernedGroupProcsFd(*group);
+
+    CancelToken cancel;
+    std::string error;
+    if (!ReadCancelOptions(options, cancel, error)) {
+        std::cerr << "[LinuxSandbox] " << error << std::endl;
+        return invalid;
+    }
+    spec.cancel = &cancel;
+
+    RecordOperationStarted(CancellableOperation::LaunchSandbox);
+    LinuxSandboxError result = LaunchLinuxSandbox(spec, pid, error);
+    RecordOperationFinished(CancellableOperation::LaunchSandbox, cancel.Outcome());
+    if (result != LinuxSandboxError::Success) {
+        if (result == LinuxSandboxError::InvalidArguments) {
+            std::cerr << "[LinuxSandbox] " << error << std::endl;
+        }
+        return result;
+    }
+
+    if (!overlayId.empty()) AttachOverlayProcess(overlayId, pid);
+    if (group) RegisterGovernedProcess(pid, std::move(group));
+    return LinuxSandboxError::Success;
+}
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+Napi::Value CreateLinuxSandbox(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        return Napi::Number::New(env, static_cast<int32_t>(LinuxSandboxError::InvalidArguments));
+    }
+
+    pid_t pid = 0;
+    LinuxSandboxError result = SpawnLinuxSandbox(info[0].As<Napi::Object>(), -1, true, pid);
+    if (result != LinuxSandboxError::Success) {
+        return Napi::Number::New(env, static_cast<int32_t>(result));
+    }
+    return Napi::Number::New(env, pid);
+}
+
+Napi::Value WaitLinuxSandbox(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        auto deferred = Napi::Promise::Deferred::New(env);
+        deferred.Reject(Napi::TypeError::New(env, "waitLinuxSandbox expects a pid").Value());
+        return deferred.Promise();
+    }
+
+    // A bare number is the timeout, as before options were accepted.
+    Napi::Value options = info.Length() > 1 ? info[1] : env.Undefined();
+    if (options.IsNumber()) {
+        Napi::Object wrapped = Napi::Object::New(env);
+        wrapped.Set("timeoutMs", Napi::Number::New(env, std::max<double>(
+                                     0, options.As<Napi::Number>().DoubleValue())));
+        options = wrapped;
+    }
+
+    CancelBinding cancel(CancellableOperation::WaitSandbox);
+    std::string error;
+    if (!cancel.Attach(options, error)) {
+        auto deferred = Napi::Promise::Deferred::New(env);
+        deferred.Reject(Napi::TypeError::New(env, error).Value());
+        return deferred.Promise();
+    }
+
+    auto* worker = new WaitWorker(env, info[0].As<Napi::Number>().Int32Value(),
+                                  std::move(cancel));
+    Napi::Promise promise = worker->Promise();
+    worker->Queue();
+    return promise;
+}
+
+Napi::Value GetLinuxSandboxSupport(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    long maxNamespaces = 0;
+    bool userNamespaces = ReadProcNumber("/proc/sys/user/max_user_namespaces", maxNamespaces) &&
+                          maxNamespaces > 0;
+
+    // Debian/Ubuntu knob; absent elsewhere.
+    long unprivileged = 1;
+    if (ReadProcNumber("/proc/sys/kernel/unprivileged_userns_clone", unprivileged) &&
+        unprivileged == 0 && geteuid() != 0) {
+        userNamespaces = false;
+    }
+
+    bool overlay = false;
+    std::ifstream filesystems("/proc/filesystems");
+    std::string line;
+    while (std::getline(filesystems, line)) {
+        if (line.size() >= 7 && line.compare(line.size() - 7, 7, "overlay") == 0) {
+            overlay = true;
+            break;
+        }
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("userNamespaces", Napi::Boolean::New(env, userNamespaces));
+    result.Set("overlay", Napi::Boolean::New(env, overlay));
+    return result;
+}
+
+} // namespace TerminAI
+
+#else // !__linux__
+
+namespace TerminAI {
+
+// ============================================================================
+// Stubs for Windows and macOS
+// ============================================================================
+
+Napi::Value CreateLinuxSandbox(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Error::New(env, "Linux sandbox is only available on Linux")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+}
+
+Napi::Value WaitLinuxSandbox(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    auto deferred = Napi::Promise::Deferred::New(env);
+    deferred.Reject(Napi::Error::New(env, "Linux sandbox is only available on Linux").Value());
+    return deferred.Promise();
+}
+
+Napi::Value GetLinuxSandboxSupport(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("userNamespaces", Napi::Boolean::New(env, false));
+    result.Set("overlay", Napi::Boolean::New(env, false));
+    return result;
+}
+
+} // namespace TerminAI
+
+#endif // __linux__
@@ -0,0 +1,235 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Linux Sandbox Launcher Header
+ *
+ * Linux counterpart of the AppContainer launcher. The sandboxed process is
+ * started in a fresh user + mount namespace (no privileges required):
+ *
+ *   fork -> join the sandbox's cgroup (limits, accounting, tree kill)
+ *        -> unshare(CLONE_NEWUSER | CLONE_NEWNS [| CLONE_NEWNET])
+ *        -> map the caller's uid/gid 1:1
+ *        -> [egress] bring up loopback, listen on 127.0.0.1:<port> and hand
+ *           the listener to the parent's egress proxy (egress_proxy.h)
+ *        -> [overlay workspace] mount overlayfs over the workspace path
+ *        -> cover the seccomp disk cache with an empty tmpfs
+ *        -> chdir
+ *        -> [capabilities] install the seccomp filter for the profile
+ *        -> execve
+ *
+ * Mounts made in the child's namespace vanish when its last process exits,
+ * so nothing has to be unmounted afterwards.
+ *
+ * Everything the child needs is prepared before fork(); between fork and
+ * execve the child only makes raw system calls (Node is multi-threaded, so
+ * allocating there could deadlock on a lock held by another thread).
+ *
+ * The same launcher starts terminal sessions (pty_session.h): the child makes
+ * the terminal its controlling tty and stdio right after setsid, and host
+ * sessions skip the namespace, mount and seccomp steps.
+ */
+
+#pragma once
+
+#include <napi.h>
+#include "cancellation.h"
+#include "egress_proxy.h"
+#include "resource_governor.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/types.h>
+#endif
+
+namespace TerminAI {
+
+struct SeccompProgram;
+
+// ============================================================================
+// Error Codes
+// ============================================================================
+
+/**
+ * Error codes returned by CreateLinuxSandbox (mirrors AppContainerError)
+ */
+enum class LinuxSandboxError : int32_t {
+    Success = 0,
+    NamespaceFailed = -1,
+    MountFailed = -2,
+    ProcessCreationFailed = -3,
+    InvalidArguments = -4,
+    CapabilityError = -5,
+    ResourceError = -6,
+    /** The signal was aborted or the deadline passed before execve */
+    Cancelled = -7,
+};
+
+#ifdef __linux__
+
+// ============================================================================
+// Launcher
+// ============================================================================
+
+struct LinuxSandboxSpec {
+    /** argv[0] is resolved against PATH from `env` if it has no slash */
+    std::vector<std::string> argv;
+    /** Complete environment as NAME=VALUE */
+    std::vector<std::string> env;
+    /** Working directory (default: workspacePath) */
+    std::string cwd;
+    std::string workspacePath;
+
+    /** Overlay mode: both set = mount a CoW view over workspacePath */
+    std::string overlayUpper;
+    std::string overlayWork;
+
+    /** Capability filter installed right before execve (null = none) */
+    std::shared_ptr<const SeccompProgram> seccomp;
+
+    /** cgroup.procs of the sandbox's cgroup, joined before unshare (-1 = none) */
+    int cgroupProcsFd = -1;
+
+    /** Terminal slave: controlling tty and stdio of the child (-1 = inherit) */
+    int terminalFd = -1;
+    /** false = host process: no namespaces, mounts or overlay */
+    bool isolate = true;
+
+    /**
+     * Run in a network namespace of its own whose only way out is this
+     * proxy, listening on 127.0.0.1:egressPort inside it (null = the host's
+     * network). Requires `isolate`.
+     */
+    EgressProxyPtr egress;
+    uint16_t egressPort = 3128;
+
+    /** Bounds the wait for the child to reach execve (null = unbounded) */
+    CancelToken* cancel = nullptr;
+};
+
+/**
+ * Launch a process in a new user + mount namespace.
+ *
+ * @param spec What to run and how
+ * @param pid Receives the child's PID on success
+ * @param error Receives a description on failure
+ * @return LinuxSandboxError::Success or the failing stage
+ */
+LinuxSandboxError LaunchLinuxSandbox(const LinuxSandboxSpec& spec, pid_t& pid, std::string& error);
+
+/**
+ * What a sandbox session (sandbox_registry.h) fixes for every process
+ * launched in it.
+ */
+struct LinuxSandboxSession {
+    std::string workspacePath;
+    /** Capability filter (null = none) */
+    std::shared_ptr<const SeccompProgram> seccomp;
+    /** The session's cgroup, shared by all its processes (null = none) */
+    GovernedGroupPtr group;
+    /** The session's egress proxy (null = the host's network) */
+    EgressProxyPtr egress;
+    uint16_t egressPort = 3128;
+};
+
+/**
+ * Build the seccomp program for a `capabilities` option object
+ * ({ network?, privateNetwork?, filesystemWrite?, processSpawn?, dispatch? }).
+ *
+ * @return null if the filter cannot be built on this architecture
+ */
+std::shared_ptr<const SeccompProgram> ReadSandboxCapabilities(const Napi::Object& capabilities);
+
+/**
+ * Launch from a createLinuxSandbox options object: builds the spec, seccomp
+ * program and cgroup, launches, and registers the process with its overlay
+ * and group.
+ *
+ * @param terminalFd See LinuxSandboxSpec::terminalFd
+ * @param isolate See LinuxSandboxSpec::isolate
+ * @param session Launch in this session: its workspace, filter, cgroup and
+ *                egress proxy apply, and `capabilities` / `resources`
+ *                options are rejected (null = a standalone sandbox)
+ */
+LinuxSandboxError SpawnLinuxSandbox(const Napi::Object& options, int terminalFd, bool isolate,
+                                    pid_t& pid, const LinuxSandboxSession* session = nullptr);
+
+/**
+ * Whether a PID was launched by this module and has not been reaped yet.
+ */
+bool IsLinuxSandboxRunning(pid_t pid);
+
+/**
+ * Reap a launched process (blocks until it exits) and release its group.
+ *
+ * @return false if the PID is unknown or waitpid failed
+ */
+bool ReapLinuxSandbox(pid_t pid, int& status);
+
+#endif // __linux__
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+/**
+ * Create a process running in a Linux user/mount namespace sandbox.
+ *
+ * Arguments:
+ *   0: Object
+ *      - command: String[] - argv
+ *      - workspacePath: String
+ *      - cwd?: String
+ *      - env?: Record<String, String> - complete environment
+ *      - overlayId?: String - run on this overlay workspace (CoW view)
+ *      - capabilities?: Object - seccomp profile { network?, privateNetwork?,
+ *                       filesystemWrite?, processSpawn? } (omitted = no filter)
+ *      - resources?: Object - limits { cpuWeight?, cpuQuotaPercent?, memoryMax?,
+ *                    memoryHigh?, pidsMax?, ioWeight? } (see resource_governor.h)
+ *      - timeoutMs?: Number - deadline for the child to reach execve; past
+ *                    it the child is killed
+ *      - signal?: AbortSignal - only an already aborted signal applies (the
+ *                 call is synchronous)
+ *
+ * Returns: Number
+ *   - Positive: Process ID of spawned process
+ *   - Negative: Error code (see LinuxSandboxError enum)
+ *     -1: Namespace creation failed (user namespaces disabled?)
+ *     -2: Overlay mount failed
+ *     -3: Process creation failed (fork or exec)
+ *     -4: Invalid arguments
+ *     -5: Capability error (seccomp filter could not be built or installed)
+ *     -6: Resource error (cgroup could not be created or joined)
+ *     -7: Cancelled (signal aborted, or the deadline passed before execve)
+ */
+Napi::Value CreateLinuxSandbox(const Napi::CallbackInfo& info);
+
+/**
+ * Wait for a sandboxed process to exit and reap it.
+ *
+ * Arguments:
+ *   0: Number - PID returned by createLinuxSandbox
+ *   1: Number | Object (optional) - Timeout in ms (default: wait forever),
+ *      or { timeoutMs?: Number, signal?: AbortSignal }
+ *
+ * Returns: Promise<Object> - { exitCode: Number|null, signal: Number|null,
+ *                              timedOut: Boolean }
+ *   A passed deadline resolves with timedOut (the process keeps running);
+ *   an aborted signal rejects with an AbortError and leaves it unreaped.
+ */
+Napi::Value WaitLinuxSandbox(const Napi::CallbackInfo& info);
+
+/**
+ * Report whether unprivileged user namespaces and overlayfs are usable.
+ *
+ * Returns: Object - { userNamespaces: Boolean, overlay: Boolean }
+ */
+Napi::Value GetLinuxSandboxSupport(const Napi::CallbackInfo& info);
+
+} // namespace TerminAI
@@ -0,0 +1,600 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Sandbox Session Registry Implementation
+ */
+
+#include "sandbox_registry.h"
+#include "resource_governor.h"
+#include "workspace_stage.h"
+
+#ifdef _WIN32
+#include "appcontainer_manager.h"
+#elif defined(__linux__)
+#include "egress_proxy.h"
+#include "sandbox_linux.h"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace TerminAI {
+
+namespace {
+
+constexpr size_t MAX_SESSION_ID = 40;
+
+struct SandboxSession {
+    std::string id;
+    std::string workspacePath;
+    /** Milliseconds since the epoch */
+    double createdAt = 0;
+    /** Null when the host has no cgroup v2 (Linux) */
+    GovernedGroupPtr group;
+    std::atomic<uint64_t> launches{0};
+    std::atomic<uint64_t> failures{0};
+
+    std::mutex pidsMutex;
+    /** Launched and, as far as we know, not yet reaped */
+    std::vector<int64_t> pids;
+
+#ifdef _WIN32
+    std::wstring profileName;
+    AppContainerSidPtr sid;
+    std::string sidString;
+    bool enableInternet = true;
+#elif defined(__linux__)
+    LinuxSandboxSession spawn;
+    /** The proxy is opened with the session */
+    bool egress = false;
+    EgressPolicy egressPolicy;
+#endif
+};
+
+using SessionPtr = std::shared_ptr<SandboxSession>;
+
+// A null entry reserves an id whose session is being created or destroyed.
+std::mutex g_sessionsMutex;
+std::unordered_map<std::string, SessionPtr> g_sessions;
+
+bool IsValidSessionId(const std::string& id) {
+    if (id.empty() || id.size() > MAX_SESSION_ID) return false;
+    return std::all_of(id.begin(), id.end(), [](char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+               c == '.' || c == '_' || c == '-';
+    });
+}
+
+bool ReserveSession(const std::string& id) {
+    std::lock_guard<std::mutex> lock(g_sessionsMutex);
+    return g_sessions.emplace(id, nullptr).second;
+}
+
+void ReleaseSession(const std::string& id) {
+    std::lock_guard<std::mutex> lock(g_sessionsMutex);
+    g_sessions.erase(id);
+}
+
+SessionPtr FindSession(const std::string& id) {
+    std::lock_guard<std::mutex> lock(g_sessionsMutex);
+    auto it = g_sessions.find(id);
+    return it == g_sessions.end() ? nullptr : it->second;
+}
+
+/** Take a session out of service, keeping its id reserved. */
+SessionPtr DetachSession(const std::string& id) {
+    std::lock_guard<std::mutex> lock(g_sessionsMutex);
+    auto it = g_sessions.find(id);
+    if (it == g_sessions.end() || !it->second) return nullptr;
+    SessionPtr session = std::move(it->second);
+    it->second = nullptr;
+    return session;
+}
+
+bool IsSessionProcessRunning(int64_t pid) {
+#ifdef __linux__
+    return IsLinuxSandboxRunning(static_cast<pid_t>(pid));
+#else
+    // Windows processes are tracked through the session's Job Object.
+    (void)pid;
+    return false;
+#endif
+}
+
+/** Drop reaped PIDs and return the ones still running. */
+std::vector<int64_t> RunningPids(SandboxSession& session) {
+    std::lock_guard<std::mutex> lock(session.pidsMutex);
+    session.pids.erase(std::remove_if(session.pids.begin(), session.pids.end(),
+                                      [](int64_t pid) { return !IsSessionProcessRunning(pid); }),
+                       session.pids.end());
+    return session.pids;
+}
+
+Napi::Object SessionToObject(Napi::Env env, SandboxSession& session) {
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("id", Napi::String::New(env, session.id));
+    result.Set("workspacePath", Napi::String::New(env, session.workspacePath));
+#ifdef _WIN32
+    result.Set("sid", Napi::String::New(env, session.sidString));
+#else
+    result.Set("sid", env.Null());
+#endif
+    result.Set("createdAt", Napi::Number::New(env, session.createdAt));
+    result.Set("launches", Napi::Number::New(env, static_cast<double>(session.launches.load())));
+    result.Set("failures", Napi::Number::New(env, static_cast<double>(session.failures.load())));
+
+    ResourceSample sample;
+    if (session.group && SampleGovernedGroup(*session.group, sample)) {
+        result.Set("running", Napi::Number::New(env, static_cast<double>(sample.pids)));
+        result.Set("resources", ResourceSampleToObject(env, sample));
+    } else {
+        result.Set("running", Napi::Number::New(env, static_cast<double>(RunningPids(session).size())));
+        result.Set("resources", env.Null());
+    }
+#ifdef __linux__
+    result.Set("egress", session.spawn.egress ? EgressStatsObject(env, *session.spawn.egress)
+                                              : env.Null());
+#else
+    result.Set("egress", env.Null());
+#endif
+    return result;
+}
+
+Napi::Value RejectedPromise(Napi::Env env, const std::string& message) {
+    auto deferred = Napi::Promise::Deferred::New(env);
+    deferred.Reject(Napi::TypeError::New(env, message).Value());
+    return deferred.Promise();
+}
+
+// ============================================================================
+// Async Workers
+// ============================================================================
+
+class CreateSessionWorker : public Napi::AsyncWorker {
+public:
+    CreateSessionWorker(Napi::Env env, SessionPtr session, ResourceLimits limits, bool limited,
+                        std::string stageSource, StageOptions stageOptions)
+        : Napi::AsyncWorker(env),
+          deferred_(Napi::Promise::Deferred::New(env)),
+          session_(std::move(session)),
+          limits_(limits),
+          limited_(limited),
+          stageSource_(std::move(stageSource)),
+          stageOptions_(std::move(stageOptions)) {}
+
+    Napi::Promise Promise() const { return deferred_.Promise(); }
+
+    void Execute() override {
+        std::string error;
+        if (!SetUp(error)) {
+            ReleaseSession(session_->id);
+            SetError(error);
+            return;
+        }
+        std::lock_guard<std::mutex> lock(g_sessionsMutex);
+        g_sessions[session_->id] = session_;
+    }
+
+    void OnOK() override {
+        Napi::Env env = Env();
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("id", Napi::String::New(env, session_->id));
+        result.Set("workspacePath", Napi::String::New(env, session_->workspacePath));
+#ifdef _WIN32
+        result.Set("sid", Napi::String::New(env, session_->sidString));
+#else
+        result.Set("sid", env.Null());
+#endif
+        result.Set("staged", stageSource_.empty() ? env.Null()
+                                                   : StageResultToObject(env, staged_));
+        deferred_.Resolve(result);
+    }
+
+    void OnError(const Napi::Error& error) override {
+        deferred_.Reject(error.Value());
+    }
+
+private:
+    bool SetUp(std::string& error) {
+        SandboxSession& session = *session_;
+        std::vector<std::string> unsupported;
+        std::string groupError;
+        session.group = CreateGovernedGroup(limits_, unsupported, groupError);
+        for (const auto& name : unsupported) {
+            std::cerr << "[SandboxRegistry] Limit not enforceable on this host: " << name
+                      << std::endl;
+        }
+
+#ifdef _WIN32
+        if (!session.group) {
+            error = groupError;
+            return false;
+        }
+        session.sid = OpenAppContainerProfile(session.profileName, session.profileName, error);
+        if (!session.sid) return false;
+
+        LPWSTR sidString = nullptr;
+        if (ConvertSidToStringSidW(session.sid.get(), &sidString)) {
+            session.sidString = WideToUtf8(sidString);
+            LocalFree(sidString);
+        }
+        if (!GrantWorkspaceAccess(Utf8ToWide(session.workspacePath), session.sid.get())) {
+            RemoveAppContainerProfile(session.profileName);
+            error = "cannot grant the session access to " + session.workspacePath;
+            return false;
+        }
+        // Staged after the grant, so files inherit the session's ACE as they
+        // are created instead of the grant walking the whole copied tree.
+        if (!Stage(error)) {
+            RemoveAppContainerProfile(session.profileName);
+            return false;
+        }
+#else
+        // Without cgroup v2 unlimited sessions fall back to per-process
+        // teardown; requested limits cannot be honored that way.
+        if (!session.group && limited_) {
+            error = groupError;
+            return false;
+        }
+#ifdef __linux__
+        session.spawn.group = session.group;
+#endif
+        if (!Stage(error)) return false;
+#ifdef __linux__
+        if (session.egress) {
+            session.spawn.egress =
+                CreateEgressProxy("session:" + session.id, session.egressPolicy, error);
+            if (!session.spawn.egress) return false;
+        }
+#endif
+#endif
+        session.createdAt = static_cast<double>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count());
+        return true;
+    }
+
+    /** Fill the workspace from the stage source, if one was given. */
+    bool Stage(std::string& error) {
+        if (stageSource_.empty()) return true;
+        if (StageWorkspace(stageSource_, session_->workspacePath, stageOptions_, staged_, error)) {
+            return true;
+        }
+        error = "cannot stage the session workspace: " + error;
+        return false;
+    }
+
+    Napi::Promise::Deferred deferred_;
+    SessionPtr session_;
+    ResourceLimits limits_;
+    bool limited_;
+    std::string stageSource_;
+    StageOptions stageOptions_;
+    StageResult staged_;
+};
+
+class DestroySessionWorker : public Napi::AsyncWorker {
+public:
+    DestroySessionWorker(Napi::Env env, SessionPtr session, int64_t timeoutMs)
+        : Napi::AsyncWorker(env),
+          deferred_(Napi::Promise::Deferred::New(env)),
+          session_(std::move(session)),
+          timeoutMs_(timeoutMs) {}
+
+    Napi::Promise Promise() const { return deferred_.Promise(); }
+
+    void Execute() override {
+        std::string error;
+        bool ok = Kill(error);
+#ifdef _WIN32
+        RemoveAppContainerProfile(session_->profileName);
+#elif defined(__linux__)
+        // After the kill: nothing is left to connect through it.
+        if (session_->spawn.egress) CloseEgressProxy(session_->spawn.egress);
+#endif
+        std::string id = session_->id;
+        // The group goes with the last process holding it.
+        session_->group.reset();
+        ReleaseSession(id);
+        if (!ok) SetError(error);
+    }
+
+    void OnOK() override {
+        Napi::Env env = Env();
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("method", Napi::String::New(env, result_.method));
+        result.Set("latencyUs", Napi::Number::New(env, static_cast<double>(result_.latencyUs)));
+        result.Set("complete", Napi::Boolean::New(env, result_.complete));
+        result.Set("processes", Napi::Number::New(env, static_cast<double>(processes_)));
+        deferred_.Resolve(result);
+    }
+
+    void OnError(const Napi::Error& error) override {
+        deferred_.Reject(error.Value());
+    }
+
+private:
+    bool Kill(std::string& error) {
+        SandboxSession& session = *session_;
+        ResourceSample sample;
+        if (session.group) {
+            processes_ = SampleGovernedGroup(*session.group, sample) ? sample.pids : 0;
+            return KillGovernedGroup(*session.group, timeoutMs_, result_, error);
+        }
+
+        // No group: each process tree separately, within one overall deadline.
+        std::vector<int64_t> pids = RunningPids(session);
+        processes_ = pids.size();
+        result_.method = "process";
+        result_.complete = true;
+        auto start = std::chrono::steady_clock::now();
+        for (int64_t pid : pids) {
+            int64_t elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            TreeKillResult one;
+            if (!KillProcessTreeOf(pid, std::max<int64_t>(0, timeoutMs_ - elapsedMs), one, error)) {
+                return false;
+            }
+            result_.method = one.method;
+            result_.complete = result_.complete && one.complete;
+        }
+        result_.latencyUs = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        return true;
+    }
+
+    Napi::Promise::Deferred deferred_;
+    SessionPtr session_;
+    int64_t timeoutMs_;
+    TreeKillResult result_;
+    uint64_t processes_ = 0;
+};
+
+} // namespace
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+Napi::Value CreateSandboxSession(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+#if !defined(_WIN32) && !defined(__linux__)
+    return RejectedPromise(env, "Sandbox sessions are only available on Windows and Linux");
+#else
+    if (info.Length() < 2 || !info[0].IsString() || !info[1].IsObject()) {
+        return RejectedPromise(env, "createSandboxSession expects an id and an options object");
+    }
+    std::string id = info[0].As<Napi::String>().Utf8Value();
+    if (!IsValidSessionId(id)) {
+        return RejectedPromise(env, "Invalid session id: " + id);
+    }
+
+    Napi::Object options = info[1].As<Napi::Object>();
+    auto session = std::make_shared<SandboxSession>();
+    session->id = id;
+    Napi::Value workspace = options.Get("workspacePath");
+    if (!workspace.IsString() || workspace.As<Napi::String>().Utf8Value().empty()) {
+        return RejectedPromise(env, "workspacePath must be a non-empty string");
+    }
+    session->workspacePath = workspace.As<Napi::String>().Utf8Value();
+
+    ResourceLimits limits;
+    Napi::Value resources = options.Get("resources");
+    bool limited = resources.IsObject();
+    if (limited) {
+        std::string error;
+        if (!ParseResourceLimits(resources.As<Napi::Object>(), limits, error)) {
+            return RejectedPromise(env, "Invalid resources: " + error);
+        }
+    }
+
+    std::string stageSource;
+    StageOptions stageOptions;
+    Napi::Value stage = options.Get("stage");
+    if (stage.IsObject()) {
+        Napi::Object stageObject = stage.As<Napi::Object>();
+        Napi::Value source = stageObject.Get("source");
+        if (!source.IsString() || source.As<Napi::String>().Utf8Value().empty()) {
+            return RejectedPromise(env, "stage.source must be a non-empty string");
+        }
+        stageSource = source.As<Napi::String>().Utf8Value();
+        std::string error;
+        if (!ReadStageOptions(stageObject, stageOptions, error)) {
+            return RejectedPromise(env, "Invalid stage: " + error);
+        }
+    } else if (!stage.IsUndefined()) {
+        return RejectedPromise(env, "stage must be an object");
+    }
+
+#ifdef _WIN32
+    session->profileName = L"TerminAI_Session_" + Utf8ToWide(id);
+    Napi::Value internet = options.Get("enableInternet");
+    if (internet.IsBoolean()) session->enableInternet = internet.As<Napi::Boolean>().Value();
+    if (!options.Get("egress").IsUndefined()) {
+        return RejectedPromise(env, "egress is only available on Linux");
+    }
+#else
+    session->spawn.workspacePath = session->workspacePath;
+    Napi::Value capabilities = options.Get("capabilities");
+    if (capabilities.IsObject()) {
+        session->spawn.seccomp = ReadSandboxCapabilities(capabilities.As<Napi::Object>());
+        if (!session->spawn.seccomp) {
+            return RejectedPromise(env, "Cannot build seccomp filter on this architecture");
+        }
+    }
+
+    Napi::Value egress = options.Get("egress");
+    if (egress.IsObject()) {
+        Napi::Object egressObject = egress.As<Napi::Object>();
+        std::string error;
+        if (!ReadEgressPolicy(egressObject, session->egressPolicy, error)) {
+            return RejectedPromise(env, "Invalid egress: " + error);
+        }
+        Napi::Value port = egressObject.Get("port");
+        if (!port.IsUndefined()) {
+            double number = port.IsNumber() ? port.As<Napi::Number>().DoubleValue() : 0;
+            if (!(number >= 1 && number <= 65535) || number != static_cast<uint16_t>(number)) {
+                return RejectedPromise(env, "Invalid egress: port must be from 1 to 65535");
+            }
+            session->spawn.egressPort = static_cast<uint16_t>(number);
+        }
+        session->egress = true;
+    } else if (!egress.IsUndefined()) {
+        return RejectedPromise(env, "egress must be an object");
+    }
+#endif
+
+    if (!ReserveSession(id)) {
+        auto deferred = Napi::Promise::Deferred::New(env);
+        deferred.Reject(Napi::Error::New(env, "Sandbox session already exists: " + id).Value());
+        return deferred.Promise();
+    }
+
+    auto* worker = new CreateSessionWorker(env, std::move(session), limits, limited,
+                                           std::move(stageSource), std::move(stageOptions));
+    Napi::Promise promise = worker->Promise();
+    worker->Queue();
+    return promise;
+#endif
+}
+
+Napi::Value LaunchInSandboxSession(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    constexpr int32_t INVALID_ARGUMENTS = -4;
+
+    if (info.Length() < 2 || !info[0].IsString() || !info[1].IsObject()) {
+        return Napi::Number::New(env, INVALID_ARGUMENTS);
+    }
+    SessionPtr session = FindSession(info[0].As<Napi::String>().Utf8Value());
+    if (!session) {
+        return Napi::Number::New(env, INVALID_ARGUMENTS);
+    }
+    Napi::Object options = info[1].As<Napi::Object>();
+
+#ifdef _WIN32
+    AppContainerLaunch launch;
+    Napi::Value command = options.Get("command");
+    Napi::Value workspace = options.Get("workspacePath");
+    if (!command.IsArray() || command.As<Napi::Array>().Length() == 0 ||
+        !options.Get("capabilities").IsUndefined() || !options.Get("resources").IsUndefined() ||
+        (workspace.IsString() && workspace.As<Napi::String>().Utf8Value() != session->workspacePath)) {
+        session->failures++;
+        return Napi::Number::New(env, INVALID_ARGUMENTS);
+    }
+    Napi::Array argv = command.As<Napi::Array>();
+    for (uint32_t i = 0; i < argv.Length(); i++) {
+        if (i > 0) launch.commandLine.push_back(L' ');
+        launch.commandLine += QuoteArgument(Utf8ToWide(argv.Get(i).ToString().Utf8Value()));
+    }
+    launch.workspacePath = Utf8ToWide(session->workspacePath);
+    Napi::Value cwd = options.Get("cwd");
+    if (cwd.IsString()) launch.cwd = Utf8ToWide(cwd.As<Napi::String>().Utf8Value());
+    Napi::Value environment = options.Get("env");
+    if (environment.IsObject()) launch.environment = BuildEnvironmentBlock(environment.As<Napi::Object>());
+    launch.enableInternet = session->enableInternet;
+    launch.appContainerSid = session->sid;
+    launch.group = session->group;
+
+    PROCESS_INFORMATION pi = {};
+    AppContainerError result = LaunchAppContainerProcess(launch, pi);
+    if (result != AppContainerError::Success) {
+        session->failures++;
+        return Napi::Number::New(env, static_cast<int32_t>(result));
+    }
+    CloseHandle(pi.hThread);
+    CloseHandle(pi.hProcess);
+    int64_t pid = pi.dwProcessId;
+#elif defined(__linux__)
+    pid_t child = 0;
+    LinuxSandboxError result = SpawnLinuxSandbox(options, -1, true, child, &session->spawn);
+    if (result != LinuxSandboxError::Success) {
+        session->failures++;
+        return Napi::Number::New(env, static_cast<int32_t>(result));
+    }
+    int64_t pid = child;
+#else
+    (void)options;
+    return Napi::Number::New(env, INVALID_ARGUMENTS);
+#endif
+
+#if defined(_WIN32) || defined(__linux__)
+    session->launches++;
+    if (!session->group) {
+        std::lock_guard<std::mutex> lock(session->pidsMutex);
+        session->pids.push_back(pid);
+    }
+    return Napi::Number::New(env, static_cast<double>(pid));
+#endif
+}
+
+Napi::Value GetSandboxSession(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "getSandboxSession expects an id").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    SessionPtr session = FindSession(info[0].As<Napi::String>().Utf8Value());
+    if (!session) return env.Null();
+    return SessionToObject(env, *session);
+}
+
+Napi::Value ListSandboxSessions(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    std::vector<SessionPtr> sessions;
+    {
+        std::lock_guard<std::mutex> lock(g_sessionsMutex);
+        sessions.reserve(g_sessions.size());
+        for (const auto& entry : g_sessions) {
+            if (entry.second) sessions.push_back(entry.second);
+        }
+    }
+    std::sort(sessions.begin(), sessions.end(),
+              [](const SessionPtr& a, const SessionPtr& b) { return a->id < b->id; });
+
+    Napi::Array result = Napi::Array::New(env, sessions.size());
+    for (size_t i = 0; i < sessions.size(); i++) {
+        result.Set(static_cast<uint32_t>(i), SessionToObject(env, *sessions[i]));
+    }
+    return result;
+}
+
+Napi::Value DestroySandboxSession(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        return RejectedPromise(env, "destroySandboxSession expects an id");
+    }
+    int64_t timeoutMs = 5000;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Value timeout = info[1].As<Napi::Object>().Get("timeoutMs");
+        if (timeout.IsNumber()) {
+            timeoutMs = std::max<int64_t>(0, timeout.As<Napi::Number>().Int64Value());
+        }
+    }
+
+    SessionPtr session = DetachSession(info[0].As<Napi::String>().Utf8Value());
+    if (!session) {
+        auto deferred = Napi::Promise::Deferred::New(env);
+        deferred.Resolve(env.Null());
+        return deferred.Promise();
+    }
+
+    auto* worker = new DestroySessionWorker(env, std::move(session), timeoutMs);
+    Napi::Promise promise = worker->Promise();
+    worker->Queue();
+    return promise;
+}
+
+} // namespace TerminAI
@@ -0,0 +1,120 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Sandbox Session Registry Header
+ *
+ * Named sandbox sessions, so that several isolated agent sessions can run
+ * side by side on one host, each with its own workspace, capabilities and
+ * resource limits. A session fixes those once; every process launched in
+ * it shares them:
+ *
+ *   Windows  its own AppContainer profile ("TerminAI_Session_<id>") and
+ *            SID, granted access to the session workspace only, and one
+ *            Job Object
+ *   Linux    one cgroup and one seccomp program; each process gets its own
+ *            user + mount namespace as with createLinuxSandbox(), and with
+ *            an egress policy a network namespace whose only way out is the
+ *            session's egress proxy (egress_proxy.h)
+ *
+ * Sessions are independent: destroying one kills its processes (one group
+ * kill) and deletes its profile, and never touches the default TerminAI
+ * profile or another session.
+ *
+ * The registry is a hash map from id to session under one mutex that is
+ * held only for the lookup itself; creation (profile, ACL grant, cgroup)
+ * and teardown run outside it, so sessions are created and destroyed
+ * concurrently from the worker pool. An id is reserved while its session
+ * is being created, so concurrent creates of the same id fail cleanly.
+ */
+
+#pragma once
+
+#include <napi.h>
+
+namespace TerminAI {
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+/**
+ * Create a sandbox session off the main thread.
+ *
+ * Arguments:
+ *   0: String - Session id, 1-40 characters of [A-Za-z0-9._-]
+ *   1: Object
+ *      - workspacePath: String
+ *      - capabilities?: Object - Linux seccomp profile, as for
+ *                       createLinuxSandbox (omitted = no filter)
+ *      - resources?: Object - limits shared by the whole session (see
+ *                    resource_governor.h)
+ *      - enableInternet?: Boolean - Windows network capability (default true)
+ *      - egress?: Object - Linux: { allow, rate?, maxConnections?,
+ *                 allowPrivate? } as for createEgressProxy, and port?:
+ *                 Number - where the proxy listens inside each process's
+ *                 namespace (default 3128); HTTP(S)_PROXY point at it
+ *      - stage?: Object - fill the workspace before the session is usable:
+ *                { source: String, exclude?, compare?, mirror?, reflink?,
+ *                ioUring?, threads? } as for stageWorkspace (on Windows,
+ *                after the workspace grant, so copies inherit it)
+ *
+ * Returns: Promise<Object> - { id, workspacePath, sid: String | null,
+ *          staged: Object | null } (staged as stageWorkspace resolves)
+ *   Rejects if the id is in use or the session cannot be set up.
+ */
+Napi::Value CreateSandboxSession(const Napi::CallbackInfo& info);
+
+/**
+ * Launch a process in a session.
+ *
+ * Arguments:
+ *   0: String - Session id
+ *   1: Object - { command: String[], cwd?, env?, overlayId?, timeoutMs?,
+ *      signal? } as for createLinuxSandbox; workspacePath, if given, must
+ *      be the session's, and capabilities / resources are not accepted
+ *
+ * Returns: Number - PID, or a negative LinuxSandboxError / AppContainerError
+ *   code (-4 for an unknown session)
+ */
+Napi::Value LaunchInSandboxSession(const Napi::CallbackInfo& info);
+
+/**
+ * Describe one session.
+ *
+ * Arguments:
+ *   0: String - Session id
+ *
+ * Returns: Object | null - as one listSandboxSessions() entry
+ */
+Napi::Value GetSandboxSession(const Napi::CallbackInfo& info);
+
+/**
+ * Describe every session.
+ *
+ * Returns: Array<Object> - { id, workspacePath, sid, createdAt, launches,
+ *          failures, running, resources: Object | null, egress: Object |
+ *          null } where resources is a sample of the session's group (see
+ *          sampleSandboxResources) and null without one, and egress the
+ *          counters of its proxy (as getEgressProxyStats)
+ */
+Napi::Value ListSandboxSessions(const Napi::CallbackInfo& info);
+
+/**
+ * Destroy a session off the main thread: kill everything running in it,
+ * then release its group, profile and egress proxy. The id is free again
+ * once the promise resolves.
+ *
+ * Arguments:
+ *   0: String - Session id
+ *   1: Object (optional) - { timeoutMs?: Number } wait for the processes to
+ *      exit (default 5000)
+ *
+ * Returns: Promise<Object | null> - { method, latencyUs, complete, processes }
+ *   as killProcessTree(), or null for an unknown session
+ */
+Napi::Value DestroySandboxSession(const Napi::CallbackInfo& info);
+
+} // namespace TerminAI
@@ -0,0 +1,1009 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Tiered Scan Pipeline Implementation
+ */
+
+#include "scan_pipeline.h"
+#include "hash_allowlist.h"
+#include "rule_database.h"
+#include "work_scheduler.h"
+#include "worker_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace TerminAI {
+
+namespace {
+
+constexpr int32_t RESULT_NOT_DETECTED = 1;
+constexpr int32_t RESULT_DETECTED = 32768;
+
+/** Content up to this size is screened on the calling thread. */
+constexpr size_t INLINE_SCREEN_BYTES = 64 * 1024;
+
+/** Larger content is scanned as given, without its normalized layers. */
+constexpr size_t NORMALIZE_MAX_BYTES = 8 * 1024 * 1024;
+
+/** Bucket 0 holds 0, bucket i holds [2^(i-1), 2^i) microseconds. */
+constexpr size_t LATENCY_BUCKETS = 32;
+
+/**
+ * Markers of droppers, download cradles, defence tampering and reverse
+ * shells in PowerShell, cmd and POSIX shell scripts. A match does not make
+ * content malicious; it only means the classifier will not clear it.
+ */
+const char* const BUILTIN_SUSPICIOUS[] = {
+    // PowerShell and Windows script hosts
+    "invoke-expression", "iex ", "iex(", "frombase64string", "-encodedcommand",
+    "-enc ", "-ec ", "[scriptblock]::create", ".invoke(", "invoke-command",
+    "downloadstring", "downloadfile", "downloaddata", "net.webclient",
+    "invoke-webrequest", "invoke-restmethod", "iwr ", "irm ", "iwr(", "irm(",
+    "get-command", "gcm ", "start-bitstransfer", "add-type", "reflection.assembly",
+    "virtualalloc", "amsiutils", "amsiinitfailed", "set-mppreference",
+    "executionpolicy bypass", "windowstyle hidden", "new-object -comobject",
+    "certutil", "bitsadmin", "mshta", "regsvr32", "rundll32", "wscript",
+    "cscript", "schtasks",
+    // POSIX shells
+    "/dev/tcp/", "/dev/udp/", "base64 -d", "base64 --decode", "| sh", "|sh",
+    "| bash", "|bash", "curl ", "wget ", "nc -e", "ncat ", "mkfifo", "chmod +s",
+    "ld_preload", "python -c", "python3 -c", "perl -e", "eval ", "crontab",
+    "authorized_keys", "/etc/shadow", "rm -rf /",
+    // The engines' own test file
+    "eicar-standard-antivirus-test-file",
+};
+
+uint64_t NowUs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+size_t LatencyBucket(uint64_t us) {
+    size_t bucket = 0;
+    while (us != 0 && bucket < LATENCY_BUCKETS - 1) {
+        us >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+const char* ResolvedEngineName(ScanEngine engine) {
+#ifdef _WIN32
+    return engine == ScanEngine::Portable ? "portable" : "amsi";
+#else
+    return engine == ScanEngine::Amsi ? "amsi" : "portable";
+#endif
+}
+
+std::string Lowercase(std::string text) {
+    for (char& c : text) {
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+    }
+    return text;
+}
+
+// ============================================================================
+// Policy and Counters
+// ============================================================================
+
+class PipelineState {
+public:
+    static PipelineState& Instance() {
+        static PipelineState* state = new PipelineState();
+        return *state;
+    }
+
+    ScanPipelinePolicy Policy() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return policy_;
+    }
+
+    void SetPolicy(const ScanPipelinePolicy& policy) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        policy_ = policy;
+    }
+
+    enum class Outcome { Clean, Detected, Escalated };
+
+    void Record(ScanTier tier, Outcome outcome, uint64_t us) {
+        TierCounters& counters = tiers_[static_cast<size_t>(tier)];
+        counters.scans.fetch_add(1, std::memory_order_relaxed);
+        std::atomic<uint64_t>& count = outcome == Outcome::Clean      ? counters.clean
+                                       : outcome == Outcome::Detected ? counters.detected
+                                                                      : counters.escalated;
+        count.fetch_add(1, std::memory_order_relaxed);
+        counters.totalUs.fetch_add(us, std::memory_order_relaxed);
+        counters.latency[LatencyBucket(us)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void RecordEscalation(EscalationReason reason) {
+        escalations_[static_cast<size_t>(reason)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    struct TierSnapshot {
+        uint64_t scans;
+        uint64_t clean;
+        uint64_t detected;
+        uint64_t escalated;
+        uint64_t totalUs;
+        std::array<uint64_t, LATENCY_BUCKETS> latency;
+    };
+
+    TierSnapshot Tier(ScanTier tier) const {
+        const TierCounters& counters = tiers_[static_cast<size_t>(tier)];
+        TierSnapshot out{counters.scans.load(), counters.clean.load(), counters.detected.load(),
+                         counters.escalated.load(), counters.totalUs.load(), {}};
+        for (size_t i = 0; i < LATENCY_BUCKETS; i++) out.latency[i] = counters.latency[i].load();
+        return out;
+    }
+
+    uint64_t Escalations(EscalationReason reason) const {
+        return escalations_[static_cast<size_t>(reason)].load();
+    }
+
+    void Reset() {
+        for (TierCounters& counters : tiers_) {
+            counters.scans = 0;
+            counters.clean = 0;
+            counters.detected = 0;
+            counters.escalated = 0;
+            counters.totalUs = 0;
+            for (auto& bucket : counters.latency) bucket = 0;
+        }
+        for (auto& count : escalations_) count = 0;
+    }
+
+private:
+    struct TierCounters {
+        std::atomic<uint64_t> scans{0};
+        std::atomic<uint64_t> clean{0};
+        std::atomic<uint64_t> detected{0};
+        std::atomic<uint64_t> escalated{0};
+        std::atomic<uint64_t> totalUs{0};
+        std::array<std::atomic<uint64_t>, LATENCY_BUCKETS> latency{};
+    };
+
+    std::mutex mutex_;
+    ScanPipelinePolicy policy_;
+    std::array<TierCounters, SCAN_TIER_COUNT> tiers_;
+    std::array<std::atomic<uint64_t>, ESCALATION_REASON_COUNT> escalations_{};
+};
+
+// ============================================================================
+// Verdict Cache
+// ============================================================================
+
+struct CacheKey {
+    Blake3Digest digest;
+    uint64_t fingerprint;
+
+    bool operator==(const CacheKey& other) const {
+        return fingerprint == other.fingerprint && digest == other.digest;
+    }
+};
+
+struct CacheKeyHash {
+    size_t operator()(const CacheKey& key) const {
+        // Digest bytes are uniform already.
+        uint64_t prefix;
+        std::memcpy(&prefix, key.digest.bytes, sizeof(prefix));
+        return static_cast<size_t>(prefix ^ key.fingerprint);
+    }
+};
+
+/** Provider verdicts by content, most recently used first. */
+class VerdictCache {
+public:
+    static VerdictCache& Instance() {
+        static VerdictCache* cache = new VerdictCache();
+        return *cache;
+    }
+
+    bool Lookup(const CacheKey& key, ScanVerdict& verdict) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            misses_++;
+            return false;
+        }
+        if (std::chrono::steady_clock::now() >= it->second->expires) {
+            entries_.erase(it->second);
+            index_.erase(it);
+            expired_++;
+            misses_++;
+            return false;
+        }
+        entries_.splice(entries_.begin(), entries_, it->second);
+        verdict = it->second->verdict;
+        hits_++;
+        return true;
+    }
+
+    void Insert(const CacheKey& key, const ScanVerdict& verdict, uint64_t ttlMs, size_t capacity) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        capacity_ = capacity;
+        if (capacity == 0) return;
+        auto expires = std::chrono::steady_clock::now() + std::chrono::milliseconds(ttlMs);
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            it->second->verdict = verdict;
+            it->second->expires = expires;
+            entries_.splice(entries_.begin(), entries_, it->second);
+            return;
+        }
+        entries_.push_front({key, verdict, expires});
+        index_[key] = entries_.begin();
+        EvictLocked();
+    }
+
+    void SetCapacity(size_t capacity) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        capacity_ = capacity;
+        EvictLocked();
+    }
+
+    void Clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.clear();
+        index_.clear();
+    }
+
+    void ResetCounters() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        hits_ = misses_ = evictions_ = expired_ = 0;
+    }
+
+    Napi::Object Describe(Napi::Env env) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Napi::Object out = Napi::Object::New(env);
+        out.Set("entries", Napi::Number::New(env, static_cast<double>(index_.size())));
+        out.Set("capacity", Napi::Number::New(env, static_cast<double>(capacity_)));
+        out.Set("hits", Napi::Number::New(env, static_cast<double>(hits_)));
+        out.Set("misses", Napi::Number::New(env, static_cast<double>(misses_)));
+        out.Set("evictions", Napi::Number::New(env, static_cast<double>(evictions_)));
+        out.Set("expired", Napi::Number::New(env, static_cast<double>(expired_)));
+        return out;
+    }
+
+private:
+    struct Entry {
+        CacheKey key;
+        ScanVerdict verdict;
+        std::chrono::steady_clock::time_point expires;
+    };
+
+    void EvictLocked() {
+        while (index_.size() > capacity_) {
+            index_.erase(entries_.back().key);
+            entries_.pop_back();
+            evictions_++;
+        }
+    }
+
+    std::mutex mutex_;
+    std::list<Entry> entries_;
+    std::unordered_map<CacheKey, std::list<Entry>::iterator, CacheKeyHash> index_;
+    size_t capacity_ = ScanPipelinePolicy().cacheEntries;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+    uint64_t evictions_ = 0;
+    uint64_t expired_ = 0;
+};
+
+// ============================================================================
+// Pre-Classifier
+// ============================================================================
+
+enum class Classification { Clean, Escalate, Block };
+
+/**
+ * One pass for the byte histogram, control bytes and line lengths, then
+ * literal searches over a lowercased copy. Only called on content no
+ * larger than classifierMaxBytes.
+ */
+Classification Classify(const uint8_t* data, size_t length, const ScanPipelinePolicy& policy,
+                        const std::vector<ScanSignature>& signatures,
+                        EscalationReason& reason, std::string& blockedBy) {
+    std::array<uint32_t, 256> histogram{};
+    size_t line = 0;
+    size_t longest = 0;
+    bool control = false;
+    for (size_t i = 0; i < length; i++) {
+        uint8_t byte = data[i];
+        histogram[byte]++;
+        if (byte == '\n') {
+            longest = std::max(longest, line);
+            line = 0;
+            continue;
+        }
+        line++;
+        if ((byte < 0x20 && byte != '\t' && byte != '\r' && byte != '\f') || byte == 0x7f) {
+            control = true;
+        }
+    }
+    longest = std::max(longest, line);
+
+    if (control) {
+        reason = EscalationReason::Binary;
+        return Classification::Escalate;
+    }
+    if (length > 0) {
+        double entropy = 0;
+        double total = static_cast<double>(length);
+        for (uint32_t count : histogram) {
+            if (count == 0) continue;
+            double p = count / total;
+            entropy -= p * std::log2(p);
+        }
+        if (entropy > policy.classifierMaxEntropy) {
+            reason = EscalationReason::Entropy;
+            return Classification::Escalate;
+        }
+    }
+    if (longest > policy.classifierMaxLineBytes) {
+        reason = EscalationReason::LongLine;
+        return Classification::Escalate;
+    }
+
+    thread_local std::string folded;
+    folded.assign(reinterpret_cast<const char*>(data), length);
+    for (char& c : folded) {
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+    }
+
+    for (const ScanSignature& literal : policy.block) {
+        if (folded.find(literal.pattern) != std::string::npos) {
+            blockedBy = literal.name;
+            reason = EscalationReason::Blocked;
+            return policy.classifier.mayBlock ? Classification::Block : Classification::Escalate;
+        }
+    }
+    for (const char* literal : BUILTIN_SUSPICIOUS) {
+        if (folded.find(literal) != std::string::npos) {
+            reason = EscalationReason::Literal;
+            return Classification::Escalate;
+        }
+    }
+    for (const std::string& literal : policy.suspicious) {
+        if (folded.find(literal) != std::string::npos) {
+            reason = EscalationReason::Literal;
+            return Classification::Escalate;
+        }
+    }
+
+    // Whatever the provider would match exactly must reach it.
+    const char* begin = reinterpret_cast<const char*>(data);
+    const char* end = begin + length;
+    for (const ScanSignature& signature : signatures) {
+        if (std::search(begin, end, signature.pattern.begin(), signature.pattern.end()) != end) {
+            reason = EscalationReason::Literal;
+            return Classification::Escalate;
+        }
+    }
+    if (auto rules = CurrentRuleDatabase()) {
+        RuleMatch match;
+        if (MatchRuleDatabase(*rules, data, length, match)) {
+            reason = EscalationReason::Literal;
+            return Classification::Escalate;
+        }
+    }
+    return Classification::Clean;
+}
+
+/**
+ * Classify the input and, while it is clean, each of its normalized and
+ * decoded layers; the first that is not clean decides.
+ */
+Classification ClassifyWithLayers(const uint8_t* data, size_t length,
+                                  const ScanPipelinePolicy& policy,
+                                  const std::vector<ScanSignature>& signatures,
+                                  PipelineResult& result, EscalationReason& reason,
+                                  std::string& blockedBy) {
+    Classification verdict = Classify(data, length, policy, signatures, reason, blockedBy);
+    if (verdict != Classification::Clean || !policy.normalize) return verdict;
+
+    const std::vector<ScriptSpan>& spans = ThreadScriptNormalizer().Normalize(
+        data, length, ScriptLanguage::Auto, policy.normalizeLimits);
+    for (size_t i = 1; i < spans.size(); i++) {
+        const ScriptSpan& span = spans[i];
+        verdict = Classify(span.data, span.length, policy, signatures, reason, blockedBy);
+        if (verdict != Classification::Clean) {
+            result.layered = true;
+            result.layerKind = span.kind;
+            result.layerDepth = span.depth;
+            return verdict;
+        }
+    }
+    return Classification::Clean;
+}
+
+void SetVerdict(ScanVerdict& verdict, bool clean, const std::string& description) {
+    verdict.clean = clean;
+    verdict.result = clean ? RESULT_NOT_DETECTED : RESULT_DETECTED;
+    verdict.description = description;
+}
+
+} // namespace
+
+// ============================================================================
+// Policy
+// ============================================================================
+
+const char* ScanTierName(ScanTier tier) {
+    switch (tier) {
+        case ScanTier::Allowlist: return "allowlist";
+        case ScanTier::Cache: return "cache";
+        case ScanTier::Classifier: return "classifier";
+        case ScanTier::Provider: return "provider";
+    }
+    return "provider";
+}
+
+void ConfigureScanPipeline(const ScanPipelinePolicy& policy) {
+    PipelineState::Instance().SetPolicy(policy);
+    VerdictCache::Instance().SetCapacity(policy.cache.enabled ? policy.cacheEntries : 0);
+}
+
+ScanPipelinePolicy CurrentScanPipelinePolicy() {
+    return PipelineState::Instance().Policy();
+}
+
+// ============================================================================
+// Scanning
+// ============================================================================
+
+ScanPipeline::ScanPipeline(ScanEngine engine, std::vector<ScanSignature> signatures)
+    : policy_(CurrentScanPipelinePolicy()), engine_(engine), signatures_(std::move(signatures)) {
+    Blake3Hasher hasher;
+    const char* name = ResolvedEngineName(engine_);
+    hasher.Update(name, std::strlen(name) + 1);
+    for (const ScanSignature& signature : signatures_) {
+        hasher.Update(signature.name.data(), signature.name.size() + 1);
+        uint64_t size = signature.pattern.size();
+        hasher.Update(&size, sizeof(size));
+        hasher.Update(signature.pattern.data(), signature.pattern.size());
+    }
+    uint64_t generation = RuleDatabaseGeneration();
+    hasher.Update(&generation, sizeof(generation));
+    // Normalizing, or normalizing deeper, can change a provider verdict.
+    uint64_t normalize[] = {policy_.normalize, policy_.normalizeLimits.maxDepth,
+                            policy_.normalizeLimits.maxOutputBytes};
+    hasher.Update(normalize, sizeof(normalize));
+    Blake3Digest digest = hasher.Finalize();
+    std::memcpy(&fingerprint_, digest.bytes, sizeof(fingerprint_));
+}
+
+bool ScanPipeline::RunCheapTiers(const uint8_t* data, size_t length, PipelineResult& result) {
+    PipelineState& state = PipelineState::Instance();
+    using Outcome = PipelineState::Outcome;
+    result.engine = ResolvedEngineName(engine_);
+
+    bool allowlist = policy_.allowlist.enabled && policy_.allowlist.mayClear &&
+                     CurrentHashAllowlist() != nullptr;
+    if (allowlist || policy_.cache.enabled) {
+        digest_ = length > BLAKE3_SEGMENT_LEN ? Blake3HashParallel(data, length, WorkerPool::Shared())
+                                              : Blake3Hash(data, length);
+    }
+
+    if (allowlist) {
+        uint64_t start = NowUs();
+        bool hit = IsHashAllowlisted(digest_);
+        state.Record(ScanTier::Allowlist, hit ? Outcome::Clean : Outcome::Escalated,
+                     NowUs() - start);
+        if (hit) {
+            SetVerdict(result.verdict, true, "Known-good content (allowlisted)");
+            result.tier = ScanTier::Allowlist;
+            return true;
+        }
+    }
+
+    if (policy_.cache.enabled) {
+        uint64_t start = NowUs();
+        ScanVerdict cached;
+        bool hit = VerdictCache::Instance().Lookup({digest_, fingerprint_}, cached);
+        bool usable = hit && (cached.clean ? policy_.cache.mayClear : policy_.cache.mayBlock);
+        state.Record(ScanTier::Cache,
+                     !usable ? Outcome::Escalated : cached.clean ? Outcome::Clean : Outcome::Detected,
+                     NowUs() - start);
+        if (usable) {
+            result.verdict = std::move(cached);
+            result.tier = ScanTier::Cache;
+            return true;
+        }
+    }
+
+    if (policy_.classifier.enabled) {
+        uint64_t start = NowUs();
+        EscalationReason reason = EscalationReason::Size;
+        std::string blockedBy;
+        Classification verdict = length > policy_.classifierMaxBytes
+            ? Classification::Escalate
+            : ClassifyWithLayers(data, length, policy_, signatures_, result, reason, blockedBy);
+        if (verdict == Classification::Clean && !policy_.classifier.mayClear) {
+            verdict = Classification::Escalate;
+            reason = EscalationReason::Policy;
+        }
+        uint64_t elapsed = NowUs() - start;
+
+        if (verdict == Classification::Clean) {
+            state.Record(ScanTier::Classifier, Outcome::Clean, elapsed);
+            SetVerdict(result.verdict, true, "No suspicious content");
+            result.tier = ScanTier::Classifier;
+            return true;
+        }
+        if (verdict == Classification::Block) {
+            state.Record(ScanTier::Classifier, Outcome::Detected, elapsed);
+            SetVerdict(result.verdict, false, "Blocked literal: " + blockedBy);
+            result.tier = ScanTier::Classifier;
+            return true;
+        }
+        state.Record(ScanTier::Classifier, Outcome::Escalated, elapsed);
+        state.RecordEscalation(reason);
+        result.escalation = reason;
+        // The provider scans every layer again and says which one it was.
+        result.layered = false;
+    }
+    return false;
+}
+
+bool ScanPipeline::Screen(const uint8_t* data, size_t length, PipelineResult& result) {
+    screened_ = true;
+    return RunCheapTiers(data, length, result);
+}
+
+bool ScanPipeline::Scan(const uint8_t* data, size_t length, const std::string& contentName,
+                        PipelineResult& result, std::string& error) {
+    if (!screened_) {
+        screened_ = true;
+        if (RunCheapTiers(data, length, result)) return true;
+    }
+
+    uint64_t start = NowUs();
+    std::unique_ptr<ScanProvider> provider = CreateScanProvider(engine_, signatures_, error);
+    if (!provider || !provider->Scan(data, length, contentName, result.verdict, error)) {
+        return false;
+    }
+    if (result.verdict.clean && policy_.normalize && length <= NORMALIZE_MAX_BYTES) {
+        const std::vector<ScriptSpan>& spans = ThreadScriptNormalizer().Normalize(
+            data, length, ScriptLanguage::Auto, policy_.normalizeLimits);
+        for (size_t i = 1; i < spans.size() && result.verdict.clean; i++) {
+            const ScriptSpan& span = spans[i];
+            std::string layerName = contentName + "#" + SpanKindName(span.kind) +
+                                    std::to_string(span.depth);
+            if (!provider->Scan(span.data, span.length, layerName, result.verdict, error)) {
+                return false;
+            }
+            if (!result.verdict.clean) {
+                result.layered = true;
+                result.layerKind = span.kind;
+                result.layerDepth = span.depth;
+            }
+        }
+    }
+    result.engine = provider->Name();
+    result.tier = ScanTier::Provider;
+    PipelineState::Instance().Record(
+        ScanTier::Provider,
+        result.verdict.clean ? PipelineState::Outcome::Clean : PipelineState::Outcome::Detected,
+        NowUs() - start);
+
+    if (policy_.cache.enabled) {
+        VerdictCache::Instance().Insert({digest_, fingerprint_}, result.verdict,
+                                        policy_.cacheTtlMs, policy_.cacheEntries);
+    }
+    return true;
+}
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+namespace {
+
+const char* EscalationName(EscalationReason reason) {
+    switch (reason) {
+        case EscalationReason::None: return nullptr;
+        case EscalationReason::Size: return "size";
+        case EscalationReason::Binary: return "binary";
+        case EscalationReason::Entropy: return "entropy";
+        case EscalationReason::LongLine: return "longLine";
+        case EscalationReason::Literal: return "literal";
+        case EscalationReason::Blocked: return "blocked";
+        case EscalationReason::Policy: return "policy";
+    }
+    return nullptr;
+}
+
+Napi::Object ResultObject(Napi::Env env, const PipelineResult& result, uint64_t latencyUs) {
+    Napi::Object out = Napi::Object::New(env);
+    out.Set("clean", Napi::Boolean::New(env, result.verdict.clean));
+    out.Set("result", Napi::Number::New(env, result.verdict.result));
+    out.Set("description", Napi::String::New(env, result.verdict.description));
+    out.Set("engine", Napi::String::New(env, result.engine));
+    out.Set("tier", Napi::String::New(env, ScanTierName(result.tier)));
+    const char* escalation = EscalationName(result.escalation);
+    out.Set("escalation", escalation ? Napi::Value(Napi::String::New(env, escalation)) : env.Null());
+    if (result.layered) {
+        Napi::Object layer = Napi::Object::New(env);
+        layer.Set("kind", Napi::String::New(env, SpanKindName(result.layerKind)));
+        layer.Set("depth", Napi::Number::New(env, result.layerDepth));
+        out.Set("layer", layer);
+    } else {
+        out.Set("layer", env.Null());
+    }
+    out.Set("latencyUs", Napi::Number::New(env, static_cast<double>(latencyUs)));
+    return out;
+}
+
+class ScanContentWorker : public Napi::AsyncWorker {
+public:
+    ScanContentWorker(Napi::Env env, std::unique_ptr<ScanPipeline> pipeline, Napi::Value content,
+                      std::string text, std::string name, PipelineResult screened,
+                      WorkContext work, uint64_t startUs)
+        : Napi::AsyncWorker(env),
+          deferred_(Napi::Promise::Deferred::New(env)),
+          pipeline_(std::move(pipeline)),
+          text_(std::move(text)),
+          name_(std::move(name)),
+          result_(std::move(screened)),
+          work_(work),
+          startUs_(startUs) {
+        if (content.IsBuffer()) {
+            // Held so the bytes stay put while the provider reads them.
+            auto bytes = content.As<Napi::Buffer<uint8_t>>();
+            data_ = bytes.Data();
+            length_ = bytes.Length();
+            buffer_ = Napi::Persistent(content.As<Napi::Object>());
+        } else {
+            data_ = reinterpret_cast<const uint8_t*>(text_.data());
+            length_ = text_.size();
+        }
+    }
+
+    Napi::Promise Promise() const { return deferred_.Promise(); }
+
+    void Execute() override {
+        WorkScope scope(work_);
+        std::string error;
+        if (!pipeline_->Scan(data_, length_, name_, result_, error)) {
+            SetError(error);
+            return;
+        }
+        latencyUs_ = NowUs() - startUs_;
+    }
+
+    void OnOK() override {
+        deferred_.Resolve(ResultObject(Env(), result_, latencyUs_));
+    }
+
+    void OnError(const Napi::Error& error) override {
+        deferred_.Reject(error.Value());
+    }
+
+private:
+    Napi::Promise::Deferred deferred_;
+    std::unique_ptr<ScanPipeline> pipeline_;
+    Napi::ObjectReference buffer_;
+    std::string text_;
+    const uint8_t* data_ = nullptr;
+    size_t length_ = 0;
+    std::string name_;
+    PipelineResult result_;
+    WorkContext work_;
+    uint64_t startUs_;
+    uint64_t latencyUs_ = 0;
+};
+
+Napi::Value RejectedPromise(Napi::Env env, const std::string& message) {
+    auto deferred = Napi::Promise::Deferred::New(env);
+    deferred.Reject(Napi::TypeError::New(env, message).Value());
+    return deferred.Promise();
+}
+
+bool ReadTierPolicy(const Napi::Object& options, const char* name, bool canBlock,
+                    ScanTierPolicy& tier, Napi::Object& out, std::string& error) {
+    Napi::Value value = options.Get(name);
+    if (value.IsUndefined()) return true;
+    if (!value.IsObject()) {
+        error = std::string(name) + " must be an object";
+        return false;
+    }
+    out = value.As<Napi::Object>();
+
+    Napi::Value enabled = out.Get("enabled");
+    if (enabled.IsBoolean()) {
+        tier.enabled = enabled.As<Napi::Boolean>().Value();
+    } else if (!enabled.IsUndefined()) {
+        error = std::string(name) + ".enabled must be a boolean";
+        return false;
+    }
+
+    Napi::Value emit = out.Get("emit");
+    if (emit.IsUndefined()) return true;
+    if (!emit.IsArray()) {
+        error = std::string(name) + ".emit must be an array";
+        return false;
+    }
+    tier.mayClear = false;
+    tier.mayBlock = false;
+    Napi::Array list = emit.As<Napi::Array>();
+    for (uint32_t i = 0; i < list.Length(); i++) {
+        Napi::Value item = list.Get(i);
+        std::string verdict = item.IsString() ? item.As<Napi::String>().Utf8Value() : "";
+        if (verdict == "clean") {
+            tier.mayClear = true;
+        } else if (verdict == "detected" && canBlock) {
+            tier.mayBlock = true;
+        } else {
+            error = std::string(name) + ".emit may only contain " +
+                    (canBlock ? "'clean' and 'detected'" : "'clean'");
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ReadSize(const Napi::Object& options, const char* name, double max, uint64_t& out,
+              std::string& error) {
+    Napi::Value value = options.Get(name);
+    if (value.IsUndefined()) return true;
+    double number = value.IsNumber() ? value.As<Napi::Number>().DoubleValue() : -1;
+    if (!(number >= 0) || number != std::floor(number) || number > max) {
+        error = std::string(name) + " must be an integer from 0 to " +
+                std::to_string(static_cast<uint64_t>(max));
+        return false;
+    }
+    out = static_cast<uint64_t>(number);
+    return true;
+}
+
+bool ReadPolicy(const Napi::Object& options, ScanPipelinePolicy& policy, std::string& error) {
+    Napi::Value normalize = options.Get("normalize");
+    if (!normalize.IsUndefined()) {
+        if (!normalize.IsObject()) {
+            error = "normalize must be an object";
+            return false;
+        }
+        Napi::Object o = normalize.As<Napi::Object>();
+        Napi::Value enabled = o.Get("enabled");
+        if (enabled.IsBoolean()) {
+            policy.normalize = enabled.As<Napi::Boolean>().Value();
+        } else if (!enabled.IsUndefined()) {
+            error = "normalize.enabled must be a boolean";
+            return false;
+        }
+        uint64_t maxDepth = policy.normalizeLimits.maxDepth;
+        uint64_t maxOutput = policy.normalizeLimits.maxOutputBytes;
+        if (!ReadSize(o, "maxDepth", 16, maxDepth, error) ||
+            !ReadSize(o, "maxOutputBytes", 1024.0 * 1024 * 1024, maxOutput, error)) {
+            return false;
+        }
+        policy.normalizeLimits.maxDepth = static_cast<uint32_t>(maxDepth);
+        policy.normalizeLimits.maxOutputBytes = static_cast<size_t>(maxOutput);
+    }
+
+    Napi::Object allowlist, cache, classifier;
+    if (!ReadTierPolicy(options, "allowlist", false, policy.allowlist, allowlist, error) ||
+        !ReadTierPolicy(options, "cache", true, policy.cache, cache, error) ||
+        !ReadTierPolicy(options, "classifier", true, policy.classifier, classifier, error)) {
+        return false;
+    }
+
+    if (!cache.IsEmpty()) {
+        uint64_t entries = policy.cacheEntries;
+        if (!ReadSize(cache, "entries", 1 << 24, entries, error) ||
+            !ReadSize(cache, "ttlMs", 7 * 24 * 3600 * 1000.0, policy.cacheTtlMs, error)) {
+            return false;
+        }
+        policy.cacheEntries = static_cast<size_t>(entries);
+    }
+
+    if (classifier.IsEmpty()) return true;
+    uint64_t maxBytes = policy.classifierMaxBytes;
+    uint64_t maxLine = policy.classifierMaxLineBytes;
+    if (!ReadSize(classifier, "maxBytes", 16 * 1024 * 1024, maxBytes, error) ||
+        !ReadSize(classifier, "maxLineBytes", 16 * 1024 * 1024, maxLine, error)) {
+        return false;
+    }
+    policy.classifierMaxBytes = static_cast<size_t>(maxBytes);
+    policy.classifierMaxLineBytes = static_cast<size_t>(maxLine);
+
+    Napi::Value entropy = classifier.Get("maxEntropy");
+    if (!entropy.IsUndefined()) {
+        double value = entropy.IsNumber() ? entropy.As<Napi::Number>().DoubleValue() : -1;
+        if (!(value >= 0 && value <= 8)) {
+            error = "maxEntropy must be a number from 0 to 8";
+            return false;
+        }
+        policy.classifierMaxEntropy = value;
+    }
+
+    Napi::Value suspicious = classifier.Get("suspicious");
+    if (!suspicious.IsUndefined()) {
+        if (!suspicious.IsArray()) {
+            error = "suspicious must be an array of strings";
+            return false;
+        }
+        Napi::Array list = suspicious.As<Napi::Array>();
+        for (uint32_t i = 0; i < list.Length(); i++) {
+            Napi::Value item = list.Get(i);
+            if (!item.IsString() || item.As<Napi::String>().Utf8Value().empty()) {
+                error = "suspicious must be an array of non-empty strings";
+                return false;
+            }
+            policy.suspicious.push_back(Lowercase(item.As<Napi::String>().Utf8Value()));
+        }
+    }
+
+    Napi::Value block = classifier.Get("block");
+    if (!block.IsUndefined()) {
+        if (!ReadScanSignatures(block, policy.block, error)) return false;
+        for (ScanSignature& literal : policy.block) literal.pattern = Lowercase(literal.pattern);
+    }
+    return true;
+}
+
+double Percentile(const std::array<uint64_t, LATENCY_BUCKETS>& histogram, double fraction) {
+    uint64_t total = 0;
+    for (uint64_t count : histogram) total += count;
+    if (total == 0) return 0;
+
+    uint64_t rank = static_cast<uint64_t>(std::ceil(fraction * static_cast<double>(total)));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < LATENCY_BUCKETS; i++) {
+        seen += histogram[i];
+        if (seen >= rank) return i == 0 ? 0 : std::ldexp(1.0, static_cast<int>(i));
+    }
+    return std::ldexp(1.0, static_cast<int>(LATENCY_BUCKETS - 1));
+}
+
+} // namespace
+
+Napi::Value ScanContent(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    uint64_t startUs = NowUs();
+
+    if (info.Length() < 1 || !(info[0].IsString() || info[0].IsBuffer())) {
+        return RejectedPromise(env, "scanContent expects a Buffer or string");
+    }
+    Napi::Value opts = info.Length() > 1 ? info[1] : env.Undefined();
+    if (!opts.IsUndefined() && !opts.IsObject()) {
+        return RejectedPromise(env, "options must be an object");
+    }
+
+    ScanEngine engine = ScanEngine::Auto;
+    std::vector<ScanSignature> signatures;
+    std::string name = "content";
+    std::string error;
+    if (opts.IsObject()) {
+        Napi::Object o = opts.As<Napi::Object>();
+        if (!ReadScanEngineOptions(o, engine, signatures, error)) {
+            return RejectedPromise(env, error);
+        }
+        Napi::Value contentName = o.Get("name");
+        if (contentName.IsString()) {
+            name = contentName.As<Napi::String>().Utf8Value();
+        } else if (!contentName.IsUndefined()) {
+            return RejectedPromise(env, "name must be a string");
+        }
+    }
+
+    // A script waiting to run: interactive unless the caller says otherwise.
+    WorkContext work;
+    if (!ReadWorkContext(opts, WorkPriority::Interactive, work, error)) {
+        return RejectedPromise(env, error);
+    }
+
+    std::string text;
+    const uint8_t* data;
+    size_t length;
+    if (info[0].IsBuffer()) {
+        auto bytes = info[0].As<Napi::Buffer<uint8_t>>();
+        data = bytes.Data();
+        length = bytes.Length();
+    } else {
+        text = info[0].As<Napi::String>().Utf8Value();
+        data = reinterpret_cast<const uint8_t*>(text.data());
+        length = text.size();
+    }
+
+    auto pipeline = std::make_unique<ScanPipeline>(engine, std::move(signatures));
+    PipelineResult result;
+    if (length <= INLINE_SCREEN_BYTES && pipeline->Screen(data, length, result)) {
+        auto deferred = Napi::Promise::Deferred::New(env);
+        deferred.Resolve(ResultObject(env, result, NowUs() - startUs));
+        return deferred.Promise();
+    }
+
+    auto* worker = new ScanContentWorker(env, std::move(pipeline), info[0], std::move(text),
+                                         std::move(name), std::move(result), work, startUs);
+    Napi::Promise promise = worker->Promise();
+    worker->Queue();
+    return promise;
+}
+
+Napi::Value ConfigureScanPipelineExport(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "configureScanPipeline expects a policy object")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    ScanPipelinePolicy policy;
+    std::string error;
+    if (!ReadPolicy(info[0].As<Napi::Object>(), policy, error)) {
+        Napi::TypeError::New(env, error).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    ConfigureScanPipeline(policy);
+    return Napi::Boolean::New(env, true);
+}
+
+Napi::Value GetScanPipelineStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    PipelineState& state = PipelineState::Instance();
+
+    Napi::Object tiers = Napi::Object::New(env);
+    for (ScanTier tier : {ScanTier::Allowlist, ScanTier::Cache, ScanTier::Classifier,
+                          ScanTier::Provider}) {
+        PipelineState::TierSnapshot snapshot = state.Tier(tier);
+        Napi::Object out = Napi::Object::New(env);
+        out.Set("scans", Napi::Number::New(env, static_cast<double>(snapshot.scans)));
+        out.Set("clean", Napi::Number::New(env, static_cast<double>(snapshot.clean)));
+        out.Set("detected", Napi::Number::New(env, static_cast<double>(snapshot.detected)));
+        out.Set("escalated", Napi::Number::New(env, static_cast<double>(snapshot.escalated)));
+
+        Napi::Object latency = Napi::Object::New(env);
+        latency.Set("p50", Napi::Number::New(env, Percentile(snapshot.latency, 0.50)));
+        latency.Set("p90", Napi::Number::New(env, Percentile(snapshot.latency, 0.90)));
+        latency.Set("p99", Napi::Number::New(env, Percentile(snapshot.latency, 0.99)));
+        latency.Set("max", Napi::Number::New(env, Percentile(snapshot.latency, 1.0)));
+        out.Set("latencyUs", latency);
+        out.Set("totalUs", Napi::Number::New(env, static_cast<double>(snapshot.totalUs)));
+        tiers.Set(ScanTierName(tier), out);
+    }
+
+    Napi::Object escalations = Napi::Object::New(env);
+    for (EscalationReason reason : {EscalationReason::Size, EscalationReason::Binary,
+                                    EscalationReason::Entropy, EscalationReason::LongLine,
+                                    EscalationReason::Literal, EscalationReason::Blocked,
+                                    EscalationReason::Policy}) {
+        escalations.Set(EscalationName(reason),
+                        Napi::Number::New(env, static_cast<double>(state.Escalations(reason))));
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("tiers", tiers);
+    result.Set("escalations", escalations);
+    result.Set("cache", VerdictCache::Instance().Describe(env));
+    return result;
+}
+
+Napi::Value ResetScanPipelineStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    PipelineState::Instance().Reset();
+    VerdictCache::Instance().ResetCounters();
+
+    if (info.Length() > 0 && info[0].IsObject()) {
+        Napi::Value cache = info[0].As<Napi::Object>().Get("cache");
+        if (cache.IsBoolean() && cache.As<Napi::Boolean>().Value()) {
+            VerdictCache::Instance().Clear();
+        }
+    }
+    return env.Undefined();
+}
+
+} // namespace TerminAI
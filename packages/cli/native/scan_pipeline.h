@@ -0,0 +1,234 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Tiered Scan Pipeline Header
+ *
+ * Scans single buffers (scripts about to run, content the broker is asked
+ * to vet) through ordered tiers, cheapest first, so that a one-line `echo`
+ * does not cost a full AMSI round trip:
+ *
+ *   allowlist   content hash in the known-good table (hash_allowlist.h)
+ *   cache       verdict the provider gave for the same content, engine,
+ *               signatures and rule database, within its time to live
+ *   classifier  single-pass structural check: size, control bytes, byte
+ *               entropy, longest line, and case-insensitive suspicious
+ *               literals, caller signatures and the active rule database
+ *   provider    the scan engine (scan_provider.h)
+ *
+ * Scripts are also normalized (script_normalizer.h): the classifier and
+ * the provider see the input, then its de-obfuscated text and every
+ * payload it decodes, and the first layer that is not clean decides.
+ *
+ * Each tier either emits a verdict or escalates to the next one. Policy
+ * decides which verdicts a tier may emit: by default the allowlist may
+ * only clear content, the cache may replay both verdicts, and the
+ * classifier emits nothing, it only escalates. A heuristic is no stand-in
+ * for AMSI, so clearing in the classifier is opt-in (emit: ['clean']), and
+ * even then nothing larger than 4 KiB. A tier that finds a verdict it may
+ * not emit escalates instead. The provider always
+ * decides, and its verdicts feed the cache.
+ *
+ * Content small enough for the classifier is screened on the calling
+ * thread; only escalations (and hashing of larger content) go to the
+ * worker pool. Every tier counts its decisions and latency.
+ */
+
+#pragma once
+
+#include <napi.h>
+#include "blake3.h"
+#include "scan_provider.h"
+#include "script_normalizer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace TerminAI {
+
+// ============================================================================
+// Policy
+// ============================================================================
+
+enum class ScanTier {
+    Allowlist,
+    Cache,
+    Classifier,
+    Provider,
+};
+
+constexpr size_t SCAN_TIER_COUNT = 4;
+
+/** "allowlist" | "cache" | "classifier" | "provider" */
+const char* ScanTierName(ScanTier tier);
+
+struct ScanTierPolicy {
+    bool enabled = true;
+    /** The tier may decide that content is clean */
+    bool mayClear = true;
+    /** The tier may decide that content is a threat */
+    bool mayBlock = false;
+};
+
+struct ScanPipelinePolicy {
+    ScanTierPolicy allowlist;
+    ScanTierPolicy cache{true, true, true};
+    /** Escalate-only unless configured to clear */
+    ScanTierPolicy classifier{true, false, false};
+
+    /** Cached verdicts kept (least recently used are evicted) */
+    size_t cacheEntries = 4096;
+    /** How long a cached verdict stays valid */
+    uint64_t cacheTtlMs = 10 * 60 * 1000;
+
+    /** Larger content always escalates past the classifier */
+    size_t classifierMaxBytes = 4096;
+    /** Escalate content whose byte entropy exceeds this (bits per byte) */
+    double classifierMaxEntropy = 5.5;
+    /** Escalate content with a line longer than this */
+    size_t classifierMaxLineBytes = 1024;
+    /** Literals that escalate, on top of the built-in set (lowercase) */
+    std::vector<std::string> suspicious;
+    /** Literals the classifier blocks when it may; otherwise they escalate */
+    std::vector<ScanSignature> block;
+
+    /** Classify and scan the normalized layers of scripts too */
+    bool normalize = true;
+    NormalizeLimits normalizeLimits;
+};
+
+/** Replace the process-wide policy. Cached verdicts are kept. */
+void ConfigureScanPipeline(const ScanPipelinePolicy& policy);
+
+/** The process-wide policy. */
+ScanPipelinePolicy CurrentScanPipelinePolicy();
+
+// ============================================================================
+// Scanning
+// ============================================================================
+
+/** Why the classifier escalated content. */
+enum class EscalationReason {
+    None,
+    Size,
+    Binary,
+    Entropy,
+    LongLine,
+    Literal,
+    /** A match the classifier may not block */
+    Blocked,
+    /** Clean content the classifier may not clear */
+    Policy,
+};
+
+constexpr size_t ESCALATION_REASON_COUNT = 8;
+
+struct PipelineResult {
+    ScanVerdict verdict;
+    /** The tier that decided */
+    ScanTier tier = ScanTier::Provider;
+    /** Why the classifier passed the content on, if it ran */
+    EscalationReason escalation = EscalationReason::None;
+    /** "amsi" or "portable" */
+    std::string engine;
+    /** The verdict came from a normalized or decoded layer, not the input */
+    bool layered = false;
+    SpanKind layerKind = SpanKind::Source;
+    uint32_t layerDepth = 0;
+};
+
+/**
+ * One scan's trip through the tiers, under the policy current when it was
+ * created. Screen() runs the cheap tiers, Scan() whatever is left.
+ */
+class ScanPipeline {
+public:
+    ScanPipeline(ScanEngine engine, std::vector<ScanSignature> signatures);
+
+    /**
+     * Run the allowlist, cache and classifier tiers.
+     *
+     * @return true if one of them decided
+     */
+    bool Screen(const uint8_t* data, size_t length, PipelineResult& result);
+
+    /**
+     * Run every tier not yet run, ending with the provider. Safe to call
+     * off the main thread.
+     *
+     * @return false with a message if the engine failed
+     */
+    bool Scan(const uint8_t* data, size_t length, const std::string& contentName,
+              PipelineResult& result, std::string& error);
+
+private:
+    bool RunCheapTiers(const uint8_t* data, size_t length, PipelineResult& result);
+
+    ScanPipelinePolicy policy_;
+    ScanEngine engine_;
+    std::vector<ScanSignature> signatures_;
+    /** Engine, signatures and rule database, for cache keys */
+    uint64_t fingerprint_ = 0;
+    Blake3Digest digest_;
+    bool screened_ = false;
+};
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+/**
+ * Scan one buffer through the tiers.
+ *
+ * Arguments:
+ *   0: Buffer | String - Content
+ *   1: Object (optional)
+ *      - name?: String - Content name shown to the engine (default 'content')
+ *      - engine?, signatures? - as for scanArchive
+ *      - priority?, sessionId? - scheduling of the provider tier
+ *        (default 'interactive')
+ *
+ * Returns: Promise<Object> - { clean, result, description, engine,
+ *          tier, escalation, layer: { kind, depth } | null, latencyUs }
+ *   `layer` names the normalized layer the verdict came from.
+ */
+Napi::Value ScanContent(const Napi::CallbackInfo& info);
+
+/**
+ * Replace the tier policy. Omitted fields take their defaults.
+ *
+ * Arguments:
+ *   0: Object
+ *      - allowlist?, cache?, classifier?: { enabled?, emit?: Array<'clean'
+ *        | 'detected'> }
+ *      - cache?.entries?, cache?.ttlMs?
+ *      - classifier?.maxBytes?, maxEntropy?, maxLineBytes?,
+ *        suspicious?: String[], block?: Array<{ name, pattern }>
+ *      - normalize?: { enabled?, maxDepth?, maxOutputBytes? }
+ *
+ * Returns: Boolean - true (throws TypeError on invalid policy)
+ */
+Napi::Value ConfigureScanPipelineExport(const Napi::CallbackInfo& info);
+
+/**
+ * Per-tier counters and latency, and the cache's occupancy.
+ *
+ * Returns: Object - { tiers: { allowlist, cache, classifier, provider:
+ *          { scans, clean, detected, escalated, latencyUs: { p50, p90, p99,
+ *          max }, totalUs } }, escalations: { size, binary, entropy,
+ *          longLine, literal, blocked, policy }, cache: { entries,
+ *          capacity, hits, misses, evictions, expired } }
+ *   Percentiles are bucket upper bounds (powers of two).
+ */
+Napi::Value GetScanPipelineStats(const Napi::CallbackInfo& info);
+
+/**
+ * Zero the counters; with `{ cache: true }` also drop cached verdicts.
+ */
+Napi::Value ResetScanPipelineStats(const Napi::CallbackInfo& info);
+
+} // namespace TerminAI
@@ -0,0 +1,219 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Scan Provider Implementation
+ */
+
+#include "scan_provider.h"
+#include "rule_database.h"
+
+#ifdef _WIN32
+#include "amsi_scanner.h"
+#include "provider_init.h"
+#endif
+
+#include <algorithm>
+#include <functional>
+
+namespace TerminAI {
+
+namespace {
+
+constexpr int32_t RESULT_NOT_DETECTED = 1;
+constexpr int32_t RESULT_DETECTED = 32768;
+
+/**
+ * The EICAR anti-malware test file. Kept in two halves so that this source
+ * file and the built module are not themselves flagged.
+ */
+std::string EicarPattern() {
+    return std::string("X5O!P%@AP[4\\PZX54(P^)7CC)7}$") + "EICAR-STANDARD-ANTIVIRUS-TEST-FILE!$H+H*";
+}
+
+// ============================================================================
+// Portable Engine
+// ============================================================================
+
+class PortableScanProvider : public ScanProvider {
+public:
+    explicit PortableScanProvider(const std::vector<ScanSignature>& signatures)
+        : rules_(CurrentRuleDatabase()) {
+        Add("EICAR-Test-File", EicarPattern());
+        for (const ScanSignature& signature : signatures) Add(signature.name, signature.pattern);
+    }
+
+    const char* Name() const override { return "portable"; }
+
+    bool Scan(const uint8_t* data, size_t length, const std::string&, ScanVerdict& verdict,
+              std::string&) override {
+        const char* begin = reinterpret_cast<const char*>(data);
+        const char* end = begin + length;
+        for (const auto& signature : signatures_) {
+            if (signature->pattern.size() > length) continue;
+            if (std::search(begin, end, signature->searcher) != end) {
+                verdict.clean = false;
+                verdict.result = RESULT_DETECTED;
+                verdict.description = "Signature match: " + signature->name;
+                return true;
+            }
+        }
+        if (rules_) {
+            RuleMatch match;
+            bool matched = MatchRuleDatabase(*rules_, data, length, match);
+            RecordRuleDatabaseScan(matched);
+            if (matched) {
+                verdict.clean = false;
+                verdict.result = RESULT_DETECTED;
+                verdict.description = "Signature match: " + match.name;
+                return true;
+            }
+        }
+        verdict.clean = true;
+        verdict.result = RESULT_NOT_DETECTED;
+        verdict.description = "No threat detected";
+        return true;
+    }
+
+private:
+    struct Signature {
+        Signature(std::string n, std::string p)
+            : name(std::move(n)), pattern(std::move(p)), searcher(pattern.begin(), pattern.end()) {}
+
+        // Not copyable: the searcher points into `pattern`.
+        Signature(const Signature&) = delete;
+        Signature& operator=(const Signature&) = delete;
+
+        std::string name;
+        std::string pattern;
+        std::boyer_moore_horspool_searcher<std::string::const_iterator> searcher;
+    };
+
+    void Add(const std::string& name, const std::string& pattern) {
+        if (pattern.empty()) return;
+        signatures_.push_back(std::make_unique<Signature>(name, pattern));
+    }
+
+    // Searchers are built once; Scan() only reads them, so threads can share it.
+    std::vector<std::unique_ptr<Signature>> signatures_;
+    /** The rule database active when the provider was created, if any */
+    std::shared_ptr<const RuleDatabase> rules_;
+};
+
+// ============================================================================
+// AMSI Engine
+// ============================================================================
+
+#ifdef _WIN32
+
+class AmsiScanProvider : public ScanProvider {
+public:
+    AmsiScanProvider() : session_(OpenAmsiSession()) {}
+    ~AmsiScanProvider() override { CloseAmsiSession(session_); }
+
+    const char* Name() const override { return "amsi"; }
+
+    bool Scan(const uint8_t* data, size_t length, const std::string& contentName,
+              ScanVerdict& verdict, std::string& error) override {
+        AMSI_RESULT result = AMSI_RESULT_DETECTED;
+        if (!AmsiScanContent(data, length, contentName, session_, result, error)) return false;
+        verdict.clean = IsAmsiResultClean(result);
+        verdict.result = static_cast<int32_t>(result);
+        verdict.description = GetAmsiResultDescription(result);
+        return true;
+    }
+
+private:
+    HAMSISESSION session_;
+};
+
+#endif // _WIN32
+
+} // namespace
+
+bool ParseScanEngine(const std::string& name, ScanEngine& engine) {
+    if (name == "auto") {
+        engine = ScanEngine::Auto;
+    } else if (name == "amsi") {
+        engine = ScanEngine::Amsi;
+    } else if (name == "portable") {
+        engine = ScanEngine::Portable;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::unique_ptr<ScanProvider> CreateScanProvider(ScanEngine engine,
+                                                 const std::vector<ScanSignature>& signatures,
+                                                 std::string& error) {
+#ifdef _WIN32
+    if (engine == ScanEngine::Auto || engine == ScanEngine::Amsi) {
+        if (!IsAmsiInitialized() && !AwaitNativeProvider("amsi") && !InitializeAmsi()) {
+            error = "AMSI not available";
+            return nullptr;
+        }
+        return std::make_unique<AmsiScanProvider>();
+    }
+#else
+    if (engine == ScanEngine::Amsi) {
+        error = "AMSI is only available on Windows";
+        return nullptr;
+    }
+#endif
+    return std::make_unique<PortableScanProvider>(signatures);
+}
+
+// ============================================================================
+// NAPI Helpers
+// ============================================================================
+
+bool ReadScanEngineOptions(const Napi::Object& options, ScanEngine& engine,
+                           std::vector<ScanSignature>& signatures, std::string& error) {
+    Napi::Value engineName = options.Get("engine");
+    if (!engineName.IsUndefined() &&
+        (!engineName.IsString() ||
+         !ParseScanEngine(engineName.As<Napi::String>().Utf8Value(), engine))) {
+        error = "engine must be 'auto', 'amsi' or 'portable'";
+        return false;
+    }
+
+    Napi::Value value = options.Get("signatures");
+    return value.IsUndefined() || ReadScanSignatures(value, signatures, error);
+}
+
+bool ReadScanSignatures(const Napi::Value& value, std::vector<ScanSignature>& signatures,
+                        std::string& error) {
+    if (!value.IsArray()) {
+        error = "signatures must be an array";
+        return false;
+    }
+    Napi::Array list = value.As<Napi::Array>();
+    for (uint32_t i = 0; i < list.Length(); i++) {
+        Napi::Value item = list.Get(i);
+        Napi::Value name = item.IsObject() ? item.As<Napi::Object>().Get("name") : item;
+        Napi::Value pattern = item.IsObject() ? item.As<Napi::Object>().Get("pattern") : item;
+        ScanSignature signature;
+        if (!name.IsString() || !(pattern.IsString() || pattern.IsBuffer())) {
+            error = "signatures must be { name: string, pattern: string | Buffer }";
+            return false;
+        }
+        signature.name = name.As<Napi::String>().Utf8Value();
+        if (pattern.IsBuffer()) {
+            auto bytes = pattern.As<Napi::Buffer<uint8_t>>();
+            signature.pattern.assign(reinterpret_cast<const char*>(bytes.Data()), bytes.Length());
+        } else {
+            signature.pattern = pattern.As<Napi::String>().Utf8Value();
+        }
+        if (signature.pattern.empty()) {
+            error = "signature patterns must not be empty";
+            return false;
+        }
+        signatures.push_back(std::move(signature));
+    }
+    return true;
+}
+
+} // namespace TerminAI
@@ -0,0 +1,109 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Scan Provider Header
+ *
+ * The content scanner behind native callers that scan many buffers at once
+ * (archive members) or scan content on its way to disk (scanned writes).
+ * Two engines:
+ *
+ *   amsi      Windows AMSI, one AMSI session per provider so the antimalware
+ *             product can correlate every buffer scanned for one request
+ *   portable  an in-process byte-signature matcher: the EICAR test string,
+ *             any signatures the caller supplies and the active precompiled
+ *             rule database (rule_database.h). Runs everywhere and is what
+ *             Linux and macOS use
+ *
+ * Verdicts use the AMSI result codes (see AmsiResult in amsi_scanner.h) so
+ * callers report both engines the same way. Scan() may be called from
+ * several pool threads at once.
+ */
+
+#pragma once
+
+#include <napi.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace TerminAI {
+
+enum class ScanEngine {
+    /** AMSI on Windows, portable elsewhere */
+    Auto,
+    Amsi,
+    Portable,
+};
+
+struct ScanVerdict {
+    bool clean = true;
+    /** AMSI result code: 1 = not detected, 32768 = detected */
+    int32_t result = 0;
+    std::string description;
+};
+
+struct ScanSignature {
+    std::string name;
+    std::string pattern;
+};
+
+class ScanProvider {
+public:
+    virtual ~ScanProvider() = default;
+
+    /** "amsi" or "portable" */
+    virtual const char* Name() const = 0;
+
+    /**
+     * Scan one buffer.
+     *
+     * @param contentName Shown to the engine as the content's origin,
+     *                    e.g. "bundle.zip!/bin/setup.ps1"
+     * @return false with a message if the engine failed to scan
+     */
+    virtual bool Scan(const uint8_t* data, size_t length, const std::string& contentName,
+                      ScanVerdict& verdict, std::string& error) = 0;
+};
+
+/** Parse "auto" | "amsi" | "portable". */
+bool ParseScanEngine(const std::string& name, ScanEngine& engine);
+
+/**
+ * Create a provider. `signatures` extend the portable engine's built-in
+ * set and are ignored by AMSI.
+ *
+ * @return nullptr with a message if the engine is not available here
+ */
+std::unique_ptr<ScanProvider> CreateScanProvider(ScanEngine engine,
+                                                 const std::vector<ScanSignature>& signatures,
+                                                 std::string& error);
+
+// ============================================================================
+// NAPI Helpers
+// ============================================================================
+
+/**
+ * Read an Array<{ name, pattern: string | Buffer }> of signatures.
+ *
+ * @return false with a message suitable for a TypeError
+ */
+bool ReadScanSignatures(const Napi::Value& value, std::vector<ScanSignature>& signatures,
+                        std::string& error);
+
+/**
+ * Read the `engine` ('auto' | 'amsi' | 'portable') and `signatures`
+ * (Array<{ name, pattern: string | Buffer }>) options shared by the
+ * scanning exports. Absent options keep the values passed in.
+ *
+ * @return false with a message suitable for a TypeError
+ */
+bool ReadScanEngineOptions(const Napi::Object& options, ScanEngine& engine,
+                           std::vector<ScanSignature>& signatures, std::string& error);
+
+} // namespace TerminAI
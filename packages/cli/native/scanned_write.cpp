@@ -0,0 +1,461 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Scanned Write Implementation
+ */
+
+#include "scanned_write.h"
+#include "work_scheduler.h"
+#include "worker_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+#ifdef _WIN32
+#include <windows.h>
+#include "appcontainer_manager.h"
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace TerminAI {
+
+namespace {
+
+/** Bytes written (and hashed) per step; the cancel token is checked between steps. */
+constexpr size_t WRITE_CHUNK = 1024 * 1024;
+
+/**
+ * Below this the scan runs on the calling thread before anything is
+ * written: handing it to the pool costs more than it saves, and a
+ * detection then never touches the disk.
+ */
+constexpr size_t CONCURRENT_SCAN_MIN = 256 * 1024;
+
+std::atomic<uint32_t> g_tempCounter{0};
+
+// ============================================================================
+// Temporary File
+// ============================================================================
+
+/**
+ * A file created exclusively next to its target, written sequentially, then
+ * either renamed over the target or deleted. Deleted on destruction unless
+ * committed.
+ */
+class TempFile {
+public:
+    TempFile() = default;
+    TempFile(const TempFile&) = delete;
+    TempFile& operator=(const TempFile&) = delete;
+    ~TempFile() { Discard(); }
+
+    /** Create ".<name>.<unique>.tmp" in the target's directory. */
+    bool Create(const std::string& target, std::string& error) {
+        size_t slash = target.find_last_of(SEPARATORS);
+        std::string dir = slash == std::string::npos ? "" : target.substr(0, slash + 1);
+        std::string name = target.substr(slash == std::string::npos ? 0 : slash + 1);
+        if (name.empty()) {
+            error = "write " + target + ": not a file path";
+            return false;
+        }
+
+        for (int attempt = 0; attempt < 16; attempt++) {
+            char suffix[32];
+            uint64_t unique = static_cast<uint64_t>(
+                std::chrono::steady_clock::now().time_since_epoch().count());
+            std::snprintf(suffix, sizeof(suffix), ".%08x%04x.tmp",
+                          static_cast<uint32_t>(unique ^ (unique >> 32)),
+                          g_tempCounter.fetch_add(1) & 0xffff);
+            path_ = dir + "." + name + suffix;
+            if (Open(target, error)) return true;
+            if (!exists_) return false;
+        }
+        error = "write " + target + ": could not create a temporary file";
+        return false;
+    }
+
+#ifdef _WIN32
+    bool Write(const uint8_t* data, size_t length, std::string& error) {
+        while (length > 0) {
+            DWORD chunk = static_cast<DWORD>(std::min<size_t>(length, 0x40000000));
+            DWORD written = 0;
+            if (!WriteFile(file_, data, chunk, &written, nullptr)) {
+                error = "write " + path_ + ": error " + std::to_string(GetLastError());
+                return false;
+            }
+            data += written;
+            length -= written;
+        }
+        return true;
+    }
+
+    bool Commit(const std::string& target, bool durable, std::string& error) {
+        if (durable && !FlushFileBuffers(file_)) {
+            error = "flush " + path_ + ": error " + std::to_string(GetLastError());
+            return false;
+        }
+        CloseHandle(file_);
+        file_ = INVALID_HANDLE_VALUE;
+        DWORD flags = MOVEFILE_REPLACE_EXISTING | (durable ? MOVEFILE_WRITE_THROUGH : 0);
+        if (!MoveFileExW(Utf8ToWide(path_).c_str(), Utf8ToWide(target).c_str(), flags)) {
+            error = "rename " + path_ + " -> " + target + ": error " +
+                    std::to_string(GetLastError());
+            return false;
+        }
+        path_.clear();
+        return true;
+    }
+
+    void Discard() {
+        if (file_ != INVALID_HANDLE_VALUE) {
+            CloseHandle(file_);
+            file_ = INVALID_HANDLE_VALUE;
+        }
+        if (!path_.empty()) {
+            DeleteFileW(Utf8ToWide(path_).c_str());
+            path_.clear();
+        }
+    }
+
+private:
+    static constexpr const char* SEPARATORS = "/\\";
+
+    bool Open(const std::string&, std::string& error) {
+        file_ = CreateFileW(Utf8ToWide(path_).c_str(), GENERIC_WRITE, 0, nullptr, CREATE_NEW,
+                            FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file_ != INVALID_HANDLE_VALUE) return true;
+        DWORD code = GetLastError();
+        exists_ = code == ERROR_FILE_EXISTS;
+        error = "create " + path_ + ": error " + std::to_string(code);
+        path_.clear();
+        return false;
+    }
+
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+#else
+    bool Write(const uint8_t* data, size_t length, std::string& error) {
+        while (length > 0) {
+            ssize_t n = write(fd_, data, std::min<size_t>(length, 1u << 30));
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                error = "write " + path_ + ": " + std::strerror(errno);
+                return false;
+            }
+            data += n;
+            length -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    bool Commit(const std::string& target, bool durable, std::string& error) {
+        if (durable && fsync(fd_) != 0) {
+            error = "fsync " + path_ + ": " + std::strerror(errno);
+            return false;
+        }
+        close(fd_);
+        fd_ = -1;
+        if (rename(path_.c_str(), target.c_str()) != 0) {
+            error = "rename " + path_ + " -> " + target + ": " + std::strerror(errno);
+            return false;
+        }
+        path_.clear();
+        if (durable) {
+            // Persist the rename itself.
+            size_t slash = target.find_last_of('/');
+            std::string dir = slash == std::string::npos ? "." : target.substr(0, slash + 1);
+            int dirFd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            if (dirFd >= 0) {
+                fsync(dirFd);
+                close(dirFd);
+            }
+        }
+        return true;
+    }
+
+    void Discard() {
+        if (fd_ >= 0) {
+            close(fd_);
+            fd_ = -1;
+        }
+        if (!path_.empty()) {
+            unlink(path_.c_str());
+            path_.clear();
+        }
+    }
+
+private:
+    static constexpr const char* SEPARATORS = "/";
+
+    bool Open(const std::string& target, std::string& error) {
+        fd_ = open(path_.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+        if (fd_ < 0) {
+            exists_ = errno == EEXIST;
+            error = "create " + path_ + ": " + std::strerror(errno);
+            path_.clear();
+            return false;
+        }
+        // Replacing a file keeps its permission bits; a new one gets 0666 & ~umask.
+        struct stat st;
+        if (stat(target.c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+            fchmod(fd_, st.st_mode & 07777);
+        }
+        return true;
+    }
+
+    int fd_ = -1;
+#endif
+
+    std::string path_;
+    bool exists_ = false;
+};
+
+std::string BaseName(const std::string& path) {
+#ifdef _WIN32
+    size_t slash = path.find_last_of("/\\");
+#else
+    size_t slash = path.find_last_of('/');
+#endif
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+// ============================================================================
+// Async Worker
+// ============================================================================
+
+class WriteFileScannedWorker : public Napi::AsyncWorker {
+public:
+    WriteFileScannedWorker(Napi::Env env, std::string path, Napi::Value content,
+                           ScanEngine engine, std::vector<ScanSignature> signatures,
+                           ScannedWriteOptions options, CancelBinding cancel, WorkContext work)
+        : Napi::AsyncWorker(env),
+          deferred_(Napi::Promise::Deferred::New(env)),
+          path_(std::move(path)),
+          engine_(engine),
+          signatures_(std::move(signatures)),
+          options_(std::move(options)),
+          cancel_(std::move(cancel)),
+          work_(work) {
+        if (content.IsBuffer()) {
+            // Held so the bytes stay put while the worker reads them.
+            auto bytes = content.As<Napi::Buffer<uint8_t>>();
+            data_ = bytes.Data();
+            length_ = bytes.Length();
+            buffer_ = Napi::Persistent(content.As<Napi::Object>());
+        } else {
+            text_ = content.As<Napi::String>().Utf8Value();
+            data_ = reinterpret_cast<const uint8_t*>(text_.data());
+            length_ = text_.size();
+        }
+        options_.cancel = cancel_.Token();
+    }
+
+    Napi::Promise Promise() const { return deferred_.Promise(); }
+
+    void Execute() override {
+        WorkScope scope(work_);
+        std::string error;
+        std::unique_ptr<ScanProvider> provider = CreateScanProvider(engine_, signatures_, error);
+        if (!provider) {
+            SetError(error);
+            return;
+        }
+        engineName_ = provider->Name();
+        if (!WriteScannedFile(path_, data_, length_, *provider, options_, result_, error)) {
+            SetError(error);
+        }
+    }
+
+    void OnOK() override {
+        cancel_.Finish();
+        Napi::Env env = Env();
+        Napi::Object out = Napi::Object::New(env);
+        out.Set("written", Napi::Boolean::New(env, result_.written));
+        out.Set("clean", Napi::Boolean::New(env, result_.verdict.clean));
+        out.Set("result", Napi::Number::New(env, result_.verdict.result));
+        out.Set("description", Napi::String::New(env, result_.verdict.description));
+        out.Set("engine", Napi::String::New(env, engineName_));
+        out.Set("hash", result_.written ? Napi::String::New(env, result_.hash.ToHex())
+                                        : env.Null());
+        out.Set("bytes", Napi::Number::New(env, static_cast<double>(length_)));
+        out.Set("bytesWritten", Napi::Number::New(env, static_cast<double>(result_.bytesWritten)));
+        out.Set("durationMs", Napi::Number::New(env, result_.durationMs));
+        deferred_.Resolve(out);
+    }
+
+    void OnError(const Napi::Error& error) override {
+        cancel_.Finish();
+        deferred_.Reject(cancel_.Stopped() ? cancel_.StoppedError(Env()) : error.Value());
+    }
+
+private:
+    Napi::Promise::Deferred deferred_;
+    std::string path_;
+    Napi::ObjectReference buffer_;
+    std::string text_;
+    const uint8_t* data_ = nullptr;
+    size_t length_ = 0;
+    ScanEngine engine_;
+    std::vector<ScanSignature> signatures_;
+    ScannedWriteOptions options_;
+    CancelBinding cancel_;
+    WorkContext work_;
+    std::string engineName_;
+    ScannedWriteResult result_;
+};
+
+Napi::Value RejectedPromise(Napi::Env env, const std::string& message) {
+    auto deferred = Napi::Promise::Deferred::New(env);
+    deferred.Reject(Napi::TypeError::New(env, message).Value());
+    return deferred.Promise();
+}
+
+} // namespace
+
+// ============================================================================
+// Core API
+// ============================================================================
+
+bool WriteScannedFile(const std::string& path, const uint8_t* data, size_t length,
+                      ScanProvider& provider, const ScannedWriteOptions& options,
+                      ScannedWriteResult& result, std::string& error) {
+    auto start = std::chrono::steady_clock::now();
+    result = ScannedWriteResult();
+    auto finish = [&](bool ok) {
+        result.durationMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+        return ok;
+    };
+
+    const std::string contentName =
+        options.contentName.empty() ? BaseName(path) : options.contentName;
+
+    // Small payloads: scan first, so a detection never reaches the disk.
+    const bool concurrent = length >= CONCURRENT_SCAN_MIN;
+    if (!concurrent) {
+        if (!provider.Scan(data, length, contentName, result.verdict, error)) return finish(false);
+        if (!result.verdict.clean) return finish(true);
+    }
+
+    TempFile temp;
+    if (!temp.Create(path, error)) return finish(false);
+
+    // Large payloads: the pool scans while this thread writes and hashes.
+    // The scan only reads `data`, which the caller keeps alive until Wait().
+    std::atomic<bool> detected{false};
+    bool scanned = true;
+    std::string scanError;
+    WaitGroup group(WorkerPool::Shared());
+    if (concurrent) {
+        group.Run([&] {
+            scanned = provider.Scan(data, length, contentName, result.verdict, scanError);
+            if (!scanned || !result.verdict.clean) detected.store(true, std::memory_order_release);
+        });
+    }
+
+    Blake3Hasher hasher;
+    bool wrote = true;
+    for (size_t offset = 0; offset < length; offset += WRITE_CHUNK) {
+        if (detected.load(std::memory_order_acquire) || IsStopped(options.cancel)) break;
+        size_t chunk = std::min(WRITE_CHUNK, length - offset);
+        hasher.Update(data + offset, chunk);
+        if (!temp.Write(data + offset, chunk, error)) {
+            wrote = false;
+            break;
+        }
+        result.bytesWritten += chunk;
+    }
+    group.Wait();
+
+    if (!scanned) {
+        error = scanError;
+        return finish(false);
+    }
+    if (!wrote) return finish(false);
+    if (IsStopped(options.cancel)) {
+        error = CancelReasonMessage(options.cancel->Outcome());
+        return finish(false);
+    }
+    if (!result.verdict.clean) return finish(true);
+
+    result.hash = hasher.Finalize();
+    if (!temp.Commit(path, options.durable, error)) return finish(false);
+    result.written = true;
+    return finish(true);
+}
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+Napi::Value WriteFileScanned(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsString() ||
+        !(info[1].IsBuffer() || info[1].IsString())) {
+        return RejectedPromise(env, "writeFileScanned expects a path and a Buffer or string");
+    }
+    std::string path = info[0].As<Napi::String>().Utf8Value();
+    if (path.empty()) {
+        return RejectedPromise(env, "writeFileScanned expects a path and a Buffer or string");
+    }
+
+    Napi::Value opts = info.Length() > 2 ? info[2] : env.Undefined();
+    if (!opts.IsUndefined() && !opts.IsObject()) {
+        return RejectedPromise(env, "options must be an object");
+    }
+
+    ScannedWriteOptions options;
+    ScanEngine engine = ScanEngine::Auto;
+    std::vector<ScanSignature> signatures;
+    std::string error;
+    if (opts.IsObject()) {
+        Napi::Object o = opts.As<Napi::Object>();
+        if (!ReadScanEngineOptions(o, engine, signatures, error)) {
+            return RejectedPromise(env, error);
+        }
+
+        Napi::Value name = o.Get("contentName");
+        if (name.IsString()) {
+            options.contentName = name.As<Napi::String>().Utf8Value();
+        } else if (!name.IsUndefined()) {
+            return RejectedPromise(env, "contentName must be a string");
+        }
+
+        Napi::Value durable = o.Get("durable");
+        if (durable.IsBoolean()) {
+            options.durable = durable.As<Napi::Boolean>().Value();
+        } else if (!durable.IsUndefined()) {
+            return RejectedPromise(env, "durable must be a boolean");
+        }
+    }
+
+    // Someone is waiting on the write.
+    WorkContext work;
+    if (!ReadWorkContext(opts, WorkPriority::Interactive, work, error)) {
+        return RejectedPromise(env, error);
+    }
+
+    CancelBinding cancel(CancellableOperation::WriteFileScanned);
+    if (!cancel.Attach(opts, error)) {
+        return RejectedPromise(env, error);
+    }
+
+    auto* worker = new WriteFileScannedWorker(env, path, info[1], engine, std::move(signatures),
+                                              std::move(options), std::move(cancel), work);
+    Napi::Promise promise = worker->Promise();
+    worker->Queue();
+    return promise;
+}
+
+} // namespace TerminAI
@@ -0,0 +1,107 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Scanned Write Header
+ *
+ * Writes a payload to disk only if a ScanProvider finds it clean, in one
+ * pass over the data instead of write, read back, scan.
+ *
+ * The payload is written in chunks to a temporary file created next to the
+ * target (so the final rename never crosses a filesystem) and BLAKE3-hashed
+ * chunk by chunk as it goes. Large payloads are scanned on the shared
+ * WorkerPool at the same time, and a detection stops the write early; small
+ * ones are scanned first, so a detection never reaches the disk. A clean
+ * payload is then renamed over the target, which readers see change
+ * atomically from the old content to the new; anything else (a detection,
+ * a scan or I/O failure, cancellation) deletes the temporary file and
+ * leaves the target untouched.
+ *
+ * A symlink at the target path is replaced, not written through. An
+ * existing target's permission bits are kept.
+ */
+
+#pragma once
+
+#include <napi.h>
+#include "blake3.h"
+#include "cancellation.h"
+#include "scan_provider.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace TerminAI {
+
+// ============================================================================
+// Types
+// ============================================================================
+
+struct ScannedWriteOptions {
+    /** Content name shown to the engine (default: the target's file name) */
+    std::string contentName;
+    /** fsync the file before the rename and the directory after it */
+    bool durable = false;
+    /** Checked per chunk (null = never stops) */
+    CancelToken* cancel = nullptr;
+};
+
+struct ScannedWriteResult {
+    /** The target now holds the payload */
+    bool written = false;
+    ScanVerdict verdict;
+    /** BLAKE3 of the payload (set when it was written) */
+    Blake3Digest hash;
+    /** Bytes that reached the temporary file (less than the payload when a
+     *  detection stopped the write early) */
+    uint64_t bytesWritten = 0;
+    double durationMs = 0;
+};
+
+// ============================================================================
+// Core API
+// ============================================================================
+
+/**
+ * Scan `data` and, if clean, atomically replace `path` with it.
+ *
+ * @return true with result.written == false when the payload was not clean;
+ *         false with a message on I/O or scan failure, or when stopped on
+ *         options.cancel (the target is untouched in every false case)
+ */
+bool WriteScannedFile(const std::string& path, const uint8_t* data, size_t length,
+                      ScanProvider& provider, const ScannedWriteOptions& options,
+                      ScannedWriteResult& result, std::string& error);
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+/**
+ * Write a file only if its content scans clean.
+ *
+ * Arguments:
+ *   0: String - Target path (its directory must exist)
+ *   1: Buffer | String - Content (strings are written as UTF-8)
+ *   2: Object (optional)
+ *      - engine, signatures: see ScanArchive (default engine 'auto')
+ *      - contentName: String - name shown to the engine
+ *      - durable: Boolean - fsync before reporting success (default false)
+ *      - priority, sessionId: scheduling (default priority 'interactive')
+ *      - timeoutMs, signal: see cancellation.h
+ *
+ * Returns: Promise<Object>
+ *   - written: Boolean - false when the content was not clean
+ *   - clean, result, description: the verdict (see ScanVerdict)
+ *   - engine: 'amsi' | 'portable'
+ *   - hash: String | null - BLAKE3 hex digest when written
+ *   - bytes: Number - payload size
+ *   - bytesWritten: Number - bytes that reached disk before the verdict
+ *   - durationMs: Number
+ */
+Napi::Value WriteFileScanned(const Napi::CallbackInfo& info);
+
+} // namespace TerminAI
@@ -0,0 +1,1033 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Script Normalizer Implementation
+ *
+ * The tokenizers are deliberately shallow: they know quoting, escapes and
+ * where commands end, which is all the obfuscations above rely on, and
+ * copy everything else through. Whatever they cannot make sense of is left
+ * as written, so the worst a malformed script does is normalize less.
+ */
+
+#include "script_normalizer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+namespace TerminAI {
+
+namespace {
+
+/** How much of the input decides binary vs text and the language */
+constexpr size_t kSniffBytes = 4096;
+/** Shortest base64 text taken for a payload */
+constexpr size_t kMinPayloadChars = 8;
+/** Quotes and substitutions nested deeper are copied through */
+constexpr int kMaxNesting = 32;
+
+struct NormalizerCounters {
+    std::atomic<uint64_t> scripts{0};
+    std::atomic<uint64_t> bytesIn{0};
+    std::atomic<uint64_t> bytesOut{0};
+    std::atomic<uint64_t> layers{0};
+    std::atomic<uint64_t> decoded{0};
+    std::atomic<uint64_t> concatenations{0};
+    std::atomic<uint64_t> escapes{0};
+    std::atomic<uint64_t> limited{0};
+    std::atomic<uint64_t> bufferGrowths{0};
+};
+
+NormalizerCounters g_counters;
+
+char Lower(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+bool EqualsIgnoreCase(const char* text, size_t length, const char* literal) {
+    size_t n = std::strlen(literal);
+    if (length != n) return false;
+    for (size_t i = 0; i < n; i++) {
+        if (Lower(text[i]) != literal[i]) return false;
+    }
+    return true;
+}
+
+bool ContainsIgnoreCase(const char* text, size_t length, const char* literal) {
+    size_t n = std::strlen(literal);
+    if (n > length) return false;
+    for (size_t i = 0; i + n <= length; i++) {
+        if (Lower(text[i]) != literal[0]) continue;
+        size_t j = 1;
+        while (j < n && Lower(text[i + j]) == literal[j]) j++;
+        if (j == n) return true;
+    }
+    return false;
+}
+
+bool IsSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' || c == '\v';
+}
+
+/** The part of a command word after its last '/' or '\' */
+void Basename(const char*& text, size_t& length) {
+    for (size_t i = length; i > 0; i--) {
+        if (text[i - 1] == '/' || text[i - 1] == '\\') {
+            text += i;
+            length -= i;
+            return;
+        }
+    }
+}
+
+/** -EncodedCommand and every prefix PowerShell accepts for it (-e, -en, ...), and -ec */
+bool IsEncodedCommandSwitch(const char* text, size_t length) {
+    static const char kSwitch[] = "-encodedcommand";
+    if (length < 2 || (text[0] != '-' && text[0] != '/')) return false;
+    if (EqualsIgnoreCase(text + 1, length - 1, "ec")) return true;
+    if (length > sizeof(kSwitch) - 1) return false;
+    for (size_t i = 1; i < length; i++) {
+        if (Lower(text[i]) != kSwitch[i]) return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// Decoding
+// ============================================================================
+
+int Base64Value(char c) {
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '+' || c == '-') return 62;
+    if (c == '/' || c == '_') return 63;
+    return -1;
+}
+
+/**
+ * Append the decoded bytes to `out`. Whitespace is skipped and padding is
+ * optional; anything else outside the alphabet (standard or URL-safe)
+ * means it is not base64.
+ */
+bool Base64Decode(const char* text, size_t length, std::string& out) {
+    uint32_t bits = 0;
+    int count = 0;
+    size_t chars = 0;
+    size_t i = 0;
+    for (; i < length; i++) {
+        char c = text[i];
+        if (IsSpace(c)) continue;
+        if (c == '=') break;
+        int value = Base64Value(c);
+        if (value < 0) return false;
+        bits = (bits << 6) | static_cast<uint32_t>(value);
+        chars++;
+        if (++count == 4) {
+            out.push_back(static_cast<char>(bits >> 16));
+            out.push_back(static_cast<char>(bits >> 8));
+            out.push_back(static_cast<char>(bits));
+            bits = 0;
+            count = 0;
+        }
+    }
+    for (; i < length; i++) {
+        if (text[i] != '=' && !IsSpace(text[i])) return false;
+    }
+    if (chars < kMinPayloadChars || count == 1) return false;
+    if (count == 2) out.push_back(static_cast<char>(bits >> 4));
+    if (count == 3) {
+        out.push_back(static_cast<char>(bits >> 10));
+        out.push_back(static_cast<char>(bits >> 2));
+    }
+    return true;
+}
+
+/** Even length, and nearly every high byte zero: ASCII-range UTF-16LE */
+bool LooksLikeUtf16Le(const std::string& bytes) {
+    if (bytes.size() < 2 || bytes.size() % 2 != 0) return false;
+    size_t units = bytes.size() / 2;
+    size_t zeroHigh = 0;
+    for (size_t i = 1; i < bytes.size(); i += 2) {
+        if (bytes[i] == 0) zeroHigh++;
+    }
+    return zeroHigh * 10 >= units * 9;
+}
+
+void AppendUtf8(uint32_t cp, std::string& out) {
+    if (cp < 0x80) {
+        out.push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+}
+
+/** Unpaired surrogates become U+FFFD; a leading BOM is dropped. */
+void Utf16LeToUtf8(const std::string& bytes, std::string& out) {
+    size_t units = bytes.size() / 2;
+    auto unit = [&bytes](size_t i) {
+        return static_cast<uint32_t>(static_cast<uint8_t>(bytes[2 * i])) |
+               static_cast<uint32_t>(static_cast<uint8_t>(bytes[2 * i + 1])) << 8;
+    };
+    for (size_t i = 0; i < units; i++) {
+        uint32_t cp = unit(i);
+        if (i == 0 && cp == 0xFEFF) continue;
+        if (cp >= 0xD800 && cp <= 0xDBFF && i + 1 < units) {
+            uint32_t low = unit(i + 1);
+            if (low >= 0xDC00 && low <= 0xDFFF) {
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                i++;
+            } else {
+                cp = 0xFFFD;
+            }
+        } else if (cp >= 0xD800 && cp <= 0xDFFF) {
+            cp = 0xFFFD;
+        }
+        AppendUtf8(cp, out);
+    }
+}
+
+/** No NUL bytes and hardly any other control bytes */
+bool IsText(const uint8_t* data, size_t length) {
+    size_t control = 0;
+    for (size_t i = 0; i < length; i++) {
+        uint8_t byte = data[i];
+        if (byte == 0) return false;
+        if ((byte < 0x20 && !IsSpace(static_cast<char>(byte)) && byte != 0x1b) || byte == 0x7f) {
+            control++;
+        }
+    }
+    return length > 0 && control * 32 <= length;
+}
+
+const char* const POWERSHELL_MARKERS[] = {
+    "$env:", "-encodedcommand", "[convert]::", "write-host", "write-output", "invoke-",
+    "get-", "new-object", "param(", "$psversiontable", "-join", "iex", "powershell", "pwsh",
+    "frombase64string", "$null", "foreach-object", "[system.", "-eq ",
+};
+
+const char* const SHELL_MARKERS[] = {
+    "#!/", "${", "\nfi", "; then", "; do", "done", "esac", "&&", "export ", "echo ",
+    "| base64", "2>&1", "/dev/null", "sudo ", "chmod ", "$((", "[ -",
+};
+
+/** More distinct PowerShell markers than shell ones in the first 4 KiB */
+ScriptLanguage DetectLanguage(const uint8_t* data, size_t length) {
+    const char* text = reinterpret_cast<const char*>(data);
+    size_t n = std::min(length, kSniffBytes);
+    if (n >= 2 && text[0] == '#' && text[1] == '!' && !ContainsIgnoreCase(text, n, "pwsh")) {
+        return ScriptLanguage::Shell;
+    }
+    int powershell = 0;
+    int shell = 0;
+    for (const char* marker : POWERSHELL_MARKERS) powershell += ContainsIgnoreCase(text, n, marker);
+    for (const char* marker : SHELL_MARKERS) shell += ContainsIgnoreCase(text, n, marker);
+    return powershell > shell ? ScriptLanguage::PowerShell : ScriptLanguage::Shell;
+}
+
+/** Whether `text` ends with `FromBase64String(`, ignoring whitespace and case */
+bool EndsWithFromBase64(const char* text, size_t length) {
+    static const char kCall[] = "frombase64string";
+    size_t end = length;
+    while (end > 0 && IsSpace(text[end - 1])) end--;
+    if (end == 0 || text[end - 1] != '(') return false;
+    end--;
+    while (end > 0 && IsSpace(text[end - 1])) end--;
+    size_t n = sizeof(kCall) - 1;
+    return end >= n && EqualsIgnoreCase(text + end - n, n, kCall);
+}
+
+void AppendEscapedCodePoint(uint32_t cp, std::string& out) {
+    AppendUtf8(cp > 0x10FFFF ? 0xFFFD : cp, out);
+}
+
+int HexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+} // namespace
+
+// ============================================================================
+// Names
+// ============================================================================
+
+bool ParseScriptLanguage(const std::string& name, ScriptLanguage& language) {
+    if (name == "auto") {
+        language = ScriptLanguage::Auto;
+    } else if (name == "powershell") {
+        language = ScriptLanguage::PowerShell;
+    } else if (name == "shell") {
+        language = ScriptLanguage::Shell;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* ScriptLanguageName(ScriptLanguage language) {
+    switch (language) {
+        case ScriptLanguage::Auto: return "auto";
+        case ScriptLanguage::PowerShell: return "powershell";
+        case ScriptLanguage::Shell: return "shell";
+        case ScriptLanguage::Binary: return "binary";
+    }
+    return "auto";
+}
+
+const char* SpanKindName(SpanKind kind) {
+    switch (kind) {
+        case SpanKind::Source: return "source";
+        case SpanKind::Normalized: return "normalized";
+        case SpanKind::Decoded: return "decoded";
+    }
+    return "source";
+}
+
+// ============================================================================
+// Normalizer
+// ============================================================================
+
+bool ScriptNormalizer::QueuePayload(const char* text, size_t length, ScriptLanguage language,
+                                    Utf16 utf16) {
+    decoded_.clear();
+    if (!Base64Decode(text, length, decoded_) || decoded_.size() < 4) return false;
+    bool wide = utf16 != Utf16::Never && LooksLikeUtf16Le(decoded_);
+    if (utf16 == Utf16::Require && !wide) return false;
+
+    size_t start = payloads_.size();
+    if (wide) {
+        Utf16LeToUtf8(decoded_, payloads_);
+    } else {
+        payloads_.append(decoded_);
+    }
+    const uint8_t* payload = reinterpret_cast<const uint8_t*>(payloads_.data()) + start;
+    size_t size = payloads_.size() - start;
+    if (!IsText(payload, size)) {
+        language = ScriptLanguage::Binary;
+    } else if (language == ScriptLanguage::Auto) {
+        language = DetectLanguage(payload, size);
+    }
+    payloadRefs_.push_back({start, size, language, 0});
+    return true;
+}
+
+bool ScriptNormalizer::NormalizePowerShell(const uint8_t* data, size_t length) {
+    const char* s = reinterpret_cast<const char*>(data);
+    size_t n = length;
+    bool changed = false;
+    // The previous token was -EncodedCommand (or a prefix of it).
+    bool encodedNext = false;
+
+    auto copyUntil = [&](size_t& i, const char* terminator) {
+        const char* found = std::search(s + i, s + n, terminator, terminator + std::strlen(terminator));
+        size_t end = found == s + n ? n : static_cast<size_t>(found - s) + std::strlen(terminator);
+        layer_.append(s + i, end - i);
+        i = end;
+    };
+
+    size_t i = 0;
+    while (i < n) {
+        char c = s[i];
+        bool tokenStart = i == 0 || IsSpace(s[i - 1]) || std::strchr("(){};,|=", s[i - 1]);
+
+        if (c == '#' && tokenStart) {
+            size_t end = i;
+            while (end < n && s[end] != '\n') end++;
+            layer_.append(s + i, end - i);
+            i = end;
+            continue;
+        }
+        if (c == '<' && i + 1 < n && s[i + 1] == '#') {
+            copyUntil(i, "#>");
+            continue;
+        }
+        if (c == '@' && i + 2 < n && (s[i + 1] == '\'' || s[i + 1] == '"') &&
+            (s[i + 2] == '\n' || s[i + 2] == '\r')) {
+            // Here-strings are taken as written.
+            copyUntil(i, s[i + 1] == '\'' ? "\n'@" : "\n\"@");
+            encodedNext = false;
+            continue;
+        }
+
+        if (c == '\'' || c == '"') {
+            // A literal, and any literals '+'-ed onto it.
+            literal_.clear();
+            size_t start = i;
+            size_t parts = 0;
+            bool escaped = false;
+            for (;;) {
+                char quote = s[i++];
+                while (i < n) {
+                    char ch = s[i];
+                    if (ch == quote) {
+                        if (i + 1 < n && s[i + 1] == quote) {
+                            literal_.push_back(quote);
+                            i += 2;
+                            continue;
+                        }
+                        i++;
+                        break;
+                    }
+                    if (quote == '"' && ch == '`' && i + 1 < n) {
+                        char e = s[i + 1];
+                        switch (e) {
+                            case '0': e = '\0'; break;
+                            case 'a': e = '\a'; break;
+                            case 'b': e = '\b'; break;
+                            case 'e': e = '\x1b'; break;
+                            case 'f': e = '\f'; break;
+                            case 'n': e = '\n'; break;
+                            case 'r': e = '\r'; break;
+                            case 't': e = '\t'; break;
+                            case 'v': e = '\v'; break;
+                            default: break;
+                        }
+                        literal_.push_back(e);
+                        i += 2;
+                        escaped = true;
+                        stats_.escapes++;
+                        continue;
+                    }
+                    literal_.push_back(ch);
+                    i++;
+                }
+                parts++;
+
+                size_t j = i;
+                while (j < n && (s[j] == ' ' || s[j] == '\t')) j++;
+                if (j >= n || s[j] != '+') break;
+                size_t k = j + 1;
+                while (k < n && IsSpace(s[k])) k++;
+                if (k >= n || (s[k] != '\'' && s[k] != '"')) break;
+                i = k;
+            }
+
+            size_t emitted = layer_.size();
+            if (parts == 1 && !escaped) {
+                layer_.append(s + start, i - start);
+            } else {
+                changed = true;
+                stats_.concatenations += parts - 1;
+                layer_.push_back('\'');
+                for (char ch : literal_) {
+                    if (ch == '\'') layer_.push_back('\'');
+                    layer_.push_back(ch);
+                }
+                layer_.push_back('\'');
+            }
+
+            if (encodedNext) {
+                QueuePayload(literal_.data(), literal_.size(), ScriptLanguage::PowerShell,
+                             Utf16::Require);
+            } else if (EndsWithFromBase64(layer_.data(), emitted)) {
+                QueuePayload(literal_.data(), literal_.size(), ScriptLanguage::Auto,
+                             Utf16::Detect);
+            }
+            encodedNext = false;
+            continue;
+        }
+
+        if (c == '`') {
+            // Outside strings a backtick makes the next character literal;
+            // before a line break it continues the line.
+            changed = true;
+            stats_.escapes++;
+            if (i + 1 < n && s[i + 1] == '\n') {
+                i += 2;
+            } else if (i + 2 < n && s[i + 1] == '\r' && s[i + 2] == '\n') {
+                i += 3;
+            } else {
+                if (i + 1 < n) layer_.push_back(s[i + 1]);
+                i += 2;
+            }
+            continue;
+        }
+
+        if (IsSpace(c)) {
+            layer_.push_back(c);
+            i++;
+            continue;
+        }
+        if (std::strchr("(){};,|", c)) {
+            layer_.push_back(c);
+            i++;
+            encodedNext = false;
+            continue;
+        }
+
+        // A bareword, with its backtick escapes undone.
+        size_t token = layer_.size();
+        while (i < n) {
+            char ch = s[i];
+            if (ch == '`' && i + 1 < n && s[i + 1] != '\n' && s[i + 1] != '\r') {
+                layer_.push_back(s[i + 1]);
+                i += 2;
+                changed = true;
+                stats_.escapes++;
+                continue;
+            }
+            if (IsSpace(ch) || ch == '`' || std::strchr("(){};,|'\"", ch)) break;
+            layer_.push_back(ch);
+            i++;
+        }
+        const char* word = layer_.data() + token;
+        size_t size = layer_.size() - token;
+        if (encodedNext) {
+            encodedNext = false;
+            QueuePayload(word, size, ScriptLanguage::PowerShell, Utf16::Require);
+        } else {
+            encodedNext = IsEncodedCommandSwitch(word, size);
+        }
+    }
+    return changed;
+}
+
+void ScriptNormalizer::EndShellCommand(bool pipe) {
+    if (words_.empty()) {
+        // `echo ... |` then a line break: still the same pipeline.
+        pipedIn_ = pipedIn_ || pipe;
+        return;
+    }
+    auto value = [this](const Word& word) { return layer_.data() + word.offset; };
+
+    const char* name = value(words_[0]);
+    size_t nameLength = words_[0].length;
+    Basename(name, nameLength);
+
+    if (EqualsIgnoreCase(name, nameLength, "base64")) {
+        bool decode = false;
+        for (size_t i = 1; i < words_.size(); i++) {
+            const char* flag = value(words_[i]);
+            size_t length = words_[i].length;
+            if (EqualsIgnoreCase(flag, length, "--decode") ||
+                (length >= 2 && length <= 3 && flag[0] == '-' && flag[1] != '-' &&
+                 std::memchr(flag, 'd', length) != nullptr) ||
+                (length == 2 && flag[0] == '-' && flag[1] == 'D')) {
+                decode = true;
+            }
+        }
+        if (decode) {
+            for (const Word& word : words_) {
+                if (word.hereString) {
+                    QueuePayload(value(word), word.length, ScriptLanguage::Auto, Utf16::Detect);
+                }
+            }
+            if (pipedIn_ && !previousWords_.empty()) {
+                const char* source = layer_.data() + previousWords_[0].offset;
+                size_t sourceLength = previousWords_[0].length;
+                Basename(source, sourceLength);
+                if (EqualsIgnoreCase(source, sourceLength, "echo") ||
+                    EqualsIgnoreCase(source, sourceLength, "printf")) {
+                    for (size_t i = 1; i < previousWords_.size(); i++) {
+                        const Word& word = previousWords_[i];
+                        if (word.length > 0 && layer_[word.offset] == '-') continue;
+                        QueuePayload(value(word), word.length, ScriptLanguage::Auto,
+                                     Utf16::Detect);
+                    }
+                }
+            }
+        }
+    } else if (EqualsIgnoreCase(name, nameLength, "powershell") ||
+               EqualsIgnoreCase(name, nameLength, "powershell.exe") ||
+               EqualsIgnoreCase(name, nameLength, "pwsh") ||
+               EqualsIgnoreCase(name, nameLength, "pwsh.exe")) {
+        for (size_t i = 1; i + 1 < words_.size(); i++) {
+            if (IsEncodedCommandSwitch(value(words_[i]), words_[i].length)) {
+                const Word& payload = words_[i + 1];
+                QueuePayload(value(payload), payload.length, ScriptLanguage::PowerShell,
+                             Utf16::Require);
+            }
+        }
+    }
+
+    previousWords_.swap(words_);
+    words_.clear();
+    pipedIn_ = pipe;
+}
+
+bool ScriptNormalizer::NormalizeShell(const uint8_t* data, size_t length) {
+    const char* s = reinterpret_cast<const char*>(data);
+    size_t n = length;
+    bool changed = false;
+
+    enum Mode : uint8_t { Plain, Quoted, Substitution };
+    Mode modes[kMaxNesting];
+    int top = 0;
+    modes[0] = Plain;
+
+    words_.clear();
+    previousWords_.clear();
+    pipedIn_ = false;
+
+    bool inWord = false;
+    bool hereNext = false;
+    bool wordHere = false;
+    bool plainRun = false;
+    size_t wordStart = 0;
+    size_t fragments = 0;
+
+    auto beginWord = [&]() {
+        if (inWord) return;
+        inWord = true;
+        wordStart = layer_.size();
+        wordHere = hereNext;
+        hereNext = false;
+        plainRun = false;
+        fragments = 0;
+    };
+    auto quotedFragment = [&]() {
+        beginWord();
+        fragments++;
+        plainRun = false;
+    };
+    auto endWord = [&]() {
+        if (!inWord) return;
+        inWord = false;
+        words_.push_back({wordStart, layer_.size() - wordStart, wordHere});
+        if (fragments > 1) {
+            // c'u'"r"l: the quotes only split the word up.
+            changed = true;
+            stats_.concatenations += fragments - 1;
+        }
+    };
+    auto separator = [&](bool pipe) {
+        endWord();
+        EndShellCommand(pipe);
+    };
+    auto opensSubstitution = [&](size_t i) {
+        return s[i] == '$' && i + 1 < n && s[i + 1] == '(' && !(i + 2 < n && s[i + 2] == '(') &&
+               top + 1 < kMaxNesting;
+    };
+
+    size_t i = 0;
+    while (i < n) {
+        char c = s[i];
+
+        if (modes[top] == Quoted) {
+            if (c == '"') {
+                top--;
+                i++;
+                continue;
+            }
+            if (c == '\\' && i + 1 < n && std::strchr("$`\"\\\n", s[i + 1])) {
+                if (s[i + 1] != '\n') layer_.push_back(s[i + 1]);
+                i += 2;
+                changed = true;
+                stats_.escapes++;
+                continue;
+            }
+            if (opensSubstitution(i)) {
+                separator(false);
+                layer_.append("$(");
+                modes[++top] = Substitution;
+                i += 2;
+                continue;
+            }
+            layer_.push_back(c);
+            i++;
+            continue;
+        }
+
+        switch (c) {
+            case ' ':
+            case '\t':
+            case '\r':
+                endWord();
+                layer_.push_back(c);
+                i++;
+                continue;
+            case '\n':
+            case ';':
+            case '&':
+            case '(':
+            case '`':
+                separator(false);
+                layer_.push_back(c);
+                i++;
+                continue;
+            case ')':
+                separator(false);
+                layer_.push_back(c);
+                i++;
+                if (modes[top] == Substitution) top--;
+                continue;
+            case '|': {
+                bool pipe = !(i + 1 < n && s[i + 1] == '|');
+                separator(pipe);
+                size_t width = pipe ? 1 : 2;
+                layer_.append(s + i, width);
+                i += width;
+                continue;
+            }
+            case '<':
+                endWord();
+                if (i + 2 < n && s[i + 1] == '<' && s[i + 2] == '<') {
+                    hereNext = true;
+                    layer_.append("<<<");
+                    i += 3;
+                } else {
+                    layer_.push_back(c);
+                    i++;
+                }
+                continue;
+            case '>':
+                endWord();
+                layer_.push_back(c);
+                i++;
+                continue;
+            case '#':
+                if (!inWord) {
+                    size_t end = i;
+                    while (end < n && s[end] != '\n') end++;
+                    layer_.append(s + i, end - i);
+                    i = end;
+                    continue;
+                }
+                break;
+            case '\'':
+                quotedFragment();
+                i++;
+                while (i < n && s[i] != '\'') layer_.push_back(s[i++]);
+                if (i < n) i++;
+                continue;
+            case '"':
+                quotedFragment();
+                if (top + 1 < kMaxNesting) modes[++top] = Quoted;
+                i++;
+                continue;
+            case '\\':
+                if (i + 1 < n && s[i + 1] == '\n') {
+                    // Line continuation
+                    i += 2;
+                    changed = true;
+                    stats_.escapes++;
+                    continue;
+                }
+                if (i + 1 < n) {
+                    beginWord();
+                    layer_.push_back(s[i + 1]);
+                    i += 2;
+                    changed = true;
+                    stats_.escapes++;
+                    continue;
+                }
+                break;
+            case '$':
+                if (i + 1 < n && s[i + 1] == '\'') {
+                    // $'...': C escapes
+                    quotedFragment();
+                    i += 2;
+                    while (i < n && s[i] != '\'') {
+                        if (s[i] != '\\' || i + 1 >= n) {
+                            layer_.push_back(s[i++]);
+                            continue;
+                        }
+                        char e = s[i + 1];
+                        i += 2;
+                        changed = true;
+                        stats_.escapes++;
+                        switch (e) {
+                            case 'n': layer_.push_back('\n'); break;
+                            case 't': layer_.push_back('\t'); break;
+                            case 'r': layer_.push_back('\r'); break;
+                            case 'a': layer_.push_back('\a'); break;
+                            case 'b': layer_.push_back('\b'); break;
+                            case 'e':
+                            case 'E': layer_.push_back('\x1b'); break;
+                            case 'f': layer_.push_back('\f'); break;
+                            case 'v': layer_.push_back('\v'); break;
+                            case 'x':
+                            case 'u':
+                            case 'U': {
+                                size_t digits = e == 'x' ? 2 : e == 'u' ? 4 : 8;
+                                uint32_t cp = 0;
+                                size_t read = 0;
+                                while (read < digits && i < n && HexValue(s[i]) >= 0) {
+                                    cp = cp * 16 + static_cast<uint32_t>(HexValue(s[i++]));
+                                    read++;
+                                }
+                                if (read == 0) {
+                                    layer_.push_back('\\');
+                                    layer_.push_back(e);
+                                } else if (e == 'x') {
+                                    layer_.push_back(static_cast<char>(cp));
+                                } else {
+                                    AppendEscapedCodePoint(cp, layer_);
+                                }
+                                break;
+                            }
+                            default:
+                                if (e >= '0' && e <= '7') {
+                                    uint32_t value = static_cast<uint32_t>(e - '0');
+                                    for (int d = 0; d < 2 && i < n && s[i] >= '0' && s[i] <= '7';
+                                         d++) {
+                                        value = value * 8 + static_cast<uint32_t>(s[i++] - '0');
+                                    }
+                                    layer_.push_back(static_cast<char>(value));
+                                } else if (e == '\\' || e == '\'' || e == '"' || e == '?') {
+                                    layer_.push_back(e);
+                                } else {
+                                    layer_.push_back('\\');
+                                    layer_.push_back(e);
+                                }
+                                break;
+                        }
+                    }
+                    if (i < n) i++;
+                    continue;
+                }
+                if (opensSubstitution(i)) {
+                    separator(false);
+                    layer_.append("$(");
+                    modes[++top] = Substitution;
+                    i += 2;
+                    continue;
+                }
+                break;
+            default:
+                break;
+        }
+
+        beginWord();
+        if (!plainRun) {
+            fragments++;
+            plainRun = true;
+        }
+        layer_.push_back(c);
+        i++;
+    }
+    separator(false);
+    return changed;
+}
+
+const std::vector<ScriptSpan>& ScriptNormalizer::Normalize(const uint8_t* data, size_t length,
+                                                           ScriptLanguage language,
+                                                           const NormalizeLimits& limits) {
+    const size_t capacities[] = {
+        arena_.capacity(),       offsets_.capacity(),      layer_.capacity(),
+        literal_.capacity(),     decoded_.capacity(),      payloads_.capacity(),
+        payloadRefs_.capacity(), queue_.capacity(),        words_.capacity(),
+        previousWords_.capacity(), spans_.capacity(),
+    };
+
+    stats_ = NormalizeStats{};
+    spans_.clear();
+    offsets_.clear();
+    arena_.clear();
+    queue_.clear();
+
+    bool binary = std::memchr(data, 0, std::min(length, kSniffBytes)) != nullptr;
+    if (binary) {
+        language = ScriptLanguage::Binary;
+    } else if (language == ScriptLanguage::Auto) {
+        language = DetectLanguage(data, length);
+    }
+    spans_.push_back({data, length, SpanKind::Source, language, 0});
+    offsets_.push_back(SIZE_MAX);
+    if (!binary) queue_.push_back({SIZE_MAX, length, language, 0});
+
+    auto fits = [&](size_t size) {
+        if (arena_.size() + size <= limits.maxOutputBytes) return true;
+        stats_.limited = true;
+        return false;
+    };
+
+    for (size_t q = 0; q < queue_.size(); q++) {
+        Pending item = queue_[q];
+        const uint8_t* input = item.offset == SIZE_MAX
+                                   ? data
+                                   : reinterpret_cast<const uint8_t*>(arena_.data()) + item.offset;
+        layer_.clear();
+        payloads_.clear();
+        payloadRefs_.clear();
+        bool changed = item.language == ScriptLanguage::PowerShell
+                           ? NormalizePowerShell(input, item.length)
+                           : NormalizeShell(input, item.length);
+
+        // The arena only grows once the layer (which may read it) is done.
+        if (changed && fits(layer_.size())) {
+            offsets_.push_back(arena_.size());
+            spans_.push_back({nullptr, layer_.size(), SpanKind::Normalized, item.language,
+                              item.depth});
+            arena_.append(layer_);
+        }
+        for (const Pending& payload : payloadRefs_) {
+            if (item.depth + 1 > limits.maxDepth) {
+                stats_.limited = true;
+                break;
+            }
+            if (!fits(payload.length)) continue;
+            size_t offset = arena_.size();
+            offsets_.push_back(offset);
+            spans_.push_back({nullptr, payload.length, SpanKind::Decoded, payload.language,
+                              item.depth + 1});
+            arena_.append(payloads_, payload.offset, payload.length);
+            stats_.decoded++;
+            stats_.depth = std::max(stats_.depth, item.depth + 1);
+            if (payload.language != ScriptLanguage::Binary) {
+                queue_.push_back({offset, payload.length, payload.language, item.depth + 1});
+            }
+        }
+    }
+
+    for (size_t i = 1; i < spans_.size(); i++) {
+        spans_[i].data = reinterpret_cast<const uint8_t*>(arena_.data()) + offsets_[i];
+    }
+    stats_.layers = spans_.size() - 1;
+    stats_.arenaBytes = arena_.size();
+
+    const size_t after[] = {
+        arena_.capacity(),       offsets_.capacity(),      layer_.capacity(),
+        literal_.capacity(),     decoded_.capacity(),      payloads_.capacity(),
+        payloadRefs_.capacity(), queue_.capacity(),        words_.capacity(),
+        previousWords_.capacity(), spans_.capacity(),
+    };
+    for (size_t i = 0; i < sizeof(after) / sizeof(after[0]); i++) {
+        if (after[i] > capacities[i]) stats_.bufferGrowths++;
+    }
+
+    g_counters.scripts++;
+    g_counters.bytesIn += length;
+    g_counters.bytesOut += stats_.arenaBytes;
+    g_counters.layers += stats_.layers;
+    g_counters.decoded += stats_.decoded;
+    g_counters.concatenations += stats_.concatenations;
+    g_counters.escapes += stats_.escapes;
+    g_counters.limited += stats_.limited ? 1 : 0;
+    g_counters.bufferGrowths += stats_.bufferGrowths;
+    return spans_;
+}
+
+ScriptNormalizer& ThreadScriptNormalizer() {
+    thread_local ScriptNormalizer normalizer;
+    return normalizer;
+}
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+Napi::Value NormalizeScriptExport(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    auto fail = [&env](const std::string& message) {
+        Napi::TypeError::New(env, message).ThrowAsJavaScriptException();
+        return env.Null();
+    };
+
+    if (info.Length() < 1 || !(info[0].IsString() || info[0].IsBuffer())) {
+        return fail("normalizeScript expects a Buffer or string");
+    }
+
+    ScriptLanguage language = ScriptLanguage::Auto;
+    NormalizeLimits limits;
+    if (info.Length() > 1 && !info[1].IsUndefined()) {
+        if (!info[1].IsObject()) return fail("options must be an object");
+        Napi::Object options = info[1].As<Napi::Object>();
+
+        Napi::Value name = options.Get("language");
+        if (!name.IsUndefined() &&
+            (!name.IsString() ||
+             !ParseScriptLanguage(name.As<Napi::String>().Utf8Value(), language))) {
+            return fail("language must be 'auto', 'powershell' or 'shell'");
+        }
+        Napi::Value depth = options.Get("maxDepth");
+        if (!depth.IsUndefined()) {
+            double value = depth.IsNumber() ? depth.As<Napi::Number>().DoubleValue() : -1;
+            if (!(value >= 0 && value <= 16) || value != static_cast<uint32_t>(value)) {
+                return fail("maxDepth must be an integer from 0 to 16");
+            }
+            limits.maxDepth = static_cast<uint32_t>(value);
+        }
+        Napi::Value output = options.Get("maxOutputBytes");
+        if (!output.IsUndefined()) {
+            double value = output.IsNumber() ? output.As<Napi::Number>().DoubleValue() : -1;
+            if (!(value >= 0 && value <= 1024.0 * 1024 * 1024)) {
+                return fail("maxOutputBytes must be a number from 0 to 1 GiB");
+            }
+            limits.maxOutputBytes = static_cast<size_t>(value);
+        }
+    }
+
+    std::string text;
+    const uint8_t* data;
+    size_t length;
+    if (info[0].IsBuffer()) {
+        auto bytes = info[0].As<Napi::Buffer<uint8_t>>();
+        data = bytes.Data();
+        length = bytes.Length();
+    } else {
+        text = info[0].As<Napi::String>().Utf8Value();
+        data = reinterpret_cast<const uint8_t*>(text.data());
+        length = text.size();
+    }
+
+    ScriptNormalizer& normalizer = ThreadScriptNormalizer();
+    const std::vector<ScriptSpan>& spans = normalizer.Normalize(data, length, language, limits);
+    const NormalizeStats& stats = normalizer.Stats();
+
+    Napi::Array list = Napi::Array::New(env, spans.size());
+    for (size_t i = 0; i < spans.size(); i++) {
+        const ScriptSpan& span = spans[i];
+        Napi::Object out = Napi::Object::New(env);
+        out.Set("kind", Napi::String::New(env, SpanKindName(span.kind)));
+        out.Set("language", Napi::String::New(env, ScriptLanguageName(span.language)));
+        out.Set("depth", Napi::Number::New(env, span.depth));
+        if (span.language == ScriptLanguage::Binary) {
+            std::u16string latin1(span.data, span.data + span.length);
+            out.Set("text", Napi::String::New(env, latin1));
+        } else {
+            out.Set("text", Napi::String::New(env, reinterpret_cast<const char*>(span.data),
+                                              span.length));
+        }
+        list.Set(static_cast<uint32_t>(i), out);
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("language", Napi::String::New(env, ScriptLanguageName(spans[0].language)));
+    result.Set("spans", list);
+    result.Set("layers", Napi::Number::New(env, static_cast<double>(stats.layers)));
+    result.Set("decoded", Napi::Number::New(env, static_cast<double>(stats.decoded)));
+    result.Set("concatenations",
+               Napi::Number::New(env, static_cast<double>(stats.concatenations)));
+    result.Set("escapes", Napi::Number::New(env, static_cast<double>(stats.escapes)));
+    result.Set("depth", Napi::Number::New(env, stats.depth));
+    result.Set("limited", Napi::Boolean::New(env, stats.limited));
+    result.Set("bufferGrowths", Napi::Number::New(env, static_cast<double>(stats.bufferGrowths)));
+    return result;
+}
+
+Napi::Value GetScriptNormalizerStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    auto number = [&env](const std::atomic<uint64_t>& value) {
+        return Napi::Number::New(env, static_cast<double>(value.load()));
+    };
+    Napi::Object stats = Napi::Object::New(env);
+    stats.Set("scripts", number(g_counters.scripts));
+    stats.Set("bytesIn", number(g_counters.bytesIn));
+    stats.Set("bytesOut", number(g_counters.bytesOut));
+    stats.Set("layers", number(g_counters.layers));
+    stats.Set("decoded", number(g_counters.decoded));
+    stats.Set("concatenations", number(g_counters.concatenations));
+    stats.Set("escapes", number(g_counters.escapes));
+    stats.Set("limited", number(g_counters.limited));
+    stats.Set("bufferGrowths", number(g_counters.bufferGrowths));
+    return stats;
+}
+
+} // namespace TerminAI
@@ -0,0 +1,192 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Script Normalizer Header
+ *
+ * Undoes the cheap obfuscation of PowerShell and POSIX shell scripts so
+ * that signatures written against the plain text still match:
+ *
+ *   PowerShell  backtick escapes (I`E`X), literal concatenation
+ *               ('Down'+'loadString'), -EncodedCommand / -enc payloads
+ *               (base64 of UTF-16LE) and [Convert]::FromBase64String('...')
+ *   shell       quote splicing (c'u'"r"l), backslash escapes, $'\x..'
+ *               strings, line continuations, `echo ... | base64 -d`,
+ *               `base64 -d <<< ...` and `powershell -enc ...`
+ *
+ * Each layer is tokenized in one pass that writes its normalized text and
+ * collects the payloads it decodes; decoded payloads become the next
+ * layers, up to a depth and output limit. The result is a list of spans:
+ * the input itself (not copied), then every layer that differs from its
+ * source and every decoded payload, all in one arena. The arena and the
+ * working buffers belong to the normalizer and are reused, so a normalizer
+ * that has seen content of a given size normalizes more of it without
+ * allocating. Spans stay valid until its next Normalize() call.
+ *
+ * The scan pipeline (scan_pipeline.h) runs every span through its
+ * classifier and provider tiers, using one normalizer per thread.
+ */
+
+#pragma once
+
+#include <napi.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace TerminAI {
+
+enum class ScriptLanguage {
+    /** Decided from the content: PowerShell markers against shell ones */
+    Auto,
+    PowerShell,
+    Shell,
+    /** Decoded bytes that are not text; never tokenized */
+    Binary,
+};
+
+/** Parse "auto" | "powershell" | "shell". */
+bool ParseScriptLanguage(const std::string& name, ScriptLanguage& language);
+
+/** "auto" | "powershell" | "shell" | "binary" */
+const char* ScriptLanguageName(ScriptLanguage language);
+
+enum class SpanKind {
+    /** The input as given */
+    Source,
+    /** A layer with its escapes, quotes and concatenations undone */
+    Normalized,
+    /** A payload as decoded from base64 (UTF-16LE converted to UTF-8) */
+    Decoded,
+};
+
+/** "source" | "normalized" | "decoded" */
+const char* SpanKindName(SpanKind kind);
+
+struct ScriptSpan {
+    const uint8_t* data = nullptr;
+    size_t length = 0;
+    SpanKind kind = SpanKind::Source;
+    ScriptLanguage language = ScriptLanguage::Auto;
+    /** Times decoded: 0 for the input and its normalized text */
+    uint32_t depth = 0;
+};
+
+struct NormalizeLimits {
+    /** Decoding layers followed below the input */
+    uint32_t maxDepth = 4;
+    /** Arena bytes (normalized text and payloads); the rest is dropped */
+    size_t maxOutputBytes = 16 * 1024 * 1024;
+};
+
+struct NormalizeStats {
+    /** Spans other than the input */
+    uint64_t layers = 0;
+    uint64_t decoded = 0;
+    /** Literal + literal joins, and quoted fragments spliced into words */
+    uint64_t concatenations = 0;
+    /** Escape sequences and line continuations undone */
+    uint64_t escapes = 0;
+    uint32_t depth = 0;
+    /** A payload was dropped at the depth or output limit */
+    bool limited = false;
+    size_t arenaBytes = 0;
+    /** Reused buffers that had to grow in this call; 0 once warmed up */
+    uint64_t bufferGrowths = 0;
+};
+
+class ScriptNormalizer {
+public:
+    /**
+     * Normalize a script. Content with NUL bytes near its start is taken
+     * for binary and only yields its source span.
+     *
+     * @return the spans, the input first; valid until the next call
+     */
+    const std::vector<ScriptSpan>& Normalize(const uint8_t* data, size_t length,
+                                             ScriptLanguage language,
+                                             const NormalizeLimits& limits);
+
+    /** Counters of the last Normalize() call. */
+    const NormalizeStats& Stats() const { return stats_; }
+
+private:
+    struct Pending {
+        /** Offset in the arena, or SIZE_MAX for the input */
+        size_t offset;
+        size_t length;
+        ScriptLanguage language;
+        uint32_t depth;
+    };
+
+    struct Word {
+        /** Offset and length of the word's value in the layer text */
+        size_t offset;
+        size_t length;
+        /** Follows `<<<` */
+        bool hereString;
+    };
+
+    bool NormalizePowerShell(const uint8_t* data, size_t length);
+    bool NormalizeShell(const uint8_t* data, size_t length);
+
+    enum class Utf16 { Never, Detect, Require };
+
+    /** Decode a base64 payload into payloads_; false if it is not one. */
+    bool QueuePayload(const char* text, size_t length, ScriptLanguage language, Utf16 utf16);
+    void EndShellCommand(bool pipe);
+
+    std::string arena_;
+    /** Arena offset of every span but the first */
+    std::vector<size_t> offsets_;
+    std::string layer_;
+    std::string literal_;
+    std::string decoded_;
+    std::string payloads_;
+    std::vector<Pending> payloadRefs_;
+    std::vector<Pending> queue_;
+    std::vector<Word> words_;
+    std::vector<Word> previousWords_;
+    bool pipedIn_ = false;
+    std::vector<ScriptSpan> spans_;
+    NormalizeStats stats_;
+};
+
+/** This thread's normalizer (pool workers and the JS thread each have one). */
+ScriptNormalizer& ThreadScriptNormalizer();
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+/**
+ * Normalize a script.
+ *
+ * Arguments:
+ *   0: Buffer | String - Script
+ *   1: Object (optional)
+ *      - language?: 'auto' | 'powershell' | 'shell' (default 'auto')
+ *      - maxDepth?: Number - Decoding layers followed (default 4)
+ *      - maxOutputBytes?: Number - Normalized and decoded bytes kept
+ *        (default 16 MiB)
+ *
+ * Returns: Object - { language, spans: Array<{ kind, language, depth,
+ *          text }>, layers, decoded, concatenations, escapes, depth,
+ *          limited, bufferGrowths }
+ *   spans[0] is the input; decoded binary payloads are given as latin1.
+ */
+Napi::Value NormalizeScriptExport(const Napi::CallbackInfo& info);
+
+/**
+ * Counters since the module was loaded, across every thread.
+ *
+ * Returns: Object - { scripts, bytesIn, bytesOut, layers, decoded,
+ *          concatenations, escapes, limited, bufferGrowths }
+ */
+Napi::Value GetScriptNormalizerStats(const Napi::CallbackInfo& info);
+
+} // namespace TerminAI
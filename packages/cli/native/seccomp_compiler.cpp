@@ -0,0 +1,865 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Seccomp Policy Compiler Implementation
+ */
+
+#include "seccomp_compiler.h"
+
+#include <chrono>
+
+#ifdef __linux__
+
+#include "blake3.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/audit.h>
+#include <linux/seccomp.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/prctl.h>
+#include <sys/random.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <mutex>
+#include <unordered_map>
+
+// Syscalls that do not exist on every architecture (or in older headers).
+#ifndef __NR_open
+#define __NR_open -1
+#endif
+#ifndef __NR_creat
+#define __NR_creat -1
+#endif
+#ifndef __NR_mkdir
+#define __NR_mkdir -1
+#endif
+#ifndef __NR_rmdir
+#define __NR_rmdir -1
+#endif
+#ifndef __NR_unlink
+#define __NR_unlink -1
+#endif
+#ifndef __NR_rename
+#define __NR_rename -1
+#endif
+#ifndef __NR_link
+#define __NR_link -1
+#endif
+#ifndef __NR_symlink
+#define __NR_symlink -1
+#endif
+#ifndef __NR_chmod
+#define __NR_chmod -1
+#endif
+#ifndef __NR_chown
+#define __NR_chown -1
+#endif
+#ifndef __NR_lchown
+#define __NR_lchown -1
+#endif
+#ifndef __NR_utime
+#define __NR_utime -1
+#endif
+#ifndef __NR_utimes
+#define __NR_utimes -1
+#endif
+#ifndef __NR_futimesat
+#define __NR_futimesat -1
+#endif
+#ifndef __NR_mknod
+#define __NR_mknod -1
+#endif
+#ifndef __NR_fork
+#define __NR_fork -1
+#endif
+#ifndef __NR_vfork
+#define __NR_vfork -1
+#endif
+#ifndef __NR_iopl
+#define __NR_iopl -1
+#endif
+#ifndef __NR_ioperm
+#define __NR_ioperm -1
+#endif
+#ifndef __NR_uselib
+#define __NR_uselib -1
+#endif
+#ifndef __NR_renameat
+#define __NR_renameat -1
+#endif
+#ifndef __NR_clone3
+#define __NR_clone3 -1
+#endif
+#ifndef __NR_openat2
+#define __NR_openat2 -1
+#endif
+#ifndef __NR_fchmodat2
+#define __NR_fchmodat2 -1
+#endif
+#ifndef __NR_move_mount
+#define __NR_move_mount -1
+#endif
+#ifndef __NR_open_tree
+#define __NR_open_tree -1
+#endif
+#ifndef __NR_fsopen
+#define __NR_fsopen -1
+#endif
+#ifndef __NR_fsconfig
+#define __NR_fsconfig -1
+#endif
+#ifndef __NR_fsmount
+#define __NR_fsmount -1
+#endif
+#ifndef __NR_fspick
+#define __NR_fspick -1
+#endif
+#ifndef __NR_mount_setattr
+#define __NR_mount_setattr -1
+#endif
+#ifndef __NR_kexec_file_load
+#define __NR_kexec_file_load -1
+#endif
+
+#if defined(__x86_64__)
+#define TERMINAI_SECCOMP_ARCH AUDIT_ARCH_X86_64
+#elif defined(__aarch64__)
+#define TERMINAI_SECCOMP_ARCH AUDIT_ARCH_AARCH64
+#endif
+
+#endif // __linux__
+
+namespace TerminAI {
+
+#ifdef TERMINAI_SECCOMP_ARCH
+namespace {
+const std::string& SyscallTableIdentity();
+} // namespace
+#endif
+
+std::string SeccompProfile::Canonical() const {
+    // Bump the version whenever code generation changes so stale disk
+    // entries are never reused. The arch and syscall table pin the build.
+    std::string text = "terminai-seccomp v2";
+#ifdef TERMINAI_SECCOMP_ARCH
+    text += " arch=" + std::to_string(TERMINAI_SECCOMP_ARCH);
+    text += " table=" + SyscallTableIdentity();
+#endif
+    text += network ? " network=1" : " network=0";
+    text += privateNetwork ? " private=1" : " private=0";
+    text += filesystemWrite ? " write=1" : " write=0";
+    text += processSpawn ? " spawn=1" : " spawn=0";
+    text += linearDispatch ? " dispatch=linear" : " dispatch=binary";
+    return text;
+}
+
+#ifdef __linux__
+
+namespace {
+
+// ============================================================================
+// Rules
+// ============================================================================
+
+enum class LeafKind : uint8_t {
+    Allow,
+    Errno,
+    SocketFamily, // deny AF_INET/AF_INET6/AF_PACKET in arg0
+    OpenFlags,    // deny write flags in arg `arg`
+    CloneThread,  // allow only CLONE_THREAD in arg0
+};
+
+struct Leaf {
+    LeafKind kind = LeafKind::Allow;
+    uint16_t errnoValue = 0;
+    uint8_t arg = 0;
+
+    bool operator==(const Leaf& o) const {
+        return kind == o.kind && errnoValue == o.errnoValue && arg == o.arg;
+    }
+};
+
+struct SyscallRule {
+    uint32_t nr;
+    Leaf leaf;
+};
+
+constexpr uint32_t WRITE_OPEN_FLAGS = O_WRONLY | O_RDWR | O_CREAT | O_TRUNC | O_APPEND;
+
+std::vector<SyscallRule> BuildRules(const SeccompProfile& profile) {
+    std::vector<SyscallRule> rules;
+    auto add = [&rules](long nr, Leaf leaf) {
+        if (nr < 0) return;
+        // Later (more specific) rules for the same syscall win.
+        for (auto& rule : rules) {
+            if (rule.nr == static_cast<uint32_t>(nr)) {
+                rule.leaf = leaf;
+                return;
+            }
+        }
+        rules.push_back({static_cast<uint32_t>(nr), leaf});
+    };
+    const Leaf eperm{LeafKind::Errno, EPERM, 0};
+    const Leaf enosys{LeafKind::Errno, ENOSYS, 0};
+
+    // Baseline: never useful to an agent, always dangerous.
+    for (long nr : {
+             (long)__NR_ptrace, (long)__NR_process_vm_readv, (long)__NR_process_vm_writev,
+             (long)__NR_kexec_load, (long)__NR_kexec_file_load, (long)__NR_init_module,
+             (long)__NR_finit_module, (long)__NR_delete_module, (long)__NR_reboot,
+             (long)__NR_swapon, (long)__NR_swapoff, (long)__NR_mount, (long)__NR_umount2,
+             (long)__NR_pivot_root, (long)__NR_move_mount, (long)__NR_open_tree,
+             (long)__NR_fsopen, (long)__NR_fsconfig, (long)__NR_fsmount, (long)__NR_fspick,
+             (long)__NR_mount_setattr, (long)__NR_bpf, (long)__NR_perf_event_open,
+             (long)__NR_userfaultfd, (long)__NR_keyctl, (long)__NR_add_key,
+             (long)__NR_request_key, (long)__NR_open_by_handle_at, (long)__NR_setns,
+             (long)__NR_unshare, (long)__NR_iopl, (long)__NR_ioperm, (long)__NR_acct,
+             (long)__NR_settimeofday, (long)__NR_clock_settime, (long)__NR_clock_adjtime,
+             (long)__NR_adjtimex, (long)__NR_syslog, (long)__NR_quotactl, (long)__NR_vhangup,
+             (long)__NR_uselib,
+         }) {
+        add(nr, eperm);
+    }
+
+    // io_uring requests bypass seccomp entirely; ENOSYS makes libuv and
+    // friends fall back to plain syscalls, which the filter does see.
+    for (long nr : {(long)__NR_io_uring_setup, (long)__NR_io_uring_enter,
+                    (long)__NR_io_uring_register}) {
+        add(nr, enosys);
+    }
+
+    // Network: internet-client sockets need `network`; privateNetwork also
+    // permits them (address filtering is the egress proxy's job).
+    if (!profile.network && !profile.privateNetwork) {
+        add(__NR_socket, {LeafKind::SocketFamily, 0, 0});
+    }
+    if (!profile.privateNetwork) {
+        for (long nr : {(long)__NR_listen, (long)__NR_accept, (long)__NR_accept4}) add(nr, eperm);
+    }
+
+    if (!profile.filesystemWrite) {
+        add(__NR_open, {LeafKind::OpenFlags, 0, 1});
+        add(__NR_openat, {LeafKind::OpenFlags, 0, 2});
+        add(__NR_openat2, enosys);
+        for (long nr : {
+                 (long)__NR_creat, (long)__NR_mkdir, (long)__NR_mkdirat, (long)__NR_rmdir,
+                 (long)__NR_unlink, (long)__NR_unlinkat, (long)__NR_rename,
+                 (long)__NR_renameat, (long)__NR_renameat2, (long)__NR_link, (long)__NR_linkat,
+                 (long)__NR_symlink, (long)__NR_symlinkat, (long)__NR_chmod, (long)__NR_fchmod,
+                 (long)__NR_fchmodat, (long)__NR_fchmodat2, (long)__NR_chown, (long)__NR_fchown,
+                 (long)__NR_lchown, (long)__NR_fchownat, (long)__NR_truncate,
+                 (long)__NR_ftruncate, (long)__NR_utime, (long)__NR_utimes,
+                 (long)__NR_utimensat, (long)__NR_futimesat, (long)__NR_mknod,
+                 (long)__NR_mknodat, (long)__NR_setxattr, (long)__NR_lsetxattr,
+                 (long)__NR_fsetxattr, (long)__NR_removexattr, (long)__NR_lremovexattr,
+                 (long)__NR_fremovexattr, (long)__NR_fallocate,
+             }) {
+            add(nr, eperm);
+        }
+    }
+
+    if (!profile.processSpawn) {
+        add(__NR_fork, eperm);
+        add(__NR_vfork, eperm);
+        add(__NR_clone, {LeafKind::CloneThread, 0, 0});
+        add(__NR_clone3, enosys);
+    }
+
+    std::sort(rules.begin(), rules.end(),
+              [](const SyscallRule& a, const SyscallRule& b) { return a.nr < b.nr; });
+    return rules;
+}
+
+/**
+ * Digest of every rule the most restrictive profile produces: the numbers
+ * this build's headers give each syscall, and what happens to it. Builds
+ * against other headers never share disk entries.
+ */
+const std::string& SyscallTableIdentity() {
+    static const std::string identity = [] {
+        SeccompProfile strict;
+        strict.network = false;
+        strict.filesystemWrite = false;
+        strict.processSpawn = false;
+        Blake3Hasher hasher;
+        for (const SyscallRule& rule : BuildRules(strict)) {
+            uint32_t fields[4] = {rule.nr, static_cast<uint32_t>(rule.leaf.kind),
+                                  rule.leaf.errnoValue, rule.leaf.arg};
+            hasher.Update(fields, sizeof(fields));
+        }
+        return hasher.Finalize().ToHex().substr(0, 16);
+    }();
+    return identity;
+}
+
+// ============================================================================
+// Code Generation
+// ============================================================================
+
+using Code = std::vector<sock_filter>;
+
+inline sock_filter Stmt(uint16_t code, uint32_t k) {
+    return BPF_STMT(code, k);
+}
+
+inline sock_filter Jump(uint16_t code, uint32_t k, uint8_t jt, uint8_t jf) {
+    return BPF_JUMP(code, k, jt, jf);
+}
+
+constexpr uint32_t ArgLow(uint8_t index) {
+    return static_cast<uint32_t>(offsetof(struct seccomp_data, args) + 8 * index
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+                                 + 4
+#endif
+    );
+}
+
+inline sock_filter Errno(uint16_t value) {
+    return Stmt(BPF_RET | BPF_K, SECCOMP_RET_ERRNO | (value & SECCOMP_RET_DATA));
+}
+
+inline sock_filter Allow() {
+    return Stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW);
+}
+
+/** Leaf code: always ends in a return, so blocks never fall through. */
+void EmitLeaf(const Leaf& leaf, Code& out) {
+    switch (leaf.kind) {
+        case LeafKind::Allow:
+            out.push_back(Allow());
+            break;
+        case LeafKind::Errno:
+            out.push_back(Errno(leaf.errnoValue));
+            break;
+        case LeafKind::SocketFamily:
+            out.push_back(Stmt(BPF_LD | BPF_W | BPF_ABS, ArgLow(0)));
+            out.push_back(Jump(BPF_JMP | BPF_JEQ | BPF_K, AF_INET, 3, 0));
+            out.push_back(Jump(BPF_JMP | BPF_JEQ | BPF_K, AF_INET6, 2, 0));
+            out.push_back(Jump(BPF_JMP | BPF_JEQ | BPF_K, AF_PACKET, 1, 0));
+            out.push_back(Allow());
+            out.push_back(Errno(EPERM));
+            break;
+        case LeafKind::OpenFlags:
+            out.push_back(Stmt(BPF_LD | BPF_W | BPF_ABS, ArgLow(leaf.arg)));
+            out.push_back(Jump(BPF_JMP | BPF_JSET | BPF_K, WRITE_OPEN_FLAGS, 1, 0));
+            out.push_back(Allow());
+            out.push_back(Errno(EPERM));
+            break;
+        case LeafKind::CloneThread:
+            out.push_back(Stmt(BPF_LD | BPF_W | BPF_ABS, ArgLow(0)));
+            out.push_back(Jump(BPF_JMP | BPF_JSET | BPF_K, CLONE_THREAD, 0, 1));
+            out.push_back(Allow());
+            out.push_back(Errno(EPERM));
+            break;
+    }
+}
+
+/** A run of syscall numbers [lo, next range's lo) sharing one leaf. */
+struct Range {
+    uint32_t lo;
+    Leaf leaf;
+};
+
+std::vector<Range> BuildRanges(const std::vector<SyscallRule>& rules) {
+    std::vector<Range> ranges;
+    auto push = [&ranges](uint32_t lo, const Leaf& leaf) {
+        if (!ranges.empty() && ranges.back().leaf == leaf) return;
+        ranges.push_back({lo, leaf});
+    };
+
+    push(0, Leaf{});
+    for (const SyscallRule& rule : rules) {
+        if (!ranges.empty() && ranges.back().lo == rule.nr) {
+            ranges.pop_back(); // Empty gap before this syscall
+        }
+        push(rule.nr, rule.leaf);
+        push(rule.nr + 1, Leaf{});
+    }
+    return ranges;
+}
+
+/**
+ * Balanced binary search over ranges[first, last). The left half follows
+ * the compare directly; the right half is reached by jt, or by a JA
+ * trampoline when the left half is too long for an 8-bit jump offset.
+ */
+void EmitSearch(const std::vector<Range>& ranges, size_t first, size_t last, Code& out) {
+    if (last - first == 1) {
+        EmitLeaf(ranges[first].leaf, out);
+        return;
+    }
+
+    size_t mid = first + (last - first) / 2;
+    Code left;
+    EmitSearch(ranges, first, mid, left);
+
+    if (left.size() <= 255) {
+        out.push_back(Jump(BPF_JMP | BPF_JGE | BPF_K, ranges[mid].lo,
+                           static_cast<uint8_t>(left.size()), 0));
+    } else {
+        out.push_back(Jump(BPF_JMP | BPF_JGE | BPF_K, ranges[mid].lo, 0, 1));
+        out.push_back(Stmt(BPF_JMP | BPF_JA, static_cast<uint32_t>(left.size())));
+    }
+    out.insert(out.end(), left.begin(), left.end());
+    EmitSearch(ranges, mid, last, out);
+}
+
+/** The one-compare-per-rule layout this compiler replaces (benchmarks only). */
+void EmitLinear(const std::vector<SyscallRule>& rules, Code& out) {
+    std::vector<Code> leaves(rules.size());
+    for (size_t i = 0; i < rules.size(); i++) EmitLeaf(rules[i].leaf, leaves[i]);
+
+    size_t compareEnd = out.size() + 2 * rules.size() + 1;
+    size_t leafStart = compareEnd;
+    for (size_t i = 0; i < rules.size(); i++) {
+        out.push_back(Jump(BPF_JMP | BPF_JEQ | BPF_K, rules[i].nr, 0, 1));
+        size_t jaIndex = out.size();
+        out.push_back(Stmt(BPF_JMP | BPF_JA, static_cast<uint32_t>(leafStart - (jaIndex + 1))));
+        leafStart += leaves[i].size();
+    }
+    out.push_back(Allow());
+    for (const Code& leaf : leaves) out.insert(out.end(), leaf.begin(), leaf.end());
+}
+
+// ============================================================================
+// Caches
+// ============================================================================
+
+constexpr char DISK_MAGIC[4] = {'T', 'B', 'P', 'F'};
+constexpr uint32_t DISK_VERSION = 2;
+constexpr size_t CACHE_KEY_LEN = 32;
+
+struct DiskHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t count;
+    uint32_t reserved;
+    /** Keyed BLAKE3 of the hash and instructions (EntryMac) */
+    uint8_t checksum[BLAKE3_OUT_LEN];
+};
+
+std::mutex g_cacheMutex;
+std::unordered_map<std::string, std::shared_ptr<const SeccompProgram>> g_memoryCache;
+bool g_cacheDirConfigured = false;
+std::string g_cacheDir;
+
+/** The key of g_keyDir, read once per directory */
+std::mutex g_keyMutex;
+std::string g_keyDir;
+uint8_t g_key[CACHE_KEY_LEN];
+
+std::string DefaultCacheDirectory() {
+    if (const char* xdg = getenv("XDG_CACHE_HOME"); xdg && *xdg) {
+        return std::string(xdg) + "/terminai/seccomp";
+    }
+    if (const char* home = getenv("HOME"); home && *home) {
+        return std::string(home) + "/.cache/terminai/seccomp";
+    }
+    return "";
+}
+
+std::string CacheDirectory() {
+    std::lock_guard<std::mutex> lock(g_cacheMutex);
+    if (!g_cacheDirConfigured) {
+        g_cacheDir = DefaultCacheDirectory();
+        g_cacheDirConfigured = true;
+    }
+    return g_cacheDir;
+}
+
+/** Ours, and neither group nor others may write (or, with `secret`, read). */
+bool OwnedPrivately(const struct stat& st, bool secret) {
+    return st.st_uid == geteuid() && (st.st_mode & (secret ? 077 : 022)) == 0;
+}
+
+bool ReadFull(int fd, void* data, size_t length) {
+    auto* out = static_cast<uint8_t*>(data);
+    while (length > 0) {
+        ssize_t n = read(fd, out, length);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        out += n;
+        length -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool WriteFull(int fd, const void* data, size_t length) {
+    const auto* in = static_cast<const uint8_t*>(data);
+    while (length > 0) {
+        ssize_t n = write(fd, in, length);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        in += n;
+        length -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool IsCacheKey(const struct stat& st) {
+    return S_ISREG(st.st_mode) && OwnedPrivately(st, true) &&
+           st.st_size == static_cast<off_t>(CACHE_KEY_LEN);
+}
+
+bool ReadCacheKey(int dirFd, uint8_t key[CACHE_KEY_LEN]) {
+    int fd = openat(dirFd, "key", O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat st;
+    bool ok = fstat(fd, &st) == 0 && IsCacheKey(st) && ReadFull(fd, key, CACHE_KEY_LEN);
+    close(fd);
+    return ok;
+}
+
+/**
+ * Write a fresh random key unless another process got there first. A key
+ * someone else could have read (or swapped for a link) is replaced; the
+ * entries it signed are recompiled on their next use.
+ */
+void CreateCacheKey(int dirFd) {
+    struct stat st;
+    if (fstatat(dirFd, "key", &st, AT_SYMLINK_NOFOLLOW) == 0 && !IsCacheKey(st)) {
+        unlinkat(dirFd, "key", 0);
+    }
+    uint8_t key[CACHE_KEY_LEN];
+    if (getrandom(key, sizeof(key), 0) != static_cast<ssize_t>(sizeof(key))) return;
+    std::string temp = "key.tmp-" + std::to_string(getpid());
+    int fd = openat(dirFd, temp.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC,
+                    0600);
+    if (fd < 0) return;
+    bool written = WriteFull(fd, key, sizeof(key));
+    close(fd);
+    // link() never replaces: concurrent creators all end up with the winner's key.
+    if (written) linkat(dirFd, temp.c_str(), dirFd, "key", 0);
+    unlinkat(dirFd, temp.c_str(), 0);
+}
+
+/** The disk cache directory, open, and the key its entries are signed with. */
+struct DiskCache {
+    int dirFd = -1;
+    uint8_t key[CACHE_KEY_LEN];
+
+    DiskCache() = default;
+    DiskCache(const DiskCache&) = delete;
+    DiskCache& operator=(const DiskCache&) = delete;
+    ~DiskCache() {
+        if (dirFd >= 0) close(dirFd);
+    }
+};
+
+/**
+ * Open (creating it 0700) a cache directory we own, and its key (0600).
+ * Anything else sharing the uid could otherwise plant a well-formed
+ * allow-all program under the expected name; without the key it cannot
+ * sign one, and isolated sandboxes cannot see the directory at all.
+ */
+bool OpenDiskCache(const std::string& dir, DiskCache& cache) {
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(dir).parent_path(), ec);
+    if (mkdir(dir.c_str(), 0700) != 0 && errno != EEXIST) return false;
+
+    cache.dirFd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    struct stat st;
+    if (cache.dirFd < 0 || fstat(cache.dirFd, &st) != 0 || st.st_uid != geteuid()) return false;
+    if ((st.st_mode & 077) != 0 && fchmod(cache.dirFd, 0700) != 0) return false;
+
+    std::lock_guard<std::mutex> lock(g_keyMutex);
+    if (g_keyDir != dir) {
+        if (!ReadCacheKey(cache.dirFd, g_key)) {
+            CreateCacheKey(cache.dirFd);
+            if (!ReadCacheKey(cache.dirFd, g_key)) return false;
+        }
+        g_keyDir = dir;
+    }
+    memcpy(cache.key, g_key, CACHE_KEY_LEN);
+    return true;
+}
+
+Blake3Digest EntryMac(const uint8_t key[CACHE_KEY_LEN], const SeccompProgram& program) {
+    // BLAKE3 is not length-extendable, so a key prefix makes a sound MAC.
+    Blake3Hasher hasher;
+    hasher.Update(key, CACHE_KEY_LEN);
+    hasher.Update(program.hash.data(), program.hash.size());
+    hasher.Update(program.instructions.data(),
+                  program.instructions.size() * sizeof(sock_filter));
+    return hasher.Finalize();
+}
+
+std::shared_ptr<const SeccompProgram> LoadFromDisk(const DiskCache& cache,
+                                                   const std::string& hash) {
+    std::string name = hash + ".bpf";
+    int fd = openat(cache.dirFd, name.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd < 0) return nullptr;
+
+    auto program = std::make_shared<SeccompProgram>();
+    program->hash = hash;
+    DiskHeader header;
+    struct stat st;
+    bool ok = fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && OwnedPrivately(st, false) &&
+              ReadFull(fd, &header, sizeof(header)) &&
+              memcmp(header.magic, DISK_MAGIC, 4) == 0 && header.version == DISK_VERSION &&
+              header.count != 0 && header.count <= BPF_MAXINSNS;
+    if (ok) {
+        program->instructions.resize(header.count);
+        ok = ReadFull(fd, program->instructions.data(), header.count * sizeof(sock_filter));
+    }
+    close(fd);
+    if (!ok) return nullptr;
+
+    Blake3Digest mac = EntryMac(cache.key, *program);
+    uint8_t difference = 0;
+    for (size_t i = 0; i < BLAKE3_OUT_LEN; i++) difference |= mac.bytes[i] ^ header.checksum[i];
+    std::string error;
+    if (difference != 0 || !ValidateSeccompProgram(program->instructions, error)) {
+        return nullptr;
+    }
+    return program;
+}
+
+void StoreToDisk(const DiskCache& cache, const SeccompProgram& program) {
+    DiskHeader header{};
+    memcpy(header.magic, DISK_MAGIC, 4);
+    header.version = DISK_VERSION;
+    header.count = static_cast<uint32_t>(program.instructions.size());
+    Blake3Digest mac = EntryMac(cache.key, program);
+    memcpy(header.checksum, mac.bytes, BLAKE3_OUT_LEN);
+
+    // Write-then-rename so concurrent launchers never read a torn file.
+    std::string name = program.hash + ".bpf";
+    std::string temp = name + ".tmp-" + std::to_string(getpid());
+    int fd = openat(cache.dirFd, temp.c_str(),
+                    O_WRONLY | O_CREAT | O_TRUNC | O_NOFOLLOW | O_CLOEXEC, 0600);
+    if (fd < 0) return;
+    bool written = WriteFull(fd, &header, sizeof(header)) &&
+                   WriteFull(fd, program.instructions.data(),
+                             program.instructions.size() * sizeof(sock_filter));
+    close(fd);
+    if (!written || renameat(cache.dirFd, temp.c_str(), cache.dirFd, name.c_str()) != 0) {
+        unlinkat(cache.dirFd, temp.c_str(), 0);
+    }
+}
+
+} // namespace
+
+// ============================================================================
+// Core Functions
+// ============================================================================
+
+std::shared_ptr<const SeccompProgram> CompileSeccompProfile(const SeccompProfile& profile) {
+#ifndef TERMINAI_SECCOMP_ARCH
+    (void)profile;
+    return nullptr;
+#else
+    std::string canonical = profile.Canonical();
+    auto program = std::make_shared<SeccompProgram>();
+    program->hash = Blake3Hash(canonical.data(), canonical.size()).ToHex();
+    Code& code = program->instructions;
+
+    // Kill anything issued through a foreign syscall ABI.
+    code.push_back(Stmt(BPF_LD | BPF_W | BPF_ABS, offsetof(struct seccomp_data, arch)));
+    code.push_back(Jump(BPF_JMP | BPF_JEQ | BPF_K, TERMINAI_SECCOMP_ARCH, 1, 0));
+    code.push_back(Stmt(BPF_RET | BPF_K, SECCOMP_RET_KILL_PROCESS));
+    code.push_back(Stmt(BPF_LD | BPF_W | BPF_ABS, offsetof(struct seccomp_data, nr)));
+#ifdef __x86_64__
+    // x32 syscalls share the arch value; refuse them outright.
+    code.push_back(Jump(BPF_JMP | BPF_JGE | BPF_K, 0x40000000, 0, 1));
+    code.push_back(Errno(ENOSYS));
+#endif
+
+    std::vector<SyscallRule> rules = BuildRules(profile);
+    if (profile.linearDispatch) {
+        EmitLinear(rules, code);
+    } else {
+        std::vector<Range> ranges = BuildRanges(rules);
+        EmitSearch(ranges, 0, ranges.size(), code);
+    }
+
+    std::string error;
+    if (!ValidateSeccompProgram(code, error)) return nullptr;
+    return program;
+#endif
+}
+
+bool ValidateSeccompProgram(const std::vector<sock_filter>& instructions, std::string& error) {
+    if (instructions.empty() || instructions.size() > BPF_MAXINSNS) {
+        error = "program size out of range";
+        return false;
+    }
+
+    const size_t count = instructions.size();
+    for (size_t pc = 0; pc < count; pc++) {
+        const sock_filter& insn = instructions[pc];
+        uint16_t cls = BPF_CLASS(insn.code);
+
+        if (cls == BPF_JMP) {
+            if (BPF_OP(insn.code) == BPF_JA) {
+                if (pc + 1 + insn.k >= count) {
+                    error = "jump out of range at " + std::to_string(pc);
+                    return false;
+                }
+            } else if (pc + 1 + insn.jt >= count || pc + 1 + insn.jf >= count) {
+                error = "branch out of range at " + std::to_string(pc);
+                return false;
+            }
+        } else if (cls == BPF_LD) {
+            if (BPF_MODE(insn.code) == BPF_ABS &&
+                (insn.k >= sizeof(struct seccomp_data) || insn.k % 4 != 0)) {
+                error = "bad seccomp_data offset at " + std::to_string(pc);
+                return false;
+            }
+        } else if (cls != BPF_RET) {
+            error = "unsupported instruction class at " + std::to_string(pc);
+            return false;
+        }
+    }
+
+    if (BPF_CLASS(instructions.back().code) != BPF_RET) {
+        error = "program does not end in a return";
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<const SeccompProgram> GetSeccompProgram(const SeccompProfile& profile,
+                                                        SeccompCacheSource* source) {
+    std::string canonical = profile.Canonical();
+    std::string hash = Blake3Hash(canonical.data(), canonical.size()).ToHex();
+
+    {
+        std::lock_guard<std::mutex> lock(g_cacheMutex);
+        auto it = g_memoryCache.find(hash);
+        if (it != g_memoryCache.end()) {
+            if (source) *source = SeccompCacheSource::Memory;
+            return it->second;
+        }
+    }
+
+    std::string dir = CacheDirectory();
+    DiskCache cache;
+    bool disk = !dir.empty() && OpenDiskCache(dir, cache);
+    std::shared_ptr<const SeccompProgram> program;
+    SeccompCacheSource from = SeccompCacheSource::Disk;
+    if (disk) program = LoadFromDisk(cache, hash);
+    if (!program) {
+        program = CompileSeccompProfile(profile);
+        if (!program) return nullptr;
+        from = SeccompCacheSource::Compiled;
+        if (disk) StoreToDisk(cache, *program);
+    }
+
+    std::lock_guard<std::mutex> lock(g_cacheMutex);
+    g_memoryCache.emplace(hash, program);
+    if (source) *source = from;
+    return program;
+}
+
+std::string PrepareSeccompCacheDirectory() {
+    std::string dir = CacheDirectory();
+    DiskCache cache;
+    return !dir.empty() && OpenDiskCache(dir, cache) ? dir : std::string();
+}
+
+int InstallSeccompProgram(const SeccompProgram& program) {
+    struct sock_fprog fprog;
+    fprog.len = static_cast<unsigned short>(program.instructions.size());
+    fprog.filter = const_cast<sock_filter*>(program.instructions.data());
+
+    if (prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0) != 0) return errno;
+    if (syscall(SYS_seccomp, SECCOMP_SET_MODE_FILTER, 0, &fprog) != 0) return errno;
+    return 0;
+}
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+Napi::Value CompileSeccompFilter(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    SeccompProfile profile;
+    if (info.Length() > 0 && info[0].IsObject()) {
+        Napi::Object options = info[0].As<Napi::Object>();
+        auto flag = [&options](const char* name, bool fallback) {
+            Napi::Value value = options.Get(name);
+            return value.IsBoolean() ? value.As<Napi::Boolean>().Value() : fallback;
+        };
+        profile.network = flag("network", profile.network);
+        profile.privateNetwork = flag("privateNetwork", profile.privateNetwork);
+        profile.filesystemWrite = flag("filesystemWrite", profile.filesystemWrite);
+        profile.processSpawn = flag("processSpawn", profile.processSpawn);
+        Napi::Value dispatch = options.Get("dispatch");
+        profile.linearDispatch =
+            dispatch.IsString() && dispatch.As<Napi::String>().Utf8Value() == "linear";
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    SeccompCacheSource source = SeccompCacheSource::Compiled;
+    auto program = GetSeccompProgram(profile, &source);
+    double durationUs = std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - start).count();
+
+    if (!program) {
+        Napi::Error::New(env, "seccomp filters are not supported on this architecture")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("hash", Napi::String::New(env, program->hash));
+    result.Set("instructions",
+               Napi::Number::New(env, static_cast<double>(program->instructions.size())));
+    result.Set("source", Napi::String::New(env,
+        source == SeccompCacheSource::Memory ? "memory"
+        : source == SeccompCacheSource::Disk ? "disk" : "compiled"));
+    result.Set("durationUs", Napi::Number::New(env, durationUs));
+    return result;
+}
+
+Napi::Value SetSeccompCacheDirectory(const Napi::CallbackInfo& info) {
+    std::lock_guard<std::mutex> lock(g_cacheMutex);
+    g_cacheDir = info.Length() > 0 && info[0].IsString()
+        ? info[0].As<Napi::String>().Utf8Value()
+        : DefaultCacheDirectory();
+    g_cacheDirConfigured = true;
+    return info.Env().Undefined();
+}
+
+Napi::Value ClearSeccompCache(const Napi::CallbackInfo& info) {
+    std::lock_guard<std::mutex> lock(g_cacheMutex);
+    g_memoryCache.clear();
+    return info.Env().Undefined();
+}
+
+#else // !__linux__
+
+// ============================================================================
+// Stubs for Windows and macOS
+// ============================================================================
+
+Napi::Value CompileSeccompFilter(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Error::New(env, "seccomp is only available on Linux").ThrowAsJavaScriptException();
+    return env.Null();
+}
+
+Napi::Value SetSeccompCacheDirectory(const Napi::CallbackInfo& info) {
+    return info.Env().Undefined();
+}
+
+Napi::Value ClearSeccompCache(const Napi::CallbackInfo& info) {
+    return info.Env().Undefined();
+}
+
+#endif // __linux__
+
+} // namespace TerminAI
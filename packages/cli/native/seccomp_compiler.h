@@ -0,0 +1,157 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Seccomp Policy Compiler Header
+ *
+ * Linux counterpart of the AppContainer capability SIDs. A capability
+ * profile is compiled into a seccomp-BPF program that the sandbox launcher
+ * installs right before execve:
+ *
+ *   capability           when false
+ *   -------------------  ----------------------------------------------------
+ *   network              socket(AF_INET/AF_INET6/AF_PACKET) -> EPERM,
+ *                        unless privateNetwork is set
+ *   privateNetwork       listen/accept/accept4 -> EPERM (no serving)
+ *   filesystemWrite      open*(write flags), mkdir, unlink, rename, chmod,
+ *                        ... -> EPERM
+ *   processSpawn         fork/vfork/clone without CLONE_THREAD -> EPERM
+ *
+ * A baseline deny list (ptrace, mount, bpf, kexec, module loading, ...) is
+ * always applied, and io_uring is refused because its requests never pass
+ * through the filter. Syscalls that carry their arguments in structs the filter
+ * cannot read (clone3, openat2) return ENOSYS so libc falls back to the
+ * checkable variant.
+ *
+ * Program layout:
+ *
+ *   check arch (kill on mismatch) -> load nr -> binary search over the
+ *   syscall ranges that share an action -> leaf (ret, or argument checks)
+ *
+ * so the per-syscall cost is O(log n) compares instead of one per rule.
+ *
+ * Compiled programs are keyed by a BLAKE3 hash of the canonical profile
+ * (including the arch and this build's syscall numbers) and cached in
+ * memory and on disk (<cacheDir>/<hash>.bpf), so a launch only compiles a
+ * profile the first time the machine sees it. Disk entries are signed with
+ * a per-install key (<cacheDir>/key, 0600 in a 0700 directory we own) and
+ * anything unsigned is recompiled; isolated sandboxes get an empty tmpfs
+ * over the directory, so nothing they run can read the key or plant one.
+ */
+
+#pragma once
+
+#include <napi.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/filter.h>
+#endif
+
+namespace TerminAI {
+
+// ============================================================================
+// Types
+// ============================================================================
+
+struct SeccompProfile {
+    bool network = true;
+    bool privateNetwork = false;
+    bool filesystemWrite = true;
+    bool processSpawn = true;
+    /** Benchmarking aid: compare against the linear dispatch it replaces */
+    bool linearDispatch = false;
+
+    /** Stable text form; its hash is the cache key. */
+    std::string Canonical() const;
+};
+
+enum class SeccompCacheSource : uint8_t {
+    Compiled,
+    Memory,
+    Disk,
+};
+
+#ifdef __linux__
+
+struct SeccompProgram {
+    std::string hash;
+    std::vector<sock_filter> instructions;
+};
+
+// ============================================================================
+// Core Functions
+// ============================================================================
+
+/**
+ * Compile a profile (no caching).
+ */
+std::shared_ptr<const SeccompProgram> CompileSeccompProfile(const SeccompProfile& profile);
+
+/**
+ * Structural check: size limit, every jump in range, last instruction is a
+ * return. Run once at compile time and on every program loaded from disk.
+ */
+bool ValidateSeccompProgram(const std::vector<sock_filter>& instructions, std::string& error);
+
+/**
+ * Compile through the memory and disk caches.
+ *
+ * @param source Receives where the program came from
+ */
+std::shared_ptr<const SeccompProgram> GetSeccompProgram(const SeccompProfile& profile,
+                                                        SeccompCacheSource* source = nullptr);
+
+/**
+ * The disk cache directory, created with its key if need be, for isolated
+ * sandboxes to hide. "" when disk caching is off or the directory is not
+ * ours (the cache is then unused too).
+ */
+std::string PrepareSeccompCacheDirectory();
+
+/**
+ * Install a program on the calling thread. Async-signal-safe (raw system
+ * calls only), so the sandbox launcher can use it between fork and execve.
+ *
+ * @return 0 on success, errno on failure
+ */
+int InstallSeccompProgram(const SeccompProgram& program);
+
+#endif // __linux__
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+/**
+ * Compile (or fetch from cache) the filter for a capability profile.
+ *
+ * Arguments:
+ *   0: Object - { network?, privateNetwork?, filesystemWrite?, processSpawn?,
+ *                 dispatch?: 'binary' | 'linear' }
+ *
+ * Returns: Object - { hash, instructions, source: 'compiled'|'memory'|'disk',
+ *                     durationUs }
+ */
+Napi::Value CompileSeccompFilter(const Napi::CallbackInfo& info);
+
+/**
+ * Set the on-disk cache directory ('' disables the disk cache).
+ *
+ * Arguments:
+ *   0: String - Directory
+ */
+Napi::Value SetSeccompCacheDirectory(const Napi::CallbackInfo& info);
+
+/**
+ * Drop the in-memory cache (the disk cache is kept).
+ */
+Napi::Value ClearSeccompCache(const Napi::CallbackInfo& info);
+
+} // namespace TerminAI
@@ -0,0 +1,184 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Work Scheduler Implementation
+ */
+
+#include "work_scheduler.h"
+
+#include <cmath>
+#include <functional>
+
+namespace TerminAI {
+
+namespace {
+
+const WorkPriority PRIORITIES[WORK_PRIORITY_COUNT] = {
+    WorkPriority::Interactive,
+    WorkPriority::Normal,
+    WorkPriority::Bulk,
+};
+
+/** Upper bound of the bucket holding the given fraction of samples. */
+double HistogramPercentile(const std::array<uint64_t, WORK_HISTOGRAM_BUCKETS>& histogram,
+                           double fraction) {
+    uint64_t total = 0;
+    for (uint64_t count : histogram) total += count;
+    if (total == 0) return 0;
+
+    uint64_t rank = static_cast<uint64_t>(std::ceil(fraction * static_cast<double>(total)));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < WORK_HISTOGRAM_BUCKETS; i++) {
+        seen += histogram[i];
+        if (seen >= rank) return i == 0 ? 0 : std::ldexp(1.0, static_cast<int>(i));
+    }
+    return std::ldexp(1.0, static_cast<int>(WORK_HISTOGRAM_BUCKETS - 1));
+}
+
+Napi::Array HistogramArray(Napi::Env env,
+                           const std::array<uint64_t, WORK_HISTOGRAM_BUCKETS>& histogram) {
+    // Trailing empty buckets are left out.
+    size_t length = WORK_HISTOGRAM_BUCKETS;
+    while (length > 0 && histogram[length - 1] == 0) length--;
+    Napi::Array out = Napi::Array::New(env, length);
+    for (size_t i = 0; i < length; i++) {
+        out.Set(static_cast<uint32_t>(i), Napi::Number::New(env, static_cast<double>(histogram[i])));
+    }
+    return out;
+}
+
+Napi::Object ClassStatsObject(Napi::Env env, const WorkClassStats& stats) {
+    Napi::Object out = Napi::Object::New(env);
+    out.Set("submitted", Napi::Number::New(env, static_cast<double>(stats.submitted)));
+    out.Set("completed", Napi::Number::New(env, static_cast<double>(stats.completed)));
+    out.Set("rejected", Napi::Number::New(env, static_cast<double>(stats.rejected)));
+    out.Set("stolen", Napi::Number::New(env, static_cast<double>(stats.stolen)));
+    out.Set("queued", Napi::Number::New(env, static_cast<double>(stats.queued)));
+    out.Set("maxQueued", Napi::Number::New(env, static_cast<double>(stats.maxQueued)));
+
+    Napi::Object wait = Napi::Object::New(env);
+    wait.Set("p50", Napi::Number::New(env, HistogramPercentile(stats.waitUs, 0.50)));
+    wait.Set("p90", Napi::Number::New(env, HistogramPercentile(stats.waitUs, 0.90)));
+    wait.Set("p99", Napi::Number::New(env, HistogramPercentile(stats.waitUs, 0.99)));
+    wait.Set("max", Napi::Number::New(env, HistogramPercentile(stats.waitUs, 1.0)));
+    out.Set("waitUs", wait);
+
+    out.Set("waitHistogram", HistogramArray(env, stats.waitUs));
+    out.Set("depthHistogram", HistogramArray(env, stats.depth));
+    return out;
+}
+
+bool ReadCount(const Napi::Object& options, const char* name, size_t& out, std::string& error) {
+    Napi::Value value = options.Get(name);
+    if (value.IsUndefined()) return true;
+    double number = value.IsNumber() ? value.As<Napi::Number>().DoubleValue() : -1;
+    if (!(number >= 0) || number != std::floor(number) || number > 65536 * 1024.0) {
+        error = std::string(name) + " must be a non-negative integer";
+        return false;
+    }
+    out = static_cast<size_t>(number);
+    return true;
+}
+
+} // namespace
+
+bool ReadWorkContext(const Napi::Value& options, WorkPriority defaultPriority,
+                     WorkContext& out, std::string& error) {
+    out = WorkContext();
+    out.priority = defaultPriority;
+    if (!options.IsObject()) return true;
+    Napi::Object opts = options.As<Napi::Object>();
+
+    Napi::Value priority = opts.Get("priority");
+    if (priority.IsString()) {
+        std::string name = priority.As<Napi::String>().Utf8Value();
+        bool known = false;
+        for (WorkPriority candidate : PRIORITIES) {
+            if (name == WorkPriorityName(candidate)) {
+                out.priority = candidate;
+                known = true;
+            }
+        }
+        if (!known) {
+            error = "priority must be 'interactive', 'normal' or 'bulk'";
+            return false;
+        }
+    } else if (!priority.IsUndefined()) {
+        error = "priority must be a string";
+        return false;
+    }
+
+    Napi::Value session = opts.Get("sessionId");
+    if (session.IsString()) {
+        // 0 is "no session", which every unkeyed operation shares.
+        out.session = std::hash<std::string>()(session.As<Napi::String>().Utf8Value()) | 1;
+    } else if (!session.IsUndefined()) {
+        error = "sessionId must be a string";
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+Napi::Value ConfigureScheduler(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "configureScheduler expects an options object")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    Napi::Object options = info[0].As<Napi::Object>();
+
+    WorkerPoolConfig config;
+    std::string error;
+    if (!ReadCount(options, "threads", config.threads, error) ||
+        !ReadCount(options, "reservedInteractive", config.reservedInteractive, error) ||
+        !ReadCount(options, "queueCapacity", config.queueCapacity, error)) {
+        Napi::TypeError::New(env, error).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    Napi::Value pin = options.Get("pinThreads");
+    config.pinThreads = pin.IsBoolean() && pin.As<Napi::Boolean>().Value();
+
+    return Napi::Boolean::New(env, WorkerPool::ConfigureShared(config));
+}
+
+Napi::Value GetSchedulerStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    // Reading the stats must not start the pool (and so lock the config).
+    bool started = WorkerPool::SharedStarted();
+    WorkerPoolStats stats;
+    if (started) {
+        stats = WorkerPool::Shared().Stats();
+    } else {
+        stats.config = WorkerPool::PendingSharedConfig();
+    }
+
+    Napi::Object out = Napi::Object::New(env);
+    out.Set("started", Napi::Boolean::New(env, started));
+    out.Set("threads", Napi::Number::New(env, static_cast<double>(stats.config.threads)));
+    out.Set("reservedInteractive",
+            Napi::Number::New(env, static_cast<double>(stats.config.reservedInteractive)));
+    out.Set("queueCapacity",
+            Napi::Number::New(env, static_cast<double>(stats.config.queueCapacity)));
+    out.Set("pinThreads", Napi::Boolean::New(env, stats.config.pinThreads));
+    for (size_t i = 0; i < WORK_PRIORITY_COUNT; i++) {
+        out.Set(WorkPriorityName(PRIORITIES[i]), ClassStatsObject(env, stats.classes[i]));
+    }
+    return out;
+}
+
+Napi::Value ResetSchedulerStats(const Napi::CallbackInfo& info) {
+    if (WorkerPool::SharedStarted()) WorkerPool::Shared().ResetStats();
+    return info.Env().Undefined();
+}
+
+} // namespace TerminAI
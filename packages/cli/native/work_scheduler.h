@@ -0,0 +1,77 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Work Scheduler Header
+ *
+ * JS bindings for the shared WorkerPool's scheduling (see worker_pool.h).
+ *
+ * Pooled exports take `{ priority?, sessionId? }` in their options:
+ *
+ *   priority   'interactive' | 'normal' | 'bulk'; the class every task of
+ *              the operation is queued in
+ *   sessionId  fairness key: within a class, sessions take turns
+ *
+ * The pool's size, reserved interactive workers, queue bound and CPU
+ * pinning are set with configureScheduler() before the pool first runs.
+ */
+
+#pragma once
+
+#include <napi.h>
+
+#include <string>
+
+#include "worker_pool.h"
+
+namespace TerminAI {
+
+/**
+ * Read `priority` and `sessionId` from an options object (or undefined).
+ *
+ * @return false with a message if either is malformed
+ */
+bool ReadWorkContext(const Napi::Value& options, WorkPriority defaultPriority,
+                     WorkContext& out, std::string& error);
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+/**
+ * Configure the shared worker pool. Takes effect only before the pool first
+ * runs (the first pooled operation); call it during startup.
+ *
+ * Arguments:
+ *   0: options - {
+ *        threads?: number,             // default: hardware concurrency
+ *        reservedInteractive?: number, // workers that never run bulk (1)
+ *        queueCapacity?: number,       // per class (4096)
+ *        pinThreads?: boolean          // pin worker i to CPU i (false)
+ *      }
+ *
+ * Returns: boolean - false if the pool is already running (nothing changed)
+ */
+Napi::Value ConfigureScheduler(const Napi::CallbackInfo& info);
+
+/**
+ * Scheduler configuration, counters and histograms.
+ *
+ * Returns: Object - { started, threads, reservedInteractive, queueCapacity,
+ *          pinThreads, interactive, normal, bulk }, where each class is
+ *          { submitted, completed, rejected, stolen, queued, maxQueued,
+ *            waitUs: { p50, p90, p99, max },
+ *            waitHistogram: number[], depthHistogram: number[] }.
+ *          Histogram bucket 0 counts zeros and bucket i counts values in
+ *          [2^(i-1), 2^i); percentiles are bucket upper bounds.
+ */
+Napi::Value GetSchedulerStats(const Napi::CallbackInfo& info);
+
+/**
+ * Zero the scheduler's counters and histograms.
+ */
+Napi::Value ResetSchedulerStats(const Napi::CallbackInfo& info);
+
+} // namespace TerminAI
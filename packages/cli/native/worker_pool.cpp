@@ -0,0 +1,425 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Worker Pool Implementation
+ */
+
+#include "worker_pool.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace TerminAI {
+
+namespace {
+
+// A worker takes from the injection queue ahead of its own deque on every
+// Nth pick, so new operations still start while running ones fan out.
+constexpr uint32_t INJECTION_INTERVAL = 8;
+
+thread_local WorkContext t_context;
+// The pool and worker the calling thread belongs to, if it is a worker.
+thread_local const WorkerPool* t_pool = nullptr;
+thread_local void* t_worker = nullptr;
+
+size_t ClassIndex(WorkPriority priority) {
+    return static_cast<size_t>(priority);
+}
+
+size_t HistogramBucket(uint64_t value) {
+    size_t bucket = 0;
+    while (value != 0 && bucket < WORK_HISTOGRAM_BUCKETS - 1) {
+        value >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+void PinThread(std::thread& thread, size_t index) {
+    size_t cpus = std::thread::hardware_concurrency();
+    if (cpus == 0) return;
+#ifdef _WIN32
+    if (cpus > 64) cpus = 64;
+    SetThreadAffinityMask(thread.native_handle(), DWORD_PTR(1) << (index % cpus));
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(index % cpus, &set);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#else
+    (void)thread;
+    (void)index;
+#endif
+}
+
+std::mutex g_sharedMutex;
+WorkerPoolConfig g_sharedConfig;
+std::atomic<WorkerPool*> g_shared{nullptr};
+
+} // namespace
+
+// ============================================================================
+// Work Context
+// ============================================================================
+
+const char* WorkPriorityName(WorkPriority priority) {
+    switch (priority) {
+        case WorkPriority::Interactive: return "interactive";
+        case WorkPriority::Bulk: return "bulk";
+        default: return "normal";
+    }
+}
+
+WorkContext CurrentWorkContext() {
+    return t_context;
+}
+
+WorkScope::WorkScope(const WorkContext& context) : previous_(t_context) {
+    t_context = context;
+}
+
+WorkScope::~WorkScope() {
+    t_context = previous_;
+}
+
+// ============================================================================
+// WaitGroup
+// ============================================================================
+
+void WaitGroup::Run(std::function<void()> task) {
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    std::function<void()> counted = [this, task = std::move(task)]() {
+        task();
+        Done();
+    };
+    // At capacity: run it here, which holds the producer back.
+    if (!pool_.TrySubmit(std::move(counted))) counted();
+}
+
+void WaitGroup::Done() {
+    size_t pending = pending_.load(std::memory_order_relaxed);
+    while (pending > 1) {
+        if (pending_.compare_exchange_weak(pending, pending - 1, std::memory_order_acq_rel)) {
+            return;
+        }
+    }
+    // Reaching zero under the lock: Wait() takes it before returning, so the
+    // group is not destroyed while this thread still touches it.
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) idle_.notify_all();
+}
+
+void WaitGroup::Wait() {
+    while (pending_.load(std::memory_order_acquire) != 0) {
+        // Help drain the queue rather than blocking a thread that the
+        // outstanding tasks may need.
+        if (pool_.RunPendingTask()) continue;
+        // Nothing to help with: sleep, but look again for tasks the
+        // outstanding ones queue, which no other thread may be free to run.
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_.wait_for(lock, std::chrono::milliseconds(1), [this]() {
+            return pending_.load(std::memory_order_acquire) == 0;
+        });
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+}
+
+// ============================================================================
+// WorkerPool
+// ============================================================================
+
+WorkerPool::WorkerPool(const WorkerPoolConfig& config) : config_(config) {
+    if (config_.threads == 0) {
+        config_.threads = std::thread::hardware_concurrency();
+        if (config_.threads == 0) config_.threads = 1;
+    }
+    config_.reservedInteractive = std::min(config_.reservedInteractive, config_.threads - 1);
+    if (config_.queueCapacity == 0) config_.queueCapacity = 1;
+
+    workers_.reserve(config_.threads);
+    for (size_t i = 0; i < config_.threads; i++) {
+        auto worker = std::make_unique<Worker>();
+        worker->reserved = i >= config_.threads - config_.reservedInteractive;
+        workers_.push_back(std::move(worker));
+    }
+    // Started only once every Worker exists, since workers steal from each other.
+    for (size_t i = 0; i < workers_.size(); i++) {
+        workers_[i]->thread = std::thread([this, i]() { WorkerLoop(i); });
+        if (config_.pinThreads) PinThread(workers_[i]->thread, i);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stopping_ = true;
+    }
+    anyCv_.notify_all();
+    reservedCv_.notify_all();
+
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) worker->thread.join();
+    }
+}
+
+void WorkerPool::Submit(std::function<void()> task, const WorkContext& context) {
+    Task queued{std::move(task), context, std::chrono::steady_clock::now()};
+    Enqueue(queued);
+}
+
+bool WorkerPool::TrySubmit(std::function<void()>&& task, const WorkContext& context) {
+    Task queued{std::function<void()>(), context, std::chrono::steady_clock::now()};
+    size_t cls = ClassIndex(context.priority);
+    if (counters_[cls].queued.load(std::memory_order_relaxed) >= config_.queueCapacity) {
+        counters_[cls].rejected.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    queued.run = std::move(task);
+    Enqueue(queued);
+    return true;
+}
+
+void WorkerPool::Enqueue(Task& task) {
+    const size_t cls = ClassIndex(task.context.priority);
+    ClassCounters& counters = counters_[cls];
+    Worker* self = t_pool == this ? static_cast<Worker*>(t_worker) : nullptr;
+
+    // The count rises under the same lock as the push, so a taker can never
+    // decrement it for a task it has not yet been counted for.
+    uint64_t depth;
+    if (self != nullptr) {
+        std::lock_guard<std::mutex> lock(self->mutex);
+        depth = counters.queued.fetch_add(1) + 1;
+        self->deques[cls].push_back(std::move(task));
+    } else {
+        std::lock_guard<std::mutex> lock(injectionMutex_);
+        depth = counters.queued.fetch_add(1) + 1;
+        InjectionClass& injection = injection_[cls];
+        std::deque<Task>& queue = injection.sessions[task.context.session];
+        if (queue.empty()) injection.ready.push_back(task.context.session);
+        queue.push_back(std::move(task));
+    }
+
+    counters.submitted.fetch_add(1, std::memory_order_relaxed);
+    counters.depth[HistogramBucket(depth)].fetch_add(1, std::memory_order_relaxed);
+    uint64_t max = counters.maxQueued.load(std::memory_order_relaxed);
+    while (depth > max &&
+           !counters.maxQueued.compare_exchange_weak(max, depth, std::memory_order_relaxed)) {
+    }
+
+    Wake(cls);
+}
+
+void WorkerPool::Wake(size_t cls) {
+    // Pairs with the sleeper's increment before it re-checks the queues:
+    // either it sees the new task or this sees it sleeping.
+    if (sleeping_.load() == 0) return;
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+    }
+    anyCv_.notify_one();
+    if (cls != ClassIndex(WorkPriority::Bulk)) reservedCv_.notify_one();
+}
+
+bool WorkerPool::PopInjection(size_t cls, Task& out) {
+    std::lock_guard<std::mutex> lock(injectionMutex_);
+    InjectionClass& injection = injection_[cls];
+    if (injection.ready.empty()) return false;
+
+    uint64_t session = injection.ready.front();
+    injection.ready.pop_front();
+    auto it = injection.sessions.find(session);
+    out = std::move(it->second.front());
+    it->second.pop_front();
+    // Back of the line for the session's next task.
+    if (it->second.empty()) {
+        injection.sessions.erase(it);
+    } else {
+        injection.ready.push_back(session);
+    }
+    counters_[cls].queued.fetch_sub(1);
+    return true;
+}
+
+bool WorkerPool::Steal(Worker* self, size_t cls, Task& out) {
+    static thread_local size_t start = 0;
+    const size_t count = workers_.size();
+    start++;
+    for (size_t i = 0; i < count; i++) {
+        Worker* victim = workers_[(start + i) % count].get();
+        if (victim == self) continue;
+        std::lock_guard<std::mutex> lock(victim->mutex);
+        std::deque<Task>& deque = victim->deques[cls];
+        if (deque.empty()) continue;
+        // Oldest first: the biggest pieces of work, furthest from the
+        // victim's cache.
+        out = std::move(deque.front());
+        deque.pop_front();
+        counters_[cls].queued.fetch_sub(1);
+        counters_[cls].stolen.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+bool WorkerPool::TakeTask(Worker* self, size_t classLimit, bool injectionFirst, Task& out) {
+    for (size_t cls = 0; cls < classLimit; cls++) {
+        if (counters_[cls].queued.load() == 0) continue;
+
+        if (injectionFirst && PopInjection(cls, out)) return true;
+        if (self != nullptr) {
+            std::lock_guard<std::mutex> lock(self->mutex);
+            std::deque<Task>& deque = self->deques[cls];
+            if (!deque.empty()) {
+                out = std::move(deque.back());
+                deque.pop_back();
+                counters_[cls].queued.fetch_sub(1);
+                return true;
+            }
+        }
+        if (!injectionFirst && PopInjection(cls, out)) return true;
+        if (Steal(self, cls, out)) return true;
+    }
+    return false;
+}
+
+void WorkerPool::RunTask(Task& task) {
+    const size_t cls = ClassIndex(task.context.priority);
+    auto waited = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - task.queuedAt).count();
+    counters_[cls]
+        .waitUs[HistogramBucket(static_cast<uint64_t>(std::max<int64_t>(waited, 0)))]
+        .fetch_add(1, std::memory_order_relaxed);
+
+    {
+        WorkScope scope(task.context);
+        task.run();
+    }
+    counters_[cls].completed.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool WorkerPool::RunOneUpTo(size_t classLimit) {
+    Worker* self = t_pool == this ? static_cast<Worker*>(t_worker) : nullptr;
+    Task task;
+    if (!TakeTask(self, classLimit, false, task)) return false;
+    RunTask(task);
+    return true;
+}
+
+bool WorkerPool::RunPendingTask() {
+    // A waiter only helps with work at least as urgent as its own, so an
+    // interactive operation never ends up running someone's bulk task.
+    return RunOneUpTo(ClassIndex(t_context.priority) + 1);
+}
+
+bool WorkerPool::RunUrgentTask() {
+    size_t limit = ClassIndex(t_context.priority);
+    if (limit == 0) return false;
+    return RunOneUpTo(limit);
+}
+
+void WorkerPool::WorkerLoop(size_t index) {
+    Worker* self = workers_[index].get();
+    t_pool = this;
+    t_worker = self;
+
+    const size_t limit = self->reserved ? ClassIndex(WorkPriority::Bulk) : WORK_PRIORITY_COUNT;
+    auto hasWork = [this, limit]() {
+        for (size_t cls = 0; cls < limit; cls++) {
+            if (counters_[cls].queued.load() != 0) return true;
+        }
+        return false;
+    };
+
+    for (;;) {
+        Task task;
+        bool injectionFirst = ++self->picks % INJECTION_INTERVAL == 0;
+        if (TakeTask(self, limit, injectionFirst, task)) {
+            RunTask(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        sleeping_.fetch_add(1);
+        std::condition_variable& cv = self->reserved ? reservedCv_ : anyCv_;
+        cv.wait(lock, [this, &hasWork]() { return stopping_ || hasWork(); });
+        sleeping_.fetch_sub(1);
+        if (stopping_ && !hasWork()) return;
+    }
+}
+
+WorkerPoolStats WorkerPool::Stats() const {
+    WorkerPoolStats stats;
+    stats.config = config_;
+    for (size_t cls = 0; cls < WORK_PRIORITY_COUNT; cls++) {
+        const ClassCounters& counters = counters_[cls];
+        WorkClassStats& out = stats.classes[cls];
+        out.submitted = counters.submitted.load(std::memory_order_relaxed);
+        out.completed = counters.completed.load(std::memory_order_relaxed);
+        out.rejected = counters.rejected.load(std::memory_order_relaxed);
+        out.stolen = counters.stolen.load(std::memory_order_relaxed);
+        out.queued = counters.queued.load(std::memory_order_relaxed);
+        out.maxQueued = counters.maxQueued.load(std::memory_order_relaxed);
+        for (size_t b = 0; b < WORK_HISTOGRAM_BUCKETS; b++) {
+            out.waitUs[b] = counters.waitUs[b].load(std::memory_order_relaxed);
+            out.depth[b] = counters.depth[b].load(std::memory_order_relaxed);
+        }
+    }
+    return stats;
+}
+
+void WorkerPool::ResetStats() {
+    for (ClassCounters& counters : counters_) {
+        counters.submitted.store(0, std::memory_order_relaxed);
+        counters.completed.store(0, std::memory_order_relaxed);
+        counters.rejected.store(0, std::memory_order_relaxed);
+        counters.stolen.store(0, std::memory_order_relaxed);
+        counters.maxQueued.store(counters.queued.load(), std::memory_order_relaxed);
+        for (size_t b = 0; b < WORK_HISTOGRAM_BUCKETS; b++) {
+            counters.waitUs[b].store(0, std::memory_order_relaxed);
+            counters.depth[b].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+WorkerPool& WorkerPool::Shared() {
+    WorkerPool* pool = g_shared.load(std::memory_order_acquire);
+    if (pool != nullptr) return *pool;
+
+    std::lock_guard<std::mutex> lock(g_sharedMutex);
+    pool = g_shared.load(std::memory_order_relaxed);
+    if (pool == nullptr) {
+        // Intentionally leaked: worker threads must not be joined from a
+        // static destructor while Node is tearing the process down.
+        pool = new WorkerPool(g_sharedConfig);
+        g_shared.store(pool, std::memory_order_release);
+    }
+    return *pool;
+}
+
+bool WorkerPool::ConfigureShared(const WorkerPoolConfig& config) {
+    std::lock_guard<std::mutex> lock(g_sharedMutex);
+    if (g_shared.load(std::memory_order_relaxed) != nullptr) return false;
+    g_sharedConfig = config;
+    return true;
+}
+
+bool WorkerPool::SharedStarted() {
+    return g_shared.load(std::memory_order_acquire) != nullptr;
+}
+
+WorkerPoolConfig WorkerPool::PendingSharedConfig() {
+    std::lock_guard<std::mutex> lock(g_sharedMutex);
+    return g_sharedConfig;
+}
+
+} // namespace TerminAI
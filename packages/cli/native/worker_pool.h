@@ -0,0 +1,305 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Worker Pool Header
+ *
+ * A fixed-size, priority-aware thread pool shared by all CPU-heavy native
+ * work (hashing, directory walks, grants). It is deliberately independent of
+ * the libuv threadpool so that a single large job cannot starve Node's own
+ * fs/dns work.
+ *
+ * Tasks may fan out sub-tasks and wait for them with a WaitGroup. A waiting
+ * thread executes queued tasks before it sleeps, so nested fan-out never
+ * deadlocks even when every worker is itself waiting; with nothing queued
+ * it blocks until the group finishes, looking again every millisecond.
+ *
+ * Scheduling:
+ * - Every task carries a WorkContext: a priority class (interactive, normal,
+ *   bulk) and a session. Sub-tasks inherit the context of the thread that
+ *   submits them, so an operation keeps its class all the way down.
+ * - Workers always take the most urgent class that has work. A configurable
+ *   number of workers never take bulk tasks, so an interactive request finds
+ *   a thread even while bulk work saturates the rest.
+ * - Each worker owns one deque per class. Tasks submitted from a worker go
+ *   to its own deque (taken newest-first by the owner, oldest-first by idle
+ *   workers stealing from it); tasks submitted from other threads go to a
+ *   shared injection queue that serves sessions round-robin, so one session
+ *   queueing thousands of tasks does not delay another's first one.
+ * - Queues are bounded. TrySubmit() refuses a task once its class is at
+ *   capacity; WaitGroup then runs it on the submitting thread, which slows
+ *   the producer down instead of growing the queue.
+ * - Long-running tasks call RunUrgentTask() between units of work, so a
+ *   more urgent task never waits for a bulk task to finish.
+ * - Wait times and queue depths are recorded per class in log2 histograms.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace TerminAI {
+
+class WorkerPool;
+
+// ============================================================================
+// Work Context
+// ============================================================================
+
+/** Priority classes, most urgent first. */
+enum class WorkPriority : int {
+    /** Something the user is blocked on */
+    Interactive = 0,
+    Normal = 1,
+    /** Tree-wide scans and background cleanup */
+    Bulk = 2,
+};
+
+constexpr size_t WORK_PRIORITY_COUNT = 3;
+
+/** "interactive" / "normal" / "bulk" */
+const char* WorkPriorityName(WorkPriority priority);
+
+struct WorkContext {
+    WorkPriority priority = WorkPriority::Normal;
+    /** Fairness key within a class (0 = no session) */
+    uint64_t session = 0;
+};
+
+/** Context of the calling thread: its running task's, or Normal outside one. */
+WorkContext CurrentWorkContext();
+
+/**
+ * Sets the calling thread's context for the work it submits until the
+ * scope ends. AsyncWorkers open one in Execute() with the context their
+ * export parsed.
+ */
+class WorkScope {
+public:
+    explicit WorkScope(const WorkContext& context);
+    ~WorkScope();
+
+    WorkScope(const WorkScope&) = delete;
+    WorkScope& operator=(const WorkScope&) = delete;
+
+private:
+    WorkContext previous_;
+};
+
+// ============================================================================
+// Configuration and Statistics
+// ============================================================================
+
+struct WorkerPoolConfig {
+    /** Worker threads (0 = hardware concurrency) */
+    size_t threads = 0;
+    /** Workers that never take bulk tasks (clamped below `threads`) */
+    size_t reservedInteractive = 1;
+    /** Queued tasks per class before TrySubmit() refuses more */
+    size_t queueCapacity = 4096;
+    /** Pin worker i to CPU i (modulo the CPU count) */
+    bool pinThreads = false;
+};
+
+/** Histogram buckets: bucket 0 holds value 0, bucket i holds [2^(i-1), 2^i). */
+constexpr size_t WORK_HISTOGRAM_BUCKETS = 32;
+
+struct WorkClassStats {
+    uint64_t submitted = 0;
+    uint64_t completed = 0;
+    /** TrySubmit() refusals (the task then ran on the submitting thread) */
+    uint64_t rejected = 0;
+    /** Tasks an idle worker took from another worker's deque */
+    uint64_t stolen = 0;
+    /** Tasks queued right now */
+    uint64_t queued = 0;
+    uint64_t maxQueued = 0;
+    /** Time from submission to start, microseconds */
+    std::array<uint64_t, WORK_HISTOGRAM_BUCKETS> waitUs{};
+    /** Queued tasks of the class at each submission */
+    std::array<uint64_t, WORK_HISTOGRAM_BUCKETS> depth{};
+};
+
+struct WorkerPoolStats {
+    WorkerPoolConfig config;
+    std::array<WorkClassStats, WORK_PRIORITY_COUNT> classes;
+};
+
+// ============================================================================
+// WaitGroup
+// ============================================================================
+
+/**
+ * Tracks completion of a set of tasks submitted to a WorkerPool.
+ */
+class WaitGroup {
+public:
+    explicit WaitGroup(WorkerPool& pool) : pool_(pool) {}
+
+    WaitGroup(const WaitGroup&) = delete;
+    WaitGroup& operator=(const WaitGroup&) = delete;
+
+    /**
+     * Submit a task that counts towards this group, in the caller's
+     * context. If its class is at capacity, the task runs here and now.
+     */
+    void Run(std::function<void()> task);
+
+    /** Block until every task submitted through Run() has finished. */
+    void Wait();
+
+private:
+    /** Count one task out; the last one wakes Wait(). */
+    void Done();
+
+    WorkerPool& pool_;
+    std::atomic<size_t> pending_{0};
+    /** Held for the decrement that reaches zero */
+    std::mutex mutex_;
+    std::condition_variable idle_;
+};
+
+// ============================================================================
+// WorkerPool
+// ============================================================================
+
+class WorkerPool {
+public:
+    explicit WorkerPool(const WorkerPoolConfig& config = WorkerPoolConfig());
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /**
+     * Queue a task regardless of capacity, for work that must not run on
+     * the caller (cleanup scheduled from the JS thread).
+     */
+    void Submit(std::function<void()> task, const WorkContext& context = CurrentWorkContext());
+
+    /**
+     * Queue a task unless its class is at capacity.
+     *
+     * @return false (and counts a rejection) if the task was not queued;
+     *         `task` is then left untouched for the caller to run
+     */
+    bool TrySubmit(std::function<void()>&& task,
+                   const WorkContext& context = CurrentWorkContext());
+
+    /**
+     * Run one queued task on the calling thread, if any is available that
+     * is at least as urgent as the caller's own context.
+     *
+     * @return true if a task was executed
+     */
+    bool RunPendingTask();
+
+    /**
+     * Run one queued task that is strictly more urgent than the caller's
+     * context. Long-running tasks call this between units of work.
+     *
+     * @return true if a task was executed
+     */
+    bool RunUrgentTask();
+
+    /** Number of worker threads. */
+    size_t ThreadCount() const { return workers_.size(); }
+
+    const WorkerPoolConfig& Config() const { return config_; }
+
+    WorkerPoolStats Stats() const;
+
+    /** Zero the counters and histograms (not the queues). */
+    void ResetStats();
+
+    /** Process-wide pool used by native exports. */
+    static WorkerPool& Shared();
+
+    /**
+     * Configure the shared pool before its first use.
+     *
+     * @return false if the shared pool is already running
+     */
+    static bool ConfigureShared(const WorkerPoolConfig& config);
+
+    /** Whether the shared pool has been started. */
+    static bool SharedStarted();
+
+    /** What ConfigureShared() last set (before the pool starts). */
+    static WorkerPoolConfig PendingSharedConfig();
+
+private:
+    struct Task {
+        std::function<void()> run;
+        WorkContext context;
+        std::chrono::steady_clock::time_point queuedAt;
+    };
+
+    /** One class of the injection queue: a FIFO per session, served round-robin. */
+    struct InjectionClass {
+        std::unordered_map<uint64_t, std::deque<Task>> sessions;
+        std::deque<uint64_t> ready;
+    };
+
+    struct Worker {
+        std::thread thread;
+        std::mutex mutex;
+        std::array<std::deque<Task>, WORK_PRIORITY_COUNT> deques;
+        /** Skips bulk tasks */
+        bool reserved = false;
+        /** Picks made, for periodically favoring the injection queue */
+        uint32_t picks = 0;
+    };
+
+    struct ClassCounters {
+        std::atomic<uint64_t> submitted{0};
+        std::atomic<uint64_t> completed{0};
+        std::atomic<uint64_t> rejected{0};
+        std::atomic<uint64_t> stolen{0};
+        std::atomic<uint64_t> queued{0};
+        std::atomic<uint64_t> maxQueued{0};
+        std::array<std::atomic<uint64_t>, WORK_HISTOGRAM_BUCKETS> waitUs{};
+        std::array<std::atomic<uint64_t>, WORK_HISTOGRAM_BUCKETS> depth{};
+    };
+
+    void Enqueue(Task& task);
+    bool TakeTask(Worker* self, size_t classLimit, bool injectionFirst, Task& out);
+    bool PopInjection(size_t cls, Task& out);
+    bool Steal(Worker* self, size_t cls, Task& out);
+    void RunTask(Task& task);
+    bool RunOneUpTo(size_t classLimit);
+    void WorkerLoop(size_t index);
+    void Wake(size_t cls);
+
+    WorkerPoolConfig config_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+
+    std::mutex injectionMutex_;
+    std::array<InjectionClass, WORK_PRIORITY_COUNT> injection_;
+
+    std::array<ClassCounters, WORK_PRIORITY_COUNT> counters_;
+
+    // Idle workers sleep on one of two condition variables, so that a bulk
+    // task never wakes only a reserved worker that cannot take it.
+    std::mutex sleepMutex_;
+    std::condition_variable anyCv_;
+    std::condition_variable reservedCv_;
+    std::atomic<size_t> sleeping_{0};
+    bool stopping_ = false;
+};
+
+} // namespace TerminAI
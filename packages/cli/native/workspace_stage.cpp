@@ -0,0 +1,1364 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Workspace Staging Implementation
+ *
+ * The scan runs on the calling thread and hands out listing, hashing and
+ * copying to the pool. Metadata calls are collected per level (statx of
+ * both sides, then mkdirat of the level's new directories) and per copy
+ * batch (openat of both sides), and each batch goes to the kernel in as
+ * few io_uring_enter calls as the ring allows. Path lookups cannot
+ * complete inline, so the kernel spreads a batch over its own io-wq
+ * workers: the win grows with cores and with cold dentry caches, and is
+ * small on one CPU with everything cached. io_uring has no
+ * copy_file_range opcode, so the data itself moves in pool tasks, which
+ * keeps large files from holding up a batch.
+ *
+ * The ring is set up without liburing: one submission and one completion
+ * ring mapped from the ring descriptor, a user_data index per operation,
+ * and never more operations in flight than submission entries, so the
+ * completion ring (twice as large) cannot overflow.
+ */
+
+#include "workspace_stage.h"
+#include "blake3.h"
+#include "content_hasher.h"
+#include "work_scheduler.h"
+#include "worker_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <unordered_set>
+
+#ifdef _WIN32
+#include "appcontainer_manager.h"
+#elif defined(__linux__)
+#include <dirent.h>
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <linux/io_uring.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace TerminAI {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+/** Children stat'ed per batch; bounds memory on very wide directories. */
+constexpr size_t STAT_BATCH = 4096;
+
+/** Files opened per copy batch. Two batches are open at a time. */
+constexpr size_t OPEN_BATCH = 128;
+
+constexpr size_t MAX_REPORTED_ERRORS = 16;
+
+// ============================================================================
+// Shared State
+// ============================================================================
+
+enum class EntryKind : uint8_t {
+    Missing,
+    File,
+    Directory,
+    Symlink,
+    /** Sockets, FIFOs, devices: never staged */
+    Other,
+};
+
+struct EntryMeta {
+    EntryKind kind = EntryKind::Missing;
+    uint64_t size = 0;
+    int64_t mtimeNs = 0;
+    uint32_t mode = 0;
+};
+
+struct StatResult {
+    EntryMeta meta;
+    /** Empty unless the entry exists but cannot be stat'ed */
+    std::string error;
+};
+
+struct CopyJob {
+    std::string rel;
+    EntryMeta source;
+};
+
+struct StageState {
+    StageState(const StageOptions& options, StageResult& result)
+        : options(options), result(result), pool(WorkerPool::Shared()) {}
+
+    const StageOptions& options;
+    StageResult& result;
+    WorkerPool& pool;
+    std::string source;
+    std::string destination;
+
+    std::atomic<uint64_t> handledFiles{0};
+    std::atomic<uint64_t> copiedFiles{0};
+    std::atomic<uint64_t> copiedBytes{0};
+    std::atomic<uint64_t> reflinkedFiles{0};
+    std::atomic<uint64_t> unchangedFiles{0};
+    /** Cleared once the destination refuses a clone */
+    std::atomic<bool> clone{false};
+    uint64_t totalFiles = 0;
+    uint64_t totalBytes = 0;
+
+    std::mutex failMutex;
+    std::chrono::steady_clock::time_point lastReport{};
+
+    bool Serial() const { return options.threads == 1; }
+
+    bool Stopped() const { return IsStopped(options.cancel); }
+
+    bool IsExcluded(const std::string& name) const {
+        return std::find(options.exclude.begin(), options.exclude.end(), name) !=
+               options.exclude.end();
+    }
+
+    /** Count a failed entry; safe from any thread. */
+    void Fail(const std::string& rel, const std::string& reason) {
+        std::lock_guard<std::mutex> lock(failMutex);
+        result.failed++;
+        if (result.errors.size() < MAX_REPORTED_ERRORS) {
+            result.errors.push_back((rel.empty() ? "." : rel) + ": " + reason);
+        }
+    }
+
+    /** Call the progress callback if the interval has passed, or when `final`. */
+    void Report(const char* phase, bool final = false) {
+        if (!options.progress) return;
+        auto now = std::chrono::steady_clock::now();
+        if (!final && now - lastReport < std::chrono::milliseconds(options.progressIntervalMs)) {
+            return;
+        }
+        lastReport = now;
+
+        StageProgress progress;
+        progress.phase = phase;
+        progress.done = final;
+        if (std::strcmp(phase, "scan") == 0) {
+            progress.files = result.files + result.directories + result.symlinks;
+        } else {
+            progress.files = handledFiles.load(std::memory_order_relaxed);
+            progress.totalFiles = totalFiles;
+            progress.bytes = copiedBytes.load(std::memory_order_relaxed);
+            progress.totalBytes = totalBytes;
+        }
+        options.progress(progress);
+    }
+
+    /** Run `task(i)` for i in [0, count), on the pool unless serial. */
+    template <typename Task>
+    void ForEach(size_t count, Task task) {
+        if (Serial() || count < 2) {
+            for (size_t i = 0; i < count; i++) task(i);
+            return;
+        }
+        WaitGroup group(pool);
+        for (size_t i = 0; i < count; i++) {
+            group.Run([&task, i]() { task(i); });
+        }
+        group.Wait();
+    }
+};
+
+inline std::string JoinPath(const std::string& dir, const std::string& rel) {
+    if (rel.empty()) return dir;
+#ifdef _WIN32
+    std::string native = rel;
+    std::replace(native.begin(), native.end(), '/', '\\');
+    if (dir.back() == '\\' || dir.back() == '/') return dir + native;
+    return dir + "\\" + native;
+#else
+    if (dir.back() == '/') return dir + rel;
+    return dir + "/" + rel;
+#endif
+}
+
+inline std::string JoinRelative(const std::string& dir, const std::string& name) {
+    return dir.empty() ? name : dir + "/" + name;
+}
+
+inline fs::path ToPath(const std::string& path) {
+#ifdef _WIN32
+    return fs::path(Utf8ToWide(path));
+#else
+    return fs::path(path);
+#endif
+}
+
+/** Remove a destination entry, recursively for directories. */
+bool RemoveEntry(const std::string& path, std::string& error) {
+    std::error_code ec;
+    fs::remove_all(ToPath(path), ec);
+    if (ec) error = "remove: " + ec.message();
+    return !ec;
+}
+
+/** Same size and BLAKE3 digest; files that cannot be read differ. */
+bool SameContent(StageState& state, const std::string& rel) {
+    Blake3Digest source, destination;
+    std::string error;
+    return HashFileContent(JoinPath(state.source, rel), 1, source, error, state.options.cancel) &&
+           HashFileContent(JoinPath(state.destination, rel), 1, destination, error,
+                           state.options.cancel) &&
+           std::memcmp(source.bytes, destination.bytes, BLAKE3_OUT_LEN) == 0;
+}
+
+// ============================================================================
+// Platform Layer
+// ============================================================================
+
+#ifdef __linux__
+
+constexpr unsigned RING_ENTRIES = 256;
+constexpr unsigned STAT_MASK = STATX_TYPE | STATX_MODE | STATX_SIZE | STATX_MTIME;
+constexpr int NOT_RUN = INT_MIN;
+constexpr size_t COPY_BUFFER_BYTES = 1024 * 1024;
+
+struct MetaOp {
+    enum class Kind : uint8_t { Stat, Mkdir, Open, Unlink };
+
+    Kind kind = Kind::Stat;
+    const char* path = nullptr;
+    int flags = 0;
+    uint32_t mode = 0;
+    /** 0, a descriptor or -errno once run */
+    int result = NOT_RUN;
+    struct statx stx;
+};
+
+int RunDirect(MetaOp& op) {
+    int ret = -1;
+    switch (op.kind) {
+        case MetaOp::Kind::Stat:
+            ret = statx(AT_FDCWD, op.path, AT_SYMLINK_NOFOLLOW, STAT_MASK, &op.stx);
+            break;
+        case MetaOp::Kind::Mkdir:
+            ret = mkdirat(AT_FDCWD, op.path, op.mode);
+            break;
+        case MetaOp::Kind::Open:
+            ret = openat(AT_FDCWD, op.path, op.flags, op.mode);
+            break;
+        case MetaOp::Kind::Unlink:
+            ret = unlinkat(AT_FDCWD, op.path, op.flags);
+            break;
+    }
+    return ret < 0 ? -errno : ret;
+}
+
+/** A minimal io_uring for metadata batches. */
+class MetadataRing {
+public:
+    MetadataRing() = default;
+    ~MetadataRing() { Close(); }
+
+    MetadataRing(const MetadataRing&) = delete;
+    MetadataRing& operator=(const MetadataRing&) = delete;
+
+    /** @return false if io_uring is unavailable or lacks an opcode we need */
+    bool Open(unsigned entries) {
+        struct io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        int fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (fd < 0) return false;
+        fd_ = fd;
+        entries_ = params.sq_entries;
+
+        sqRingBytes_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingBytes_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+        singleMap_ = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMap_) sqRingBytes_ = cqRingBytes_ = std::max(sqRingBytes_, cqRingBytes_);
+
+        sqRing_ = mmap(nullptr, sqRingBytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       fd_, IORING_OFF_SQ_RING);
+        if (sqRing_ == MAP_FAILED) return Fail();
+        cqRing_ = singleMap_ ? sqRing_
+                             : mmap(nullptr, cqRingBytes_, PROT_READ | PROT_WRITE,
+                                    MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+        if (cqRing_ == MAP_FAILED) return Fail();
+        sqesBytes_ = params.sq_entries * sizeof(struct io_uring_sqe);
+        void* sqes = mmap(nullptr, sqesBytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          fd_, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) return Fail();
+        sqes_ = static_cast<struct io_uring_sqe*>(sqes);
+
+        auto* sq = static_cast<uint8_t*>(sqRing_);
+        sqTail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqArray_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        auto* cq = static_cast<uint8_t*>(cqRing_);
+        cqHead_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        return SupportsOpcodes() || Fail();
+    }
+
+    bool IsOpen() const { return fd_ >= 0; }
+
+    /**
+     * Run every op that has not run yet and wait for all of them.
+     *
+     * @return false (and the ring is closed) if io_uring_enter failed;
+     *         ops it did not complete are left NOT_RUN
+     */
+    bool Run(std::vector<MetaOp>& ops) {
+        size_t next = 0;
+        unsigned inFlight = 0;
+        unsigned unsubmitted = 0;
+        unsigned tail = *sqTail_;
+
+        while (next < ops.size() || inFlight > 0) {
+            for (; next < ops.size() && inFlight < entries_; next++) {
+                if (ops[next].result != NOT_RUN) continue;
+                unsigned slot = tail & sqMask_;
+                Prepare(sqes_[slot], ops[next], next);
+                sqArray_[slot] = slot;
+                tail++;
+                inFlight++;
+                unsubmitted++;
+            }
+            __atomic_store_n(sqTail_, tail, __ATOMIC_RELEASE);
+            if (inFlight == 0) break;
+
+            int submitted = static_cast<int>(syscall(__NR_io_uring_enter, fd_, unsubmitted, 1,
+                                                     IORING_ENTER_GETEVENTS, nullptr, 0));
+            if (submitted < 0) {
+                if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                    Close();
+                    return false;
+                }
+                submitted = 0;
+            }
+            unsubmitted -= static_cast<unsigned>(submitted);
+
+            unsigned head = *cqHead_;
+            unsigned ready = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+            for (; head != ready; head++) {
+                const struct io_uring_cqe& cqe = cqes_[head & cqMask_];
+                ops[static_cast<size_t>(cqe.user_data)].result = cqe.res;
+                inFlight--;
+            }
+            __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+        }
+        return true;
+    }
+
+private:
+    static void Prepare(struct io_uring_sqe& sqe, MetaOp& op, size_t index) {
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.fd = AT_FDCWD;
+        sqe.addr = reinterpret_cast<uint64_t>(op.path);
+        sqe.user_data = index;
+        switch (op.kind) {
+            case MetaOp::Kind::Stat:
+                sqe.opcode = IORING_OP_STATX;
+                sqe.len = STAT_MASK;
+                sqe.statx_flags = AT_SYMLINK_NOFOLLOW;
+                sqe.off = reinterpret_cast<uint64_t>(&op.stx);
+                break;
+            case MetaOp::Kind::Mkdir:
+                sqe.opcode = IORING_OP_MKDIRAT;
+                sqe.len = op.mode;
+                break;
+            case MetaOp::Kind::Open:
+                sqe.opcode = IORING_OP_OPENAT;
+                sqe.len = op.mode;
+                sqe.open_flags = static_cast<uint32_t>(op.flags);
+                break;
+            case MetaOp::Kind::Unlink:
+                sqe.opcode = IORING_OP_UNLINKAT;
+                sqe.unlink_flags = static_cast<uint32_t>(op.flags);
+                break;
+        }
+    }
+
+    bool SupportsOpcodes() {
+        std::vector<uint8_t> buffer(sizeof(struct io_uring_probe) +
+                                    256 * sizeof(struct io_uring_probe_op));
+        auto* probe = reinterpret_cast<struct io_uring_probe*>(buffer.data());
+        if (syscall(__NR_io_uring_register, fd_, IORING_REGISTER_PROBE, probe, 256) < 0) {
+            return false;
+        }
+        for (int opcode : {IORING_OP_STATX, IORING_OP_MKDIRAT, IORING_OP_OPENAT,
+                           IORING_OP_UNLINKAT}) {
+            if (opcode > probe->last_op ||
+                !(probe->ops[opcode].flags & IO_URING_OP_SUPPORTED)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool Fail() {
+        Close();
+        return false;
+    }
+
+    void Close() {
+        if (sqes_ != nullptr) munmap(sqes_, sqesBytes_);
+        if (cqRing_ != MAP_FAILED && !singleMap_) munmap(cqRing_, cqRingBytes_);
+        if (sqRing_ != MAP_FAILED) munmap(sqRing_, sqRingBytes_);
+        if (fd_ >= 0) close(fd_);
+        sqes_ = nullptr;
+        sqRing_ = cqRing_ = MAP_FAILED;
+        fd_ = -1;
+    }
+
+    int fd_ = -1;
+    unsigned entries_ = 0;
+    bool singleMap_ = false;
+    void* sqRing_ = MAP_FAILED;
+    void* cqRing_ = MAP_FAILED;
+    size_t sqRingBytes_ = 0;
+    size_t cqRingBytes_ = 0;
+    size_t sqesBytes_ = 0;
+    struct io_uring_sqe* sqes_ = nullptr;
+    struct io_uring_cqe* cqes_ = nullptr;
+    unsigned* sqTail_ = nullptr;
+    unsigned* sqArray_ = nullptr;
+    unsigned sqMask_ = 0;
+    unsigned* cqHead_ = nullptr;
+    unsigned* cqTail_ = nullptr;
+    unsigned cqMask_ = 0;
+};
+
+EntryMeta MetaFromStatx(const struct statx& stx) {
+    EntryMeta meta;
+    switch (stx.stx_mode & S_IFMT) {
+        case S_IFREG: meta.kind = EntryKind::File; break;
+        case S_IFDIR: meta.kind = EntryKind::Directory; break;
+        case S_IFLNK: meta.kind = EntryKind::Symlink; break;
+        default: meta.kind = EntryKind::Other; break;
+    }
+    meta.size = stx.stx_size;
+    meta.mtimeNs = static_cast<int64_t>(stx.stx_mtime.tv_sec) * 1000000000LL +
+                   stx.stx_mtime.tv_nsec;
+    meta.mode = stx.stx_mode & 07777;
+    return meta;
+}
+
+/** Metadata batches: through io_uring when available, else one call at a time. */
+class FileSystemBatch {
+public:
+    explicit FileSystemBatch(bool ioUring) {
+        if (ioUring) ring_.Open(RING_ENTRIES);
+    }
+
+    const char* Engine() const { return ring_.IsOpen() ? "io_uring" : "syscalls"; }
+
+    void Stat(const std::vector<std::string>& paths, std::vector<StatResult>& out) {
+        Prepare(paths, MetaOp::Kind::Stat);
+        Run();
+        out.assign(paths.size(), StatResult());
+        for (size_t i = 0; i < paths.size(); i++) {
+            int res = ops_[i].result;
+            if (res == 0) {
+                out[i].meta = MetaFromStatx(ops_[i].stx);
+            } else if (res != -ENOENT && res != -ENOTDIR) {
+                out[i].error = std::string("stat: ") + std::strerror(-res);
+            }
+        }
+    }
+
+    /** @param errors Set per path; empty on success */
+    void MakeDirectories(const std::vector<std::string>& paths, const std::vector<uint32_t>& modes,
+                         std::vector<std::string>& errors) {
+        Prepare(paths, MetaOp::Kind::Mkdir);
+        for (size_t i = 0; i < paths.size(); i++) ops_[i].mode = modes[i];
+        Run();
+        errors.assign(paths.size(), std::string());
+        for (size_t i = 0; i < paths.size(); i++) {
+            int res = ops_[i].result;
+            if (res < 0 && res != -EEXIST) errors[i] = std::string("mkdir: ") + std::strerror(-res);
+        }
+    }
+
+    void Unlink(const std::vector<std::string>& paths, std::vector<std::string>& errors) {
+        Prepare(paths, MetaOp::Kind::Unlink);
+        Run();
+        errors.assign(paths.size(), std::string());
+        for (size_t i = 0; i < paths.size(); i++) {
+            int res = ops_[i].result;
+            if (res < 0 && res != -ENOENT) {
+                errors[i] = std::string("unlink: ") + std::strerror(-res);
+            }
+        }
+    }
+
+    /** @param fds A descriptor or -errno per path */
+    void Open(const std::vector<std::string>& paths, const std::vector<int>& flags,
+              const std::vector<uint32_t>& modes, std::vector<int>& fds) {
+        Prepare(paths, MetaOp::Kind::Open);
+        for (size_t i = 0; i < paths.size(); i++) {
+            ops_[i].flags = flags[i];
+            ops_[i].mode = modes[i];
+        }
+        Run();
+        fds.resize(paths.size());
+        for (size_t i = 0; i < paths.size(); i++) fds[i] = ops_[i].result;
+    }
+
+private:
+    void Prepare(const std::vector<std::string>& paths, MetaOp::Kind kind) {
+        ops_.resize(paths.size());
+        for (size_t i = 0; i < paths.size(); i++) {
+            ops_[i].kind = kind;
+            ops_[i].path = paths[i].c_str();
+            ops_[i].flags = 0;
+            ops_[i].mode = 0;
+            ops_[i].result = NOT_RUN;
+        }
+    }
+
+    void Run() {
+        if (ring_.IsOpen()) ring_.Run(ops_);
+        for (auto& op : ops_) {
+            if (op.result == NOT_RUN) op.result = RunDirect(op);
+        }
+    }
+
+    MetadataRing ring_;
+    std::vector<MetaOp> ops_;
+};
+
+bool ListNames(const std::string& path, std::vector<std::string>& names) {
+    DIR* dir = opendir(path.c_str());
+    if (dir == nullptr) return false;
+    while (struct dirent* entry = readdir(dir)) {
+        const char* name = entry->d_name;
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+            continue;
+        }
+        names.emplace_back(name);
+    }
+    closedir(dir);
+    return true;
+}
+
+bool StageSymlink(const std::string& from, const std::string& to, const EntryMeta& existing,
+                  std::string& error) {
+    std::vector<char> buffer(4096);
+    ssize_t n = readlink(from.c_str(), buffer.data(), buffer.size() - 1);
+    if (n < 0) {
+        error = std::string("readlink: ") + std::strerror(errno);
+        return false;
+    }
+    buffer[static_cast<size_t>(n)] = '\0';
+    if (existing.kind == EntryKind::Symlink) {
+        std::vector<char> current(4096);
+        ssize_t m = readlink(to.c_str(), current.data(), current.size() - 1);
+        if (m == n && std::memcmp(current.data(), buffer.data(), static_cast<size_t>(n)) == 0) {
+            return true;
+        }
+        unlink(to.c_str());
+    }
+    if (symlink(buffer.data(), to.c_str()) != 0) {
+        error = std::string("symlink: ") + std::strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Copy `size` bytes (the size the scan saw) of `in` to `out`: a clone if
+ * allowed and possible, else copy_file_range, else read/write (across
+ * filesystems on kernels before 5.3, or filesystems without it). The first
+ * refused clone turns cloning off for the rest of the stage.
+ */
+bool CopyContents(int in, int out, uint64_t size, std::atomic<bool>& clone, uint64_t& copied,
+                  bool& cloned, std::string& error) {
+    if (size == 0) return true;
+    if (clone.load(std::memory_order_relaxed)) {
+        if (ioctl(out, FICLONE, in) == 0) {
+            copied = size;
+            cloned = true;
+            return true;
+        }
+        if (errno == EOPNOTSUPP || errno == ENOTTY || errno == EXDEV || errno == EINVAL) {
+            clone.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    bool ranged = true;
+    while (ranged && copied < size) {
+        size_t chunk = static_cast<size_t>(std::min<uint64_t>(size - copied, 1u << 30));
+        ssize_t n = copy_file_range(in, nullptr, out, nullptr, chunk, 0);
+        if (n > 0) {
+            copied += static_cast<uint64_t>(n);
+        } else if (n == 0) {
+            // Truncated underneath us, or a pseudo file that reports 0 here.
+            if (copied > 0) return true;
+            ranged = false;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (copied == 0 && (errno == EXDEV || errno == EINVAL || errno == ENOSYS ||
+                                   errno == EOPNOTSUPP || errno == EPERM)) {
+            ranged = false;
+        } else {
+            error = std::string("copy_file_range: ") + std::strerror(errno);
+            return false;
+        }
+    }
+    if (ranged) return true;
+
+    std::vector<uint8_t> buffer(COPY_BUFFER_BYTES);
+    for (;;) {
+        ssize_t n = read(in, buffer.data(), buffer.size());
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            error = std::string("read: ") + std::strerror(errno);
+            return false;
+        }
+        if (n == 0) return true;
+        for (ssize_t done = 0; done < n;) {
+            ssize_t w = write(out, buffer.data() + done, static_cast<size_t>(n - done));
+            if (w < 0) {
+                if (errno == EINTR) continue;
+                error = std::string("write: ") + std::strerror(errno);
+                return false;
+            }
+            done += w;
+        }
+        copied += static_cast<uint64_t>(n);
+    }
+}
+
+/** Copy one opened pair, then copy mode and mtime and close both. */
+void CopyOpened(StageState& state, const CopyJob& job, int in, int out) {
+    std::string error;
+    uint64_t copied = 0;
+    bool cloned = false;
+    bool ok = !state.Stopped() && CopyContents(in, out, job.source.size, state.clone, copied,
+                                               cloned, error);
+    if (ok) {
+        fchmod(out, job.source.mode);
+        struct timespec times[2];
+        times[0].tv_sec = 0;
+        times[0].tv_nsec = UTIME_OMIT;
+        times[1].tv_sec = job.source.mtimeNs / 1000000000LL;
+        times[1].tv_nsec = job.source.mtimeNs % 1000000000LL;
+        futimens(out, times);
+    }
+    close(in);
+    if (close(out) != 0 && ok) {
+        ok = false;
+        error = std::string("close: ") + std::strerror(errno);
+    }
+
+    if (ok) {
+        state.copiedFiles.fetch_add(1, std::memory_order_relaxed);
+        state.copiedBytes.fetch_add(copied, std::memory_order_relaxed);
+        if (cloned) state.reflinkedFiles.fetch_add(1, std::memory_order_relaxed);
+    } else if (!state.Stopped()) {
+        state.Fail(job.rel, error);
+    }
+    state.handledFiles.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * Open batches of source/destination pairs and copy them on the pool,
+ * opening the next batch while the previous one copies.
+ */
+void CopyFiles(StageState& state, FileSystemBatch& batch, const std::vector<CopyJob>& jobs) {
+    WaitGroup even(state.pool);
+    WaitGroup odd(state.pool);
+    std::vector<std::string> paths;
+    std::vector<int> flags;
+    std::vector<uint32_t> modes;
+    std::vector<int> fds;
+
+    for (size_t start = 0, round = 0; start < jobs.size(); start += OPEN_BATCH, round++) {
+        if (state.Stopped()) break;
+        WaitGroup& group = round % 2 == 0 ? even : odd;
+        // The batch before last used this group: its descriptors are closed
+        // once it has drained.
+        group.Wait();
+
+        size_t end = std::min(jobs.size(), start + OPEN_BATCH);
+        paths.clear();
+        flags.clear();
+        modes.clear();
+        for (size_t i = start; i < end; i++) {
+            paths.push_back(JoinPath(state.source, jobs[i].rel));
+            flags.push_back(O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+            modes.push_back(0);
+            paths.push_back(JoinPath(state.destination, jobs[i].rel));
+            flags.push_back(O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC | O_NOFOLLOW);
+            modes.push_back(jobs[i].source.mode | S_IWUSR);
+        }
+        batch.Open(paths, flags, modes, fds);
+
+        for (size_t i = start; i < end; i++) {
+            const CopyJob& job = jobs[i];
+            int in = fds[(i - start) * 2];
+            int out = fds[(i - start) * 2 + 1];
+            if (out == -EACCES) {
+                // A read-only file from an earlier stage: replace it.
+                const std::string& target = paths[(i - start) * 2 + 1];
+                unlink(target.c_str());
+                out = open(target.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC | O_NOFOLLOW,
+                           job.source.mode | S_IWUSR);
+                if (out < 0) out = -errno;
+            }
+            if (in < 0 || out < 0) {
+                if (in >= 0) close(in);
+                if (out >= 0) close(out);
+                state.Fail(job.rel, std::string("open: ") + std::strerror(in < 0 ? -in : -out));
+                state.handledFiles.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            if (state.Serial()) {
+                CopyOpened(state, job, in, out);
+            } else {
+                group.Run([&state, &job, in, out]() { CopyOpened(state, job, in, out); });
+            }
+        }
+        state.Report("copy");
+    }
+    even.Wait();
+    odd.Wait();
+}
+
+#else // !__linux__
+
+/** One call at a time through std::filesystem. */
+class FileSystemBatch {
+public:
+    explicit FileSystemBatch(bool) {}
+
+    const char* Engine() const { return "portable"; }
+
+    void Stat(const std::vector<std::string>& paths, std::vector<StatResult>& out) {
+        out.assign(paths.size(), StatResult());
+        for (size_t i = 0; i < paths.size(); i++) {
+            std::error_code ec;
+            fs::path path = ToPath(paths[i]);
+            fs::file_status status = fs::symlink_status(path, ec);
+            if (ec || !fs::exists(status)) continue;
+
+            EntryMeta& meta = out[i].meta;
+            if (fs::is_symlink(status)) {
+                meta.kind = EntryKind::Symlink;
+            } else if (fs::is_directory(status)) {
+                meta.kind = EntryKind::Directory;
+            } else if (fs::is_regular_file(status)) {
+                meta.kind = EntryKind::File;
+                meta.size = fs::file_size(path, ec);
+            } else {
+                meta.kind = EntryKind::Other;
+            }
+            meta.mode = static_cast<uint32_t>(status.permissions()) & 07777;
+            if (meta.kind != EntryKind::Symlink) {
+                auto mtime = fs::last_write_time(path, ec);
+                meta.mtimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    mtime.time_since_epoch()).count();
+            }
+        }
+    }
+
+    void MakeDirectories(const std::vector<std::string>& paths, const std::vector<uint32_t>&,
+                         std::vector<std::string>& errors) {
+        errors.assign(paths.size(), std::string());
+        for (size_t i = 0; i < paths.size(); i++) {
+            std::error_code ec;
+            fs::create_directory(ToPath(paths[i]), ec);
+            if (ec) errors[i] = "mkdir: " + ec.message();
+        }
+    }
+
+    void Unlink(const std::vector<std::string>& paths, std::vector<std::string>& errors) {
+        errors.assign(paths.size(), std::string());
+        for (size_t i = 0; i < paths.size(); i++) {
+            std::error_code ec;
+            fs::remove(ToPath(paths[i]), ec);
+            if (ec) errors[i] = "remove: " + ec.message();
+        }
+    }
+};
+
+bool ListNames(const std::string& path, std::vector<std::string>& names) {
+    std::error_code ec;
+    fs::directory_iterator it(ToPath(path), ec);
+    if (ec) return false;
+    for (const auto& entry : it) {
+#ifdef _WIN32
+        names.push_back(WideToUtf8(entry.path().filename().wstring()));
+#else
+        names.push_back(entry.path().filename().string());
+#endif
+    }
+    return true;
+}
+
+bool StageSymlink(const std::string& from, const std::string& to, const EntryMeta& existing,
+                  std::string& error) {
+    std::error_code ec;
+    fs::path target = fs::read_symlink(ToPath(from), ec);
+    if (ec) {
+        error = "readlink: " + ec.message();
+        return false;
+    }
+    if (existing.kind == EntryKind::Symlink) {
+        if (fs::read_symlink(ToPath(to), ec) == target && !ec) return true;
+        fs::remove(ToPath(to), ec);
+    }
+    fs::create_symlink(target, ToPath(to), ec);
+    if (ec) {
+        error = "symlink: " + ec.message();
+        return false;
+    }
+    return true;
+}
+
+void CopyOne(StageState& state, const CopyJob& job) {
+    if (state.Stopped()) return;
+    std::error_code ec;
+    fs::path from = ToPath(JoinPath(state.source, job.rel));
+    fs::path to = ToPath(JoinPath(state.destination, job.rel));
+    fs::copy_file(from, to, fs::copy_options::overwrite_existing, ec);
+    if (!ec) {
+        // Kept so that the next sync can compare by mtime.
+        fs::last_write_time(to, fs::file_time_type(std::chrono::duration_cast<
+                                    fs::file_time_type::duration>(
+                                    std::chrono::nanoseconds(job.source.mtimeNs))), ec);
+        state.copiedFiles.fetch_add(1, std::memory_order_relaxed);
+        state.copiedBytes.fetch_add(job.source.size, std::memory_order_relaxed);
+    } else {
+        state.Fail(job.rel, "copy: " + ec.message());
+    }
+    state.handledFiles.fetch_add(1, std::memory_order_relaxed);
+}
+
+void CopyFiles(StageState& state, FileSystemBatch&, const std::vector<CopyJob>& jobs) {
+    WaitGroup group(state.pool);
+    for (const auto& job : jobs) {
+        if (state.Stopped()) break;
+        if (state.Serial()) {
+            CopyOne(state, job);
+        } else {
+            group.Run([&state, &job]() { CopyOne(state, job); });
+        }
+        state.Report("copy");
+    }
+    group.Wait();
+}
+
+#endif // __linux__
+
+// ============================================================================
+// Scan
+// ============================================================================
+
+struct LevelDirectory {
+    std::string rel;
+    /** Whether the destination had it before this stage (worth listing to mirror) */
+    bool existed = false;
+};
+
+struct Child {
+    std::string rel;
+    /** Present only at the destination: to be removed when mirroring */
+    bool extraneous = false;
+};
+
+/**
+ * Handle one batch of children of the current level: stat both sides,
+ * queue directories for the next level (and creation), files for copying,
+ * and stage symlinks and removals straight away.
+ */
+void ProcessChildren(StageState& state, FileSystemBatch& batch, const std::vector<Child>& children,
+                     std::vector<LevelDirectory>& next, std::vector<CopyJob>& copies,
+                     std::vector<CopyJob>& compares) {
+    std::vector<std::string> paths;
+    paths.reserve(children.size() * 2);
+    for (const auto& child : children) {
+        paths.push_back(JoinPath(state.source, child.rel));
+        paths.push_back(JoinPath(state.destination, child.rel));
+    }
+    std::vector<StatResult> stats;
+    batch.Stat(paths, stats);
+
+    std::vector<std::string> mkdirPaths;
+    std::vector<uint32_t> mkdirModes;
+    std::vector<size_t> mkdirLevel;
+    std::vector<std::string> unlinkPaths;
+    std::vector<std::string> unlinkRels;
+
+    for (size_t i = 0; i < children.size(); i++) {
+        const Child& child = children[i];
+        const StatResult& source = stats[i * 2];
+        const StatResult& destination = stats[i * 2 + 1];
+        const std::string& to = paths[i * 2 + 1];
+
+        if (!destination.error.empty()) {
+            state.Fail(child.rel, destination.error);
+            continue;
+        }
+        EntryMeta existing = destination.meta;
+
+        if (child.extraneous) {
+            if (existing.kind == EntryKind::Missing) continue;
+            std::string error;
+            if (existing.kind == EntryKind::Directory) {
+                if (RemoveEntry(to, error)) {
+                    state.result.removedEntries++;
+                } else {
+                    state.Fail(child.rel, error);
+                }
+            } else {
+                unlinkPaths.push_back(to);
+                unlinkRels.push_back(child.rel);
+            }
+            continue;
+        }
+
+        if (!source.error.empty()) {
+            state.Fail(child.rel, source.error);
+            continue;
+        }
+        // Vanished since it was listed, or not something we stage.
+        if (source.meta.kind == EntryKind::Missing || source.meta.kind == EntryKind::Other) {
+            continue;
+        }
+
+        if (existing.kind != EntryKind::Missing && existing.kind != source.meta.kind) {
+            if (!state.options.mirror) {
+                state.Fail(child.rel, "exists at the destination as a different type");
+                continue;
+            }
+            std::string error;
+            if (!RemoveEntry(to, error)) {
+                state.Fail(child.rel, error);
+                continue;
+            }
+            state.result.removedEntries++;
+            existing = EntryMeta();
+        }
+
+        switch (source.meta.kind) {
+            case EntryKind::Directory:
+                state.result.directories++;
+                next.push_back({child.rel, existing.kind != EntryKind::Missing});
+                if (existing.kind == EntryKind::Missing) {
+                    mkdirPaths.push_back(to);
+                    // Owner access so the rest of the stage can fill it.
+                    mkdirModes.push_back(source.meta.mode | 0700);
+                    mkdirLevel.push_back(next.size() - 1);
+                }
+                break;
+
+            case EntryKind::File: {
+                state.result.files++;
+                bool sameSize = existing.kind == EntryKind::File &&
+                                existing.size == source.meta.size;
+                if (sameSize && state.options.compare == StageCompare::Metadata &&
+                    existing.mtimeNs == source.meta.mtimeNs) {
+                    state.unchangedFiles.fetch_add(1, std::memory_order_relaxed);
+                } else if (sameSize && state.options.compare == StageCompare::Hash) {
+                    compares.push_back({child.rel, source.meta});
+                } else {
+                    copies.push_back({child.rel, source.meta});
+                }
+                break;
+            }
+
+            case EntryKind::Symlink: {
+                state.result.symlinks++;
+                std::string error;
+                if (!StageSymlink(paths[i * 2], to, existing, error)) state.Fail(child.rel, error);
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+
+    std::vector<std::string> errors;
+    if (!unlinkPaths.empty()) {
+        batch.Unlink(unlinkPaths, errors);
+        for (size_t i = 0; i < unlinkPaths.size(); i++) {
+            if (errors[i].empty()) {
+                state.result.removedEntries++;
+            } else {
+                state.Fail(unlinkRels[i], errors[i]);
+            }
+        }
+    }
+
+    // All of a level's new directories at once; their children are only
+    // listed on the next level, so none of them waits on its parent.
+    if (!mkdirPaths.empty()) {
+        batch.MakeDirectories(mkdirPaths, mkdirModes, errors);
+        for (size_t i = mkdirPaths.size(); i-- > 0;) {
+            if (errors[i].empty()) continue;
+            state.Fail(next[mkdirLevel[i]].rel, errors[i]);
+            next.erase(next.begin() + static_cast<std::ptrdiff_t>(mkdirLevel[i]));
+        }
+    }
+}
+
+/** Walk the source level by level; returns the files to copy. */
+void ScanTree(StageState& state, FileSystemBatch& batch, std::vector<CopyJob>& copies) {
+    std::vector<CopyJob> compares;
+    std::vector<LevelDirectory> level{{"", true}};
+
+    while (!level.empty() && !state.Stopped()) {
+        std::vector<std::vector<std::string>> names(level.size());
+        std::vector<std::vector<std::string>> extraneous(level.size());
+        std::vector<char> unreadable(level.size(), 0);
+
+        state.ForEach(level.size(), [&](size_t i) {
+            if (state.Stopped()) return;
+            if (!ListNames(JoinPath(state.source, level[i].rel), names[i])) {
+                unreadable[i] = 1;
+                return;
+            }
+            names[i].erase(std::remove_if(names[i].begin(), names[i].end(),
+                                          [&state](const std::string& name) {
+                                              return state.IsExcluded(name);
+                                          }),
+                           names[i].end());
+            if (!state.options.mirror || !level[i].existed) return;
+
+            std::vector<std::string> present;
+            if (!ListNames(JoinPath(state.destination, level[i].rel), present)) return;
+            std::unordered_set<std::string> wanted(names[i].begin(), names[i].end());
+            for (auto& name : present) {
+                if (!wanted.count(name) && !state.IsExcluded(name)) {
+                    extraneous[i].push_back(std::move(name));
+                }
+            }
+        });
+
+        std::vector<LevelDirectory> next;
+        std::vector<Child> children;
+        auto flush = [&]() {
+            ProcessChildren(state, batch, children, next, copies, compares);
+            children.clear();
+            state.Report("scan");
+        };
+        for (size_t i = 0; i < level.size() && !state.Stopped(); i++) {
+            if (unreadable[i]) {
+                state.Fail(level[i].rel, "cannot list directory");
+                continue;
+            }
+            for (auto& name : names[i]) {
+                children.push_back({JoinRelative(level[i].rel, name), false});
+                if (children.size() == STAT_BATCH) flush();
+            }
+            for (auto& name : extraneous[i]) {
+                children.push_back({JoinRelative(level[i].rel, name), true});
+                if (children.size() == STAT_BATCH) flush();
+            }
+        }
+        if (!children.empty()) flush();
+        level = std::move(next);
+    }
+
+    // Same size at both ends: the digests decide.
+    std::mutex copiesMutex;
+    state.ForEach(compares.size(), [&](size_t i) {
+        if (state.Stopped()) return;
+        if (SameContent(state, compares[i].rel)) {
+            state.unchangedFiles.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        std::lock_guard<std::mutex> lock(copiesMutex);
+        copies.push_back(std::move(compares[i]));
+    });
+}
+
+/** Whether `inner` is `outer` or below it, unless below an excluded name. */
+bool IsWithin(const StageState& state, const std::string& outer, const std::string& inner) {
+    std::error_code ec;
+    fs::path relative = fs::weakly_canonical(ToPath(inner), ec).lexically_relative(
+        fs::weakly_canonical(ToPath(outer), ec));
+    if (ec || relative.empty() || *relative.begin() == "..") return false;
+    if (relative == ".") return true;
+#ifdef _WIN32
+    return !state.IsExcluded(WideToUtf8(relative.begin()->wstring()));
+#else
+    return !state.IsExcluded(relative.begin()->string());
+#endif
+}
+
+} // namespace
+
+// ============================================================================
+// Core API
+// ============================================================================
+
+bool StageWorkspace(const std::string& source, const std::string& destination,
+                    const StageOptions& options, StageResult& result, std::string& error) {
+    auto start = std::chrono::steady_clock::now();
+
+    std::error_code ec;
+    if (!fs::is_directory(ToPath(source), ec)) {
+        error = "Stage source is not a directory: " + source;
+        return false;
+    }
+    StageState state(options, result);
+    state.source = source;
+    state.destination = destination;
+    state.clone = options.reflink;
+    if (IsWithin(state, source, destination)) {
+        error = "Stage destination is inside the source: " + destination;
+        return false;
+    }
+    fs::create_directories(ToPath(destination), ec);
+    if (ec || !fs::is_directory(ToPath(destination), ec)) {
+        error = "Cannot create stage destination: " + destination;
+        return false;
+    }
+
+    FileSystemBatch batch(options.ioUring);
+    result.engine = batch.Engine();
+
+    std::vector<CopyJob> copies;
+    ScanTree(state, batch, copies);
+
+    for (const auto& job : copies) state.totalBytes += job.source.size;
+    state.totalFiles = copies.size();
+    if (!state.Stopped()) CopyFiles(state, batch, copies);
+
+    result.copiedFiles = state.copiedFiles.load();
+    result.copiedBytes = state.copiedBytes.load();
+    result.reflinkedFiles = state.reflinkedFiles.load();
+    result.unchangedFiles = state.unchangedFiles.load();
+    if (state.Stopped()) {
+        error = CancelReasonMessage(options.cancel->Outcome());
+        return false;
+    }
+    state.Report("copy", true);
+
+    result.durationMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+bool ReadStageOptions(const Napi::Object& options, StageOptions& out, std::string& error) {
+    Napi::Value exclude = options.Get("exclude");
+    if (exclude.IsArray()) {
+        Napi::Array names = exclude.As<Napi::Array>();
+        for (uint32_t i = 0; i < names.Length(); i++) {
+            Napi::Value name = names.Get(i);
+            if (name.IsString()) out.exclude.push_back(name.As<Napi::String>().Utf8Value());
+        }
+    } else if (!exclude.IsUndefined()) {
+        error = "exclude must be an array of names";
+        return false;
+    }
+
+    Napi::Value compare = options.Get("compare");
+    if (compare.IsString()) {
+        std::string name = compare.As<Napi::String>().Utf8Value();
+        if (name == "metadata") {
+            out.compare = StageCompare::Metadata;
+        } else if (name == "hash") {
+            out.compare = StageCompare::Hash;
+        } else if (name == "always") {
+            out.compare = StageCompare::Always;
+        } else {
+            error = "compare must be 'metadata', 'hash' or 'always'";
+            return false;
+        }
+    } else if (!compare.IsUndefined()) {
+        error = "compare must be 'metadata', 'hash' or 'always'";
+        return false;
+    }
+
+    Napi::Value mirror = options.Get("mirror");
+    if (mirror.IsBoolean()) out.mirror = mirror.As<Napi::Boolean>().Value();
+    Napi::Value reflink = options.Get("reflink");
+    if (reflink.IsBoolean()) out.reflink = reflink.As<Napi::Boolean>().Value();
+    Napi::Value ioUring = options.Get("ioUring");
+    if (ioUring.IsBoolean()) out.ioUring = ioUring.As<Napi::Boolean>().Value();
+    Napi::Value threads = options.Get("threads");
+    if (threads.IsNumber()) out.threads = threads.As<Napi::Number>().Uint32Value();
+    return true;
+}
+
+Napi::Object StageResultToObject(Napi::Env env, const StageResult& result) {
+    Napi::Object out = Napi::Object::New(env);
+    auto number = [&](const char* key, uint64_t value) {
+        out.Set(key, Napi::Number::New(env, static_cast<double>(value)));
+    };
+    number("files", result.files);
+    number("directories", result.directories);
+    number("symlinks", result.symlinks);
+    number("copiedFiles", result.copiedFiles);
+    number("copiedBytes", result.copiedBytes);
+    number("reflinkedFiles", result.reflinkedFiles);
+    number("unchangedFiles", result.unchangedFiles);
+    number("removedEntries", result.removedEntries);
+    number("failed", result.failed);
+    Napi::Array errors = Napi::Array::New(env, result.errors.size());
+    for (size_t i = 0; i < result.errors.size(); i++) {
+        errors.Set(static_cast<uint32_t>(i), Napi::String::New(env, result.errors[i]));
+    }
+    out.Set("errors", errors);
+    out.Set("engine", Napi::String::New(env, result.engine));
+    out.Set("durationMs", Napi::Number::New(env, result.durationMs));
+    return out;
+}
+
+// ============================================================================
+// Async Worker
+// ============================================================================
+
+namespace {
+
+Napi::Value RejectedPromise(Napi::Env env, const std::string& message) {
+    auto deferred = Napi::Promise::Deferred::New(env);
+    deferred.Reject(Napi::TypeError::New(env, message).Value());
+    return deferred.Promise();
+}
+
+Napi::Object ProgressToObject(Napi::Env env, const StageProgress& progress) {
+    Napi::Object out = Napi::Object::New(env);
+    out.Set("phase", Napi::String::New(env, progress.phase));
+    out.Set("files", Napi::Number::New(env, static_cast<double>(progress.files)));
+    out.Set("totalFiles", Napi::Number::New(env, static_cast<double>(progress.totalFiles)));
+    out.Set("bytes", Napi::Number::New(env, static_cast<double>(progress.bytes)));
+    out.Set("totalBytes", Napi::Number::New(env, static_cast<double>(progress.totalBytes)));
+    out.Set("done", Napi::Boolean::New(env, progress.done));
+    return out;
+}
+
+class StageWorker : public Napi::AsyncWorker {
+public:
+    StageWorker(Napi::Env env, std::string source, std::string destination, StageOptions options,
+                CancelBinding cancel, WorkContext work, Napi::Value onProgress)
+        : Napi::AsyncWorker(env),
+          deferred_(Napi::Promise::Deferred::New(env)),
+          source_(std::move(source)),
+          destination_(std::move(destination)),
+          options_(std::move(options)),
+          cancel_(std::move(cancel)),
+          work_(work) {
+        options_.cancel = cancel_.Token();
+        if (!onProgress.IsFunction()) return;
+
+        // Queue of one: an update the JS thread has not picked up yet means
+        // the next one is dropped. The last one waits for room instead.
+        progress_ = Napi::ThreadSafeFunction::New(env, onProgress.As<Napi::Function>(),
+                                                  "StageProgress", 1, 1);
+        hasProgress_ = true;
+        options_.progress = [this](const StageProgress& progress) {
+            auto* copy = new StageProgress(progress);
+            auto call = [](Napi::Env env, Napi::Function callback, StageProgress* data) {
+                Napi::Object object = ProgressToObject(env, *data);
+                delete data;
+                callback.Call({object});
+            };
+            napi_status status = progress.done ? progress_.BlockingCall(copy, call)
+                                               : progress_.NonBlockingCall(copy, call);
+            if (status != napi_ok) delete copy;
+        };
+    }
+
+    Napi::Promise Promise() const { return deferred_.Promise(); }
+
+    void Execute() override {
+        WorkScope scope(work_);
+        std::string error;
+        if (!StageWorkspace(source_, destination_, options_, result_, error)) SetError(error);
+        if (hasProgress_) progress_.Release();
+    }
+
+    void OnOK() override {
+        cancel_.Finish();
+        deferred_.Resolve(StageResultToObject(Env(), result_));
+    }
+
+    void OnError(const Napi::Error& error) override {
+        cancel_.Finish();
+        deferred_.Reject(cancel_.Stopped() ? cancel_.StoppedError(Env()) : error.Value());
+    }
+
+private:
+    Napi::Promise::Deferred deferred_;
+    std::string source_;
+    std::string destination_;
+    StageOptions options_;
+    CancelBinding cancel_;
+    WorkContext work_;
+    Napi::ThreadSafeFunction progress_;
+    bool hasProgress_ = false;
+    StageResult result_;
+};
+
+} // namespace
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+Napi::Value StageWorkspaceExport(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsString() || !info[1].IsString()) {
+        return RejectedPromise(env, "stageWorkspace expects a source and a destination");
+    }
+
+    StageOptions options;
+    Napi::Value opts = info.Length() > 2 ? info[2] : env.Undefined();
+    Napi::Value onProgress = env.Undefined();
+    std::string error;
+    if (opts.IsObject()) {
+        Napi::Object object = opts.As<Napi::Object>();
+        if (!ReadStageOptions(object, options, error)) {
+            return RejectedPromise(env, error);
+        }
+        onProgress = object.Get("onProgress");
+        if (!onProgress.IsUndefined() && !onProgress.IsFunction()) {
+            return RejectedPromise(env, "onProgress must be a function");
+        }
+        Napi::Value interval = object.Get("progressIntervalMs");
+        if (interval.IsNumber()) {
+            options.progressIntervalMs = interval.As<Napi::Number>().Uint32Value();
+        }
+    }
+
+    // Tree-wide by nature, so bulk unless the caller is waiting on it.
+    WorkContext work;
+    if (!ReadWorkContext(opts, WorkPriority::Bulk, work, error)) {
+        return RejectedPromise(env, error);
+    }
+
+    CancelBinding cancel(CancellableOperation::StageWorkspace);
+    if (!cancel.Attach(opts, error)) {
+        return RejectedPromise(env, error);
+    }
+
+    auto* worker = new StageWorker(env, info[0].As<Napi::String>().Utf8Value(),
+                                   info[1].As<Napi::String>().Utf8Value(), std::move(options),
+                                   std::move(cancel), work, onProgress);
+    Napi::Promise promise = worker->Promise();
+    worker->Queue();
+    return promise;
+}
+
+} // namespace TerminAI
@@ -0,0 +1,170 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Native Module - Workspace Staging Header
+ *
+ * Bulk copy and incremental sync of a directory tree, for filling a sandbox
+ * workspace from a project and pulling results back out. The source is
+ * walked one directory level at a time:
+ *
+ *   1. Every directory of the level is listed by its own pool task.
+ *   2. Source and destination of each child are stat'ed in one batch, and
+ *      the level's missing directories are created in one batch, so the
+ *      next level can be listed and created in parallel.
+ *   3. Changed files are opened in batches and copied by pool tasks:
+ *      a reflink (FICLONE) where the filesystem shares extents, otherwise
+ *      copy_file_range, otherwise read/write. Mode and mtime are copied,
+ *      so the next sync can compare by size and mtime.
+ *
+ * On Linux the batches go through io_uring (statx, mkdirat, openat,
+ * unlinkat); where io_uring is unavailable or lacks an opcode (kernels
+ * before 5.15, or io_uring disabled by sysctl or seccomp) the same batches
+ * run as plain system calls. Other platforms copy with std::filesystem on
+ * the pool.
+ *
+ * A file is copied if its destination is missing, or differs by the chosen
+ * comparison: size and mtime (default), content hash (BLAKE3, for trees
+ * whose mtimes are not preserved), or not at all (always copy). Mirroring
+ * also removes destination entries the source does not have.
+ *
+ * Destination files are never opened through a symlink. The destination
+ * must not change while it is staged: stage into a workspace before its
+ * sandbox starts, and out of it after its processes have exited.
+ */
+
+#pragma once
+
+#include <napi.h>
+#include "cancellation.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace TerminAI {
+
+// ============================================================================
+// Types
+// ============================================================================
+
+enum class StageCompare {
+    /** Same size and modification time */
+    Metadata,
+    /** Same size and BLAKE3 digest */
+    Hash,
+    /** Copy every file */
+    Always,
+};
+
+struct StageProgress {
+    /** "scan" | "copy" */
+    const char* phase = "scan";
+    /** Entries found (scan) or files handled (copy) */
+    uint64_t files = 0;
+    /** Files to copy; 0 while scanning */
+    uint64_t totalFiles = 0;
+    uint64_t bytes = 0;
+    uint64_t totalBytes = 0;
+    /** The last report of a stage that completed */
+    bool done = false;
+};
+
+struct StageOptions {
+    /** Entry names (not paths) to skip at any depth, e.g. ".git" */
+    std::vector<std::string> exclude;
+    StageCompare compare = StageCompare::Metadata;
+    /** Remove destination entries the source does not have (excluded names are kept) */
+    bool mirror = false;
+    /** Clone files on filesystems that support it (btrfs, XFS) */
+    bool reflink = true;
+    /** Batch metadata calls through io_uring where available (Linux) */
+    bool ioUring = true;
+    /** 1 = calling thread only; 0 = use the whole pool */
+    size_t threads = 0;
+    /** Checked between batches and files (null = never stops) */
+    CancelToken* cancel = nullptr;
+    /** Called on the staging thread, at most every progressIntervalMs, and once when done */
+    std::function<void(const StageProgress&)> progress;
+    uint32_t progressIntervalMs = 100;
+};
+
+struct StageResult {
+    uint64_t files = 0;
+    uint64_t directories = 0;
+    uint64_t symlinks = 0;
+    uint64_t copiedFiles = 0;
+    uint64_t copiedBytes = 0;
+    /** Copied files that were cloned rather than copied byte by byte */
+    uint64_t reflinkedFiles = 0;
+    /** Files the comparison found already up to date */
+    uint64_t unchangedFiles = 0;
+    /** Destination entries removed by mirroring (a directory counts once) */
+    uint64_t removedEntries = 0;
+    /** Entries that could not be staged */
+    uint64_t failed = 0;
+    /** The first few failures, as "<relative path>: <reason>" */
+    std::vector<std::string> errors;
+    /** "io_uring" | "syscalls" | "portable" */
+    const char* engine = "portable";
+    double durationMs = 0;
+};
+
+// ============================================================================
+// Core API
+// ============================================================================
+
+/**
+ * Copy or sync `source` into `destination`, creating it if needed. Entries
+ * that fail are counted and skipped.
+ *
+ * @return false if the source is not a readable directory, the destination
+ *         cannot be created, or the operation was stopped (error describes
+ *         it)
+ */
+bool StageWorkspace(const std::string& source, const std::string& destination,
+                    const StageOptions& options, StageResult& result, std::string& error);
+
+/**
+ * Read `{ exclude?, compare?, mirror?, reflink?, ioUring?, threads? }`.
+ *
+ * @return false with a message if a field is malformed
+ */
+bool ReadStageOptions(const Napi::Object& options, StageOptions& out, std::string& error);
+
+/** The result as returned to JS. */
+Napi::Object StageResultToObject(Napi::Env env, const StageResult& result);
+
+// ============================================================================
+// NAPI Exports
+// ============================================================================
+
+/**
+ * Stage a directory tree off the main thread.
+ *
+ * Arguments:
+ *   0: String - Source directory
+ *   1: String - Destination directory (created if missing)
+ *   2: Object (optional)
+ *      - exclude?: String[] - entry names to skip at any depth
+ *      - compare?: 'metadata' | 'hash' | 'always' (default 'metadata')
+ *      - mirror?: Boolean - remove extraneous destination entries
+ *      - reflink?: Boolean (default true), ioUring?: Boolean (default true)
+ *      - threads?: Number
+ *      - onProgress?: Function - ({ phase, files, totalFiles, bytes,
+ *        totalBytes, done }) => void, at most every progressIntervalMs
+ *        (default 100); updates the JS thread has not picked up yet are
+ *        dropped, except the last one (done: true)
+ *      - timeoutMs?, signal? - see cancellation.h
+ *      - priority?, sessionId? - see work_scheduler.h (default 'bulk')
+ *
+ * Returns: Promise<Object> - { files, directories, symlinks, copiedFiles,
+ *          copiedBytes, reflinkedFiles, unchangedFiles, removedEntries,
+ *          failed, errors, engine, durationMs }
+ */
+Napi::Value StageWorkspaceExport(const Napi::CallbackInfo& info);
+
+} // namespace TerminAI
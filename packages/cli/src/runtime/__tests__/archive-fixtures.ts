@@ -0,0 +1,148 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * In-memory zip and tar writers for the archive scanner tests and
+ * benchmarks, so fixtures need no external tools.
+ */
+
+import * as zlib from 'node:zlib';
+
+export type ArchiveFiles = Record<string, string | Buffer>;
+
+/** The EICAR test string, assembled at runtime so no file contains it. */
+export const EICAR =
+  'X5O!P%@AP[4\\PZX54(P^)7CC)7}$' + 'EICAR-STANDARD-ANTIVIRUS-TEST-FILE!$H+H*';
+
+const CRC_TABLE = Array.from({ length: 256 }, (_, n) => {
+  let c = n;
+  for (let k = 0; k < 8; k++) c = c & 1 ? 0xedb88320 ^ (c >>> 1) : c >>> 1;
+  return c >>> 0;
+});
+
+function crc32(data: Buffer): number {
+  let crc = 0xffffffff;
+  for (const byte of data) crc = CRC_TABLE[(crc ^ byte) & 0xff] ^ (crc >>> 8);
+  return (crc ^ 0xffffffff) >>> 0;
+}
+
+export interface ZipOptions {
+  /** Store members instead of deflating them */
+  store?: boolean;
+  /** Per-member general purpose flags, e.g. { 'a.txt': 1 } (encrypted) */
+  flags?: Record<string, number>;
+  /** Per-member compression method override, written as-is */
+  methods?: Record<string, number>;
+}
+
+export function zipArchive(files: ArchiveFiles, options: ZipOptions = {}) {
+  const locals: Buffer[] = [];
+  const central: Buffer[] = [];
+  let offset = 0;
+  for (const [name, content] of Object.entries(files)) {
+    const data = Buffer.from(content);
+    const nameBytes = Buffer.from(name);
+    const body = options.store ? data : zlib.deflateRawSync(data);
+    const method = options.methods?.[name] ?? (options.store ? 0 : 8);
+    const flags = options.flags?.[name] ?? 0;
+
+    const local = Buffer.alloc(30);
+    local.writeUInt32LE(0x04034b50, 0);
+    local.writeUInt16LE(20, 4);
+    local.writeUInt16LE(flags, 6);
+    local.writeUInt16LE(method, 8);
+    local.writeUInt32LE(crc32(data), 14);
+    local.writeUInt32LE(body.length, 18);
+    local.writeUInt32LE(data.length, 22);
+    local.writeUInt16LE(nameBytes.length, 26);
+
+    const entry = Buffer.alloc(46);
+    entry.writeUInt32LE(0x02014b50, 0);
+    entry.writeUInt16LE(20, 4);
+    entry.writeUInt16LE(20, 6);
+    entry.writeUInt16LE(flags, 8);
+    entry.writeUInt16LE(method, 10);
+    entry.writeUInt32LE(crc32(data), 16);
+    entry.writeUInt32LE(body.length, 20);
+    entry.writeUInt32LE(data.length, 24);
+    entry.writeUInt16LE(nameBytes.length, 28);
+    entry.writeUInt32LE(offset, 42);
+
+    locals.push(local, nameBytes, body);
+    central.push(entry, nameBytes);
+    offset += local.length + nameBytes.length + body.length;
+  }
+
+  const directory = Buffer.concat(central);
+  const end = Buffer.alloc(22);
+  end.writeUInt32LE(0x06054b50, 0);
+  const count = Object.keys(files).length;
+  end.writeUInt16LE(count, 8);
+  end.writeUInt16LE(count, 10);
+  end.writeUInt32LE(directory.length, 12);
+  end.writeUInt32LE(offset, 16);
+  return Buffer.concat([...locals, directory, end]);
+}
+
+function tarHeader(name: string, size: number, type = '0'): Buffer {
+  const header = Buffer.alloc(512);
+  header.write(name.slice(0, 100), 0);
+  header.write('0000644\0', 100);
+  header.write('0000000\0', 108);
+  header.write('0000000\0', 116);
+  header.write(size.toString(8).padStart(11, '0') + '\0', 124);
+  header.write('00000000000\0', 136);
+  header.write('        ', 148);
+  header.write(type, 156);
+  header.write('ustar\x0000', 257);
+  let sum = 0;
+  for (const byte of header) sum += byte;
+  header.write(sum.toString(8).padStart(6, '0') + '\0 ', 148);
+  return header;
+}
+
+function padded(data: Buffer): Buffer[] {
+  const padding = (512 - (data.length % 512)) % 512;
+  return [data, Buffer.alloc(padding)];
+}
+
+/** A ustar archive; names over 100 bytes get a pax path record. */
+export function tarArchive(files: ArchiveFiles): Buffer {
+  const blocks: Buffer[] = [];
+  for (const [name, content] of Object.entries(files)) {
+    const data = Buffer.from(content);
+    if (Buffer.byteLength(name) > 100) {
+      const record = ` path=${name}\n`;
+      let length = record.length;
+      while (`${length}${record}`.length !== length) {
+        length = `${length}${record}`.length;
+      }
+      const pax = Buffer.from(`${length}${record}`);
+      blocks.push(tarHeader('PaxHeader', pax.length, 'x'), ...padded(pax));
+    }
+    blocks.push(tarHeader(name, data.length), ...padded(data));
+  }
+  blocks.push(Buffer.alloc(1024));
+  return Buffer.concat(blocks);
+}
+
+/** Source-like text that compresses about as well as real code does. */
+export function sourceText(seed: number, bytes: number): Buffer {
+  const words = ['const', 'value', 'return', 'function', 'await', 'import'];
+  const lines: string[] = [];
+  let state = seed * 2654435761;
+  let size = 0;
+  while (size < bytes) {
+    state = (state * 1103515245 + 12345) >>> 0;
+    const line =
+      `  ${words[state % words.length]} v${state % 9973} = ` +
+      `${(state >>> 8).toString(36)}; // ${seed}\n`;
+    lines.push(line);
+    size += line.length;
+  }
+  return Buffer.from(lines.join('').slice(0, bytes));
+}
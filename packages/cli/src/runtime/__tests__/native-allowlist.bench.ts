@@ -0,0 +1,114 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Hash Allowlist Benchmarks (Linux)
+ *
+ * Run with `npm run bench -- native-allowlist`.
+ *
+ * Tables of 1M and 4M random digests are built once (build time is
+ * printed). The load cases map a table and swap it in, against reading the
+ * same hashes from a text file into a JS Set, which is what an allowlist
+ * costs without the native table. Lookups alternate hits and misses.
+ */
+
+import { bench, describe } from 'vitest';
+import { randomBytes } from 'node:crypto';
+import * as fs from 'node:fs';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import * as native from '../windows/native.js';
+
+const isLinux =
+  process.platform === 'linux' && native.isNativeModuleAvailable();
+
+const SIZES = [1_000_000, 4_000_000];
+const PROBES = 1024;
+
+interface Fixture {
+  table: string;
+  list: string;
+  probes: Buffer[];
+  set: Set<string>;
+}
+
+const fixtures = new Map<number, Fixture>();
+let dir = '';
+
+if (isLinux) {
+  dir = fs.mkdtempSync(path.join(os.tmpdir(), 'terminai-allow-bench-'));
+  process.on('exit', () => fs.rmSync(dir, { recursive: true, force: true }));
+
+  for (const size of SIZES) {
+    const digests = randomBytes(size * 32);
+    const table = path.join(dir, `table-${size}.bin`);
+    const built = await native.buildHashAllowlist(digests, table);
+    console.log(
+      `[allowlist] built ${size} entries in ${built.durationMs.toFixed(0)}ms ` +
+        `(${(built.bytes / 1024 / 1024).toFixed(1)} MiB)`,
+    );
+
+    const hex: string[] = [];
+    for (let i = 0; i < size; i++) {
+      hex.push(digests.toString('hex', i * 32, i * 32 + 32));
+    }
+    const list = path.join(dir, `list-${size}.txt`);
+    fs.writeFileSync(list, hex.join('\n'));
+
+    const probes: Buffer[] = [];
+    for (let i = 0; i < PROBES; i++) {
+      probes.push(
+        i % 2 === 0
+          ? digests.subarray(i * 32, i * 32 + 32)
+          : randomBytes(32),
+      );
+    }
+    fixtures.set(size, { table, list, probes, set: new Set(hex) });
+  }
+}
+
+for (const size of SIZES) {
+  describe.skipIf(!isLinux)(`load (${size} entries)`, () => {
+    bench('native map + swap', () => {
+      native.loadHashAllowlist(fixtures.get(size)!.table);
+    });
+
+    bench('JS read hex list into a Set', () => {
+      const text = fs.readFileSync(fixtures.get(size)!.list, 'utf-8');
+      new Set(text.split('\n'));
+    });
+  });
+
+  describe.skipIf(!isLinux)(`${PROBES} lookups (${size} entries)`, () => {
+    bench(
+      'native isHashAllowlisted',
+      () => {
+        for (const probe of fixtures.get(size)!.probes) {
+          native.isHashAllowlisted(probe);
+        }
+      },
+      {
+        setup: () => {
+          native.loadHashAllowlist(fixtures.get(size)!.table);
+        },
+        teardown: () => {
+          const info = native.getHashAllowlistInfo();
+          if (info) {
+            console.log(
+              `[allowlist] ${size}: hit rate ${info.hitRate.toFixed(3)}`,
+            );
+          }
+        },
+      },
+    );
+
+    bench('JS Set<string>.has (hex)', () => {
+      const { probes, set } = fixtures.get(size)!;
+      for (const probe of probes) set.has(probe.toString('hex'));
+    });
+  });
+}
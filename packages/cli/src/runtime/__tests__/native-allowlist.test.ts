@@ -0,0 +1,179 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Known-Good Hash Allowlist Tests
+ *
+ * Builds tables with buildHashAllowlist, maps them with loadHashAllowlist
+ * and checks lookups, atomic swaps, validation and the hit rate. Skipped
+ * when the native module is not built.
+ */
+
+import { describe, it, expect, beforeEach, afterEach } from 'vitest';
+import { randomBytes } from 'node:crypto';
+import * as fs from 'node:fs';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import * as native from '../windows/native.js';
+
+const hasNative = native.isNativeModuleAvailable();
+const itIfNative = hasNative ? it : it.skip;
+
+function hashes(prefix: string, count: number): string[] {
+  return Array.from({ length: count }, (_, i) =>
+    native.hashBuffer(`${prefix}-${i}`),
+  );
+}
+
+describe('Native Hash Allowlist', () => {
+  let dir: string;
+
+  beforeEach(() => {
+    if (!hasNative) return;
+    dir = fs.mkdtempSync(path.join(os.tmpdir(), 'terminai-allowlist-'));
+    native.unloadHashAllowlist();
+  });
+
+  afterEach(() => {
+    if (!hasNative) return;
+    native.unloadHashAllowlist();
+    fs.rmSync(dir, { recursive: true, force: true });
+  });
+
+  itIfNative('finds every listed hash and nothing else', async () => {
+    const listed = hashes('good', 5000);
+    const table = path.join(dir, 'good.bin');
+
+    const built = await native.buildHashAllowlist(listed, table);
+    expect(built.entries).toBe(5000);
+    expect(built.bytes).toBe(fs.statSync(table).size);
+
+    const loaded = native.loadHashAllowlist(table);
+    expect(loaded).toMatchObject({ ok: true, entries: 5000 });
+
+    expect(listed.every((hash) => native.isHashAllowlisted(hash))).toBe(true);
+    expect(
+      hashes('other', 5000).some((hash) => native.isHashAllowlisted(hash)),
+    ).toBe(false);
+  });
+
+  itIfNative('accepts raw digests and drops duplicates', async () => {
+    const digests = [randomBytes(32), randomBytes(32)];
+    const table = path.join(dir, 'raw.bin');
+    const built = await native.buildHashAllowlist(
+      Buffer.concat([digests[0], digests[1], digests[0]]),
+      table,
+    );
+    expect(built.entries).toBe(2);
+
+    native.loadHashAllowlist(table);
+    expect(native.isHashAllowlisted(digests[1])).toBe(true);
+    expect(native.isHashAllowlisted(digests[0].toString('hex'))).toBe(true);
+    expect(
+      native.isHashAllowlisted(digests[0].toString('hex').toUpperCase()),
+    ).toBe(true);
+  });
+
+  itIfNative('reports the hit rate', async () => {
+    const [good] = hashes('good', 1);
+    const table = path.join(dir, 'one.bin');
+    await native.buildHashAllowlist([good], table);
+    native.loadHashAllowlist(table);
+
+    const before = native.getHashAllowlistInfo()!;
+    native.isHashAllowlisted(good);
+    native.isHashAllowlisted(good);
+    native.isHashAllowlisted(good);
+    native.isHashAllowlisted(native.hashBuffer('unknown'));
+
+    const info = native.getHashAllowlistInfo()!;
+    expect(info).toMatchObject({ loaded: true, path: table, entries: 1 });
+    expect(info.lookups - before.lookups).toBe(4);
+    expect(info.hits - before.hits).toBe(3);
+    expect(info.hitRate).toBeGreaterThan(0);
+  });
+
+  itIfNative('swaps tables atomically on reload', async () => {
+    const table = path.join(dir, 'swap.bin');
+    const [first] = hashes('first', 1);
+    const [second] = hashes('second', 1);
+
+    await native.buildHashAllowlist([first], table);
+    const v1 = native.loadHashAllowlist(table).version;
+    expect(native.isHashAllowlisted(first)).toBe(true);
+
+    // Rebuilding over a mapped table does not disturb it until reloaded.
+    await native.buildHashAllowlist([second], table);
+    expect(native.isHashAllowlisted(first)).toBe(true);
+
+    const v2 = native.loadHashAllowlist(table).version;
+    expect(v2).toBe(v1 + 1);
+    expect(native.isHashAllowlisted(first)).toBe(false);
+    expect(native.isHashAllowlisted(second)).toBe(true);
+  });
+
+  itIfNative('keeps the previous table when a load fails', async () => {
+    const table = path.join(dir, 'ok.bin');
+    const [good] = hashes('good', 1);
+    await native.buildHashAllowlist([good], table);
+    native.loadHashAllowlist(table);
+
+    const garbage = path.join(dir, 'garbage.bin');
+    fs.writeFileSync(garbage, 'not a table');
+    const result = native.loadHashAllowlist(garbage);
+    expect(result.ok).toBe(false);
+    expect(result.error).toMatch(/not an allowlist table/);
+    expect(native.isHashAllowlisted(good)).toBe(true);
+    expect(native.getHashAllowlistInfo()!.lastError).toMatch(/garbage/);
+  });
+
+  itIfNative('detects a corrupted body with verify', async () => {
+    const table = path.join(dir, 'corrupt.bin');
+    await native.buildHashAllowlist(hashes('good', 100), table);
+    const bytes = fs.readFileSync(table);
+    bytes[bytes.length - 1] ^= 0xff;
+    fs.writeFileSync(table, bytes);
+
+    expect(native.loadHashAllowlist(table).ok).toBe(true);
+    const verified = native.loadHashAllowlist(table, { verify: true });
+    expect(verified.ok).toBe(false);
+    expect(verified.error).toMatch(/checksum mismatch/);
+  });
+
+  itIfNative('rejects a truncated table', async () => {
+    const table = path.join(dir, 'short.bin');
+    await native.buildHashAllowlist(hashes('good', 100), table);
+    fs.truncateSync(table, fs.statSync(table).size - 32);
+    expect(native.loadHashAllowlist(table).error).toMatch(/corrupt/);
+  });
+
+  itIfNative('handles an empty table', async () => {
+    const table = path.join(dir, 'empty.bin');
+    const built = await native.buildHashAllowlist([], table);
+    expect(built.entries).toBe(0);
+    expect(native.loadHashAllowlist(table, { verify: true }).ok).toBe(true);
+    expect(native.isHashAllowlisted(native.hashBuffer('x'))).toBe(false);
+  });
+
+  itIfNative('returns false with no table loaded', () => {
+    expect(native.isHashAllowlisted(native.hashBuffer('x'))).toBe(false);
+    expect(native.getHashAllowlistInfo()!.loaded).toBe(false);
+  });
+
+  itIfNative('rejects malformed digests', async () => {
+    expect(() => native.isHashAllowlisted('abc')).toThrow(TypeError);
+    expect(() => native.isHashAllowlisted(Buffer.alloc(16))).toThrow(
+      TypeError,
+    );
+    await expect(
+      native.buildHashAllowlist(['zz'], path.join(dir, 'x.bin')),
+    ).rejects.toThrow(/digest 0/);
+    await expect(
+      native.buildHashAllowlist(Buffer.alloc(31), path.join(dir, 'x.bin')),
+    ).rejects.toBeInstanceOf(TypeError);
+  });
+});
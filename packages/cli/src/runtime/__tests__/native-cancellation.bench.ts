@@ -0,0 +1,89 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Cancellation Benchmarks (Linux)
+ *
+ * Run with `npm run bench -- native-cancellation`.
+ *
+ * - full: hashing a 256 MB file / snapshotting a 10,000-file tree
+ * - aborted: the same call aborted straight after it starts; the time is
+ *   how long the caller waits for the rejection
+ * - armed: a deadline and a signal that never fire, to show that the
+ *   checks cost nothing measurable
+ */
+
+import { bench, describe } from 'vitest';
+import * as fs from 'node:fs';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import * as native from '../windows/native.js';
+
+const isLinux =
+  process.platform === 'linux' && native.isNativeModuleAvailable();
+
+let dir = '';
+let tree = '';
+let largeFile = '';
+if (isLinux) {
+  dir = fs.mkdtempSync(path.join(os.tmpdir(), 'terminai-cancel-bench-'));
+  tree = path.join(dir, 'tree');
+  for (let d = 0; d < 50; d++) {
+    const sub = path.join(tree, `d${d}`);
+    fs.mkdirSync(sub, { recursive: true });
+    for (let f = 0; f < 200; f++) {
+      fs.writeFileSync(path.join(sub, `f${f}.txt`), `file ${d}/${f}`);
+    }
+  }
+  largeFile = path.join(dir, 'large.bin');
+  fs.writeFileSync(largeFile, Buffer.alloc(256 * 1024 * 1024, 0x5a));
+  process.on('exit', () => fs.rmSync(dir, { recursive: true, force: true }));
+}
+
+async function aborted<T>(start: (signal: AbortSignal) => Promise<T>) {
+  const controller = new AbortController();
+  const pending = start(controller.signal);
+  controller.abort();
+  await pending.catch(() => undefined);
+}
+
+describe.skipIf(!isLinux)('hash a 256 MB file', () => {
+  bench('full', async () => {
+    await native.hashFile(largeFile);
+  });
+
+  bench('aborted', async () => {
+    await aborted((signal) => native.hashFile(largeFile, { signal }));
+  });
+
+  bench('armed, never fires', async () => {
+    await native.hashFile(largeFile, {
+      timeoutMs: 60000,
+      signal: new AbortController().signal,
+    });
+  });
+});
+
+describe.skipIf(!isLinux)('snapshot a 10,000-file tree (cold)', () => {
+  bench('full', async () => {
+    native.clearSnapshotCache();
+    await native.snapshotDirectory(tree);
+  });
+
+  bench('aborted', async () => {
+    native.clearSnapshotCache();
+    await aborted((signal) => native.snapshotDirectory(tree, { signal }));
+  });
+
+  bench('armed, never fires', async () => {
+    native.clearSnapshotCache();
+    await native.snapshotDirectory(tree, {
+      timeoutMs: 60000,
+      signal: new AbortController().signal,
+    });
+  });
+});
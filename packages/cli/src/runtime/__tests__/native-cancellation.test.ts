@@ -0,0 +1,204 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Cancellation Tests (Linux)
+ *
+ * Deadlines and AbortSignals on long-running native operations: the error
+ * a stopped operation rejects with, how quickly it stops under load, that
+ * a stopped snapshot leaves no partial manifest behind, and the counters.
+ * Skipped when the native module is not built.
+ */
+
+import { describe, it, expect, beforeAll, afterAll } from 'vitest';
+import * as fs from 'node:fs';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import * as native from '../windows/native.js';
+
+const isLinux =
+  process.platform === 'linux' && native.isNativeModuleAvailable();
+const canSandbox = isLinux && native.getLinuxSandboxSupport().userNamespaces;
+const itIfLinux = isLinux ? it : it.skip;
+const itIfSandbox = canSandbox ? it : it.skip;
+
+const DIRECTORIES = 50;
+const FILES = 200;
+const LARGE_FILE_BYTES = 256 * 1024 * 1024;
+
+describe('Native Cancellation', () => {
+  let dir: string;
+  let tree: string;
+  let largeFile: string;
+
+  beforeAll(() => {
+    if (!isLinux) return;
+    dir = fs.mkdtempSync(path.join(os.tmpdir(), 'terminai-cancel-'));
+    tree = path.join(dir, 'tree');
+    for (let d = 0; d < DIRECTORIES; d++) {
+      const sub = path.join(tree, `d${d}`);
+      fs.mkdirSync(sub, { recursive: true });
+      for (let f = 0; f < FILES; f++) {
+        fs.writeFileSync(path.join(sub, `f${f}.txt`), `file ${d}/${f}`);
+      }
+    }
+    largeFile = path.join(dir, 'large.bin');
+    const fd = fs.openSync(largeFile, 'w');
+    const chunk = Buffer.alloc(8 * 1024 * 1024, 0x5a);
+    for (let written = 0; written < LARGE_FILE_BYTES; written += chunk.length) {
+      fs.writeSync(fd, chunk);
+    }
+    fs.closeSync(fd);
+  });
+
+  afterAll(() => {
+    if (dir) fs.rmSync(dir, { recursive: true, force: true });
+  });
+
+  itIfLinux('rejects with a TimeoutError past the deadline', async () => {
+    const error = await native
+      .snapshotDirectory(tree, { timeoutMs: 0 })
+      .catch((e: Error & { code?: string }) => e);
+    expect(error).toBeInstanceOf(Error);
+    expect((error as Error).name).toBe('TimeoutError');
+    expect((error as { code?: string }).code).toBe('ETIMEDOUT');
+    expect((error as Error).message).toContain('deadline exceeded');
+  });
+
+  itIfLinux('rejects with an AbortError for an aborted signal', async () => {
+    const controller = new AbortController();
+    controller.abort();
+    const error = await native
+      .hashFile(largeFile, { signal: controller.signal })
+      .catch((e: Error) => e);
+    expect((error as Error).name).toBe('AbortError');
+    expect((error as { code?: string }).code).toBe('ABORT_ERR');
+  });
+
+  itIfLinux('stops a large hash shortly after abort', async () => {
+    const started = performance.now();
+    const full = await native.hashFile(largeFile);
+    const fullMs = performance.now() - started;
+    expect(full).toMatch(/^[0-9a-f]{64}$/);
+
+    const controller = new AbortController();
+    const pending = native.hashFile(largeFile, { signal: controller.signal });
+    const abortedAt = performance.now();
+    controller.abort();
+    await expect(pending).rejects.toMatchObject({ name: 'AbortError' });
+    // Well within the time a full hash takes.
+    expect(performance.now() - abortedAt).toBeLessThan(
+      Math.max(fullMs / 2, 50),
+    );
+  });
+
+  itIfLinux('leaves no partial manifest behind', async () => {
+    native.clearSnapshotCache();
+    await expect(
+      native.snapshotDirectory(tree, { timeoutMs: 0 }),
+    ).rejects.toMatchObject({ name: 'TimeoutError' });
+
+    const snapshot = await native.snapshotDirectory(tree);
+    expect(snapshot.files).toBe(DIRECTORIES * FILES);
+    expect(snapshot.reusedFiles).toBe(0);
+  });
+
+  itIfLinux('completes when nothing stops it', async () => {
+    const controller = new AbortController();
+    const snapshot = await native.snapshotDirectory(tree, {
+      timeoutMs: 60000,
+      signal: controller.signal,
+    });
+    expect(snapshot.files).toBe(DIRECTORIES * FILES);
+    // Aborting after completion changes nothing.
+    controller.abort();
+  });
+
+  itIfLinux('stops concurrent operations under load', async () => {
+    const controller = new AbortController();
+    const { signal } = controller;
+    native.clearSnapshotCache();
+    const pending = [
+      native.hashFile(largeFile, { signal }),
+      native.hashFile(largeFile, { signal, threads: 1 }),
+      native.snapshotDirectory(tree, { signal }),
+      native.snapshotDirectory(tree, { signal, threads: 1 }),
+    ];
+    controller.abort();
+    const results = await Promise.allSettled(pending);
+    for (const result of results) {
+      expect(result.status).toBe('rejected');
+      expect((result as PromiseRejectedResult).reason.name).toBe(
+        'AbortError',
+      );
+    }
+  });
+
+  itIfLinux('counts started, cancelled and expired operations', async () => {
+    const before = native.getCancellationStats().snapshotDirectory;
+    const controller = new AbortController();
+    controller.abort();
+    await native
+      .snapshotDirectory(tree, { signal: controller.signal })
+      .catch(() => undefined);
+    await native
+      .snapshotDirectory(tree, { timeoutMs: 0 })
+      .catch(() => undefined);
+    await native.snapshotDirectory(tree);
+
+    const after = native.getCancellationStats().snapshotDirectory;
+    expect(after.started - before.started).toBe(3);
+    expect(after.cancelled - before.cancelled).toBe(1);
+    expect(after.expired - before.expired).toBe(1);
+    expect(after.completed - before.completed).toBe(1);
+  });
+
+  itIfLinux('rejects malformed options with a TypeError', async () => {
+    await expect(
+      native.snapshotDirectory(tree, { timeoutMs: -1 }),
+    ).rejects.toBeInstanceOf(TypeError);
+    await expect(
+      native.hashFile(largeFile, {
+        signal: {} as unknown as AbortSignal,
+      }),
+    ).rejects.toBeInstanceOf(TypeError);
+  });
+
+  itIfSandbox('aborts a wait without killing the process', async () => {
+    const pid = native.createLinuxSandbox({
+      command: ['sleep', '30'],
+      workspacePath: dir,
+    });
+    expect(pid).toBeGreaterThan(0);
+    try {
+      const controller = new AbortController();
+      const wait = native.waitLinuxSandbox(pid, { signal: controller.signal });
+      setTimeout(() => controller.abort(), 20);
+      await expect(wait).rejects.toMatchObject({ name: 'AbortError' });
+
+      const timed = await native.waitLinuxSandbox(pid, { timeoutMs: 20 });
+      expect(timed.timedOut).toBe(true);
+    } finally {
+      process.kill(pid, 'SIGKILL');
+      await native.waitLinuxSandbox(pid, 5000);
+    }
+  });
+
+  itIfSandbox('refuses to launch with an aborted signal', () => {
+    const controller = new AbortController();
+    controller.abort();
+    const before = native.getCancellationStats().launchSandbox;
+    const pid = native.createLinuxSandbox({
+      command: ['true'],
+      workspacePath: dir,
+      signal: controller.signal,
+    });
+    expect(pid).toBe(-7);
+    const after = native.getCancellationStats().launchSandbox;
+    expect(after.cancelled - before.cancelled).toBe(1);
+  });
+});
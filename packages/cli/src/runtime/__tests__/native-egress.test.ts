@@ -0,0 +1,432 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Egress Proxy Tests (Linux)
+ *
+ * Runs createEgressProxy against local stand-in upstreams: CONNECT tunnels
+ * to allowed and denied hosts, the private address check, the SNI check on
+ * a handcrafted ClientHello, plain HTTP forwarding, the rate limit, the
+ * connection limit, Unix socket listeners, byte accounting and invalid
+ * options. A sandbox session with `egress` is launched into and must reach
+ * its upstream through the proxy and nothing else.
+ */
+
+import { describe, it, expect, beforeEach, afterEach } from 'vitest';
+import * as fs from 'node:fs';
+import * as net from 'node:net';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import * as native from '../windows/native.js';
+
+const isLinux =
+  process.platform === 'linux' && native.isNativeModuleAvailable();
+const itIfLinux = isLinux ? it : it.skip;
+const canSandbox = isLinux && native.getLinuxSandboxSupport().userNamespaces;
+const itIfSandbox = canSandbox ? it : it.skip;
+
+/** Echoes what it receives; `received` counts the bytes. */
+async function echoServer(): Promise<{ server: net.Server; port: number }> {
+  const server = net.createServer((socket) => socket.pipe(socket));
+  await new Promise<void>((resolve) => server.listen(0, '127.0.0.1', resolve));
+  return { server, port: (server.address() as net.AddressInfo).port };
+}
+
+/** Resolves with everything the socket sends until it closes. */
+function readAll(socket: net.Socket): Promise<Buffer> {
+  return new Promise((resolve) => {
+    const chunks: Buffer[] = [];
+    socket.on('data', (chunk) => chunks.push(chunk));
+    socket.on('error', () => resolve(Buffer.concat(chunks)));
+    socket.on('close', () => resolve(Buffer.concat(chunks)));
+  });
+}
+
+/** Send a request line to the proxy; resolves with its response header. */
+function request(
+  target: { port: number } | { path: string },
+  head: string,
+): Promise<{ socket: net.Socket; status: number; rest: Buffer }> {
+  return new Promise((resolve, reject) => {
+    const socket =
+      'port' in target
+        ? net.connect(target.port, '127.0.0.1')
+        : net.connect(target.path);
+    let buffer = Buffer.alloc(0);
+    const onData = (chunk: Buffer) => {
+      buffer = Buffer.concat([buffer, chunk]);
+      const end = buffer.indexOf('\r\n\r\n');
+      if (end < 0) return;
+      socket.off('data', onData);
+      socket.pause();
+      const status = Number(buffer.toString('latin1', 9, 12));
+      resolve({ socket, status, rest: buffer.subarray(end + 4) });
+    };
+    socket.on('data', onData);
+    socket.on('error', reject);
+    socket.write(`${head}\r\n\r\n`);
+  });
+}
+
+/** A TLS 1.3-shaped ClientHello record carrying `serverName`. */
+function clientHello(serverName: string): Buffer {
+  const name = Buffer.from(serverName);
+  const entry = Buffer.concat([
+    Buffer.from([0, name.length >> 8, name.length & 0xff]),
+    name,
+  ]);
+  const list = Buffer.concat([
+    Buffer.from([entry.length >> 8, entry.length & 0xff]),
+    entry,
+  ]);
+  const extension = Buffer.concat([
+    Buffer.from([0, 0, list.length >> 8, list.length & 0xff]),
+    list,
+  ]);
+  const body = Buffer.concat([
+    Buffer.from([3, 3]),
+    Buffer.alloc(32, 7),
+    Buffer.from([0, 0, 2, 0x13, 0x01, 1, 0]),
+    Buffer.from([extension.length >> 8, extension.length & 0xff]),
+    extension,
+  ]);
+  const handshake = Buffer.concat([
+    Buffer.from([1, 0, body.length >> 8, body.length & 0xff]),
+    body,
+  ]);
+  return Buffer.concat([
+    Buffer.from([0x16, 3, 1, handshake.length >> 8, handshake.length & 0xff]),
+    handshake,
+  ]);
+}
+
+describe('Native Egress Proxy', () => {
+  let upstream: { server: net.Server; port: number };
+  const proxies: string[] = [];
+
+  function createProxy(
+    options: native.EgressProxyOptions,
+  ): native.EgressProxyHandle {
+    const proxy = native.createEgressProxy(options);
+    proxies.push(proxy.id);
+    return proxy;
+  }
+
+  beforeEach(async () => {
+    if (!isLinux) return;
+    upstream = await echoServer();
+  });
+
+  afterEach(() => {
+    if (!isLinux) return;
+    for (const id of proxies.splice(0)) native.closeEgressProxy(id);
+    upstream.server.close();
+  });
+
+  itIfLinux('tunnels CONNECT to allowed hosts and counts bytes', async () => {
+    const proxy = createProxy({ allow: [`127.0.0.1:${upstream.port}`] });
+    const { socket, status } = await request(
+      { port: proxy.port! },
+      `CONNECT 127.0.0.1:${upstream.port} HTTP/1.1`,
+    );
+    expect(status).toBe(200);
+    const echoed = readAll(socket);
+    socket.resume();
+    socket.end('hello through the proxy');
+    expect((await echoed).toString()).toBe('hello through the proxy');
+
+    const stats = native.getEgressProxyStats(proxy.id)!;
+    expect(stats).toMatchObject({
+      listeners: 1,
+      connections: 1,
+      denied: 0,
+      bytesUp: 23,
+      bytesDown: 23,
+    });
+    expect(stats.hosts).toEqual([
+      {
+        host: '127.0.0.1',
+        connections: 1,
+        denied: 0,
+        bytesUp: 23,
+        bytesDown: 23,
+      },
+    ]);
+  });
+
+  itIfLinux('denies hosts and ports outside the allowlist', async () => {
+    const proxy = createProxy({ allow: [`127.0.0.1:${upstream.port}`] });
+    const port = await request(
+      { port: proxy.port! },
+      `CONNECT 127.0.0.1:${upstream.port + 1} HTTP/1.1`,
+    );
+    expect(port.status).toBe(403);
+    const host = await request(
+      { port: proxy.port! },
+      `CONNECT example.invalid:443 HTTP/1.1`,
+    );
+    expect(host.status).toBe(403);
+    port.socket.destroy();
+    host.socket.destroy();
+    expect(native.getEgressProxyStats(proxy.id)!.denied).toBe(2);
+  });
+
+  itIfLinux('refuses private addresses unless they are listed', async () => {
+    const open = createProxy({ allow: ['*'] });
+    for (const target of ['127.0.0.1', 'localhost', '[::1]']) {
+      const { socket, status } = await request(
+        { port: open.port! },
+        `CONNECT ${target}:${upstream.port} HTTP/1.1`,
+      );
+      expect(status).toBe(403);
+      socket.destroy();
+    }
+
+    const trusted = createProxy({ allow: ['localhost'], allowPrivate: true });
+    const { socket, status } = await request(
+      { port: trusted.port! },
+      `CONNECT localhost:${upstream.port} HTTP/1.1`,
+    );
+    expect(status).toBe(200);
+    socket.destroy();
+  });
+
+  itIfLinux('checks the SNI of tunneled TLS', async () => {
+    const proxy = createProxy({
+      allow: [`127.0.0.1:${upstream.port}`, `*.good.test:${upstream.port}`],
+    });
+    const tunnel = () =>
+      request(
+        { port: proxy.port! },
+        `CONNECT 127.0.0.1:${upstream.port} HTTP/1.1`,
+      );
+
+    const good = await tunnel();
+    const hello = clientHello('API.good.test');
+    const echoed = readAll(good.socket);
+    good.socket.resume();
+    // Split mid-record: the proxy waits for the whole ClientHello.
+    good.socket.write(hello.subarray(0, 20));
+    await new Promise((resolve) => setTimeout(resolve, 50));
+    good.socket.end(hello.subarray(20));
+    expect((await echoed).equals(hello)).toBe(true);
+
+    const bad = await tunnel();
+    const dropped = readAll(bad.socket);
+    bad.socket.resume();
+    bad.socket.write(clientHello('evil.test'));
+    expect((await dropped).length).toBe(0);
+
+    const stats = native.getEgressProxyStats(proxy.id)!;
+    expect(stats.denied).toBe(1);
+    expect(stats.hosts.find((host) => host.host === 'evil.test')).toEqual(
+      expect.objectContaining({ denied: 1 }),
+    );
+  });
+
+  itIfLinux('forwards plain HTTP requests in origin form', async () => {
+    let seen = '';
+    const server = net.createServer((socket) => {
+      socket.once('data', (chunk) => {
+        seen = chunk.toString();
+        socket.end('HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok');
+      });
+    });
+    await new Promise<void>((resolve) =>
+      server.listen(0, '127.0.0.1', resolve),
+    );
+    const port = (server.address() as net.AddressInfo).port;
+    const proxy = createProxy({ allow: ['127.0.0.1'] });
+
+    const { socket, status, rest } = await request(
+      { port: proxy.port! },
+      `GET http://127.0.0.1:${port}/a?b=1 HTTP/1.1\r\n` +
+        `Host: 127.0.0.1:${port}\r\nProxy-Authorization: Basic eA==\r\n` +
+        'Connection: keep-alive',
+    );
+    expect(status).toBe(200);
+    socket.resume();
+    const body = Buffer.concat([rest, await readAll(socket)]).toString();
+    expect(body).toBe('ok');
+    expect(seen).toBe(
+      `GET /a?b=1 HTTP/1.1\r\nHost: 127.0.0.1:${port}\r\n` +
+        'Connection: close\r\n\r\n',
+    );
+    server.close();
+
+    const https = await request(
+      { port: proxy.port! },
+      `GET https://127.0.0.1:${port}/ HTTP/1.1`,
+    );
+    expect(https.status).toBe(400);
+    https.socket.destroy();
+  });
+
+  itIfLinux('limits the rate of each direction', async () => {
+    let received = 0;
+    let done: () => void;
+    const finished = new Promise<void>((resolve) => (done = resolve));
+    const sink = net.createServer((socket) => {
+      socket.on('data', (chunk) => {
+        received += chunk.length;
+        if (received === 256 * 1024) done();
+      });
+    });
+    await new Promise<void>((resolve) => sink.listen(0, '127.0.0.1', resolve));
+    const port = (sink.address() as net.AddressInfo).port;
+    const proxy = createProxy({
+      allow: ['127.0.0.1'],
+      rate: { bytesPerSec: 128 * 1024, burstBytes: 64 * 1024 },
+    });
+
+    const { socket } = await request(
+      { port: proxy.port! },
+      `CONNECT 127.0.0.1:${port} HTTP/1.1`,
+    );
+    const start = Date.now();
+    socket.write(Buffer.alloc(256 * 1024, 1));
+    await finished;
+    const elapsed = Date.now() - start;
+    socket.destroy();
+    sink.close();
+
+    // 64 KiB of burst, then 192 KiB at 128 KiB/s.
+    expect(elapsed).toBeGreaterThanOrEqual(1300);
+    expect(elapsed).toBeLessThan(5000);
+    expect(native.getEgressProxyStats(proxy.id)!.throttled).toBeGreaterThan(0);
+  });
+
+  itIfLinux('answers 503 over the connection limit', async () => {
+    const proxy = createProxy({ allow: ['127.0.0.1'], maxConnections: 1 });
+    const first = await request(
+      { port: proxy.port! },
+      `CONNECT 127.0.0.1:${upstream.port} HTTP/1.1`,
+    );
+    expect(first.status).toBe(200);
+    const second = await request(
+      { port: proxy.port! },
+      `CONNECT 127.0.0.1:${upstream.port} HTTP/1.1`,
+    );
+    expect(second.status).toBe(503);
+    first.socket.destroy();
+    second.socket.destroy();
+    expect(native.getEgressProxyStats(proxy.id)!.failed).toBe(1);
+  });
+
+  itIfLinux('listens on a Unix socket and closes', async () => {
+    const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'terminai-egress-'));
+    const socketPath = path.join(dir, 'proxy.sock');
+    const proxy = native.createEgressProxy({
+      allow: ['127.0.0.1'],
+      listen: { socketPath },
+    });
+    expect(proxy).toMatchObject({ port: null, socketPath });
+    const { socket, status } = await request(
+      { path: socketPath },
+      `CONNECT 127.0.0.1:${upstream.port} HTTP/1.1`,
+    );
+    expect(status).toBe(200);
+    socket.destroy();
+
+    expect(native.closeEgressProxy(proxy.id)).toBe(true);
+    expect(native.closeEgressProxy(proxy.id)).toBe(false);
+    expect(native.getEgressProxyStats(proxy.id)).toBeNull();
+    expect(fs.existsSync(socketPath)).toBe(false);
+    fs.rmSync(dir, { recursive: true, force: true });
+  });
+
+  itIfLinux('rejects invalid options', () => {
+    const create = (options: unknown) => () =>
+      native.createEgressProxy(options as native.EgressProxyOptions);
+    expect(create({})).toThrow(/allow/);
+    expect(create({ allow: ['*.10.0.0.1'] })).toThrow(/allow entry/);
+    expect(create({ allow: ['a.test:0'] })).toThrow(/allow entry/);
+    expect(create({ allow: [], rate: {} })).toThrow(/bytesPerSec/);
+    expect(create({ allow: [], maxConnections: 0 })).toThrow(
+      /maxConnections/,
+    );
+    expect(create({ allow: [], listen: { port: 70000 } })).toThrow(
+      /listen.port/,
+    );
+    expect(native.closeEgressProxy('session:nope')).toBe(false);
+  });
+
+  describe('in a sandbox session', () => {
+    let dir: string;
+
+    beforeEach(() => {
+      if (!canSandbox) return;
+      dir = fs.mkdtempSync(path.join(os.tmpdir(), 'terminai-egress-'));
+    });
+
+    afterEach(async () => {
+      if (!canSandbox) return;
+      await Promise.all(
+        native
+          .listSandboxSessions()
+          .map((session) => native.destroySandboxSession(session.id)),
+      );
+      fs.rmSync(dir, { recursive: true, force: true });
+    });
+
+    itIfSandbox('reaches the network through the proxy only', async () => {
+      await native.createSandboxSession('egress-1', {
+        workspacePath: dir,
+        egress: { allow: [`127.0.0.1:${upstream.port}`], port: 8080 },
+      });
+      // bash's /dev/tcp: a direct connection, then one through the proxy.
+      const script =
+        `(exec 3<>/dev/tcp/127.0.0.1/${upstream.port}) 2>/dev/null ` +
+        '&& echo direct > out.txt; ' +
+        'exec 3<>/dev/tcp/127.0.0.1/8080; ' +
+        `printf 'CONNECT 127.0.0.1:${upstream.port} HTTP/1.1\\r\\n\\r\\n` +
+        "ping\\n' >&3; timeout 2 head -n 3 <&3 >> out.txt; " +
+        'echo "$HTTPS_PROXY" >> out.txt';
+      const pid = native.launchInSandboxSession('egress-1', {
+        command: ['/bin/bash', '-c', script],
+      });
+      expect(pid).toBeGreaterThan(0);
+      await native.waitLinuxSandbox(pid);
+
+      const lines = fs
+        .readFileSync(path.join(dir, 'out.txt'), 'utf8')
+        .split(/\r?\n/);
+      expect(lines).toEqual([
+        'HTTP/1.1 200 Connection established',
+        '',
+        'ping',
+        'http://127.0.0.1:8080',
+        '',
+      ]);
+
+      const info = native.getSandboxSession('egress-1')!;
+      expect(info.egress).toMatchObject({
+        id: 'session:egress-1',
+        connections: 1,
+        bytesUp: 5,
+        bytesDown: 5,
+      });
+      expect(native.getEgressProxyStats('session:egress-1')).not.toBeNull();
+      expect(native.closeEgressProxy('session:egress-1')).toBe(false);
+    });
+
+    itIfSandbox('rejects an invalid egress policy', async () => {
+      await expect(
+        native.createSandboxSession('egress-1', {
+          workspacePath: dir,
+          egress: { allow: ['*'], port: 0 },
+        }),
+      ).rejects.toThrow(/port/);
+      await expect(
+        native.createSandboxSession('egress-1', {
+          workspacePath: dir,
+          egress: { allow: ['bad host'] },
+        }),
+      ).rejects.toThrow(/allow entry/);
+    });
+  });
+});
@@ -0,0 +1,81 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Access Grant Benchmarks (Linux)
+ *
+ * Run with `npm run bench -- native-grants`.
+ *
+ * On a 2,000-file tree:
+ * - first grant: every entry read and written (a new uid each iteration)
+ * - re-verify: cache cleared, every entry read, nothing written
+ * - warm: answered from the verification cache
+ * - subprocess floor: spawning one helper process, the least that each
+ *   icacls check / grant used to cost before any ACL work
+ */
+
+import { bench, describe } from 'vitest';
+import { spawnSync } from 'node:child_process';
+import * as fs from 'node:fs';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import * as native from '../windows/native.js';
+
+const isLinux =
+  process.platform === 'linux' && native.isNativeModuleAvailable();
+
+const DIRECTORIES = 20;
+const FILES = 100;
+
+let dir = '';
+if (isLinux) {
+  dir = fs.mkdtempSync(path.join(os.tmpdir(), 'terminai-grants-bench-'));
+  for (let d = 0; d < DIRECTORIES; d++) {
+    const sub = path.join(dir, `d${d}`);
+    fs.mkdirSync(sub);
+    for (let f = 0; f < FILES; f++) {
+      fs.writeFileSync(path.join(sub, `f${f}.txt`), 'data');
+    }
+  }
+  process.on('exit', () => fs.rmSync(dir, { recursive: true, force: true }));
+}
+
+let nextUid = 20001;
+
+function grant(uid: number): Promise<native.AccessGrantResult> {
+  return native.grantPathAccess({
+    path: dir,
+    principal: `u:${uid}`,
+    rights: 'rx',
+    recursive: true,
+  });
+}
+
+describe.skipIf(!isLinux)('grant rx on a 2,000-file tree', () => {
+  // Each iteration adds an ACL entry to every file; bounded so the ACLs
+  // stay well inside one xattr block.
+  bench(
+    'native, first grant',
+    async () => {
+      await grant(nextUid++);
+    },
+    { iterations: 50, time: 0 },
+  );
+
+  bench('native, re-verify (nothing to write)', async () => {
+    native.clearAccessGrantCache();
+    await grant(20000);
+  });
+
+  bench('native, warm (verification cache)', async () => {
+    await grant(20000);
+  });
+
+  bench('subprocess floor', () => {
+    spawnSync('true');
+  });
+});
@@ -0,0 +1,154 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Access Grant Tests (Linux)
+ *
+ * Exercises the grant engine through POSIX ACLs: check-first writes, the
+ * verification cache, and inheritance into new files. Skipped when the
+ * native module is not built.
+ */
+
+import { describe, it, expect, beforeEach, afterEach } from 'vitest';
+import { spawnSync } from 'node:child_process';
+import * as fs from 'node:fs';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import * as native from '../windows/native.js';
+
+const isLinux =
+  process.platform === 'linux' && native.isNativeModuleAvailable();
+const itIfLinux = isLinux ? it : it.skip;
+// Root bypasses ACLs; an unprivileged uid shows whether they take effect.
+const canDropPrivileges =
+  isLinux &&
+  process.getuid?.() === 0 &&
+  spawnSync('setpriv', ['--version']).status === 0;
+const itIfSetpriv = canDropPrivileges ? it : it.skip;
+
+const UID = 4321;
+const PRINCIPAL = `u:${UID}`;
+
+describe('Native Access Grants', () => {
+  let dir: string;
+
+  beforeEach(() => {
+    dir = fs.mkdtempSync(path.join(os.tmpdir(), 'terminai-grants-'));
+    native.clearAccessGrantCache();
+  });
+
+  afterEach(() => {
+    fs.rmSync(dir, { recursive: true, force: true });
+  });
+
+  /** A directories x files tree; returns the number of entries below dir. */
+  function makeTree(directories: number, files: number): number {
+    for (let d = 0; d < directories; d++) {
+      const sub = path.join(dir, `d${d}`, 'nested');
+      fs.mkdirSync(sub, { recursive: true });
+      for (let f = 0; f < files; f++) {
+        fs.writeFileSync(path.join(sub, `f${f}.txt`), 'data');
+      }
+    }
+    return directories * (2 + files);
+  }
+
+  function grant(): Promise<native.AccessGrantResult> {
+    return native.grantPathAccess({
+      path: dir,
+      principal: PRINCIPAL,
+      rights: 'rx',
+      recursive: true,
+    });
+  }
+
+  itIfLinux('grants a tree and makes new entries inherit', async () => {
+    const entries = makeTree(4, 10);
+    const file = path.join(dir, 'd0', 'nested', 'f0.txt');
+    expect(native.checkPathAccess(file, PRINCIPAL, 'r')).toBe(false);
+
+    const result = await grant();
+    expect(result.cached).toBe(false);
+    expect(result.checked).toBe(entries + 1);
+    expect(result.granted).toBe(entries + 1);
+    expect(result.failed).toBe(0);
+
+    expect(native.checkPathAccess(file, PRINCIPAL, 'r')).toBe(true);
+    expect(native.checkPathAccess(file, PRINCIPAL, 'w')).toBe(false);
+    expect(native.checkPathAccess(dir, PRINCIPAL, 'rx', true)).toBe(true);
+
+    const later = path.join(dir, 'd1', 'later.txt');
+    fs.writeFileSync(later, 'new');
+    expect(native.checkPathAccess(later, PRINCIPAL, 'r')).toBe(true);
+  });
+
+  itIfLinux('answers a warm grant from the cache', async () => {
+    makeTree(2, 5);
+    await grant();
+
+    const warm = await grant();
+    expect(warm.cached).toBe(true);
+    expect(warm.checked).toBe(0);
+
+    // A mode change on the root moves its ctime: verify again, write nothing.
+    fs.chmodSync(dir, 0o750);
+    const changed = await grant();
+    expect(changed.cached).toBe(false);
+    expect(changed.granted).toBe(0);
+  });
+
+  itIfLinux('writes only the entries that lack the grant', async () => {
+    const entries = makeTree(3, 4);
+    await grant();
+
+    // Moved in from elsewhere: keeps its own (empty) ACL.
+    const outside = fs.mkdtempSync(path.join(os.tmpdir(), 'terminai-moved-'));
+    fs.writeFileSync(path.join(outside, 'moved.txt'), 'moved');
+    fs.renameSync(
+      path.join(outside, 'moved.txt'),
+      path.join(dir, 'd2', 'moved.txt'),
+    );
+    fs.rmSync(outside, { recursive: true, force: true });
+
+    native.clearAccessGrantCache();
+    const result = await grant();
+    expect(result.checked).toBe(entries + 2);
+    expect(result.granted).toBe(1);
+  });
+
+  itIfLinux('rejects invalid principals and rights', async () => {
+    await expect(
+      native.grantPathAccess({ path: dir, principal: 'nobody', rights: 'r' }),
+    ).rejects.toThrow(/principal/);
+    await expect(
+      native.grantPathAccess({ path: dir, principal: PRINCIPAL, rights: 'q' }),
+    ).rejects.toThrow();
+    expect(native.checkPathAccess(dir, 'nobody', 'r')).toBe(false);
+  });
+
+  itIfSetpriv('lets the principal read what it was granted', async () => {
+    const file = path.join(dir, 'secret.txt');
+    fs.writeFileSync(file, 'granted');
+    fs.chmodSync(file, 0o600);
+    fs.chmodSync(dir, 0o700);
+
+    const readAs = () =>
+      spawnSync('setpriv', [
+        `--reuid=${UID}`,
+        `--regid=${UID}`,
+        '--clear-groups',
+        'cat',
+        file,
+      ]);
+    expect(readAs().status).not.toBe(0);
+
+    await grant();
+    const read = readAs();
+    expect(read.status).toBe(0);
+    expect(read.stdout.toString()).toBe('granted');
+  });
+});
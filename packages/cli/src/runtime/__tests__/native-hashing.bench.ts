@@ -0,0 +1,103 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Content Hasher Benchmarks (Linux)
+ *
+ * Run with `npm run bench -- native-hashing`.
+ *
+ * Each hashFile iteration reads 256 MiB, so throughput in GB/s is
+ * hz * 0.268. The `threads: 1` case gives per-core throughput; the default
+ * case shows scaling across every core. node:crypto SHA-256 streaming is the
+ * baseline the JS code uses today.
+ */
+
+import { bench, describe } from 'vitest';
+import { createHash } from 'node:crypto';
+import * as fs from 'node:fs';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import * as native from '../windows/native.js';
+
+const hasNative = native.isNativeModuleAvailable();
+const FILE_SIZE = 256 * 1024 * 1024;
+
+const benchDir = fs.mkdtempSync(path.join(os.tmpdir(), 'terminai-hash-bench-'));
+const bigFile = path.join(benchDir, 'big.bin');
+const treeDir = path.join(benchDir, 'tree');
+
+function prepare(): void {
+  const block = Buffer.alloc(1024 * 1024);
+  for (let i = 0; i < block.length; i++) block[i] = (i * 31) & 0xff;
+  const fd = fs.openSync(bigFile, 'w');
+  for (let written = 0; written < FILE_SIZE; written += block.length) {
+    fs.writeSync(fd, block);
+  }
+  fs.closeSync(fd);
+
+  // 20k small files across 200 directories, like a mid-sized repository
+  for (let d = 0; d < 200; d++) {
+    const dir = path.join(treeDir, `pkg${d}`, 'src');
+    fs.mkdirSync(dir, { recursive: true });
+    for (let f = 0; f < 100; f++) {
+      fs.writeFileSync(path.join(dir, `file${f}.ts`), block.subarray(0, 4096));
+    }
+  }
+}
+
+function sha256File(file: string): Promise<string> {
+  return new Promise((resolve, reject) => {
+    const hash = createHash('sha256');
+    fs.createReadStream(file)
+      .on('data', (chunk) => hash.update(chunk))
+      .on('end', () => resolve(hash.digest('hex')))
+      .on('error', reject);
+  });
+}
+
+async function sha256Tree(dir: string): Promise<void> {
+  for (const entry of fs.readdirSync(dir, { withFileTypes: true })) {
+    const full = path.join(dir, entry.name);
+    if (entry.isDirectory()) {
+      await sha256Tree(full);
+    } else {
+      createHash('sha256').update(fs.readFileSync(full)).digest('hex');
+    }
+  }
+}
+
+if (hasNative) prepare();
+process.on('exit', () => fs.rmSync(benchDir, { recursive: true, force: true }));
+
+describe.skipIf(!hasNative)('hashFile (256 MiB)', () => {
+  bench('native BLAKE3, 1 thread', async () => {
+    await native.hashFile(bigFile, { threads: 1 });
+  });
+
+  bench('native BLAKE3, all cores', async () => {
+    await native.hashFile(bigFile);
+  });
+
+  bench('node:crypto SHA-256 stream', async () => {
+    await sha256File(bigFile);
+  });
+});
+
+describe.skipIf(!hasNative)('snapshot (20k files)', () => {
+  bench('native snapshot, cold', async () => {
+    native.clearSnapshotCache();
+    await native.snapshotDirectory(treeDir);
+  });
+
+  bench('native snapshot, warm (stat only)', async () => {
+    await native.snapshotDirectory(treeDir);
+  });
+
+  bench('JS readdir + SHA-256 per file', async () => {
+    await sha256Tree(treeDir);
+  });
+});
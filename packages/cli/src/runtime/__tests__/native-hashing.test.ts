@@ -0,0 +1,119 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Content Hasher Tests
+ *
+ * Verifies BLAKE3 digests against the reference test vectors and the
+ * snapshot cache behaviour. Skipped when the native module is not built.
+ */
+
+import { describe, it, expect, beforeAll, afterAll } from 'vitest';
+import * as fs from 'node:fs';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import * as native from '../windows/native.js';
+
+const hasNative = native.isNativeModuleAvailable();
+const itIfNative = hasNative ? it : it.skip;
+
+/** Reference input from the BLAKE3 test vectors: byte i = i % 251 */
+function vectorInput(length: number): Buffer {
+  const buf = Buffer.alloc(length);
+  for (let i = 0; i < length; i++) buf[i] = i % 251;
+  return buf;
+}
+
+describe('Native Content Hasher', () => {
+  itIfNative('matches BLAKE3 reference vectors', () => {
+    expect(native.hashBuffer(Buffer.alloc(0))).toBe(
+      'af1349b9f5f9a1a6a0404dea36dcc9499bcb25c9adc112b7cc9a93cae41f3262',
+    );
+    expect(native.hashBuffer('abc')).toBe(
+      '6437b3ac38465133ffb63b75273a8db548c558465d79db03fd359c6cd5bd9d85',
+    );
+    expect(native.hashBuffer(vectorInput(1025))).toBe(
+      'd00278ae47eb27b34faecf67b4fe263f82d5412916c1ffd97c8cb7fb814b8444',
+    );
+  });
+
+  itIfNative('hashFile matches hashBuffer across segments', async () => {
+    const file = path.join(os.tmpdir(), `terminai-hash-${process.pid}.bin`);
+    const content = vectorInput(3 * 1024 * 1024 + 17);
+    fs.writeFileSync(file, content);
+    try {
+      const expected = native.hashBuffer(content);
+      expect(await native.hashFile(file)).toBe(expected);
+      expect(await native.hashFile(file, { threads: 1 })).toBe(expected);
+    } finally {
+      fs.rmSync(file, { force: true });
+    }
+  });
+
+  itIfNative('rejects missing files', async () => {
+    await expect(
+      native.hashFile(path.join(os.tmpdir(), 'terminai-does-not-exist')),
+    ).rejects.toThrow();
+  });
+
+  describe('snapshotDirectory', () => {
+    let root: string;
+
+    beforeAll(() => {
+      root = fs.mkdtempSync(path.join(os.tmpdir(), 'terminai-snapshot-'));
+      fs.mkdirSync(path.join(root, 'src', 'nested'), { recursive: true });
+      fs.mkdirSync(path.join(root, '.git'));
+      fs.writeFileSync(path.join(root, 'README.md'), '# readme\n');
+      fs.writeFileSync(path.join(root, 'src', 'a.ts'), 'export const a = 1;\n');
+      fs.writeFileSync(path.join(root, 'src', 'nested', 'b.ts'), 'b\n');
+      fs.writeFileSync(path.join(root, '.git', 'HEAD'), 'ref: main\n');
+    });
+
+    afterAll(() => {
+      fs.rmSync(root, { recursive: true, force: true });
+    });
+
+    itIfNative('produces a stable root and honours excludes', async () => {
+      native.clearSnapshotCache();
+      const first = await native.snapshotDirectory(root, {
+        exclude: ['.git'],
+        includeEntries: true,
+      });
+      native.clearSnapshotCache();
+      const second = await native.snapshotDirectory(root, {
+        exclude: ['.git'],
+      });
+
+      expect(first.root).toMatch(/^[0-9a-f]{64}$/);
+      expect(second.root).toBe(first.root);
+      expect(first.files).toBe(3);
+      expect(first.directories).toBe(3);
+      expect(first.entries?.some((e) => e.path.startsWith('.git'))).toBe(false);
+
+      const withGit = await native.snapshotDirectory(root);
+      expect(withGit.root).not.toBe(first.root);
+    });
+
+    itIfNative('reuses unchanged files and detects edits', async () => {
+      native.clearSnapshotCache();
+      const options = { exclude: ['.git'] };
+      const before = await native.snapshotDirectory(root, options);
+
+      // Let the racy-clean window pass so cached entries become trusted.
+      await new Promise((resolve) => setTimeout(resolve, 20));
+      const warm = await native.snapshotDirectory(root, options);
+      expect(warm.root).toBe(before.root);
+      expect(warm.reusedFiles).toBe(3);
+      expect(warm.hashedBytes).toBe(0);
+
+      fs.appendFileSync(path.join(root, 'src', 'nested', 'b.ts'), 'more\n');
+      const after = await native.snapshotDirectory(root, options);
+      expect(after.root).not.toBe(before.root);
+      expect(after.reusedFiles).toBe(2);
+    });
+  });
+});
@@ -0,0 +1,169 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Script Normalizer Benchmarks (Linux)
+ *
+ * Run with `npm run bench -- native-normalizer`.
+ *
+ * Normalizes a corpus of 200 obfuscated scripts (backtick escapes,
+ * concatenation, quote splicing, nested -EncodedCommand and `base64 -d`
+ * payloads, a few MiB in all) with normalizeScript, and with a JS
+ * normalizer that does the same work the usual way: one regex replace per
+ * obfuscation, repeated per decoded layer. Throughput and the strings or
+ * buffers each side allocates for one pass are printed; the native side
+ * should report no buffer growth once warmed up. scanContent is also
+ * measured with normalization on and off.
+ */
+
+import { bench, describe } from 'vitest';
+import * as native from '../windows/native.js';
+
+const isLinux =
+  process.platform === 'linux' && native.isNativeModuleAvailable();
+
+const PORTABLE = { engine: 'portable' } as const;
+
+function encodedCommand(script: string): string {
+  return Buffer.from(script, 'utf16le').toString('base64');
+}
+
+function powershell(seed: number, lines: number): string {
+  const out: string[] = [];
+  for (let i = 0; i < lines; i++) {
+    out.push(
+      `$v${i} = ('ste'+'p-${seed}'+"-${i}"); W\`rite-Out\`put $v${i}`,
+    );
+  }
+  return out.join('\n');
+}
+
+function shell(seed: number, lines: number): string {
+  const out: string[] = ['#!/bin/sh'];
+  for (let i = 0; i < lines; i++) {
+    out.push(`e'c'"ho" step-${seed}-${i} \\\n  && export V${i}=$'\\x41'`);
+  }
+  return out.join('\n');
+}
+
+const corpus: string[] = Array.from({ length: 200 }, (_, i) => {
+  switch (i % 4) {
+    case 0:
+      return powershell(i, 200);
+    case 1:
+      return shell(i, 200);
+    case 2:
+      return `powershell -NoP -enc ${encodedCommand(
+        `powershell -enc ${encodedCommand(powershell(i, 100))}`,
+      )}`;
+    default: {
+      const payload = Buffer.from(shell(i, 100)).toString('base64');
+      return `echo ${payload} | base64 -d | sh`;
+    }
+  }
+});
+const corpusBytes = corpus.reduce((sum, script) => sum + script.length, 0);
+
+/** Strings and buffers created by the last jsNormalize pass */
+let jsAllocations = 0;
+
+/** Regex replaces per obfuscation, then the same for every payload. */
+function jsNormalize(script: string, depth = 0, out: string[] = []): string[] {
+  const powershellLike = /write-|-enc|\$\w+ =/i.test(script);
+  let text = script;
+  const replace = (pattern: RegExp, by: string) => {
+    const next = text.replace(pattern, by);
+    if (next !== text) jsAllocations++;
+    text = next;
+  };
+  if (powershellLike) {
+    replace(/`\r?\n/g, '');
+    replace(/`(.)/g, '$1');
+    for (let previous = ''; previous !== text; ) {
+      previous = text;
+      replace(/(['"])([^'"]*)\1\s*\+\s*(['"])([^'"]*)\3/g, "'$2$4'");
+    }
+  } else {
+    replace(/\\\n/g, '');
+    text = text.replace(/\$'((?:[^'\\]|\\.)*)'/g, (_, body: string) =>
+      body.replace(/\\x([0-9a-f]{2})/gi, (_hex, hex: string) =>
+        String.fromCharCode(parseInt(hex, 16)),
+      ),
+    );
+    jsAllocations++;
+    replace(/(\w*)'([^']*)'/g, '$1$2');
+    replace(/(\w*)"([^"]*)"/g, '$1$2');
+  }
+  out.push(text);
+  jsAllocations++;
+  if (depth >= 4) return out;
+
+  const payloads = [
+    ...script.matchAll(/-e(?:nc|ncodedcommand)?\s+([A-Za-z0-9+/=]{8,})/gi),
+  ].map((match) => {
+    jsAllocations += 2;
+    return Buffer.from(match[1], 'base64').toString('utf16le');
+  });
+  for (const match of script.matchAll(
+    /echo\s+([A-Za-z0-9+/=]{8,})\s*\|\s*base64\s+-d/g,
+  )) {
+    jsAllocations += 2;
+    payloads.push(Buffer.from(match[1], 'base64').toString('utf8'));
+  }
+  for (const payload of payloads) jsNormalize(payload, depth + 1, out);
+  return out;
+}
+
+if (isLinux) {
+  // One pass each to compare allocations.
+  jsAllocations = 0;
+  for (const script of corpus) jsNormalize(script);
+  console.log(`js: ${jsAllocations} strings/buffers for one pass`);
+
+  for (const script of corpus) native.normalizeScript(script);
+  const before = native.getScriptNormalizerStats()!;
+  for (const script of corpus) native.normalizeScript(script);
+  const after = native.getScriptNormalizerStats()!;
+  console.log(
+    `native: ${after.layers - before.layers} layers, ` +
+      `${after.decoded - before.decoded} payloads, ` +
+      `${after.bufferGrowths - before.bufferGrowths} buffer growths ` +
+      `for one warm pass over ${(corpusBytes / 1048576).toFixed(1)} MiB`,
+  );
+}
+
+describe.skipIf(!isLinux)('normalize 200 obfuscated scripts', () => {
+  bench('normalizeScript', () => {
+    for (const script of corpus) native.normalizeScript(script);
+  });
+
+  bench('JS regex passes', () => {
+    for (const script of corpus) jsNormalize(script);
+  });
+});
+
+describe.skipIf(!isLinux)('scanContent over the corpus', () => {
+  const scanAll = () =>
+    Promise.all(corpus.map((script) => native.scanContent(script, PORTABLE)));
+
+  bench('normalizing', scanAll, {
+    setup: () => {
+      native.configureScanPipeline({ cache: { enabled: false } });
+    },
+    teardown: () => native.configureScanPipeline({}),
+  });
+
+  bench('input only', scanAll, {
+    setup: () => {
+      native.configureScanPipeline({
+        cache: { enabled: false },
+        normalize: { enabled: false },
+      });
+    },
+    teardown: () => native.configureScanPipeline({}),
+  });
+});
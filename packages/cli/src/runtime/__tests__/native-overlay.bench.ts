@@ -0,0 +1,81 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Overlay Workspace Benchmarks (Linux)
+ *
+ * Run with `npm run bench -- native-overlay`.
+ *
+ * Measures the cost of preparing a disposable workspace and running a
+ * trivial command in it, for a small and a large synthetic tree. The
+ * overlay cases should take the same time for both sizes; the copy
+ * baseline (what disposable runs need today) grows with the tree.
+ */
+
+import { bench, describe } from 'vitest';
+import * as fs from 'node:fs';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import * as native from '../windows/native.js';
+
+const support = native.isNativeModuleAvailable()
+  ? native.getLinuxSandboxSupport()
+  : { userNamespaces: false, overlay: false };
+const hasOverlay = support.userNamespaces && support.overlay;
+
+const benchDir = fs.mkdtempSync(
+  path.join(os.tmpdir(), 'terminai-overlay-bench-'),
+);
+const stateRoot = path.join(benchDir, 'state');
+
+function makeTree(root: string, files: number): void {
+  const payload = Buffer.alloc(2048, 0x61);
+  for (let i = 0; i < files; i++) {
+    const dir = path.join(root, `pkg${i % 100}`, 'src');
+    if (i < 100) fs.mkdirSync(dir, { recursive: true });
+    fs.writeFileSync(path.join(dir, `file${i}.ts`), payload);
+  }
+}
+
+const trees = [
+  { name: '1k files', root: path.join(benchDir, 'small'), files: 1000 },
+  { name: '50k files', root: path.join(benchDir, 'large'), files: 50000 },
+];
+
+if (hasOverlay) {
+  for (const tree of trees) makeTree(tree.root, tree.files);
+}
+process.on('exit', () => fs.rmSync(benchDir, { recursive: true, force: true }));
+
+for (const tree of trees) {
+  describe.skipIf(!hasOverlay)(`disposable workspace (${tree.name})`, () => {
+    bench('overlay: create + run `true` + discard', async () => {
+      const overlay = native.createOverlayWorkspace(tree.root, stateRoot);
+      const pid = native.createLinuxSandbox({
+        command: ['true'],
+        overlayId: overlay.id,
+      });
+      await native.waitLinuxSandbox(pid);
+      native.discardOverlayWorkspace(overlay.id);
+    });
+
+    bench(
+      'copy: cpSync + run `true` + rmSync',
+      async () => {
+        const copy = path.join(benchDir, 'copy');
+        fs.cpSync(tree.root, copy, { recursive: true });
+        const pid = native.createLinuxSandbox({
+          command: ['true'],
+          workspacePath: copy,
+        });
+        await native.waitLinuxSandbox(pid);
+        fs.rmSync(copy, { recursive: true, force: true });
+      },
+      { iterations: 3 },
+    );
+  });
+}
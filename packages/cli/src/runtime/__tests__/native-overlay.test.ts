@@ -0,0 +1,145 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Overlay Workspace Tests (Linux)
+ *
+ * Runs a sandboxed shell on a copy-on-write overlay and checks that the
+ * workspace is untouched until commit. Skipped when the native module is
+ * not built or user namespaces / overlayfs are unavailable.
+ */
+
+import { describe, it, expect, beforeEach, afterEach } from 'vitest';
+import * as fs from 'node:fs';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import * as native from '../windows/native.js';
+
+const support = native.isNativeModuleAvailable()
+  ? native.getLinuxSandboxSupport()
+  : { userNamespaces: false, overlay: false };
+const itIfOverlay = support.userNamespaces && support.overlay ? it : it.skip;
+
+describe('Native Overlay Workspace', () => {
+  let base: string;
+  let workspace: string;
+
+  beforeEach(() => {
+    base = fs.mkdtempSync(path.join(os.tmpdir(), 'terminai-overlay-'));
+    workspace = path.join(base, 'ws');
+    fs.mkdirSync(path.join(workspace, 'gone'), { recursive: true });
+    fs.writeFileSync(path.join(workspace, 'keep.txt'), 'keep\n');
+    fs.writeFileSync(path.join(workspace, 'edit.txt'), 'v1\n');
+    fs.writeFileSync(path.join(workspace, 'gone', 'old.txt'), 'old\n');
+  });
+
+  afterEach(() => {
+    fs.rmSync(base, { recursive: true, force: true });
+  });
+
+  async function runOnOverlay(id: string, script: string): Promise<void> {
+    const pid = native.createLinuxSandbox({
+      command: ['sh', '-c', script],
+      overlayId: id,
+    });
+    expect(pid).toBeGreaterThan(0);
+    const exit = await native.waitLinuxSandbox(pid, 10000);
+    expect(exit).toMatchObject({ exitCode: 0, timedOut: false });
+  }
+
+  itIfOverlay('isolates writes and reports them as a diff', async () => {
+    const overlay = native.createOverlayWorkspace(
+      workspace,
+      path.join(base, 'state'),
+    );
+    await runOnOverlay(
+      overlay.id,
+      'echo v2 > edit.txt && echo hi > new.txt && rm -r gone',
+    );
+
+    expect(fs.readFileSync(path.join(workspace, 'edit.txt'), 'utf8')).toBe(
+      'v1\n',
+    );
+    expect(fs.existsSync(path.join(workspace, 'new.txt'))).toBe(false);
+
+    const changes = await native.diffOverlayWorkspace(overlay.id);
+    expect(changes.map((c) => [c.path, c.kind])).toEqual([
+      ['edit.txt', 'modified'],
+      ['gone', 'deleted'],
+      ['new.txt', 'added'],
+    ]);
+    expect(native.discardOverlayWorkspace(overlay.id)).toBe(true);
+  });
+
+  itIfOverlay('commits changes into the workspace', async () => {
+    const overlay = native.createOverlayWorkspace(
+      workspace,
+      path.join(base, 'state'),
+    );
+    await runOnOverlay(
+      overlay.id,
+      'echo v2 > edit.txt && mkdir -p a/b && echo x > a/b/x && rm -r gone',
+    );
+
+    const result = await native.commitOverlayWorkspace(overlay.id);
+    expect(result).toMatchObject({ written: 2, removed: 1 });
+    expect(fs.readFileSync(path.join(workspace, 'edit.txt'), 'utf8')).toBe(
+      'v2\n',
+    );
+    expect(fs.readFileSync(path.join(workspace, 'a/b/x'), 'utf8')).toBe('x\n');
+    expect(fs.existsSync(path.join(workspace, 'gone'))).toBe(false);
+    expect(fs.existsSync(path.join(workspace, 'keep.txt'))).toBe(true);
+
+    // The overlay is reset and reusable after commit.
+    expect(await native.diffOverlayWorkspace(overlay.id)).toEqual([]);
+    native.discardOverlayWorkspace(overlay.id);
+  });
+
+  itIfOverlay('refuses to commit while the sandbox runs', async () => {
+    const overlay = native.createOverlayWorkspace(
+      workspace,
+      path.join(base, 'state'),
+    );
+    const pid = native.createLinuxSandbox({
+      command: ['sleep', '5'],
+      overlayId: overlay.id,
+    });
+    try {
+      await expect(native.commitOverlayWorkspace(overlay.id)).rejects.toThrow(
+        /in use/,
+      );
+    } finally {
+      process.kill(pid, 'SIGKILL');
+      await native.waitLinuxSandbox(pid);
+      native.discardOverlayWorkspace(overlay.id);
+    }
+  });
+
+  itIfOverlay('mounts paths with overlayfs separators in them', async () => {
+    const odd = path.join(base, 'ws,1:a\\b');
+    fs.mkdirSync(odd);
+    fs.writeFileSync(path.join(odd, 'keep.txt'), 'keep\n');
+    const overlay = native.createOverlayWorkspace(
+      odd,
+      path.join(base, 'state,2'),
+    );
+    await runOnOverlay(overlay.id, 'cat keep.txt && echo hi > new.txt');
+
+    expect(fs.existsSync(path.join(odd, 'new.txt'))).toBe(false);
+    const changes = await native.diffOverlayWorkspace(overlay.id);
+    expect(changes.map((c) => [c.path, c.kind])).toEqual([
+      ['new.txt', 'added'],
+    ]);
+    native.discardOverlayWorkspace(overlay.id);
+  });
+
+  itIfOverlay('rejects a state root inside the workspace', () => {
+    expect(() =>
+      native.createOverlayWorkspace(workspace, path.join(workspace, '.s')),
+    ).toThrow(/outside the workspace/);
+  });
+});
@@ -0,0 +1,143 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Tiered Scan Pipeline Benchmarks (Linux)
+ *
+ * Run with `npm run bench -- native-pipeline`.
+ *
+ * A mixed broker workload of 1000 scans with the portable engine and a
+ * 10000-rule database loaded: 80% one-line commands, 15% generated
+ * scripts of about 20 KiB drawn from a pool of 20, and 5% 1 MiB bundles.
+ * The default tiers are measured against every scan going straight to
+ * the engine, and the tier hit rates of one pass are printed.
+ */
+
+import { bench, describe } from 'vitest';
+import * as fs from 'node:fs';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import * as native from '../windows/native.js';
+
+const isLinux =
+  process.platform === 'linux' && native.isNativeModuleAvailable();
+
+const PORTABLE = { engine: 'portable' } as const;
+const DIRECT: native.ScanPipelinePolicy = {
+  allowlist: { enabled: false },
+  cache: { enabled: false },
+  classifier: { enabled: false },
+};
+
+const COMMANDS = [
+  'ls -la',
+  'git status --porcelain',
+  'npm test',
+  'echo done',
+  'cat package.json',
+  'Get-ChildItem -Recurse',
+];
+
+function script(seed: number, bytes: number): string {
+  const lines: string[] = [];
+  for (let size = 0, i = 0; size < bytes; i++) {
+    const line = `Write-Output "step ${seed}-${i}: value=$($env:HOME)"`;
+    lines.push(line);
+    size += line.length + 1;
+  }
+  return lines.join('\n');
+}
+
+const scripts = Array.from({ length: 20 }, (_, i) => script(i, 20 * 1024));
+const bundles = Array.from({ length: 4 }, (_, i) =>
+  Buffer.from(script(100 + i, 1024 * 1024)),
+);
+
+const workload: Array<string | Buffer> = Array.from(
+  { length: 1000 },
+  (_, i) => {
+    if (i % 20 === 0) return bundles[(i / 20) % bundles.length];
+    if (i % 20 < 4) return scripts[(i * 7) % scripts.length];
+    return `${COMMANDS[i % COMMANDS.length]} # ${i % 50}`;
+  },
+);
+
+let dir = '';
+if (isLinux) {
+  dir = fs.mkdtempSync(path.join(os.tmpdir(), 'terminai-pipeline-bench-'));
+  process.on('exit', () => {
+    native.unloadRuleDatabase();
+    fs.rmSync(dir, { recursive: true, force: true });
+  });
+  const rules = Array.from({ length: 10000 }, (_, i) => ({
+    name: `Rule-${i}`,
+    pattern: `sig-${i.toString(36)}-payload`,
+  }));
+  const db = path.join(dir, 'rules.db');
+  await native.compileRuleDatabase(rules, db);
+  native.loadRuleDatabase(db);
+
+  // One pass to show where decisions are made.
+  native.configureScanPipeline({});
+  native.resetScanPipelineStats({ cache: true });
+  for (const content of workload) await native.scanContent(content, PORTABLE);
+  const { tiers } = native.getScanPipelineStats()!;
+  for (const [tier, stats] of Object.entries(tiers)) {
+    console.log(
+      `${tier}: ${stats.scans} scans, ${stats.clean + stats.detected} ` +
+        `decided, p50 ${stats.latencyUs.p50}us, p99 ${stats.latencyUs.p99}us`,
+    );
+  }
+}
+
+async function scanAll(): Promise<void> {
+  await Promise.all(
+    workload.map((content) => native.scanContent(content, PORTABLE)),
+  );
+}
+
+describe.skipIf(!isLinux)('mixed workload (1000 scans)', () => {
+  bench('tiered (default policy)', scanAll, {
+    setup: () => {
+      native.configureScanPipeline({});
+      native.resetScanPipelineStats({ cache: true });
+    },
+  });
+
+  bench('engine only', scanAll, {
+    setup: () => native.configureScanPipeline(DIRECT),
+    teardown: () => native.configureScanPipeline({}),
+  });
+});
+
+describe.skipIf(!isLinux)('one-line command', () => {
+  bench(
+    'tiered (classifier)',
+    async () => {
+      await native.scanContent('git status --porcelain', PORTABLE);
+    },
+    {
+      setup: () =>
+        native.configureScanPipeline({
+          cache: { enabled: false },
+          classifier: { emit: ['clean'] },
+        }),
+      teardown: () => native.configureScanPipeline({}),
+    },
+  );
+
+  bench(
+    'engine only',
+    async () => {
+      await native.scanContent('git status --porcelain', PORTABLE);
+    },
+    {
+      setup: () => native.configureScanPipeline(DIRECT),
+      teardown: () => native.configureScanPipeline({}),
+    },
+  );
+});
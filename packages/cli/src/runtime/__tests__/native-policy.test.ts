@@ -0,0 +1,166 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Command Policy Tests
+ *
+ * Verifies rule precedence, glob/cwd/env matching and hot reload of the
+ * compiled command policy. Skipped when the native module is not built.
+ */
+
+import { describe, it, expect, afterEach } from 'vitest';
+import * as fs from 'node:fs';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import * as native from '../windows/native.js';
+
+const hasNative = native.isNativeModuleAvailable();
+const itIfNative = hasNative ? it : it.skip;
+
+const POLICY = `
+default deny
+allow git-read   cmd=git args="status*" cwd=/work/repo
+allow npm-ci     cmd=npm args=ci env=CI=true
+deny  no-preload cmd=* env=LD_PRELOAD
+allow node       cmd=node env=!NODE_OPTIONS
+allow usr-bin    cmd=/usr/bin/ls*
+`;
+
+describe('Native Command Policy', () => {
+  afterEach(() => {
+    if (hasNative) native.unloadCommandPolicy();
+  });
+
+  itIfNative('returns null when no policy is loaded', () => {
+    expect(native.evaluateCommandPolicy({ command: 'echo' })).toBeNull();
+  });
+
+  itIfNative('applies allow rules with args and cwd', () => {
+    expect(native.compileCommandPolicy(POLICY)).toMatchObject({
+      ok: true,
+      rules: 5,
+    });
+
+    const allowed = native.evaluateCommandPolicy({
+      command: 'git',
+      args: ['status', '-s'],
+      cwd: '/work/repo/src',
+    });
+    expect(allowed).toMatchObject({ allowed: true, ruleId: 'git-read' });
+
+    const escaped = native.evaluateCommandPolicy({
+      command: 'git',
+      args: ['status'],
+      cwd: '/work/repo/../other',
+    });
+    expect(escaped).toMatchObject({ allowed: false, action: 'default' });
+  });
+
+  itIfNative('lets deny rules override earlier allows', () => {
+    native.compileCommandPolicy(POLICY);
+    const decision = native.evaluateCommandPolicy({
+      command: 'git',
+      args: ['status'],
+      cwd: '/work/repo',
+      env: { LD_PRELOAD: '/tmp/x.so' },
+    });
+    expect(decision).toMatchObject({ allowed: false, ruleId: 'no-preload' });
+  });
+
+  itIfNative('matches env constraints and path globs', () => {
+    native.compileCommandPolicy(POLICY);
+    const evaluate = (request: native.CommandPolicyRequest) =>
+      native.evaluateCommandPolicy(request)?.allowed;
+
+    const ci = { CI: 'true' };
+    const nodeOptions = { NODE_OPTIONS: '-r x' };
+    expect(evaluate({ command: 'npm', args: ['ci'], env: ci })).toBe(true);
+    expect(evaluate({ command: 'npm', args: ['ci'] })).toBe(false);
+    expect(evaluate({ command: 'node' })).toBe(true);
+    expect(evaluate({ command: 'node', env: nodeOptions })).toBe(false);
+    expect(evaluate({ command: '/usr/bin/lsblk' })).toBe(true);
+    expect(evaluate({ command: 'lsblk' })).toBe(false);
+  });
+
+  itIfNative('matches variable names the way the platform does', () => {
+    native.compileCommandPolicy(POLICY);
+    const decision = native.evaluateCommandPolicy({
+      command: 'git',
+      args: ['status'],
+      cwd: '/work/repo',
+      env: { ld_preload: '/tmp/x.so' },
+    });
+    // Windows variable names ignore case; elsewhere this is another variable.
+    expect(decision?.allowed).toBe(process.platform !== 'win32');
+  });
+
+  itIfNative('matches bare-name allow rules against bare names only', () => {
+    native.compileCommandPolicy(`
+default deny
+allow git   cmd=git
+deny  no-rm cmd=rm
+`);
+    const evaluate = (command: string) =>
+      native.evaluateCommandPolicy({ command })?.allowed;
+
+    expect(evaluate('git')).toBe(true);
+    expect(evaluate('./git')).toBe(false);
+    expect(evaluate('sub/git')).toBe(false);
+    expect(evaluate('/ws/evil/git')).toBe(false);
+    expect(evaluate('sub\\git')).toBe(false);
+
+    // Deny rules still catch a path to the named command.
+    const rm = native.evaluateCommandPolicy({ command: '/bin/rm' });
+    expect(rm).toMatchObject({ allowed: false, ruleId: 'no-rm' });
+  });
+
+  itIfNative('reports compile errors with line numbers', () => {
+    const result = native.compileCommandPolicy('allow a cmd=x\nallow a\n');
+    expect(result.ok).toBe(false);
+    expect(result.error).toMatch(/line 2: duplicate rule id/);
+  });
+
+  itIfNative('hot-reloads a watched file, keeping it on error', async () => {
+    const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'terminai-policy-'));
+    const file = path.join(dir, 'policy.rules');
+    fs.writeFileSync(file, 'allow echo cmd=echo\n');
+    try {
+      const loaded = native.loadCommandPolicy(file, { watchIntervalMs: 10 });
+      expect(loaded.ok).toBe(true);
+      expect(native.evaluateCommandPolicy({ command: 'ls' })?.allowed).toBe(
+        false,
+      );
+
+      fs.writeFileSync(file, 'allow echo cmd=echo\nallow ls cmd=ls\n');
+      await expect
+        .poll(() => native.evaluateCommandPolicy({ command: 'ls' })?.allowed)
+        .toBe(true);
+
+      fs.writeFileSync(file, 'allow broken cmd=\n');
+      fs.utimesSync(file, 1e9, 1e9);
+      await expect
+        .poll(() => native.getCommandPolicyInfo()?.lastError)
+        .toMatch(/line 1/);
+      expect(native.getCommandPolicyInfo()).toMatchObject({
+        loaded: true,
+        rules: 2,
+        version: loaded.version + 1,
+      });
+
+      // Same size and mtime as the broken one, like a write caught halfway:
+      // the failed load must not have been taken as the file's final state.
+      fs.writeFileSync(file, 'allow pwd cmd=pwd\n');
+      fs.utimesSync(file, 1e9, 1e9);
+      await expect
+        .poll(() => native.evaluateCommandPolicy({ command: 'pwd' })?.allowed)
+        .toBe(true);
+      expect(native.getCommandPolicyInfo()?.lastError).toBeFalsy();
+    } finally {
+      fs.rmSync(dir, { recursive: true, force: true });
+    }
+  });
+});
@@ -0,0 +1,105 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Pseudo-Terminal Benchmarks (Linux)
+ *
+ * Run with `npm run bench -- native-pty`.
+ *
+ * - Keystroke to echo: one byte written to a session running `cat`, until
+ *   the terminal's echo of it arrives in onData.
+ * - Sustained output: 16 MiB from `head -c`, start to onExit.
+ *
+ * Both against child_process with pipes, which is what host-side execute
+ * uses today (no terminal, so `cat` itself does the echoing).
+ */
+
+import { bench, describe } from 'vitest';
+import { spawn } from 'node:child_process';
+import * as native from '../windows/native.js';
+
+const isLinux =
+  process.platform === 'linux' && native.isNativeModuleAvailable();
+
+const OUTPUT_BYTES = 16 * 1024 * 1024;
+
+let onEcho: (() => void) | null = null;
+let echoPid = 0;
+const echoPipe = isLinux ? spawn('cat') : null;
+echoPipe?.stdout?.on('data', () => onEcho?.());
+
+if (isLinux) {
+  echoPid = native.createPty({
+    command: ['cat'],
+    onData: () => onEcho?.(),
+    onExit: () => {},
+  });
+}
+
+process.on('exit', () => {
+  if (echoPid > 0) native.closePty(echoPid);
+  echoPipe?.kill();
+});
+
+function nextEcho(): Promise<void> {
+  return new Promise((resolve) => {
+    onEcho = () => {
+      onEcho = null;
+      resolve();
+    };
+  });
+}
+
+describe.skipIf(!isLinux)('keystroke to echo', () => {
+  bench('native pty', async () => {
+    const echoed = nextEcho();
+    native.writePty(echoPid, 'x');
+    await echoed;
+  });
+
+  bench('child_process pipes', async () => {
+    const echoed = nextEcho();
+    echoPipe!.stdin!.write('x');
+    await echoed;
+  });
+});
+
+describe.skipIf(!isLinux)('sustained output (16 MiB)', () => {
+  bench(
+    'native pty',
+    async () => {
+      let received = 0;
+      await new Promise<void>((resolve) => {
+        native.createPty({
+          command: ['head', '-c', String(OUTPUT_BYTES), '/dev/zero'],
+          onData: (chunk) => {
+            received += chunk.length;
+          },
+          onExit: () => resolve(),
+        });
+      });
+      if (received !== OUTPUT_BYTES) throw new Error(`got ${received} bytes`);
+    },
+    { iterations: 10 },
+  );
+
+  bench(
+    'child_process pipes',
+    async () => {
+      let received = 0;
+      await new Promise<void>((resolve) => {
+        const child = spawn('head', ['-c', String(OUTPUT_BYTES), '/dev/zero']);
+        child.stdout.on('data', (chunk: Buffer) => {
+          received += chunk.length;
+        });
+        child.on('close', () => resolve());
+      });
+      if (received !== OUTPUT_BYTES) throw new Error(`got ${received} bytes`);
+    },
+    { iterations: 10 },
+  );
+});
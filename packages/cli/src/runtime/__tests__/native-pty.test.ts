@@ -0,0 +1,172 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Pseudo-Terminal Tests (Linux)
+ *
+ * Runs shells on a native terminal, both on the host and in the sandbox,
+ * and checks terminal semantics (tty, size, echo, SIGWINCH, hangup),
+ * output ordering and the zero-copy delivery contract.
+ */
+
+import { describe, it, expect, beforeAll, afterAll } from 'vitest';
+import * as fs from 'node:fs';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import * as native from '../windows/native.js';
+
+const isLinux =
+  process.platform === 'linux' && native.isNativeModuleAvailable();
+const canSandbox = isLinux && native.getLinuxSandboxSupport().userNamespaces;
+const itIfSandbox = canSandbox ? it : it.skip;
+
+interface Session {
+  pid: number;
+  /** Everything received so far */
+  output: () => string;
+  /** Resolves once `text` has appeared in the output */
+  waitFor: (text: string) => Promise<void>;
+  exit: Promise<native.PtyExit>;
+  chunks: Buffer[];
+}
+
+function start(
+  script: string,
+  options: Partial<native.PtyOptions> = {},
+): Session {
+  let output = '';
+  const chunks: Buffer[] = [];
+  const waiters: Array<{ text: string; resolve: () => void }> = [];
+  let resolveExit!: (exit: native.PtyExit) => void;
+  const exit = new Promise<native.PtyExit>((resolve) => {
+    resolveExit = resolve;
+  });
+
+  const pid = native.createPty({
+    command: ['sh', '-c', script],
+    ...options,
+    onData: (chunk) => {
+      chunks.push(chunk);
+      output += chunk.toString('utf8');
+      for (const waiter of waiters.filter((w) => output.includes(w.text))) {
+        waiters.splice(waiters.indexOf(waiter), 1);
+        waiter.resolve();
+      }
+    },
+    onExit: resolveExit,
+  });
+  expect(pid).toBeGreaterThan(0);
+
+  return {
+    pid,
+    output: () => output,
+    waitFor: (text) =>
+      output.includes(text)
+        ? Promise.resolve()
+        : new Promise((resolve) => waiters.push({ text, resolve })),
+    exit,
+    chunks,
+  };
+}
+
+describe.skipIf(!isLinux)('Native Pseudo-Terminal', () => {
+  let dir: string;
+
+  beforeAll(() => {
+    dir = fs.mkdtempSync(path.join(os.tmpdir(), 'terminai-pty-'));
+  });
+
+  afterAll(() => {
+    fs.rmSync(dir, { recursive: true, force: true });
+  });
+
+  it('runs the process on a terminal of the requested size', async () => {
+    const session = start('tty; stty size; exit 7', { cols: 132, rows: 43 });
+    const exit = await session.exit;
+    expect(exit).toEqual({ exitCode: 7, signal: null });
+    expect(session.output()).toMatch(/\/dev\/pts\/\d+/);
+    expect(session.output()).toContain('43 132');
+  });
+
+  it('echoes input and delivers it to the process', async () => {
+    const session = start('read line; echo "got:$line"; read done');
+    // Split writes are batched into one flush where possible.
+    expect(native.writePty(session.pid, 'hel')).toBe(true);
+    expect(native.writePty(session.pid, Buffer.from('lo\r'))).toBe(true);
+    await session.waitFor('got:hello');
+    const stats = native.getPtyStats(session.pid);
+    native.writePty(session.pid, '\r');
+    await session.exit;
+
+    // Terminal echo, then the reply, with \n translated to \r\n
+    expect(session.output()).toBe('hello\r\ngot:hello\r\n\r\n');
+    expect(stats?.writeCalls).toBe(2);
+    expect(stats?.writeSyscalls).toBeLessThanOrEqual(2);
+    expect(stats?.bytesWritten).toBe(6);
+    expect(stats?.chunks).toBeGreaterThan(0);
+    expect(native.writePty(session.pid, 'x')).toBe(false);
+  });
+
+  it('notifies the foreground process of a resize', async () => {
+    const session = start(
+      "trap 'stty size; exit 0' WINCH; echo ready; " +
+        'while :; do sleep 0.05; done',
+    );
+    await session.waitFor('ready');
+    expect(native.resizePty(session.pid, 100, 50)).toBe(true);
+    await session.exit;
+    expect(session.output()).toContain('50 100');
+  });
+
+  it('delivers all output before the exit, in order', async () => {
+    // 8 MiB of numbered lines: larger than every slab together, so the
+    // slabs are reused many times.
+    const session = start('seq 1 1000000');
+    const exit = await session.exit;
+    expect(exit.exitCode).toBe(0);
+
+    const lines = session.output().split('\r\n');
+    expect(lines.length).toBe(1000001);
+    expect(lines[0]).toBe('1');
+    expect(lines[999999]).toBe('1000000');
+    const stats = native.getPtyStats(session.pid);
+    expect(stats).toBeNull(); // Forgotten once onExit has run
+  });
+
+  it('reuses the chunk memory once onData returns', async () => {
+    const session = start('echo ready; read done');
+    await session.waitFor('ready');
+    const stats = native.getPtyStats(session.pid);
+    native.writePty(session.pid, '\r');
+    await session.exit;
+
+    expect(stats?.chunks).toBeGreaterThan(0);
+    if (stats?.copiedChunks === 0) {
+      // Lent slabs are detached after the callback: kept views are empty.
+      expect(session.chunks.every((chunk) => chunk.length === 0)).toBe(true);
+    }
+  });
+
+  it('hangs up the terminal', async () => {
+    const session = start('echo ready; while :; do sleep 0.05; done');
+    await session.waitFor('ready');
+    native.closePty(session.pid);
+    const exit = await session.exit;
+    expect(exit.signal).toBe(1); // SIGHUP
+  });
+
+  itIfSandbox('runs sandboxed sessions in the user namespace', async () => {
+    const session = start('tty; cat /proc/self/uid_map; exit 0', {
+      sandbox: { workspacePath: dir, capabilities: { network: false } },
+    });
+    const exit = await session.exit;
+    expect(exit.exitCode).toBe(0);
+    expect(session.output()).toMatch(/\/dev\/pts\/\d+/);
+    const uid = String(process.getuid!());
+    expect(session.output()).toMatch(new RegExp(`\\s${uid}\\s+${uid}\\s+1`));
+  });
+});
@@ -0,0 +1,70 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Resource Governor Benchmarks (Linux)
+ *
+ * Run with `npm run bench -- native-resources`.
+ *
+ * Cost of one sampling pass over 16 idle sandboxes: the native sampler
+ * (pread on descriptors opened at launch) against the /proc polling a JS
+ * monitor would do (read /proc/<pid>/stat and /proc/<pid>/status for each
+ * process).
+ */
+
+import { bench, describe } from 'vitest';
+import * as fs from 'node:fs';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import * as native from '../windows/native.js';
+
+const canGovern =
+  process.platform === 'linux' &&
+  native.isNativeModuleAvailable() &&
+  native.getResourceGovernorSupport().available &&
+  native.getLinuxSandboxSupport().userNamespaces;
+
+const benchDir = fs.mkdtempSync(
+  path.join(os.tmpdir(), 'terminai-resources-bench-'),
+);
+const pids: number[] = [];
+
+if (canGovern) {
+  for (let i = 0; i < 16; i++) {
+    pids.push(
+      native.createLinuxSandbox({
+        command: ['sleep', '600'],
+        workspacePath: benchDir,
+        resources: { cpuWeight: 100 },
+      }),
+    );
+  }
+}
+
+process.on('exit', () => {
+  for (const pid of pids) {
+    try {
+      process.kill(pid, 'SIGKILL');
+    } catch {
+      // already gone
+    }
+  }
+  fs.rmSync(benchDir, { recursive: true, force: true });
+});
+
+describe.skipIf(!canGovern)('sampling pass (16 sandboxes)', () => {
+  bench('native sampleSandboxResources', () => {
+    for (const pid of pids) native.sampleSandboxResources(pid);
+  });
+
+  bench('JS /proc polling', () => {
+    for (const pid of pids) {
+      fs.readFileSync(`/proc/${pid}/stat`, 'utf8');
+      fs.readFileSync(`/proc/${pid}/status`, 'utf8');
+    }
+  });
+});
@@ -0,0 +1,151 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Resource Governor Tests (Linux)
+ *
+ * Launches sandboxes in their own cgroup and checks accounting, sampling
+ * and, where the host delegates the controllers, limit enforcement. Point
+ * TERMINAI_TEST_CGROUP_ROOT at a delegated, empty cgroup to exercise the
+ * limits; without one only accounting is checked.
+ */
+
+import { describe, it, expect, beforeAll, afterAll } from 'vitest';
+import * as fs from 'node:fs';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import * as native from '../windows/native.js';
+
+const isLinux =
+  process.platform === 'linux' && native.isNativeModuleAvailable();
+if (isLinux && process.env['TERMINAI_TEST_CGROUP_ROOT']) {
+  native.setResourceGovernorRoot(process.env['TERMINAI_TEST_CGROUP_ROOT']);
+}
+const support: native.ResourceGovernorSupport = isLinux
+  ? native.getResourceGovernorSupport()
+  : { available: false, root: '', limits: [] };
+const canGovern =
+  isLinux &&
+  support.available &&
+  native.getLinuxSandboxSupport().userNamespaces;
+const itIfGoverned = canGovern ? it : it.skip;
+const itIfLimit = (limit: keyof native.SandboxResourceLimits) =>
+  canGovern && support.limits.includes(limit) ? it : it.skip;
+
+describe('Native Resource Governor', () => {
+  let dir: string;
+
+  beforeAll(() => {
+    dir = fs.mkdtempSync(path.join(os.tmpdir(), 'terminai-resources-'));
+  });
+
+  afterAll(() => {
+    native.stopResourceSampler();
+    fs.rmSync(dir, { recursive: true, force: true });
+  });
+
+  function launch(
+    script: string,
+    resources: native.SandboxResourceLimits = {},
+  ): number {
+    const pid = native.createLinuxSandbox({
+      command: ['sh', '-c', script],
+      workspacePath: dir,
+      resources,
+    });
+    expect(pid).toBeGreaterThan(0);
+    return pid;
+  }
+
+  async function sampleUntil(
+    pid: number,
+    done: (sample: native.ResourceSample) => boolean,
+  ): Promise<native.ResourceSample | null> {
+    const deadline = Date.now() + 5000;
+    let sample = native.sampleSandboxResources(pid);
+    while (sample && !done(sample) && Date.now() < deadline) {
+      await new Promise((resolve) => setTimeout(resolve, 20));
+      sample = native.sampleSandboxResources(pid);
+    }
+    return sample;
+  }
+
+  itIfGoverned('charges the sandbox for its descendants', async () => {
+    // The busy loop runs in a subshell, which must be accounted too.
+    const pid = launch(
+      '(i=0; while [ $i -lt 100000 ]; do i=$((i+1)); done); sleep 5',
+    );
+    const sample = await sampleUntil(pid, (s) => s.cpuUsageUs > 50000);
+    expect(sample).not.toBeNull();
+    expect(sample!.pid).toBe(pid);
+    expect(sample!.cpuUsageUs).toBeGreaterThan(50000);
+    expect(sample!.pids).toBeGreaterThanOrEqual(1);
+    expect(sample!.memoryPeak).toBeGreaterThan(0);
+
+    process.kill(pid, 'SIGKILL');
+    await native.waitLinuxSandbox(pid, 10000);
+    // Reaping releases the group.
+    expect(native.sampleSandboxResources(pid)).toBeNull();
+  });
+
+  itIfGoverned('delivers samples on a fixed cadence', async () => {
+    const batches: native.ResourceSample[][] = [];
+    native.startResourceSampler(20, (samples) => batches.push(samples));
+    const pid = launch('sleep 0.4');
+    await native.waitLinuxSandbox(pid, 10000);
+    const stats = native.stopResourceSampler();
+
+    const mine = batches.filter((b) => b.some((s) => s.pid === pid));
+    expect(mine.length).toBeGreaterThanOrEqual(5);
+    expect(stats.passes).toBeGreaterThanOrEqual(mine.length);
+    const times = mine.map((b) => b[0].timestamp);
+    for (let i = 1; i < times.length; i++) {
+      expect(times[i]).toBeGreaterThanOrEqual(times[i - 1]);
+    }
+  });
+
+  itIfGoverned('rejects out-of-range limits', () => {
+    expect(
+      native.createLinuxSandbox({
+        command: ['true'],
+        workspacePath: dir,
+        resources: { cpuWeight: 0 },
+      }),
+    ).toBe(-4);
+  });
+
+  itIfLimit('pidsMax')('caps the number of tasks', async () => {
+    const pid = launch('for i in 1 2 3 4 5 6 7 8; do sleep 1 & done; wait', {
+      pidsMax: 4,
+    });
+    const exit = await native.waitLinuxSandbox(pid, 10000);
+    expect(exit.exitCode).not.toBe(0);
+  });
+
+  itIfLimit('memoryMax')('OOM-kills above memoryMax', async () => {
+    const pid = native.createLinuxSandbox({
+      command: [
+        process.execPath,
+        '-e',
+        'Buffer.alloc(256 * 1024 * 1024, 1); setTimeout(() => {}, 1000)',
+      ],
+      workspacePath: dir,
+      resources: { memoryMax: 64 * 1024 * 1024 },
+    });
+    expect(pid).toBeGreaterThan(0);
+    const exit = await native.waitLinuxSandbox(pid, 10000);
+    expect(exit.signal).toBe(9);
+  });
+
+  itIfLimit('cpuQuotaPercent')('throttles above the CPU quota', async () => {
+    const pid = launch('while :; do :; done', { cpuQuotaPercent: 10 });
+    const sample = await sampleUntil(pid, (s) => s.cpuThrottledCount > 0);
+    process.kill(pid, 'SIGKILL');
+    await native.waitLinuxSandbox(pid, 10000);
+    expect(sample?.cpuThrottledCount).toBeGreaterThan(0);
+  });
+});
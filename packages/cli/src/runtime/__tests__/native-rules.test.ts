@@ -0,0 +1,182 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Rule Database Tests (Linux)
+ *
+ * Compiles rule sets with compileRuleDatabase, loads them with
+ * loadRuleDatabase and scans with the portable engine: short and long
+ * rules, binary patterns, reloads, validation and the scan counters.
+ * Skipped when the native module is not built.
+ */
+
+import { describe, it, expect, beforeEach, afterEach } from 'vitest';
+import * as fs from 'node:fs';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import * as native from '../windows/native.js';
+import { zipArchive } from './archive-fixtures.js';
+
+const isLinux =
+  process.platform === 'linux' && native.isNativeModuleAvailable();
+const itIfLinux = isLinux ? it : it.skip;
+
+const PORTABLE = { engine: 'portable' } as const;
+
+function scan(content: string | Buffer) {
+  return native.scanArchive(Buffer.from(content), {
+    ...PORTABLE,
+    name: 'content',
+  });
+}
+
+describe('Native Rule Database', () => {
+  let dir: string;
+
+  beforeEach(() => {
+    if (!isLinux) return;
+    dir = fs.mkdtempSync(path.join(os.tmpdir(), 'terminai-rules-'));
+    native.unloadRuleDatabase();
+  });
+
+  afterEach(() => {
+    if (!isLinux) return;
+    native.unloadRuleDatabase();
+    fs.rmSync(dir, { recursive: true, force: true });
+  });
+
+  itIfLinux('flags content matching a loaded rule', async () => {
+    const db = path.join(dir, 'rules.bin');
+    const built = await native.compileRuleDatabase(
+      [
+        { name: 'Downloader', pattern: 'Invoke-WebRequest -OutFile' },
+        { name: 'Marker', pattern: 'zz' },
+      ],
+      db,
+    );
+    expect(built.rules).toBe(2);
+    expect(built.bytes).toBe(fs.statSync(db).size);
+    expect(native.loadRuleDatabase(db)).toMatchObject({ ok: true, rules: 2 });
+
+    const long = await scan('$x = 1\nInvoke-WebRequest -OutFile a.exe\n');
+    expect(long.clean).toBe(false);
+    expect(long.threats[0].description).toBe('Signature match: Downloader');
+
+    const short = await scan('buzz');
+    expect(short.threats[0].description).toBe('Signature match: Marker');
+
+    expect((await scan('Invoke-WebRequest https://x')).clean).toBe(true);
+  });
+
+  itIfLinux('matches binary patterns inside archive members', async () => {
+    const db = path.join(dir, 'binary.bin');
+    const pattern = Buffer.from([0x4d, 0x5a, 0x90, 0x00, 0x03, 0xff]);
+    await native.compileRuleDatabase([{ name: 'Stub', pattern }], db);
+    native.loadRuleDatabase(db);
+
+    const archive = zipArchive({
+      'ok.txt': 'fine',
+      'bin/tool.exe': Buffer.concat([Buffer.alloc(100), pattern]),
+    });
+    const result = await native.scanArchive(archive, PORTABLE);
+    expect(result.threats).toHaveLength(1);
+    expect(result.threats[0].path).toBe('bin/tool.exe');
+  });
+
+  itIfLinux('scans many rules in one pass', async () => {
+    const rules = Array.from({ length: 20000 }, (_, i) => ({
+      name: `Rule-${i}`,
+      pattern: `sig-${i.toString(36)}-payload`,
+    }));
+    const db = path.join(dir, 'many.bin');
+    await native.compileRuleDatabase(rules, db);
+    native.loadRuleDatabase(db);
+
+    const result = await scan(`${'filler '.repeat(1000)}sig-ab12-payload`);
+    expect(result.threats[0].description).toBe(
+      `Signature match: Rule-${parseInt('ab12', 36)}`,
+    );
+    expect((await scan('filler '.repeat(1000))).clean).toBe(true);
+  });
+
+  itIfLinux('swaps databases on reload', async () => {
+    const db = path.join(dir, 'swap.bin');
+    await native.compileRuleDatabase([{ name: 'Old', pattern: 'alpha' }], db);
+    const v1 = native.loadRuleDatabase(db).version;
+
+    // Recompiling over a mapped database does not disturb it until reloaded.
+    await native.compileRuleDatabase([{ name: 'New', pattern: 'omega' }], db);
+    expect((await scan('alpha')).clean).toBe(false);
+
+    expect(native.loadRuleDatabase(db).version).toBe(v1 + 1);
+    expect((await scan('alpha')).clean).toBe(true);
+    expect((await scan('omega')).clean).toBe(false);
+  });
+
+  itIfLinux('keeps the previous database when a load fails', async () => {
+    const db = path.join(dir, 'ok.bin');
+    await native.compileRuleDatabase([{ name: 'Kept', pattern: 'kept!' }], db);
+    native.loadRuleDatabase(db);
+
+    const garbage = path.join(dir, 'garbage.bin');
+    fs.writeFileSync(garbage, 'not a database');
+    const result = native.loadRuleDatabase(garbage);
+    expect(result.ok).toBe(false);
+    expect(result.error).toMatch(/not a rule database/);
+    expect((await scan('kept!')).clean).toBe(false);
+    expect(native.getRuleDatabaseInfo()!.lastError).toMatch(/garbage/);
+  });
+
+  itIfLinux('detects a corrupted database with verify', async () => {
+    const db = path.join(dir, 'corrupt.bin');
+    await native.compileRuleDatabase([{ name: 'R', pattern: 'pattern' }], db);
+    const bytes = fs.readFileSync(db);
+    bytes[bytes.length - 1] ^= 0xff;
+    fs.writeFileSync(db, bytes);
+
+    const verified = native.loadRuleDatabase(db, { verify: true });
+    expect(verified.ok).toBe(false);
+    expect(verified.error).toMatch(/checksum mismatch/);
+
+    fs.truncateSync(db, bytes.length - 4);
+    expect(native.loadRuleDatabase(db).error).toMatch(/corrupt/);
+  });
+
+  itIfLinux('counts scans and matches', async () => {
+    const db = path.join(dir, 'count.bin');
+    await native.compileRuleDatabase([{ name: 'R', pattern: 'hit me' }], db);
+    native.loadRuleDatabase(db);
+    const before = native.getRuleDatabaseInfo()!;
+
+    await scan('hit me');
+    await scan('miss');
+
+    const info = native.getRuleDatabaseInfo()!;
+    expect(info).toMatchObject({ loaded: true, path: db, rules: 1 });
+    expect(info.scans - before.scans).toBe(2);
+    expect(info.matches - before.matches).toBe(1);
+  });
+
+  itIfLinux('scans without a database loaded', async () => {
+    expect(native.getRuleDatabaseInfo()!.loaded).toBe(false);
+    expect((await scan('anything')).clean).toBe(true);
+  });
+
+  itIfLinux('rejects invalid rules', async () => {
+    const out = path.join(dir, 'x.bin');
+    await expect(
+      native.compileRuleDatabase([{ name: 'E', pattern: '' }], out),
+    ).rejects.toThrow(/empty/);
+    await expect(
+      native.compileRuleDatabase(
+        'nope' as unknown as Array<{ name: string; pattern: string }>,
+        out,
+      ),
+    ).rejects.toBeInstanceOf(TypeError);
+    expect(fs.existsSync(out)).toBe(false);
+  });
+});
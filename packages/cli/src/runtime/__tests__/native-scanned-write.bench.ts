@@ -0,0 +1,85 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Scanned Write Benchmarks (Linux)
+ *
+ * Run with `npm run bench -- native-scanned-write`.
+ *
+ * Writing a 16 MiB payload that must be scanned and hashed, two ways:
+ * - writeFileScanned: one pass, scanned on the pool while it is written
+ * - write, then read back: fs.writeFile, then scanArchive and hashFile on
+ *   the written file, which is what the broker would have to do without it
+ *
+ * Both use the portable engine. Bytes moved through the file per write are
+ * printed after each case: the payload once, against once written plus
+ * twice read back.
+ */
+
+import { bench, describe } from 'vitest';
+import * as fs from 'node:fs';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import * as native from '../windows/native.js';
+import { sourceText } from './archive-fixtures.js';
+
+const isLinux =
+  process.platform === 'linux' && native.isNativeModuleAvailable();
+const PORTABLE = { engine: 'portable' } as const;
+const SIZE = 16 * 1024 * 1024;
+
+let dir = '';
+let payload = Buffer.alloc(0);
+if (isLinux) {
+  dir = fs.mkdtempSync(path.join(os.tmpdir(), 'terminai-swrite-bench-'));
+  payload = sourceText(1, SIZE);
+  process.on('exit', () => fs.rmSync(dir, { recursive: true, force: true }));
+}
+
+let bytesTouched = 0;
+let writes = 0;
+
+function report(label: string): void {
+  if (writes > 0) {
+    console.log(
+      `[scanned-write] ${label}: ` +
+        `${(bytesTouched / writes / SIZE).toFixed(1)}x payload bytes ` +
+        `through the file per write`,
+    );
+  }
+  bytesTouched = 0;
+  writes = 0;
+}
+
+describe.skipIf(!isLinux)('scanned write (16 MiB)', () => {
+  bench(
+    'native writeFileScanned',
+    async () => {
+      const result = await native.writeFileScanned(
+        path.join(dir, 'one-pass.ts'),
+        payload,
+        PORTABLE,
+      );
+      bytesTouched += result.bytesWritten;
+      writes++;
+    },
+    { teardown: () => report('one pass') },
+  );
+
+  bench(
+    'fs.writeFile, then scan and hash the file',
+    async () => {
+      const file = path.join(dir, 'read-back.ts');
+      await fs.promises.writeFile(file, payload);
+      const scan = await native.scanArchive(file, PORTABLE);
+      await native.hashFile(file, { threads: 1 });
+      bytesTouched += SIZE + scan.scannedBytes + SIZE;
+      writes++;
+    },
+    { teardown: () => report('write + read back') },
+  );
+});
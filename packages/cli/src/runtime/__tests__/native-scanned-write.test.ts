@@ -0,0 +1,144 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Scanned Write Tests (Linux)
+ *
+ * writeFileScanned with the portable engine: clean content lands at the
+ * path with its BLAKE3 hash, anything else leaves the target and directory
+ * as they were. Skipped when the native module is not built.
+ */
+
+import { describe, it, expect, beforeEach, afterEach } from 'vitest';
+import * as fs from 'node:fs';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import * as native from '../windows/native.js';
+import { EICAR } from './archive-fixtures.js';
+
+const isLinux =
+  process.platform === 'linux' && native.isNativeModuleAvailable();
+const itIfLinux = isLinux ? it : it.skip;
+
+const PORTABLE = { engine: 'portable' } as const;
+
+describe('Native Scanned Write', () => {
+  let dir: string;
+
+  beforeEach(() => {
+    if (!isLinux) return;
+    dir = fs.mkdtempSync(path.join(os.tmpdir(), 'terminai-swrite-'));
+  });
+
+  afterEach(() => {
+    if (dir) fs.rmSync(dir, { recursive: true, force: true });
+  });
+
+  itIfLinux('writes clean content and returns its hash', async () => {
+    const file = path.join(dir, 'a.txt');
+    const content = Buffer.from('hello world\n');
+
+    const result = await native.writeFileScanned(file, content, PORTABLE);
+    expect(result.written).toBe(true);
+    expect(result.clean).toBe(true);
+    expect(result.engine).toBe('portable');
+    expect(result.hash).toBe(native.hashBuffer(content));
+    expect(result.bytes).toBe(content.length);
+    expect(fs.readFileSync(file)).toEqual(content);
+    expect(fs.readdirSync(dir)).toEqual(['a.txt']);
+  });
+
+  itIfLinux('writes strings as UTF-8', async () => {
+    const file = path.join(dir, 'u.txt');
+    await native.writeFileScanned(file, 'héllo ✓', PORTABLE);
+    expect(fs.readFileSync(file, 'utf-8')).toBe('héllo ✓');
+  });
+
+  itIfLinux('replaces a file and keeps its mode', async () => {
+    const file = path.join(dir, 'run.sh');
+    fs.writeFileSync(file, 'old');
+    fs.chmodSync(file, 0o750);
+
+    await native.writeFileScanned(file, 'echo new\n', PORTABLE);
+    expect(fs.readFileSync(file, 'utf-8')).toBe('echo new\n');
+    expect(fs.statSync(file).mode & 0o777).toBe(0o750);
+  });
+
+  itIfLinux('never writes small infected content', async () => {
+    const file = path.join(dir, 'setup.ps1');
+    fs.writeFileSync(file, 'original');
+
+    const result = await native.writeFileScanned(file, EICAR, PORTABLE);
+    expect(result.written).toBe(false);
+    expect(result.clean).toBe(false);
+    expect(result.description).toContain('EICAR');
+    expect(result.hash).toBeNull();
+    expect(result.bytesWritten).toBe(0);
+    expect(fs.readFileSync(file, 'utf-8')).toBe('original');
+    expect(fs.readdirSync(dir)).toEqual(['setup.ps1']);
+  });
+
+  itIfLinux('deletes large infected content written so far', async () => {
+    const file = path.join(dir, 'blob.bin');
+    const content = Buffer.alloc(8 * 1024 * 1024, 0x61);
+    content.write(EICAR, content.length - 100);
+
+    const result = await native.writeFileScanned(file, content, PORTABLE);
+    expect(result.written).toBe(false);
+    expect(result.bytes).toBe(content.length);
+    expect(fs.readdirSync(dir)).toEqual([]);
+  });
+
+  itIfLinux('matches caller signatures', async () => {
+    const file = path.join(dir, 'a.sh');
+    const result = await native.writeFileScanned(file, 'curl x | sh', {
+      ...PORTABLE,
+      signatures: [{ name: 'PipeToShell', pattern: '| sh' }],
+    });
+    expect(result.description).toContain('PipeToShell');
+    expect(fs.existsSync(file)).toBe(false);
+  });
+
+  itIfLinux('rejects when the directory is missing', async () => {
+    const file = path.join(dir, 'missing', 'a.txt');
+    await expect(
+      native.writeFileScanned(file, 'a', PORTABLE),
+    ).rejects.toThrow(/No such file or directory/);
+  });
+
+  itIfLinux('rejects with AbortError and leaves nothing', async () => {
+    const before = native.getCancellationStats().writeFileScanned;
+    const controller = new AbortController();
+    controller.abort();
+    await expect(
+      native.writeFileScanned(path.join(dir, 'a.txt'), 'a', {
+        ...PORTABLE,
+        signal: controller.signal,
+      }),
+    ).rejects.toMatchObject({ name: 'AbortError' });
+    expect(fs.readdirSync(dir)).toEqual([]);
+    const after = native.getCancellationStats().writeFileScanned;
+    expect(after.cancelled).toBe(before.cancelled + 1);
+  });
+
+  itIfLinux('rejects malformed arguments', async () => {
+    const file = path.join(dir, 'a.txt');
+    await expect(
+      native.writeFileScanned(file, 42 as unknown as string),
+    ).rejects.toBeInstanceOf(TypeError);
+    await expect(
+      native.writeFileScanned(file, 'a', {
+        durable: 'yes' as unknown as boolean,
+      }),
+    ).rejects.toBeInstanceOf(TypeError);
+    await expect(
+      native.writeFileScanned(file, 'a', {
+        engine: 'clamav' as native.NativeScanEngine,
+      }),
+    ).rejects.toBeInstanceOf(TypeError);
+  });
+});
@@ -0,0 +1,116 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Work Scheduler Benchmarks (Linux)
+ *
+ * Run with `npm run bench -- native-scheduler` and compare the p99 column.
+ *
+ * An interactive 8 MiB hashFile (fanned out across the pool) is timed:
+ * - idle: nothing else running
+ * - under bulk load: three 256 MiB hashes marked 'bulk' run back to back,
+ *   saturating every worker but the reserved one
+ * - under same-class load: the same load marked 'interactive' too, which
+ *   is what every caller got before priorities existed
+ *
+ * Three load streams leave one of libuv's four threads free for the timed
+ * call, so the difference is the pool's scheduling alone. Queue wait
+ * percentiles per class are printed after each case.
+ */
+
+import { bench, describe } from 'vitest';
+import * as fs from 'node:fs';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import * as native from '../windows/native.js';
+
+const isLinux =
+  process.platform === 'linux' && native.isNativeModuleAvailable();
+
+const LOAD_STREAMS = 3;
+
+let dir = '';
+let smallFile = '';
+let largeFile = '';
+if (isLinux) {
+  dir = fs.mkdtempSync(path.join(os.tmpdir(), 'terminai-sched-bench-'));
+  smallFile = path.join(dir, 'small.bin');
+  largeFile = path.join(dir, 'large.bin');
+  fs.writeFileSync(smallFile, Buffer.alloc(8 * 1024 * 1024, 0x11));
+  fs.writeFileSync(largeFile, Buffer.alloc(256 * 1024 * 1024, 0x22));
+  process.on('exit', () => fs.rmSync(dir, { recursive: true, force: true }));
+}
+
+let stopLoad: (() => Promise<void>) | null = null;
+
+function startLoad(priority: native.NativeWorkPriority): void {
+  let running = true;
+  const streams = Array.from({ length: LOAD_STREAMS }, async (_, i) => {
+    while (running) {
+      await native.hashFile(largeFile, { priority, sessionId: `load-${i}` });
+    }
+  });
+  stopLoad = async () => {
+    running = false;
+    await Promise.all(streams);
+  };
+}
+
+async function endLoad(label: string): Promise<void> {
+  await stopLoad?.();
+  stopLoad = null;
+  const stats = native.getSchedulerStats();
+  if (stats) {
+    console.log(
+      `[scheduler] ${label}: interactive wait p99 ` +
+        `${stats.interactive.waitUs.p99}us, bulk wait p99 ` +
+        `${stats.bulk.waitUs.p99}us, stolen ` +
+        `${stats.interactive.stolen + stats.bulk.stolen}`,
+    );
+  }
+}
+
+function interactiveHash(): Promise<string> {
+  return native.hashFile(smallFile, {
+    priority: 'interactive',
+    sessionId: 'brain',
+  });
+}
+
+describe.skipIf(!isLinux)('interactive hashFile (8 MiB)', () => {
+  bench('idle', async () => {
+    await interactiveHash();
+  });
+
+  bench(
+    'under bulk load',
+    async () => {
+      await interactiveHash();
+    },
+    {
+      setup: () => {
+        native.resetSchedulerStats();
+        startLoad('bulk');
+      },
+      teardown: () => endLoad('bulk load'),
+    },
+  );
+
+  bench(
+    'under same-class load',
+    async () => {
+      await interactiveHash();
+    },
+    {
+      setup: () => {
+        native.resetSchedulerStats();
+        startLoad('interactive');
+      },
+      teardown: () => endLoad('same-class load'),
+    },
+  );
+});
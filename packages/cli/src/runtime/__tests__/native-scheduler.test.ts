@@ -0,0 +1,132 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Work Scheduler Tests (Linux)
+ *
+ * Priority classes, per-session scheduling options and the scheduler's
+ * counters and histograms. Skipped when the native module is not built.
+ */
+
+import { describe, it, expect, beforeAll, afterAll } from 'vitest';
+import * as fs from 'node:fs';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import * as native from '../windows/native.js';
+
+const isLinux =
+  process.platform === 'linux' && native.isNativeModuleAvailable();
+const itIfLinux = isLinux ? it : it.skip;
+
+describe('Native Work Scheduler', () => {
+  let dir: string;
+  let smallFile: string;
+  let largeFile: string;
+  let tree: string;
+
+  beforeAll(() => {
+    if (!isLinux) return;
+    dir = fs.mkdtempSync(path.join(os.tmpdir(), 'terminai-sched-'));
+    smallFile = path.join(dir, 'small.bin');
+    largeFile = path.join(dir, 'large.bin');
+    fs.writeFileSync(smallFile, Buffer.alloc(4 * 1024 * 1024, 0x11));
+    fs.writeFileSync(largeFile, Buffer.alloc(64 * 1024 * 1024, 0x22));
+    tree = path.join(dir, 'tree');
+    for (let d = 0; d < 20; d++) {
+      const sub = path.join(tree, `d${d}`);
+      fs.mkdirSync(sub, { recursive: true });
+      for (let f = 0; f < 50; f++) {
+        fs.writeFileSync(path.join(sub, `f${f}.txt`), `file ${d}/${f}`);
+      }
+    }
+  });
+
+  afterAll(() => {
+    if (dir) fs.rmSync(dir, { recursive: true, force: true });
+  });
+
+  itIfLinux('reports every class', () => {
+    const stats = native.getSchedulerStats()!;
+    for (const cls of ['interactive', 'normal', 'bulk'] as const) {
+      expect(stats[cls].submitted).toBeGreaterThanOrEqual(0);
+      expect(stats[cls].waitUs).toHaveProperty('p99');
+      expect(Array.isArray(stats[cls].waitHistogram)).toBe(true);
+    }
+    expect(stats.queueCapacity).toBeGreaterThan(0);
+  });
+
+  itIfLinux('queues work in the requested class', async () => {
+    await native.hashFile(smallFile);
+    native.resetSchedulerStats();
+
+    const digest = await native.hashFile(smallFile, {
+      priority: 'interactive',
+      sessionId: 'brain',
+    });
+    expect(digest).toBe(await native.hashFile(smallFile, { threads: 1 }));
+
+    const stats = native.getSchedulerStats()!;
+    expect(stats.started).toBe(true);
+    expect(stats.interactive.submitted).toBeGreaterThan(0);
+    expect(stats.interactive.completed).toBe(stats.interactive.submitted);
+    expect(stats.bulk.submitted).toBe(0);
+    const samples = stats.interactive.waitHistogram.reduce((a, b) => a + b, 0);
+    expect(samples).toBe(stats.interactive.completed);
+  });
+
+  itIfLinux('snapshots default to the bulk class', async () => {
+    native.clearSnapshotCache();
+    native.resetSchedulerStats();
+    const snapshot = await native.snapshotDirectory(tree);
+    expect(snapshot.files).toBe(1000);
+    const stats = native.getSchedulerStats()!;
+    expect(stats.bulk.submitted).toBeGreaterThan(0);
+    expect(stats.interactive.submitted).toBe(0);
+  });
+
+  itIfLinux('finishes interactive work under bulk load', async () => {
+    native.clearSnapshotCache();
+    native.resetSchedulerStats();
+    const load = [
+      native.hashFile(largeFile, { priority: 'bulk', sessionId: 'a' }),
+      native.hashFile(largeFile, { priority: 'bulk', sessionId: 'b' }),
+      native.snapshotDirectory(tree, { sessionId: 'c' }),
+    ];
+
+    const digest = await native.hashFile(smallFile, {
+      priority: 'interactive',
+    });
+    expect(digest).toMatch(/^[0-9a-f]{64}$/);
+    await Promise.all(load);
+
+    const stats = native.getSchedulerStats()!;
+    expect(stats.interactive.completed).toBeGreaterThan(0);
+    expect(stats.bulk.completed).toBeGreaterThan(0);
+    expect(stats.bulk.queued).toBe(0);
+    expect(stats.interactive.queued).toBe(0);
+  });
+
+  itIfLinux('cannot be reconfigured once running', () => {
+    expect(native.configureScheduler({ threads: 2 })).toBe(false);
+    expect(() =>
+      native.configureScheduler({ threads: -1 } as native.SchedulerConfig),
+    ).toThrow(TypeError);
+  });
+
+  itIfLinux('rejects malformed scheduling options', async () => {
+    await expect(
+      native.hashFile(smallFile, {
+        priority: 'urgent' as native.NativeWorkPriority,
+      }),
+    ).rejects.toBeInstanceOf(TypeError);
+    await expect(
+      native.snapshotDirectory(tree, {
+        sessionId: 42 as unknown as string,
+      }),
+    ).rejects.toBeInstanceOf(TypeError);
+  });
+});
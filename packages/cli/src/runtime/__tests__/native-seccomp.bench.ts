@@ -0,0 +1,101 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Seccomp Compiler Benchmarks (Linux)
+ *
+ * Run with `npm run bench -- native-seccomp`.
+ *
+ * - compile: cold compile vs memory cache vs disk cache
+ * - launch: sandbox start-up with no filter, a cached filter, and a filter
+ *   compiled from scratch for every launch
+ * - per-syscall: `dd bs=1` issues ~2 syscalls per byte, so the difference
+ *   between the no-filter, binary-search and linear cases is filter cost
+ */
+
+import { bench, describe } from 'vitest';
+import * as fs from 'node:fs';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import * as native from '../windows/native.js';
+
+const canSandbox =
+  process.platform === 'linux' &&
+  native.isNativeModuleAvailable() &&
+  native.getLinuxSandboxSupport().userNamespaces;
+
+const benchDir = fs.mkdtempSync(
+  path.join(os.tmpdir(), 'terminai-seccomp-bench-'),
+);
+const cacheDir = path.join(benchDir, 'cache');
+process.on('exit', () => fs.rmSync(benchDir, { recursive: true, force: true }));
+
+const profile = { network: false, processSpawn: false };
+
+async function launch(
+  command: string[],
+  capabilities?: native.LinuxSandboxOptions['capabilities'],
+): Promise<void> {
+  const pid = native.createLinuxSandbox({
+    command,
+    workspacePath: benchDir,
+    capabilities,
+  });
+  await native.waitLinuxSandbox(pid);
+}
+
+describe.skipIf(!canSandbox)('compile filter', () => {
+  bench('cold compile', () => {
+    native.setSeccompCacheDirectory('');
+    native.clearSeccompCache();
+    native.compileSeccompFilter(profile);
+  });
+
+  bench('disk cache', () => {
+    native.setSeccompCacheDirectory(cacheDir);
+    native.clearSeccompCache();
+    native.compileSeccompFilter(profile);
+  });
+
+  bench('memory cache', () => {
+    native.setSeccompCacheDirectory(cacheDir);
+    native.compileSeccompFilter(profile);
+  });
+});
+
+describe.skipIf(!canSandbox)('launch `true`', () => {
+  bench('no filter', async () => {
+    await launch(['true']);
+  });
+
+  bench('cached filter', async () => {
+    native.setSeccompCacheDirectory(cacheDir);
+    await launch(['true'], profile);
+  });
+
+  bench('filter compiled per launch', async () => {
+    native.setSeccompCacheDirectory('');
+    native.clearSeccompCache();
+    await launch(['true'], profile);
+  });
+});
+
+describe.skipIf(!canSandbox)('per-syscall cost (200k syscalls)', () => {
+  const dd = ['dd', 'if=/dev/zero', 'of=/dev/null', 'bs=1', 'count=100000'];
+
+  bench('no filter', async () => {
+    await launch(dd);
+  });
+
+  bench('binary-search dispatch', async () => {
+    await launch(dd, profile);
+  });
+
+  bench('linear dispatch', async () => {
+    await launch(dd, { ...profile, dispatch: 'linear' });
+  });
+});
@@ -0,0 +1,127 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Seccomp Compiler Tests (Linux)
+ *
+ * Verifies filter caching, that unsigned disk entries are never used, and
+ * that sandboxed processes are held to their capability profile and cannot
+ * see the cache. Skipped when the native module is not built or the
+ * platform has no user namespaces.
+ */
+
+import { describe, it, expect, beforeAll, afterAll } from 'vitest';
+import * as fs from 'node:fs';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import * as native from '../windows/native.js';
+
+const isLinux =
+  process.platform === 'linux' && native.isNativeModuleAvailable();
+const canSandbox = isLinux && native.getLinuxSandboxSupport().userNamespaces;
+const itIfLinux = isLinux ? it : it.skip;
+const itIfSandbox = canSandbox ? it : it.skip;
+
+describe('Native Seccomp Compiler', () => {
+  let dir: string;
+
+  beforeAll(() => {
+    dir = fs.mkdtempSync(path.join(os.tmpdir(), 'terminai-seccomp-'));
+    if (isLinux) native.setSeccompCacheDirectory(path.join(dir, 'cache'));
+  });
+
+  afterAll(() => {
+    if (isLinux) native.setSeccompCacheDirectory();
+    fs.rmSync(dir, { recursive: true, force: true });
+  });
+
+  itIfLinux('caches compiled filters in memory and on disk', () => {
+    native.clearSeccompCache();
+    const profile = { network: false, processSpawn: false };
+
+    const first = native.compileSeccompFilter(profile);
+    expect(first.source).toBe('compiled');
+    expect(native.compileSeccompFilter(profile).source).toBe('memory');
+
+    native.clearSeccompCache();
+    const fromDisk = native.compileSeccompFilter(profile);
+    expect(fromDisk).toMatchObject({ source: 'disk', hash: first.hash });
+    expect(fs.existsSync(path.join(dir, 'cache', `${first.hash}.bpf`))).toBe(
+      true,
+    );
+
+    const other = native.compileSeccompFilter({ network: true });
+    expect(other.hash).not.toBe(first.hash);
+  });
+
+  itIfLinux('recompiles a corrupted disk entry', () => {
+    native.clearSeccompCache();
+    const { hash } = native.compileSeccompFilter({ filesystemWrite: false });
+    const file = path.join(dir, 'cache', `${hash}.bpf`);
+    const bytes = fs.readFileSync(file);
+    bytes[bytes.length - 3] ^= 0xff;
+    fs.writeFileSync(file, bytes);
+
+    native.clearSeccompCache();
+    expect(
+      native.compileSeccompFilter({ filesystemWrite: false }).source,
+    ).toBe('compiled');
+  });
+
+  itIfLinux('recompiles disk entries it did not sign', () => {
+    native.clearSeccompCache();
+    const cache = path.join(dir, 'cache');
+    const signed = native.compileSeccompFilter({ processSpawn: false });
+    const wanted = native.compileSeccompFilter({ network: false });
+    expect(fs.statSync(cache).mode & 0o777).toBe(0o700);
+    expect(fs.statSync(path.join(cache, 'key')).mode & 0o777).toBe(0o600);
+
+    // A well-formed entry planted under another profile's name.
+    fs.copyFileSync(
+      path.join(cache, `${signed.hash}.bpf`),
+      path.join(cache, `${wanted.hash}.bpf`),
+    );
+    native.clearSeccompCache();
+    expect(native.compileSeccompFilter({ network: false }).source).toBe(
+      'compiled',
+    );
+  });
+
+  async function run(
+    script: string,
+    capabilities: native.SandboxCapabilities,
+  ): Promise<number | null> {
+    const pid = native.createLinuxSandbox({
+      command: ['sh', '-c', script],
+      workspacePath: dir,
+      capabilities,
+    });
+    expect(pid).toBeGreaterThan(0);
+    return (await native.waitLinuxSandbox(pid, 10000)).exitCode;
+  }
+
+  itIfSandbox('blocks writes without filesystemWrite', async () => {
+    const target = path.join(dir, 'written.txt');
+    const script = `echo hi > ${target}`;
+    expect(await run(script, { filesystemWrite: false })).not.toBe(0);
+    expect(fs.existsSync(target)).toBe(false);
+    expect(await run(script, { filesystemWrite: true })).toBe(0);
+    expect(fs.existsSync(target)).toBe(true);
+  });
+
+  itIfSandbox('blocks child processes without processSpawn', async () => {
+    expect(await run('/bin/true', { processSpawn: false })).not.toBe(0);
+    expect(await run('/bin/true', { processSpawn: true })).toBe(0);
+  });
+
+  itIfSandbox('hides the disk cache from sandboxed processes', async () => {
+    const cache = path.join(dir, 'cache');
+    const script = `test -z "$(ls -A ${cache})" && ! touch ${cache}/x.bpf`;
+    expect(await run(script, { network: false })).toBe(0);
+    expect(fs.readdirSync(cache)).toContain('key');
+  });
+});
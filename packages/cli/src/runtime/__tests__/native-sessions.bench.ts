@@ -0,0 +1,67 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Sandbox Session Benchmarks (Linux)
+ *
+ * Run with `npm run bench -- native-sessions`.
+ *
+ * Launch throughput with 32 live sessions: one `true` per session, started
+ * all at once and waited for together, against the same launches made one
+ * after another. Session setup and teardown (32 concurrent creates and
+ * destroys) is measured on its own.
+ */
+
+import { bench, describe } from 'vitest';
+import * as fs from 'node:fs';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import * as native from '../windows/native.js';
+
+const canSandbox =
+  process.platform === 'linux' &&
+  native.isNativeModuleAvailable() &&
+  native.getLinuxSandboxSupport().userNamespaces;
+
+const SESSIONS = 32;
+const ids = Array.from({ length: SESSIONS }, (_, i) => `bench-${i}`);
+const TRUE = { command: ['/bin/true'] };
+
+let dir = '';
+if (canSandbox) {
+  dir = fs.mkdtempSync(path.join(os.tmpdir(), 'terminai-sessions-bench-'));
+  process.on('exit', () => fs.rmSync(dir, { recursive: true, force: true }));
+  await Promise.all(
+    ids.map((id) => native.createSandboxSession(id, { workspacePath: dir })),
+  );
+}
+
+describe.skipIf(!canSandbox)(`launch (${SESSIONS} sessions)`, () => {
+  bench('all sessions at once', async () => {
+    const pids = ids.map((id) => native.launchInSandboxSession(id, TRUE));
+    await Promise.all(pids.map((pid) => native.waitLinuxSandbox(pid)));
+  });
+
+  bench('one session after another', async () => {
+    for (const id of ids) {
+      const pid = native.launchInSandboxSession(id, TRUE);
+      await native.waitLinuxSandbox(pid);
+    }
+  });
+});
+
+describe.skipIf(!canSandbox)(`setup (${SESSIONS} sessions)`, () => {
+  bench('create + destroy concurrently', async () => {
+    const fresh = ids.map((id) => `setup-${id}`);
+    await Promise.all(
+      fresh.map((id) =>
+        native.createSandboxSession(id, { workspacePath: dir }),
+      ),
+    );
+    await Promise.all(fresh.map((id) => native.destroySandboxSession(id)));
+  });
+});
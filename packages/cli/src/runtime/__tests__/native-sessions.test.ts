@@ -0,0 +1,138 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Sandbox Session Tests (Linux)
+ *
+ * Creates named sandbox sessions with createSandboxSession, launches into
+ * them and tears them down: id validation, lookup and enumeration,
+ * concurrent creation, and that destroying one session kills its
+ * processes without touching the others.
+ */
+
+import { describe, it, expect, beforeEach, afterEach } from 'vitest';
+import * as fs from 'node:fs';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import * as native from '../windows/native.js';
+
+const canSandbox =
+  process.platform === 'linux' &&
+  native.isNativeModuleAvailable() &&
+  native.getLinuxSandboxSupport().userNamespaces;
+const itIfSandbox = canSandbox ? it : it.skip;
+
+describe('Native Sandbox Sessions', () => {
+  let dir: string;
+
+  beforeEach(() => {
+    if (!canSandbox) return;
+    dir = fs.mkdtempSync(path.join(os.tmpdir(), 'terminai-sessions-'));
+  });
+
+  afterEach(async () => {
+    if (!canSandbox) return;
+    await Promise.all(
+      native
+        .listSandboxSessions()
+        .map((session) => native.destroySandboxSession(session.id)),
+    );
+    fs.rmSync(dir, { recursive: true, force: true });
+  });
+
+  function launch(id: string, script: string): number {
+    return native.launchInSandboxSession(id, {
+      command: ['/bin/sh', '-c', script],
+    });
+  }
+
+  itIfSandbox('launches into the session workspace', async () => {
+    const created = await native.createSandboxSession('agent-1', {
+      workspacePath: dir,
+    });
+    expect(created).toEqual({
+      id: 'agent-1',
+      workspacePath: dir,
+      sid: null,
+      staged: null,
+    });
+
+    const pid = launch('agent-1', 'pwd > out.txt');
+    expect(pid).toBeGreaterThan(0);
+    expect((await native.waitLinuxSandbox(pid)).exitCode).toBe(0);
+    expect(fs.readFileSync(path.join(dir, 'out.txt'), 'utf8').trim()).toBe(
+      dir,
+    );
+
+    const info = native.getSandboxSession('agent-1')!;
+    expect(info).toMatchObject({ id: 'agent-1', launches: 1, failures: 0 });
+    expect(info.createdAt).toBeLessThanOrEqual(Date.now());
+  });
+
+  itIfSandbox('rejects duplicate and invalid ids', async () => {
+    await native.createSandboxSession('dup', { workspacePath: dir });
+    await expect(
+      native.createSandboxSession('dup', { workspacePath: dir }),
+    ).rejects.toThrow(/already exists/);
+    await expect(
+      native.createSandboxSession('../escape', { workspacePath: dir }),
+    ).rejects.toThrow(/Invalid session id/);
+    expect(launch('missing', 'true')).toBe(-4);
+  });
+
+  itIfSandbox('keeps workspace, filter and limits per session', async () => {
+    await native.createSandboxSession('fixed', {
+      workspacePath: dir,
+      capabilities: { network: false },
+    });
+    const other = native.launchInSandboxSession('fixed', {
+      command: ['true'],
+      workspacePath: os.tmpdir(),
+    });
+    const limits = native.launchInSandboxSession('fixed', {
+      command: ['true'],
+      resources: { pidsMax: 4 },
+    });
+    expect([other, limits]).toEqual([-4, -4]);
+    expect(native.getSandboxSession('fixed')!.failures).toBe(2);
+  });
+
+  itIfSandbox('creates sessions concurrently', async () => {
+    const ids = Array.from({ length: 24 }, (_, i) => `parallel-${i}`);
+    await Promise.all(
+      ids.map((id) => native.createSandboxSession(id, { workspacePath: dir })),
+    );
+    const listed = native.listSandboxSessions().map((session) => session.id);
+    expect(listed).toEqual([...ids].sort());
+
+    const pids = ids.map((id) => launch(id, 'exit 7'));
+    const exits = await Promise.all(
+      pids.map((pid) => native.waitLinuxSandbox(pid)),
+    );
+    expect(exits.every((exit) => exit.exitCode === 7)).toBe(true);
+  });
+
+  itIfSandbox('destroys one session without touching others', async () => {
+    await native.createSandboxSession('doomed', { workspacePath: dir });
+    await native.createSandboxSession('survivor', { workspacePath: dir });
+    const doomed = launch('doomed', 'sleep 60 & sleep 60');
+    const survivor = launch('survivor', 'sleep 60');
+
+    const result = await native.destroySandboxSession('doomed', 2000);
+    expect(result!.complete).toBe(true);
+    expect((await native.waitLinuxSandbox(doomed)).signal).toBe(9);
+    expect(native.getSandboxSession('doomed')).toBeNull();
+    expect(await native.destroySandboxSession('doomed')).toBeNull();
+
+    const alive = await native.waitLinuxSandbox(survivor, 100);
+    expect(alive.timedOut).toBe(true);
+    expect(native.getSandboxSession('survivor')!.running).toBeGreaterThan(0);
+
+    // The id is free again once the teardown has finished.
+    await native.createSandboxSession('doomed', { workspacePath: dir });
+  });
+});
@@ -0,0 +1,112 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Process Spawner Benchmarks
+ *
+ * Run with `npm run bench -- native-spawn`.
+ *
+ * Runs 100 short commands, one after another and all at once, with
+ * spawnProcess and with the child_process handler broker execute requests
+ * used before it (environment merged per call, a JS timer per command,
+ * output gathered from stream events). Linux only: the commands are
+ * /bin/true and /bin/echo.
+ */
+
+import { bench, describe } from 'vitest';
+import { spawn } from 'node:child_process';
+import * as native from '../windows/native.js';
+
+const enabled =
+  native.isNativeModuleAvailable() && process.platform === 'linux';
+
+const COMMANDS = 100;
+
+interface Executed {
+  exitCode: number;
+  stdout: string;
+}
+
+/** The previous execute handler, minus policy checks and responses */
+function childProcessExecute(
+  command: string,
+  args: string[],
+  timeout = 30000,
+): Promise<Executed> {
+  return new Promise((resolve) => {
+    const proc = spawn(command, args, {
+      env: { ...process.env, TERMINAI_REQUEST: '1' },
+      shell: false,
+    });
+    let stdout = '';
+    proc.stdout?.on('data', (data) => {
+      stdout += data.toString();
+    });
+    proc.stderr?.on('data', () => {});
+    const timer = setTimeout(() => proc.kill('SIGKILL'), timeout);
+    proc.on('close', (code) => {
+      clearTimeout(timer);
+      resolve({ exitCode: code ?? -1, stdout });
+    });
+  });
+}
+
+function nativeExecute(command: string, args: string[]): Promise<Executed> {
+  return native
+    .spawnProcess(command, args, {
+      env: { TERMINAI_REQUEST: '1' },
+      timeoutMs: 30000,
+    })
+    .then((result) => ({
+      exitCode: result.exitCode ?? -1,
+      stdout: result.stdout,
+    }));
+}
+
+async function sequential(
+  execute: typeof nativeExecute,
+  command: string,
+  args: string[],
+): Promise<void> {
+  for (let i = 0; i < COMMANDS; i++) await execute(command, args);
+}
+
+async function concurrent(
+  execute: typeof nativeExecute,
+  command: string,
+  args: string[],
+): Promise<void> {
+  await Promise.all(
+    Array.from({ length: COMMANDS }, () => execute(command, args)),
+  );
+}
+
+describe.skipIf(!enabled)('100 × /bin/true, one at a time', () => {
+  bench('spawnProcess', () => sequential(nativeExecute, '/bin/true', []));
+
+  bench('child_process.spawn', () =>
+    sequential(childProcessExecute, '/bin/true', []),
+  );
+});
+
+describe.skipIf(!enabled)('100 × /bin/true, all at once', () => {
+  bench('spawnProcess', () => concurrent(nativeExecute, '/bin/true', []));
+
+  bench('child_process.spawn', () =>
+    concurrent(childProcessExecute, '/bin/true', []),
+  );
+});
+
+describe.skipIf(!enabled)('100 × echo with output, all at once', () => {
+  const args = ['-n', 'x'.repeat(4096)];
+
+  bench('spawnProcess', () => concurrent(nativeExecute, '/bin/echo', args));
+
+  bench('child_process.spawn', () =>
+    concurrent(childProcessExecute, '/bin/echo', args),
+  );
+});
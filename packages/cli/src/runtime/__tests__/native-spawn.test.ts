@@ -0,0 +1,218 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Process Spawner Tests
+ *
+ * Runs host commands with spawnProcess: exit status and output, the base
+ * environment and per-call variables, PATH lookup, working directory,
+ * timeouts, output caps, abort signals, leftover background processes,
+ * commands that cannot start (batch files on Windows), invalid input, and
+ * batched delivery of exits.
+ */
+
+import { describe, it, expect, beforeEach, afterEach } from 'vitest';
+import * as fs from 'node:fs';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import * as native from '../windows/native.js';
+
+const hasNative = native.isNativeModuleAvailable();
+const canSpawn = hasNative && process.platform !== 'darwin';
+const isLinux = process.platform === 'linux';
+const itIfLinux = canSpawn && isLinux ? it : it.skip;
+const itIfSpawn = canSpawn ? it : it.skip;
+const itIfWindows = canSpawn && process.platform === 'win32' ? it : it.skip;
+
+/** The same small script on both platforms */
+function shell(script: string): [string, string[]] {
+  return process.platform === 'win32'
+    ? ['cmd.exe', ['/d', '/c', script]]
+    : ['/bin/sh', ['-c', script]];
+}
+
+describe('Native Process Spawner', () => {
+  let dir: string;
+
+  beforeEach(() => {
+    dir = fs.mkdtempSync(path.join(os.tmpdir(), 'terminai-spawn-'));
+  });
+
+  afterEach(() => {
+    if (canSpawn) native.setSpawnEnvironment();
+    fs.rmSync(dir, { recursive: true, force: true });
+  });
+
+  itIfSpawn('collects exit code, stdout and stderr', async () => {
+    const [command, args] = shell('echo out&& echo err 1>&2&& exit 3');
+    const result = await native.spawnProcess(command, args);
+    expect(result).toMatchObject({
+      exitCode: 3,
+      signal: null,
+      timedOut: false,
+      truncated: false,
+    });
+    expect(result.stdout.trim()).toBe('out');
+    expect(result.stderr.trim()).toBe('err');
+    expect(result.pid).toBeGreaterThan(0);
+  });
+
+  itIfLinux('passes arguments without a shell', async () => {
+    const result = await native.spawnProcess('printf', [
+      '%s|',
+      'a b',
+      '$HOME',
+      '',
+    ]);
+    expect(result.stdout).toBe('a b|$HOME||');
+  });
+
+  itIfLinux('applies variables on top of the base environment', async () => {
+    const result = await native.spawnProcess(
+      '/bin/sh',
+      ['-c', 'echo "$SPAWN_TEST_VAR:$HOME:${PATH:+path}"'],
+      { env: { SPAWN_TEST_VAR: 'set', HOME: '/nowhere' } },
+    );
+    expect(result.stdout).toBe('set:/nowhere:path\n');
+
+    const count = native.setSpawnEnvironment({
+      PATH: '/usr/bin:/bin',
+      ONLY: '1',
+    });
+    expect(count).toBe(2);
+    expect(native.getSpawnStats()?.baseVariables).toBe(2);
+    const bare = await native.spawnProcess('env', [], { env: { EXTRA: 'x' } });
+    expect(bare.stdout.trim().split('\n').sort()).toEqual([
+      'EXTRA=x',
+      'ONLY=1',
+      'PATH=/usr/bin:/bin',
+    ]);
+  });
+
+  itIfLinux('resolves bare commands on the base PATH only', async () => {
+    const planted = path.join(dir, 'env');
+    fs.writeFileSync(planted, '#!/bin/sh\necho planted\n', { mode: 0o755 });
+    const result = await native.spawnProcess('env', [], { env: { PATH: dir } });
+    expect(result.stdout).not.toContain('planted');
+    expect(result.stdout).toContain(`PATH=${dir}\n`);
+  });
+
+  itIfWindows('refuses batch files', async () => {
+    const script = path.join(dir, 'echo.bat');
+    fs.writeFileSync(script, '@echo %*\r\n');
+    for (const command of [script, `${script}. .`, script.toUpperCase()]) {
+      await expect(
+        native.spawnProcess(command, ['"&calc.exe']),
+      ).rejects.toThrow(/batch files/);
+    }
+  });
+
+  itIfSpawn('runs in the given working directory', async () => {
+    fs.writeFileSync(path.join(dir, 'marker.txt'), 'here');
+    const [command, args] = shell(
+      process.platform === 'win32' ? 'type marker.txt' : 'cat marker.txt',
+    );
+    const result = await native.spawnProcess(command, args, { cwd: dir });
+    expect(result.stdout).toBe('here');
+  });
+
+  itIfLinux('kills the process group on timeout', async () => {
+    const started = Date.now();
+    const result = await native.spawnProcess(
+      '/bin/sh',
+      ['-c', 'sleep 30 & sleep 30'],
+      { timeoutMs: 200 },
+    );
+    expect(result).toMatchObject({
+      timedOut: true,
+      exitCode: null,
+      signal: 9,
+    });
+    expect(Date.now() - started).toBeLessThan(5000);
+    expect(native.getSpawnStats()?.timers).toBe(0);
+  });
+
+  itIfSpawn('caps collected output', async () => {
+    const [command, args] = shell(
+      process.platform === 'win32'
+        ? 'for /l %i in (1,1,2000) do @echo line %i'
+        : 'yes | head -c 100000',
+    );
+    const result = await native.spawnProcess(command, args, {
+      maxOutputBytes: 64,
+    });
+    expect(result.truncated).toBe(true);
+    expect(result.stdout.length).toBe(64);
+    expect(result.exitCode).toBe(0);
+  });
+
+  itIfLinux('kills the process group when the signal aborts', async () => {
+    const controller = new AbortController();
+    const pending = native.spawnProcess('/bin/sh', ['-c', 'sleep 30'], {
+      signal: controller.signal,
+    });
+    setTimeout(() => controller.abort(), 50);
+    await expect(pending).rejects.toMatchObject({ name: 'AbortError' });
+
+    const aborted = new AbortController();
+    aborted.abort();
+    await expect(
+      native.spawnProcess('true', [], { signal: aborted.signal }),
+    ).rejects.toMatchObject({ name: 'AbortError' });
+  });
+
+  itIfLinux('kills what the command leaves running', async () => {
+    const pidFile = path.join(dir, 'background.pid');
+    const result = await native.spawnProcess('/bin/sh', [
+      '-c',
+      `sleep 30 >/dev/null & echo $! > ${pidFile}`,
+    ]);
+    expect(result.exitCode).toBe(0);
+    const background = Number(fs.readFileSync(pidFile, 'utf8'));
+    await new Promise((resolve) => setTimeout(resolve, 100));
+    expect(() => process.kill(background, 0)).toThrow();
+  });
+
+  itIfSpawn('rejects commands that cannot start', async () => {
+    await expect(
+      native.spawnProcess('terminai-no-such-command', []),
+    ).rejects.toThrow(/cannot start/);
+    await expect(
+      native.spawnProcess(...shell('echo x'), {
+        cwd: path.join(dir, 'missing'),
+      }),
+    ).rejects.toThrow(/cannot start/);
+    expect(native.getSpawnStats()?.failed).toBeGreaterThanOrEqual(2);
+  });
+
+  itIfSpawn('rejects invalid input', async () => {
+    await expect(native.spawnProcess('', [])).rejects.toThrow(/command/);
+    await expect(
+      native.spawnProcess('echo', [1 as unknown as string]),
+    ).rejects.toThrow(/args/);
+    await expect(
+      native.spawnProcess('echo', [], { timeoutMs: -1 }),
+    ).rejects.toThrow(/timeoutMs/);
+  });
+
+  itIfLinux('batches exits that happen while JS is busy', async () => {
+    const before = native.getSpawnStats()!;
+    const pending = Array.from({ length: 32 }, (_, i) =>
+      native.spawnProcess('/bin/sh', ['-c', `sleep 0.1; echo ${i}`]),
+    );
+    // Keep the event loop busy until every command has exited.
+    Atomics.wait(new Int32Array(new SharedArrayBuffer(4)), 0, 0, 1000);
+    const results = await Promise.all(pending);
+    results.forEach((result, i) => expect(result.stdout).toBe(`${i}\n`));
+
+    const after = native.getSpawnStats()!;
+    expect(after.exited - before.exited).toBe(32);
+    expect(after.deliveries - before.deliveries).toBe(1);
+    expect(after.largestDelivery).toBeGreaterThanOrEqual(32);
+    expect(after.running).toBe(0);
+  });
+});
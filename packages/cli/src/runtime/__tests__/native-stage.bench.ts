@@ -0,0 +1,113 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Workspace Staging Benchmarks
+ *
+ * Run with `npm run bench -- native-stage`.
+ *
+ * Stages a synthetic tree of 20k files of 2 KiB into a fresh workspace,
+ * and re-syncs an up-to-date one, against Node's recursive copy. On Linux
+ * both native engines are measured (io_uring batches and plain system
+ * calls); elsewhere they are the same portable engine.
+ */
+
+import { bench, describe } from 'vitest';
+import * as fs from 'node:fs';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import * as native from '../windows/native.js';
+
+const hasNative = native.isNativeModuleAvailable();
+
+const benchDir = fs.mkdtempSync(
+  path.join(os.tmpdir(), 'terminai-stage-bench-'),
+);
+const source = path.join(benchDir, 'source');
+const synced = path.join(benchDir, 'synced');
+const copies = path.join(benchDir, 'copies');
+
+function makeTree(root: string, files: number): void {
+  const payload = Buffer.alloc(2048, 0x61);
+  for (let i = 0; i < files; i++) {
+    const dir = path.join(root, `pkg${i % 200}`, 'src', `m${i % 7}`);
+    if (i < 1400) fs.mkdirSync(dir, { recursive: true });
+    fs.writeFileSync(path.join(dir, `file${i}.ts`), payload);
+  }
+}
+
+if (hasNative) {
+  makeTree(source, 20000);
+  await native.stageWorkspace(source, synced);
+}
+process.on('exit', () => fs.rmSync(benchDir, { recursive: true, force: true }));
+
+// Every iteration copies into a new directory; teardown removes them all.
+let copyCount = 0;
+function fresh(): string {
+  return path.join(copies, String(copyCount++));
+}
+
+function discard(): void {
+  fs.rmSync(copies, { recursive: true, force: true });
+}
+
+describe.skipIf(!hasNative)('initial copy (20k files)', () => {
+  bench(
+    'stageWorkspace',
+    async () => {
+      await native.stageWorkspace(source, fresh());
+    },
+    { iterations: 3, teardown: discard },
+  );
+
+  bench(
+    'stageWorkspace (no io_uring)',
+    async () => {
+      await native.stageWorkspace(source, fresh(), { ioUring: false });
+    },
+    { iterations: 3, teardown: discard },
+  );
+
+  bench(
+    'fs.promises.cp',
+    async () => {
+      await fs.promises.cp(source, fresh(), { recursive: true });
+    },
+    { iterations: 3, teardown: discard },
+  );
+
+  bench(
+    'fs.cpSync',
+    () => {
+      fs.cpSync(source, fresh(), { recursive: true });
+    },
+    { iterations: 3, teardown: discard },
+  );
+});
+
+describe.skipIf(!hasNative)('resync, nothing changed (20k files)', () => {
+  bench('stageWorkspace (metadata)', async () => {
+    await native.stageWorkspace(source, synced);
+  });
+
+  bench(
+    'stageWorkspace (hash)',
+    async () => {
+      await native.stageWorkspace(source, synced, { compare: 'hash' });
+    },
+    { iterations: 3 },
+  );
+
+  bench(
+    'fs.promises.cp (overwrites everything)',
+    async () => {
+      await fs.promises.cp(source, synced, { recursive: true, force: true });
+    },
+    { iterations: 3 },
+  );
+});
@@ -0,0 +1,258 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Workspace Staging Tests
+ *
+ * Stages trees with stageWorkspace: a first copy (contents, symlinks,
+ * modes, mtimes, exclusions), incremental syncs by metadata and by hash,
+ * mirroring, progress reports, both Linux engines, cancellation, invalid
+ * input, and staging a sandbox session's workspace as it is created.
+ */
+
+import { describe, it, expect, beforeEach, afterEach } from 'vitest';
+import * as fs from 'node:fs';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import * as native from '../windows/native.js';
+
+const hasNative = native.isNativeModuleAvailable();
+const itIfNative = hasNative ? it : it.skip;
+const isPosix = process.platform !== 'win32';
+const canSandbox =
+  process.platform === 'linux' &&
+  hasNative &&
+  native.getLinuxSandboxSupport().userNamespaces;
+const itIfSandbox = canSandbox ? it : it.skip;
+
+describe('Native Workspace Staging', () => {
+  let dir: string;
+  let source: string;
+  let dest: string;
+
+  function write(root: string, rel: string, content: string): void {
+    const file = path.join(root, rel);
+    fs.mkdirSync(path.dirname(file), { recursive: true });
+    fs.writeFileSync(file, content);
+  }
+
+  function read(root: string, rel: string): string {
+    return fs.readFileSync(path.join(root, rel), 'utf8');
+  }
+
+  beforeEach(() => {
+    if (!hasNative) return;
+    dir = fs.mkdtempSync(path.join(os.tmpdir(), 'terminai-stage-'));
+    source = path.join(dir, 'source');
+    dest = path.join(dir, 'dest');
+    write(source, 'package.json', '{"name":"demo"}');
+    write(source, 'src/index.ts', 'export {};\n');
+    write(source, 'src/lib/util.ts', 'export const x = 1;\n');
+    write(source, 'docs/empty.md', '');
+    write(source, '.git/HEAD', 'ref: refs/heads/main\n');
+    fs.mkdirSync(path.join(source, 'empty'));
+  });
+
+  afterEach(() => {
+    if (!hasNative) return;
+    fs.rmSync(dir, { recursive: true, force: true });
+  });
+
+  itIfNative('copies a tree into a new destination', async () => {
+    if (isPosix) {
+      fs.symlinkSync('src/index.ts', path.join(source, 'entry'));
+      fs.chmodSync(path.join(source, 'src/lib/util.ts'), 0o750);
+    }
+    const result = await native.stageWorkspace(source, dest, {
+      exclude: ['.git'],
+    });
+
+    expect(result).toMatchObject({
+      files: 4,
+      directories: 4,
+      copiedFiles: 4,
+      unchangedFiles: 0,
+      failed: 0,
+      errors: [],
+    });
+    expect(result.copiedBytes).toBe(15 + 11 + 20);
+    expect(read(dest, 'src/lib/util.ts')).toBe('export const x = 1;\n');
+    expect(fs.existsSync(path.join(dest, 'empty'))).toBe(true);
+    expect(fs.existsSync(path.join(dest, '.git'))).toBe(false);
+
+    const from = fs.statSync(path.join(source, 'src/index.ts'));
+    const to = fs.statSync(path.join(dest, 'src/index.ts'));
+    expect(to.mtimeMs).toBe(from.mtimeMs);
+    if (isPosix) {
+      expect(result.symlinks).toBe(1);
+      expect(fs.readlinkSync(path.join(dest, 'entry'))).toBe('src/index.ts');
+      const mode = fs.statSync(path.join(dest, 'src/lib/util.ts')).mode;
+      expect(mode & 0o777).toBe(0o750);
+    }
+  });
+
+  itIfNative('copies only what changed on a later sync', async () => {
+    await native.stageWorkspace(source, dest);
+    const unchanged = await native.stageWorkspace(source, dest);
+    expect(unchanged).toMatchObject({ copiedFiles: 0, unchangedFiles: 5 });
+
+    write(source, 'src/index.ts', 'export const changed = true;\n');
+    write(source, 'src/new.ts', 'new\n');
+    const result = await native.stageWorkspace(source, dest);
+    expect(result).toMatchObject({ copiedFiles: 2, unchangedFiles: 4 });
+    expect(read(dest, 'src/index.ts')).toBe('export const changed = true;\n');
+  });
+
+  itIfNative('compares by hash when mtimes are not preserved', async () => {
+    await native.stageWorkspace(source, dest);
+    const later = new Date(Date.now() + 60_000);
+    fs.utimesSync(path.join(dest, 'package.json'), later, later);
+    write(dest, 'src/index.ts', 'export {}!\n');
+
+    const byHash = await native.stageWorkspace(source, dest, {
+      compare: 'hash',
+    });
+    expect(byHash).toMatchObject({ copiedFiles: 1, unchangedFiles: 4 });
+    expect(read(dest, 'src/index.ts')).toBe('export {};\n');
+
+    const always = await native.stageWorkspace(source, dest, {
+      compare: 'always',
+    });
+    expect(always).toMatchObject({ copiedFiles: 5, unchangedFiles: 0 });
+  });
+
+  itIfNative('mirrors the source when asked', async () => {
+    await native.stageWorkspace(source, dest, { exclude: ['.git'] });
+    write(dest, 'stray.log', 'x');
+    write(dest, 'build/out/main.js', 'y');
+    write(dest, '.git/config', 'kept');
+    fs.rmSync(path.join(source, 'docs'), { recursive: true });
+
+    const copy = await native.stageWorkspace(source, dest, {
+      exclude: ['.git'],
+    });
+    expect(copy.removedEntries).toBe(0);
+    expect(fs.existsSync(path.join(dest, 'stray.log'))).toBe(true);
+
+    const mirror = await native.stageWorkspace(source, dest, {
+      exclude: ['.git'],
+      mirror: true,
+    });
+    expect(mirror.removedEntries).toBe(3);
+    expect(fs.readdirSync(dest).sort()).toEqual([
+      '.git',
+      'empty',
+      'package.json',
+      'src',
+    ]);
+  });
+
+  itIfNative('replaces changed entry types only when mirroring', async () => {
+    await native.stageWorkspace(source, dest);
+    fs.rmSync(path.join(dest, 'docs'), { recursive: true });
+    write(dest, 'docs', 'now a file');
+
+    const copy = await native.stageWorkspace(source, dest);
+    expect(copy.failed).toBe(1);
+    expect(copy.errors[0]).toMatch(/^docs: .*different type/);
+
+    const mirror = await native.stageWorkspace(source, dest, { mirror: true });
+    expect(mirror).toMatchObject({ failed: 0, removedEntries: 1 });
+    expect(fs.statSync(path.join(dest, 'docs')).isDirectory()).toBe(true);
+  });
+
+  itIfNative('reports progress', async () => {
+    for (let i = 0; i < 200; i++) write(source, `bulk/f${i}.txt`, `${i}\n`);
+    const updates: native.StageProgress[] = [];
+    const result = await native.stageWorkspace(source, dest, {
+      progressIntervalMs: 0,
+      onProgress: (progress) => updates.push(progress),
+    });
+    await new Promise((resolve) => setImmediate(resolve));
+
+    expect(updates.length).toBeGreaterThan(0);
+    expect(updates.some((update) => update.phase === 'scan')).toBe(true);
+    const last = updates[updates.length - 1];
+    expect(last).toMatchObject({ phase: 'copy', done: true });
+    expect(last.totalFiles).toBe(result.copiedFiles);
+    expect(last.files).toBe(last.totalFiles);
+  });
+
+  itIfNative('stages with either engine', async () => {
+    const batched = await native.stageWorkspace(source, dest);
+    const plain = await native.stageWorkspace(
+      source,
+      path.join(dir, 'plain'),
+      { ioUring: false, threads: 1 },
+    );
+    if (process.platform === 'linux') {
+      expect(['io_uring', 'syscalls']).toContain(batched.engine);
+      expect(plain.engine).toBe('syscalls');
+    } else {
+      expect(plain.engine).toBe('portable');
+    }
+    expect(plain.copiedFiles).toBe(batched.copiedFiles);
+    expect(read(path.join(dir, 'plain'), 'package.json')).toBe(
+      '{"name":"demo"}',
+    );
+  });
+
+  itIfNative('stops on an aborted signal', async () => {
+    const controller = new AbortController();
+    controller.abort();
+    await expect(
+      native.stageWorkspace(source, dest, { signal: controller.signal }),
+    ).rejects.toMatchObject({ name: 'AbortError' });
+  });
+
+  itIfNative('rejects invalid input', async () => {
+    await expect(
+      native.stageWorkspace(path.join(dir, 'missing'), dest),
+    ).rejects.toThrow(/not a directory/);
+    await expect(
+      native.stageWorkspace(source, path.join(source, 'src', 'copy')),
+    ).rejects.toThrow(/inside the source/);
+    await expect(
+      native.stageWorkspace(source, dest, {
+        compare: 'size' as 'hash',
+      }),
+    ).rejects.toThrow(/compare/);
+    // Below an excluded directory is fine.
+    const nested = await native.stageWorkspace(
+      source,
+      path.join(source, '.git', 'stage'),
+      { exclude: ['.git'] },
+    );
+    expect(nested.copiedFiles).toBe(4);
+  });
+
+  itIfSandbox('stages a session workspace as it is created', async () => {
+    const workspace = path.join(dir, 'workspace');
+    const created = await native.createSandboxSession('staged', {
+      workspacePath: workspace,
+      stage: { source, exclude: ['.git'] },
+    });
+    try {
+      expect(created.staged).toMatchObject({ copiedFiles: 4, failed: 0 });
+      const pid = native.launchInSandboxSession('staged', {
+        command: ['/bin/sh', '-c', 'cat src/index.ts > seen.txt'],
+      });
+      expect((await native.waitLinuxSandbox(pid)).exitCode).toBe(0);
+      expect(read(workspace, 'seen.txt')).toBe('export {};\n');
+    } finally {
+      await native.destroySandboxSession('staged');
+    }
+
+    await expect(
+      native.createSandboxSession('unstaged', {
+        workspacePath: workspace,
+        stage: { source: path.join(dir, 'missing') },
+      }),
+    ).rejects.toThrow(/cannot stage/);
+    expect(native.getSandboxSession('unstaged')).toBeNull();
+  });
+});
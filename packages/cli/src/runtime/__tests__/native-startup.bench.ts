@@ -0,0 +1,60 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Module Startup Benchmarks (Linux)
+ *
+ * Run with `npm run bench -- native-startup`.
+ *
+ * Each iteration is a fresh `node`, since the addon loads once per process:
+ *
+ * - node alone: the floor.
+ * - require: what every CLI start pays now that loading initializes nothing.
+ * - require + warm-up: loading plus the whole provider run (portable
+ *   scanner, cgroup root, default seccomp profile), i.e. what an eager
+ *   initializer would add to startup.
+ *
+ * Plus the readiness probe, which must stay cheap enough to poll.
+ */
+
+import { bench, describe } from 'vitest';
+import { spawnSync } from 'node:child_process';
+import * as fs from 'node:fs';
+import { fileURLToPath } from 'node:url';
+import * as native from '../windows/native.js';
+
+const addonPath = fileURLToPath(
+  new URL('../../../build/Release/terminai_native.node', import.meta.url),
+);
+const isLinux =
+  process.platform === 'linux' &&
+  native.isNativeModuleAvailable() &&
+  fs.existsSync(addonPath);
+
+const load = `const m = require(${JSON.stringify(addonPath)});`;
+
+function runNode(script: string): void {
+  spawnSync(process.execPath, ['-e', script]);
+}
+
+describe.skipIf(!isLinux)('cold start', () => {
+  bench('node alone', () => runNode(''), { iterations: 20 });
+
+  bench('node + require', () => runNode(load), { iterations: 20 });
+
+  bench(
+    'node + require + warmUpNative()',
+    () => runNode(`${load} m.warmUpNative().then(() => {});`),
+    { iterations: 20 },
+  );
+});
+
+describe.skipIf(!isLinux)('readiness probe', () => {
+  bench('getNativeReadiness()', () => {
+    native.getNativeReadiness();
+  });
+});
@@ -0,0 +1,87 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Provider Initialization Tests (Linux)
+ *
+ * Loading the module must not initialize anything; providers come up on a
+ * background thread after warmUpNative() or on first use. Fresh-process
+ * checks run in a child `node`, since the addon's state is per process.
+ */
+
+import { describe, it, expect } from 'vitest';
+import { spawnSync } from 'node:child_process';
+import * as fs from 'node:fs';
+import { fileURLToPath } from 'node:url';
+import * as native from '../windows/native.js';
+
+const addonPath = fileURLToPath(
+  new URL('../../../build/Release/terminai_native.node', import.meta.url),
+);
+const isLinux =
+  process.platform === 'linux' &&
+  native.isNativeModuleAvailable() &&
+  fs.existsSync(addonPath);
+const itIfLinux = isLinux ? it : it.skip;
+
+/** Runs `body` in a fresh node with the addon bound to `m`. */
+function inFreshProcess(body: string): unknown {
+  const script = `const m = require(${JSON.stringify(addonPath)}); ${body}`;
+  const result = spawnSync(process.execPath, ['-e', script], {
+    encoding: 'utf8',
+  });
+  expect(result.status).toBe(0);
+  return JSON.parse(result.stdout);
+}
+
+describe('Native Provider Initialization', () => {
+  itIfLinux('initializes nothing when the module loads', () => {
+    const readiness = inFreshProcess(
+      'console.log(JSON.stringify(m.getNativeReadiness()))',
+    ) as native.NativeReadiness;
+    expect(readiness.state).toBe('idle');
+    expect(readiness.providers.map((p) => p.name)).toEqual([
+      'portable',
+      'cgroupRoot',
+      'seccompProfile',
+    ]);
+    expect(readiness.providers.every((p) => !p.ready)).toBe(true);
+  });
+
+  itIfLinux('reads isAmsiAvailable without starting initialization', () => {
+    const [amsi, state] = inFreshProcess(
+      'console.log(JSON.stringify(' +
+        '[m.isAmsiAvailable, m.getNativeReadiness().state]))',
+    ) as [boolean, string];
+    expect(amsi).toBe(false);
+    expect(state).toBe('idle');
+  });
+
+  itIfLinux('attempts every provider once', async () => {
+    const readiness = await native.warmUpNative();
+    expect(readiness.state).toBe('ready');
+    expect(readiness.providers.every((p) => p.ready)).toBe(true);
+    const portable = readiness.providers.find((p) => p.name === 'portable');
+    expect(portable?.available).toBe(true);
+    for (const provider of readiness.providers) {
+      if (!provider.available) expect(provider.error).toBeTruthy();
+    }
+
+    // A second warm-up reports the same run instead of starting another.
+    const again = await native.warmUpNative();
+    expect(again.totalUs).toBe(readiness.totalUs);
+    expect(native.getNativeReadiness()).toEqual(readiness);
+  });
+
+  it.skipIf(native.isNativeModuleAvailable())(
+    'reports no providers without the module',
+    async () => {
+      const readiness = await native.warmUpNative();
+      expect(readiness).toEqual({ state: 'ready', totalUs: 0, providers: [] });
+    },
+  );
+});
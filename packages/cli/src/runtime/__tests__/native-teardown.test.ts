@@ -0,0 +1,151 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Process-Tree Teardown Tests (Linux)
+ *
+ * Builds deep process trees, including descendants that escape their
+ * session with setsid, and checks that killProcessTree leaves nothing
+ * behind.
+ */
+
+import { describe, it, expect, beforeAll, afterAll } from 'vitest';
+import { spawn } from 'node:child_process';
+import * as fs from 'node:fs';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import * as native from '../windows/native.js';
+
+const isLinux =
+  process.platform === 'linux' && native.isNativeModuleAvailable();
+const governed = isLinux && native.getResourceGovernorSupport().available;
+const canSandbox =
+  governed && native.getLinuxSandboxSupport().userNamespaces;
+const itIfSandbox = canSandbox ? it : it.skip;
+const itIfGoverned = governed ? it : it.skip;
+
+/**
+ * Shell script that forks a chain `$1` levels deep. Every level also starts
+ * a setsid'd sleeper, which a process-group kill would miss. Each process
+ * appends its pid to `pidFile`, so `depth * 2` lines mean the tree is up.
+ */
+function writeTreeScript(script: string, pidFile: string): void {
+  fs.writeFileSync(
+    script,
+    [
+      `echo $$ >> ${pidFile}`,
+      `setsid sh -c 'echo $$ >> ${pidFile}; exec sleep 60' &`,
+      `if [ "$1" -gt 1 ]; then sh ${script} $(($1 - 1)) & fi`,
+      'wait',
+      '',
+    ].join('\n'),
+  );
+}
+
+function isAlive(pid: number): boolean {
+  try {
+    const stat = fs.readFileSync(`/proc/${pid}/stat`, 'utf8');
+    // Zombies are dead; they only wait for their parent to reap them.
+    return stat.slice(stat.lastIndexOf(')') + 2)[0] !== 'Z';
+  } catch {
+    return false;
+  }
+}
+
+async function waitForLines(file: string, count: number): Promise<number[]> {
+  const deadline = Date.now() + 10000;
+  for (;;) {
+    const pids = fs.existsSync(file)
+      ? fs
+          .readFileSync(file, 'utf8')
+          .split('\n')
+          .filter(Boolean)
+          .map(Number)
+      : [];
+    if (pids.length >= count || Date.now() > deadline) return pids;
+    await new Promise((resolve) => setTimeout(resolve, 20));
+  }
+}
+
+describe('Native Process-Tree Teardown', () => {
+  let dir: string;
+
+  beforeAll(() => {
+    dir = fs.mkdtempSync(path.join(os.tmpdir(), 'terminai-teardown-'));
+  });
+
+  afterAll(() => {
+    fs.rmSync(dir, { recursive: true, force: true });
+  });
+
+  /** Returns the pid file and the command that builds the tree. */
+  function deepTree(name: string, depth: number): [string, string] {
+    const pidFile = path.join(dir, `${name}.pids`);
+    const script = path.join(dir, `${name}.sh`);
+    writeTreeScript(script, pidFile);
+    return [pidFile, `sh ${script} ${depth}`];
+  }
+
+  itIfSandbox('kills a deep tree and its setsid escapes', async () => {
+    const depth = 16;
+    const [pidFile, script] = deepTree('sandbox', depth);
+    const pid = native.createLinuxSandbox({
+      command: ['sh', '-c', script],
+      workspacePath: dir,
+    });
+    expect(pid).toBeGreaterThan(0);
+
+    const pids = await waitForLines(pidFile, depth * 2);
+    expect(pids.length).toBe(depth * 2);
+
+    const result = await native.killProcessTree(pid);
+    expect(result.method).toBe('cgroup');
+    expect(result.complete).toBe(true);
+    expect(result.latencyUs).toBeGreaterThan(0);
+
+    const exit = await native.waitLinuxSandbox(pid);
+    expect(exit.signal).toBe(9);
+    expect(pids.filter(isAlive)).toEqual([]);
+  });
+
+  itIfGoverned('kills an attached child_process tree', async () => {
+    const depth = 8;
+    const [pidFile, script] = deepTree('attached', depth);
+    // Attach before the tree exists: the script waits for the go file.
+    const go = path.join(dir, 'attached.go');
+    const proc = spawn('sh', [
+      '-c',
+      `while [ ! -e ${go} ]; do sleep 0.01; done; ${script}`,
+    ]);
+    const exited = new Promise((resolve) => proc.on('exit', resolve));
+    expect(native.attachProcessTree(proc.pid!)).toBe(true);
+    fs.writeFileSync(go, '');
+
+    const pids = await waitForLines(pidFile, depth * 2);
+    expect(pids.length).toBe(depth * 2);
+
+    const result = await native.killProcessTree(proc.pid!);
+    expect(result.method).toBe('cgroup');
+    expect(result.complete).toBe(true);
+    await exited;
+    native.releaseSandboxResources(proc.pid!);
+    expect(pids.filter(isAlive)).toEqual([]);
+  });
+
+  it.skipIf(!isLinux)('kills the process group without a group', async () => {
+    const proc = spawn('sh', ['-c', 'sleep 60 & sleep 60 & wait'], {
+      detached: true,
+    });
+    const exited = new Promise((resolve) => proc.on('exit', resolve));
+    await new Promise((resolve) => setTimeout(resolve, 100));
+
+    const result = await native.killProcessTree(proc.pid!);
+    expect(result.method).toBe('processGroup');
+    expect(result.complete).toBe(true);
+    await exited;
+  });
+});
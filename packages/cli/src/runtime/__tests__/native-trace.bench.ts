@@ -0,0 +1,82 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Call Trace Benchmarks
+ *
+ * Run with `npm run bench -- native-trace`.
+ *
+ * What recording costs per call: a cheap export (hashBuffer of a short
+ * string, and of a 1 MiB Buffer that is digested into the trace) with no
+ * trace running against the same calls while a trace is recorded.
+ */
+
+import { bench, describe } from 'vitest';
+import * as fs from 'node:fs';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import * as native from '../windows/native.js';
+
+const isAvailable = native.isNativeModuleAvailable();
+
+const SMALL = 'git status --porcelain';
+const LARGE = Buffer.alloc(1024 * 1024, 0x61);
+
+let dir = '';
+if (isAvailable) {
+  dir = fs.mkdtempSync(path.join(os.tmpdir(), 'terminai-trace-bench-'));
+  process.on('exit', () => {
+    native.stopNativeTrace();
+    fs.rmSync(dir, { recursive: true, force: true });
+  });
+}
+
+function tracing(on: boolean): void {
+  if (on) {
+    const tracePath = path.join(dir, 'bench.trace');
+    fs.rmSync(tracePath, { force: true });
+    native.startNativeTrace(tracePath);
+  } else {
+    native.stopNativeTrace();
+  }
+}
+
+describe.skipIf(!isAvailable)('hashBuffer (short string)', () => {
+  bench(
+    'no trace',
+    () => {
+      native.hashBuffer(SMALL);
+    },
+    { setup: () => tracing(false) },
+  );
+
+  bench(
+    'traced',
+    () => {
+      native.hashBuffer(SMALL);
+    },
+    { setup: () => tracing(true), teardown: () => tracing(false) },
+  );
+});
+
+describe.skipIf(!isAvailable)('hashBuffer (1 MiB Buffer)', () => {
+  bench(
+    'no trace',
+    () => {
+      native.hashBuffer(LARGE);
+    },
+    { setup: () => tracing(false) },
+  );
+
+  bench(
+    'traced',
+    () => {
+      native.hashBuffer(LARGE);
+    },
+    { setup: () => tracing(true), teardown: () => tracing(false) },
+  );
+});
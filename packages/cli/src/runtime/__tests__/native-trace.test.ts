@@ -0,0 +1,153 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * Portions Copyright 2025 TerminaI Authors
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Native Call Trace Tests
+ *
+ * Records calls with startNativeTrace and decodes them with
+ * readNativeTrace: sync, throwing and async exports, how strings and
+ * Buffers are digested (all strings by default, env values always), the
+ * file's permissions, the size cap, and that stopping the trace leaves the
+ * module untouched.
+ */
+
+import { describe, it, expect, beforeEach, afterEach } from 'vitest';
+import * as fs from 'node:fs';
+import * as os from 'node:os';
+import * as path from 'node:path';
+import * as native from '../windows/native.js';
+
+const isAvailable = native.isNativeModuleAvailable();
+const itIfNative = isAvailable ? it : it.skip;
+
+describe('Native Call Trace', () => {
+  let dir: string;
+  let tracePath: string;
+
+  beforeEach(() => {
+    if (!isAvailable) return;
+    dir = fs.mkdtempSync(path.join(os.tmpdir(), 'terminai-trace-'));
+    tracePath = path.join(dir, 'session.trace');
+  });
+
+  afterEach(() => {
+    if (!isAvailable) return;
+    native.stopNativeTrace();
+    fs.rmSync(dir, { recursive: true, force: true });
+  });
+
+  itIfNative('records sync, throwing and async calls', async () => {
+    const file = path.join(dir, 'payload.bin');
+    fs.writeFileSync(file, 'payload');
+    expect(native.startNativeTrace(tracePath, { redactStrings: false })).toBe(
+      true,
+    );
+
+    const digest = native.hashBuffer('hello');
+    expect(() => native.hashBuffer(42 as unknown as Buffer)).toThrow();
+    await native.hashFile(file);
+
+    const summary = native.stopNativeTrace()!;
+    expect(summary).toMatchObject({ path: tracePath, calls: 3, dropped: 0 });
+    expect(fs.statSync(tracePath).size).toBe(summary.bytes);
+
+    const trace = await native.readNativeTrace(tracePath);
+    expect(trace).toMatchObject({ version: 1, complete: true, dropped: 0 });
+    expect(trace.calls.map((call) => [call.name, call.status])).toEqual([
+      ['hashBuffer', 'returned'],
+      ['hashBuffer', 'threw'],
+      ['hashFile', 'resolved'],
+    ]);
+
+    const [sync, , async] = trace.calls;
+    expect(sync.args).toEqual(['hello']);
+    expect(sync.result).toBe(digest);
+    expect(async.args[0]).toBe(file);
+    expect(async.durationUs).toBeGreaterThanOrEqual(async.syncUs);
+    expect(async.startUs).toBeGreaterThanOrEqual(sync.startUs);
+  });
+
+  itIfNative('digests payloads instead of recording them', async () => {
+    native.startNativeTrace(tracePath, {
+      maxStringBytes: 8,
+      redactStrings: false,
+    });
+    native.hashBuffer(Buffer.alloc(100_000, 7));
+    native.hashBuffer('a string longer than eight bytes');
+    native.stopNativeTrace();
+
+    const [buffer, text] = (await native.readNativeTrace(tracePath)).calls;
+    expect(buffer.args[0]).toMatchObject({ $buffer: 100_000 });
+    expect(text.args[0]).toMatchObject({ $string: 32 });
+    expect(buffer.payloadBytes).toBe(100_000);
+    expect(fs.readFileSync(tracePath).includes('longer than')).toBe(false);
+  });
+
+  itIfNative('redacts by default and keeps the file private', async () => {
+    native.startNativeTrace(tracePath);
+    native.hashBuffer('secret value');
+    native.stopNativeTrace();
+    const [call] = (await native.readNativeTrace(tracePath)).calls;
+    expect(call.args[0]).toMatchObject({ $string: 12 });
+    expect(fs.readFileSync(tracePath).includes('secret')).toBe(false);
+    if (process.platform !== 'win32') {
+      expect(fs.statSync(tracePath).mode & 0o777).toBe(0o600);
+    }
+
+    // Never an existing file or a symlink
+    expect(native.startNativeTrace(tracePath)).toBe(false);
+    if (process.platform !== 'win32') {
+      const link = path.join(dir, 'link.trace');
+      fs.symlinkSync(path.join(dir, 'target.trace'), link);
+      expect(native.startNativeTrace(link)).toBe(false);
+      expect(fs.existsSync(path.join(dir, 'target.trace'))).toBe(false);
+    }
+  });
+
+  itIfNative('digests env values even when strings are kept', async () => {
+    native.startNativeTrace(tracePath, { redactStrings: false });
+    native.hashBuffer('kept');
+    if (process.platform === 'linux') {
+      await native.spawnProcess('true', [], { env: { TOKEN: 'hunter2' } });
+    }
+    native.stopNativeTrace();
+
+    const [kept, spawned] = (await native.readNativeTrace(tracePath)).calls;
+    expect(kept.args[0]).toBe('kept');
+    if (spawned) {
+      expect(spawned.args[2]).toMatchObject({ env: { TOKEN: { $string: 7 } } });
+      expect(fs.readFileSync(tracePath).includes('hunter2')).toBe(false);
+    }
+  });
+
+  itIfNative('drops calls past maxBytes', async () => {
+    native.startNativeTrace(tracePath, { maxBytes: 512 });
+    for (let i = 0; i < 100; i++) native.hashBuffer(`call ${i}`);
+    const summary = native.stopNativeTrace()!;
+    expect(summary.dropped).toBeGreaterThan(0);
+    expect(summary.calls + summary.dropped).toBe(100);
+
+    const trace = await native.readNativeTrace(tracePath);
+    expect(trace.calls).toHaveLength(summary.calls);
+    expect(trace.dropped).toBe(summary.dropped);
+  });
+
+  itIfNative('stops cleanly and rejects other files', async () => {
+    expect(native.stopNativeTrace()).toBeNull();
+    native.startNativeTrace(tracePath);
+    native.stopNativeTrace();
+    native.hashBuffer('not traced');
+    expect((await native.readNativeTrace(tracePath)).calls).toHaveLength(0);
+
+    const other = path.join(dir, 'other.bin');
+    fs.writeFileSync(other, 'not a trace');
+    await expect(native.readNativeTrace(other)).rejects.toThrow();
+    expect(native.startNativeTrace(path.join(dir, 'missing', 'x'))).toBe(
+      false,
+    );
+  });
+});
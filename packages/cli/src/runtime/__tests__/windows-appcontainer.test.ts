@@ -147,26 +147,8 @@ describe('BrokerSchema', () => {
 // ============================================================================
 
 describe('BrokerServer and BrokerClient', () => {
-  // These tests use Node.js net module which works on all platforms
-  // We mock the Windows-specific ACL and permission checks
-
-  beforeAll(() => {
-    // Mock execSync to prevent actual system calls
-    vi.mock('node:child_process', async (importOriginal) => {
-      const actual =
-        await importOriginal<typeof import('node:child_process')>();
-      return {
-        ...actual,
-        execSync: vi.fn((cmd: string) => {
-          if (cmd.includes('icacls')) {
-            // Mock Windows ACL check
-            return 'BUILTIN\\Users:(OI)(CI)(RX)';
-          }
-          return actual.execSync(cmd);
-        }),
-      };
-    });
-  });
+  // These tests use Node.js net module which works on all platforms.
+  // The Windows-specific ACL grant is skipped with checkNodePermissions.
 
   it('BrokerServer can be instantiated', async () => {
     const { BrokerServer } = await import('../windows/BrokerServer.js');
@@ -244,7 +226,7 @@ describe('Native Module', () => {
     const native = await import('../windows/native.js');
 
     // Skip if AMSI not available (e.g., in CI without Defender)
-    if (!native.isAmsiAvailable) {
+    if (!native.getIsAmsiAvailable()) {
       console.log('AMSI not available, skipping test');
       return;
     }
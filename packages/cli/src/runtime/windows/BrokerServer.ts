@@ -22,7 +22,6 @@
 
 import * as net from 'node:net';
 import * as path from 'node:path';
-import { execSync } from 'node:child_process';
 import { randomUUID } from 'node:crypto';
 import { EventEmitter } from 'node:events';
 import {
@@ -31,6 +30,7 @@ import {
   type BrokerRequest,
   type BrokerResponse,
 } from './BrokerSchema.js';
+import { checkPathAccess, grantPathAccess } from './native.js';
 
 // Well-known SID for "ALL APPLICATION PACKAGES" (AppContainers)
 const ALL_APP_PACKAGES_SID = 'S-1-15-2-1';
@@ -48,6 +48,8 @@ export interface BrokerServerEvents {
   request: (
     request: BrokerRequest,
     respond: (response: BrokerResponse) => void,
+    /** Aborted when the client disconnects before the response */
+    signal: AbortSignal,
   ) => void;
   error: (error: Error) => void;
   connection: (clientId: string) => void;
@@ -97,10 +99,11 @@ export class BrokerServer extends EventEmitter {
    * Check if Node.js is readable by AppContainers and grant access if needed.
    *
    * AppContainers cannot access arbitrary system directories. This method:
-   * 1. Checks if node.exe is accessible by ALL APPLICATION PACKAGES
-   * 2. If not, executes icacls to grant read/execute permissions
+   * 1. Checks node.exe's DACL for an ALL APPLICATION PACKAGES read/execute ACE
+   * 2. If it is missing, grants it on the Node.js directory through the
+   *    native grant engine, which writes only the entries that lack it
    *
-   * @throws Error if permission cannot be granted (requires Admin)
+   * Failures are logged, not thrown (granting requires Admin)
    */
   async ensureNodeAccessible(): Promise<void> {
     if (!this.checkNodePermissions) {
@@ -111,29 +114,24 @@ export class BrokerServer extends EventEmitter {
     const nodeDir = path.dirname(nodePath);
 
     try {
-      // Check if already accessible by checking icacls output
-      const aclCheck = execSync(`icacls "${nodePath}"`, { encoding: 'utf-8' });
-
-      // Look for ALL APPLICATION PACKAGES or S-1-15-2-1 in the output
-      if (
-        aclCheck.includes('ALL APPLICATION PACKAGES') ||
-        aclCheck.includes(ALL_APP_PACKAGES_SID)
-      ) {
+      if (checkPathAccess(nodePath, ALL_APP_PACKAGES_SID, 'rx')) {
         // Already accessible
         return;
       }
 
-      // Grant read/execute access to Node.js installation
-      // (OI) = Object Inherit, (CI) = Container Inherit, (RX) = Read and Execute
+      // Read/execute on the installation, inherited by new files
       console.log(
         '[BrokerServer] Granting AppContainer access to Node.js runtime...',
       );
-      execSync(
-        `icacls "${nodeDir}" /grant "*${ALL_APP_PACKAGES_SID}:(OI)(CI)(RX)"`,
-        { stdio: 'inherit' },
-      );
+      const result = await grantPathAccess({
+        path: nodeDir,
+        principal: ALL_APP_PACKAGES_SID,
+        rights: 'rx',
+        recursive: true,
+      });
       console.log(
-        '[BrokerServer] Node.js runtime is now AppContainer-accessible',
+        `[BrokerServer] Node.js runtime is now AppContainer-accessible ` +
+          `(${result.granted} of ${result.checked} entries updated)`,
       );
     } catch (error) {
       // Log warning but don't fail - the native module might bundle Node
@@ -217,9 +215,13 @@ export class BrokerServer extends EventEmitter {
    * 2. Buffers incoming data for complete JSON messages
    * 3. Validates requests against BrokerRequestSchema
    * 4. Emits 'request' event for processing
+   *
+   * Requests of a connection share one AbortSignal that is aborted when the
+   * client goes away, so handlers can stop work nobody will read.
    */
   private handleConnection(socket: net.Socket): void {
     const clientId = randomUUID();
+    const disconnected = new AbortController();
     let buffer = '';
 
     this.emit('connection', clientId);
@@ -239,10 +241,16 @@ export class BrokerServer extends EventEmitter {
           const validated = BrokerRequestSchema.parse(parsed);
 
           // Emit request event with response callback
-          this.emit('request', validated, (response: BrokerResponse) => {
-            const validatedResponse = BrokerResponseSchema.parse(response);
-            socket.write(JSON.stringify(validatedResponse) + '\n');
-          });
+          this.emit(
+            'request',
+            validated,
+            (response: BrokerResponse) => {
+              if (disconnected.signal.aborted) return;
+              const validatedResponse = BrokerResponseSchema.parse(response);
+              socket.write(JSON.stringify(validatedResponse) + '\n');
+            },
+            disconnected.signal,
+          );
         } catch (error) {
           // Send error response for invalid requests
           const errorResponse: BrokerResponse = {
@@ -259,6 +267,7 @@ export class BrokerServer extends EventEmitter {
     });
 
     socket.on('close', () => {
+      disconnected.abort();
       console.log(`[BrokerServer] Client ${clientId} disconnected`);
     });
   }
@@ -32,6 +32,7 @@ import type {
   RuntimeProcess,
 } from '@terminai/core';
 import { BrokerServer } from './BrokerServer.js';
+import type { ResourceSample, SandboxResourceLimits } from './native.js';
 import {
   type BrokerRequest,
   type BrokerResponse,
@@ -65,6 +66,7 @@ enum AppContainerError {
   ProcessCreationFailed = -3,
   InvalidArguments = -4,
   CapabilityError = -5,
+  ResourceError = -6,
 }
 
 export interface WindowsBrokerContextOptions {
@@ -74,6 +76,21 @@ export interface WindowsBrokerContextOptions {
   workspacePath?: string;
   /** Path to the Brain script to execute in sandbox */
   brainScript?: string;
+  /**
+   * Command policy file for 'execute' requests (see native/policy_engine.h).
+   * Without one, only the built-in connectivity-check commands are allowed.
+   */
+  commandPolicyPath?: string;
+  /** Poll the policy file for changes at this interval (default: 2000ms) */
+  commandPolicyWatchMs?: number;
+  /** CPU/memory/process limits for the Brain (enforced by a Job Object) */
+  resourceLimits?: SandboxResourceLimits;
+  /**
+   * Known-good hash table (see native buildHashAllowlist). Scripts whose
+   * BLAKE3 hash is listed skip the AMSI scan (the scan pipeline's first
+   * tier).
+   */
+  scanAllowlistPath?: string;
 }
 
 /**
@@ -91,6 +108,10 @@ export class WindowsBrokerContext implements RuntimeContext {
   private readonly cliVersion: string;
   private readonly workspacePath: string;
   private readonly brainScript: string;
+  private readonly commandPolicyPath?: string;
+  private readonly commandPolicyWatchMs: number;
+  private readonly resourceLimits?: SandboxResourceLimits;
+  private readonly scanAllowlistPath?: string;
 
   private brokerServer: BrokerServer | null = null;
   private brainPid: number | null = null;
@@ -102,6 +123,10 @@ export class WindowsBrokerContext implements RuntimeContext {
       options.workspacePath ??
       path.join(os.homedir(), '.terminai', 'workspace');
     this.brainScript = options.brainScript ?? 'agent-brain.js';
+    this.commandPolicyPath = options.commandPolicyPath;
+    this.commandPolicyWatchMs = options.commandPolicyWatchMs ?? 2000;
+    this.resourceLimits = options.resourceLimits;
+    this.scanAllowlistPath = options.scanAllowlistPath;
   }
 
   /**
@@ -134,8 +159,9 @@ export class WindowsBrokerContext implements RuntimeContext {
    * 1. Ensure workspace directory exists
    * 2. Create AppContainer profile (if not exists)
    * 3. Grant workspace ACLs to AppContainer
-   * 4. Start Broker server
-   * 5. Spawn Brain process in AppContainer
+   * 4. Load command policy and scan allowlist (if configured)
+   * 5. Start Broker server
+   * 6. Spawn Brain process in AppContainer
    */
   async initialize(): Promise<void> {
     await loadNative();
@@ -143,13 +169,48 @@ export class WindowsBrokerContext implements RuntimeContext {
       throw new Error('WindowsBrokerContext is only available on Windows');
     }
 
+    // AMSI and the AppContainer profile initialize in the background while
+    // the broker starts up.
+    void native.warmUpNative();
+
     // Step 1: Ensure workspace exists
     await fs.mkdir(this.workspacePath, { recursive: true });
 
     // Step 2 & 3: Create AppContainer and grant ACLs
     // This is handled by the native module in createAppContainerSandbox
 
-    // Step 4: Start Broker server
+    // Step 4: Load command policy. Failing closed: a broken policy file
+    // aborts startup rather than silently falling back to the allowlist.
+    if (this.commandPolicyPath) {
+      const loaded = native.loadCommandPolicy(this.commandPolicyPath, {
+        watchIntervalMs: this.commandPolicyWatchMs,
+      });
+      if (!loaded.ok) {
+        throw new Error(`Invalid command policy: ${loaded.error}`);
+      }
+      console.log(
+        `[WindowsBrokerContext] Command policy loaded (${loaded.rules} rules)`,
+      );
+    }
+
+    // The allowlist only lets content skip a scan, so a broken table means
+    // scanning everything rather than refusing to start.
+    if (this.scanAllowlistPath) {
+      const allowlist = native.loadHashAllowlist(this.scanAllowlistPath);
+      if (allowlist.ok) {
+        console.log(
+          `[WindowsBrokerContext] Scan allowlist loaded ` +
+            `(${allowlist.entries} hashes)`,
+        );
+      } else {
+        console.error(
+          '[WindowsBrokerContext] Scan allowlist not loaded:',
+          allowlist.error,
+        );
+      }
+    }
+
+    // Step 5: Start Broker server
     this.brokerServer = new BrokerServer({
       workspacePath: this.workspacePath,
       checkNodePermissions: true,
@@ -167,13 +228,14 @@ export class WindowsBrokerContext implements RuntimeContext {
       `[WindowsBrokerContext] Broker listening on ${this.brokerServer.path}`,
     );
 
-    // Step 5: Spawn Brain in AppContainer
+    // Step 6: Spawn Brain in AppContainer
     const commandLine = `node "${this.brainScript}" --pipe="${this.brokerServer.path}"`;
 
     const result = native.createAppContainerSandbox(
       commandLine,
       this.workspacePath,
       true, // Enable internet access for LLM calls
+      this.resourceLimits,
     );
 
     if (result < 0) {
@@ -202,6 +264,8 @@ export class WindowsBrokerContext implements RuntimeContext {
         return 'Invalid arguments for sandbox creation';
       case AppContainerError.CapabilityError:
         return 'Failed to set sandbox capabilities';
+      case AppContainerError.ResourceError:
+        return 'Failed to apply sandbox resource limits';
       default:
         return `Unknown error: ${error}`;
     }
@@ -213,6 +277,7 @@ export class WindowsBrokerContext implements RuntimeContext {
   private async handleRequest(
     request: BrokerRequest,
     respond: (response: BrokerResponse) => void,
+    signal: AbortSignal,
   ): Promise<void> {
     try {
       switch (request.type) {
@@ -221,15 +286,15 @@ export class WindowsBrokerContext implements RuntimeContext {
           break;
 
         case 'execute':
-          await this.handleExecute(request, respond);
+          await this.handleExecute(request, respond, signal);
           break;
 
         case 'readFile':
-          await this.handleReadFile(request, respond);
+          await this.handleReadFile(request, respond, signal);
           break;
 
         case 'writeFile':
-          await this.handleWriteFile(request, respond);
+          await this.handleWriteFile(request, respond, signal);
           break;
 
         case 'listDir':
@@ -259,38 +324,91 @@ export class WindowsBrokerContext implements RuntimeContext {
   /**
    * Handle 'execute' request.
    * HARDENED: Only allows specific commands and disables shell execution.
+   * The command's process tree is killed if the client disconnects.
    */
   private async handleExecute(
     request: Extract<BrokerRequest, { type: 'execute' }>,
     respond: (response: BrokerResponse) => void,
+    signal: AbortSignal,
   ): Promise<void> {
-    const { spawn } = await import('node:child_process');
-
     const args = request.args ?? [];
-    const cwd = request.cwd ?? this.workspacePath;
+    // Resolved once: the directory the policy approves is the one the
+    // command starts in, not one relative to the broker's own cwd.
+    const cwd = path.resolve(this.workspacePath, request.cwd ?? '.');
     const timeout = request.timeout ?? 30000;
 
-    // Security: Strict Allowlist
-    const ALLOWED_COMMANDS = ['echo', 'dir']; // Minimal allowlist for connectivity check
-    // Real sidecars should be registered and invoked by specific ID, not arbitrary command string.
+    // Security: compiled command policy when configured, otherwise a
+    // minimal allowlist for connectivity checks. Real sidecars should be
+    // registered and invoked by specific ID, not arbitrary command string.
+    const ALLOWED_COMMANDS = ['echo', 'dir'];
+
+    const decision = native?.evaluateCommandPolicy({
+      command: request.command,
+      args,
+      cwd,
+      env: request.env ?? {},
+    });
+
+    let denial: string | null = null;
+    if (decision) {
+      if (!decision.allowed) {
+        denial = decision.ruleId
+          ? `Command '${request.command}' is denied by policy rule '${decision.ruleId}'.`
+          : `Command '${request.command}' is not allowed by Windows Broker policy.`;
+      }
+    } else if (!ALLOWED_COMMANDS.includes(request.command)) {
+      denial = `Command '${request.command}' is not allowed by Windows Broker policy.`;
+    }
 
-    if (!ALLOWED_COMMANDS.includes(request.command)) {
+    if (denial) {
       respond(
         createSuccessResponse({
           exitCode: 1,
           stdout: '',
-          stderr: `Command '${request.command}' is not allowed by Windows Broker policy.`,
+          stderr: denial,
           timedOut: false,
         }),
       );
       return;
     }
 
+    // Native spawner: one service thread for every running command, with
+    // its own Job Object, timeout and output collection.
+    if (native?.isNativeModuleAvailable()) {
+      let result: ExecuteResult;
+      try {
+        const spawned = await native.spawnProcess(request.command, args, {
+          cwd,
+          env: request.env,
+          timeoutMs: timeout,
+          signal,
+        });
+        result = {
+          exitCode: spawned.exitCode ?? -1,
+          stdout: spawned.stdout,
+          timedOut: spawned.timedOut,
+          stderr:
+            spawned.stderr || (spawned.exitCode !== 0 ? 'Process failed' : ''),
+        };
+      } catch (error) {
+        result = {
+          exitCode: -1,
+          stdout: '',
+          stderr: (error as Error).message,
+          timedOut: false,
+        };
+      }
+      respond(createSuccessResponse(result));
+      return;
+    }
+
+    // Without the native module there is no Job Object: a timeout or abort
+    // kills the command itself, not whatever it started.
+    const { spawn } = await import('node:child_process');
     return new Promise((resolve) => {
       const proc = spawn(request.command, args, {
         cwd,
         env: { ...process.env, ...request.env },
-        timeout,
         shell: false, // CRITICAL: Disable shell to prevent injection
       });
 
@@ -306,7 +424,19 @@ export class WindowsBrokerContext implements RuntimeContext {
         stderr += data.toString();
       });
 
+      // Handle timeout
+      const timer = setTimeout(() => {
+        timedOut = true;
+        proc.kill('SIGKILL');
+      }, timeout);
+
+      // Nobody is left to read the result.
+      const onAbort = () => proc.kill('SIGKILL');
+      signal.addEventListener('abort', onAbort, { once: true });
+
       proc.on('error', (error) => {
+        clearTimeout(timer);
+        signal.removeEventListener('abort', onAbort);
         const result: ExecuteResult = {
           exitCode: -1,
           stdout,
@@ -318,6 +448,8 @@ export class WindowsBrokerContext implements RuntimeContext {
       });
 
       proc.on('close', (code) => {
+        clearTimeout(timer);
+        signal.removeEventListener('abort', onAbort);
         const result: ExecuteResult = {
           exitCode: code ?? -1,
           stdout,
@@ -327,14 +459,6 @@ export class WindowsBrokerContext implements RuntimeContext {
         respond(createSuccessResponse(result));
         resolve();
       });
-
-      // Handle timeout
-      setTimeout(() => {
-        if (!proc.killed) {
-          timedOut = true;
-          proc.kill('SIGKILL');
-        }
-      }, timeout);
     });
   }
 
@@ -344,6 +468,7 @@ export class WindowsBrokerContext implements RuntimeContext {
   private async handleReadFile(
     request: Extract<BrokerRequest, { type: 'readFile' }>,
     respond: (response: BrokerResponse) => void,
+    signal: AbortSignal,
   ): Promise<void> {
     const filePath = path.isAbsolute(request.path)
       ? request.path
@@ -354,6 +479,7 @@ export class WindowsBrokerContext implements RuntimeContext {
     try {
       const content = await fs.readFile(filePath, {
         encoding: encoding === 'base64' ? null : 'utf-8',
+        signal,
       });
 
       const data =
@@ -370,11 +496,13 @@ export class WindowsBrokerContext implements RuntimeContext {
   }
 
   /**
-   * Handle 'writeFile' request.
+   * Handle 'writeFile' request. With AMSI available the content is scanned
+   * as it is written and only lands at the path if clean.
    */
   private async handleWriteFile(
     request: Extract<BrokerRequest, { type: 'writeFile' }>,
     respond: (response: BrokerResponse) => void,
+    signal: AbortSignal,
   ): Promise<void> {
     const filePath = path.isAbsolute(request.path)
       ? request.path
@@ -392,7 +520,23 @@ export class WindowsBrokerContext implements RuntimeContext {
           ? Buffer.from(request.content, 'base64')
           : request.content;
 
-      await fs.writeFile(filePath, content);
+      if (native?.getIsAmsiAvailable()) {
+        const result = await native.writeFileScanned(filePath, content, {
+          engine: 'amsi',
+          signal,
+        });
+        if (!result.written) {
+          respond(
+            createErrorResponse(
+              `AMSI blocked file write: ${result.description}`,
+              'AMSI_BLOCKED',
+            ),
+          );
+          return;
+        }
+      } else {
+        await fs.writeFile(filePath, content, { signal });
+      }
       respond(createSuccessResponse({ written: true }));
     } catch (error) {
       respond(
@@ -457,9 +601,12 @@ export class WindowsBrokerContext implements RuntimeContext {
     request: Extract<BrokerRequest, { type: 'powershell' }>,
     respond: (response: BrokerResponse) => void,
   ): Promise<void> {
-    // AMSI scan before execution
-    if (native?.isAmsiAvailable) {
-      const scanResult = native.amsiScanBuffer(request.script, 'script.ps1');
+    // Scan before execution. The pipeline clears known-good, previously
+    // scanned and trivially benign scripts without an AMSI round trip.
+    if (native?.getIsAmsiAvailable()) {
+      const scanResult = await native.scanContent(request.script, {
+        name: 'script.ps1',
+      });
       if (!scanResult.clean) {
         respond(
           createErrorResponse(
@@ -524,7 +671,7 @@ export class WindowsBrokerContext implements RuntimeContext {
     request: Extract<BrokerRequest, { type: 'amsiScan' }>,
     respond: (response: BrokerResponse) => void,
   ): Promise<void> {
-    if (!native?.isAmsiAvailable) {
+    if (!native?.getIsAmsiAvailable()) {
       respond(
         createSuccessResponse({
           clean: true,
@@ -535,8 +682,11 @@ export class WindowsBrokerContext implements RuntimeContext {
       return;
     }
 
-    const result = native.amsiScanBuffer(request.content, request.filename);
-    respond(createSuccessResponse(result));
+    const { clean, result, description } = await native.scanContent(
+      request.content,
+      { name: request.filename },
+    );
+    respond(createSuccessResponse({ clean, result, description }));
   }
 
   /**
@@ -558,6 +708,15 @@ export class WindowsBrokerContext implements RuntimeContext {
     return { ok: true };
   }
 
+  /**
+   * Current CPU, memory and I/O usage of the Brain and its descendants.
+   * Null unless the Brain was started with resourceLimits.
+   */
+  getResourceUsage(): ResourceSample | null {
+    if (this.brainPid === null) return null;
+    return native?.sampleSandboxResources(this.brainPid) ?? null;
+  }
+
   /**
    * Clean up resources.
    */
@@ -568,16 +727,28 @@ export class WindowsBrokerContext implements RuntimeContext {
       this.brokerServer = null;
     }
 
-    // Kill Brain process if still running
+    // Kill the Brain and everything it spawned (its Job Object)
     if (this.brainPid !== null) {
       try {
-        process.kill(this.brainPid, 'SIGTERM');
+        const teardown = await native?.killProcessTree(this.brainPid);
+        if (teardown) {
+          console.log(
+            `[WindowsBrokerContext] Brain tree killed via ${teardown.method} ` +
+              `in ${(teardown.latencyUs / 1000).toFixed(1)}ms`,
+          );
+        }
       } catch {
         // Process may already be dead
       }
+      native?.releaseSandboxResources(this.brainPid);
       this.brainPid = null;
     }
 
+    // Stop watching the command policy file
+    if (this.commandPolicyPath) {
+      native?.unloadCommandPolicy();
+    }
+
     console.log('[WindowsBrokerContext] Disposed');
   }
 
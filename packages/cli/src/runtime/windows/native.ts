@@ -11,11 +11,20 @@
  * This module provides a type-safe interface to the Windows-specific
  * native functionality. On non-Windows platforms, the functions either
  * return appropriate defaults or throw errors.
+ *
+ * Content hashing (BLAKE3 digests and workspace snapshots) is available on
+ * every platform the native module is built for, as is the compiled command
+ * policy used to vet broker execute requests.
+ *
+ * On Linux, the module also launches sandboxed processes in user/mount
+ * namespaces, optionally on a copy-on-write overlay of the workspace and
+ * under a seccomp filter compiled from a capability profile.
  */
 
 import { createRequire } from 'node:module';
 import * as path from 'node:path';
 import * as fs from 'node:fs';
+import * as os from 'node:os';
 
 // ============================================================================
 // Type Definitions
@@ -30,12 +39,942 @@ export interface AmsiScanResult {
   description: string;
 }
 
+/**
+ * Deadline and cancellation for long-running native operations. A stopped
+ * operation rejects with an Error named 'AbortError' (signal) or
+ * 'TimeoutError' (deadline).
+ */
+export interface NativeCancelOptions {
+  /** Stop once this many milliseconds have passed */
+  timeoutMs?: number;
+  /** Stop when aborted */
+  signal?: AbortSignal;
+}
+
+export interface CancellationCounters {
+  started: number;
+  /** Ran to the end, successfully or not */
+  completed: number;
+  cancelled: number;
+  expired: number;
+}
+
+/** Scheduling class of pooled native work, most urgent first */
+export type NativeWorkPriority = 'interactive' | 'normal' | 'bulk';
+
+/**
+ * Scheduling of an operation's work on the shared native worker pool.
+ * Sessions of the same class take turns.
+ */
+export interface NativeScheduleOptions {
+  priority?: NativeWorkPriority;
+  sessionId?: string;
+}
+
+export interface SchedulerConfig {
+  /** Worker threads (default: hardware concurrency) */
+  threads?: number;
+  /** Workers that never run bulk work (default: 1) */
+  reservedInteractive?: number;
+  /** Queued tasks per class before producers run their own (default: 4096) */
+  queueCapacity?: number;
+  /** Pin worker i to CPU i (default: false) */
+  pinThreads?: boolean;
+}
+
+export interface SchedulerClassStats {
+  submitted: number;
+  completed: number;
+  /** Tasks refused at capacity and run by their producer instead */
+  rejected: number;
+  /** Tasks an idle worker took from another worker */
+  stolen: number;
+  queued: number;
+  maxQueued: number;
+  /** Queue wait percentiles (log2 bucket upper bounds) */
+  waitUs: { p50: number; p90: number; p99: number; max: number };
+  /** Bucket 0: zero; bucket i: [2^(i-1), 2^i) microseconds */
+  waitHistogram: number[];
+  /** Queued tasks of the class at each submission, same buckets */
+  depthHistogram: number[];
+}
+
+export interface SchedulerStats extends Required<SchedulerConfig> {
+  /** Whether the pool has started (after which it cannot be configured) */
+  started: boolean;
+  interactive: SchedulerClassStats;
+  normal: SchedulerClassStats;
+  bulk: SchedulerClassStats;
+}
+
+export type NativeCancellationStats = Record<
+  | 'hashFile'
+  | 'snapshotDirectory'
+  | 'diffOverlay'
+  | 'commitOverlay'
+  | 'grantPathAccess'
+  | 'launchSandbox'
+  | 'waitSandbox'
+  | 'scanArchive'
+  | 'writeFileScanned'
+  | 'stageWorkspace'
+  | 'spawnProcess',
+  CancellationCounters
+>;
+
+/** 'auto' = AMSI on Windows, the portable signature engine elsewhere */
+export type NativeScanEngine = 'auto' | 'amsi' | 'portable';
+
+export interface ArchiveScanOptions
+  extends NativeCancelOptions,
+    NativeScheduleOptions {
+  /** Largest decompressed member (default: 64 MiB) */
+  maxEntryBytes?: number;
+  /** Decompressed bytes across the archive (default: 1 GiB) */
+  maxTotalBytes?: number;
+  /** Largest expansion ratio, per stream and overall (default: 100) */
+  maxRatio?: number;
+  /** Members across the archive, nested ones included (default: 100000) */
+  maxEntries?: number;
+  /** Levels of nested archives to open (default: 2) */
+  maxDepth?: number;
+  engine?: NativeScanEngine;
+  /** Byte patterns the portable engine flags, besides EICAR */
+  signatures?: Array<{ name: string; pattern: string | Buffer }>;
+  /** Content name of a Buffer archive (default: 'archive') */
+  name?: string;
+}
+
+export interface ArchiveScanResult {
+  /** No threats, every member scanned and no limit hit */
+  clean: boolean;
+  format:
+    | 'zip'
+    | 'tar'
+    | 'gzip'
+    | 'zstd'
+    | 'tar+gzip'
+    | 'tar+zstd'
+    | 'none';
+  engine: 'amsi' | 'portable';
+  entries: number;
+  scannedEntries: number;
+  scannedBytes: number;
+  compressedBytes: number;
+  durationMs: number;
+  /** Inner paths, nested archives joined with '!/' */
+  threats: Array<{ path: string; result: number; description: string }>;
+  /** Encrypted, unsupported, corrupt or too deeply nested members */
+  unscanned: Array<{ path: string; reason: string }>;
+  /** The limit that stopped the scan, if one did */
+  limit: {
+    kind: 'entrySize' | 'totalSize' | 'ratio' | 'entries' | 'overlap';
+    path: string;
+    detail: string;
+  } | null;
+}
+
+export interface ScannedWriteOptions
+  extends NativeCancelOptions,
+    NativeScheduleOptions {
+  engine?: NativeScanEngine;
+  /** Byte patterns the portable engine flags, besides EICAR */
+  signatures?: Array<{ name: string; pattern: string | Buffer }>;
+  /** Name shown to the engine (default: the target's file name) */
+  contentName?: string;
+  /** fsync the file and its directory before resolving (default: false) */
+  durable?: boolean;
+}
+
+export interface ScannedWriteResult {
+  /** The target now holds the content; false when it was not clean */
+  written: boolean;
+  clean: boolean;
+  result: number;
+  description: string;
+  engine: 'amsi' | 'portable';
+  /** BLAKE3 hex digest of the content, when written */
+  hash: string | null;
+  bytes: number;
+  /** Bytes that reached disk before the verdict (0 for small payloads) */
+  bytesWritten: number;
+  durationMs: number;
+}
+
+export interface SnapshotOptions
+  extends NativeCancelOptions,
+    NativeScheduleOptions {
+  /** Entry names (not paths) to skip at any depth, e.g. '.git' */
+  exclude?: string[];
+  /** 1 = hash on a single thread; omitted = use every core */
+  threads?: number;
+  /** Return every entry, not just the summary */
+  includeEntries?: boolean;
+  /** File used to persist the manifest so later processes can reuse it */
+  manifestPath?: string;
+}
+
+export interface SnapshotEntry {
+  /** Path relative to the snapshot root, '/'-separated ('' for the root) */
+  path: string;
+  type: 'file' | 'directory' | 'symlink';
+  size: number;
+  /** Hex BLAKE3 digest (Merkle hash for directories) */
+  hash: string;
+}
+
+export interface SnapshotResult {
+  /** Merkle root digest of the directory */
+  root: string;
+  files: number;
+  directories: number;
+  symlinks: number;
+  /** Total size of all files */
+  totalBytes: number;
+  /** Bytes actually read and hashed (cache misses) */
+  hashedBytes: number;
+  /** Files whose hash was reused from the previous snapshot */
+  reusedFiles: number;
+  /** Directories whose whole subtree was unchanged */
+  reusedDirectories: number;
+  /** Entries that vanished or could not be read during the walk */
+  skipped: number;
+  durationMs: number;
+  entries?: SnapshotEntry[];
+}
+
+export interface StageOptions {
+  /** Entry names (not paths) to skip at any depth, e.g. '.git' */
+  exclude?: string[];
+  /**
+   * When a file counts as unchanged: same size and mtime ('metadata',
+   * default), same size and BLAKE3 digest ('hash'), or never ('always')
+   */
+  compare?: 'metadata' | 'hash' | 'always';
+  /** Remove destination entries the source does not have */
+  mirror?: boolean;
+  /** Clone files where the filesystem supports it (default: true) */
+  reflink?: boolean;
+  /** Batch metadata calls through io_uring on Linux (default: true) */
+  ioUring?: boolean;
+  /** 1 = copy on a single thread; omitted = use every core */
+  threads?: number;
+}
+
+export interface StageProgress {
+  phase: 'scan' | 'copy';
+  /** Entries found (scan) or files handled (copy) */
+  files: number;
+  /** Files to copy; 0 while scanning */
+  totalFiles: number;
+  bytes: number;
+  totalBytes: number;
+  /** Set on the last update of a stage that completed */
+  done: boolean;
+}
+
+export interface StageWorkspaceOptions
+  extends StageOptions,
+    NativeCancelOptions,
+    NativeScheduleOptions {
+  /** Called at most every progressIntervalMs; only the last is never dropped */
+  onProgress?: (progress: StageProgress) => void;
+  /** Default: 100 */
+  progressIntervalMs?: number;
+}
+
+export interface StageResult {
+  files: number;
+  directories: number;
+  symlinks: number;
+  copiedFiles: number;
+  copiedBytes: number;
+  /** Copied files that were cloned instead of copied byte by byte */
+  reflinkedFiles: number;
+  /** Files the comparison found up to date */
+  unchangedFiles: number;
+  /** Destination entries removed by mirroring */
+  removedEntries: number;
+  /** Entries that could not be staged */
+  failed: number;
+  /** The first few failures, as '<relative path>: <reason>' */
+  errors: string[];
+  engine: 'io_uring' | 'syscalls' | 'portable';
+  durationMs: number;
+}
+
+export interface CommandPolicyRequest {
+  command: string;
+  args?: string[];
+  cwd?: string;
+  env?: Record<string, string>;
+}
+
+export interface CommandPolicyDecision {
+  allowed: boolean;
+  /** 'default' when no rule matched and the default action applied */
+  action: 'allow' | 'deny' | 'default';
+  ruleId: string | null;
+  /** Source line of the deciding rule (0 for the default action) */
+  line: number;
+}
+
+export interface CommandPolicyLoadResult {
+  ok: boolean;
+  rules: number;
+  /** Incremented on every successful (re)load */
+  version: number;
+  error?: string;
+}
+
+export interface CommandPolicyInfo {
+  loaded: boolean;
+  path: string;
+  rules: number;
+  version: number;
+  evaluations: number;
+  averageEvalNs: number;
+  /** Last compile error; the previous policy stays active when set */
+  lastError: string | null;
+}
+
+export interface HashAllowlistBuildResult {
+  /** Distinct hashes written */
+  entries: number;
+  bytes: number;
+  durationMs: number;
+}
+
+export interface HashAllowlistLoadResult {
+  ok: boolean;
+  entries: number;
+  /** Incremented on every successful load */
+  version: number;
+  loadMs: number;
+  error?: string;
+}
+
+export interface HashAllowlistInfo {
+  loaded: boolean;
+  path: string | null;
+  entries: number;
+  bytes: number;
+  version: number;
+  lookups: number;
+  hits: number;
+  /** hits / lookups (0 before the first lookup) */
+  hitRate: number;
+  /** Last load error; the previous table stays active when set */
+  lastError: string | null;
+}
+
+export interface RuleDatabaseCompileResult {
+  rules: number;
+  bytes: number;
+  durationMs: number;
+}
+
+export interface RuleDatabaseLoadResult {
+  ok: boolean;
+  rules: number;
+  /** Incremented on every successful load */
+  version: number;
+  loadMs: number;
+  error?: string;
+}
+
+export interface RuleDatabaseInfo {
+  loaded: boolean;
+  path: string | null;
+  rules: number;
+  bytes: number;
+  version: number;
+  /** Portable-engine scans that consulted the database */
+  scans: number;
+  matches: number;
+  /** Last load error; the previous database stays active when set */
+  lastError: string | null;
+}
+
+export type ScanPipelineTier =
+  | 'allowlist'
+  | 'cache'
+  | 'classifier'
+  | 'provider';
+
+/** Why the pre-classifier passed content on to the next tier */
+export type ScanEscalation =
+  | 'size'
+  | 'binary'
+  | 'entropy'
+  | 'longLine'
+  | 'literal'
+  | 'blocked'
+  | 'policy';
+
+export interface ScanContentOptions extends NativeScheduleOptions {
+  /** Content name shown to the engine (default: 'content') */
+  name?: string;
+  engine?: NativeScanEngine;
+  /** Byte patterns the portable engine flags, besides EICAR */
+  signatures?: Array<{ name: string; pattern: string | Buffer }>;
+}
+
+export interface ScanContentResult extends AmsiScanResult {
+  engine: 'amsi' | 'portable';
+  /** The tier that decided */
+  tier: ScanPipelineTier;
+  /** Set if the pre-classifier passed the content on */
+  escalation: ScanEscalation | null;
+  /** Set if a normalized or decoded layer, not the content, decided */
+  layer: { kind: NormalizedSpanKind; depth: number } | null;
+  latencyUs: number;
+}
+
+/** Which verdicts a tier may emit; it escalates anything else. */
+export interface ScanTierPolicy {
+  enabled?: boolean;
+  emit?: Array<'clean' | 'detected'>;
+}
+
+/** Omitted fields take their defaults. */
+export interface ScanPipelinePolicy {
+  /** Default: clears allowlisted hashes */
+  allowlist?: { enabled?: boolean; emit?: Array<'clean'> };
+  /** Default: replays both verdicts, 4096 entries, 10 minutes */
+  cache?: ScanTierPolicy & { entries?: number; ttlMs?: number };
+  /**
+   * Default: escalates everything (emit: []); with emit: ['clean'], clears
+   * up to 4 KiB, entropy 5.5, lines up to 1024 bytes
+   */
+  classifier?: ScanTierPolicy & {
+    maxBytes?: number;
+    /** Bits per byte */
+    maxEntropy?: number;
+    maxLineBytes?: number;
+    /** Extra literals that escalate (case-insensitive) */
+    suspicious?: string[];
+    /** Literals that block when 'detected' may be emitted */
+    block?: Array<{ name: string; pattern: string | Buffer }>;
+  };
+  /** Default: enabled, 4 decoding layers, 16 MiB of layers */
+  normalize?: {
+    enabled?: boolean;
+    maxDepth?: number;
+    maxOutputBytes?: number;
+  };
+}
+
+export type ScriptLanguage = 'auto' | 'powershell' | 'shell';
+
+export type NormalizedSpanKind = 'source' | 'normalized' | 'decoded';
+
+export interface NormalizeScriptOptions {
+  /** Default: decided from the content */
+  language?: ScriptLanguage;
+  /** Decoding layers followed (default 4, at most 16) */
+  maxDepth?: number;
+  /** Normalized and decoded bytes kept (default 16 MiB) */
+  maxOutputBytes?: number;
+}
+
+export interface NormalizedSpan {
+  kind: NormalizedSpanKind;
+  /** 'binary' for decoded payloads that are not text */
+  language: Exclude<ScriptLanguage, 'auto'> | 'binary';
+  /** Times decoded: 0 for the script and its normalized text */
+  depth: number;
+  /** Binary payloads are given as latin1 */
+  text: string;
+}
+
+export interface NormalizeScriptResult {
+  language: Exclude<ScriptLanguage, 'auto'> | 'binary';
+  /** The script first, then each normalized layer and decoded payload */
+  spans: NormalizedSpan[];
+  layers: number;
+  decoded: number;
+  concatenations: number;
+  escapes: number;
+  depth: number;
+  /** A payload was dropped at the depth or output limit */
+  limited: boolean;
+  /** Working buffers that grew; 0 once the normalizer is warmed up */
+  bufferGrowths: number;
+}
+
+export interface ScriptNormalizerStats {
+  scripts: number;
+  bytesIn: number;
+  bytesOut: number;
+  layers: number;
+  decoded: number;
+  concatenations: number;
+  escapes: number;
+  limited: number;
+  bufferGrowths: number;
+}
+
+export interface ScanTierStats {
+  scans: number;
+  clean: number;
+  detected: number;
+  escalated: number;
+  /** Bucket upper bounds (powers of two) */
+  latencyUs: { p50: number; p90: number; p99: number; max: number };
+  totalUs: number;
+}
+
+export interface ScanPipelineStats {
+  tiers: Record<ScanPipelineTier, ScanTierStats>;
+  /** Pre-classifier escalations by reason */
+  escalations: Record<ScanEscalation, number>;
+  cache: {
+    entries: number;
+    capacity: number;
+    hits: number;
+    misses: number;
+    evictions: number;
+    expired: number;
+  };
+}
+
+/**
+ * Linux equivalent of AppContainer capabilities, enforced with seccomp.
+ * Omitted fields keep their defaults (network and write/spawn allowed,
+ * no serving).
+ */
+export interface SandboxCapabilities {
+  /** Outbound internet sockets (AF_INET/AF_INET6) */
+  network?: boolean;
+  /** Sockets plus listen/accept (local servers) */
+  privateNetwork?: boolean;
+  /** Opening files for writing, creating, deleting, renaming, chmod */
+  filesystemWrite?: boolean;
+  /** fork/vfork/clone of new processes (threads are always allowed) */
+  processSpawn?: boolean;
+}
+
+export interface SeccompFilterInfo {
+  /** BLAKE3 of the canonical profile; the cache key */
+  hash: string;
+  instructions: number;
+  source: 'compiled' | 'memory' | 'disk';
+  durationUs: number;
+}
+
+/**
+ * Per-sandbox resource limits (cgroup v2 on Linux, Job Object on Windows).
+ * Limits the host cannot enforce are skipped with a warning; see
+ * getResourceGovernorSupport().
+ */
+export interface SandboxResourceLimits {
+  /** Relative CPU share, 1..10000 (default 100) */
+  cpuWeight?: number;
+  /** CPU time in percent of one CPU (150 = 1.5 CPUs) */
+  cpuQuotaPercent?: number;
+  /** Hard memory limit in bytes */
+  memoryMax?: number;
+  /** Memory throttling threshold in bytes (Linux only) */
+  memoryHigh?: number;
+  /** Tasks (Linux) or processes (Windows) */
+  pidsMax?: number;
+  /** Relative I/O share, 1..10000 (Linux only) */
+  ioWeight?: number;
+}
+
+/** Usage counters, cumulative since launch unless noted */
+export interface ResourceSample {
+  pid: number;
+  /** Date.now() at sampling time */
+  timestamp: number;
+  cpuUsageUs: number;
+  cpuUserUs: number;
+  cpuSystemUs: number;
+  /** Periods in which the CPU quota ran out, and time spent throttled */
+  cpuThrottledCount: number;
+  cpuThrottledUs: number;
+  /** Resident memory now */
+  memoryCurrent: number;
+  memoryPeak: number;
+  memoryHighEvents: number;
+  memoryMaxEvents: number;
+  oomKills: number;
+  ioReadBytes: number;
+  ioWriteBytes: number;
+  /** Live tasks/processes now */
+  pids: number;
+}
+
+export interface ResourceGovernorSupport {
+  available: boolean;
+  /** cgroup sandbox groups are created under (Linux) */
+  root: string;
+  /** Names of the SandboxResourceLimits fields this host enforces */
+  limits: Array<keyof SandboxResourceLimits>;
+  error?: string;
+}
+
+export interface TreeKillResult {
+  /**
+   * 'cgroup' / 'job': the whole tree in one kernel operation.
+   * 'processGroup' / 'process': no group was available.
+   */
+  method: 'cgroup' | 'job' | 'processGroup' | 'process';
+  /** From the kill request until the last process exited */
+  latencyUs: number;
+  /** false if processes were still alive when the timeout expired */
+  complete: boolean;
+}
+
+export interface LinuxSandboxOptions extends NativeCancelOptions {
+  /** argv; argv[0] is resolved against PATH from `env` */
+  command: string[];
+  /** Workspace path (default: the overlay's workspace) */
+  workspacePath?: string;
+  /** Working directory (default: workspacePath) */
+  cwd?: string;
+  /** Complete environment (default: inherit process.env) */
+  env?: Record<string, string>;
+  /** Run on this overlay workspace instead of the live directory */
+  overlayId?: string;
+  /** Install a seccomp filter for these capabilities (omitted = none) */
+  capabilities?: SandboxCapabilities & { dispatch?: 'binary' | 'linear' };
+  /** Limits for the sandbox's cgroup (omitted = accounting only) */
+  resources?: SandboxResourceLimits;
+}
+
+export interface LinuxSandboxExit {
+  exitCode: number | null;
+  signal: number | null;
+  timedOut: boolean;
+}
+
+export interface EgressPolicy {
+  /**
+   * Hosts that may be reached: "example.com", "*.example.com" (subdomains),
+   * an IP address, each optionally with ":port", or "*"
+   */
+  allow: string[];
+  /** Bytes per second in each direction, shared by all connections */
+  rate?: { bytesPerSec: number; burstBytes?: number };
+  /** Concurrent connections; more are answered 503 (default: 256) */
+  maxConnections?: number;
+  /** Names may resolve to loopback, private or link-local addresses */
+  allowPrivate?: boolean;
+}
+
+export interface EgressProxyOptions extends EgressPolicy {
+  /** Host loopback port (default: any free one) or Unix socket */
+  listen?: { port?: number } | { socketPath: string };
+}
+
+export interface EgressProxyHandle {
+  id: string;
+  /** Port on 127.0.0.1, or null for a Unix socket */
+  port: number | null;
+  socketPath: string | null;
+}
+
+export interface EgressHostStats {
+  host: string;
+  connections: number;
+  denied: number;
+  bytesUp: number;
+  bytesDown: number;
+}
+
+export interface EgressProxyStats {
+  id: string;
+  /** Listening sockets (a session has one per running launch) */
+  listeners: number;
+  /** Accepted since the proxy was created */
+  connections: number;
+  active: number;
+  /** Refused by the allowlist, the SNI check or the address check */
+  denied: number;
+  /** Unreachable upstreams, timeouts and connections over the limit */
+  failed: number;
+  /** Client to upstream */
+  bytesUp: number;
+  bytesDown: number;
+  /** Times a direction paused for the rate limit */
+  throttled: number;
+  spliceCalls: number;
+  /** At most 256; later hosts are counted under "(other)" */
+  hosts: EgressHostStats[];
+}
+
+export interface SandboxSessionOptions {
+  workspacePath: string;
+  /** Seccomp filter for every process in the session (Linux) */
+  capabilities?: SandboxCapabilities & { dispatch?: 'binary' | 'linear' };
+  /** Limits shared by the whole session */
+  resources?: SandboxResourceLimits;
+  /** Grant the internetClient capability (Windows, default: true) */
+  enableInternet?: boolean;
+  /**
+   * Linux: each process gets a network namespace whose only way out is
+   * the session's proxy on 127.0.0.1:port (default 3128)
+   */
+  egress?: EgressPolicy & { port?: number };
+  /** Fill the workspace from `source` before the session is usable */
+  stage?: StageOptions & { source: string };
+}
+
+export type SandboxSessionCreated = Pick<
+  SandboxSessionInfo,
+  'id' | 'workspacePath' | 'sid'
+> & {
+  /** What staging did, or null without `stage` */
+  staged: StageResult | null;
+};
+
+/** Per-launch options; the session fixes workspace, filter and limits */
+export type SandboxSessionLaunchOptions = Omit<
+  LinuxSandboxOptions,
+  'capabilities' | 'resources'
+>;
+
+export interface SandboxSessionInfo {
+  id: string;
+  workspacePath: string;
+  /** The session's AppContainer SID (Windows), otherwise null */
+  sid: string | null;
+  /** Date.now() at creation */
+  createdAt: number;
+  launches: number;
+  failures: number;
+  /** Processes alive in the session now */
+  running: number;
+  /** Usage of the session's cgroup/job; null without one */
+  resources: Omit<ResourceSample, 'pid' | 'timestamp'> | null;
+  /** Counters of the session's egress proxy; null without one */
+  egress: EgressProxyStats | null;
+}
+
+export interface OverlayWorkspace {
+  id: string;
+  /** Workspace directory the overlay is layered on */
+  lower: string;
+  /** Directory collecting the sandbox's writes */
+  upper: string;
+  work: string;
+}
+
+export interface OverlayChange {
+  /** Path relative to the workspace, '/'-separated */
+  path: string;
+  kind: 'added' | 'modified' | 'deleted' | 'replaced';
+  directory: boolean;
+  size: number;
+}
+
+/** Sandbox options of a terminal session, per platform */
+export type PtySandboxOptions = Omit<
+  LinuxSandboxOptions,
+  'command' | 'cwd' | 'env' | keyof NativeCancelOptions
+> & {
+  /** Windows: grant the internetClient capability (default: true) */
+  enableInternet?: boolean;
+};
+
+export interface PtyOptions {
+  /** argv; argv[0] is resolved against PATH */
+  command: string[];
+  cwd?: string;
+  /** Complete environment (default: process.env, TERM=xterm-256color) */
+  env?: Record<string, string>;
+  /** Initial size (default: 80x24) */
+  cols?: number;
+  rows?: number;
+  /**
+   * Run in the platform sandbox (namespaces / AppContainer). Omitted = host
+   * process, which still gets its own cgroup / Job Object.
+   */
+  sandbox?: PtySandboxOptions;
+  /**
+   * Terminal output. The Buffer's memory is reused once the callback
+   * returns: decode or copy it before then.
+   */
+  onData: (chunk: Buffer) => void;
+  /** Called once, after the last onData */
+  onExit: (exit: PtyExit) => void;
+}
+
+export interface PtyExit {
+  exitCode: number | null;
+  signal: number | null;
+}
+
+export interface PtyStats {
+  bytesRead: number;
+  /** onData calls, and those that got a copy instead of a lent slab */
+  chunks: number;
+  copiedChunks: number;
+  bytesWritten: number;
+  /** writePty calls, and the write system calls they were batched into */
+  writeCalls: number;
+  writeSyscalls: number;
+}
+
+export interface SpawnProcessOptions
+  extends Pick<NativeCancelOptions, 'signal'> {
+  /** Working directory (default: inherited) */
+  cwd?: string;
+  /** Variables set on top of the base environment (see setSpawnEnvironment) */
+  env?: Record<string, string>;
+  /** Kill the process group and resolve with timedOut: true (default: none) */
+  timeoutMs?: number;
+  /** Per stream; the rest is discarded (default: 64 MiB) */
+  maxOutputBytes?: number;
+}
+
+export interface SpawnResult {
+  pid: number;
+  /** null if the process was killed by a signal */
+  exitCode: number | null;
+  signal: number | null;
+  stdout: string;
+  stderr: string;
+  timedOut: boolean;
+  /** A stream went past maxOutputBytes */
+  truncated: boolean;
+  durationMs: number;
+}
+
+export interface SpawnStats {
+  spawned: number;
+  /** Commands that could not be started */
+  failed: number;
+  running: number;
+  exited: number;
+  timedOut: number;
+  /** Killed by an aborted signal */
+  aborted: number;
+  /** Times the service thread woke up */
+  wakeups: number;
+  /** Calls onto the JS thread; each resolves every process done by then */
+  deliveries: number;
+  largestDelivery: number;
+  /** Armed timeouts */
+  timers: number;
+  /** Variables in the base environment */
+  baseVariables: number;
+}
+
+export interface NativeProviderStatus {
+  /**
+   * 'amsi' and 'appContainerProfile' on Windows; 'portable' (scanner
+   * without AMSI), 'cgroupRoot' and 'seccompProfile' on Linux
+   */
+  name: string;
+  /** Attempted, successfully or not */
+  ready: boolean;
+  available: boolean;
+  durationUs: number;
+  error?: string;
+}
+
+export interface NativeReadiness {
+  state: 'idle' | 'initializing' | 'ready';
+  /** Wall time of the whole run (0 until ready) */
+  totalUs: number;
+  providers: NativeProviderStatus[];
+}
+
+export interface NativeTraceOptions {
+  /** Longer strings are recorded as length + digest (default: 256) */
+  maxStringBytes?: number;
+  /** Payload prefix digested per Buffer (default: 65536) */
+  maxDigestBytes?: number;
+  /**
+   * Record every string as length + digest (default: true). When false,
+   * strings under an `env` key are still digested.
+   */
+  redactStrings?: boolean;
+  /** Stop recording calls past this trace size (default: 256 MiB) */
+  maxBytes?: number;
+}
+
+export interface NativeTraceSummary {
+  path: string;
+  calls: number;
+  /** Calls not recorded because the trace reached maxBytes */
+  dropped: number;
+  bytes: number;
+  durationMs: number;
+}
+
+export interface NativeTraceCall {
+  seq: number;
+  /** Export called */
+  name: string;
+  /** Offset from the start of the trace */
+  startUs: number;
+  /** Time until the export returned */
+  syncUs: number;
+  /** Until the returned promise settled; null if it never did */
+  durationUs: number | null;
+  status: 'returned' | 'threw' | 'resolved' | 'rejected' | 'pending';
+  /**
+   * Decoded arguments. Digested strings and Buffers appear as
+   * { $string | $buffer: length, digest }, functions as
+   * { $function: true }, values cut off by depth as { $truncated: true }
+   * and arrays over 64 entries as { $array: length, items }.
+   */
+  args: unknown[];
+  result: unknown;
+  /** String and Buffer bytes across the arguments */
+  payloadBytes: number;
+}
+
+export interface NativeTrace {
+  version: number;
+  /** Date.now() when recording started */
+  startedAt: number;
+  durationMs: number;
+  dropped: number;
+  /** false if the recording process died before stopping the trace */
+  complete: boolean;
+  calls: NativeTraceCall[];
+}
+
+export interface AccessGrantOptions
+  extends NativeCancelOptions,
+    NativeScheduleOptions {
+  path: string;
+  /**
+   * SID on Windows ('S-1-15-2-1', an AppContainer SID); 'u:<uid>' or
+   * 'g:<gid>' on Linux
+   */
+  principal: string;
+  /** Any of 'r', 'w', 'x' ('x' on files only where already executable) */
+  rights: string;
+  /** Whole tree, inherited by new entries (default: false) */
+  recursive?: boolean;
+}
+
+export interface AccessGrantResult {
+  /** Verified earlier and the root is unchanged; nothing was read */
+  cached: boolean;
+  /** Entries whose ACL was read, written, or could not be handled */
+  checked: number;
+  granted: number;
+  failed: number;
+  latencyUs: number;
+}
+
+type NativePtyOptions = Omit<PtyOptions, 'sandbox'> &
+  PtySandboxOptions & { sandbox: boolean };
+
 export interface NativeModule {
   /** Create a process running in AppContainer sandbox */
   createAppContainerSandbox: (
     commandLine: string,
     workspacePath: string,
     enableInternet?: boolean,
+    resources?: SandboxResourceLimits,
   ) => number;
 
   /** Get the SID of the TerminAI AppContainer profile */
@@ -50,11 +989,309 @@ export interface NativeModule {
   /** Scan a file for malware by reading its contents */
   amsiScanFile: (filepath: string) => AmsiScanResult;
 
+  /** BLAKE3 digest of an in-memory payload */
+  hashBuffer: (content: Buffer | string) => string;
+
+  /** BLAKE3 digest of a file, computed off the main thread */
+  hashFile: (
+    filepath: string,
+    options?: { threads?: number } & NativeCancelOptions &
+      NativeScheduleOptions,
+  ) => Promise<string>;
+
+  /** Scan archive members in memory, without extracting */
+  scanArchive: (
+    source: string | Buffer,
+    options?: ArchiveScanOptions,
+  ) => Promise<ArchiveScanResult>;
+
+  /** Write a file only if its content scans clean */
+  writeFileScanned: (
+    filepath: string,
+    content: Buffer | string,
+    options?: ScannedWriteOptions,
+  ) => Promise<ScannedWriteResult>;
+
+  /** Merkle snapshot of a directory */
+  snapshotDirectory: (
+    root: string,
+    options?: SnapshotOptions,
+  ) => Promise<SnapshotResult>;
+
+  /** Forget cached snapshot manifests */
+  clearSnapshotCache: (root?: string) => void;
+
+  /** Copy or sync a directory tree */
+  stageWorkspace: (
+    source: string,
+    destination: string,
+    options?: StageWorkspaceOptions,
+  ) => Promise<StageResult>;
+
+  /** Load a command policy file, optionally watching it for changes */
+  loadCommandPolicy: (
+    policyPath: string,
+    options?: { watchIntervalMs?: number },
+  ) => CommandPolicyLoadResult;
+
+  /** Compile and activate command policy text */
+  compileCommandPolicy: (text: string) => CommandPolicyLoadResult;
+
+  /** Evaluate a request; null when no policy is loaded */
+  evaluateCommandPolicy: (
+    request: CommandPolicyRequest,
+  ) => CommandPolicyDecision | null;
+
+  /** Describe the active command policy */
+  getCommandPolicyInfo: () => CommandPolicyInfo;
+
+  /** Deactivate the command policy */
+  unloadCommandPolicy: () => void;
+
+  /** Build a known-good hash table file */
+  buildHashAllowlist: (
+    hashes: Array<string | Buffer> | Buffer,
+    outPath: string,
+  ) => Promise<HashAllowlistBuildResult>;
+
+  /** Map a hash table file and make it the active allowlist */
+  loadHashAllowlist: (
+    tablePath: string,
+    options?: { verify?: boolean },
+  ) => HashAllowlistLoadResult;
+
+  /** Check a BLAKE3 digest against the active allowlist */
+  isHashAllowlisted: (hash: string | Buffer) => boolean;
+
+  /** Describe the active allowlist and its hit rate */
+  getHashAllowlistInfo: () => HashAllowlistInfo;
+
+  /** Deactivate the allowlist */
+  unloadHashAllowlist: () => void;
+
+  /** Compile portable-engine rules into a database file */
+  compileRuleDatabase: (
+    rules: Array<{ name: string; pattern: string | Buffer }>,
+    outPath: string,
+  ) => Promise<RuleDatabaseCompileResult>;
+
+  /** Map a rule database file and make it the active database */
+  loadRuleDatabase: (
+    databasePath: string,
+    options?: { verify?: boolean },
+  ) => RuleDatabaseLoadResult;
+
+  /** Describe the active rule database */
+  getRuleDatabaseInfo: () => RuleDatabaseInfo;
+
+  /** Deactivate the rule database */
+  unloadRuleDatabase: () => void;
+
+  /** Scan one buffer through the allowlist, cache, classifier and engine */
+  scanContent: (
+    content: Buffer | string,
+    options?: ScanContentOptions,
+  ) => Promise<ScanContentResult>;
+
+  /** Replace the scan pipeline's tier policy */
+  configureScanPipeline: (policy: ScanPipelinePolicy) => boolean;
+
+  /** Per-tier decisions and latency */
+  getScanPipelineStats: () => ScanPipelineStats;
+
+  /** Zero the pipeline counters, optionally dropping cached verdicts */
+  resetScanPipelineStats: (options?: { cache?: boolean }) => void;
+
+  /** Undo escapes, concatenation and encoded payloads in a script */
+  normalizeScript: (
+    script: Buffer | string,
+    options?: NormalizeScriptOptions,
+  ) => NormalizeScriptResult;
+
+  /** Normalizer counters since load */
+  getScriptNormalizerStats: () => ScriptNormalizerStats;
+
+  /** Launch a process in a user/mount namespace (Linux) */
+  createLinuxSandbox: (options: LinuxSandboxOptions) => number;
+
+  /** Wait for and reap a sandboxed process */
+  waitLinuxSandbox: (
+    pid: number,
+    options?: number | NativeCancelOptions,
+  ) => Promise<LinuxSandboxExit>;
+
+  /** Whether user namespaces and overlayfs are usable */
+  getLinuxSandboxSupport: () => { userNamespaces: boolean; overlay: boolean };
+
+  /** Create a copy-on-write overlay of a workspace */
+  createOverlayWorkspace: (
+    workspacePath: string,
+    stateRoot: string,
+  ) => OverlayWorkspace;
+
+  /** List an overlay's changes */
+  diffOverlayWorkspace: (
+    id: string,
+    options?: NativeCancelOptions,
+  ) => Promise<OverlayChange[]>;
+
+  /** Apply an overlay's changes to the workspace */
+  commitOverlayWorkspace: (
+    id: string,
+    options?: NativeCancelOptions,
+  ) => Promise<{ written: number; removed: number; bytes: number }>;
+
+  /** Throw an overlay away */
+  discardOverlayWorkspace: (id: string) => boolean;
+
+  /** Compile (or fetch from cache) a capability profile's seccomp filter */
+  compileSeccompFilter: (
+    capabilities: SandboxCapabilities & { dispatch?: 'binary' | 'linear' },
+  ) => SeccompFilterInfo;
+
+  /** Set the on-disk seccomp cache directory ('' disables it) */
+  setSeccompCacheDirectory: (dir?: string) => void;
+
+  /** Drop the in-memory seccomp cache */
+  clearSeccompCache: () => void;
+
+  /** Create a named sandbox session */
+  createSandboxSession: (
+    id: string,
+    options: SandboxSessionOptions,
+  ) => Promise<SandboxSessionCreated>;
+
+  /** Launch a process in a session */
+  launchInSandboxSession: (
+    id: string,
+    options: SandboxSessionLaunchOptions,
+  ) => number;
+
+  /** Describe one session */
+  getSandboxSession: (id: string) => SandboxSessionInfo | null;
+
+  /** Describe every session */
+  listSandboxSessions: () => SandboxSessionInfo[];
+
+  /** Kill a session's processes and remove it */
+  destroySandboxSession: (
+    id: string,
+    options?: { timeoutMs?: number },
+  ) => Promise<(TreeKillResult & { processes: number }) | null>;
+
+  /** Start a standalone egress proxy (Linux) */
+  createEgressProxy: (options: EgressProxyOptions) => EgressProxyHandle;
+
+  /** Counters of a proxy ("session:<id>" for a session's) */
+  getEgressProxyStats: (id: string) => EgressProxyStats | null;
+
+  /** Close a standalone proxy */
+  closeEgressProxy: (id: string) => boolean;
+
+  /** Read a governed sandbox's usage now */
+  sampleSandboxResources: (pid: number) => ResourceSample | null;
+
+  /** Sample all governed sandboxes on a fixed cadence */
+  startResourceSampler: (
+    intervalMs: number,
+    callback: (samples: ResourceSample[]) => void,
+  ) => void;
+
+  /** Stop the sampler */
+  stopResourceSampler: () => { passes: number; dropped: number };
+
+  /** Stop tracking a sandbox and remove its cgroup/job */
+  releaseSandboxResources: (pid: number) => void;
+
+  /** Give a spawned process its own cgroup/job */
+  attachProcessTree: (pid: number) => boolean;
+
+  /** Kill a sandbox and every descendant */
+  killProcessTree: (pid: number, timeoutMs?: number) => Promise<TreeKillResult>;
+
+  /** Set the cgroup sandbox groups are created under (Linux) */
+  setResourceGovernorRoot: (root?: string) => void;
+
+  /** What the resource governor can enforce here */
+  getResourceGovernorSupport: () => ResourceGovernorSupport;
+
+  /** Start a process on a pseudo-terminal */
+  createPty: (options: NativePtyOptions) => number;
+
+  /** Queue terminal input */
+  writePty: (pid: number, data: string | Buffer) => boolean;
+
+  /** Change the terminal size */
+  resizePty: (pid: number, cols: number, rows: number) => boolean;
+
+  /** Hang up the terminal */
+  closePty: (pid: number) => void;
+
+  /** Transfer counters of a terminal session */
+  getPtyStats: (pid: number) => PtyStats | null;
+
+  /** Start a command on the host and collect its output */
+  spawnProcess: (
+    command: string,
+    args?: string[],
+    options?: SpawnProcessOptions,
+  ) => Promise<SpawnResult>;
+
+  /** Replace the base environment of spawned processes */
+  setSpawnEnvironment: (env?: Record<string, string>) => number;
+
+  /** Spawner counters */
+  getSpawnStats: () => SpawnStats | null;
+
+  /** Grant access where it is missing */
+  grantPathAccess: (options: AccessGrantOptions) => Promise<AccessGrantResult>;
+
+  /** Check a grant on one path */
+  checkPathAccess: (
+    path: string,
+    principal: string,
+    rights: string,
+    inheritable?: boolean,
+  ) => boolean;
+
+  /** Forget verified grants */
+  clearAccessGrantCache: () => void;
+
+  /** Initialize providers in the background */
+  warmUpNative: () => Promise<NativeReadiness>;
+
+  /** Initialization progress (never starts or waits) */
+  getNativeReadiness: () => NativeReadiness;
+
+  /** Record calls to this module's exports to a trace file */
+  startNativeTrace: (
+    path: string,
+    options?: NativeTraceOptions,
+  ) => { ok: boolean; exports: number; error?: string };
+
+  /** Stop recording and restore the exports */
+  stopNativeTrace: () => NativeTraceSummary | null;
+
+  /** Decode a trace file */
+  readNativeTrace: (path: string) => Promise<NativeTrace>;
+
+  /** Started / completed / cancelled / expired counts per operation */
+  getCancellationStats: () => NativeCancellationStats;
+
+  /** Size the shared worker pool; false once it has started */
+  configureScheduler: (config: SchedulerConfig) => boolean;
+
+  /** Worker pool configuration, counters and histograms */
+  getSchedulerStats: () => SchedulerStats;
+
+  /** Zero the worker pool's counters and histograms */
+  resetSchedulerStats: () => void;
+
   /** Whether running on Windows */
   isWindows: boolean;
 
-  /** Whether AMSI is initialized and available */
-  isAmsiAvailable: boolean;
+  /** Whether AMSI is available (the first read waits for initialization) */
+  readonly isAmsiAvailable: boolean;
 }
 
 // ============================================================================
@@ -69,11 +1306,6 @@ function loadNativeModule(): NativeModule | null {
   if (nativeModule) return nativeModule;
   if (loadError) return null;
 
-  // Skip load attempt on non-Windows platforms
-  if (process.platform !== 'win32') {
-    return null;
-  }
-
   try {
     // Native module is built by node-gyp to build/Release/terminai_native.node
     // Try different possible locations
@@ -106,6 +1338,13 @@ function loadNativeModule(): NativeModule | null {
       if (fs.existsSync(modulePath)) {
         nativeModule = requireFn(modulePath) as NativeModule;
         console.log('[native] Loaded native module from:', modulePath);
+        const tracePath = process.env['TERMINAI_NATIVE_TRACE'];
+        if (tracePath) {
+          const trace = nativeModule.startNativeTrace(tracePath);
+          if (!trace.ok) {
+            console.warn('[native] Trace not started:', trace.error);
+          }
+        }
         return nativeModule;
       }
     }
@@ -130,25 +1369,156 @@ function loadNativeModule(): NativeModule | null {
 export const isWindows = process.platform === 'win32';
 
 /**
- * Check if AMSI is available.
+ * Check if the native module was built and loaded for this platform.
+ */
+export function isNativeModuleAvailable(): boolean {
+  return loadNativeModule() !== null;
+}
+
+/**
+ * Check if AMSI is available. The first call waits for AMSI to initialize
+ * unless warmUpNative() has already done it.
  */
 export function getIsAmsiAvailable(): boolean {
+  if (process.platform !== 'win32') return false;
   const native = loadNativeModule();
   return native?.isAmsiAvailable ?? false;
 }
 
+const NO_PROVIDERS: NativeReadiness = {
+  state: 'ready',
+  totalUs: 0,
+  providers: [],
+};
+
+/**
+ * Start initializing native providers (AMSI, sandbox profiles) on a
+ * background thread. Loading the module initializes nothing; without a
+ * warm-up, the first call that needs a provider starts the thread and
+ * waits for that provider.
+ *
+ * @returns Resolves once every provider has been attempted; failures are
+ *          reported per provider, not as a rejection
+ */
+export function warmUpNative(): Promise<NativeReadiness> {
+  const native = loadNativeModule();
+  if (!native) {
+    return Promise.resolve(NO_PROVIDERS);
+  }
+  return native.warmUpNative();
+}
+
 /**
- * Re-export isAmsiAvailable as a getter-like constant
+ * Report initialization progress without starting or waiting for it.
  */
-export const isAmsiAvailable =
-  process.platform === 'win32' ? getIsAmsiAvailable() : false;
+export function getNativeReadiness(): NativeReadiness {
+  return loadNativeModule()?.getNativeReadiness() ?? NO_PROVIDERS;
+}
 
 /**
- * Create a process running in AppContainer sandbox.
+ * Record every call into the native module (arguments, timings, results)
+ * to a compact binary trace, for replay with
+ * scripts/replay-native-trace.ts. Setting TERMINAI_NATIVE_TRACE to a path
+ * starts a trace when the module loads. Tracing costs nothing while off.
+ * The file is created readable by the current user only, and must not
+ * exist yet.
  *
- * @param commandLine Command line to execute (e.g., "node agent.js")
- * @param workspacePath Path to workspace directory
+ * @returns false if the trace file cannot be created or there is no module
+ */
+export function startNativeTrace(
+  tracePath: string,
+  options?: NativeTraceOptions,
+): boolean {
+  const native = loadNativeModule();
+  if (!native) return false;
+  const result = native.startNativeTrace(tracePath, options);
+  if (!result.ok) console.warn('[native] Trace not started:', result.error);
+  return result.ok;
+}
+
+/**
+ * Stop the running trace and write it out.
+ *
+ * @returns null if no trace is running
+ */
+export function stopNativeTrace(): NativeTraceSummary | null {
+  return loadNativeModule()?.stopNativeTrace() ?? null;
+}
+
+/**
+ * Decode a trace file written by startNativeTrace.
+ */
+export async function readNativeTrace(tracePath: string): Promise<NativeTrace> {
+  const native = loadNativeModule();
+  if (!native) {
+    throw new Error('Native module not available');
+  }
+  return native.readNativeTrace(tracePath);
+}
+
+/**
+ * Started / completed / cancelled / expired counts for every operation that
+ * takes a deadline or an abort signal; all zero without the native module.
+ */
+export function getCancellationStats(): NativeCancellationStats {
+  const native = loadNativeModule();
+  if (native) {
+    return native.getCancellationStats();
+  }
+  const zero = (): CancellationCounters => ({
+    started: 0,
+    completed: 0,
+    cancelled: 0,
+    expired: 0,
+  });
+  return {
+    hashFile: zero(),
+    snapshotDirectory: zero(),
+    diffOverlay: zero(),
+    commitOverlay: zero(),
+    grantPathAccess: zero(),
+    launchSandbox: zero(),
+    waitSandbox: zero(),
+    scanArchive: zero(),
+    writeFileScanned: zero(),
+    stageWorkspace: zero(),
+    spawnProcess: zero(),
+  };
+}
+
+/**
+ * Size the shared native worker pool. Only takes effect before the first
+ * pooled operation, so call it during startup.
+ *
+ * @returns false if the pool already runs (or there is no native module)
+ */
+export function configureScheduler(config: SchedulerConfig): boolean {
+  return loadNativeModule()?.configureScheduler(config) ?? false;
+}
+
+/**
+ * Worker pool configuration with per-class counters, queue-wait
+ * percentiles and histograms, or null without the native module.
+ */
+export function getSchedulerStats(): SchedulerStats | null {
+  return loadNativeModule()?.getSchedulerStats() ?? null;
+}
+
+/**
+ * Zero the worker pool's counters and histograms (e.g. between benchmark
+ * phases).
+ */
+export function resetSchedulerStats(): void {
+  loadNativeModule()?.resetSchedulerStats();
+}
+
+/**
+ * Create a process running in AppContainer sandbox.
+ *
+ * @param commandLine Command line to execute (e.g., "node agent.js")
+ * @param workspacePath Path to workspace directory
  * @param enableInternet Enable internet access for the sandbox (default: true)
+ * @param resources Run the sandbox in a Job Object with these limits
  * @returns Process ID on success, negative error code on failure
  *
  * Error codes:
@@ -157,11 +1527,13 @@ export const isAmsiAvailable =
  * -3: Process creation failed
  * -4: Invalid arguments
  * -5: Capability error
+ * -6: Resource error (Job Object could not be created or assigned)
  */
 export function createAppContainerSandbox(
   commandLine: string,
   workspacePath: string,
   enableInternet = true,
+  resources?: SandboxResourceLimits,
 ): number {
   const native = loadNativeModule();
   if (!native) {
@@ -171,6 +1543,7 @@ export function createAppContainerSandbox(
     commandLine,
     workspacePath,
     enableInternet,
+    resources,
   );
 }
 
@@ -240,3 +1613,893 @@ export function amsiScanFile(filepath: string): AmsiScanResult {
   }
   return native.amsiScanFile(filepath);
 }
+
+/**
+ * Scan the members of a zip, tar, gzip or zstd archive (nested archives
+ * included) without extracting it. Members are decompressed in memory under
+ * size and ratio limits, and each is scanned with its inner path as context.
+ *
+ * @param source Archive path, or its content
+ * @param options Limits, engine, deadline, abort signal and scheduling
+ *   (priority defaults to 'bulk')
+ */
+export async function scanArchive(
+  source: string | Buffer,
+  options?: ArchiveScanOptions,
+): Promise<ArchiveScanResult> {
+  const native = loadNativeModule();
+  if (!native) {
+    throw new Error('Native module not available');
+  }
+  return native.scanArchive(source, options);
+}
+
+/**
+ * Write a file in one pass: the content is streamed to a temporary file
+ * beside the target while it is hashed and scanned, then renamed over the
+ * target only if clean. Otherwise the temporary file is deleted, the target
+ * is left as it was and the verdict is returned with `written: false`.
+ *
+ * @param filepath Target path; its directory must exist
+ * @param content Content to write (strings are written as UTF-8)
+ * @param options Engine, durability, deadline, abort signal and scheduling
+ *   (priority defaults to 'interactive')
+ */
+export async function writeFileScanned(
+  filepath: string,
+  content: Buffer | string,
+  options?: ScannedWriteOptions,
+): Promise<ScannedWriteResult> {
+  const native = loadNativeModule();
+  if (!native) {
+    throw new Error('Native module not available');
+  }
+  return native.writeFileScanned(filepath, content, options);
+}
+
+/**
+ * Compute the BLAKE3 digest of an in-memory payload.
+ *
+ * @param content Payload to hash
+ * @returns 64-character hex digest
+ */
+export function hashBuffer(content: Buffer | string): string {
+  const native = loadNativeModule();
+  if (!native) {
+    throw new Error('Native module not available');
+  }
+  return native.hashBuffer(content);
+}
+
+/**
+ * Compute the BLAKE3 digest of a file. Large files are tree-hashed across
+ * all cores unless `threads: 1` is given.
+ *
+ * @param filepath Path to the file
+ * @param options Threading, deadline, abort signal and scheduling
+ *   (priority defaults to 'normal')
+ * @returns 64-character hex digest
+ */
+export async function hashFile(
+  filepath: string,
+  options?: { threads?: number } & NativeCancelOptions &
+    NativeScheduleOptions,
+): Promise<string> {
+  const native = loadNativeModule();
+  if (!native) {
+    throw new Error('Native module not available');
+  }
+  return native.hashFile(filepath, options);
+}
+
+/**
+ * Build a Merkle snapshot of a directory.
+ *
+ * Files unchanged since the previous snapshot of the same root (same inode,
+ * size, mtime and ctime) reuse their previous hash without being read.
+ *
+ * @param root Directory to snapshot
+ * @param options Exclusions, threading, manifest persistence, deadline,
+ *   abort signal (a stopped snapshot leaves the cache untouched) and
+ *   scheduling (priority defaults to 'bulk')
+ */
+export async function snapshotDirectory(
+  root: string,
+  options?: SnapshotOptions,
+): Promise<SnapshotResult> {
+  const native = loadNativeModule();
+  if (!native) {
+    throw new Error('Native module not available');
+  }
+  return native.snapshotDirectory(root, options);
+}
+
+/**
+ * Forget cached snapshot manifests so the next snapshot re-reads every file.
+ *
+ * @param root Root to forget (default: all)
+ */
+export function clearSnapshotCache(root?: string): void {
+  loadNativeModule()?.clearSnapshotCache(root);
+}
+
+/**
+ * Copy or incrementally sync a directory tree, e.g. a project into a
+ * sandbox workspace or results back out. Directories are listed and
+ * created a level at a time, metadata calls are batched (through io_uring
+ * on Linux where available) and files are copied in parallel, as reflinks
+ * where the filesystem allows. Mode and mtime are copied, so a later sync
+ * with the default comparison only copies what changed.
+ *
+ * The destination must not change while it is staged: stage into a
+ * workspace before its sandbox starts, and out of it after it exits.
+ *
+ * @param source Directory to copy from
+ * @param destination Directory to copy into (created if missing)
+ * @param options Comparison, mirroring, exclusions, progress, deadline,
+ *   abort signal and scheduling (priority defaults to 'bulk')
+ */
+export async function stageWorkspace(
+  source: string,
+  destination: string,
+  options?: StageWorkspaceOptions,
+): Promise<StageResult> {
+  const native = loadNativeModule();
+  if (!native) {
+    throw new Error('Native module not available');
+  }
+  return native.stageWorkspace(source, destination, options);
+}
+
+/**
+ * Load and activate a command policy file. With `watchIntervalMs`, the file
+ * is polled and recompiled when it changes; a file that fails to compile
+ * leaves the previous policy active.
+ *
+ * @param policyPath Path to the rule file
+ * @param options Watch interval (0 or omitted = no watching)
+ */
+export function loadCommandPolicy(
+  policyPath: string,
+  options?: { watchIntervalMs?: number },
+): CommandPolicyLoadResult {
+  const native = loadNativeModule();
+  if (!native) {
+    throw new Error('Native module not available');
+  }
+  return native.loadCommandPolicy(policyPath, options);
+}
+
+/**
+ * Compile and activate command policy text (no file watching).
+ *
+ * @param text Policy rules
+ */
+export function compileCommandPolicy(text: string): CommandPolicyLoadResult {
+  const native = loadNativeModule();
+  if (!native) {
+    throw new Error('Native module not available');
+  }
+  return native.compileCommandPolicy(text);
+}
+
+/**
+ * Evaluate an execute request against the active command policy.
+ *
+ * @returns The decision, or null if no policy is loaded
+ */
+export function evaluateCommandPolicy(
+  request: CommandPolicyRequest,
+): CommandPolicyDecision | null {
+  return loadNativeModule()?.evaluateCommandPolicy(request) ?? null;
+}
+
+/**
+ * Describe the active command policy and its evaluation counters.
+ */
+export function getCommandPolicyInfo(): CommandPolicyInfo | null {
+  return loadNativeModule()?.getCommandPolicyInfo() ?? null;
+}
+
+/**
+ * Deactivate the command policy and stop watching its file.
+ */
+export function unloadCommandPolicy(): void {
+  loadNativeModule()?.unloadCommandPolicy();
+}
+
+/**
+ * Build a known-good hash table: a minimal perfect hash over BLAKE3
+ * digests, written to `outPath` through a temporary file and a rename.
+ * Duplicates are dropped.
+ *
+ * @param hashes Hex or 32-byte digests (see hashBuffer/hashFile), or one
+ *   Buffer of 32-byte digests back to back
+ * @param outPath Table file to create or replace
+ */
+export async function buildHashAllowlist(
+  hashes: Array<string | Buffer> | Buffer,
+  outPath: string,
+): Promise<HashAllowlistBuildResult> {
+  const native = loadNativeModule();
+  if (!native) {
+    throw new Error('Native module not available');
+  }
+  return native.buildHashAllowlist(hashes, outPath);
+}
+
+/**
+ * Map a table built by buildHashAllowlist and swap it in as the active
+ * allowlist. The file is used in place, so loading takes the same time at
+ * any size; an invalid file leaves the previous table active.
+ *
+ * @param tablePath Table file
+ * @param options `verify` also checksums the whole file
+ */
+export function loadHashAllowlist(
+  tablePath: string,
+  options?: { verify?: boolean },
+): HashAllowlistLoadResult {
+  const native = loadNativeModule();
+  if (!native) {
+    throw new Error('Native module not available');
+  }
+  return native.loadHashAllowlist(tablePath, options);
+}
+
+/**
+ * Check a content hash against the active allowlist.
+ *
+ * @param hash BLAKE3 digest, hex or 32 bytes
+ * @returns false when no table is loaded
+ */
+export function isHashAllowlisted(hash: string | Buffer): boolean {
+  return loadNativeModule()?.isHashAllowlisted(hash) ?? false;
+}
+
+/**
+ * Describe the active allowlist and its lookup hit rate.
+ */
+export function getHashAllowlistInfo(): HashAllowlistInfo | null {
+  return loadNativeModule()?.getHashAllowlistInfo() ?? null;
+}
+
+/**
+ * Deactivate the allowlist.
+ */
+export function unloadHashAllowlist(): void {
+  loadNativeModule()?.unloadHashAllowlist();
+}
+
+/**
+ * Compile byte-signature rules for the portable scan engine into a
+ * database file, written to `outPath` through a temporary file and a
+ * rename. Meant to run offline; loading the result is what scanners do.
+ *
+ * @param rules Rule names and byte patterns (strings are UTF-8)
+ * @param outPath Database file to create or replace
+ */
+export async function compileRuleDatabase(
+  rules: Array<{ name: string; pattern: string | Buffer }>,
+  outPath: string,
+): Promise<RuleDatabaseCompileResult> {
+  const native = loadNativeModule();
+  if (!native) {
+    throw new Error('Native module not available');
+  }
+  return native.compileRuleDatabase(rules, outPath);
+}
+
+/**
+ * Map a database built by compileRuleDatabase and swap it in as the active
+ * rule database. The file is matched in place, so loading takes the same
+ * time at any size and processes share its pages; an invalid file leaves
+ * the previous database active. Portable-engine scans started afterwards
+ * use it.
+ *
+ * @param databasePath Database file
+ * @param options `verify` also checksums the whole file
+ */
+export function loadRuleDatabase(
+  databasePath: string,
+  options?: { verify?: boolean },
+): RuleDatabaseLoadResult {
+  const native = loadNativeModule();
+  if (!native) {
+    throw new Error('Native module not available');
+  }
+  return native.loadRuleDatabase(databasePath, options);
+}
+
+/**
+ * Describe the active rule database and how often it matched.
+ */
+export function getRuleDatabaseInfo(): RuleDatabaseInfo | null {
+  return loadNativeModule()?.getRuleDatabaseInfo() ?? null;
+}
+
+/**
+ * Deactivate the rule database.
+ */
+export function unloadRuleDatabase(): void {
+  loadNativeModule()?.unloadRuleDatabase();
+}
+
+/**
+ * Scan a buffer through the tiered pipeline: known-good hash allowlist,
+ * cached verdicts, a structural pre-classifier, then the engine (AMSI on
+ * Windows). Small content is screened without leaving the main thread;
+ * only escalations wait for the engine.
+ *
+ * @param content Script or file content
+ * @param options Content name, engine and scheduling (priority defaults
+ *   to 'interactive')
+ */
+export async function scanContent(
+  content: Buffer | string,
+  options?: ScanContentOptions,
+): Promise<ScanContentResult> {
+  const native = loadNativeModule();
+  if (!native) {
+    throw new Error('Native module not available');
+  }
+  return native.scanContent(content, options);
+}
+
+/**
+ * Set which tiers run and which verdicts each may emit. Cached verdicts
+ * survive; throws a TypeError on an invalid policy.
+ */
+export function configureScanPipeline(policy: ScanPipelinePolicy): boolean {
+  const native = loadNativeModule();
+  if (!native) {
+    throw new Error('Native module not available');
+  }
+  return native.configureScanPipeline(policy);
+}
+
+/**
+ * Decisions, escalations and latency per tier, and verdict cache usage.
+ */
+export function getScanPipelineStats(): ScanPipelineStats | null {
+  return loadNativeModule()?.getScanPipelineStats() ?? null;
+}
+
+/**
+ * Zero the pipeline counters; `cache: true` also drops cached verdicts.
+ */
+export function resetScanPipelineStats(options?: { cache?: boolean }): void {
+  loadNativeModule()?.resetScanPipelineStats(options);
+}
+
+/**
+ * De-obfuscate a PowerShell or shell script in one pass per layer:
+ * escapes, quote splicing and literal concatenation are undone and
+ * base64 (and UTF-16LE) payloads handed to -EncodedCommand,
+ * FromBase64String or `base64 -d` are decoded and normalized in turn.
+ * scanContent does this itself; this is for inspecting what it sees.
+ *
+ * Throws a TypeError on invalid options.
+ */
+export function normalizeScript(
+  script: Buffer | string,
+  options?: NormalizeScriptOptions,
+): NormalizeScriptResult {
+  const native = loadNativeModule();
+  if (!native) {
+    throw new Error('Native module not available');
+  }
+  return native.normalizeScript(script, options);
+}
+
+/**
+ * Scripts, bytes, layers and decoded payloads normalized since load.
+ */
+export function getScriptNormalizerStats(): ScriptNormalizerStats | null {
+  return loadNativeModule()?.getScriptNormalizerStats() ?? null;
+}
+
+/**
+ * Launch a process in a Linux user/mount namespace sandbox.
+ *
+ * @returns Process ID on success, negative error code on failure
+ *
+ * Error codes:
+ * -1: Namespace creation failed (user namespaces disabled?)
+ * -2: Overlay mount failed
+ * -3: Process creation failed
+ * -4: Invalid arguments
+ * -5: Capability error (seccomp filter could not be installed)
+ * -6: Resource error (cgroup could not be created or joined)
+ * -7: Cancelled (deadline passed or signal aborted before the launch ended)
+ *
+ * The call is synchronous, so `signal` only takes effect if it is already
+ * aborted; `timeoutMs` bounds the launch itself.
+ */
+export function createLinuxSandbox(options: LinuxSandboxOptions): number {
+  const native = loadNativeModule();
+  if (!native) {
+    throw new Error('Native module not available');
+  }
+  return native.createLinuxSandbox(options);
+}
+
+/**
+ * Wait for a process started by createLinuxSandbox and reap it.
+ *
+ * @param pid Process ID
+ * @param options Give up after this many ms (resolves with timedOut), or
+ *   { timeoutMs, signal }; an aborted signal rejects with an AbortError.
+ *   Either way the process keeps running.
+ */
+export async function waitLinuxSandbox(
+  pid: number,
+  options?: number | NativeCancelOptions,
+): Promise<LinuxSandboxExit> {
+  const native = loadNativeModule();
+  if (!native) {
+    throw new Error('Native module not available');
+  }
+  return native.waitLinuxSandbox(pid, options);
+}
+
+/**
+ * Check whether the Linux sandbox and overlay workspaces can be used.
+ */
+export function getLinuxSandboxSupport(): {
+  userNamespaces: boolean;
+  overlay: boolean;
+} {
+  const native = loadNativeModule();
+  if (!native || process.platform !== 'linux') {
+    return { userNamespaces: false, overlay: false };
+  }
+  return native.getLinuxSandboxSupport();
+}
+
+/**
+ * Create a copy-on-write overlay of a workspace for a disposable sandbox
+ * run. Setup cost does not depend on the size of the workspace.
+ *
+ * @param workspacePath Workspace to layer on
+ * @param stateRoot Where upper/work directories live (outside the workspace)
+ */
+export function createOverlayWorkspace(
+  workspacePath: string,
+  stateRoot = path.join(os.homedir(), '.terminai', 'overlays'),
+): OverlayWorkspace {
+  const native = loadNativeModule();
+  if (!native) {
+    throw new Error('Native module not available');
+  }
+  return native.createOverlayWorkspace(workspacePath, stateRoot);
+}
+
+/**
+ * List what a sandbox changed on an overlay workspace.
+ */
+export async function diffOverlayWorkspace(
+  id: string,
+  options?: NativeCancelOptions,
+): Promise<OverlayChange[]> {
+  const native = loadNativeModule();
+  if (!native) {
+    throw new Error('Native module not available');
+  }
+  return native.diffOverlayWorkspace(id, options);
+}
+
+/**
+ * Apply an overlay's changes to the real workspace and reset the overlay.
+ * Rejects while a sandbox running on the overlay has not been reaped.
+ *
+ * A commit stopped by `options` has applied some of the changes; the rest
+ * stay on the overlay and the next commit applies them.
+ */
+export async function commitOverlayWorkspace(
+  id: string,
+  options?: NativeCancelOptions,
+): Promise<{ written: number; removed: number; bytes: number }> {
+  const native = loadNativeModule();
+  if (!native) {
+    throw new Error('Native module not available');
+  }
+  return native.commitOverlayWorkspace(id, options);
+}
+
+/**
+ * Throw an overlay's changes away. Returns immediately; the files are
+ * deleted in the background.
+ *
+ * @returns false if the overlay is unknown
+ */
+export function discardOverlayWorkspace(id: string): boolean {
+  return loadNativeModule()?.discardOverlayWorkspace(id) ?? false;
+}
+
+/**
+ * Compile the seccomp filter for a capability profile, or fetch it from the
+ * memory/disk cache. Launches compile on demand, so calling this is only
+ * needed to warm the cache or to inspect the program.
+ *
+ * @param capabilities Profile; `dispatch: 'linear'` is for benchmarks
+ */
+export function compileSeccompFilter(
+  capabilities: SandboxCapabilities & { dispatch?: 'binary' | 'linear' },
+): SeccompFilterInfo {
+  const native = loadNativeModule();
+  if (!native) {
+    throw new Error('Native module not available');
+  }
+  return native.compileSeccompFilter(capabilities);
+}
+
+/**
+ * Set where compiled seccomp filters are cached on disk. The directory
+ * must be ours; it is kept at 0700 with a per-install key that signs every
+ * entry, and isolated sandboxes cannot see it.
+ *
+ * @param dir Directory, '' to disable, omitted for the default
+ *            ($XDG_CACHE_HOME/terminai/seccomp)
+ */
+export function setSeccompCacheDirectory(dir?: string): void {
+  loadNativeModule()?.setSeccompCacheDirectory(dir);
+}
+
+/**
+ * Drop the in-memory seccomp filter cache.
+ */
+export function clearSeccompCache(): void {
+  loadNativeModule()?.clearSeccompCache();
+}
+
+/**
+ * Create a named sandbox session: its own AppContainer profile and Job
+ * Object (Windows), or its own cgroup and seccomp filter (Linux). Sessions
+ * are isolated from each other and can be created concurrently. With
+ * `stage`, the workspace is filled from a source tree (see stageWorkspace)
+ * before the promise resolves.
+ *
+ * @param id 1-40 characters of [A-Za-z0-9._-], unique among live sessions
+ */
+export async function createSandboxSession(
+  id: string,
+  options: SandboxSessionOptions,
+): Promise<SandboxSessionCreated> {
+  const native = loadNativeModule();
+  if (!native) {
+    throw new Error('Native module not available');
+  }
+  return native.createSandboxSession(id, options);
+}
+
+/**
+ * Launch a process in a session, in its own namespaces (Linux) or in the
+ * session's AppContainer (Windows). Wait for it with waitLinuxSandbox.
+ *
+ * @returns PID, or a negative error code as createLinuxSandbox (-4 for an
+ *          unknown session)
+ */
+export function launchInSandboxSession(
+  id: string,
+  options: SandboxSessionLaunchOptions,
+): number {
+  const native = loadNativeModule();
+  if (!native) {
+    throw new Error('Native module not available');
+  }
+  return native.launchInSandboxSession(id, options);
+}
+
+/**
+ * Describe one session, or null if there is none by that id.
+ */
+export function getSandboxSession(id: string): SandboxSessionInfo | null {
+  return loadNativeModule()?.getSandboxSession(id) ?? null;
+}
+
+/**
+ * Describe every live session, ordered by id.
+ */
+export function listSandboxSessions(): SandboxSessionInfo[] {
+  return loadNativeModule()?.listSandboxSessions() ?? [];
+}
+
+/**
+ * Kill everything running in a session and remove it with its profile.
+ *
+ * @param timeoutMs Wait at most this long for the processes (default: 5000)
+ * @returns null for an unknown session
+ */
+export async function destroySandboxSession(
+  id: string,
+  timeoutMs?: number,
+): Promise<(TreeKillResult & { processes: number }) | null> {
+  const native = loadNativeModule();
+  if (!native) {
+    throw new Error('Native module not available');
+  }
+  return native.destroySandboxSession(id, { timeoutMs });
+}
+
+/**
+ * Start an egress proxy on the host (Linux): HTTP CONNECT tunnels and
+ * plain HTTP requests to allowed hosts only, forwarded with splice(). The
+ * same proxy a session with `egress` runs inside each of its processes'
+ * network namespaces.
+ *
+ * @throws on an invalid policy or if the listener cannot be opened
+ */
+export function createEgressProxy(
+  options: EgressProxyOptions,
+): EgressProxyHandle {
+  const native = loadNativeModule();
+  if (!native) {
+    throw new Error('Native module not available');
+  }
+  return native.createEgressProxy(options);
+}
+
+/**
+ * Counters of an egress proxy; a session's is "session:<id>".
+ */
+export function getEgressProxyStats(id: string): EgressProxyStats | null {
+  return loadNativeModule()?.getEgressProxyStats(id) ?? null;
+}
+
+/**
+ * Close a standalone egress proxy and drop its connections.
+ *
+ * @returns false for an unknown id or a session's proxy
+ */
+export function closeEgressProxy(id: string): boolean {
+  return loadNativeModule()?.closeEgressProxy(id) ?? false;
+}
+
+/**
+ * Read a governed sandbox's resource usage now.
+ *
+ * @returns null if the sandbox has no cgroup/job (no cgroup v2), has been
+ *          released, or the native module is unavailable
+ */
+export function sampleSandboxResources(pid: number): ResourceSample | null {
+  return loadNativeModule()?.sampleSandboxResources(pid) ?? null;
+}
+
+/**
+ * Sample every governed sandbox on a fixed cadence. Sampling runs on a
+ * native thread; batches the event loop is too busy to pick up are dropped
+ * rather than queued. Replaces a running sampler and does not keep the
+ * process alive.
+ *
+ * @param intervalMs Cadence (minimum 10ms)
+ */
+export function startResourceSampler(
+  intervalMs: number,
+  callback: (samples: ResourceSample[]) => void,
+): void {
+  const native = loadNativeModule();
+  if (!native) {
+    throw new Error('Native module not available');
+  }
+  native.startResourceSampler(intervalMs, callback);
+}
+
+/**
+ * Stop the resource sampler.
+ *
+ * @returns Sampling passes made and batches dropped
+ */
+export function stopResourceSampler(): { passes: number; dropped: number } {
+  return (
+    loadNativeModule()?.stopResourceSampler() ?? { passes: 0, dropped: 0 }
+  );
+}
+
+/**
+ * Stop tracking a sandbox, kill anything left in its cgroup or Job Object
+ * and remove it. Linux sandboxes are released automatically when
+ * waitLinuxSandbox reaps them.
+ */
+export function releaseSandboxResources(pid: number): void {
+  loadNativeModule()?.releaseSandboxResources(pid);
+}
+
+/**
+ * Give a process spawned with child_process its own cgroup (Linux) or
+ * kill-on-close Job Object (Windows), so killProcessTree() reaches every
+ * descendant. Call right after spawning: children it forked before the
+ * call are not covered.
+ *
+ * @returns false if no group could be created or joined
+ */
+export function attachProcessTree(pid: number): boolean {
+  return loadNativeModule()?.attachProcessTree(pid) ?? false;
+}
+
+/**
+ * Kill a sandbox (or attached process) and everything it spawned in one
+ * kernel operation, and wait for the tree to exit without polling. The
+ * leader still has to be reaped (waitLinuxSandbox, or child_process).
+ *
+ * @param timeoutMs Wait at most this long (default: 5000)
+ */
+export async function killProcessTree(
+  pid: number,
+  timeoutMs?: number,
+): Promise<TreeKillResult> {
+  const native = loadNativeModule();
+  if (!native) {
+    throw new Error('Native module not available');
+  }
+  return native.killProcessTree(pid, timeoutMs);
+}
+
+/**
+ * Set the cgroup that sandbox cgroups are created under (Linux). Limits
+ * need a delegated cgroup that holds no processes itself.
+ *
+ * @param root cgroup directory; omitted for $TERMINAI_CGROUP_ROOT or the
+ *             caller's own cgroup
+ */
+export function setResourceGovernorRoot(root?: string): void {
+  loadNativeModule()?.setResourceGovernorRoot(root);
+}
+
+/**
+ * Describe which resource limits this host can enforce.
+ */
+export function getResourceGovernorSupport(): ResourceGovernorSupport {
+  return (
+    loadNativeModule()?.getResourceGovernorSupport() ?? {
+      available: false,
+      root: '',
+      limits: [],
+    }
+  );
+}
+
+/**
+ * Start a process on a pseudo-terminal (openpty on Linux, ConPTY on
+ * Windows). Output is delivered without copying; input is batched.
+ *
+ * @returns Process ID (the session handle), or a negative error code of
+ *          createLinuxSandbox / createAppContainerSandbox
+ */
+export function createPty(options: PtyOptions): number {
+  const native = loadNativeModule();
+  if (!native) {
+    throw new Error('Native module not available');
+  }
+  const { sandbox, ...rest } = options;
+  return native.createPty({
+    ...sandbox,
+    ...rest,
+    env: rest.env ?? {
+      TERM: 'xterm-256color',
+      ...(process.env as Record<string, string>),
+    },
+    sandbox: sandbox !== undefined,
+  });
+}
+
+/**
+ * Send input to a terminal session. Writes made while the previous ones
+ * are still being flushed go out in the same system call.
+ *
+ * @returns false if the session has exited or was hung up
+ */
+export function writePty(pid: number, data: string | Buffer): boolean {
+  return loadNativeModule()?.writePty(pid, data) ?? false;
+}
+
+/**
+ * Resize a terminal session; the foreground process is notified.
+ */
+export function resizePty(pid: number, cols: number, rows: number): boolean {
+  return loadNativeModule()?.resizePty(pid, cols, rows) ?? false;
+}
+
+/**
+ * Hang up a terminal session. onExit fires once the process has exited;
+ * use killProcessTree() for processes that ignore the hangup.
+ */
+export function closePty(pid: number): void {
+  loadNativeModule()?.closePty(pid);
+}
+
+/**
+ * Transfer counters of a running terminal session.
+ */
+export function getPtyStats(pid: number): PtyStats | null {
+  return loadNativeModule()?.getPtyStats(pid) ?? null;
+}
+
+/**
+ * Run a command on the host without a shell (posix_spawn on Linux,
+ * CreateProcess in a kill-on-close Job Object on Windows) and collect its
+ * output. One native thread watches every running process and enforces
+ * timeouts; processes that finish together are resolved together. Whatever
+ * the command leaves running is killed when it exits.
+ *
+ * @param command A bare name is resolved against the base environment's
+ *   PATH, not one set in `env`; batch files are refused on Windows (run
+ *   cmd.exe with the script instead)
+ * @param args Arguments, passed as they are
+ * @param options Working directory, extra variables, timeout, output cap
+ *   and abort signal
+ * @throws Error if the command cannot be started or the signal aborts it
+ *   (AbortError)
+ */
+export async function spawnProcess(
+  command: string,
+  args: string[] = [],
+  options?: SpawnProcessOptions,
+): Promise<SpawnResult> {
+  const native = loadNativeModule();
+  if (!native) {
+    throw new Error('Native module not available');
+  }
+  return native.spawnProcess(command, args, options);
+}
+
+/**
+ * Replace the environment spawned processes start from; their own `env`
+ * is applied on top. The base is built once instead of on every spawn.
+ *
+ * @param env Complete environment; omitted to capture process.env as it is
+ *   now
+ * @returns Variables in the new base (0 without the native module)
+ */
+export function setSpawnEnvironment(env?: Record<string, string>): number {
+  return loadNativeModule()?.setSpawnEnvironment(env) ?? 0;
+}
+
+/**
+ * Spawner counters since the module was loaded.
+ */
+export function getSpawnStats(): SpawnStats | null {
+  return loadNativeModule()?.getSpawnStats() ?? null;
+}
+
+/**
+ * Grant a principal access to a file or directory tree. Only entries that
+ * lack a matching ACE / ACL entry are written; a grant verified earlier on
+ * an unchanged root is answered from cache without touching any ACL.
+ *
+ * @throws Error if the native module is not available
+ */
+export function grantPathAccess(
+  options: AccessGrantOptions,
+): Promise<AccessGrantResult> {
+  const native = loadNativeModule();
+  if (!native) {
+    throw new Error('Native module not available');
+  }
+  return native.grantPathAccess(options);
+}
+
+/**
+ * Whether a path already grants the rights (nothing is changed).
+ *
+ * @param inheritable Also require directories to pass the grant on
+ */
+export function checkPathAccess(
+  filePath: string,
+  principal: string,
+  rights: string,
+  inheritable = false,
+): boolean {
+  const native = loadNativeModule();
+  if (!native) {
+    return false;
+  }
+  return native.checkPathAccess(filePath, principal, rights, inheritable);
+}
+
+/**
+ * Forget verified grants, so the next grant re-checks every entry.
+ */
+export function clearAccessGrantCache(): void {
+  loadNativeModule()?.clearAccessGrantCache();
+}
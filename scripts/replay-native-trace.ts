@@ -0,0 +1,440 @@
+/**
+ * @license
+ * Copyright 2025 Google LLC
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Replays a native call trace (recorded with startNativeTrace or
+ * TERMINAI_NATIVE_TRACE) against a build of the native module and reports
+ * per-export latency distributions, so that a session recorded in the
+ * field becomes a repeatable benchmark.
+ *
+ *   npm run native:replay -- <trace> [options]
+ *
+ *   --module <path>     native module to drive (default: the release
+ *                       build in packages/cli/build)
+ *   --pace <mode>       'original' keeps the recorded gaps between calls,
+ *                       'asap' drops them (default: asap)
+ *   --speed <n>         with --pace original, replay n times faster
+ *   --iterations <n>    replay the trace n times (default: 1)
+ *   --only <a,b>        replay only these exports
+ *   --skip <a,b>        do not replay these exports
+ *   --json <file>       write the distributions as JSON
+ *   --baseline <file>   compare against JSON from an earlier run
+ *
+ * Ordering: a call is issued only after every call that had settled before
+ * it started in the recording, so `await` chains (create, then launch, then
+ * wait) keep their order while independent calls still overlap.
+ *
+ * Arguments are rebuilt from the trace: Buffers and digested strings as
+ * filler of the recorded length, callbacks as no-ops. Traces digest every
+ * string unless recorded with redactStrings: false, which keeps paths and
+ * commands. Handles returned by create and launch calls (PIDs, session
+ * and overlay ids) are mapped to the ones the replay gets back. Scans use
+ * the portable engine, and AMSI scans are replayed as portable buffer
+ * scans, so Windows traces replay on Linux. Other calls that only exist
+ * on Windows are skipped and counted.
+ *
+ * Replaying repeats the recorded side effects (sandboxes, overlays, files
+ * written); run it in a scratch environment.
+ */
+
+import { createRequire } from 'node:module';
+import { readFileSync, writeFileSync } from 'node:fs';
+import path from 'node:path';
+import { fileURLToPath } from 'node:url';
+import { parseArgs } from 'node:util';
+import type {
+  NativeTrace,
+  NativeTraceCall,
+} from '../packages/cli/src/runtime/windows/native.ts';
+
+type NativeFn = (...args: unknown[]) => unknown;
+type NativeModule = Record<string, unknown> & {
+  readNativeTrace: (file: string) => Promise<NativeTrace>;
+};
+
+interface Distribution {
+  calls: number;
+  errors: number;
+  skipped: number;
+  p50: number;
+  p90: number;
+  p99: number;
+  max: number;
+  mean: number;
+}
+
+interface ReplayReport {
+  trace: string;
+  module: string;
+  node: string;
+  platform: string;
+  pace: string;
+  iterations: number;
+  wallMs: number;
+  /** Replayed latency (µs, to settle for async exports) per export */
+  exports: Record<string, Distribution>;
+  /** Latency recorded in the trace, for reference */
+  recorded: Record<string, Distribution>;
+}
+
+const WINDOWS_ONLY = new Set([
+  'createAppContainerSandbox',
+  'getAppContainerSid',
+  'deleteAppContainerProfile',
+]);
+
+/** Exports whose results are handles later calls refer to. */
+const HANDLE_SOURCE = /^(create|launch|start|open)/;
+
+const rootDir = path.resolve(
+  path.dirname(fileURLToPath(import.meta.url)),
+  '..',
+);
+
+const { values, positionals } = parseArgs({
+  allowPositionals: true,
+  options: {
+    module: {
+      type: 'string',
+      default: path.join(
+        rootDir,
+        'packages/cli/build/Release/terminai_native.node',
+      ),
+    },
+    pace: { type: 'string', default: 'asap' },
+    speed: { type: 'string', default: '1' },
+    iterations: { type: 'string', default: '1' },
+    only: { type: 'string' },
+    skip: { type: 'string' },
+    json: { type: 'string' },
+    baseline: { type: 'string' },
+  },
+});
+
+function distribution(
+  samples: number[],
+  errors = 0,
+  skipped = 0,
+): Distribution {
+  const sorted = [...samples].sort((a, b) => a - b);
+  const at = (q: number) =>
+    sorted.length
+      ? sorted[Math.min(sorted.length - 1, Math.floor(q * sorted.length))]
+      : 0;
+  const total = sorted.reduce((sum, v) => sum + v, 0);
+  return {
+    calls: sorted.length,
+    errors,
+    skipped,
+    p50: at(0.5),
+    p90: at(0.9),
+    p99: at(0.99),
+    max: sorted.length ? sorted[sorted.length - 1] : 0,
+    mean: sorted.length ? total / sorted.length : 0,
+  };
+}
+
+const fillers = new Map<number, Buffer>();
+
+/** Printable, non-repeating-looking bytes, so scans do real work. */
+function filler(length: number): Buffer {
+  let buffer = fillers.get(length);
+  if (!buffer) {
+    buffer = Buffer.alloc(length);
+    let state = length | 1;
+    for (let i = 0; i < length; i++) {
+      state = (state * 1103515245 + 12345) >>> 0;
+      buffer[i] = 32 + ((state >>> 16) % 95);
+    }
+    fillers.set(length, buffer);
+  }
+  return buffer;
+}
+
+class Replayer {
+  private readonly handles = new Map<unknown, unknown>();
+
+  /** Rebuild a recorded argument. */
+  rebuild(value: unknown): unknown {
+    if (Array.isArray(value)) return value.map((item) => this.rebuild(item));
+    if (value === null || typeof value !== 'object') {
+      return this.handles.has(value) ? this.handles.get(value) : value;
+    }
+    const record = value as Record<string, unknown>;
+    if (typeof record['$buffer'] === 'number') return filler(record['$buffer']);
+    if (typeof record['$string'] === 'number') {
+      return filler(record['$string']).toString('latin1');
+    }
+    if (record['$function']) return () => undefined;
+    if (record['$truncated']) return undefined;
+    if (typeof record['$array'] === 'number') {
+      return this.rebuild(record['items']);
+    }
+    const out: Record<string, unknown> = {};
+    for (const [key, item] of Object.entries(record)) {
+      out[key] = key === 'engine' ? 'portable' : this.rebuild(item);
+    }
+    return out;
+  }
+
+  /** Remember how a recorded handle maps to the replayed one. */
+  mapHandles(call: NativeTraceCall, result: unknown): void {
+    if (!HANDLE_SOURCE.test(call.name)) return;
+    const recorded = call.result;
+    if (
+      typeof recorded === 'number' &&
+      recorded > 0 &&
+      typeof result === 'number'
+    ) {
+      this.handles.set(recorded, result);
+    } else if (typeof recorded === 'string' && typeof result === 'string') {
+      this.handles.set(recorded, result);
+    } else if (
+      recorded !== null &&
+      typeof recorded === 'object' &&
+      result !== null &&
+      typeof result === 'object'
+    ) {
+      const id = (recorded as Record<string, unknown>)['id'];
+      const replayed = (result as Record<string, unknown>)['id'];
+      if (id !== undefined && replayed !== undefined) {
+        this.handles.set(id, replayed);
+      }
+    }
+  }
+
+  reset(): void {
+    this.handles.clear();
+  }
+}
+
+/** Translate calls that have a portable equivalent. */
+function portableCall(
+  native: NativeModule,
+  name: string,
+  args: unknown[],
+): [NativeFn, unknown[]] | null {
+  const scanArchive = native['scanArchive'];
+  if (name === 'amsiScanBuffer' && typeof scanArchive === 'function') {
+    const content = Buffer.isBuffer(args[0])
+      ? args[0]
+      : Buffer.from(String(args[0] ?? ''));
+    const options = { engine: 'portable', name: String(args[1] ?? 'content') };
+    return [scanArchive as NativeFn, [content, options]];
+  }
+  if (process.platform !== 'win32' && WINDOWS_ONLY.has(name)) return null;
+  const fn = native[name];
+  return typeof fn === 'function' ? [fn as NativeFn, args] : null;
+}
+
+function sleep(ms: number): Promise<void> {
+  return ms > 0
+    ? new Promise((resolve) => setTimeout(resolve, ms))
+    : Promise.resolve();
+}
+
+async function replayOnce(
+  native: NativeModule,
+  calls: NativeTraceCall[],
+  replayer: Replayer,
+  samples: Map<string, number[]>,
+  failures: Map<string, number>,
+  skips: Map<string, number>,
+): Promise<void> {
+  const original = values.pace === 'original';
+  const speed = Math.max(Number(values.speed) || 1, 1e-6);
+  const bump = (map: Map<string, number>, name: string) =>
+    map.set(name, (map.get(name) ?? 0) + 1);
+  const started = performance.now();
+
+  // Outstanding async calls, by recorded settle time.
+  let inFlight: Array<{ endUs: number; done: Promise<void> }> = [];
+
+  for (const call of calls) {
+    const ready = inFlight.filter((entry) => entry.endUs <= call.startUs);
+    if (ready.length) {
+      await Promise.all(ready.map((entry) => entry.done));
+      inFlight = inFlight.filter((entry) => entry.endUs > call.startUs);
+    }
+    if (original) {
+      await sleep(call.startUs / 1000 / speed - (performance.now() - started));
+    }
+
+    const args = replayer.rebuild(call.args) as unknown[];
+    const target = portableCall(native, call.name, args);
+    if (!target) {
+      bump(skips, call.name);
+      continue;
+    }
+    const [fn, callArgs] = target;
+    const list = samples.get(call.name) ?? [];
+    samples.set(call.name, list);
+
+    const t0 = performance.now();
+    let result: unknown;
+    try {
+      result = fn.apply(native, callArgs);
+    } catch {
+      list.push((performance.now() - t0) * 1000);
+      if (call.status !== 'threw') bump(failures, call.name);
+      continue;
+    }
+    if (result instanceof Promise) {
+      const done = result.then(
+        (value) => {
+          list.push((performance.now() - t0) * 1000);
+          replayer.mapHandles(call, value);
+        },
+        () => {
+          list.push((performance.now() - t0) * 1000);
+          if (call.status !== 'rejected') bump(failures, call.name);
+        },
+      );
+      const endUs =
+        call.durationUs === null ? Infinity : call.startUs + call.durationUs;
+      inFlight.push({ endUs, done });
+    } else {
+      list.push((performance.now() - t0) * 1000);
+      replayer.mapHandles(call, result);
+    }
+  }
+  await Promise.all(inFlight.map((entry) => entry.done));
+}
+
+function formatUs(us: number): string {
+  return us >= 1000 ? `${(us / 1000).toFixed(2)}ms` : `${us.toFixed(1)}us`;
+}
+
+function printReport(
+  report: ReplayReport,
+  baseline: ReplayReport | null,
+): void {
+  const rows = Object.entries(report.exports).sort(([a], [b]) =>
+    a.localeCompare(b),
+  );
+  const header = ['export', 'calls', 'p50', 'p90', 'p99', 'max', 'recorded'];
+  if (baseline) header.push('base p50', 'base p99', 'Δp50', 'Δp99');
+  const lines = [header];
+  for (const [name, dist] of rows) {
+    const recorded = report.recorded[name];
+    const line = [
+      name + (dist.errors ? ` (${dist.errors} failed)` : ''),
+      String(dist.calls),
+      formatUs(dist.p50),
+      formatUs(dist.p90),
+      formatUs(dist.p99),
+      formatUs(dist.max),
+      recorded ? formatUs(recorded.p50) : '-',
+    ];
+    const base = baseline?.exports[name];
+    if (baseline) {
+      const delta = (now: number, then: number) =>
+        then > 0 ? `${(((now - then) / then) * 100).toFixed(1)}%` : '-';
+      line.push(
+        base ? formatUs(base.p50) : '-',
+        base ? formatUs(base.p99) : '-',
+        base ? delta(dist.p50, base.p50) : '-',
+        base ? delta(dist.p99, base.p99) : '-',
+      );
+    }
+    lines.push(line);
+  }
+  const widths = header.map((_, i) =>
+    Math.max(...lines.map((line) => line[i].length)),
+  );
+  for (const line of lines) {
+    const cells = line.map((cell, i) =>
+      i === 0 ? cell.padEnd(widths[i]) : cell.padStart(widths[i]),
+    );
+    console.log(cells.join('  '));
+  }
+  const skipped = Object.entries(report.exports)
+    .filter(([, dist]) => dist.skipped)
+    .map(([name, dist]) => `${name} x${dist.skipped}`);
+  if (skipped.length) console.log(`skipped: ${skipped.join(', ')}`);
+  console.log(
+    `wall time ${report.wallMs.toFixed(0)}ms, ` +
+      `${report.iterations} iteration(s), pace ${report.pace}`,
+  );
+}
+
+async function main(): Promise<void> {
+  const [traceFile] = positionals;
+  if (!traceFile) {
+    console.error(
+      'usage: replay-native-trace.ts <trace> [--module path] ' +
+        '[--pace asap|original] [--speed n] [--iterations n] ...',
+    );
+    process.exit(2);
+  }
+  const modulePath = path.resolve(values.module!);
+  const native = createRequire(import.meta.url)(modulePath) as NativeModule;
+  const trace = await native.readNativeTrace(path.resolve(traceFile));
+  if (!trace.complete) {
+    console.warn('trace was not stopped cleanly; replaying the calls it has');
+  }
+
+  const only = values.only ? new Set(values.only.split(',')) : null;
+  const skip = new Set(values.skip ? values.skip.split(',') : []);
+  const calls = trace.calls.filter(
+    (call) => (!only || only.has(call.name)) && !skip.has(call.name),
+  );
+
+  const samples = new Map<string, number[]>();
+  const failures = new Map<string, number>();
+  const skips = new Map<string, number>();
+  const replayer = new Replayer();
+  const iterations = Math.max(1, Number(values.iterations) || 1);
+  const started = performance.now();
+  for (let i = 0; i < iterations; i++) {
+    replayer.reset();
+    await replayOnce(native, calls, replayer, samples, failures, skips);
+  }
+  const wallMs = performance.now() - started;
+
+  const recorded = new Map<string, number[]>();
+  for (const call of calls) {
+    if (call.durationUs === null) continue;
+    const list = recorded.get(call.name) ?? [];
+    list.push(call.durationUs);
+    recorded.set(call.name, list);
+  }
+
+  const names = new Set([...samples.keys(), ...skips.keys()]);
+  const report: ReplayReport = {
+    trace: path.resolve(traceFile),
+    module: modulePath,
+    node: process.version,
+    platform: `${process.platform}-${process.arch}`,
+    pace: values.pace === 'original' ? `original x${values.speed}` : 'asap',
+    iterations,
+    wallMs,
+    exports: Object.fromEntries(
+      [...names].map((name) => [
+        name,
+        distribution(
+          samples.get(name) ?? [],
+          failures.get(name) ?? 0,
+          skips.get(name) ?? 0,
+        ),
+      ]),
+    ),
+    recorded: Object.fromEntries(
+      [...recorded].map(([name, list]) => [name, distribution(list)]),
+    ),
+  };
+
+  const baseline = values.baseline
+    ? (JSON.parse(readFileSync(values.baseline, 'utf8')) as ReplayReport)
+    : null;
+  printReport(report, baseline);
+  if (values.json) writeFileSync(values.json, JSON.stringify(report, null, 2));
+}
+
+main().catch((error: unknown) => {
+  console.error(error);
+  process.exit(1);
+});